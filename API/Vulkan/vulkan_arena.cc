@@ -0,0 +1,81 @@
+#include "vulkan_arena.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Albedo {
+namespace RHI
+{
+	LinearArena::LinearArena(size_t block_size/* = 64 * 1024*/) :
+		m_block_size{ block_size }
+	{
+		assert(m_block_size > 0 && "Invalid block size!");
+	}
+
+	void LinearArena::Rewind(Marker marker)
+	{
+		assert((marker.block < m_current || (marker.block == m_current && marker.offset <= m_offset)) && "Markers must be rewound in reverse order!");
+		if (marker.block == 0 && marker.offset == 0) return Reset();
+		m_current = marker.block;
+		m_offset = marker.offset;
+	}
+
+	void LinearArena::Reset()
+	{
+		// Nothing is alive anymore: One block of the whole capacity serves the next frame without spilling
+		if (m_blocks.size() > 1)
+		{
+			const size_t capacity = GetCapacity();
+			m_blocks.clear();
+			m_blocks.emplace_back(Block{ .data = std::make_unique_for_overwrite<std::byte[]>(capacity), .size = capacity });
+			++m_block_allocations;
+		}
+		m_current = 0;
+		m_offset = 0;
+	}
+
+	size_t LinearArena::GetCapacity() const
+	{
+		size_t capacity = 0;
+		for (const auto& block : m_blocks) capacity += block.size;
+		return capacity;
+	}
+
+	LinearArena& LinearArena::GetThreadScratch()
+	{
+		thread_local LinearArena scratch;
+		return scratch;
+	}
+
+	void* LinearArena::do_allocate(size_t bytes, size_t alignment)
+	{
+		while (true)
+		{
+			if (m_current < m_blocks.size())
+			{
+				auto& block = m_blocks[m_current];
+				const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+				const size_t offset = ((base + m_offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+				if (offset + bytes <= block.size)
+				{
+					m_offset = offset + bytes;
+					return block.data.get() + offset;
+				}
+				if (m_current + 1 < m_blocks.size()) // Kept from before a rewind
+				{
+					++m_current;
+					m_offset = 0;
+					continue;
+				}
+			}
+
+			// Spill into a new block (Coalesced by the next Reset())
+			const size_t size = std::max(m_block_size, bytes + alignment);
+			m_blocks.emplace_back(Block{ .data = std::make_unique_for_overwrite<std::byte[]>(size), .size = size });
+			++m_block_allocations;
+			m_current = m_blocks.size() - 1;
+			m_offset = 0;
+		}
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Albedo {
+namespace RHI
+{
+	// Linear (Monotonic) Arena: Allocations are bumped from blocks that are kept across Reset(), and the blocks are coalesced into one
+	// of the reached capacity, so a steady-state workload stops hitting the heap. Deallocation is a no-op. Not thread-safe.
+	// Use it as the resource of std::pmr containers (e.g. std::pmr::vector<VkWriteDescriptorSet> writes{ &arena }).
+	class LinearArena final : public std::pmr::memory_resource
+	{
+	public:
+		struct Marker
+		{
+			size_t block = 0;
+			size_t offset = 0;
+		};
+		Marker GetMarker() const { return { m_current, m_offset }; }
+		void Rewind(Marker marker); // Release the allocations after the marker (The first marker of the arena resets it)
+		void Reset();
+
+		size_t GetCapacity() const;
+		uint64_t GetBlockAllocations() const { return m_block_allocations; } // Heap allocations so far
+
+		// Scratch memory of the calling thread for transient bookkeeping inside one call (See ScratchScope)
+		static LinearArena& GetThreadScratch();
+
+	public:
+		LinearArena(size_t block_size = 64 * 1024); // Nothing is allocated until the first use
+		LinearArena(const LinearArena&) = delete;
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override {} // Released by Rewind() & Reset()
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<std::byte[]> data;
+			size_t size = 0;
+		};
+		std::vector<Block> m_blocks;
+		size_t m_current = 0; // Block of the next allocation
+		size_t m_offset = 0;
+		size_t m_block_size;
+		uint64_t m_block_allocations = 0;
+	};
+
+	// Rewinds the scratch arena of this thread when the scope ends (Nestable, containers must not outlive it)
+	class ScratchScope
+	{
+	public:
+		std::pmr::memory_resource* Resource() { return &m_arena; }
+
+	public:
+		ScratchScope() : m_arena{ LinearArena::GetThreadScratch() }, m_marker{ m_arena.GetMarker() } {}
+		~ScratchScope() { m_arena.Rewind(m_marker); }
+		ScratchScope(const ScratchScope&) = delete;
+
+	private:
+		LinearArena& m_arena;
+		const LinearArena::Marker m_marker;
+	};
+
+}} // namespace Albedo::RHI
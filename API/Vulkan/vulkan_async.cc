@@ -0,0 +1,139 @@
+#include "vulkan_async.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	bool GPUAwaitable::await_ready()
+	{
+		return m_poller->is_complete(m_semaphore, m_value, m_fence);
+	}
+
+	void GPUAwaitable::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		m_poller->enqueue(CompletionPoller::Waiter{ m_semaphore, m_value, m_fence, coroutine });
+	}
+
+	void ResumeOn::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		worker_pool.Submit([coroutine]() { coroutine.resume(); }); // Task exceptions are kept in their promises
+	}
+
+	CompletionPoller::CompletionPoller(VulkanContext* vulkan_context) :
+		m_context{ vulkan_context }
+	{
+
+	}
+
+	CompletionPoller::~CompletionPoller()
+	{
+		{
+			std::scoped_lock guard{ m_mutex };
+			m_stop = true;
+		}
+		m_condition.notify_all();
+		if (m_thread.joinable()) m_thread.join();
+		if (!m_waiters.empty()) log::warn("Destroyed the Completion Poller with {} suspended coroutines", m_waiters.size());
+	}
+
+	void CompletionPoller::Poll()
+	{
+		for (auto coroutine : collect_completed()) coroutine.resume();
+	}
+
+	void CompletionPoller::EnableThread(std::chrono::microseconds interval/* = std::chrono::microseconds{ 500 }*/)
+	{
+		if (IsThreadEnabled()) return;
+		m_thread = std::thread{ &CompletionPoller::work, this, interval };
+	}
+
+	size_t CompletionPoller::GetPendingCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_waiters.size();
+	}
+
+	bool CompletionPoller::is_complete(VkSemaphore semaphore, uint64_t value, VkFence fence)
+	{
+		if (fence != VK_NULL_HANDLE) return vkGetFenceStatus(m_context->m_device, fence) == VK_SUCCESS;
+		uint64_t counter = 0;
+		m_context->m_dispatch.vkGetSemaphoreCounterValue(m_context->m_device, semaphore, &counter);
+		return counter >= value;
+	}
+
+	void CompletionPoller::enqueue(const Waiter& waiter)
+	{
+		bool isFirst = false;
+		{
+			std::scoped_lock guard{ m_mutex };
+			isFirst = m_waiters.empty();
+			m_waiters.emplace_back(waiter);
+		}
+		if (isFirst) m_condition.notify_one();
+	}
+
+	std::vector<std::coroutine_handle<>> CompletionPoller::collect_completed()
+	{
+		std::vector<std::coroutine_handle<>> completed;
+		std::scoped_lock guard{ m_mutex };
+		std::erase_if(m_waiters, [this, &completed](const Waiter& waiter)
+			{
+				if (!is_complete(waiter.semaphore, waiter.value, waiter.fence)) return false;
+				completed.emplace_back(waiter.coroutine);
+				return true;
+			});
+		return completed;
+	}
+
+	void CompletionPoller::work(std::chrono::microseconds interval)
+	{
+		const uint64_t timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+		std::vector<VkSemaphore> semaphores;
+		std::vector<uint64_t> values;
+		std::vector<VkFence> fences;
+		while (true)
+		{
+			semaphores.clear(); values.clear(); fences.clear();
+			{
+				std::unique_lock lock{ m_mutex };
+				m_condition.wait(lock, [this]() { return m_stop || !m_waiters.empty(); });
+				if (m_stop) return;
+				for (const auto& waiter : m_waiters)
+				{
+					if (waiter.fence != VK_NULL_HANDLE) fences.emplace_back(waiter.fence);
+					else
+					{
+						semaphores.emplace_back(waiter.semaphore);
+						values.emplace_back(waiter.value);
+					}
+				}
+			}
+
+			// Sleep until any of the snapshot completes (Fences are polled when timelines are waited)
+			VkResult result = VK_SUCCESS;
+			if (!semaphores.empty())
+			{
+				VkSemaphoreWaitInfo waitInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+					.flags = VK_SEMAPHORE_WAIT_ANY_BIT,
+					.semaphoreCount = static_cast<uint32_t>(semaphores.size()),
+					.pSemaphores = semaphores.data(),
+					.pValues = values.data()
+				};
+				result = m_context->m_dispatch.vkWaitSemaphores(m_context->m_device, &waitInfo, fences.empty()? timeout : std::min<uint64_t>(timeout, 100'000));
+			}
+			else result = vkWaitForFences(m_context->m_device, static_cast<uint32_t>(fences.size()), fences.data(), VK_FALSE, timeout);
+			if (result == VK_ERROR_DEVICE_LOST)
+			{
+				m_context->OnDeviceLost();
+				return; // The waiters will never complete
+			}
+
+			auto& workerPool = m_context->GetWorkerPool();
+			for (auto coroutine : collect_completed())
+				workerPool.Submit([coroutine]() { coroutine.resume(); });
+		}
+	}
+
+}} // namespace Albedo::RHI
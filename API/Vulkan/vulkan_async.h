@@ -0,0 +1,194 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <condition_variable>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class WorkerPool;
+	class CompletionPoller;
+
+	// co_await GPU completion (Fence, QueueTimeline::Completion(), UploadEngine::Completion())
+	// Ready work resumes inline, otherwise the coroutine is parked in the context's CompletionPoller.
+	// The awaited fence must not be reset before the coroutine was resumed.
+	class GPUAwaitable
+	{
+	public:
+		bool await_ready();
+		void await_suspend(std::coroutine_handle<> coroutine);
+		void await_resume() {}
+
+	public:
+		GPUAwaitable(CompletionPoller* poller, VkSemaphore timeline_semaphore, uint64_t value) :
+			m_poller{ poller }, m_semaphore{ timeline_semaphore }, m_value{ value } {}
+		GPUAwaitable(CompletionPoller* poller, VkFence fence) : m_poller{ poller }, m_fence{ fence } {}
+
+	private:
+		CompletionPoller* m_poller;
+		VkSemaphore m_semaphore = VK_NULL_HANDLE;
+		uint64_t m_value = 0;
+		VkFence m_fence = VK_NULL_HANDLE;
+	};
+
+	// Resumes the coroutines waiting for the GPU (VulkanContext::GetCompletionPoller(), thread-safe)
+	// Either by the frame loop (FrameContext::BeginFrame() calls Poll(), resumed on the frame thread), or by the poller thread
+	// (EnableThread(): Sleeps in vkWaitSemaphores / vkWaitForFences, the coroutines are resumed on the worker pool).
+	class CompletionPoller
+	{
+	public:
+		GPUAwaitable Await(VkSemaphore timeline_semaphore, uint64_t value) { return GPUAwaitable{ this, timeline_semaphore, value }; }
+		GPUAwaitable Await(VkFence fence) { return GPUAwaitable{ this, fence }; }
+
+		void Poll(); // Resume the completed waiters on the calling thread
+		// New waiters are picked up within the interval (The thread blocks on the GPU in between, it does not spin)
+		void EnableThread(std::chrono::microseconds interval = std::chrono::microseconds{ 500 });
+		bool IsThreadEnabled() const { return m_thread.joinable(); }
+		size_t GetPendingCount();
+
+	public:
+		CompletionPoller() = delete;
+		CompletionPoller(VulkanContext* vulkan_context);
+		~CompletionPoller(); // Waiters still pending are never resumed (Their frames are leaked)
+		CompletionPoller(const CompletionPoller&) = delete;
+
+	private:
+		friend class GPUAwaitable;
+		struct Waiter
+		{
+			VkSemaphore semaphore;
+			uint64_t value;
+			VkFence fence;
+			std::coroutine_handle<> coroutine;
+		};
+		bool is_complete(VkSemaphore semaphore, uint64_t value, VkFence fence);
+		void enqueue(const Waiter& waiter);
+		std::vector<std::coroutine_handle<>> collect_completed();
+		void work(std::chrono::microseconds interval);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		std::mutex m_mutex;
+		std::vector<Waiter> m_waiters;
+		std::condition_variable m_condition; // Wakes the thread for its first waiter
+		std::thread m_thread;
+		bool m_stop = false;
+	};
+
+	// co_await ResumeOn(worker_pool): Continue the coroutine on a worker (e.g. transcoding between a load and an upload)
+	struct ResumeOn
+	{
+		WorkerPool& worker_pool;
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> coroutine);
+		void await_resume() const noexcept {}
+	};
+
+	// Eagerly started coroutine (co_await it from another coroutine, or Get() from a plain thread)
+	// The frame is destroyed by the last of the task and the finished coroutine, so an unwaited task simply runs to completion.
+	template<typename Result>
+	class Task
+	{
+	public:
+		struct promise_type;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		bool await_ready() const noexcept { return m_coroutine.promise().is_completed(); }
+		bool await_suspend(std::coroutine_handle<> awaiting) noexcept { return m_coroutine.promise().set_continuation(awaiting); }
+		Result await_resume() { return m_coroutine.promise().take(); }
+
+		Result Get() // Blocks the calling thread (Not on a coroutine, use co_await)
+		{
+			m_coroutine.promise().wait();
+			return m_coroutine.promise().take();
+		}
+		bool IsCompleted() const { return m_coroutine.promise().is_completed(); }
+
+	public:
+		Task(Task&& rvalue) noexcept : m_coroutine{ std::exchange(rvalue.m_coroutine, nullptr) } {}
+		Task(const Task&) = delete;
+		~Task() { if (m_coroutine) m_coroutine.promise().release(m_coroutine); }
+
+	private:
+		explicit Task(Handle coroutine) : m_coroutine{ coroutine } {}
+		Handle m_coroutine;
+
+	private:
+		class PromiseBase
+		{
+		public:
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			struct FinalAwaiter
+			{
+				bool await_ready() noexcept { return false; }
+				std::coroutine_handle<> await_suspend(Handle coroutine) noexcept
+				{
+					auto& promise = coroutine.promise();
+					void* continuation = promise.m_continuation.exchange(promise.completed(), std::memory_order_acq_rel);
+					promise.m_continuation.notify_all(); // Get()
+					auto next = continuation ? std::coroutine_handle<>::from_address(continuation) : std::noop_coroutine();
+					promise.release(coroutine); // May destroy the frame, only locals are used from here
+					return next;
+				}
+				void await_resume() noexcept {}
+			};
+			FinalAwaiter final_suspend() noexcept { return {}; }
+			void unhandled_exception() { m_exception = std::current_exception(); }
+
+			bool is_completed() const { return m_continuation.load(std::memory_order_acquire) == completed(); }
+			bool set_continuation(std::coroutine_handle<> awaiting) // False if already completed (Resume immediately)
+			{
+				void* expected = nullptr;
+				return m_continuation.compare_exchange_strong(expected, awaiting.address(), std::memory_order_acq_rel);
+			}
+			void wait() const
+			{
+				for (void* state = m_continuation.load(std::memory_order_acquire); state != completed();
+					state = m_continuation.load(std::memory_order_acquire))
+					m_continuation.wait(state, std::memory_order_acquire);
+			}
+			void release(Handle coroutine) { if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) coroutine.destroy(); }
+
+		protected:
+			void rethrow() { if (m_exception) std::rethrow_exception(m_exception); }
+
+		private:
+			void* completed() const { return const_cast<PromiseBase*>(this); }
+			std::atomic<void*> m_continuation{ nullptr }; // Null: Running, completed(): Completed, otherwise the awaiting coroutine
+			std::atomic<uint32_t> m_references{ 2 }; // Task & Coroutine
+			std::exception_ptr m_exception;
+		};
+
+		template<typename Value>
+		struct ValuePromise : PromiseBase
+		{
+			void return_value(Value value) { m_value.emplace(std::move(value)); }
+			Value take() { this->rethrow(); return std::move(*m_value); }
+			std::optional<Value> m_value;
+		};
+		struct VoidPromise : PromiseBase
+		{
+			void return_void() {}
+			void take() { this->rethrow(); }
+		};
+
+	public:
+		struct promise_type : std::conditional_t<std::is_void_v<Result>, VoidPromise, ValuePromise<std::conditional_t<std::is_void_v<Result>, int, Result>>>
+		{
+			Task get_return_object() { return Task{ Handle::from_promise(*this) }; }
+		};
+	};
+
+}} // namespace Albedo::RHI
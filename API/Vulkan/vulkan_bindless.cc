@@ -0,0 +1,191 @@
+#include "vulkan_bindless.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	static constexpr VkDescriptorType BINDLESS_DESCRIPTOR_TYPES[BindlessHeap::MAX_BINDING_SLOT]
+	{
+		VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_SAMPLER
+	};
+
+	BindlessHeap::BindlessHeap(VulkanContext* vulkan_context) :
+		m_context{ vulkan_context }
+	{
+		const auto& limits = m_context->m_physical_device_properties12;
+		m_slots[SAMPLED_IMAGE].capacity	= std::min(16384u, limits.maxDescriptorSetUpdateAfterBindSampledImages);
+		m_slots[STORAGE_BUFFER].capacity	= std::min(8192u, limits.maxDescriptorSetUpdateAfterBindStorageBuffers);
+		m_slots[SAMPLER].capacity				= std::min(1024u, limits.maxDescriptorSetUpdateAfterBindSamplers);
+
+		std::array<VkDescriptorSetLayoutBinding, MAX_BINDING_SLOT> descriptorSetLayoutBindings;
+		std::array<VkDescriptorBindingFlags, MAX_BINDING_SLOT> descriptorBindingFlags;
+		std::array<VkDescriptorPoolSize, MAX_BINDING_SLOT> descriptorPoolSizes;
+		for (uint32_t binding = 0; binding < MAX_BINDING_SLOT; ++binding)
+		{
+			descriptorSetLayoutBindings[binding] = VkDescriptorSetLayoutBinding
+			{
+				.binding = binding,
+				.descriptorType = BINDLESS_DESCRIPTOR_TYPES[binding],
+				.descriptorCount = m_slots[binding].capacity,
+				.stageFlags = VK_SHADER_STAGE_ALL,
+				.pImmutableSamplers = nullptr
+			};
+			descriptorBindingFlags[binding] =
+				VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+				VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+				VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+			descriptorPoolSizes[binding] = VkDescriptorPoolSize
+			{
+				.type = BINDLESS_DESCRIPTOR_TYPES[binding],
+				.descriptorCount = m_slots[binding].capacity
+			};
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo descriptorSetLayoutBindingFlagsCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+			.bindingCount = static_cast<uint32_t>(descriptorBindingFlags.size()),
+			.pBindingFlags = descriptorBindingFlags.data()
+		};
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.pNext = &descriptorSetLayoutBindingFlagsCreateInfo,
+			.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+			.bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size()),
+			.pBindings = descriptorSetLayoutBindings.data()
+		};
+		if (vkCreateDescriptorSetLayout(
+			m_context->m_device,
+			&descriptorSetLayoutCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_descriptor_set_layout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Bindless Descriptor Set Layout!");
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+			.maxSets = 1,
+			.poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size()),
+			.pPoolSizes = descriptorPoolSizes.data()
+		};
+		if (vkCreateDescriptorPool(
+			m_context->m_device,
+			&descriptorPoolCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_descriptor_pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Bindless Descriptor Pool!");
+
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = m_descriptor_pool,
+			.descriptorSetCount = 1,
+			.pSetLayouts = &m_descriptor_set_layout
+		};
+		if (vkAllocateDescriptorSets(m_context->m_device, &descriptorSetAllocateInfo, &m_descriptor_set) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate the Vulkan Bindless Descriptor Set!");
+		m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_ALLOCATIONS);
+
+		log::info("Created the Bindless Descriptor Heap ({} sampled images, {} storage buffers, {} samplers)",
+			m_slots[SAMPLED_IMAGE].capacity, m_slots[STORAGE_BUFFER].capacity, m_slots[SAMPLER].capacity);
+	}
+
+	BindlessHeap::~BindlessHeap()
+	{
+		vkDestroyDescriptorPool(m_context->m_device, m_descriptor_pool, m_context->m_memory_allocation_callback);
+		vkDestroyDescriptorSetLayout(m_context->m_device, m_descriptor_set_layout, m_context->m_memory_allocation_callback);
+	}
+
+	uint32_t BindlessHeap::
+		RegisterSampledImage(VkImageView image_view, VkImageLayout image_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		VkDescriptorImageInfo descriptorImageInfo
+		{
+			.sampler = VK_NULL_HANDLE,
+			.imageView = image_view,
+			.imageLayout = image_layout
+		};
+		std::scoped_lock guard{ m_mutex };
+		uint32_t index = acquire_slot(SAMPLED_IMAGE);
+		write_descriptor(SAMPLED_IMAGE, index, &descriptorImageInfo, nullptr);
+		return index;
+	}
+
+	uint32_t BindlessHeap::
+		RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset/* = 0*/, VkDeviceSize range/* = VK_WHOLE_SIZE*/)
+	{
+		VkDescriptorBufferInfo descriptorBufferInfo
+		{
+			.buffer = buffer,
+			.offset = offset,
+			.range = range
+		};
+		std::scoped_lock guard{ m_mutex };
+		uint32_t index = acquire_slot(STORAGE_BUFFER);
+		write_descriptor(STORAGE_BUFFER, index, nullptr, &descriptorBufferInfo);
+		return index;
+	}
+
+	uint32_t BindlessHeap::
+		RegisterSampler(VkSampler sampler)
+	{
+		VkDescriptorImageInfo descriptorImageInfo
+		{
+			.sampler = sampler
+		};
+		std::scoped_lock guard{ m_mutex };
+		uint32_t index = acquire_slot(SAMPLER);
+		write_descriptor(SAMPLER, index, &descriptorImageInfo, nullptr);
+		return index;
+	}
+
+	void BindlessHeap::Release(BindingSlot binding, uint32_t index)
+	{
+		std::scoped_lock guard{ m_mutex };
+		assert(index < m_slots[binding].next && "Bindless index has never been registered!");
+		m_slots[binding].free_list.emplace_back(index); // Partially bound - stale descriptors are never accessed
+	}
+
+	void BindlessHeap::Bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout pipeline_layout, uint32_t set)
+	{
+		m_context->m_dispatch.vkCmdBindDescriptorSets(command_buffer, bind_point, pipeline_layout, set, 1, &m_descriptor_set, 0, nullptr);
+	}
+
+	uint32_t BindlessHeap::acquire_slot(BindingSlot binding)
+	{
+		auto& slot = m_slots[binding];
+		if (!slot.free_list.empty())
+		{
+			uint32_t index = slot.free_list.back();
+			slot.free_list.pop_back();
+			return index;
+		}
+		if (slot.next >= slot.capacity)
+			throw std::runtime_error("Failed to register the bindless resource - the Bindless Descriptor Heap is full!");
+		return slot.next++;
+	}
+
+	void BindlessHeap::write_descriptor(BindingSlot binding, uint32_t index,
+		const VkDescriptorImageInfo* image_info, const VkDescriptorBufferInfo* buffer_info)
+	{
+		VkWriteDescriptorSet writeDescriptorSet
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = m_descriptor_set,
+			.dstBinding = binding,
+			.dstArrayElement = index,
+			.descriptorCount = 1,
+			.descriptorType = BINDLESS_DESCRIPTOR_TYPES[binding],
+			.pImageInfo = image_info,
+			.pBufferInfo = buffer_info,
+			.pTexelBufferView = nullptr
+		};
+		vkUpdateDescriptorSets(m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
+		m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES);
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <mutex>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Global update-after-bind & partially-bound descriptor heap (Requires descriptor indexing)
+	// Shaders declare the set as runtime arrays: binding 0 - texture2D[], 1 - StorageBuffer[], 2 - sampler[]
+	class BindlessHeap
+	{
+	public:
+		enum BindingSlot : uint32_t { SAMPLED_IMAGE, STORAGE_BUFFER, SAMPLER, MAX_BINDING_SLOT };
+
+		// Stable indices until released (Thread-safe)
+		uint32_t RegisterSampledImage(VkImageView image_view, VkImageLayout image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		uint32_t RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		uint32_t RegisterSampler(VkSampler sampler);
+		void Release(BindingSlot binding, uint32_t index); // The slot must not be used by in-flight command buffers
+
+		// Bind once per frame (The set index must match the bindless set in your pipeline layouts)
+		void Bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout pipeline_layout, uint32_t set);
+
+		VkDescriptorSetLayout GetDescriptorSetLayout() const { return m_descriptor_set_layout; }
+		VkDescriptorSet GetDescriptorSet() const { return m_descriptor_set; }
+		uint32_t GetCapacity(BindingSlot binding) const { return m_slots[binding].capacity; }
+
+	public:
+		BindlessHeap() = delete;
+		BindlessHeap(VulkanContext* vulkan_context);
+		~BindlessHeap();
+		BindlessHeap(const BindlessHeap&) = delete;
+
+	private:
+		struct SlotAllocator
+		{
+			uint32_t capacity = 0;
+			uint32_t next = 0;
+			std::vector<uint32_t> free_list; // Recycled indices
+		};
+		uint32_t acquire_slot(BindingSlot binding);
+		void write_descriptor(BindingSlot binding, uint32_t index,
+			const VkDescriptorImageInfo* image_info, const VkDescriptorBufferInfo* buffer_info);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		VkDescriptorSetLayout m_descriptor_set_layout = VK_NULL_HANDLE;
+		VkDescriptorPool m_descriptor_pool = VK_NULL_HANDLE;
+		VkDescriptorSet m_descriptor_set = VK_NULL_HANDLE;
+
+		std::mutex m_mutex;
+		std::array<SlotAllocator, MAX_BINDING_SLOT> m_slots;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,95 @@
+#include "vulkan_breadcrumbs.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	CrashBreadcrumbs::CrashBreadcrumbs(VulkanContext* vulkan_context, uint32_t max_markers/* = 4096*/) :
+		m_context{ vulkan_context },
+		m_max_markers{ max_markers },
+		m_slot_markers(max_markers, 0),
+		m_slot_names(max_markers)
+	{
+		assert(max_markers > 0 && "Crash Breadcrumbs need at least one marker!");
+		const size_t bufferSize = sizeof(Marker) * 2 * max_markers;
+		m_marker_buffer = m_context->m_memory_allocator->AllocateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, true, true, true);
+		std::memset(m_marker_buffer->Access(), 0, bufferSize);
+		m_marker_buffer->Flush();
+		if constexpr (EnableDebugMarkers) m_marker_buffer->SetDebugName("Crash Breadcrumbs");
+	}
+
+	CrashBreadcrumbs::Marker CrashBreadcrumbs::Begin(CommandBuffer& command_buffer, std::string_view name)
+	{
+		assert(command_buffer.IsRecording() && "You must Begin() the command buffer before recording breadcrumbs!");
+		Marker marker = m_next_marker.fetch_add(1, std::memory_order_relaxed);
+		if (marker == 0) marker = m_next_marker.fetch_add(1, std::memory_order_relaxed); // Wrapped around
+		const uint32_t slot = marker % m_max_markers;
+		{
+			std::scoped_lock guard{ m_slots_mutex };
+			m_slot_markers[slot] = marker;
+			m_slot_names[slot].assign(name);
+		}
+		write_marker(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot * 2, marker);
+		if (m_context->m_cmd_set_checkpoint) // The marker itself is the checkpoint (No pointer to keep alive)
+			m_context->m_cmd_set_checkpoint(command_buffer, reinterpret_cast<const void*>(static_cast<uintptr_t>(marker)));
+		return marker;
+	}
+
+	void CrashBreadcrumbs::End(CommandBuffer& command_buffer, Marker marker)
+	{
+		assert(command_buffer.IsRecording() && "You must record End() into a recording command buffer!");
+		write_marker(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, (marker % m_max_markers) * 2 + 1, marker);
+	}
+
+	std::string CrashBreadcrumbs::GetReport(std::span<const VkQueue> checkpoint_queues/* = {}*/)
+	{
+		m_marker_buffer->Invalidate();
+		const auto* markers = static_cast<const Marker*>(m_marker_buffer->Access());
+
+		std::scoped_lock guard{ m_slots_mutex };
+		std::string report;
+		Marker lastCompleted = 0;
+		for (uint32_t slot = 0; slot < m_max_markers; ++slot)
+		{
+			const Marker begin = markers[slot * 2], end = markers[slot * 2 + 1];
+			if (begin == 0 || begin != m_slot_markers[slot]) continue; // Never reached by the GPU, or the name was overwritten
+			if (begin != end) report += std::format("  Running: {} (#{})\n", m_slot_names[slot], begin);
+			else if (begin > lastCompleted) lastCompleted = begin;
+		}
+		if (lastCompleted) report += std::format("  Last completed: {} (#{})\n", find_name(lastCompleted), lastCompleted);
+		if (report.empty()) report = "  No pass was running on the GPU\n";
+
+		if (m_context->m_get_queue_checkpoint_data)
+		{
+			for (auto queue : checkpoint_queues)
+			{
+				uint32_t checkpointCount = 0;
+				m_context->m_get_queue_checkpoint_data(queue, &checkpointCount, nullptr);
+				std::vector<VkCheckpointDataNV> checkpoints(checkpointCount, VkCheckpointDataNV{ .sType = VK_STRUCTURE_TYPE_CHECKPOINT_DATA_NV });
+				m_context->m_get_queue_checkpoint_data(queue, &checkpointCount, checkpoints.data());
+				for (const auto& checkpoint : checkpoints)
+				{
+					auto marker = static_cast<Marker>(reinterpret_cast<uintptr_t>(checkpoint.pCheckpointMarker));
+					report += std::format("  Checkpoint of queue {}: {} (#{}) at stage {:#x}\n",
+						static_cast<void*>(queue), find_name(marker), marker, static_cast<uint32_t>(checkpoint.stage));
+				}
+			}
+		}
+		return report;
+	}
+
+	void CrashBreadcrumbs::write_marker(CommandBuffer& command_buffer, VkPipelineStageFlagBits stage, uint32_t slot_offset, Marker marker)
+	{
+		const VkDeviceSize offset = static_cast<VkDeviceSize>(slot_offset) * sizeof(Marker);
+		if (m_context->m_cmd_write_buffer_marker)
+			m_context->m_cmd_write_buffer_marker(command_buffer, stage, *m_marker_buffer, offset, marker);
+		else command_buffer.GetDispatch().vkCmdFillBuffer(command_buffer, *m_marker_buffer, offset, sizeof(Marker), marker); // No barrier (Only ever written by the GPU)
+	}
+
+	std::string_view CrashBreadcrumbs::find_name(Marker marker)
+	{
+		const uint32_t slot = marker % m_max_markers;
+		return (m_slot_markers[slot] == marker) ? std::string_view{ m_slot_names[slot] } : std::string_view{ "<Overwritten>" };
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// GPU Crash Breadcrumbs (VulkanContext::EnableCrashBreadcrumbs()): The GPU writes a marker into a host-visible buffer before and
+	// after every pass, so the passes that were running when the device was lost can be read after VK_ERROR_DEVICE_LOST without a capture.
+	// VK_AMD_buffer_marker writes them at the top and the bottom of the pipe (Also inside render passes), the fallback is vkCmdFillBuffer
+	// (Outside render passes only, ordered with the transfer stage, so it is coarser). VK_NV_device_diagnostic_checkpoints adds the
+	// last checkpoints each queue executed. Two 4-byte writes per pass, cheap enough for shipping builds.
+	class CrashBreadcrumbs
+	{
+	public:
+		using Marker = uint32_t;
+
+		Marker Begin(CommandBuffer& command_buffer, std::string_view name); // Thread-safe
+		void End(CommandBuffer& command_buffer, Marker marker);
+
+		class Scope // Begin() & End() (No-op if breadcrumbs is null, so it can always be recorded)
+		{
+		public:
+			Scope(CrashBreadcrumbs* breadcrumbs, CommandBuffer& command_buffer, std::string_view name) :
+				m_breadcrumbs{ breadcrumbs }, m_command_buffer{ command_buffer }, m_marker{ breadcrumbs ? breadcrumbs->Begin(command_buffer, name) : 0 } {}
+			~Scope() { if (m_breadcrumbs) m_breadcrumbs->End(m_command_buffer, m_marker); }
+			Scope(const Scope&) = delete;
+		private:
+			CrashBreadcrumbs* m_breadcrumbs;
+			CommandBuffer& m_command_buffer;
+			Marker m_marker;
+		};
+
+		// Passes the GPU began but did not end, and the last completed one (Read it after VK_ERROR_DEVICE_LOST, see VulkanContext::OnDeviceLost())
+		std::string GetReport(std::span<const VkQueue> checkpoint_queues = {});
+
+	public:
+		CrashBreadcrumbs() = delete;
+		CrashBreadcrumbs(VulkanContext* vulkan_context, uint32_t max_markers = 4096); // Ring of markers (Older passes are overwritten)
+		CrashBreadcrumbs(const CrashBreadcrumbs&) = delete;
+
+	private:
+		void write_marker(CommandBuffer& command_buffer, VkPipelineStageFlagBits stage, uint32_t slot_offset, Marker marker);
+		std::string_view find_name(Marker marker); // Locked by m_slots_mutex
+
+	private:
+		VulkanContext* const m_context; // Owner
+		const uint32_t m_max_markers;
+		std::shared_ptr<VMA::Buffer> m_marker_buffer; // { Begin, End } Marker per slot
+		std::atomic<Marker> m_next_marker{ 1 }; // 0: Never written
+
+		std::mutex m_slots_mutex;
+		std::vector<Marker> m_slot_markers; // Last recorded marker per slot
+		std::vector<std::string> m_slot_names;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,102 @@
+#include "vulkan_capture.h"
+#include "vulkan_context.h"
+
+#include <fstream>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		// Capture File: [MAGIC][VERSION][LAYOUT HASH][N]{Packets}
+		constexpr uint32_t COMMAND_CAPTURE_FILE_MAGIC = 0x41524343; // "ARCC"
+		constexpr uint32_t COMMAND_CAPTURE_FILE_VERSION = 1;
+		// Packets hold native structs (Same build, like the pipeline trace)
+		constexpr uint64_t COMMAND_CAPTURE_LAYOUT_HASH = HashWords(sizeof(VkImageCreateInfo), sizeof(VkMemoryBarrier2), sizeof(VkViewport),
+			sizeof(VkBufferCopy), sizeof(VkMultiDrawIndexedInfoEXT), static_cast<uint32_t>(CaptureOpcode::MAX_OPCODE), alignof(void*));
+	} // namespace
+
+	void CommandCapture::AddBuffer(VkBuffer buffer, VkDeviceSize size, VkBufferUsageFlags usage)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_stream.Write(CaptureOpcode::CREATE_BUFFER, buffer, size, usage);
+	}
+
+	void CommandCapture::AddImage(VkImage image, const VkImageCreateInfo& create_info)
+	{
+		VkImageCreateInfo imageCreateInfo = create_info;
+		imageCreateInfo.pNext = nullptr;
+		imageCreateInfo.queueFamilyIndexCount = 0;
+		imageCreateInfo.pQueueFamilyIndices = nullptr;
+		std::scoped_lock guard{ m_mutex };
+		m_stream.Write(CaptureOpcode::CREATE_IMAGE, image, imageCreateInfo);
+	}
+
+	void CommandCapture::AddPipeline(VkPipeline pipeline, VkPipelineLayout pipeline_layout, const std::vector<char>& pipeline_record)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_stream.Write(CaptureOpcode::CREATE_PIPELINE, pipeline, pipeline_layout, pipeline_record);
+	}
+
+	void CommandCapture::Submit(const CaptureStream& commands)
+	{
+		auto data = commands.GetData();
+		if (data.empty()) return;
+		std::scoped_lock guard{ m_mutex };
+		m_stream.Write(CaptureOpcode::SUBMIT, data);
+	}
+
+	void CommandCapture::EndFrame()
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_stream.Write(CaptureOpcode::FRAME);
+		++m_frame_count;
+	}
+
+	size_t CommandCapture::GetSize()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_stream.GetSize();
+	}
+
+	uint32_t CommandCapture::GetFrameCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_frame_count;
+	}
+
+	void CommandCapture::Save(std::string_view capture_file)
+	{
+		std::ofstream file(capture_file.data(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the command capture {}!", capture_file));
+
+		auto write = [&file](const auto& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+		std::scoped_lock guard{ m_mutex };
+		auto data = m_stream.GetData();
+		write(COMMAND_CAPTURE_FILE_MAGIC);
+		write(COMMAND_CAPTURE_FILE_VERSION);
+		write(COMMAND_CAPTURE_LAYOUT_HASH);
+		write(static_cast<uint64_t>(data.size()));
+		file.write(data.data(), data.size());
+		if (!file) throw std::runtime_error(std::format("Failed to write the command capture {}!", capture_file));
+		log::info("Saved the command capture {} ({} frames, {} bytes)", capture_file, m_frame_count, data.size());
+	}
+
+	std::vector<char> CommandCapture::Load(std::string_view capture_file)
+	{
+		std::ifstream file(capture_file.data(), std::ios::binary);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the command capture {}!", capture_file));
+
+		auto read = [&file](auto& value) { return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+		uint32_t magic = 0, version = 0;
+		uint64_t layoutHash = 0, size = 0;
+		if (!read(magic) || magic != COMMAND_CAPTURE_FILE_MAGIC || !read(version) || version != COMMAND_CAPTURE_FILE_VERSION ||
+			!read(layoutHash) || layoutHash != COMMAND_CAPTURE_LAYOUT_HASH || !read(size))
+			throw std::runtime_error(std::format("Failed to load the command capture {} - Invalid header or another build!", capture_file));
+		std::vector<char> data(size);
+		if (!file.read(data.data(), data.size()))
+			throw std::runtime_error(std::format("Failed to load the command capture {} - The file is truncated!", capture_file));
+		return data;
+	}
+
+}} // namespace Albedo::RHI
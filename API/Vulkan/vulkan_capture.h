@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+#include <mutex>
+#include <vector>
+#include <string_view>
+#include <stdexcept>
+#include <cstring>
+#include <type_traits>
+
+namespace Albedo {
+namespace RHI
+{
+	// Packets of the captured command stream, handles are identified by their captured values (See CommandCapture)
+	enum class CaptureOpcode : uint8_t
+	{
+		// Definitions (Before their first use, a redefined handle replaces the old one)
+		CREATE_BUFFER,			// VkBuffer, VkDeviceSize size, VkBufferUsageFlags
+		CREATE_IMAGE,				// VkImage, VkImageCreateInfo (Pointers cleared)
+		CREATE_PIPELINE,			// VkPipeline, VkPipelineLayout, [N]{PipelineTrace::Serialize()}
+		// Queue
+		SUBMIT,							// [N]{Commands of one command buffer}
+		FRAME,							// End of a frame (FrameContext::EndFrame())
+		// Commands
+		BIND_PIPELINE,				// VkPipelineBindPoint, VkPipeline
+		BIND_DESCRIPTOR_SETS,	// VkPipelineBindPoint, VkPipelineLayout, first set, [N]{VkDescriptorSet}, [N]{Dynamic offset}
+		BIND_VERTEX_BUFFERS,	// First binding, [N]{VkBuffer}, [N]{VkDeviceSize}
+		BIND_INDEX_BUFFER,		// VkBuffer, VkDeviceSize, VkIndexType
+		PUSH_CONSTANTS,			// VkPipelineLayout, VkShaderStageFlags, offset, [N]{Bytes}
+		DRAW,							// Vertex count, instance count, first vertex, first instance
+		DRAW_INDEXED,				// Index count, instance count, first index, vertex offset, first instance
+		DRAW_INDIRECT,				// VkBuffer, VkDeviceSize, draw count, stride, indexed
+		DRAW_INDIRECT_COUNT,	// VkBuffer, VkDeviceSize, count VkBuffer, count VkDeviceSize, max draw count, stride, indexed
+		DRAW_MULTI,					// Instance count, first instance, [N]{VkMultiDrawInfoEXT}
+		DRAW_MULTI_INDEXED,	// Instance count, first instance, [N]{VkMultiDrawIndexedInfoEXT}
+		DISPATCH,						// Group counts
+		BARRIER,						// VkMemoryBarrier2 (Union of the flushed barriers), barrier count
+		COPY_BUFFER,				// Source VkBuffer, destination VkBuffer, [N]{VkBufferCopy}
+		SET_VIEWPORTS,				// [N]{VkViewport}
+		SET_SCISSORS,				// [N]{VkRect2D}
+		SET_STATE,					// CaptureState, std::array<uint32_t, 5> values
+		BEGIN_RENDERING,			// VkRect2D render area, VkSampleCountFlagBits, [N]{Color VkFormat}, depth VkFormat, stencil VkFormat
+		END_RENDERING,
+		MAX_OPCODE
+	};
+
+	// Extended dynamic states of SET_STATE
+	enum class CaptureState : uint32_t
+	{
+		CULL_MODE, FRONT_FACE, PRIMITIVE_TOPOLOGY, DEPTH_TEST_ENABLE, DEPTH_WRITE_ENABLE, DEPTH_COMPARE_OP, STENCIL_TEST_ENABLE,
+		STENCIL_OP // Faces, fail op, pass op, depth fail op, compare op
+	};
+
+	// Packet: [Opcode][N]{Payload}, payload values are trivially copyable, arrays are [Count]{Elements}
+	class CaptureStream
+	{
+	public:
+		template<typename... Values>
+		void Write(CaptureOpcode opcode, const Values&... values)
+		{
+			m_data.emplace_back(static_cast<char>(opcode));
+			const size_t sizeOffset = m_data.size();
+			m_data.resize(sizeOffset + sizeof(uint32_t));
+			(append(values), ...);
+			const auto size = static_cast<uint32_t>(m_data.size() - sizeOffset - sizeof(uint32_t));
+			memcpy(m_data.data() + sizeOffset, &size, sizeof(size));
+		}
+		bool IsEmpty() const { return m_data.empty(); }
+		size_t GetSize() const { return m_data.size(); }
+		std::span<const char> GetData() const { return m_data; }
+		std::vector<char> Take() { return std::move(m_data); }
+
+	private:
+		template<typename T>
+		void append(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Capture the fields of the struct instead!");
+			auto bytes = reinterpret_cast<const char*>(&value);
+			m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+		}
+		template<typename T>
+		void append(const std::span<const T>& values)
+		{
+			append(static_cast<uint32_t>(values.size()));
+			auto bytes = reinterpret_cast<const char*>(values.data());
+			m_data.insert(m_data.end(), bytes, bytes + values.size_bytes());
+		}
+		template<typename T>
+		void append(const std::vector<T>& values) { append(std::span<const T>{ values }); }
+
+	private:
+		std::vector<char> m_data;
+	};
+
+	class CaptureReader
+	{
+	public:
+		bool IsEnd() const { return m_cursor == m_data.size(); }
+		// Next packet (Throws if the stream is truncated)
+		CaptureOpcode Next(CaptureReader& payload)
+		{
+			auto opcode = Read<CaptureOpcode>();
+			if (opcode >= CaptureOpcode::MAX_OPCODE) throw std::runtime_error("Invalid packet of the command capture!");
+			payload = CaptureReader{ ReadBytes(Read<uint32_t>()) };
+			return opcode;
+		}
+		template<typename T>
+		T Read()
+		{
+			T value;
+			memcpy(&value, ReadBytes(sizeof(T)).data(), sizeof(T));
+			return value;
+		}
+		template<typename T>
+		std::vector<T> ReadArray() // Copied (The stream is not aligned)
+		{
+			auto count = Read<uint32_t>();
+			auto bytes = ReadBytes(count * sizeof(T));
+			std::vector<T> values(count);
+			if (count) memcpy(values.data(), bytes.data(), bytes.size());
+			return values;
+		}
+		std::span<const char> ReadBytes(size_t size)
+		{
+			if (m_cursor + size > m_data.size()) throw std::runtime_error("The command capture is truncated!");
+			auto bytes = m_data.subspan(m_cursor, size);
+			m_cursor += size;
+			return bytes;
+		}
+
+	public:
+		CaptureReader() = default;
+		CaptureReader(std::span<const char> data) : m_data{ data } {}
+
+	private:
+		std::span<const char> m_data;
+		size_t m_cursor = 0;
+	};
+
+	// Command Capture: Records the RHI-level command stream of a workload while attached to the context (VulkanContext::SetCommandCapture()):
+	// Buffers & images allocated by VMA, pipelines with reflected layouts (As PipelineTrace records), the commands of the primary command
+	// buffers in submission order and the frame boundaries. CommandReplay re-executes it headless with timings (AlbedoRHI_replay).
+	// Not captured: Raw vkCmd calls on the handle, secondary command buffers, render pass (VkRenderPass) pipelines, push descriptors,
+	// descriptor buffers, mesh tasks, conditional rendering and resource contents (Replayed on zeroed proxies).
+	// Attach it before the resources are created.
+	class CommandCapture
+	{
+	public:
+		void AddBuffer(VkBuffer buffer, VkDeviceSize size, VkBufferUsageFlags usage);
+		void AddImage(VkImage image, const VkImageCreateInfo& create_info);
+		void AddPipeline(VkPipeline pipeline, VkPipelineLayout pipeline_layout, const std::vector<char>& pipeline_record);
+		void Submit(const CaptureStream& commands); // Commands of one primary command buffer (Once per submission)
+		void EndFrame();
+
+		size_t GetSize(); // Bytes captured so far
+		uint32_t GetFrameCount();
+		void Save(std::string_view capture_file); // Everything captured so far (Keeps capturing)
+		static std::vector<char> Load(std::string_view capture_file); // Packets (Throws if the file is broken or of another build)
+
+	private:
+		std::mutex m_mutex;
+		CaptureStream m_stream;
+		uint32_t m_frame_count = 0;
+	};
+
+}} // namespace Albedo::RHI
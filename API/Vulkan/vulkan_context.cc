@@ -1,56 +1,452 @@
 #include "vulkan_context.h"
 
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <vulkan/vulkan_win32.h>
+#define GLFW_EXPOSE_NATIVE_WIN32
+#include <GLFW/glfw3native.h> // glfwGetWin32Window() (Monitor of the full-screen exclusive mode)
+#endif
+
 namespace Albedo {
 namespace RHI
 {
-	std::vector<uint32_t> VulkanContext::s_debug_message_statistics(MAX_MESSAGE_TYPE, 0);
+	// Prefix of the pipeline cache file (the cache will be discarded if the device or driver changed)
+	struct PipelineCacheFileHeader
+	{
+		static constexpr uint32_t MAGIC = 0x41524843; // "ARHC"
+		static constexpr uint32_t VERSION = 2;
+		uint32_t	magic;
+		uint32_t	version;
+		uint64_t	generation; // Merges by MergePipelineCaches() (0: Saved by a single process)
+		uint32_t	vendor_id;
+		uint32_t	device_id;
+		uint32_t	driver_version;
+		uint8_t		pipeline_cache_uuid[VK_UUID_SIZE];
+		uint64_t	data_size;
+	};
+
+	// Cached winner of the physical device selection (Discarded if the GPUs or the driver changed)
+	struct PhysicalDeviceDecisionFile
+	{
+		static constexpr uint32_t MAGIC = 0x41524844; // "ARHD"
+		uint32_t	magic;
+		uint32_t	physical_device_count;
+		uint32_t	vendor_id;
+		uint32_t	device_id;
+		uint32_t	driver_version;
+		uint8_t		device_uuid[VK_UUID_SIZE];
+		uint64_t	score;
+		// Enumerated capabilities (Informative)
+		uint64_t	device_local_size;
+		uint32_t	queue_family_graphics;
+		uint32_t	queue_family_transfer;
+		uint32_t	queue_family_compute;
+	};
+
+	namespace
+	{
+		std::mutex PIPELINE_CACHE_FILE_MUTEX; // Contexts of identical GPUs save to the same files
+
+		VulkanContext::PhysicalDeviceUUID get_physical_device_uuid(VkPhysicalDevice physical_device)
+		{
+			VkPhysicalDeviceIDProperties idProperties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
+			VkPhysicalDeviceProperties2 properties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &idProperties
+			};
+			vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+			VulkanContext::PhysicalDeviceUUID uuid;
+			std::copy(std::begin(idProperties.deviceUUID), std::end(idProperties.deviceUUID), uuid.begin());
+			return uuid;
+		}
+
+		VkDeviceSize get_device_local_size(VkPhysicalDevice physical_device)
+		{
+			VkPhysicalDeviceMemoryProperties memoryProperties;
+			vkGetPhysicalDeviceMemoryProperties(physical_device, &memoryProperties);
+			VkDeviceSize deviceLocalSize = 0;
+			for (uint32_t idx = 0; idx < memoryProperties.memoryHeapCount; ++idx)
+				if (memoryProperties.memoryHeaps[idx].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+					deviceLocalSize += memoryProperties.memoryHeaps[idx].size;
+			return deviceLocalSize;
+		}
+	} // namespace
 
 	VulkanContext::VulkanContext(GLFWwindow* window) :
-		m_window{ window }
+		m_window{ window },
+		m_context_id{ [] { static std::atomic<uint64_t> contextCount{ 0 }; return ++contextCount; }() }
 	{
 		// Please create Vulkan Context via VulkanContext::Create()
 	}
 
 	VulkanContext::~VulkanContext()
 	{
-		destroy_swap_chain();
-		destroy_memory_allocator();
-		destroy_logical_device();
+		destroy_completion_poller(); // Its thread resumes coroutines on the workers
+		destroy_worker_pool(); // Join workers before destroying anything they may use
+		if (m_device != VK_NULL_HANDLE) // Skipped if no suitable GPU was found (CreateHeadlessGroup())
+		{
+			destroy_swap_chain();
+			destroy_upload_engine();
+			destroy_bindless_heap();
+			destroy_shader_cache();
+			destroy_pipeline_cache();
+			destroy_resource_registry(); // Drops the registered resources into the deletion queue
+			m_crash_breadcrumbs.reset();
+			destroy_deletion_queue(); // Deferred deletions may still need the allocator
+			destroy_memory_allocator();
+			destroy_sync_pool(); // Semaphores & fences released by the deletion queue return here
+			destroy_logical_device();
+		}
 		destroy_surface();
-		destroy_debug_messenger();
 		destroy_vulkan_instance();
 	}
 
-	void  VulkanContext::PresentSwapChain(const std::vector<VkSemaphore>& wait_semaphores) throw (swapchain_error)
+	VulkanContext::SharedInstance::~SharedInstance()
+	{
+		if (debug_messenger != VK_NULL_HANDLE)
+		{
+			auto loadFunction = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+			if (loadFunction != nullptr) loadFunction(instance, debug_messenger, allocation_callbacks);
+			else log::warn("Failed to load function: vkDestroyDebugUtilsMessengerEXT"); // Destructors must not throw
+		}
+		if (debug_message_queue)
+		{
+			debug_message_queue->Flush();
+			auto statistics = debug_message_queue->GetStatistics();
+			log::warn("\n[Vulkan Messenger Statistics]");
+			constexpr std::array<const char*, DebugMessageQueue::MAX_SEVERITY> SEVERITY_NAMES{ "VERBOSE", "INFO", "WARN", "ERROR" }; // <windows.h> defines ERROR
+			for (uint32_t severity = 0; severity < DebugMessageQueue::MAX_SEVERITY; ++severity)
+				log::info("{}: {}", SEVERITY_NAMES[severity], statistics.messages[severity]);
+			log::info("Suppressed: {}, Dropped: {}", statistics.suppressed, statistics.dropped);
+		}
+		vkDestroyInstance(instance, allocation_callbacks);
+	}
+
+	void  VulkanContext::PresentSwapChain(std::span<const VkSemaphore> wait_semaphores) throw (swapchain_error)
+	{
+		PresentSwapChains({}, wait_semaphores);
+	}
+
+	void VulkanContext::PresentSwapChains(std::span<WindowSwapChain* const> windows, std::span<const VkSemaphore> wait_semaphores)
+		throw (swapchain_error)
 	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::PresentSwapChain");
+		RHIStatistics::CPUTimer presentTimer{ m_statistics, RHIStatistics::PRESENT_CPU_NS };
+		if (IsHeadless())
+		{
+			// Nothing to present, only consume the render finished semaphores
+			assert(windows.empty() && "Headless contexts have no windows!");
+			InlineVector<SemaphoreWaitInfo, 8> waitInfos;
+			for (auto wait_semaphore : wait_semaphores) waitInfos.emplace_back(SemaphoreWaitInfo{ .semaphore = wait_semaphore, .stages = 0 });
+			GetGlobalQueueTimeline(m_device_queue_family_graphics)->Submit({}, waitInfos);
+			return;
+		}
+
+		// The main swap chain first, then the acquired windows
+		InlineVector<VkSwapchainKHR, 8> swapchains;
+		InlineVector<uint32_t, 8> imageIndices;
+		InlineVector<WindowSwapChain*, 8> presentedWindows;
+		InlineVector<const PresentOwnershipTransfer*, 8> transfers;
+		swapchains.emplace_back(m_swapchain);
+		imageIndices.emplace_back(m_swapchain_current_image_index);
+		transfers.emplace_back(m_present_ownership_transfer ? &*m_present_ownership_transfer : nullptr);
+		for (auto window : windows)
+		{
+			if (!window->m_is_acquired) continue;
+			window->m_is_acquired = false;
+			swapchains.emplace_back(window->m_swapchain);
+			imageIndices.emplace_back(window->m_image_index);
+			presentedWindows.emplace_back(window);
+			transfers.emplace_back(window->m_present_ownership_transfer ? &*window->m_present_ownership_transfer : nullptr);
+		}
+		const auto swapchainCount = static_cast<uint32_t>(swapchains.size());
+		InlineVector<VkResult, 8> results;
+		InlineVector<uint64_t, 8> presentIds; // 0: Untagged (Windows are not paced)
+		for (uint32_t index = 0; index < swapchainCount; ++index)
+		{
+			results.emplace_back(VK_SUCCESS);
+			presentIds.emplace_back(0);
+		}
 		VkPresentInfoKHR presentInfo
 		{
 			.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 			.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size()),
 			.pWaitSemaphores = wait_semaphores.data(),
-			.swapchainCount = 1,
-			.pSwapchains = &m_swapchain,
-			.pImageIndices = &m_swapchain_current_image_index,
-			.pResults = nullptr // It is not necessary if you are only using a single swap chain
-		};
-		static VkQueue present_queue = GetQueue(m_device_queue_family_present);
-		auto result = vkQueuePresentKHR(present_queue, &presentInfo);
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+			.swapchainCount = swapchainCount,
+			.pSwapchains = swapchains.data(),
+			.pImageIndices = imageIndices.data(),
+			.pResults = (swapchainCount > 1)? results.data() : nullptr // The return value is the result of a single swap chain
+		};
+
+		VkPresentIdKHR presentIdInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+			.swapchainCount = swapchainCount,
+			.pPresentIds = presentIds.data()
+		};
+		if (m_frame_pacer)
+		{
+			presentIds[0] = m_frame_pacer->OnPresent();
+			presentInfo.pNext = &presentIdInfo;
+		}
+		InlineVector<VkSemaphore, 8> acquiredSemaphores;
+		if (m_device_queue_family_graphics != m_device_queue_family_present)
+		{
+			// Release on the graphics queue after rendering, acquire on the present queue, and present after the acquisition
+			// (One submission per queue for all swap chains)
+			InlineVector<VkCommandBuffer, 8> releaseCommands, acquireCommands;
+			InlineVector<VkSemaphore, 8> releasedSemaphores;
+			InlineVector<SemaphoreWaitInfo, 8> releasedInfos;
+			for (uint32_t index = 0; index < swapchainCount; ++index)
+			{
+				auto& transfer = *transfers[index];
+				const uint32_t imageIndex = imageIndices[index];
+				releaseCommands.emplace_back(transfer.release_commands[imageIndex]);
+				acquireCommands.emplace_back(transfer.acquire_commands[imageIndex]);
+				releasedSemaphores.emplace_back(transfer.released_semaphores[imageIndex]);
+				releasedInfos.emplace_back(SemaphoreWaitInfo{ .semaphore = transfer.released_semaphores[imageIndex], .stages = 0 });
+				acquiredSemaphores.emplace_back(transfer.acquired_semaphores[imageIndex]);
+			}
+			InlineVector<SemaphoreWaitInfo, 8> waitInfos;
+			for (auto wait_semaphore : wait_semaphores)
+				waitInfos.emplace_back(SemaphoreWaitInfo{ .semaphore = wait_semaphore, .stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT });
+			GetGlobalQueueTimeline(m_device_queue_family_graphics)->Submit(releaseCommands, waitInfos, releasedSemaphores);
+			GetGlobalQueueTimeline(m_device_queue_family_present)->Submit(acquireCommands, releasedInfos, acquiredSemaphores);
+			presentInfo.waitSemaphoreCount = static_cast<uint32_t>(acquiredSemaphores.size());
+			presentInfo.pWaitSemaphores = acquiredSemaphores.data();
+		}
+		// Maintenance1: The present mode of every swap chain (Switched without recreation) and a fence for the main one
+		InlineVector<VkPresentModeKHR, 8> presentModes;
+		InlineVector<VkFence, 8> presentFences;
+		VkSwapchainPresentModeInfoEXT presentModeInfo{ .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODE_INFO_EXT };
+		VkSwapchainPresentFenceInfoEXT presentFenceInfo{ .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT };
+		if (IsSwapchainMaintenance1Supported())
+		{
+			collect_present_fences();
+			presentModes.emplace_back(m_swapchain_present_mode);
+			presentFences.emplace_back(GetSyncPool().AcquireFence());
+			for (auto window : presentedWindows)
+			{
+				presentModes.emplace_back(window->m_present_mode);
+				presentFences.emplace_back(VK_NULL_HANDLE);
+			}
+			presentModeInfo.pNext = presentInfo.pNext;
+			presentModeInfo.swapchainCount = swapchainCount;
+			presentModeInfo.pPresentModes = presentModes.data();
+			presentFenceInfo.pNext = &presentModeInfo;
+			presentFenceInfo.swapchainCount = swapchainCount;
+			presentFenceInfo.pFences = presentFences.data();
+			presentInfo.pNext = &presentFenceInfo;
+		}
+		{
+			// Render finished semaphores may be signaled by packets still queued for other submission threads
+			std::scoped_lock guard{ m_global_queue_timelines_mutex };
+			for (auto& [key, queue_timeline] : m_global_queue_timelines) queue_timeline->Flush();
+		}
+		auto result = GetGlobalQueueTimeline(m_device_queue_family_present)->Present(presentInfo);
+		m_swapchain_image_acquired = false;
+		if (result == VK_ERROR_DEVICE_LOST)
+		{
+			OnDeviceLost();
+			throw std::runtime_error("Failed to present the Vulkan Swap Chain - the device was lost!");
+		}
+		if (!presentFences.empty())
+		{
+			// Out-of-date presents are still queued operations (Their fences are signaled as well)
+			const VkResult mainResult = (swapchainCount > 1)? results[0] : result;
+			if (mainResult == VK_SUCCESS || mainResult == VK_SUBOPTIMAL_KHR || mainResult == VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				std::scoped_lock guard{ m_present_fences_mutex };
+				m_present_fences.emplace_back(PresentFence{ .present_index = m_present_count, .fence = presentFences[0], .swapchain = m_swapchain });
+			}
+		}
+		++m_present_count;
+		if (swapchainCount > 1)
+		{
+			// Out-of-date windows are recreated by their next acquisition, the main swap chain by the caller
+			for (uint32_t index = 1; index < swapchainCount; ++index)
+			{
+				if (results[index] == VK_ERROR_OUT_OF_DATE_KHR || results[index] == VK_SUBOPTIMAL_KHR)
+					presentedWindows[index - 1]->m_is_out_of_date = true;
+				else if (results[index] != VK_SUCCESS)
+					throw std::runtime_error("Failed to present the Vulkan Window Swap Chain!");
+			}
+			result = results[0];
+		}
+		// A lost full-screen exclusive mode is acquired again by the recreation
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT)
 			throw swapchain_error();
 		else if (result != VK_SUCCESS)
 			throw std::runtime_error("Failed to present the Vulkan Swap Chain!");
 	}
 
-	void VulkanContext::RecreateSwapChain()
+	std::shared_ptr<WindowSwapChain> VulkanContext::CreateWindowSwapChain(GLFWwindow* window)
+	{
+		if (IsHeadless()) throw std::runtime_error("Failed to create the Window Swap Chain - Headless contexts have no present queue!");
+		return std::make_shared<WindowSwapChain>(shared_from_this(), window);
+	}
+
+	void VulkanContext::AcquireSwapChains(std::span<WindowSwapChain* const> windows, std::span<const VkSemaphore> semaphores,
+		uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AcquireSwapChains");
+		assert(windows.size() == semaphores.size() && "One semaphore per window!");
+		for (auto window : windows) if (window->m_is_out_of_date) window->Recreate(); // Not concurrently with the present queue
+
+		// Each swap chain is externally synchronized on its own, so the acquisitions only block their own job
+		std::vector<std::future<bool>> acquisitions;
+		for (size_t index = 1; index < windows.size(); ++index)
+			acquisitions.emplace_back(GetWorkerPool().Submit([window = windows[index], semaphore = semaphores[index], timeout]()
+				{ return window->acquire(semaphore, timeout); }));
+		std::exception_ptr error;
+		try { if (!windows.empty()) windows[0]->acquire(semaphores[0], timeout); } // On this thread
+		catch (...) { error = std::current_exception(); }
+		for (auto& acquisition : acquisitions) // The jobs reference the windows
+		{
+			try { GetWorkerPool().Wait(acquisition); }
+			catch (...) { if (!error) error = std::current_exception(); }
+		}
+		if (error) std::rethrow_exception(error);
+	}
+
+	void VulkanContext::EnableFramePacing(uint32_t max_queued_frames/* = 1*/, double safety_margin/* = 1.0*/)
+	{
+		if (!IsFramePacingSupported())
+		{
+			log::warn("Frame pacing is disabled - the GPU does not support {} and {}", VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+			return;
+		}
+		m_frame_pacer = std::make_unique<FramePacer>(this, max_queued_frames, safety_margin);
+	}
+
+	void VulkanContext::EnableCrashBreadcrumbs(uint32_t max_markers/* = 4096*/)
+	{
+		if (!m_buffer_marker_supported)
+			log::warn("Crash breadcrumbs fall back to vkCmdFillBuffer - the GPU does not support {} (Passes are ordered with the transfer stage only)", VK_AMD_BUFFER_MARKER_EXTENSION_NAME);
+		m_crash_breadcrumbs = std::make_unique<CrashBreadcrumbs>(this, max_markers);
+	}
+
+	void VulkanContext::OnDeviceLost()
+	{
+		if (m_device_lost.exchange(true)) return; // Report once (Every later submission fails as well)
+		log::error("[Vulkan Device Lost]");
+		if (!m_crash_breadcrumbs)
+		{
+			log::error("  No breadcrumbs - call VulkanContext::EnableCrashBreadcrumbs() to find the pass that crashed");
+			return;
+		}
+
+		// The device lost may be reported under the lock (e.g. Flush() in PresentSwapChain()), skip the checkpoints then
+		std::vector<VkQueue> queues;
+		if (std::unique_lock guard{ m_global_queue_timelines_mutex, std::try_to_lock }; guard.owns_lock())
+			for (auto& [key, queue_timeline] : m_global_queue_timelines) queues.emplace_back(queue_timeline->GetQueue());
+		log::error("{}", m_crash_breadcrumbs->GetReport(queues));
+	}
+
+	SwapchainConfig SwapchainConfig::FromPreset(Preset preset)
+	{
+		switch (preset)
+		{
+		case LOW_LATENCY: return SwapchainConfig
+		{
+			.present_modes{ VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR },
+			.extra_image_count = 1
+		};
+		case THROUGHPUT: return SwapchainConfig
+		{
+			.present_modes{ VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR },
+			.extra_image_count = 2
+		};
+		case POWER_SAVE: return SwapchainConfig
+		{
+			.present_modes{ VK_PRESENT_MODE_FIFO_KHR },
+			.extra_image_count = 0
+		};
+		default: throw std::runtime_error("Failed to create the Swap Chain Config - Unknown preset!");
+		}
+	}
+
+	void VulkanContext::SetSwapChainConfig(const SwapchainConfig& config)
+	{
+		const bool isPresentModeOnly = config.extra_image_count == m_swapchain_config.extra_image_count &&
+			config.depth_formats == m_swapchain_config.depth_formats;
+		m_swapchain_config = config;
+		if (isPresentModeOnly && !m_swapchain_present_modes.empty())
+		{
+			// Maintenance1: Switched by the next present if the swap chain was created compatible with it
+			auto presentMode = std::find_first_of(config.present_modes.begin(), config.present_modes.end(),
+				m_surface_present_modes.begin(), m_surface_present_modes.end());
+			if (presentMode != config.present_modes.end() &&
+				std::find(m_swapchain_present_modes.begin(), m_swapchain_present_modes.end(), *presentMode) != m_swapchain_present_modes.end())
+			{
+				if (*presentMode != m_swapchain_present_mode)
+					log::info("Swap Chain present mode: {} (Without recreation)", static_cast<int>(*presentMode));
+				m_swapchain_present_mode = *presentMode;
+				return;
+			}
+		}
+		RecreateSwapChain();
+	}
+
+	bool VulkanContext::ReleaseSwapChainImage()
+	{
+		if (!m_swapchain_image_acquired || !IsSwapchainMaintenance1Supported()) return false;
+		const VkReleaseSwapchainImagesInfoEXT releaseInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_RELEASE_SWAPCHAIN_IMAGES_INFO_EXT,
+			.swapchain = m_swapchain,
+			.imageIndexCount = 1,
+			.pImageIndices = &m_swapchain_current_image_index
+		};
+		if (m_release_swapchain_images(m_device, &releaseInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to release the image of the Vulkan Swap Chain!");
+		m_swapchain_image_acquired = false;
+		return true;
+	}
+
+	void VulkanContext::WaitPresent(uint64_t present_index)
+	{
+		std::scoped_lock guard{ m_present_fences_mutex };
+		InlineVector<VkFence, 8> fences;
+		for (const auto& present_fence : m_present_fences)
+		{
+			if (present_fence.present_index > present_index) break;
+			fences.emplace_back(present_fence.fence);
+		}
+		if (fences.empty()) return;
+		vkWaitForFences(m_device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+		for (size_t index = 0; index < fences.size(); ++index)
+		{
+			GetSyncPool().ReleaseFence(m_present_fences.front().fence);
+			m_present_fences.pop_front();
+		}
+	}
+
+	void VulkanContext::collect_present_fences()
 	{
-		static bool RECREATING = false;
-		if (RECREATING) return;
+		std::scoped_lock guard{ m_present_fences_mutex };
+		while (!m_present_fences.empty() && vkGetFenceStatus(m_device, m_present_fences.front().fence) == VK_SUCCESS)
+		{
+			GetSyncPool().ReleaseFence(m_present_fences.front().fence);
+			m_present_fences.pop_front();
+		}
+	}
 
-		WaitDeviceIdle();
-		RECREATING = true;
-		destroy_swap_chain();
-		create_swap_chain();
-		RECREATING = false;
+	void VulkanContext::RecreateSwapChain()
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::RecreateSwapChain");
+		// Skip nested (e.g. resize callbacks during glfwWaitEvents()) and concurrent recreations
+		if (m_swapchain_recreating.exchange(true)) return;
+		try { create_swap_chain(); } // The old swap chain is retired inside, frames in flight keep running
+		catch (...) { m_swapchain_recreating = false; throw; }
+		m_swapchain_recreating = false;
 	}
 
 	std::shared_ptr<CommandBuffer> VulkanContext::
@@ -72,9 +468,9 @@ namespace RHI
 	}
 
 	void VulkanContext::Screenshot(
-		std::shared_ptr<VMA::Image> screenshot, 
-		std::vector<VkSemaphore> wait_semaphores/* = {}*/, 
-		std::vector<VkSemaphore> signal_semaphores/* = {}*/, 
+		VMA::Image& screenshot,
+		std::span<const VkSemaphore> wait_semaphores/* = {}*/,
+		std::span<const VkSemaphore> signal_semaphores/* = {}*/,
 		VkFence fence/* = nullptr*/)
 	{
 		auto& extent = m_swapchain_current_extent;
@@ -91,14 +487,16 @@ namespace RHI
 				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 				.layerCount = 1
 			},
-			.dstOffsets = {{0,0,0}, {(int32_t)screenshot->Width() , (int32_t)screenshot->Height() , 1}} // Boundary
+			.dstOffsets = {{0,0,0}, {(int32_t)screenshot.Width() , (int32_t)screenshot.Height() , 1}} // Boundary
 		};
 
-		VkImageMemoryBarrier barrier_present_to_transfer
+		VkImageMemoryBarrier2 barrier_present_to_transfer
 		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT,
-			.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, // Previous frames
+			.srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT,
+			.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
 			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -114,11 +512,13 @@ namespace RHI
 			}
 		};
 
-		VkImageMemoryBarrier barrier_transfer_to_present
+		VkImageMemoryBarrier2 barrier_transfer_to_present
 		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-			.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT,
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT,
+			.srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_NONE, // Presentation waits on semaphores
+			.dstAccessMask = VK_ACCESS_2_NONE,
 			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 			.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -136,45 +536,50 @@ namespace RHI
 
 		auto commandBuffer = CreateOneTimeCommandBuffer(m_device_queue_family_graphics);
 		commandBuffer->Begin();
-		vkCmdPipelineBarrier(
-			*commandBuffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			0x0,				// Dependency Flags
-			0, nullptr,	// Memory Barrier
-			0, nullptr,	// Buffer Memory Barrier
-			1, &barrier_present_to_transfer);
-		auto oldLayout = screenshot->GetImageLayout();
-		screenshot->TransitionLayoutCommand(commandBuffer,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-		vkCmdBlitImage(*commandBuffer,
+		auto oldLayout = screenshot.GetImageLayout();
+		const ResourceAccess blitDestination{ VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+		commandBuffer->QueueBarrier(barrier_present_to_transfer);
+		screenshot.TransitionCommand(*commandBuffer, blitDestination); // One barrier command for both images
+
+		commandBuffer->FlushBarriers();
+		commandBuffer->GetDispatch().vkCmdBlitImage(*commandBuffer,
 			m_swapchain_images[m_swapchain_current_image_index],
 			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			*screenshot,
-			screenshot->GetImageLayout(),
+			screenshot,
+			screenshot.GetImageLayout(),
 			1, &blitRegion, VK_FILTER_LINEAR);
 
-		screenshot->TransitionLayoutCommand(commandBuffer, oldLayout);
-
-		vkCmdPipelineBarrier(
-			*commandBuffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			0x0,				// Dependency Flags
-			0, nullptr,	// Memory Barrier
-			0, nullptr,	// Buffer Memory Barrier
-			1, &barrier_transfer_to_present);
+		screenshot.TransitionLayoutCommand(*commandBuffer, oldLayout);
+		commandBuffer->QueueBarrier(barrier_transfer_to_present);
 		commandBuffer->End();
 		commandBuffer->Submit(true, fence, wait_semaphores, signal_semaphores,
-			VK_PIPELINE_STAGE_TRANSFER_BIT);
+			VK_PIPELINE_STAGE_2_BLIT_BIT);
 	}
 
 	void VulkanContext::NextSwapChainImageIndex(VkSemaphore semaphore, VkFence fence, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
 		throw (swapchain_error)
 	{
-		auto result = vkAcquireNextImageKHR(m_device, m_swapchain, timeout, semaphore, fence, &m_swapchain_current_image_index);
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+		if (IsHeadless())
+		{
+			// Round-robin the offscreen ring, the frame fence guarantees the image is not in use anymore
+			m_swapchain_current_image_index = (m_swapchain_current_image_index + 1) % m_swapchain_image_count;
+			std::vector<VkSemaphore> signalSemaphores;
+			if (semaphore != VK_NULL_HANDLE) signalSemaphores.emplace_back(semaphore);
+			if (!signalSemaphores.empty() || fence != VK_NULL_HANDLE)
+				GetGlobalQueueTimeline(m_device_queue_family_graphics)->Submit({}, {}, signalSemaphores, fence);
+			return;
+		}
+		if (m_swapchain_suspended)
+		{
+			RecreateSwapChain(); // Resumed once the window has an area again
+			if (m_swapchain_suspended) throw swapchain_suspended();
+		}
+		if (m_frame_pacer) m_frame_pacer->Pace(); // Sample input as late as possible
+		auto result = m_dispatch.vkAcquireNextImageKHR(m_device, m_swapchain, timeout, semaphore, fence, &m_swapchain_current_image_index);
+		// Suboptimal images are acquired (The semaphore is signaled): With maintenance1 it is presented and recreated after the present
+		if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) m_swapchain_image_acquired = true;
+		if (result == VK_SUBOPTIMAL_KHR && IsSwapchainMaintenance1Supported()) return;
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT)
 			throw swapchain_error();
 		else if (result != VK_SUCCESS)
 			throw std::runtime_error("Failed to retrive the next image of the Vulkan Swap Chain!");
@@ -206,19 +611,88 @@ namespace RHI
 		}
 	}
 
+	void VulkanContext::create_worker_pool(uint32_t worker_count)
+	{
+		if (!worker_count) worker_count = std::max(2U, std::thread::hardware_concurrency()) - 1; // Leave one core to the caller (0: Unknown)
+		m_worker_pool = std::make_unique<WorkerPool>(worker_count);
+		log::info("Created the RHI Worker Pool with {} workers", worker_count);
+	}
+
+	void VulkanContext::register_worker_threads()
+	{
+		for (auto worker_thread_id : m_worker_pool->GetWorkerThreadIDs())
+		{
+			for (auto* queue_family : { &m_device_queue_family_graphics, &m_device_queue_family_compute, &m_device_queue_family_transfer })
+			{
+				if (!queue_family->has_value()) continue;
+				GetGlobalOneTimeCommandPool(*queue_family, worker_thread_id);
+				GetGlobalResetableCommandPool(*queue_family, worker_thread_id);
+			}
+			GetGlobalDescriptorAllocator(worker_thread_id);
+		}
+	}
+
 	void VulkanContext::create_vulkan_instance()
 	{
+		const bool enableDisplay = !IsHeadless() && m_surface_config.mode == SurfaceConfig::DIRECT_DISPLAY;
+		const bool requireSurfaceCapabilities2 = !IsHeadless() && m_surface_config.mode == SurfaceConfig::FULL_SCREEN_EXCLUSIVE;
+
+		// Reuse the instance of the other contexts (A windowed context needs the surface extensions, and those of its surface mode)
+		if (auto sharedInstance = SHARED_INSTANCE.lock(); sharedInstance && (IsHeadless() ||
+			(sharedInstance->wsi && (!enableDisplay || sharedInstance->display) && (!requireSurfaceCapabilities2 || sharedInstance->surface_capabilities2))))
+		{
+			m_shared_instance = std::move(sharedInstance);
+			m_instance = m_shared_instance->instance;
+			return;
+		}
+
 		// Extensions
 		std::vector<const char*> requiredExtensions;
 		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount); // Include WSI extensions
+		const char** glfwExtensions = nullptr;
+		if (!IsHeadless()) glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount); // Include WSI extensions
 		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 		if (EnableValidationLayers)
 		{
 			extensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 			extensions.emplace_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 		}
+		uint32_t extensionCount = 0;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+		auto is_instance_extension_available = [&availableExtensions](const char* extension_name)
+		{
+			return std::any_of(availableExtensions.begin(), availableExtensions.end(),
+				[extension_name](const VkExtensionProperties& extension) { return strcmp(extension.extensionName, extension_name) == 0; });
+		};
+		bool enableDebugUtils = EnableValidationLayers;
+		if (EnableDebugMarkers && !enableDebugUtils)
+		{
+			// Labels in shipping builds (Only if the loader or a capture layer provides it)
+			enableDebugUtils = is_instance_extension_available(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			if (enableDebugUtils) extensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			else log::warn("Debug markers are enabled but {} is not available!", VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+		}
+		// Required by VK_EXT_swapchain_maintenance1 (Optional)
+		const bool enableSurfaceMaintenance1 = !IsHeadless() &&
+			is_instance_extension_available(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME) &&
+			is_instance_extension_available(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+		if (enableSurfaceMaintenance1)
+		{
+			extensions.emplace_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+			extensions.emplace_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+		}
+		// Required by VK_EXT_full_screen_exclusive (Windowed presentation without it)
+		const bool enableSurfaceCapabilities2 = enableSurfaceMaintenance1 ||
+			(requireSurfaceCapabilities2 && is_instance_extension_available(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME));
+		if (enableSurfaceCapabilities2 && !enableSurfaceMaintenance1) extensions.emplace_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+		if (enableDisplay)
+		{
+			if (!is_instance_extension_available(VK_KHR_DISPLAY_EXTENSION_NAME))
+				throw std::runtime_error(std::format("Failed to create the VkInstance - {} is not available for the direct display!", VK_KHR_DISPLAY_EXTENSION_NAME));
+			extensions.emplace_back(VK_KHR_DISPLAY_EXTENSION_NAME);
+		}
 
 		// Instance
 		VkApplicationInfo appInfo
@@ -252,21 +726,39 @@ namespace RHI
 			instanceCreateInfo.pNext = nullptr;
 		}
 
-		if (vkCreateInstance(&instanceCreateInfo, nullptr, &m_instance) != VK_SUCCESS)
+		if (vkCreateInstance(&instanceCreateInfo, m_memory_allocation_callback, &m_instance) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create the VkInstance");
+
+		if (EnableDebugMarkers && enableDebugUtils) DebugUtils::Load(m_instance);
+
+		m_shared_instance = std::make_shared<SharedInstance>();
+		m_shared_instance->instance = m_instance;
+		m_shared_instance->allocation_callbacks = m_memory_allocation_callback;
+		m_shared_instance->wsi = !IsHeadless();
+		m_shared_instance->surface_maintenance1 = enableSurfaceMaintenance1;
+		m_shared_instance->surface_capabilities2 = enableSurfaceCapabilities2;
+		m_shared_instance->display = enableDisplay;
+		SHARED_INSTANCE = m_shared_instance; // A headless instance is replaced by the first windowed one
 	}
 
 	void VulkanContext::create_debug_messenger()
 	{
 		if (!EnableValidationLayers) return;
+		if (m_shared_instance->debug_messenger != VK_NULL_HANDLE)
+		{
+			m_debug_messenger = m_shared_instance->debug_messenger;
+			return;
+		}
 
-		auto messengerCreateInfo = VulkanContext::GetDefaultDebuggerMessengerCreateInfo();
+		m_shared_instance->debug_message_queue = std::make_unique<DebugMessageQueue>();
+		auto messengerCreateInfo = VulkanContext::GetDefaultDebuggerMessengerCreateInfo(m_shared_instance->debug_message_queue.get());
 		auto loadedFunction = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(m_instance, "vkCreateDebugUtilsMessengerEXT");
 		if (loadedFunction == nullptr ||
-			loadedFunction(m_instance, &messengerCreateInfo, nullptr, &m_debug_messenger) != VK_SUCCESS)
+			loadedFunction(m_instance, &messengerCreateInfo, m_shared_instance->allocation_callbacks, &m_debug_messenger) != VK_SUCCESS)
 		{
 			throw std::runtime_error("Failed to create the Vulkan Debug Messenger!");
 		}
+		m_shared_instance->debug_messenger = m_debug_messenger;
 	}
 
 	void VulkanContext::create_surface()
@@ -275,6 +767,8 @@ namespace RHI
 		*  The window surface needs to be created right after the instance creation,
 		*  because it can actually influence the physical device selection.
 		*/
+		if (IsHeadless()) return;
+		if (m_surface_config.mode == SurfaceConfig::DIRECT_DISPLAY) return create_display_surface();
 		if (glfwCreateWindowSurface(
 			m_instance,
 			m_window,
@@ -283,6 +777,82 @@ namespace RHI
 			throw std::runtime_error("Failed to create the Vulkan Window Surface!");
 	}
 
+	void VulkanContext::create_display_surface()
+	{
+		// The surface belongs to the GPU driving the display (The caller's GPU or the first one with enough displays)
+		uint32_t phyDevCnt = 0;
+		vkEnumeratePhysicalDevices(m_instance, &phyDevCnt, nullptr);
+		std::vector<VkPhysicalDevice> physicalDevices(phyDevCnt);
+		vkEnumeratePhysicalDevices(m_instance, &phyDevCnt, physicalDevices.data());
+		if (m_physical_device != VK_NULL_HANDLE) physicalDevices = { m_physical_device };
+
+		std::vector<VkDisplayPropertiesKHR> displays;
+		for (auto physicalDevice : physicalDevices)
+		{
+			uint32_t displayCount = 0;
+			vkGetPhysicalDeviceDisplayPropertiesKHR(physicalDevice, &displayCount, nullptr);
+			if (displayCount <= m_surface_config.display_index) continue;
+			displays.resize(displayCount);
+			vkGetPhysicalDeviceDisplayPropertiesKHR(physicalDevice, &displayCount, displays.data());
+			m_physical_device = physicalDevice;
+			break;
+		}
+		if (displays.empty())
+			throw std::runtime_error(std::format("Failed to create the Vulkan Display Surface - Display {} is not found!", m_surface_config.display_index));
+		const auto& display = displays[m_surface_config.display_index];
+
+		// Native resolution at the highest refresh rate (The largest mode if none is native)
+		uint32_t modeCount = 0;
+		vkGetDisplayModePropertiesKHR(m_physical_device, display.display, &modeCount, nullptr);
+		std::vector<VkDisplayModePropertiesKHR> modes(modeCount);
+		vkGetDisplayModePropertiesKHR(m_physical_device, display.display, &modeCount, modes.data());
+		if (modes.empty()) throw std::runtime_error("Failed to create the Vulkan Display Surface - The display has no modes!");
+		auto rank = [&](const VkDisplayModePropertiesKHR& mode)
+		{
+			const auto& region = mode.parameters.visibleRegion;
+			const bool isNative = region.width == display.physicalResolution.width && region.height == display.physicalResolution.height;
+			return std::make_tuple(isNative, uint64_t(region.width) * region.height, mode.parameters.refreshRate);
+		};
+		const auto& mode = *std::max_element(modes.begin(), modes.end(), [&](const auto& lhs, const auto& rhs) { return rank(lhs) < rank(rhs); });
+
+		// A plane that can scan out the display opaquely (Not in use by another display)
+		uint32_t planeCount = 0;
+		vkGetPhysicalDeviceDisplayPlanePropertiesKHR(m_physical_device, &planeCount, nullptr);
+		std::vector<VkDisplayPlanePropertiesKHR> planes(planeCount);
+		vkGetPhysicalDeviceDisplayPlanePropertiesKHR(m_physical_device, &planeCount, planes.data());
+		std::optional<uint32_t> planeIndex;
+		for (uint32_t plane = 0; plane < planeCount && !planeIndex.has_value(); ++plane)
+		{
+			if (planes[plane].currentDisplay != VK_NULL_HANDLE && planes[plane].currentDisplay != display.display) continue;
+			uint32_t supportedCount = 0;
+			vkGetDisplayPlaneSupportedDisplaysKHR(m_physical_device, plane, &supportedCount, nullptr);
+			std::vector<VkDisplayKHR> supportedDisplays(supportedCount);
+			vkGetDisplayPlaneSupportedDisplaysKHR(m_physical_device, plane, &supportedCount, supportedDisplays.data());
+			if (std::find(supportedDisplays.begin(), supportedDisplays.end(), display.display) == supportedDisplays.end()) continue;
+			VkDisplayPlaneCapabilitiesKHR capabilities{};
+			vkGetDisplayPlaneCapabilitiesKHR(m_physical_device, mode.displayMode, plane, &capabilities);
+			if (capabilities.supportedAlpha & VK_DISPLAY_PLANE_ALPHA_OPAQUE_BIT_KHR) planeIndex = plane;
+		}
+		if (!planeIndex.has_value()) throw std::runtime_error("Failed to create the Vulkan Display Surface - No display plane is available!");
+
+		VkDisplaySurfaceCreateInfoKHR displaySurfaceCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DISPLAY_SURFACE_CREATE_INFO_KHR,
+			.displayMode = mode.displayMode,
+			.planeIndex = *planeIndex,
+			.planeStackIndex = planes[*planeIndex].currentStackIndex,
+			.transform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
+			.globalAlpha = 1.0f,
+			.alphaMode = VK_DISPLAY_PLANE_ALPHA_OPAQUE_BIT_KHR,
+			.imageExtent = mode.parameters.visibleRegion
+		};
+		if (vkCreateDisplayPlaneSurfaceKHR(m_instance, &displaySurfaceCreateInfo, m_memory_allocation_callback, &m_surface) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Display Surface!");
+		m_display = display.display;
+		log::info("Presenting directly to display {} ({}x{} @ {:.2f} Hz, plane {})", display.displayName ? display.displayName : "(Unnamed)",
+			mode.parameters.visibleRegion.width, mode.parameters.visibleRegion.height, mode.parameters.refreshRate / 1000.0, *planeIndex);
+	}
+
 
 	void VulkanContext::create_physical_device()
 	{
@@ -292,49 +862,273 @@ namespace RHI
 
 		std::vector<VkPhysicalDevice> physicalDevices(phyDevCnt);
 		vkEnumeratePhysicalDevices(m_instance, &phyDevCnt, physicalDevices.data());
+		if (m_physical_device == VK_NULL_HANDLE) enumerate_physical_device_capabilities(physicalDevices); // Scored or matched below
 
-		bool is_physical_device_suitable = false;
-		for (const auto& physicalDevice : physicalDevices)
+		if (m_physical_device != VK_NULL_HANDLE) // Chosen by the caller
 		{
-			m_physical_device = physicalDevice;
-			if (check_physical_device_features_support() &&
-				check_physical_device_queue_families_support() &&
-				check_physical_device_extensions_support() &&
-				check_physical_device_surface_support())
-				is_physical_device_suitable = true;
-			if (is_physical_device_suitable) break;
-		}
-		if (!is_physical_device_suitable)
-			throw std::runtime_error("Failed to find a suitable GPU!");
-
-		vkGetPhysicalDeviceFeatures(m_physical_device, &m_physical_device_features);
-		vkGetPhysicalDeviceProperties(m_physical_device, &m_physical_device_properties);
+			if (!select_physical_device(m_physical_device))
+				throw std::runtime_error("Failed to find a suitable GPU!");
+		}
+		else if (PINNED_PHYSICAL_DEVICE.has_value())
+		{
+			auto pinnedDevice = std::find_if(physicalDevices.begin(), physicalDevices.end(),
+				[](VkPhysicalDevice physical_device) { return get_physical_device_uuid(physical_device) == *PINNED_PHYSICAL_DEVICE; });
+			if (pinnedDevice == physicalDevices.end() || !select_physical_device(*pinnedDevice))
+				throw std::runtime_error("Failed to find the pinned GPU or it is not suitable!");
+		}
+		else if (auto cachedDevice = load_physical_device_decision(physicalDevices);
+			cachedDevice != VK_NULL_HANDLE && select_physical_device(cachedDevice))
+		{
+			log::info("Selected the cached GPU {}", m_physical_device_properties.deviceName);
+		}
+		else
+		{
+			VkPhysicalDevice bestDevice = VK_NULL_HANDLE;
+			uint64_t bestScore = 0;
+			for (const auto& physicalDevice : physicalDevices)
+			{
+				if (!select_physical_device(physicalDevice)) continue;
+				uint64_t score = score_physical_device();
+				log::info("GPU {} scored {}", m_physical_device_properties.deviceName, score);
+				if (bestDevice == VK_NULL_HANDLE || score > bestScore) { bestDevice = physicalDevice; bestScore = score; }
+			}
+			if (bestDevice == VK_NULL_HANDLE || !select_physical_device(bestDevice)) // Queue families of the winner
+				throw std::runtime_error("Failed to find a suitable GPU!");
+			m_physical_device_score = bestScore;
+			save_physical_device_decision(phyDevCnt);
+		}
+		if (IsHeadless() && !is_device_extension_available(VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+			std::erase_if(m_device_extensions, [](const char* extension) { return strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0; });
+
+		m_physical_device_features = get_physical_device_capabilities().features;
+		m_physical_device_properties = get_physical_device_capabilities().properties;
 		vkGetPhysicalDeviceMemoryProperties(m_physical_device, &m_physical_device_memory_properties);
+		m_format_table = FormatTable{ m_physical_device, m_physical_device_properties.apiVersion };
+		query_physical_device_advanced_features();
+		if (m_device_group_enabled) select_device_group();
 	}
 
-	void VulkanContext::create_logical_device()
+	void VulkanContext::select_device_group()
 	{
-		std::vector<VkDeviceQueueCreateInfo> deviceQueueCreateInfos;
-		std::unordered_map<uint32_t, size_t> visitedIndicesAndSize;
-		for (const auto& [required_family, priorities] : m_required_queue_families_with_priorities)
+		uint32_t groupCount = 0;
+		vkEnumeratePhysicalDeviceGroups(m_instance, &groupCount, nullptr);
+		std::vector<VkPhysicalDeviceGroupProperties> groups(groupCount, { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GROUP_PROPERTIES });
+		vkEnumeratePhysicalDeviceGroups(m_instance, &groupCount, groups.data());
+		for (const auto& group : groups)
 		{
-			auto familyIndex = required_family->value();
-			//[Vulkan Tutorial - P77]: If the queue families are the same, then we only need to pass its index once.
-			if (visitedIndicesAndSize.find(familyIndex) != visitedIndicesAndSize.end())
+			const auto devices = std::span{ group.physicalDevices, group.physicalDeviceCount };
+			if (std::find(devices.begin(), devices.end(), m_physical_device) == devices.end()) continue;
+			if (devices.size() < 2) break;
+			// Members of a group are identical, so the checks of the selected GPU cover every one of them
+			m_device_group.assign(devices.begin(), devices.end());
+			log::info("Selected a device group of {} x {} (Subset allocation: {})", devices.size(), m_physical_device_properties.deviceName,
+				group.subsetAllocation == VK_TRUE);
+			return;
+		}
+		log::warn("Device groups are enabled, but the GPU {} is not linked to another GPU", m_physical_device_properties.deviceName);
+	}
+
+	void VulkanContext::enumerate_physical_device_capabilities(const std::vector<VkPhysicalDevice>& physical_devices)
+	{
+		// Extension enumeration is slow on some drivers, so the candidates are queried side by side
+		std::vector<std::future<PhysicalDeviceCapabilities>> futures;
+		futures.reserve(physical_devices.size());
+		for (auto physical_device : physical_devices)
+			futures.emplace_back(m_worker_pool->Submit([physical_device]() { return query_physical_device_capabilities(physical_device); }));
+		for (size_t index = 0; index < physical_devices.size(); ++index)
+			m_physical_device_capabilities[physical_devices[index]] = futures[index].get();
+	}
+
+	const VulkanContext::PhysicalDeviceCapabilities& VulkanContext::get_physical_device_capabilities()
+	{
+		auto capabilities = m_physical_device_capabilities.find(m_physical_device);
+		if (capabilities == m_physical_device_capabilities.end()) // Chosen by the caller
+			capabilities = m_physical_device_capabilities.emplace(m_physical_device, query_physical_device_capabilities(m_physical_device)).first;
+		return capabilities->second;
+	}
+
+	VulkanContext::PhysicalDeviceCapabilities VulkanContext::query_physical_device_capabilities(VkPhysicalDevice physical_device)
+	{
+		PhysicalDeviceCapabilities capabilities;
+		vkGetPhysicalDeviceProperties(physical_device, &capabilities.properties);
+		vkGetPhysicalDeviceFeatures(physical_device, &capabilities.features);
+
+		uint32_t extensionCount = 0;
+		vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extensionCount, availableExtensions.data());
+		for (const auto& extension : availableExtensions) capabilities.extensions.emplace(extension.extensionName);
+		return capabilities;
+	}
+
+	bool VulkanContext::select_physical_device(VkPhysicalDevice physical_device)
+	{
+		m_physical_device = physical_device;
+		return check_physical_device_features_support() &&
+			check_physical_device_queue_families_support() &&
+			check_physical_device_extensions_support() &&
+			check_physical_device_surface_support();
+	}
+
+	uint64_t VulkanContext::score_physical_device()
+	{
+		uint64_t score = 0;
+		switch (m_physical_device_properties.deviceType)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:		score += 100'000; break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:	score += 10'000; break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:		score += 5'000; break;
+		default: break; // CPU or other
+		}
+		score += get_device_local_size(m_physical_device) >> 24; // 1 point per 16MB
+
+		// Queue families (Uploads and compute overlap with graphics only on separate families)
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queueFamilyCount, queueFamilies.data());
+		bool hasDedicatedTransfer = false, hasAsyncCompute = false;
+		for (const auto& queueFamily : queueFamilies)
+		{
+			if (!(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
 			{
-				if (priorities.size() != visitedIndicesAndSize[familyIndex])
-					throw std::runtime_error("Failed to initialize logical device - You are creating more than 1 queues at same QueueFamily but have different size!");
-				continue;
+				if (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) hasAsyncCompute = true;
+				else if (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) hasDedicatedTransfer = true;
+			}
+		}
+		if (hasDedicatedTransfer) score += 2'000;
+		if (hasAsyncCompute) score += 2'000;
+
+		// Optional extensions and limits
+		constexpr std::array optionalExtensions
+		{
+			VK_KHR_PRESENT_ID_EXTENSION_NAME,
+			VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+			VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+		};
+		for (auto extension : optionalExtensions)
+			if (is_device_extension_available(extension)) score += 500;
+		if (m_physical_device_properties.apiVersion >= VK_API_VERSION_1_3) score += 1'000;
+
+		const auto& limits = m_physical_device_properties.limits;
+		score += limits.maxImageDimension2D / 1024 * 100;
+		score += limits.maxComputeSharedMemorySize / 1024 * 10;
+		return score;
+	}
+
+	VkPhysicalDevice VulkanContext::load_physical_device_decision(const std::vector<VkPhysicalDevice>& physical_devices)
+	{
+		if (m_pipeline_cache_file.empty()) return VK_NULL_HANDLE;
+		std::ifstream file(m_pipeline_cache_file + ".device", std::ios::binary);
+		if (!file.is_open()) return VK_NULL_HANDLE;
+
+		PhysicalDeviceDecisionFile decision{};
+		if (!file.read(reinterpret_cast<char*>(&decision), sizeof(decision)) ||
+			decision.magic != PhysicalDeviceDecisionFile::MAGIC ||
+			decision.physical_device_count != physical_devices.size()) // GPUs were added or removed
+			return VK_NULL_HANDLE;
+
+		for (auto physical_device : physical_devices)
+		{
+			const auto& properties = m_physical_device_capabilities.at(physical_device).properties;
+			if (properties.vendorID != decision.vendor_id || properties.deviceID != decision.device_id) continue;
+			if (properties.driverVersion != decision.driver_version) return VK_NULL_HANDLE; // Rescore after driver updates
+			auto uuid = get_physical_device_uuid(physical_device);
+			if (std::equal(uuid.begin(), uuid.end(), decision.device_uuid))
+			{
+				m_physical_device_score = decision.score;
+				return physical_device;
 			}
-			else visitedIndicesAndSize[familyIndex] = priorities.size();
+		}
+		return VK_NULL_HANDLE;
+	}
+
+	void VulkanContext::save_physical_device_decision(uint32_t physical_device_count)
+	{
+		if (m_pipeline_cache_file.empty()) return;
+		PhysicalDeviceDecisionFile decision
+		{
+			.magic = PhysicalDeviceDecisionFile::MAGIC,
+			.physical_device_count = physical_device_count,
+			.vendor_id = m_physical_device_properties.vendorID,
+			.device_id = m_physical_device_properties.deviceID,
+			.driver_version = m_physical_device_properties.driverVersion,
+			.score = m_physical_device_score,
+			.device_local_size = get_device_local_size(m_physical_device),
+			.queue_family_graphics = m_device_queue_family_graphics.value(),
+			.queue_family_transfer = m_device_queue_family_transfer.value(),
+			.queue_family_compute = m_device_queue_family_compute.value_or(VK_QUEUE_FAMILY_IGNORED)
+		};
+		auto uuid = get_physical_device_uuid(m_physical_device);
+		std::copy(uuid.begin(), uuid.end(), decision.device_uuid);
+
+		std::scoped_lock guard{ PIPELINE_CACHE_FILE_MUTEX };
+		std::ofstream file(m_pipeline_cache_file + ".device", std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) { log::warn("Failed to save the physical device decision {}.device", m_pipeline_cache_file); return; }
+		file.write(reinterpret_cast<const char*>(&decision), sizeof(decision));
+	}
+
+	VulkanContext::PhysicalDeviceUUID VulkanContext::GetPhysicalDeviceUUID()
+	{
+		return get_physical_device_uuid(m_physical_device);
+	}
+
+	void VulkanContext::PinPhysicalDevice(std::optional<PhysicalDeviceUUID> device_uuid)
+	{
+		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
+		PINNED_PHYSICAL_DEVICE = std::move(device_uuid);
+	}
+
+	void VulkanContext::create_logical_device()
+	{
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queueFamilyCount, queueFamilies.data());
+
+		// Every hardware queue of the used families (Priorities follow the QueueConfig layout)
+		ScratchScope scratch;
+		std::pmr::vector<VkDeviceQueueCreateInfo> deviceQueueCreateInfos{ scratch.Resource() };
+		std::pmr::vector<std::pmr::vector<float>> queuePriorities{ scratch.Resource() }; // Elements use the same resource
+		std::pmr::vector<VkDeviceQueueGlobalPriorityCreateInfoKHR> globalPriorityCreateInfos{ scratch.Resource() }; // Chained to the queue infos
+		auto usedQueueFamilies = m_required_queue_families;
+		if (IsSparseResidencySupported()) usedQueueFamilies.emplace_back(&m_device_queue_family_sparsebinding); // Optional
+		if (IsVideoEncodeSupported()) usedQueueFamilies.emplace_back(&m_device_queue_family_video_encode); // Optional
+		queuePriorities.reserve(usedQueueFamilies.size());
+		globalPriorityCreateInfos.reserve(usedQueueFamilies.size()); // Stable pNext
+		m_device_queue_global_priorities.fill(VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR);
+		for (const auto used_family : usedQueueFamilies)
+		{
+			auto familyIndex = used_family->value();
+			//[Vulkan Tutorial - P77]: If the queue families are the same, then we only need to pass its index once.
+			if (familyIndex >= MAX_QUEUE_FAMILY_COUNT)
+				throw std::runtime_error("Failed to initialize logical device - Queue family index is out of the global slot range!");
+			if (m_device_queue_counts[familyIndex]) continue;
 
-			deviceQueueCreateInfos.emplace_back(VkDeviceQueueCreateInfo
+			uint32_t queueCount = std::clamp(queueFamilies[familyIndex].queueCount, 1U, std::max(1U, m_queue_config.max_queues_per_family));
+			m_device_queue_counts[familyIndex] = queueCount;
+			auto& priorities = queuePriorities.emplace_back(queueCount, m_queue_config.normal_priority);
+			if (queueCount >= 2) priorities[1] = m_queue_config.high_priority;
+			if (queueCount >= 3) priorities.back() = m_queue_config.low_priority;
+
+			auto& queueCreateInfo = deviceQueueCreateInfos.emplace_back(VkDeviceQueueCreateInfo
 				{
 					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 					.queueFamilyIndex = familyIndex,
-					.queueCount = static_cast<uint32_t>(priorities.size()),
+					.queueCount = queueCount,
 					.pQueuePriorities = priorities.data()
 				});
+			m_device_queue_global_priorities[familyIndex] = get_queue_family_global_priority(familyIndex);
+			if (m_device_queue_global_priorities[familyIndex] != VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR) // MEDIUM is the default
+			{
+				queueCreateInfo.pNext = &globalPriorityCreateInfos.emplace_back(VkDeviceQueueGlobalPriorityCreateInfoKHR
+					{
+						.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_GLOBAL_PRIORITY_CREATE_INFO_KHR,
+						.globalPriority = m_device_queue_global_priorities[familyIndex]
+					});
+			}
+			log::info("Created {} queues on queue family {} (Global priority {:#x})", queueCount, familyIndex,
+				static_cast<uint32_t>(m_device_queue_global_priorities[familyIndex]));
 		}
 
 		VkDeviceCreateInfo deviceCreateInfo
@@ -348,18 +1142,378 @@ namespace RHI
 			.ppEnabledExtensionNames = m_device_extensions.data(),
 			.pEnabledFeatures = m_physical_device_features2.has_value() ? nullptr : &m_physical_device_features// (If pNext includes a VkPhysicalDeviceFeatures2, here should be NULL)
 		};
+		const VkDeviceGroupDeviceCreateInfo deviceGroupCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO,
+			.pNext = deviceCreateInfo.pNext,
+			.physicalDeviceCount = static_cast<uint32_t>(m_device_group.size()),
+			.pPhysicalDevices = m_device_group.data()
+		};
+		if (!m_device_group.empty()) deviceCreateInfo.pNext = &deviceGroupCreateInfo;
 		
-		if (vkCreateDevice(m_physical_device, &deviceCreateInfo, m_memory_allocation_callback, &m_device) != VK_SUCCESS)
+		auto result = vkCreateDevice(m_physical_device, &deviceCreateInfo, m_memory_allocation_callback, &m_device);
+		if (result == VK_ERROR_NOT_PERMITTED_KHR && !globalPriorityCreateInfos.empty())
+		{
+			// HIGH & REALTIME may need privileges (e.g. CAP_SYS_NICE): Retry with the default priority
+			log::warn("Global queue priorities above MEDIUM are not permitted for this process - Using MEDIUM");
+			for (auto& queueCreateInfo : deviceQueueCreateInfos) queueCreateInfo.pNext = nullptr;
+			m_device_queue_global_priorities.fill(VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR);
+			result = vkCreateDevice(m_physical_device, &deviceCreateInfo, m_memory_allocation_callback, &m_device);
+		}
+		if (result != VK_SUCCESS)
 			throw std::runtime_error("Failed to create the logical device!");
-	}
+		m_dispatch.Load(m_device);
+
+		if (IsMeshShaderSupported())
+		{
+			m_cmd_draw_mesh_tasks = (PFN_vkCmdDrawMeshTasksEXT)vkGetDeviceProcAddr(m_device, "vkCmdDrawMeshTasksEXT");
+			m_cmd_draw_mesh_tasks_indirect = (PFN_vkCmdDrawMeshTasksIndirectEXT)vkGetDeviceProcAddr(m_device, "vkCmdDrawMeshTasksIndirectEXT");
+			m_cmd_draw_mesh_tasks_indirect_count = (PFN_vkCmdDrawMeshTasksIndirectCountEXT)vkGetDeviceProcAddr(m_device, "vkCmdDrawMeshTasksIndirectCountEXT");
+		}
+		if (IsAccelerationStructureSupported())
+		{
+			m_create_acceleration_structure = (PFN_vkCreateAccelerationStructureKHR)vkGetDeviceProcAddr(m_device, "vkCreateAccelerationStructureKHR");
+			m_destroy_acceleration_structure = (PFN_vkDestroyAccelerationStructureKHR)vkGetDeviceProcAddr(m_device, "vkDestroyAccelerationStructureKHR");
+			m_get_acceleration_structure_build_sizes = (PFN_vkGetAccelerationStructureBuildSizesKHR)vkGetDeviceProcAddr(m_device, "vkGetAccelerationStructureBuildSizesKHR");
+			m_get_acceleration_structure_device_address = (PFN_vkGetAccelerationStructureDeviceAddressKHR)vkGetDeviceProcAddr(m_device, "vkGetAccelerationStructureDeviceAddressKHR");
+			m_cmd_build_acceleration_structures = (PFN_vkCmdBuildAccelerationStructuresKHR)vkGetDeviceProcAddr(m_device, "vkCmdBuildAccelerationStructuresKHR");
+			m_cmd_write_acceleration_structures_properties = (PFN_vkCmdWriteAccelerationStructuresPropertiesKHR)vkGetDeviceProcAddr(m_device, "vkCmdWriteAccelerationStructuresPropertiesKHR");
+			m_cmd_copy_acceleration_structure = (PFN_vkCmdCopyAccelerationStructureKHR)vkGetDeviceProcAddr(m_device, "vkCmdCopyAccelerationStructureKHR");
+		}
+		if (IsPushDescriptorSupported())
+			m_cmd_push_descriptor_set = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(m_device, "vkCmdPushDescriptorSetKHR");
+		if (IsDescriptorBufferSupported())
+		{
+			m_get_descriptor_set_layout_size = (PFN_vkGetDescriptorSetLayoutSizeEXT)vkGetDeviceProcAddr(m_device, "vkGetDescriptorSetLayoutSizeEXT");
+			m_get_descriptor_set_layout_binding_offset = (PFN_vkGetDescriptorSetLayoutBindingOffsetEXT)vkGetDeviceProcAddr(m_device, "vkGetDescriptorSetLayoutBindingOffsetEXT");
+			m_get_descriptor = (PFN_vkGetDescriptorEXT)vkGetDeviceProcAddr(m_device, "vkGetDescriptorEXT");
+			m_cmd_bind_descriptor_buffers = (PFN_vkCmdBindDescriptorBuffersEXT)vkGetDeviceProcAddr(m_device, "vkCmdBindDescriptorBuffersEXT");
+			m_cmd_set_descriptor_buffer_offsets = (PFN_vkCmdSetDescriptorBufferOffsetsEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetDescriptorBufferOffsetsEXT");
+		}
+		if (IsConditionalRenderingSupported())
+		{
+			m_cmd_begin_conditional_rendering = (PFN_vkCmdBeginConditionalRenderingEXT)vkGetDeviceProcAddr(m_device, "vkCmdBeginConditionalRenderingEXT");
+			m_cmd_end_conditional_rendering = (PFN_vkCmdEndConditionalRenderingEXT)vkGetDeviceProcAddr(m_device, "vkCmdEndConditionalRenderingEXT");
+		}
+		if (IsFragmentShadingRateSupported())
+			m_cmd_set_fragment_shading_rate = (PFN_vkCmdSetFragmentShadingRateKHR)vkGetDeviceProcAddr(m_device, "vkCmdSetFragmentShadingRateKHR");
+		if (m_buffer_marker_supported)
+			m_cmd_write_buffer_marker = (PFN_vkCmdWriteBufferMarkerAMD)vkGetDeviceProcAddr(m_device, "vkCmdWriteBufferMarkerAMD");
+		if (m_diagnostic_checkpoints_supported)
+		{
+			m_cmd_set_checkpoint = (PFN_vkCmdSetCheckpointNV)vkGetDeviceProcAddr(m_device, "vkCmdSetCheckpointNV");
+			m_get_queue_checkpoint_data = (PFN_vkGetQueueCheckpointDataNV)vkGetDeviceProcAddr(m_device, "vkGetQueueCheckpointDataNV");
+		}
+		if (IsHostImageCopySupported())
+		{
+			m_copy_memory_to_image = (PFN_vkCopyMemoryToImageEXT)vkGetDeviceProcAddr(m_device, "vkCopyMemoryToImageEXT");
+			m_transition_image_layout = (PFN_vkTransitionImageLayoutEXT)vkGetDeviceProcAddr(m_device, "vkTransitionImageLayoutEXT");
+		}
+		if (IsPageableDeviceLocalMemorySupported())
+			m_set_device_memory_priority = (PFN_vkSetDeviceMemoryPriorityEXT)vkGetDeviceProcAddr(m_device, "vkSetDeviceMemoryPriorityEXT");
+		if (IsImageCompressionControlSupported())
+			m_get_image_subresource_layout2 = (PFN_vkGetImageSubresourceLayout2EXT)vkGetDeviceProcAddr(m_device, "vkGetImageSubresourceLayout2EXT");
+		if (IsSwapchainMaintenance1Supported())
+			m_release_swapchain_images = (PFN_vkReleaseSwapchainImagesEXT)vkGetDeviceProcAddr(m_device, "vkReleaseSwapchainImagesEXT");
+		if (IsMultiDrawSupported())
+		{
+			m_cmd_draw_multi = (PFN_vkCmdDrawMultiEXT)vkGetDeviceProcAddr(m_device, "vkCmdDrawMultiEXT");
+			m_cmd_draw_multi_indexed = (PFN_vkCmdDrawMultiIndexedEXT)vkGetDeviceProcAddr(m_device, "vkCmdDrawMultiIndexedEXT");
+		}
+		if (IsShaderObjectSupported())
+		{
+			m_create_shaders = (PFN_vkCreateShadersEXT)vkGetDeviceProcAddr(m_device, "vkCreateShadersEXT");
+			m_destroy_shader = (PFN_vkDestroyShaderEXT)vkGetDeviceProcAddr(m_device, "vkDestroyShaderEXT");
+			m_cmd_bind_shaders = (PFN_vkCmdBindShadersEXT)vkGetDeviceProcAddr(m_device, "vkCmdBindShadersEXT");
+			m_cmd_set_vertex_input = (PFN_vkCmdSetVertexInputEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetVertexInputEXT");
+			m_cmd_set_polygon_mode = (PFN_vkCmdSetPolygonModeEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetPolygonModeEXT");
+			m_cmd_set_rasterization_samples = (PFN_vkCmdSetRasterizationSamplesEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetRasterizationSamplesEXT");
+			m_cmd_set_sample_mask = (PFN_vkCmdSetSampleMaskEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetSampleMaskEXT");
+			m_cmd_set_alpha_to_coverage_enable = (PFN_vkCmdSetAlphaToCoverageEnableEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetAlphaToCoverageEnableEXT");
+			m_cmd_set_alpha_to_one_enable = (PFN_vkCmdSetAlphaToOneEnableEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetAlphaToOneEnableEXT");
+			m_cmd_set_logic_op_enable = (PFN_vkCmdSetLogicOpEnableEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetLogicOpEnableEXT");
+			m_cmd_set_depth_clamp_enable = (PFN_vkCmdSetDepthClampEnableEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetDepthClampEnableEXT");
+			m_cmd_set_color_blend_enable = (PFN_vkCmdSetColorBlendEnableEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetColorBlendEnableEXT");
+			m_cmd_set_color_blend_equation = (PFN_vkCmdSetColorBlendEquationEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetColorBlendEquationEXT");
+			m_cmd_set_color_write_mask = (PFN_vkCmdSetColorWriteMaskEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetColorWriteMaskEXT");
+			m_cmd_set_patch_control_points = (PFN_vkCmdSetPatchControlPointsEXT)vkGetDeviceProcAddr(m_device, "vkCmdSetPatchControlPointsEXT");
+		}
+		if (IsVideoEncodeSupported())
+		{
+			m_create_video_session = (PFN_vkCreateVideoSessionKHR)vkGetDeviceProcAddr(m_device, "vkCreateVideoSessionKHR");
+			m_destroy_video_session = (PFN_vkDestroyVideoSessionKHR)vkGetDeviceProcAddr(m_device, "vkDestroyVideoSessionKHR");
+			m_get_video_session_memory_requirements = (PFN_vkGetVideoSessionMemoryRequirementsKHR)vkGetDeviceProcAddr(m_device, "vkGetVideoSessionMemoryRequirementsKHR");
+			m_bind_video_session_memory = (PFN_vkBindVideoSessionMemoryKHR)vkGetDeviceProcAddr(m_device, "vkBindVideoSessionMemoryKHR");
+			m_create_video_session_parameters = (PFN_vkCreateVideoSessionParametersKHR)vkGetDeviceProcAddr(m_device, "vkCreateVideoSessionParametersKHR");
+			m_destroy_video_session_parameters = (PFN_vkDestroyVideoSessionParametersKHR)vkGetDeviceProcAddr(m_device, "vkDestroyVideoSessionParametersKHR");
+			m_get_encoded_video_session_parameters = (PFN_vkGetEncodedVideoSessionParametersKHR)vkGetDeviceProcAddr(m_device, "vkGetEncodedVideoSessionParametersKHR");
+			m_cmd_begin_video_coding = (PFN_vkCmdBeginVideoCodingKHR)vkGetDeviceProcAddr(m_device, "vkCmdBeginVideoCodingKHR");
+			m_cmd_end_video_coding = (PFN_vkCmdEndVideoCodingKHR)vkGetDeviceProcAddr(m_device, "vkCmdEndVideoCodingKHR");
+			m_cmd_control_video_coding = (PFN_vkCmdControlVideoCodingKHR)vkGetDeviceProcAddr(m_device, "vkCmdControlVideoCodingKHR");
+			m_cmd_encode_video = (PFN_vkCmdEncodeVideoKHR)vkGetDeviceProcAddr(m_device, "vkCmdEncodeVideoKHR");
+		}
+		if (IsCalibratedTimestampsSupported())
+			m_get_calibrated_timestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(m_device, "vkGetCalibratedTimestampsEXT");
+		if (IsExternalMemorySupported())
+		{
+#ifdef _WIN32
+			m_get_memory_win32_handle = vkGetDeviceProcAddr(m_device, "vkGetMemoryWin32HandleKHR");
+			m_get_semaphore_win32_handle = vkGetDeviceProcAddr(m_device, "vkGetSemaphoreWin32HandleKHR");
+			m_import_semaphore_win32_handle = vkGetDeviceProcAddr(m_device, "vkImportSemaphoreWin32HandleKHR");
+#else
+			m_get_memory_fd = (PFN_vkGetMemoryFdKHR)vkGetDeviceProcAddr(m_device, "vkGetMemoryFdKHR");
+			m_get_semaphore_fd = (PFN_vkGetSemaphoreFdKHR)vkGetDeviceProcAddr(m_device, "vkGetSemaphoreFdKHR");
+			m_import_semaphore_fd = (PFN_vkImportSemaphoreFdKHR)vkGetDeviceProcAddr(m_device, "vkImportSemaphoreFdKHR");
+			if (IsDmaBufSupported())
+				m_get_memory_fd_properties = (PFN_vkGetMemoryFdPropertiesKHR)vkGetDeviceProcAddr(m_device, "vkGetMemoryFdPropertiesKHR");
+#endif
+		}
+		if (IsFullScreenExclusiveSupported())
+			m_acquire_full_screen_exclusive_mode = vkGetDeviceProcAddr(m_device, "vkAcquireFullScreenExclusiveModeEXT");
+	}
+
+	uint32_t VulkanContext::GetQueueIndex(QueueFamilyIndex& queue_family_index, QueuePriority priority/* = QueuePriority::NORMAL*/,
+		std::thread::id thread_id/* = std::this_thread::get_id()*/) const
+	{
+		uint32_t queueCount = GetQueueCount(queue_family_index);
+		switch (priority)
+		{
+		case QueuePriority::HIGH: return (queueCount >= 2) ? 1 : 0;
+		case QueuePriority::LOW: return (queueCount >= 3) ? queueCount - 1 : 0;
+		default: break;
+		}
+		// NORMAL: Queue 0 and the spare queues between HIGH and LOW
+		uint32_t spareCount = (queueCount > 3) ? queueCount - 3 : 0;
+		if (!m_queue_config.route_by_thread || !spareCount) return 0;
+		auto slot = static_cast<uint32_t>(std::hash<std::thread::id>{}(thread_id) % (spareCount + 1));
+		return slot ? slot + 1 : 0; // Skip HIGH
+	}
+
+	VkSampleCountFlagBits VulkanContext::ClampSampleCount(VkSampleCountFlagBits samples, VkImageAspectFlags aspect/* = VK_IMAGE_ASPECT_COLOR_BIT*/) const
+	{
+		const auto& limits = m_physical_device_properties.limits;
+		VkSampleCountFlags supported = VK_SAMPLE_COUNT_FLAG_BITS_MAX_ENUM;
+		if (aspect & VK_IMAGE_ASPECT_COLOR_BIT) supported &= limits.framebufferColorSampleCounts;
+		if (aspect & VK_IMAGE_ASPECT_DEPTH_BIT) supported &= limits.framebufferDepthSampleCounts;
+		if (aspect & VK_IMAGE_ASPECT_STENCIL_BIT) supported &= limits.framebufferStencilSampleCounts;
+		for (auto count = static_cast<VkSampleCountFlags>(samples); count > VK_SAMPLE_COUNT_1_BIT; count >>= 1)
+			if (supported & count) return static_cast<VkSampleCountFlagBits>(count);
+		return VK_SAMPLE_COUNT_1_BIT; // Always supported
+	}
+
+	void VulkanContext::SetQueueConfig(const QueueConfig& config)
+	{
+		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
+		QUEUE_CONFIG = config;
+	}
+
+	void VulkanContext::SetSurfaceConfig(const SurfaceConfig& config)
+	{
+		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
+		SURFACE_CONFIG = config;
+	}
+
+	void VulkanContext::SetDeviceGroupEnabled(bool enable)
+	{
+		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
+		DEVICE_GROUP_ENABLED = enable;
+	}
+
+	VkPeerMemoryFeatureFlags VulkanContext::GetPeerMemoryFeatures(uint32_t heap_index, uint32_t local_device_index, uint32_t remote_device_index) const
+	{
+		assert(local_device_index < GetDeviceCount() && remote_device_index < GetDeviceCount() && "Invalid device index!");
+		if (local_device_index == remote_device_index)
+			return VK_PEER_MEMORY_FEATURE_COPY_SRC_BIT | VK_PEER_MEMORY_FEATURE_COPY_DST_BIT |
+				VK_PEER_MEMORY_FEATURE_GENERIC_SRC_BIT | VK_PEER_MEMORY_FEATURE_GENERIC_DST_BIT;
+		VkPeerMemoryFeatureFlags features = 0;
+		vkGetDeviceGroupPeerMemoryFeatures(m_device, heap_index, local_device_index, remote_device_index, &features);
+		return features;
+	}
 
 	void VulkanContext::create_memory_allocator()
 	{
 		m_memory_allocator = VMA::Create(shared_from_this()); // Cannot call shared_from_this() in constructor!
 	}
 
+	std::vector<char> VulkanContext::read_pipeline_cache_file() const
+	{
+		if (m_pipeline_cache_file.empty()) return {};
+		std::ifstream file(m_pipeline_cache_file, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) return {}; // Cold start
+		std::vector<char> pipeline_cache_file(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		if (!file.read(pipeline_cache_file.data(), pipeline_cache_file.size())) return {};
+		return pipeline_cache_file;
+	}
+
+	void VulkanContext::create_pipeline_cache(std::span<const char> pipeline_cache_file)
+	{
+		auto cache_data = validate_pipeline_cache_file(pipeline_cache_file, m_pipeline_cache_file, &m_pipeline_cache_generation);
+		m_pipeline_cache = create_pipeline_cache_object(cache_data);
+		log::info("Created the Vulkan Pipeline Cache with {} bytes initial data (Generation {})", cache_data.size(), m_pipeline_cache_generation);
+	}
+
+	std::span<const char> VulkanContext::validate_pipeline_cache_file(std::span<const char> pipeline_cache_file, std::string_view name, uint64_t* generation) const
+	{
+		PipelineCacheFileHeader header{};
+		if (pipeline_cache_file.size() < sizeof(header)) return {};
+		memcpy(&header, pipeline_cache_file.data(), sizeof(header));
+		if (header.magic != PipelineCacheFileHeader::MAGIC ||
+			header.version != PipelineCacheFileHeader::VERSION ||
+			header.vendor_id != m_physical_device_properties.vendorID ||
+			header.device_id != m_physical_device_properties.deviceID ||
+			header.driver_version != m_physical_device_properties.driverVersion ||
+			memcmp(header.pipeline_cache_uuid, m_physical_device_properties.pipelineCacheUUID, VK_UUID_SIZE))
+		{
+			log::warn("The pipeline cache file {} is outdated - it will be rebuilt", name);
+			return {};
+		}
+		if (header.data_size > pipeline_cache_file.size() - sizeof(header)) return {}; // Broken (Untrusted size, so no sum that could overflow)
+		if (generation) *generation = header.generation;
+		return pipeline_cache_file.subspan(sizeof(header), header.data_size);
+	}
+
+	VkPipelineCache VulkanContext::create_pipeline_cache_object(std::span<const char> cache_data) const
+	{
+		VkPipelineCacheCreateInfo pipelineCacheCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.initialDataSize = cache_data.size(),
+			.pInitialData = cache_data.empty() ? nullptr : cache_data.data()
+		};
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+		if (vkCreatePipelineCache(m_device, &pipelineCacheCreateInfo, m_memory_allocation_callback, &pipelineCache) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Pipeline Cache!");
+		return pipelineCache;
+	}
+
+	void VulkanContext::write_pipeline_cache_file(const std::string& pipeline_cache_file, uint64_t generation) const
+	{
+		size_t data_size = 0;
+		if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &data_size, nullptr) != VK_SUCCESS)
+			throw std::runtime_error("Failed to retrieve the size of Vulkan Pipeline Cache!");
+		std::vector<char> cache_data(data_size);
+		if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &data_size, cache_data.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to retrieve the data of Vulkan Pipeline Cache!");
+
+		PipelineCacheFileHeader header
+		{
+			.magic = PipelineCacheFileHeader::MAGIC,
+			.version = PipelineCacheFileHeader::VERSION,
+			.generation = generation,
+			.vendor_id = m_physical_device_properties.vendorID,
+			.device_id = m_physical_device_properties.deviceID,
+			.driver_version = m_physical_device_properties.driverVersion,
+			.data_size = data_size
+		};
+		memcpy(header.pipeline_cache_uuid, m_physical_device_properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+		// Write to a temporary file first so that a crash (or a reader on shared storage) will never see a broken cache
+		auto temporary_file = std::format("{}.{:08x}.tmp", pipeline_cache_file, std::random_device{}()); // Unique across processes
+		{
+			std::ofstream file(temporary_file, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the pipeline cache file {}!", temporary_file));
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(cache_data.data(), data_size);
+			file.flush();
+			if (!file.good()) // e.g. Disk full
+			{
+				file.close();
+				std::error_code error_code;
+				std::filesystem::remove(temporary_file, error_code);
+				throw std::runtime_error(std::format("Failed to write the pipeline cache file {}!", temporary_file));
+			}
+		}
+		std::error_code error_code;
+		std::filesystem::rename(temporary_file, pipeline_cache_file, error_code);
+		if (error_code) log::warn("Failed to save the pipeline cache file {}: {}", pipeline_cache_file, error_code.message());
+	}
+
+	std::future<void> VulkanContext::create_shader_cache()
+	{
+		m_shader_cache = std::make_unique<ShaderCache>(this); // Needs no device until the first module
+		if (m_pipeline_cache_file.empty()) return {};
+		return m_worker_pool->Submit([this]()
+			{
+				m_shader_cache->LoadShaderReflections(m_pipeline_cache_file + ".reflection");
+				std::string archiveFile = m_pipeline_cache_file + ".archive";
+				if (!std::filesystem::exists(archiveFile)) return;
+				try { m_shader_cache->LoadShaderArchive(archiveFile); }
+				catch (const std::runtime_error& error) { log::warn("Skipped the shader archive - {}", error.what()); }
+			});
+	}
+
+	void VulkanContext::create_bindless_heap()
+	{
+		if (check_physical_device_bindless_support())
+			m_bindless_heap = std::make_unique<BindlessHeap>(this);
+		else log::warn("Bindless Descriptor Heap is disabled - the GPU does not support descriptor indexing");
+	}
+
+	void VulkanContext::SavePipelineCache()
+	{
+		if (m_pipeline_cache_file.empty() || m_pipeline_cache == VK_NULL_HANDLE) return;
+		std::scoped_lock guard{ PIPELINE_CACHE_FILE_MUTEX };
+		if (m_shader_cache && m_pipeline_cache_delta_file.empty()) m_shader_cache->SaveShaderReflections(m_pipeline_cache_file + ".reflection");
+		if (!m_pipeline_cache_delta_file.empty()) write_pipeline_cache_file(m_pipeline_cache_delta_file, 0); // The shared file is read-only
+		else write_pipeline_cache_file(m_pipeline_cache_file, m_pipeline_cache_generation);
+	}
+
+	void VulkanContext::SetPipelineCacheDeltaFile(std::string_view delta_file)
+	{
+		std::scoped_lock guard{ PIPELINE_CACHE_FILE_MUTEX };
+		m_pipeline_cache_delta_file = delta_file;
+	}
+
+	size_t VulkanContext::MergePipelineCaches(const std::vector<std::string>& delta_files)
+	{
+		if (m_pipeline_cache_file.empty() || m_pipeline_cache == VK_NULL_HANDLE)
+			throw std::runtime_error("Failed to merge the pipeline caches - The context has no persistent pipeline cache!");
+		ALBEDO_RHI_TRACE_ZONE("RHI::VulkanContext::MergePipelineCaches");
+		std::scoped_lock guard{ PIPELINE_CACHE_FILE_MUTEX };
+
+		// The shared file is merged again, as another merge may have replaced it since this context loaded it
+		auto read_file = [](const std::string& path)
+		{
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file.is_open()) return std::vector<char>{};
+			std::vector<char> data(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			if (!file.read(data.data(), data.size())) return std::vector<char>{};
+			return data;
+		};
+		std::vector<std::string> sourceFiles{ m_pipeline_cache_file };
+		sourceFiles.insert(sourceFiles.end(), delta_files.begin(), delta_files.end());
+
+		uint64_t generation = m_pipeline_cache_generation;
+		size_t mergedDeltas = 0;
+		std::vector<VkPipelineCache> sourceCaches;
+		for (size_t i = 0; i < sourceFiles.size(); ++i)
+		{
+			auto fileData = read_file(sourceFiles[i]);
+			uint64_t fileGeneration = 0;
+			auto cache_data = validate_pipeline_cache_file(fileData, sourceFiles[i], &fileGeneration);
+			if (cache_data.empty()) { if (i) log::warn("Skipped the pipeline cache delta {} - Missing or of another device", sourceFiles[i]); continue; }
+			generation = std::max(generation, fileGeneration);
+			sourceCaches.emplace_back(create_pipeline_cache_object(cache_data));
+			if (i) ++mergedDeltas;
+		}
+
+		VkResult result = sourceCaches.empty() ? VK_SUCCESS :
+			vkMergePipelineCaches(m_device, m_pipeline_cache, static_cast<uint32_t>(sourceCaches.size()), sourceCaches.data());
+		for (auto source_cache : sourceCaches) vkDestroyPipelineCache(m_device, source_cache, m_memory_allocation_callback);
+		if (result != VK_SUCCESS) throw std::runtime_error("Failed to merge the Vulkan Pipeline Caches!");
+
+		m_pipeline_cache_generation = generation + 1;
+		write_pipeline_cache_file(m_pipeline_cache_file, m_pipeline_cache_generation);
+		log::info("Merged {} of {} pipeline cache deltas into {} (Generation {})", mergedDeltas, delta_files.size(), m_pipeline_cache_file, m_pipeline_cache_generation);
+		return mergedDeltas;
+	}
+
 	void VulkanContext::create_swap_chain()
 	{
+		if (IsHeadless()) return create_offscreen_images();
+
 		if (!check_swap_chain_image_format_support())
 			throw std::runtime_error(std::format("Failed to create the Vulkan Swap Chain - Image format is not supported!"));
 		if (!check_swap_chain_depth_format_support())
@@ -373,18 +1527,12 @@ namespace RHI
 		// Begin(Choose Swap Extent (resolution of images in swap chain))
 		{
 			constexpr uint32_t SPECIAL_VALUE_OF_WINDOW_MANAGER = std::numeric_limits<uint32_t>::max(); // More details in textbook P85
-			if (current_surface_capabilities.currentExtent.height == SPECIAL_VALUE_OF_WINDOW_MANAGER)
+			VkExtent2D extent = current_surface_capabilities.currentExtent;
+			if (extent.height == SPECIAL_VALUE_OF_WINDOW_MANAGER)
 			{
 				int width, height;
 				glfwGetFramebufferSize(m_window, &width, &height);
-				while (width <= 0 || height <= 0)
-				{
-
-					glfwGetFramebufferSize(m_window, &width, &height);
-					glfwWaitEvents();
-				}				
-
-				m_swapchain_current_extent = VkExtent2D
+				extent = (width <= 0 || height <= 0)? VkExtent2D{} : VkExtent2D
 				{
 					.width = std::clamp(static_cast<uint32_t>(width),
 														current_surface_capabilities.minImageExtent.width,
@@ -394,28 +1542,24 @@ namespace RHI
 														current_surface_capabilities.maxImageExtent.height)
 				};
 			}
-			else
-			{
-				while (current_surface_capabilities.currentExtent.width <= 0 ||
-					current_surface_capabilities.currentExtent.height <= 0)
-				{
-					vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
-						m_physical_device, m_surface, &current_surface_capabilities);
-					glfwWaitEvents();
-				}
-				m_swapchain_current_extent = current_surface_capabilities.currentExtent;
-			}
+			// Minimized: Suspended instead of waiting for events here (The acquisitions resume it)
+			if (extent.width == 0 || extent.height == 0) return suspend_swap_chain();
+			m_swapchain_current_extent = extent;
 		} // End(Choose Swap Extent (resolution of images in swap chain)
+		if (m_swapchain_suspended) log::info("Swap Chain resumed ({}x{})", m_swapchain_current_extent.width, m_swapchain_current_extent.height);
+		m_swapchain_suspended = false;
 
 		// Decide how many images we would like to have in the swap chain
-		m_swapchain_image_count = current_surface_capabilities.minImageCount + 1;
+		m_swapchain_image_count = current_surface_capabilities.minImageCount + m_swapchain_config.extra_image_count;
 		if (current_surface_capabilities.maxImageCount != 0) // 0 means no limits
 			m_swapchain_image_count = std::clamp(m_swapchain_image_count,
-																					  m_swapchain_image_count,
+																					  current_surface_capabilities.minImageCount,
 																					  current_surface_capabilities.maxImageCount);
 
-		bool is_exclusive_device = (m_device_queue_family_graphics == m_device_queue_family_present);
-		uint32_t queue_family_indices[] { m_device_queue_family_graphics.value(), m_device_queue_family_present.value() };
+		// Transfer source for Screenshot, sampled by VideoEncoder & FrameCaptureRing if supported (It must be the same as the usage of the image views)
+		m_swapchain_image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+			(current_surface_capabilities.supportedUsageFlags & VK_IMAGE_USAGE_SAMPLED_BIT);
+		// Exclusive even on distinct present families (Concurrent sharing may disable framebuffer compression), see PresentSwapChain()
 		VkSwapchainCreateInfoKHR swapChainCreateInfo
 		{
 			.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -425,127 +1569,1059 @@ namespace RHI
 			.imageColorSpace = m_swapchain_color_space,
 			.imageExtent = m_swapchain_current_extent,
 			.imageArrayLayers = 1,
-			.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, // For Screenshot
-			.imageSharingMode = is_exclusive_device ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT,
-			.queueFamilyIndexCount = is_exclusive_device ? 0U : 2U,
-			.pQueueFamilyIndices = is_exclusive_device ? nullptr : queue_family_indices,
+			.imageUsage = m_swapchain_image_usage,
+			.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
 			.preTransform = current_surface_capabilities.currentTransform, // Do not want any pretransformation
 			.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
 			.presentMode = m_swapchain_present_mode,
 			.clipped = VK_TRUE, // Means that we do not care about the color of pixels that are obscured for the best performance. (P89)
-			.oldSwapchain = VK_NULL_HANDLE // Modify this field later (resize)
+			.oldSwapchain = m_swapchain // Chained while recreating, so the presentation engine can reuse its resources
 		};
-		if (vkCreateSwapchainKHR(m_device, &swapChainCreateInfo, m_memory_allocation_callback, &m_swapchain) != VK_SUCCESS)
+		// Maintenance1: Every present mode compatible with the chosen one can be switched to by SetSwapChainConfig() without recreation
+		m_swapchain_present_modes.clear();
+		VkSwapchainPresentModesCreateInfoEXT presentModesCreateInfo{ .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODES_CREATE_INFO_EXT };
+		if (IsSwapchainMaintenance1Supported())
+		{
+			auto getSurfaceCapabilities2 = (PFN_vkGetPhysicalDeviceSurfaceCapabilities2KHR)
+				vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceSurfaceCapabilities2KHR");
+			VkSurfacePresentModeEXT surfacePresentMode{ .sType = VK_STRUCTURE_TYPE_SURFACE_PRESENT_MODE_EXT, .presentMode = m_swapchain_present_mode };
+			const VkPhysicalDeviceSurfaceInfo2KHR surfaceInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SURFACE_INFO_2_KHR,
+				.pNext = &surfacePresentMode,
+				.surface = m_surface
+			};
+			VkSurfacePresentModeCompatibilityEXT presentModeCompatibility{ .sType = VK_STRUCTURE_TYPE_SURFACE_PRESENT_MODE_COMPATIBILITY_EXT };
+			VkSurfaceCapabilities2KHR surfaceCapabilities2{ .sType = VK_STRUCTURE_TYPE_SURFACE_CAPABILITIES_2_KHR, .pNext = &presentModeCompatibility };
+			getSurfaceCapabilities2(m_physical_device, &surfaceInfo, &surfaceCapabilities2); // Count
+			m_swapchain_present_modes.resize(presentModeCompatibility.presentModeCount);
+			presentModeCompatibility.pPresentModes = m_swapchain_present_modes.data();
+			getSurfaceCapabilities2(m_physical_device, &surfaceInfo, &surfaceCapabilities2);
+			m_swapchain_present_modes.resize(presentModeCompatibility.presentModeCount);
+			if (std::find(m_swapchain_present_modes.begin(), m_swapchain_present_modes.end(), m_swapchain_present_mode) == m_swapchain_present_modes.end())
+				m_swapchain_present_modes.emplace_back(m_swapchain_present_mode);
+
+			presentModesCreateInfo.presentModeCount = static_cast<uint32_t>(m_swapchain_present_modes.size());
+			presentModesCreateInfo.pPresentModes = m_swapchain_present_modes.data();
+			swapChainCreateInfo.pNext = &presentModesCreateInfo;
+			ReleaseSwapChainImage(); // An acquired image of an aborted frame would stay acquired by the retired swap chain
+		}
+		// Fixed rates of the surface format need VK_KHR_get_surface_capabilities2 (The driver chooses the rate without it)
+		VkImageCompressionFixedRateFlagsEXT compressionFixedRate = 0;
+		VkImageCompressionControlEXT compressionControl{ .sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT, .pNext = swapChainCreateInfo.pNext };
+		if (const auto& compression = m_swapchain_config.compression;
+			IsSwapchainCompressionControlSupported() && compression.mode != VMA::ImageCompression::DEFAULT)
+		{
+			compressionControl.flags = (compression.mode == VMA::ImageCompression::DISABLED)?
+				VK_IMAGE_COMPRESSION_DISABLED_EXT : VK_IMAGE_COMPRESSION_FIXED_RATE_DEFAULT_EXT;
+			if (compression.mode == VMA::ImageCompression::FIXED_RATE && compression.bits_per_component && m_shared_instance->surface_capabilities2)
+			{
+				auto getSurfaceFormats2 = (PFN_vkGetPhysicalDeviceSurfaceFormats2KHR)vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceSurfaceFormats2KHR");
+				const VkPhysicalDeviceSurfaceInfo2KHR surfaceInfo{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SURFACE_INFO_2_KHR, .surface = m_surface };
+				uint32_t formatCount = 0;
+				getSurfaceFormats2(m_physical_device, &surfaceInfo, &formatCount, nullptr);
+				std::vector<VkImageCompressionPropertiesEXT> compressionProperties(formatCount, { .sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_PROPERTIES_EXT });
+				std::vector<VkSurfaceFormat2KHR> surfaceFormats(formatCount, { .sType = VK_STRUCTURE_TYPE_SURFACE_FORMAT_2_KHR });
+				for (uint32_t index = 0; index < formatCount; ++index) surfaceFormats[index].pNext = &compressionProperties[index];
+				getSurfaceFormats2(m_physical_device, &surfaceInfo, &formatCount, surfaceFormats.data());
+				for (uint32_t index = 0; index < formatCount; ++index)
+				{
+					const auto& surfaceFormat = surfaceFormats[index].surfaceFormat;
+					if (surfaceFormat.format == m_swapchain_image_format && surfaceFormat.colorSpace == m_swapchain_color_space)
+						compressionFixedRate = compression.SelectFixedRate(compressionProperties[index].imageCompressionFixedRateFlags);
+				}
+				if (compressionFixedRate)
+				{
+					compressionControl.flags = VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT;
+					compressionControl.compressionControlPlaneCount = 1;
+					compressionControl.pFixedRateFlags = &compressionFixedRate;
+				}
+			}
+			swapChainCreateInfo.pNext = &compressionControl;
+		}
+#ifdef _WIN32
+		// Application-controlled: Acquired below, lost (VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT) when the window leaves the monitor
+		VkSurfaceFullScreenExclusiveWin32InfoEXT fullScreenExclusiveWin32Info
+		{
+			.sType = VK_STRUCTURE_TYPE_SURFACE_FULL_SCREEN_EXCLUSIVE_WIN32_INFO_EXT,
+			.pNext = swapChainCreateInfo.pNext,
+			.hmonitor = MonitorFromWindow(glfwGetWin32Window(m_window), MONITOR_DEFAULTTOPRIMARY)
+		};
+		VkSurfaceFullScreenExclusiveInfoEXT fullScreenExclusiveInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SURFACE_FULL_SCREEN_EXCLUSIVE_INFO_EXT,
+			.pNext = &fullScreenExclusiveWin32Info,
+			.fullScreenExclusive = VK_FULL_SCREEN_EXCLUSIVE_APPLICATION_CONTROLLED_EXT
+		};
+		if (IsFullScreenExclusiveSupported()) swapChainCreateInfo.pNext = &fullScreenExclusiveInfo;
+#endif
+		VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+		if (vkCreateSwapchainKHR(m_device, &swapChainCreateInfo, m_memory_allocation_callback, &swapchain) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create the Vulkan Swap Chain!");
+		m_swapchain_image_acquired = false;
+		retire_swap_chain(); // Images of the old swap chain may still be used by frames in flight
+		m_swapchain = swapchain;
+		++m_swapchain_generation;
+#ifdef _WIN32
+		// Composited until the next recreation if the window is not full-screen on its monitor yet
+		if (IsFullScreenExclusiveSupported() &&
+			reinterpret_cast<PFN_vkAcquireFullScreenExclusiveModeEXT>(m_acquire_full_screen_exclusive_mode)(m_device, m_swapchain) != VK_SUCCESS)
+			log::warn("Failed to acquire the full-screen exclusive mode (Retried by the next swap chain recreation)");
+#endif
+
+		create_depth_stencil_image();
+
+		// Retrieve the swap chain images
+		vkGetSwapchainImagesKHR(m_device, m_swapchain, &m_swapchain_image_count, nullptr);
+		m_swapchain_images.resize(m_swapchain_image_count);
+		vkGetSwapchainImagesKHR(m_device, m_swapchain, &m_swapchain_image_count, m_swapchain_images.data());
+
+		// Create Image Views
+		m_swapchain_imageviews.resize(m_swapchain_image_count);
+		for (size_t idx = 0; idx < m_swapchain_image_count; ++idx)
+		{
+			VkImageViewCreateInfo imageViewCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image = m_swapchain_images[idx],
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,
+				.format = m_swapchain_image_format,
+				.components{.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+										.g = VK_COMPONENT_SWIZZLE_IDENTITY,
+										.b = VK_COMPONENT_SWIZZLE_IDENTITY,
+										.a = VK_COMPONENT_SWIZZLE_IDENTITY},
+				.subresourceRange{.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+													.baseMipLevel = 0,
+													.levelCount = 1,
+													.baseArrayLayer = 0,
+													.layerCount = 1}
+			};
+			if (vkCreateImageView(m_device, &imageViewCreateInfo, m_memory_allocation_callback, &m_swapchain_imageviews[idx]) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create all image views");
+		}
+
+		if (m_device_queue_family_graphics != m_device_queue_family_present)
+			m_present_ownership_transfer = create_present_ownership_transfer(m_swapchain_images);
+	}
+
+	PresentOwnershipTransfer VulkanContext::create_present_ownership_transfer(std::span<const VkImage> swapchain_images)
+	{
+		PresentOwnershipTransfer transfer;
+		const auto imageCount = static_cast<uint32_t>(swapchain_images.size());
+		auto create_commands = [this, imageCount](uint32_t queue_family, VkCommandPool& command_pool, std::vector<VkCommandBuffer>& command_buffers)
+		{
+			VkCommandPoolCreateInfo commandPoolCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.queueFamilyIndex = queue_family
+			};
+			if (vkCreateCommandPool(m_device, &commandPoolCreateInfo, m_memory_allocation_callback, &command_pool) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Present Ownership Command Pool!");
+			command_buffers.resize(imageCount);
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = command_pool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = imageCount
+			};
+			if (vkAllocateCommandBuffers(m_device, &commandBufferAllocateInfo, command_buffers.data()) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Present Ownership Command Buffers!");
+		};
+		try
+		{
+			create_commands(m_device_queue_family_graphics.value(), transfer.release_command_pool, transfer.release_commands);
+			create_commands(m_device_queue_family_present.value(), transfer.acquire_command_pool, transfer.acquire_commands);
+
+			VkSemaphoreCreateInfo semaphoreCreateInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			for (uint32_t idx = 0; idx < imageCount; ++idx)
+			{
+				for (auto* semaphores : { &transfer.released_semaphores, &transfer.acquired_semaphores })
+				{
+					VkSemaphore semaphore = VK_NULL_HANDLE;
+					if (vkCreateSemaphore(m_device, &semaphoreCreateInfo, m_memory_allocation_callback, &semaphore) != VK_SUCCESS)
+						throw std::runtime_error("Failed to create the Vulkan Present Ownership Semaphores!");
+					semaphores->emplace_back(semaphore);
+				}
+
+				// The layout stays PRESENT_SRC_KHR, only the ownership moves (The release has no destination access, the acquire no source access)
+				VkImageMemoryBarrier2 barrier
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+					.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+					.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+					.dstAccessMask = 0,
+					.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+					.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+					.srcQueueFamilyIndex = m_device_queue_family_graphics.value(),
+					.dstQueueFamilyIndex = m_device_queue_family_present.value(),
+					.image = swapchain_images[idx],
+					.subresourceRange{.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+														.baseMipLevel = 0,
+														.levelCount = 1,
+														.baseArrayLayer = 0,
+														.layerCount = 1}
+				};
+				VkCommandBufferBeginInfo commandBufferBeginInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+				for (auto command_buffer : { transfer.release_commands[idx], transfer.acquire_commands[idx] })
+				{
+					if (m_dispatch.vkBeginCommandBuffer(command_buffer, &commandBufferBeginInfo) != VK_SUCCESS)
+						throw std::runtime_error("Failed to begin the Vulkan Present Ownership Command Buffers!");
+					CommandBuffer::PipelineBarrier(command_buffer, *this, { barrier });
+					if (m_dispatch.vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+						throw std::runtime_error("Failed to end the Vulkan Present Ownership Command Buffers!");
+					// Acquire (Identical ownership fields)
+					barrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+					barrier.srcAccessMask = 0;
+				}
+			}
+		}
+		catch (...)
+		{
+			destroy_present_ownership_transfer(transfer);
+			throw;
+		}
+		return transfer;
+	}
 
-		// Create Depth Image
+	void VulkanContext::create_offscreen_images()
+	{
+		if (!check_swap_chain_depth_format_support())
+			throw std::runtime_error(std::format("Failed to create the Offscreen Images - Depth format is not supported!"));
+		assert(m_swapchain_image_count > 0 && m_swapchain_current_extent.width && m_swapchain_current_extent.height && "Invalid headless swap chain!");
+
+		// Frames in flight keep rendering into the previous ring, its images are deferred by their destructors
+		m_offscreen_images.clear();
+		m_swapchain_images.clear();
+		m_swapchain_imageviews.clear();
+		m_swapchain_image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; // Read back or composite
+		for (uint32_t index = 0; index < m_swapchain_image_count; ++index)
+		{
+			auto& offscreenImage = m_offscreen_images.emplace_back(m_memory_allocator->AllocateImage
+				(VK_IMAGE_ASPECT_COLOR_BIT,
+				m_swapchain_image_usage,
+				m_swapchain_current_extent.width,
+				m_swapchain_current_extent.height,
+				4, m_swapchain_image_format,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL, 1, VMA::MemoryPool::RENDER_TARGET));
+			if constexpr (EnableDebugMarkers) offscreenImage->SetDebugName(std::format("Offscreen Image {}", index).c_str());
+			m_swapchain_images.emplace_back(*offscreenImage);
+			m_swapchain_imageviews.emplace_back(offscreenImage->GetImageView());
+		}
+		m_swapchain_current_image_index = m_swapchain_image_count - 1; // The first acquisition returns 0
+
+		create_depth_stencil_image();
+		++m_swapchain_generation;
+	}
+
+	void VulkanContext::create_depth_stencil_image()
+	{
 		m_swapchain_depth_stencil_image = m_memory_allocator->AllocateImage
-																		   (VK_IMAGE_ASPECT_DEPTH_BIT,
-																			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+																		   (GetFormatAspect(m_swapchain_depth_stencil_format),
+																			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, // Lazily allocated on tile-based GPUs
 																			m_swapchain_current_extent.width,
 																			m_swapchain_current_extent.height,
 																			m_swapchain_depth_channel + m_swapchain_stencil_channel,
 																			m_swapchain_depth_stencil_format,
 																			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+	}
+
+	void VulkanContext::suspend_swap_chain()
+	{
+		if (m_swapchain_suspended) return;
+		ALBEDO_RHI_TRACE_ZONE("RHI::SuspendSwapChain");
+		m_swapchain_suspended = true;
+		ReleaseSwapChainImage();
+		retire_swap_chain(); // Frames in flight finish with the old images
+		m_swapchain_depth_stencil_image.reset();
+		m_swapchain_current_extent = {};
+		if (m_swapchain_config.trim_memory_on_suspend)
+		{
+			auto trimmedBytes = m_memory_allocator->TrimMemory();
+			log::info("Swap Chain suspended (Trimmed {} bytes of empty memory pools)", trimmedBytes);
+		}
+		else log::info("Swap Chain suspended");
+	}
+
+	void VulkanContext::retire_swap_chain()
+	{
+		if (m_swapchain == VK_NULL_HANDLE) return;
+		// Destroyed once the GPU has passed all submitted work (The old depth image is deferred by its destructor)
+		// Maintenance1: Also after its present fences (The presentation engine has released its semaphores and images)
+		std::vector<VkFence> presentFences;
+		{
+			std::scoped_lock guard{ m_present_fences_mutex };
+			for (const auto& present_fence : m_present_fences) presentFences.emplace_back(present_fence.fence);
+			m_present_fences.clear();
+		}
+		DeferDeletion([this, swapchain = m_swapchain, imageviews = std::move(m_swapchain_imageviews), present_fences = std::move(presentFences)]()
+			{
+				if (!present_fences.empty())
+				{
+					vkWaitForFences(m_device, static_cast<uint32_t>(present_fences.size()), present_fences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+					for (auto fence : present_fences) GetSyncPool().ReleaseFence(fence);
+				}
+				for (auto imageview : imageviews)
+					vkDestroyImageView(m_device, imageview, m_memory_allocation_callback);
+				vkDestroySwapchainKHR(m_device, swapchain, m_memory_allocation_callback);
+			});
+		if (m_present_ownership_transfer) // Its command buffers may be pending in frames in flight
+		{
+			DeferDeletion([this, transfer = std::move(*m_present_ownership_transfer)]() { destroy_present_ownership_transfer(transfer); });
+			m_present_ownership_transfer.reset();
+		}
+		m_swapchain = VK_NULL_HANDLE;
+		m_swapchain_imageviews.clear();
+		m_swapchain_images.clear();
+	}
+
+	void VulkanContext::destroy_swap_chain()
+	{
+		if (IsHeadless())
+		{
+			m_offscreen_images.clear(); // Owns the images and views
+			m_swapchain_images.clear();
+			m_swapchain_imageviews.clear();
+			m_swapchain_depth_stencil_image.reset();
+			return;
+		}
+		WaitPresent(std::numeric_limits<uint64_t>::max()); // Maintenance1
+		for (auto imageview : m_swapchain_imageviews)
+			vkDestroyImageView(m_device, imageview, m_memory_allocation_callback);
+		vkDestroySwapchainKHR(m_device, m_swapchain, m_memory_allocation_callback);
+		m_swapchain_depth_stencil_image.reset();
+		if (m_present_ownership_transfer)
+		{
+			destroy_present_ownership_transfer(*m_present_ownership_transfer);
+			m_present_ownership_transfer.reset();
+		}
+	}
+
+	void VulkanContext::destroy_present_ownership_transfer(const PresentOwnershipTransfer& transfer)
+	{
+		for (auto semaphore : transfer.released_semaphores) vkDestroySemaphore(m_device, semaphore, m_memory_allocation_callback);
+		for (auto semaphore : transfer.acquired_semaphores) vkDestroySemaphore(m_device, semaphore, m_memory_allocation_callback);
+		// The command buffers are freed with their pools
+		if (transfer.release_command_pool != VK_NULL_HANDLE) vkDestroyCommandPool(m_device, transfer.release_command_pool, m_memory_allocation_callback);
+		if (transfer.acquire_command_pool != VK_NULL_HANDLE) vkDestroyCommandPool(m_device, transfer.acquire_command_pool, m_memory_allocation_callback);
+	}
+
+	void VulkanContext::create_upload_engine()
+	{
+		m_upload_engine = std::make_unique<UploadEngine>(this);
+	}
+
+	void VulkanContext::create_completion_poller()
+	{
+		m_completion_poller = std::make_unique<CompletionPoller>(this);
+	}
+
+	void VulkanContext::create_deletion_queue()
+	{
+		m_deletion_queue = std::make_unique<DeletionQueue>(this);
+	}
+
+	void VulkanContext::create_sync_pool()
+	{
+		m_sync_pool = std::make_unique<SyncPool>(this);
+	}
+
+	void VulkanContext::destroy_sync_pool()
+	{
+		m_sync_pool.reset();
+	}
+
+	void VulkanContext::create_resource_registry()
+	{
+		m_resource_registry = std::make_unique<ResourceRegistry>(this);
+	}
+
+	void VulkanContext::destroy_resource_registry()
+	{
+		m_resource_registry.reset();
+	}
+
+	void VulkanContext::destroy_deletion_queue()
+	{
+		m_deletion_queue.reset(); // Objects destroyed later are deleted immediately
+	}
+
+	void VulkanContext::WaitDeviceIdle()
+	{
+		vkDeviceWaitIdle(m_device);
+		if (m_deletion_queue) m_deletion_queue->Flush();
+	}
+
+	void VulkanContext::DeferDeletion(DeletionQueue::Deleter deleter)
+	{
+		if (m_deletion_queue) m_deletion_queue->Enqueue(std::move(deleter));
+		else deleter();
+	}
+
+	void VulkanContext::CollectDeletions()
+	{
+		if (m_deletion_queue) m_deletion_queue->Collect();
+	}
+
+	void VulkanContext::invalidate_baked_commands(uint64_t handle)
+	{
+		std::scoped_lock guard{ m_baked_command_buffers_mutex };
+		std::erase_if(m_baked_command_buffers, [handle](CommandBufferBaked* baked_command_buffer)
+			{
+				auto& dependencies = baked_command_buffer->m_dependencies;
+				if (!std::binary_search(dependencies.begin(), dependencies.end(), handle)) return false;
+				baked_command_buffer->m_is_valid = false; // Baked again on the next Bake()
+				return true;
+			});
+		m_baked_command_buffer_count = m_baked_command_buffers.size();
+	}
+
+	void VulkanContext::invalidate_descriptor_set_caches(uint64_t handle)
+	{
+		std::vector<std::shared_ptr<DescriptorSet>> evictedSets; // Released after unlocking (Their destructors invalidate their handles)
+		std::scoped_lock guard{ m_descriptor_set_caches_mutex };
+		for (auto* descriptor_set_cache : m_descriptor_set_caches) descriptor_set_cache->evict(handle, evictedSets);
+	}
+
+	void VulkanContext::destroy_upload_engine()
+	{
+		m_upload_engine.reset();
+	}
+
+	void VulkanContext::destroy_completion_poller()
+	{
+		m_completion_poller.reset();
+	}
+
+	void VulkanContext::destroy_bindless_heap()
+	{
+		m_bindless_heap.reset();
+	}
+
+	void VulkanContext::destroy_shader_cache()
+	{
+		if (!m_shader_cache) return;
+		std::scoped_lock guard{ PIPELINE_CACHE_FILE_MUTEX };
+		if (!m_pipeline_cache_file.empty())
+		{
+			try { m_shader_cache->SaveShaderReflections(m_pipeline_cache_file + ".reflection"); } // Never throw from ~VulkanContext()
+			catch (const std::exception& error) { log::warn("Failed to save the shader reflections - {}", error.what()); }
+		}
+		m_shader_cache.reset();
+	}
+
+	void VulkanContext::destroy_pipeline_cache()
+	{
+		try { SavePipelineCache(); } // Never throw from ~VulkanContext()
+		catch (const std::exception& error) { log::warn("Failed to save the pipeline cache - {}", error.what()); }
+		vkDestroyPipelineCache(m_device, m_pipeline_cache, m_memory_allocation_callback);
+	}
+
+	void VulkanContext::destroy_memory_allocator()
+	{
+		m_memory_allocator.reset();
+	}
+
+	void VulkanContext::destroy_logical_device()
+	{
+		vkDeviceWaitIdle(m_device);
+		vkDestroyDevice(m_device, m_memory_allocation_callback);
+	}
+
+	void VulkanContext::destroy_surface()
+	{
+		vkDestroySurfaceKHR(m_instance, m_surface, m_memory_allocation_callback);
+	}
+
+	void VulkanContext::destroy_vulkan_instance()
+	{
+		m_debug_messenger = VK_NULL_HANDLE;
+		m_instance = VK_NULL_HANDLE;
+		m_shared_instance.reset();
+	}
+
+	void VulkanContext::destroy_worker_pool()
+	{
+		m_worker_pool.reset();
+	}
+
+	bool VulkanContext::check_physical_device_features_support()
+	{
+		// Properties
+		const auto& capabilities = get_physical_device_capabilities();
+		m_physical_device_properties = capabilities.properties;
+		if (m_physical_device_properties.apiVersion < VK_API_VERSION_1_1) // Device UUID (Any device type is scored)
+			return false;
+
+		// Basic Features
+		m_physical_device_features = capabilities.features;
+		if (m_physical_device_features.samplerAnisotropy != VK_TRUE)
+			return false;
+
+		return true;
+	}
+
+	void VulkanContext::query_physical_device_advanced_features()
+	{
+		// Vulkan 1.1 ~ 1.3 Features (Chained only if the device supports the version)
+		const uint32_t deviceApiVersion = m_physical_device_properties.apiVersion;
+		if (deviceApiVersion < VK_API_VERSION_1_2) return;
+
+		m_physical_device_features11.pNext = &m_physical_device_features12;
+		m_physical_device_features12.pNext = deviceApiVersion >= VK_API_VERSION_1_3 ? &m_physical_device_features13 : nullptr;
+		m_physical_device_features2 = VkPhysicalDeviceFeatures2
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &m_physical_device_features11
+		};
+		vkGetPhysicalDeviceFeatures2(m_physical_device, &m_physical_device_features2.value());
+		m_physical_device_features = m_physical_device_features2->features;
+
+		VkPhysicalDeviceProperties2 physicalDeviceProperties2
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &m_physical_device_properties12
+		};
+		vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+
+		query_physical_device_present_wait_support();
+		query_physical_device_swapchain_maintenance1_support();
+		query_physical_device_mesh_shader_support();
+		query_physical_device_pipeline_library_support();
+		query_physical_device_memory_budget_support();
+		query_physical_device_external_memory_host_support();
+		query_physical_device_external_memory_support();
+		query_physical_device_acceleration_structure_support();
+		query_physical_device_push_descriptor_support();
+		query_physical_device_descriptor_buffer_support();
+		query_physical_device_conditional_rendering_support();
+		query_physical_device_fragment_shading_rate_support();
+		query_physical_device_crash_diagnostics_support();
+		query_physical_device_host_image_copy_support();
+		query_physical_device_memory_priority_support();
+		query_physical_device_multi_draw_support();
+		query_physical_device_shader_object_support();
+		query_physical_device_video_encode_support();
+		query_physical_device_calibrated_timestamps_support();
+		query_physical_device_global_priority_support();
+		query_physical_device_image_compression_control_support();
+		query_physical_device_full_screen_exclusive_support();
+		disable_unused_physical_device_features();
+	}
+
+	void VulkanContext::query_physical_device_features(void* features)
+	{
+		VkPhysicalDeviceFeatures2 physicalDeviceFeatures2
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = features
+		};
+		vkGetPhysicalDeviceFeatures2(m_physical_device, &physicalDeviceFeatures2);
+	}
+
+	void VulkanContext::chain_physical_device_features(void* features)
+	{
+		auto tail = reinterpret_cast<VkBaseOutStructure*>(&m_physical_device_features2.value());
+		while (tail->pNext) tail = tail->pNext;
+		tail->pNext = reinterpret_cast<VkBaseOutStructure*>(features);
+	}
+
+	void VulkanContext::disable_unused_physical_device_features()
+	{
+		// Capture & replay addresses are for debugging tools only (May cost address space on some drivers)
+		m_physical_device_features12.bufferDeviceAddressCaptureReplay = VK_FALSE;
+		// Secondary command buffers never inherit a predicate (See CommandBuffer::BeginConditional())
+		m_physical_device_conditional_rendering_features.inheritedConditionalRendering = VK_FALSE;
+		// Without the extension the struct is not chained, and the other rates must not be reported as supported
+		if (!IsFragmentShadingRateSupported())
+		{
+			m_physical_device_fragment_shading_rate_features.primitiveFragmentShadingRate = VK_FALSE;
+			m_physical_device_fragment_shading_rate_features.attachmentFragmentShadingRate = VK_FALSE;
+		}
+		// Per-primitive rates of mesh shaders need the primitive rates of VK_KHR_fragment_shading_rate
+		if (!m_physical_device_fragment_shading_rate_features.primitiveFragmentShadingRate)
+			m_physical_device_mesh_shader_features.primitiveFragmentShadingRateMeshShader = VK_FALSE;
+		// Device builds of acceleration structures only
+		m_physical_device_acceleration_structure_features.accelerationStructureCaptureReplay = VK_FALSE;
+		m_physical_device_acceleration_structure_features.accelerationStructureHostCommands = VK_FALSE;
+		// Descriptor buffer capture & replay is for debugging tools only
+		m_physical_device_descriptor_buffer_features.descriptorBufferCaptureReplay = VK_FALSE;
+		// Push descriptor sets in descriptor buffer layouts need VK_KHR_push_descriptor
+		if (!IsPushDescriptorSupported()) m_physical_device_descriptor_buffer_features.descriptorBufferPushDescriptors = VK_FALSE;
+		// Pageable device-local memory requires the priorities
+		if (!IsMemoryPrioritySupported()) m_physical_device_pageable_memory_features.pageableDeviceLocalMemory = VK_FALSE;
+		// Swap chain compression requires the image compression control
+		if (!IsImageCompressionControlSupported()) m_physical_device_swapchain_compression_control_features.imageCompressionControlSwapchain = VK_FALSE;
+	}
+
+	void VulkanContext::query_physical_device_present_wait_support()
+	{
+		if (IsHeadless() ||
+			!is_device_extension_available(VK_KHR_PRESENT_ID_EXTENSION_NAME) ||
+			!is_device_extension_available(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		m_physical_device_present_id_features.pNext = &m_physical_device_present_wait_features;
+		query_physical_device_features(&m_physical_device_present_id_features);
+
+		if (IsFramePacingSupported())
+		{
+			chain_physical_device_features(&m_physical_device_present_id_features);
+			m_device_extensions.emplace_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+			m_device_extensions.emplace_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_swapchain_maintenance1_support()
+	{
+		if (IsHeadless() || !m_shared_instance->surface_maintenance1 ||
+			!is_device_extension_available(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_swapchain_maintenance1_features);
+
+		if (IsSwapchainMaintenance1Supported())
+		{
+			chain_physical_device_features(&m_physical_device_swapchain_maintenance1_features);
+			m_device_extensions.emplace_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_mesh_shader_support()
+	{
+		if (!is_device_extension_available(VK_EXT_MESH_SHADER_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_mesh_shader_features);
+
+		if (IsMeshShaderSupported())
+		{
+			chain_physical_device_features(&m_physical_device_mesh_shader_features);
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &m_physical_device_mesh_shader_properties
+			};
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_pipeline_library_support()
+	{
+		if (!is_device_extension_available(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+			!is_device_extension_available(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_pipeline_library_features);
+
+		if (IsGraphicsPipelineLibrarySupported())
+		{
+			chain_physical_device_features(&m_physical_device_pipeline_library_features);
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &m_physical_device_pipeline_library_properties
+			};
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+			m_device_extensions.emplace_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_memory_budget_support()
+	{
+		// VMA queries it through vkGetPhysicalDeviceMemoryProperties2 (Vulkan 1.1)
+		m_memory_budget_supported = is_device_extension_available(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		if (m_memory_budget_supported) m_device_extensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+
+	void VulkanContext::query_physical_device_external_memory_host_support()
+	{
+		if (!is_device_extension_available(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) return;
+
+		VkPhysicalDeviceProperties2 physicalDeviceProperties2
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &m_physical_device_external_memory_host_properties
+		};
+		vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+		m_external_memory_host_supported = true;
+		m_device_extensions.emplace_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+	}
+
+	void VulkanContext::query_physical_device_external_memory_support()
+	{
+#ifdef _WIN32
+		const std::array extensions{ VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME };
+#else
+		const std::array extensions{ VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME };
+#endif
+		if (!m_physical_device_features12.timelineSemaphore ||
+			!std::all_of(extensions.begin(), extensions.end(), [this](const char* extension) { return is_device_extension_available(extension); }))
+			return;
+
+		// Timeline semaphores must be both exportable and importable (External memory core since Vulkan 1.1)
+		VkSemaphoreTypeCreateInfo semaphoreTypeInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE
+		};
+		VkPhysicalDeviceExternalSemaphoreInfo externalSemaphoreInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO,
+			.pNext = &semaphoreTypeInfo,
+			.handleType = ExternalSemaphoreHandleType
+		};
+		VkExternalSemaphoreProperties externalSemaphoreProperties{ .sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES };
+		vkGetPhysicalDeviceExternalSemaphoreProperties(m_physical_device, &externalSemaphoreInfo, &externalSemaphoreProperties);
+		constexpr VkExternalSemaphoreFeatureFlags semaphoreFeatures =
+			VK_EXTERNAL_SEMAPHORE_FEATURE_EXPORTABLE_BIT | VK_EXTERNAL_SEMAPHORE_FEATURE_IMPORTABLE_BIT;
+		if ((externalSemaphoreProperties.externalSemaphoreFeatures & semaphoreFeatures) != semaphoreFeatures) return;
+
+		m_external_memory_supported = true;
+		for (auto extension : extensions) m_device_extensions.emplace_back(extension);
+#ifndef _WIN32
+		m_external_memory_dma_buf_supported = is_device_extension_available(VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME);
+		if (m_external_memory_dma_buf_supported) m_device_extensions.emplace_back(VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME);
+#endif
+	}
+
+	void VulkanContext::query_physical_device_acceleration_structure_support()
+	{
+		if (!IsBufferDeviceAddressSupported() ||
+			!is_device_extension_available(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME) ||
+			!is_device_extension_available(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_acceleration_structure_features);
+
+		if (IsAccelerationStructureSupported())
+		{
+			chain_physical_device_features(&m_physical_device_acceleration_structure_features);
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &m_physical_device_acceleration_structure_properties
+			};
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
+			m_device_extensions.emplace_back(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_push_descriptor_support()
+	{
+		if (!is_device_extension_available(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) return;
+
+		VkPhysicalDeviceProperties2 physicalDeviceProperties2
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &m_physical_device_push_descriptor_properties
+		};
+		vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+		m_push_descriptor_supported = true;
+		m_device_extensions.emplace_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+	}
+
+	void VulkanContext::query_physical_device_descriptor_buffer_support()
+	{
+		if (!IsBufferDeviceAddressSupported() ||
+			!is_device_extension_available(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_descriptor_buffer_features);
+
+		if (IsDescriptorBufferSupported())
+		{
+			chain_physical_device_features(&m_physical_device_descriptor_buffer_features);
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &m_physical_device_descriptor_buffer_properties
+			};
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_conditional_rendering_support()
+	{
+		if (!is_device_extension_available(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_conditional_rendering_features);
+
+		if (IsConditionalRenderingSupported())
+		{
+			chain_physical_device_features(&m_physical_device_conditional_rendering_features);
+			m_device_extensions.emplace_back(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_fragment_shading_rate_support()
+	{
+		if (!is_device_extension_available(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_fragment_shading_rate_features);
+
+		if (IsFragmentShadingRateSupported())
+		{
+			chain_physical_device_features(&m_physical_device_fragment_shading_rate_features);
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &m_physical_device_fragment_shading_rate_properties
+			};
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
+		}
+	}
+
+	void VulkanContext::query_physical_device_crash_diagnostics_support()
+	{
+		// No features to enable, only used once CrashBreadcrumbs are enabled
+		if (is_device_extension_available(VK_AMD_BUFFER_MARKER_EXTENSION_NAME))
+		{
+			m_buffer_marker_supported = true;
+			m_device_extensions.emplace_back(VK_AMD_BUFFER_MARKER_EXTENSION_NAME);
+		}
+		if (is_device_extension_available(VK_NV_DEVICE_DIAGNOSTIC_CHECKPOINTS_EXTENSION_NAME))
+		{
+			m_diagnostic_checkpoints_supported = true;
+			m_device_extensions.emplace_back(VK_NV_DEVICE_DIAGNOSTIC_CHECKPOINTS_EXTENSION_NAME);
+		}
+	}
 
-		// Retrieve the swap chain images
-		vkGetSwapchainImagesKHR(m_device, m_swapchain, &m_swapchain_image_count, nullptr);
-		m_swapchain_images.resize(m_swapchain_image_count);
-		vkGetSwapchainImagesKHR(m_device, m_swapchain, &m_swapchain_image_count, m_swapchain_images.data());
+	void VulkanContext::query_physical_device_host_image_copy_support()
+	{
+		if (!is_device_extension_available(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)) return;
 
-		// Create Image Views
-		m_swapchain_imageviews.resize(m_swapchain_image_count);
-		for (size_t idx = 0; idx < m_swapchain_image_count; ++idx)
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_host_image_copy_features);
+
+		if (IsHostImageCopySupported())
 		{
-			VkImageViewCreateInfo imageViewCreateInfo
+			chain_physical_device_features(&m_physical_device_host_image_copy_features);
+			// Layouts the images can be copied into (Always contains GENERAL)
+			VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT };
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
 			{
-				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-				.image = m_swapchain_images[idx],
-				.viewType = VK_IMAGE_VIEW_TYPE_2D,
-				.format = m_swapchain_image_format,
-				.components{.r = VK_COMPONENT_SWIZZLE_IDENTITY,
-										.g = VK_COMPONENT_SWIZZLE_IDENTITY,
-										.b = VK_COMPONENT_SWIZZLE_IDENTITY,
-										.a = VK_COMPONENT_SWIZZLE_IDENTITY},
-				.subresourceRange{.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-													.baseMipLevel = 0,
-													.levelCount = 1,
-													.baseArrayLayer = 0,
-													.layerCount = 1}
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &hostImageCopyProperties
 			};
-			if (vkCreateImageView(m_device, &imageViewCreateInfo, m_memory_allocation_callback, &m_swapchain_imageviews[idx]) != VK_SUCCESS)
-				throw std::runtime_error("Failed to create all image views");
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_host_image_copy_dst_layouts.resize(hostImageCopyProperties.copyDstLayoutCount);
+			hostImageCopyProperties.pCopyDstLayouts = m_host_image_copy_dst_layouts.data();
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
 		}
 	}
 
-	void VulkanContext::destroy_swap_chain()
+	void VulkanContext::query_physical_device_memory_priority_support()
 	{
-		for (auto imageview : m_swapchain_imageviews)
-			vkDestroyImageView(m_device, imageview, m_memory_allocation_callback);
-		vkDestroySwapchainKHR(m_device, m_swapchain, m_memory_allocation_callback);
+		if (!is_device_extension_available(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		const bool isPageableAvailable = is_device_extension_available(VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME);
+		if (isPageableAvailable) m_physical_device_memory_priority_features.pNext = &m_physical_device_pageable_memory_features;
+		query_physical_device_features(&m_physical_device_memory_priority_features);
+		// The pageable struct is enabled only together with the priorities
+		if (!IsMemoryPrioritySupported() || !IsPageableDeviceLocalMemorySupported()) m_physical_device_memory_priority_features.pNext = nullptr;
+		if (!IsMemoryPrioritySupported()) return;
+
+		chain_physical_device_features(&m_physical_device_memory_priority_features);
+		m_device_extensions.emplace_back(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
+		if (IsPageableDeviceLocalMemorySupported())
+			m_device_extensions.emplace_back(VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME);
 	}
 
-	void VulkanContext::destroy_memory_allocator()
+	void VulkanContext::query_physical_device_multi_draw_support()
 	{
-		m_memory_allocator.reset();
+		if (!is_device_extension_available(VK_EXT_MULTI_DRAW_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_multi_draw_features);
+
+		if (IsMultiDrawSupported())
+		{
+			chain_physical_device_features(&m_physical_device_multi_draw_features);
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &m_physical_device_multi_draw_properties
+			};
+			vkGetPhysicalDeviceProperties2(m_physical_device, &physicalDeviceProperties2);
+			m_device_extensions.emplace_back(VK_EXT_MULTI_DRAW_EXTENSION_NAME);
+		}
 	}
 
-	void VulkanContext::destroy_logical_device()
+	void VulkanContext::query_physical_device_shader_object_support()
 	{
-		vkDeviceWaitIdle(m_device);
-		vkDestroyDevice(m_device, m_memory_allocation_callback);
+		// Shader objects only render with Dynamic Rendering
+		if (!m_physical_device_features13.dynamicRendering || !is_device_extension_available(VK_EXT_SHADER_OBJECT_EXTENSION_NAME)) return;
+
+		// Query on its own, chained only if enabled
+		query_physical_device_features(&m_physical_device_shader_object_features);
+		if (IsShaderObjectSupported())
+		{
+			chain_physical_device_features(&m_physical_device_shader_object_features);
+			m_device_extensions.emplace_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+		}
 	}
 
-	void VulkanContext::destroy_debug_messenger()
+	void VulkanContext::query_physical_device_video_encode_support()
 	{
-		if (!EnableValidationLayers) return;
+		// Vulkan Video needs synchronization2 (Its stages and accesses have no legacy flags)
+		if (!m_device_queue_family_video_encode.has_value() || !m_physical_device_features13.synchronization2 ||
+			!is_device_extension_available(VK_KHR_VIDEO_QUEUE_EXTENSION_NAME) ||
+			!is_device_extension_available(VK_KHR_VIDEO_ENCODE_QUEUE_EXTENSION_NAME) ||
+			!is_device_extension_available(VK_KHR_VIDEO_ENCODE_H264_EXTENSION_NAME))
+		{
+			m_device_queue_family_video_encode.reset();
+			return;
+		}
+
+		// The encode family must support H.264
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties2(m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyVideoPropertiesKHR> videoProperties(queueFamilyCount, { .sType = VK_STRUCTURE_TYPE_QUEUE_FAMILY_VIDEO_PROPERTIES_KHR });
+		std::vector<VkQueueFamilyProperties2> queueFamilies(queueFamilyCount, { .sType = VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2 });
+		for (uint32_t index = 0; index < queueFamilyCount; ++index) queueFamilies[index].pNext = &videoProperties[index];
+		vkGetPhysicalDeviceQueueFamilyProperties2(m_physical_device, &queueFamilyCount, queueFamilies.data());
+		if (!(videoProperties[m_device_queue_family_video_encode.value()].videoCodecOperations & VK_VIDEO_CODEC_OPERATION_ENCODE_H264_BIT_KHR))
+		{
+			m_device_queue_family_video_encode.reset();
+			return;
+		}
 
-		log::warn("\n[Vulkan Messenger Statistics]");
-		log::info("VERBOSE: {}", s_debug_message_statistics[VERBOSE]);
-		log::info("INFO: {}", s_debug_message_statistics[INFO]);
-		log::info("WARN: {}", s_debug_message_statistics[WARN]);
-		log::info("ERROR: {}", s_debug_message_statistics[ERROR]);
-		auto loadFunction = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(m_instance, "vkDestroyDebugUtilsMessengerEXT");
-		if (loadFunction != nullptr) loadFunction(m_instance, m_debug_messenger, m_memory_allocation_callback);
-		else throw std::runtime_error("Failed to load function: vkDestroyDebugUtilsMessengerEXT");
+		// Physical device functions of a device extension (Loaded from the instance)
+		m_get_physical_device_video_capabilities = (PFN_vkGetPhysicalDeviceVideoCapabilitiesKHR)vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceVideoCapabilitiesKHR");
+		m_get_physical_device_video_format_properties = (PFN_vkGetPhysicalDeviceVideoFormatPropertiesKHR)vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceVideoFormatPropertiesKHR");
+		if (!m_get_physical_device_video_capabilities || !m_get_physical_device_video_format_properties)
+		{
+			m_device_queue_family_video_encode.reset();
+			return;
+		}
+		m_video_encode_h264_supported = true;
+		m_device_extensions.emplace_back(VK_KHR_VIDEO_QUEUE_EXTENSION_NAME);
+		m_device_extensions.emplace_back(VK_KHR_VIDEO_ENCODE_QUEUE_EXTENSION_NAME);
+		m_device_extensions.emplace_back(VK_KHR_VIDEO_ENCODE_H264_EXTENSION_NAME);
 	}
 
-	void VulkanContext::destroy_surface()
+	void VulkanContext::query_physical_device_calibrated_timestamps_support()
 	{
-		vkDestroySurfaceKHR(m_instance, m_surface, m_memory_allocation_callback);
+		if (!is_device_extension_available(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) return;
+
+		// Physical device function of a device extension (Loaded from the instance)
+		auto getTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+		if (!getTimeDomains) return;
+		uint32_t timeDomainCount = 0;
+		getTimeDomains(m_physical_device, &timeDomainCount, nullptr);
+		std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+		getTimeDomains(m_physical_device, &timeDomainCount, timeDomains.data());
+
+		// Both clocks must be sampled together, otherwise the calibration is no better than bracketing a timestamp query
+		auto hasTimeDomain = [&](VkTimeDomainEXT domain) { return std::find(timeDomains.begin(), timeDomains.end(), domain) != timeDomains.end(); };
+		if (!hasTimeDomain(VK_TIME_DOMAIN_DEVICE_EXT) || !hasTimeDomain(HostTimeDomain)) return;
+		m_calibrated_timestamps_supported = true;
+		m_device_extensions.emplace_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
 	}
 
-	void VulkanContext::destroy_vulkan_instance()
+	void VulkanContext::query_physical_device_global_priority_support()
 	{
-		vkDestroyInstance(m_instance, m_memory_allocation_callback);
+		if (is_device_extension_available(VK_KHR_GLOBAL_PRIORITY_EXTENSION_NAME))
+		{
+			// Query on its own, then append to the end of the feature chain (Supported priorities per family)
+			query_physical_device_features(&m_physical_device_global_priority_query_features);
+			chain_physical_device_features(&m_physical_device_global_priority_query_features);
+			m_global_priority_extension = VK_KHR_GLOBAL_PRIORITY_EXTENSION_NAME;
+		}
+		else if (is_device_extension_available(VK_EXT_GLOBAL_PRIORITY_EXTENSION_NAME))
+			m_global_priority_extension = VK_EXT_GLOBAL_PRIORITY_EXTENSION_NAME; // Requests are not checked against the family's support
+		else return;
+		m_device_extensions.emplace_back(m_global_priority_extension);
 	}
 
-	bool VulkanContext::check_physical_device_features_support()
+	void VulkanContext::query_physical_device_image_compression_control_support()
 	{
-		// Properties
-		vkGetPhysicalDeviceProperties(m_physical_device, &m_physical_device_properties);
-		if (m_physical_device_properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-			return false;
-
-		// Basic Features
-		vkGetPhysicalDeviceFeatures(m_physical_device, &m_physical_device_features);
-		if (m_physical_device_features.samplerAnisotropy != VK_TRUE)
-			return false;
+		if (!is_device_extension_available(VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME)) return;
+		const bool isSwapchainAvailable = !IsHeadless() && is_device_extension_available(VK_EXT_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN_EXTENSION_NAME);
+
+		// Query on its own, chained only if enabled
+		if (isSwapchainAvailable) m_physical_device_image_compression_control_features.pNext = &m_physical_device_swapchain_compression_control_features;
+		query_physical_device_features(&m_physical_device_image_compression_control_features);
+		// The swap chain struct is enabled only together with the image control
+		if (!IsImageCompressionControlSupported() || !IsSwapchainCompressionControlSupported()) m_physical_device_image_compression_control_features.pNext = nullptr;
+		if (!IsImageCompressionControlSupported()) return;
+
+		chain_physical_device_features(&m_physical_device_image_compression_control_features);
+		m_device_extensions.emplace_back(VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME);
+		if (IsSwapchainCompressionControlSupported())
+			m_device_extensions.emplace_back(VK_EXT_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN_EXTENSION_NAME);
+	}
 
-		// Advanced Features
-		// Bindless
-		/*static VkPhysicalDeviceDescriptorIndexingFeatures feature_descriptor_indexing
-		{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+	void VulkanContext::query_physical_device_full_screen_exclusive_support()
+	{
+		if (IsHeadless() || m_surface_config.mode != SurfaceConfig::FULL_SCREEN_EXCLUSIVE) return;
+#ifdef _WIN32
+		if (m_shared_instance->surface_capabilities2 && is_device_extension_available(VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME))
+		{
+			m_full_screen_exclusive_supported = true;
+			m_device_extensions.emplace_back(VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME);
+			return;
+		}
+#endif
+		log::warn("Full-screen exclusive mode is not supported - the GPU or platform does not support VK_EXT_full_screen_exclusive (Presenting windowed)");
+	}
 
-		m_physical_device_features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
-		m_physical_device_features2.pNext = &feature_descriptor_indexing;
+	VkQueueGlobalPriorityKHR VulkanContext::get_queue_family_global_priority(uint32_t queue_family_index) const
+	{
+		if (!IsGlobalQueuePrioritySupported()) return VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+
+		// Enumerators ascend with the priority
+		auto requested = VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+		auto request = [&](const QueueFamilyIndex& role, VkQueueGlobalPriorityKHR priority)
+			{ if (role == queue_family_index) requested = std::max(requested, priority); };
+		request(m_device_queue_family_graphics, m_queue_config.graphics_global_priority);
+		request(m_device_queue_family_present, m_queue_config.present_global_priority);
+		request(m_device_queue_family_compute, m_queue_config.compute_global_priority);
+		request(m_device_queue_family_transfer, m_queue_config.transfer_global_priority);
+		if (requested == VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR || !m_physical_device_global_priority_query_features.globalPriorityQuery) return requested;
 
-		vkGetPhysicalDeviceFeatures2(m_physical_device, &m_physical_device_features2);
-		if (feature_descriptor_indexing.descriptorBindingPartiallyBound != VK_TRUE ||
-			feature_descriptor_indexing.runtimeDescriptorArray != VK_TRUE)
-			return false;*/
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties2(m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyGlobalPriorityPropertiesKHR> globalPriorities(queueFamilyCount, { .sType = VK_STRUCTURE_TYPE_QUEUE_FAMILY_GLOBAL_PRIORITY_PROPERTIES_KHR });
+		std::vector<VkQueueFamilyProperties2> queueFamilies(queueFamilyCount, { .sType = VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2 });
+		for (uint32_t i = 0; i < queueFamilyCount; ++i) queueFamilies[i].pNext = &globalPriorities[i];
+		vkGetPhysicalDeviceQueueFamilyProperties2(m_physical_device, &queueFamilyCount, queueFamilies.data());
+
+		// Highest supported priority up to the requested one
+		auto granted = VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+		const auto& supported = globalPriorities[queue_family_index];
+		for (uint32_t i = 0; i < supported.priorityCount; ++i)
+			if (supported.priorities[i] <= requested) granted = std::max(granted, supported.priorities[i]);
+		if (granted != requested)
+			log::warn("Queue family {} does not support the requested global priority {:#x} (Using {:#x})", queue_family_index,
+				static_cast<uint32_t>(requested), static_cast<uint32_t>(granted));
+		return granted;
+	}
 
-		return true;
+	bool VulkanContext::check_physical_device_bindless_support()
+	{
+		if (!m_physical_device_features2.has_value()) return false;
+
+		const auto& features = m_physical_device_features12;
+		return features.descriptorIndexing &&
+			features.runtimeDescriptorArray &&
+			features.descriptorBindingPartiallyBound &&
+			features.descriptorBindingUpdateUnusedWhilePending &&
+			features.descriptorBindingSampledImageUpdateAfterBind &&
+			features.descriptorBindingStorageBufferUpdateAfterBind &&
+			features.shaderSampledImageArrayNonUniformIndexing &&
+			features.shaderStorageBufferArrayNonUniformIndexing;
 	}
 
 	bool VulkanContext::check_physical_device_queue_families_support()
@@ -556,6 +2632,7 @@ namespace RHI
 		m_device_queue_family_compute.reset();
 		m_device_queue_family_transfer.reset();
 		m_device_queue_family_sparsebinding.reset();
+		m_device_queue_family_video_encode.reset();
 
 		uint32_t queueFamilyCount = 0;
 		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queueFamilyCount, nullptr);
@@ -575,7 +2652,7 @@ namespace RHI
 			if (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) computeSupport = true;
 			if (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) transferSupport = true;
 			if (queueFamily.queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) sparseBindingSupport = true;
-			vkGetPhysicalDeviceSurfaceSupportKHR(m_physical_device, idx, m_surface, &presentSupport);
+			if (!IsHeadless()) vkGetPhysicalDeviceSurfaceSupportKHR(m_physical_device, idx, m_surface, &presentSupport);
 
 			// Any queue family with VK_QUEUE_GRAPHICS_BIT or VK_QUEUE_COMPUTE_BIT capabilities already implicitly support VK_QUEUE_TRANSFER_BIT operations
 			if (graphicsSupport && !m_device_queue_family_graphics.has_value())
@@ -586,6 +2663,8 @@ namespace RHI
 				m_device_queue_family_transfer = idx;
 			if (sparseBindingSupport && !m_device_queue_family_sparsebinding.has_value())
 				m_device_queue_family_sparsebinding = idx;
+			if ((queueFamily.queueFlags & VK_QUEUE_VIDEO_ENCODE_BIT_KHR) && !m_device_queue_family_video_encode.has_value())
+				m_device_queue_family_video_encode = idx; // Validated by query_physical_device_video_encode_support()
 			if (presentSupport == VK_TRUE && !m_device_queue_family_present.has_value())
 				m_device_queue_family_present = idx;
 
@@ -597,17 +2676,28 @@ namespace RHI
 				m_device_queue_family_present = idx;
 			}
 
+			// The Compute Queue Index is better to be different from the Graphics Queue Index (Async Compute).
+			if (computeSupport && !graphicsSupport && (m_device_queue_family_compute == m_device_queue_family_graphics))
+			{
+				m_device_queue_family_compute = idx;
+			}
+
 			// The Transfer Queue Index is better to be different from the Graphics Queue Index.
 			if (transferSupport && (m_device_queue_family_transfer == m_device_queue_family_graphics))
 			{
 				m_device_queue_family_transfer = idx;
 			}
+			if (transferSupport && !graphicsSupport && !computeSupport) // Dedicated (DMA) before the async compute family
+			{
+				m_device_queue_family_transfer = idx;
+			}
 
 			++idx;
 		}// End Loop - find family
+		if (IsHeadless()) m_device_queue_family_present = m_device_queue_family_graphics; // Nothing is presented
 
 		// Check Required Queue Family
-		for (const auto&[queue_family, priorities] : m_required_queue_families_with_priorities)
+		for (const auto queue_family : m_required_queue_families)
 		{
 			if (!queue_family->has_value()) return false;
 		}
@@ -616,23 +2706,23 @@ namespace RHI
 
 	bool VulkanContext::check_physical_device_extensions_support()
 	{
-		uint32_t extensionCount;
-		vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &extensionCount, nullptr);
-		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
-		vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &extensionCount, availableExtensions.data());
-		std::unordered_set<std::string> requiredExtensions(m_device_extensions.begin(), m_device_extensions.end());
-		for (const auto& extension : availableExtensions)
-		{
-			//log::info(">> {}", extension.extensionName);
-			requiredExtensions.erase(extension.extensionName);
-		}
-
-		return requiredExtensions.empty();
+		const auto& availableExtensions = get_physical_device_capabilities().extensions;
+		return std::all_of(m_device_extensions.begin(), m_device_extensions.end(), [&](const char* extension)
+			{
+				if (IsHeadless() && strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) return true; // Optional (Keeps PRESENT_SRC layouts valid)
+				return availableExtensions.contains(extension);
+			});
 	}
 
 
+	bool VulkanContext::is_device_extension_available(const char* extension_name)
+	{
+		return get_physical_device_capabilities().extensions.contains(extension_name);
+	}
+
 	bool VulkanContext::check_physical_device_surface_support()
 	{
+		if (IsHeadless()) return true; // Offscreen images only
 		// 1. Surface Formats
 		uint32_t formatCount;
 		vkGetPhysicalDeviceSurfaceFormatsKHR(m_physical_device, m_surface, &formatCount, nullptr);
@@ -667,111 +2757,396 @@ namespace RHI
 
 	bool VulkanContext::check_swap_chain_depth_format_support()
 	{
+		// The first supported format in the ranked list
+		VkFormat depthFormat = m_format_table.FindSupported(m_swapchain_config.depth_formats,
+			m_swapchain_depth_stencil_tiling, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		if (depthFormat == VK_FORMAT_UNDEFINED) return false;
+		if (depthFormat != m_swapchain_depth_stencil_format)
+			log::info("Swap Chain depth format: {}", static_cast<int>(depthFormat));
+		m_swapchain_depth_stencil_format = depthFormat;
+
 		// Deduce Channels
-		if (VK_FORMAT_D32_SFLOAT == m_swapchain_depth_stencil_format)
-		{
-			m_swapchain_stencil_channel = 0;
-			m_swapchain_depth_channel = 4;
-		}
-		else if (VK_FORMAT_D32_SFLOAT_S8_UINT == m_swapchain_depth_stencil_format)
+		switch (m_swapchain_depth_stencil_format)
 		{
-			m_swapchain_stencil_channel = 1;
-			m_swapchain_depth_channel = 4;
+		case VK_FORMAT_D32_SFLOAT:					m_swapchain_stencil_channel = 0; m_swapchain_depth_channel = 4; break;
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:	m_swapchain_stencil_channel = 1; m_swapchain_depth_channel = 4; break;
+		case VK_FORMAT_D24_UNORM_S8_UINT:		m_swapchain_stencil_channel = 1; m_swapchain_depth_channel = 3; break;
+		case VK_FORMAT_X8_D24_UNORM_PACK32:	m_swapchain_stencil_channel = 0; m_swapchain_depth_channel = 4; break;
+		case VK_FORMAT_D16_UNORM:					m_swapchain_stencil_channel = 0; m_swapchain_depth_channel = 2; break;
+		case VK_FORMAT_D16_UNORM_S8_UINT:		m_swapchain_stencil_channel = 1; m_swapchain_depth_channel = 2; break;
+		default: throw std::runtime_error("Failed to deduce the Depth Image Format!");
 		}
-		else if (VK_FORMAT_D24_UNORM_S8_UINT == m_swapchain_depth_stencil_format)
-		{
-			m_swapchain_stencil_channel = 1;
-			m_swapchain_depth_channel = 3;
-		}
-		else throw std::runtime_error("Failed to deduce the Depth Image Format!");
-
-		VkFormatProperties format_properties{};
-		vkGetPhysicalDeviceFormatProperties(m_physical_device, m_swapchain_depth_stencil_format, &format_properties);
-		// 1. Tiling Linear
-		if (VK_IMAGE_TILING_LINEAR == m_swapchain_depth_stencil_tiling &&
-			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT & format_properties.linearTilingFeatures)
-			return true;
-
-		// 2. Tiling Optimal
-		if (VK_IMAGE_TILING_OPTIMAL == m_swapchain_depth_stencil_tiling &&
-			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT & format_properties.optimalTilingFeatures)
-			return true;
-
-		return false;
+		return true;
 	}
 
 	bool VulkanContext::check_swap_chain_present_mode_support()
 	{
-		for (const auto& surface_present_mode : m_surface_present_modes)
+		for (auto present_mode : m_swapchain_config.present_modes) // The first supported mode in the fallback chain
 		{
-			if (surface_present_mode == m_swapchain_present_mode)
+			if (std::find(m_surface_present_modes.begin(), m_surface_present_modes.end(), present_mode) != m_surface_present_modes.end())
+			{
+				if (present_mode != m_swapchain_present_mode)
+					log::info("Swap Chain present mode: {}", static_cast<int>(present_mode));
+				m_swapchain_present_mode = present_mode;
 				return true;
+			}
 		}
 		return false;
 	}
 
-	bool VulkanContext::NO_VULKAN_CONTEXTS = true;
 	std::mutex VulkanContext::VULKAN_CONTEXT_CREATION_MUTEX{};
-	std::shared_ptr<VulkanContext> VulkanContext::Create(GLFWwindow* window)
+	std::weak_ptr<VulkanContext::SharedInstance> VulkanContext::SHARED_INSTANCE{};
+	std::optional<VulkanContext::PhysicalDeviceUUID> VulkanContext::PINNED_PHYSICAL_DEVICE{};
+	QueueConfig VulkanContext::QUEUE_CONFIG{};
+	bool VulkanContext::DEVICE_GROUP_ENABLED = false;
+	SurfaceConfig VulkanContext::SURFACE_CONFIG{};
+	std::shared_ptr<VulkanContext> VulkanContext::Create(GLFWwindow* window, std::string_view pipeline_cache_file/* = "AlbedoRHI.pipeline_cache"*/)
+	{
+		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
+		assert(window && "You must create a context without window via CreateHeadless()!");
+		return create(window, pipeline_cache_file);
+	}
+
+	std::shared_ptr<VulkanContext> VulkanContext::CreateHeadless(VkExtent2D extent, uint32_t image_count/* = 3*/, std::string_view pipeline_cache_file/* = ""*/)
+	{
+		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
+		return create(nullptr, pipeline_cache_file, extent, image_count);
+	}
+
+	std::vector<std::shared_ptr<VulkanContext>> VulkanContext::CreateHeadlessGroup(VkExtent2D extent, uint32_t image_count/* = 3*/, std::string_view pipeline_cache_file/* = ""*/)
 	{
 		std::scoped_lock guard{ VULKAN_CONTEXT_CREATION_MUTEX };
-		assert(NO_VULKAN_CONTEXTS && "You cannot create multiply Vulkan Contexts!");
+		// The first context creates (or joins) the shared instance, then every other GPU is tried on it
+		auto firstContext = create(nullptr, pipeline_cache_file, extent, image_count);
+		uint32_t phyDevCnt = 0;
+		vkEnumeratePhysicalDevices(firstContext->m_instance, &phyDevCnt, nullptr);
+		std::vector<VkPhysicalDevice> physicalDevices(phyDevCnt);
+		vkEnumeratePhysicalDevices(firstContext->m_instance, &phyDevCnt, physicalDevices.data());
+
+		// Split the workers, otherwise every device would spawn one per core
+		uint32_t workerCount = std::max(1U, (std::max(2U, std::thread::hardware_concurrency()) - 1) / std::max(1U, phyDevCnt));
+		std::vector<std::shared_ptr<VulkanContext>> vulkan_contexts{ std::move(firstContext) };
+		for (auto physical_device : physicalDevices)
+		{
+			const auto& firstProperties = vulkan_contexts.front()->m_physical_device_properties;
+			if (physical_device == vulkan_contexts.front()->m_physical_device) continue;
+			const auto& firstGroup = vulkan_contexts.front()->m_device_group; // Linked GPUs are driven by the first context
+			if (std::find(firstGroup.begin(), firstGroup.end(), physical_device) != firstGroup.end()) continue;
+
+			// Pipeline caches are only valid for the same device and driver
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(physical_device, &properties);
+			std::string cacheFile{ pipeline_cache_file };
+			if (!cacheFile.empty() && (properties.vendorID != firstProperties.vendorID || properties.deviceID != firstProperties.deviceID ||
+				memcmp(properties.pipelineCacheUUID, firstProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0))
+				cacheFile += std::format(".{:04x}-{:04x}", properties.vendorID, properties.deviceID);
+
+			try
+			{
+				vulkan_contexts.emplace_back(create(nullptr, cacheFile, extent, image_count, physical_device, workerCount));
+			}
+			catch (const std::runtime_error& error)
+			{
+				log::warn("Skipped the GPU {} - {}", properties.deviceName, error.what());
+			}
+		}
+		log::info("Created {} headless Vulkan Contexts on {} GPUs", vulkan_contexts.size(), phyDevCnt);
+		return vulkan_contexts;
+	}
 
+	std::shared_ptr<VulkanContext> VulkanContext::create(GLFWwindow* window, std::string_view pipeline_cache_file,
+		VkExtent2D headless_extent/* = {}*/, uint32_t headless_image_count/* = 0*/,
+		VkPhysicalDevice physical_device/* = VK_NULL_HANDLE*/, uint32_t worker_count/* = 0*/)
+	{
 		struct VulkanContextCreator : public VulkanContext
 		{
 			VulkanContextCreator(GLFWwindow* window) :VulkanContext{ window } {}
 		};
 
 		auto vulkan_context = std::make_shared<VulkanContextCreator>(window);
+		vulkan_context->m_pipeline_cache_file = pipeline_cache_file;
+		if (vulkan_context->IsHeadless())
+		{
+			vulkan_context->m_swapchain_current_extent = headless_extent;
+			vulkan_context->m_swapchain_image_count = headless_image_count;
+		}
+		vulkan_context->m_physical_device = physical_device;
+		vulkan_context->m_queue_config = QUEUE_CONFIG;
+		vulkan_context->m_device_group_enabled = DEVICE_GROUP_ENABLED;
+		if (!vulkan_context->IsHeadless()) vulkan_context->m_surface_config = SURFACE_CONFIG;
 		vulkan_context->enable_validation_layers();
+		vulkan_context->create_worker_pool(worker_count);
+
+		// File loading needs no device, so it overlaps the instance and device creation
+		// (If anything throws, the destructor joins the workers before releasing what they use)
+		auto pipelineCacheFile = vulkan_context->m_worker_pool->Submit([context = vulkan_context.get()]() { return context->read_pipeline_cache_file(); });
+		auto shaderCacheLoading = vulkan_context->create_shader_cache();
 		
 		vulkan_context->create_vulkan_instance();
 		vulkan_context->create_debug_messenger();
 		vulkan_context->create_surface();
 		vulkan_context->create_physical_device();
 		vulkan_context->create_logical_device();
+		vulkan_context->create_sync_pool();
+		vulkan_context->create_completion_poller();
 		vulkan_context->create_memory_allocator();
+		vulkan_context->create_deletion_queue();
+		vulkan_context->create_resource_registry();
+		vulkan_context->create_pipeline_cache(pipelineCacheFile.get());
 
+		// Independent of the swap chain (Swap chain creation stays on the caller, some window systems require it)
+		auto services = vulkan_context->m_worker_pool->Submit([context = vulkan_context.get()]()
+			{
+				context->create_bindless_heap();
+				context->create_upload_engine();
+				context->register_worker_threads();
+			});
 		vulkan_context->create_swap_chain();
+		services.get();
+		if (shaderCacheLoading.valid()) shaderCacheLoading.get();
 
-		NO_VULKAN_CONTEXTS = false;
 		return vulkan_context;
 	}
 
+	std::vector<std::future<void>> VulkanContext::
+		InitializeGraphicsPipelines(const std::vector<GraphicsPipeline*>& graphics_pipelines)
+	{
+		std::vector<std::future<void>> futures;
+		futures.reserve(graphics_pipelines.size());
+		for (auto graphics_pipeline : graphics_pipelines)
+		{
+			if (m_worker_pool->IsWorkerThread())
+			{
+				// Waiting for another job inside a worker may deadlock the pool, so initialize it in place.
+				std::promise<void> promise;
+				try { graphics_pipeline->Initialize(); promise.set_value(); }
+				catch (...) { promise.set_exception(std::current_exception()); }
+				futures.emplace_back(promise.get_future());
+			}
+			else futures.emplace_back(m_worker_pool->Submit([graphics_pipeline]() { graphics_pipeline->Initialize(); }));
+		}
+		return futures;
+	}
+
+	std::vector<std::future<bool>> VulkanContext::
+		PrewarmPipelines(PipelineTrace& pipeline_trace)
+	{
+		auto records = std::make_shared<const std::vector<PipelineTrace::Record>>(pipeline_trace.GetRecords()); // Shared by the jobs
+		std::vector<std::future<bool>> futures;
+		futures.reserve(records->size());
+		for (size_t i = 0; i < records->size(); ++i)
+		{
+			if (m_worker_pool->IsWorkerThread())
+			{
+				// Waiting for another job inside a worker may deadlock the pool, so replay it in place.
+				std::promise<bool> promise;
+				try { promise.set_value(PipelineTrace::Replay(*this, (*records)[i])); }
+				catch (...) { promise.set_exception(std::current_exception()); }
+				futures.emplace_back(promise.get_future());
+			}
+			else futures.emplace_back(m_worker_pool->Submit([this, records, i]() { return PipelineTrace::Replay(*this, (*records)[i]); }));
+		}
+		return futures;
+	}
+
+	void VulkanContext::UpdateShaderHotReload()
+	{
+		if (m_shader_watch_job.valid())
+		{
+			if (m_shader_watch_job.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return; // Still rebuilding (Never wait in the render loop)
+			m_shader_watch_job.get();
+		}
+
+		std::scoped_lock guard{ m_hot_reload_mutex };
+		if (m_hot_reload_pipelines.empty()) return;
+		for (auto graphics_pipeline : m_hot_reload_pipelines) graphics_pipeline->apply_hot_reload();
+
+		auto now = std::chrono::steady_clock::now();
+		if (now < m_next_shader_watch) return;
+		m_next_shader_watch = now + SHADER_WATCH_INTERVAL;
+		m_shader_watch_job = m_worker_pool->Submit([this]() { watch_shader_files(); });
+	}
+
+	void VulkanContext::WatchShaderFiles(GraphicsPipeline* graphics_pipeline, bool watch)
+	{
+		std::scoped_lock guard{ m_hot_reload_mutex };
+		if (watch) m_hot_reload_pipelines.emplace_back(graphics_pipeline);
+		else std::erase(m_hot_reload_pipelines, graphics_pipeline);
+	}
+
+	void VulkanContext::watch_shader_files()
+	{
+		auto modifiedFiles = m_shader_cache->CollectModifiedShaderFiles();
+		if (modifiedFiles.empty()) return;
+
+		// Rebuilt one after another, the render thread keeps the current pipelines until the job has finished
+		std::scoped_lock guard{ m_hot_reload_mutex };
+		for (auto graphics_pipeline : m_hot_reload_pipelines)
+		{
+			const auto& shaderFiles = graphics_pipeline->m_shader_program.files;
+			if (std::none_of(shaderFiles.begin(), shaderFiles.end(), [&modifiedFiles](const std::string& shader_file)
+				{ return std::find(modifiedFiles.begin(), modifiedFiles.end(), shader_file) != modifiedFiles.end(); }))
+				continue;
+
+			try { graphics_pipeline->reload_shader_program(); }
+			catch (const std::exception& error)
+			{
+				log::warn("Failed to hot reload {} - keep the current pipeline: {}", typeid(*graphics_pipeline).name(), error.what());
+			}
+		}
+	}
+
 	std::shared_ptr<CommandPool> VulkanContext::
-		CreateCommandPool(QueueFamilyIndex& submit_queue_family_index,VkCommandPoolCreateFlags command_pool_flags)
+		CreateCommandPool(QueueFamilyIndex& submit_queue_family_index,VkCommandPoolCreateFlags command_pool_flags, uint32_t submit_queue_index/* = 0*/)
 	{
 		if (!submit_queue_family_index.has_value()) throw std::runtime_error("Failed to create Vulkan Command Pool - Invalid Queue Family!");
-		return std::make_shared<CommandPool>(shared_from_this(), submit_queue_family_index, command_pool_flags);
+		return std::make_shared<CommandPool>(shared_from_this(), submit_queue_family_index, command_pool_flags, submit_queue_index);
 	}
 
 	std::shared_ptr<DescriptorPool> VulkanContext::
-		CreateDescriptorPool(std::vector<VkDescriptorPoolSize> pool_size, uint32_t limit_max_sets)
+		CreateDescriptorPool(std::vector<VkDescriptorPoolSize> pool_size, uint32_t limit_max_sets,
+		VkDescriptorPoolCreateFlags flags/* = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT*/)
+	{
+		return std::make_shared<DescriptorPool>(shared_from_this(), pool_size, limit_max_sets, flags);
+	}
+
+	std::shared_ptr<DescriptorAllocator> VulkanContext::
+		CreateDescriptorAllocator(bool free_descriptor_sets/* = true*/, uint32_t initial_sets_per_pool/* = 128*/)
+	{
+		return std::make_shared<DescriptorAllocator>(shared_from_this(), free_descriptor_sets, initial_sets_per_pool);
+	}
+
+	std::shared_ptr<DescriptorArena> VulkanContext::
+		CreateDescriptorArena(uint32_t frames_in_flight, uint32_t initial_sets_per_pool/* = 256*/)
+	{
+		return std::make_shared<DescriptorArena>(shared_from_this(), frames_in_flight, initial_sets_per_pool);
+	}
+
+	std::shared_ptr<DescriptorBuffer> VulkanContext::
+		CreateDescriptorBuffer(uint32_t frames_in_flight, VkDeviceSize capacity_per_frame/* = 1024 * 1024*/)
+	{
+		return std::make_shared<DescriptorBuffer>(shared_from_this(), frames_in_flight, capacity_per_frame);
+	}
+
+	std::shared_ptr<FrameContext> VulkanContext::
+		CreateFrameContext(uint32_t frames_in_flight/* = 2*/, VkDeviceSize staging_capacity_per_frame/* = 8 * 1024 * 1024*/)
+	{
+		return std::make_shared<FrameContext>(shared_from_this(), frames_in_flight, staging_capacity_per_frame);
+	}
+
+	std::shared_ptr<GPUProfiler> VulkanContext::
+		CreateGPUProfiler(uint32_t frames_in_flight, uint32_t max_zones_per_frame/* = 512*/)
+	{
+		return std::make_shared<GPUProfiler>(shared_from_this(), frames_in_flight, max_zones_per_frame);
+	}
+
+	std::shared_ptr<QueryPool> VulkanContext::
+		CreateQueryPool(QueryPool::Type type, uint32_t frames_in_flight, uint32_t max_queries_per_frame/* = 256*/)
 	{
-		return std::make_shared<DescriptorPool>(shared_from_this(), pool_size, limit_max_sets);
+		return std::make_shared<QueryPool>(shared_from_this(), type, frames_in_flight, max_queries_per_frame);
+	}
+
+	std::shared_ptr<RenderGraph> VulkanContext::
+		CreateRenderGraph(uint32_t frames_in_flight)
+	{
+		return std::make_shared<RenderGraph>(shared_from_this(), frames_in_flight);
 	}
 
 	std::shared_ptr<DescriptorSetLayout>	 VulkanContext::
-		CreateDescripotrSetLayout(std::vector<VkDescriptorSetLayoutBinding> descriptor_bindings)
+		CreateDescripotrSetLayout(std::vector<VkDescriptorSetLayoutBinding> descriptor_bindings,
+		std::vector<std::shared_ptr<Sampler>> immutable_samplers/* = {}*/,
+		VkDescriptorSetLayoutCreateFlags flags/* = 0*/)
+	{
+		auto normalized_bindings = DescriptorSetLayout::Normalize(std::move(descriptor_bindings));
+		auto hash = DescriptorSetLayout::Hash(normalized_bindings, flags);
+
+		std::scoped_lock guard{ m_descriptor_set_layout_cache_mutex };
+		auto& cached_layout = m_descriptor_set_layout_cache[hash];
+		if (auto descriptor_set_layout = cached_layout.lock())
+		{
+			if (descriptor_set_layout->IsIdentical(normalized_bindings, flags)) return descriptor_set_layout;
+			log::warn("Descriptor Set Layout hash collision ({:x}) - creating an uncached layout", hash);
+			return std::make_shared<DescriptorSetLayout>(shared_from_this(), normalized_bindings, std::move(immutable_samplers), flags);
+		}
+
+		auto descriptor_set_layout = std::make_shared<DescriptorSetLayout>(shared_from_this(), normalized_bindings, std::move(immutable_samplers), flags);
+		cached_layout = descriptor_set_layout; // Expired when the last owner releases it
+		return descriptor_set_layout;
+	}
+
+	std::shared_ptr<PipelineLayout> VulkanContext::
+		CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges)
+	{
+		auto stateKey = PipelineLayout::Serialize(descriptor_set_layouts, push_constant_ranges);
+		auto hash = HashBytes(stateKey.data(), stateKey.size());
+
+		// Created under the lock (Cheap compared with pipelines)
+		std::scoped_lock guard{ m_pipeline_registry_mutex };
+		auto& cached_layout = m_pipeline_layout_registry[hash];
+		if (auto pipeline_layout = cached_layout.lock())
+		{
+			if (pipeline_layout->GetStateKey() == stateKey) return pipeline_layout;
+			log::warn("Pipeline Layout hash collision ({:x}) - creating an uncached layout", hash);
+			return std::make_shared<PipelineLayout>(shared_from_this(), descriptor_set_layouts, push_constant_ranges);
+		}
+
+		auto pipeline_layout = std::make_shared<PipelineLayout>(shared_from_this(), descriptor_set_layouts, push_constant_ranges);
+		cached_layout = pipeline_layout; // Expired when the last owner releases it
+		return pipeline_layout;
+	}
+
+	std::shared_ptr<PipelineStateObject> VulkanContext::
+		AcquirePipeline(std::vector<uint8_t> state_key, const std::function<VkPipeline()>& create_pipeline)
 	{
-		return std::make_shared<DescriptorSetLayout>(shared_from_this(), descriptor_bindings);
+		auto hash = HashBytes(state_key.data(), state_key.size());
+		{
+			std::scoped_lock guard{ m_pipeline_registry_mutex };
+			auto iterator = m_pipeline_registry.find(hash);
+			if (iterator != m_pipeline_registry.end())
+			{
+				if (auto pipeline = iterator->second.lock())
+				{
+					if (pipeline->GetStateKey() == state_key) return pipeline;
+					log::warn("Graphics Pipeline hash collision ({:x}) - creating an unshared pipeline", hash);
+					return std::make_shared<PipelineStateObject>(shared_from_this(), create_pipeline());
+				}
+			}
+		}
+
+		// Compile without blocking other lookups (Racing threads may compile twice, the first registration wins)
+		auto pipeline = std::make_shared<PipelineStateObject>(shared_from_this(), create_pipeline(), std::move(state_key));
+		std::scoped_lock guard{ m_pipeline_registry_mutex };
+		auto& registered_pipeline = m_pipeline_registry[hash];
+		if (auto winner = registered_pipeline.lock())
+		{
+			if (winner->GetStateKey() == pipeline->GetStateKey()) return winner;
+		}
+		else registered_pipeline = pipeline;
+		return pipeline;
 	}
 
 	std::shared_ptr<DescriptorSet> VulkanContext::
 		CreateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout, std::thread::id thread_id/* = std::this_thread::get_id()*/)
 	{	
-		auto descriptorPool = GetGlobalDescriptorPool(thread_id);
-		return descriptorPool->AllocateDescriptorSet(descriptor_set_layout);
+		ALBEDO_RHI_TRACE_ZONE("RHI::CreateDescriptorSet");
+		auto descriptorAllocator = GetGlobalDescriptorAllocator(thread_id);
+		return descriptorAllocator->AllocateDescriptorSet(descriptor_set_layout);
 	}
 
 	std::shared_ptr<CommandPool> VulkanContext::
 		GetGlobalOneTimeCommandPool(QueueFamilyIndex& queue_family_index, std::thread::id thread_id/*= std::this_thread::get_id()*/)
 	{
-		auto& commandPool = m_global_onetime_command_pools[thread_id][queue_family_index];
+		assert(queue_family_index.value() < MAX_QUEUE_FAMILY_COUNT && "Queue family index is out of the global slot range!");
+		auto& slot = get_global_thread_slot(thread_id).onetime_command_pools[queue_family_index.value()];
+		auto commandPool = slot.load(std::memory_order_acquire);
 		if (commandPool == nullptr)
 		{
-			log::info("Current thread created a new Global One-time Command Pool with submit queue family index {}", queue_family_index.value());
-			commandPool = CreateCommandPool(queue_family_index, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			auto newCommandPool = CreateCommandPool(queue_family_index, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, GetQueueIndex(queue_family_index, QueuePriority::NORMAL, thread_id));
+			if (slot.compare_exchange_strong(commandPool, newCommandPool, std::memory_order_acq_rel))
+			{
+				log::info("Current thread created a new Global One-time Command Pool with submit queue family index {}", queue_family_index.value());
+				commandPool = std::move(newCommandPool);
+			}
 		}
 		return commandPool;
 	}
@@ -779,52 +3154,154 @@ namespace RHI
 	std::shared_ptr<CommandPool> VulkanContext::
 		GetGlobalResetableCommandPool(QueueFamilyIndex& queue_family_index, std::thread::id thread_id/* = std::this_thread::get_id()*/)
 	{
-		auto& commandPool = m_global_resetable_command_pools[thread_id][queue_family_index];
+		assert(queue_family_index.value() < MAX_QUEUE_FAMILY_COUNT && "Queue family index is out of the global slot range!");
+		auto& slot = get_global_thread_slot(thread_id).resetable_command_pools[queue_family_index.value()];
+		auto commandPool = slot.load(std::memory_order_acquire);
 		if (commandPool == nullptr)
 		{
-			log::info("Current thread created a new Global Resetable Command Pool with submit queue family index {}", queue_family_index.value());
-			commandPool = CreateCommandPool(queue_family_index, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+			auto newCommandPool = CreateCommandPool(queue_family_index, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, GetQueueIndex(queue_family_index, QueuePriority::NORMAL, thread_id));
+			if (slot.compare_exchange_strong(commandPool, newCommandPool, std::memory_order_acq_rel))
+			{
+				log::info("Current thread created a new Global Resetable Command Pool with submit queue family index {}", queue_family_index.value());
+				commandPool = std::move(newCommandPool);
+			}
 		}
 		return commandPool;
 	}
+
+	VulkanContext::GlobalThreadSlot& VulkanContext::
+		get_global_thread_slot(std::thread::id thread_id)
+	{
+		// Hot path: the calling thread has already looked up its slot in this context
+		struct ThreadSlotCache { uint64_t context_id = 0; GlobalThreadSlot* slot = nullptr; };
+		thread_local ThreadSlotCache threadSlotCache;
+		
+		bool isCallingThread = (thread_id == std::this_thread::get_id());
+		if (isCallingThread && threadSlotCache.context_id == m_context_id) return *threadSlotCache.slot;
+
+		GlobalThreadSlot* slot = nullptr;
+		m_statistics.Add(RHIStatistics::THREAD_SLOT_LOOKUPS);
+		{
+			std::shared_lock guard{ m_global_thread_slots_mutex, std::try_to_lock };
+			if (!guard.owns_lock())
+			{
+				m_statistics.Add(RHIStatistics::THREAD_SLOT_CONTENTIONS);
+				guard.lock();
+			}
+			if (auto target = m_global_thread_slots.find(thread_id);
+				target != m_global_thread_slots.end()) slot = target->second.get();
+		}
+		if (slot == nullptr)
+		{
+			std::unique_lock guard{ m_global_thread_slots_mutex };
+			auto& newSlot = m_global_thread_slots[thread_id];
+			if (newSlot == nullptr)
+			{
+				log::info("Registered a new thread for Global Objects ({} threads)", m_global_thread_slots.size());
+				newSlot = std::make_unique<GlobalThreadSlot>();
+			}
+			slot = newSlot.get();
+		}
+
+		if (isCallingThread) threadSlotCache = { m_context_id, slot };
+		return *slot;
+	}
 	
+	std::shared_ptr<QueueTimeline> VulkanContext::
+		GetGlobalQueueTimeline(QueueFamilyIndex& queue_family_index, uint32_t queue_index/* = 0*/)
+	{
+		std::scoped_lock guard{ m_global_queue_timelines_mutex };
+		auto& queueTimeline = m_global_queue_timelines[(static_cast<uint64_t>(queue_family_index.value()) << 32) | queue_index];
+		if (queueTimeline == nullptr)
+		{
+			log::info("Created a new Global Queue Timeline for queue family {} (queue {})", queue_family_index.value(), queue_index);
+			queueTimeline = std::make_shared<QueueTimeline>(shared_from_this(), queue_family_index, queue_index);
+		}
+		return queueTimeline;
+	}
+
+	std::shared_ptr<DescriptorAllocator> VulkanContext::
+		GetGlobalDescriptorAllocator(std::thread::id thread_id/* = std::this_thread::get_id()*/)
+	{
+		auto& slot = get_global_thread_slot(thread_id).descriptor_allocator;
+		auto descriptorAllocator = slot.load(std::memory_order_acquire);
+		if (descriptorAllocator == nullptr)
+		{
+			auto newDescriptorAllocator = CreateDescriptorAllocator();
+			if (slot.compare_exchange_strong(descriptorAllocator, newDescriptorAllocator, std::memory_order_acq_rel))
+			{
+				log::info("Current thread created a new Global Descriptor Allocator");
+				descriptorAllocator = std::move(newDescriptorAllocator);
+			}
+		}
+		return descriptorAllocator;
+	}
+
 	std::shared_ptr<DescriptorPool> VulkanContext::
 		GetGlobalDescriptorPool(std::thread::id thread_id/* = std::this_thread::get_id()*/)
 	{
-		auto& descriptorPool = m_global_descriptor_pool[thread_id];
-		if (descriptorPool == nullptr)
-		{
-			constexpr uint32_t OVERSIZE = 100;
-			std::vector<VkDescriptorPoolSize> descriptorPoolSize
-			{
-				{ VK_DESCRIPTOR_TYPE_SAMPLER,										OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,	OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,							OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,							OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,			OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,			OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,						OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,						OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,	OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,	OVERSIZE },
-				{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,					OVERSIZE }
-			};
-			const uint32_t MAX_ALLOCATABLE_SETS = OVERSIZE * descriptorPoolSize.size();
-			log::info("Current thread created a new Global Descriptor Pool with {} descriptors per type and you can allocate descriptor set {} times",
-				OVERSIZE, MAX_ALLOCATABLE_SETS);
+		return GetGlobalDescriptorAllocator(thread_id)->GetCurrentPool();
+	}
+
+	std::shared_ptr<Sampler> VulkanContext::
+		CreateSampler(const Sampler::Desc& desc)
+	{
+		auto hash = desc.Hash();
 
-			descriptorPool = std::make_shared<DescriptorPool>(shared_from_this(), descriptorPoolSize, MAX_ALLOCATABLE_SETS);
+		std::scoped_lock guard{ m_sampler_cache_mutex };
+		auto& cached_sampler = m_sampler_cache[hash];
+		if (auto sampler = cached_sampler.lock())
+		{
+			if (sampler->GetDesc() == desc) return sampler;
+			log::warn("Sampler hash collision ({:x}) - creating an uncached sampler", hash);
+			return std::make_shared<Sampler>(shared_from_this(), desc);
 		}
-		return descriptorPool;
+
+		auto sampler = std::make_shared<Sampler>(shared_from_this(), desc);
+		cached_sampler = sampler; // Expired when the last owner releases it
+		return sampler;
 	}
 
 	std::shared_ptr<Sampler> VulkanContext::
 		CreateSampler(VkSamplerAddressMode address_mode,
 		VkBorderColor border_color/* = VK_BORDER_COLOR_INT_OPAQUE_BLACK*/,
 		VkCompareOp compare_mode/* = VK_COMPARE_OP_NEVER*/,
-		bool anisotropy_enable/* = true*/)
+		bool anisotropy_enable/* = true*/,
+		float max_lod/* = VK_LOD_CLAMP_NONE*/)
+	{
+		return CreateSampler(Sampler::Desc
+			{
+				.address_mode_u = address_mode,
+				.address_mode_v = address_mode,
+				.address_mode_w = address_mode,
+				.border_color = border_color,
+				.compare_op = compare_mode,
+				.anisotropy_enable = anisotropy_enable,
+				.max_lod = max_lod
+			});
+	}
+
+	void VulkanContext::
+		RegisterImmutableSampler(std::string name, const Sampler::Desc& desc)
+	{
+		std::scoped_lock guard{ m_sampler_cache_mutex };
+		auto [immutable_sampler, isInserted] = m_immutable_samplers.try_emplace(std::move(name), desc);
+		if (!isInserted && !(immutable_sampler->second == desc))
+			throw std::runtime_error(std::format("Failed to register the immutable sampler {} - the name is taken by another description!", immutable_sampler->first));
+	}
+
+	std::shared_ptr<Sampler> VulkanContext::
+		GetImmutableSampler(std::string_view name)
 	{
-		return std::make_shared<Sampler>(shared_from_this(), address_mode, border_color, compare_mode, anisotropy_enable);
+		Sampler::Desc desc;
+		{
+			std::scoped_lock guard{ m_sampler_cache_mutex };
+			auto immutable_sampler = m_immutable_samplers.find(std::string{ name });
+			if (immutable_sampler == m_immutable_samplers.end())
+				throw std::runtime_error(std::format("Failed to get the immutable sampler {} - it is not registered!", name));
+			desc = immutable_sampler->second;
+		}
+		return CreateSampler(desc); // Shared with identical samplers
 	}
 
 	std::unique_ptr<Semaphore> VulkanContext::
@@ -839,4 +3316,11 @@ namespace RHI
 		return std::make_unique<Fence>(shared_from_this(), flags);
 	}
 
+	std::unique_ptr<Event> VulkanContext::
+		CreateEvent()
+	{
+		return std::make_unique<Event>(shared_from_this(),
+			m_physical_device_features13.synchronization2 ? VK_EVENT_CREATE_DEVICE_ONLY_BIT : 0);
+	}
+
 }} // namespace Albedo::RHI
\ No newline at end of file
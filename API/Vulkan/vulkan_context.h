@@ -7,6 +7,44 @@
 
 #include "vulkan_wrapper.h"
 #include "vulkan_memory.h"
+#include "vulkan_host_allocator.h"
+#include "vulkan_worker.h"
+#include "vulkan_async.h"
+#include "vulkan_shader.h"
+#include "vulkan_bindless.h"
+#include "vulkan_upload.h"
+#include "vulkan_frame.h"
+#include "vulkan_frame_timing.h"
+#include "vulkan_deletion.h"
+#include "vulkan_profiler.h"
+#include "vulkan_graph.h"
+#include "vulkan_pacing.h"
+#include "vulkan_scheduler.h"
+#include "vulkan_indirect.h"
+#include "vulkan_shading_rate.h"
+#include "vulkan_breadcrumbs.h"
+#include "vulkan_texture.h"
+#include "vulkan_sparse.h"
+#include "vulkan_residency.h"
+#include "vulkan_raytracing.h"
+#include "vulkan_descriptor_buffer.h"
+#include "vulkan_subpass.h"
+#include "vulkan_scatter.h"
+#include "vulkan_geometry.h"
+#include "vulkan_growable.h"
+#include "vulkan_versioned.h"
+#include "vulkan_draw_queue.h"
+#include "vulkan_culling.h"
+#include "vulkan_hiz.h"
+#include "vulkan_pipeline_desc.h"
+#include "vulkan_pipeline_trace.h"
+#include "vulkan_replay.h"
+#include "vulkan_registry.h"
+#include "vulkan_sync.h"
+#include "vulkan_stats.h"
+#include "vulkan_video.h"
+#include "vulkan_frame_capture.h"
+#include "vulkan_window.h"
 
 namespace Albedo {
 namespace RHI
@@ -17,9 +55,68 @@ namespace RHI
 	constexpr const bool EnableValidationLayers = true;
 #endif
 
+	// Swap Chain Configuration (Switch it at runtime via VulkanContext::SetSwapChainConfig())
+	struct SwapchainConfig
+	{
+		std::vector<VkPresentModeKHR> present_modes; // Fallback chain, the first supported mode wins (FIFO is always supported)
+		uint32_t extra_image_count = 1; // minImageCount + extra_image_count (Clamped to maxImageCount)
+		bool trim_memory_on_suspend = false; // VMA::TrimMemory() when the window is minimized (See VulkanContext::IsSuspended())
+		// Ranked depth formats of the swap chain depth image, the first supported one wins (e.g. FormatTable::GetDepthFormats(DepthPreference::STENCIL))
+		std::vector<VkFormat> depth_formats{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+		// Compression of the swap chain images, capped by the surface format (Needs VulkanContext::IsSwapchainCompressionControlSupported())
+		VMA::ImageCompression compression;
+
+		enum Preset
+		{
+			LOW_LATENCY,	// MAILBOX -> IMMEDIATE -> FIFO_RELAXED -> FIFO (minImageCount + 1)
+			THROUGHPUT,	// MAILBOX -> FIFO (minImageCount + 2, the GPU never waits for a free image)
+			POWER_SAVE,	// FIFO (minImageCount, no frames are rendered and then discarded)
+		};
+		static SwapchainConfig FromPreset(Preset preset);
+	};
+
+	// Queue Configuration (All hardware queues of the used families are created, see VulkanContext::SetQueueConfig())
+	// Queue 0: NORMAL (Every RHI service submits here), 1: HIGH, Last of >= 3 queues: LOW, Others: NORMAL routed by thread
+	enum class QueuePriority : uint32_t { NORMAL, HIGH, LOW };
+	struct QueueConfig
+	{
+		float high_priority = 1.0f;
+		float normal_priority = 0.5f;
+		float low_priority = 0.0f;
+		uint32_t max_queues_per_family = 8;
+		// Spread the global command pools of NORMAL submitters over the spare queues (Submissions of different threads are not ordered anymore)
+		bool route_by_thread = false;
+		// System-wide priority against other processes sharing the GPU (VK_KHR_global_priority or VK_EXT_global_priority, see
+		// VulkanContext::GetQueueGlobalPriority()). A family shared by several roles takes the highest; HIGH & REALTIME may need privileges
+		// and fall back to MEDIUM (The driver default) when they are not permitted or not supported by the family.
+		VkQueueGlobalPriorityKHR graphics_global_priority = VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+		VkQueueGlobalPriorityKHR present_global_priority = VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+		VkQueueGlobalPriorityKHR compute_global_priority = VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+		VkQueueGlobalPriorityKHR transfer_global_priority = VK_QUEUE_GLOBAL_PRIORITY_MEDIUM_KHR;
+	};
+
+	// Surface Configuration of windowed contexts (Latched on creation, see VulkanContext::SetSurfaceConfig())
+	struct SurfaceConfig
+	{
+		enum Mode
+		{
+			WINDOWED,						// Surface of the GLFW window (Composited unless the window system flips it on its own)
+			FULL_SCREEN_EXCLUSIVE,	// Windows: Application-controlled exclusive mode on the window's monitor (VK_EXT_full_screen_exclusive), windowed elsewhere.
+												// Make the window full-screen (glfwSetWindowMonitor()) before the creation, the mode is acquired by every swap chain creation
+			DIRECT_DISPLAY,				// Presents to a display plane without the window system (VK_KHR_display), the window only receives input.
+												// The display must not be driven by a compositor (e.g. run from a virtual terminal)
+		};
+		Mode mode = WINDOWED;
+		uint32_t display_index = 0; // DIRECT_DISPLAY: Of vkGetPhysicalDeviceDisplayPropertiesKHR (Native resolution at the highest refresh rate)
+	};
+
 	// Factory (You should create most of vulkan objects in via Vulkan Context: CreateXX functions)
 	class VulkanContext : public std::enable_shared_from_this<VulkanContext>
 	{
+		friend class DeletionQueue;
+		friend class CommandBufferBaked;
+		friend class DescriptorSetCache;
+		friend class WindowSwapChain;
 	public:
 		VkInstance								m_instance									= VK_NULL_HANDLE;
 		GLFWwindow*							m_window										= VK_NULL_HANDLE;
@@ -32,42 +129,128 @@ namespace RHI
 		VkPhysicalDeviceFeatures		m_physical_device_features;
 		VkPhysicalDeviceProperties	m_physical_device_properties;
 		VkPhysicalDeviceMemoryProperties m_physical_device_memory_properties;
-		std::optional<VkPhysicalDeviceFeatures2> m_physical_device_features2;	// Future: Enable Bindless
+		uint64_t										m_physical_device_score			= 0; // score_physical_device() (0 if pinned or reloaded)
+		std::vector<VkPhysicalDevice>		m_device_group;								// Linked GPUs of the logical device (Empty: m_physical_device only)
+		FormatTable								m_format_table;								// Built once the physical device is selected
+		std::optional<VkPhysicalDeviceFeatures2> m_physical_device_features2;	// Chains Vulkan 1.1 ~ 1.3 features (All supported features are enabled)
+		VkPhysicalDeviceVulkan11Features	m_physical_device_features11{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
+		VkPhysicalDeviceVulkan12Features	m_physical_device_features12{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		VkPhysicalDeviceVulkan13Features	m_physical_device_features13{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+		VkPhysicalDeviceVulkan12Properties m_physical_device_properties12{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+		VkPhysicalDevicePresentIdFeaturesKHR	m_physical_device_present_id_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };			// Chained if supported
+		VkPhysicalDevicePresentWaitFeaturesKHR	m_physical_device_present_wait_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };	// Ditto
+		VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT m_physical_device_swapchain_maintenance1_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT }; // Ditto
+		VkPhysicalDeviceMeshShaderFeaturesEXT	m_physical_device_mesh_shader_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };		// Ditto
+		VkPhysicalDeviceMeshShaderPropertiesEXT m_physical_device_mesh_shader_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_PROPERTIES_EXT };
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_physical_device_pipeline_library_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT }; // Chained if supported
+		VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT m_physical_device_pipeline_library_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT };
+		bool m_memory_budget_supported = false; // VK_EXT_memory_budget enabled
+		VkPhysicalDeviceExternalMemoryHostPropertiesEXT m_physical_device_external_memory_host_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT };
+		bool m_external_memory_host_supported = false; // VK_EXT_external_memory_host enabled
+		bool m_external_memory_supported = false; // VK_KHR_external_memory_fd & VK_KHR_external_semaphore_fd (Or the Win32 ones) enabled
+		bool m_external_memory_dma_buf_supported = false; // VK_EXT_external_memory_dma_buf enabled
+		VkPhysicalDeviceAccelerationStructureFeaturesKHR m_physical_device_acceleration_structure_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR }; // Chained if supported
+		VkPhysicalDeviceAccelerationStructurePropertiesKHR m_physical_device_acceleration_structure_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR };
+		VkPhysicalDevicePushDescriptorPropertiesKHR m_physical_device_push_descriptor_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR };
+		bool m_push_descriptor_supported = false; // VK_KHR_push_descriptor enabled
+		VkPhysicalDeviceDescriptorBufferFeaturesEXT m_physical_device_descriptor_buffer_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT }; // Chained if supported
+		VkPhysicalDeviceDescriptorBufferPropertiesEXT m_physical_device_descriptor_buffer_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT };
+		VkPhysicalDeviceConditionalRenderingFeaturesEXT m_physical_device_conditional_rendering_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT }; // Chained if supported
+		VkPhysicalDeviceFragmentShadingRateFeaturesKHR m_physical_device_fragment_shading_rate_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR }; // Chained if supported
+		VkPhysicalDeviceFragmentShadingRatePropertiesKHR m_physical_device_fragment_shading_rate_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR };
+		bool m_buffer_marker_supported = false; // VK_AMD_buffer_marker enabled
+		bool m_diagnostic_checkpoints_supported = false; // VK_NV_device_diagnostic_checkpoints enabled
+		VkPhysicalDeviceHostImageCopyFeaturesEXT m_physical_device_host_image_copy_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT }; // Chained if supported
+		std::vector<VkImageLayout> m_host_image_copy_dst_layouts; // pCopyDstLayouts of VkPhysicalDeviceHostImageCopyPropertiesEXT
+		VkPhysicalDeviceMemoryPriorityFeaturesEXT m_physical_device_memory_priority_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT }; // Chained if supported
+		VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT m_physical_device_pageable_memory_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PAGEABLE_DEVICE_LOCAL_MEMORY_FEATURES_EXT }; // Ditto
+		VkPhysicalDeviceMultiDrawFeaturesEXT m_physical_device_multi_draw_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT }; // Chained if supported
+		VkPhysicalDeviceMultiDrawPropertiesEXT m_physical_device_multi_draw_properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT };
+		VkPhysicalDeviceShaderObjectFeaturesEXT m_physical_device_shader_object_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT }; // Chained if supported
+		bool m_video_encode_h264_supported = false; // VK_KHR_video_queue & VK_KHR_video_encode_queue & VK_KHR_video_encode_h264 enabled
+		bool m_calibrated_timestamps_supported = false; // VK_EXT_calibrated_timestamps enabled (Device & HostTimeDomain calibrateable)
+		VkPhysicalDeviceImageCompressionControlFeaturesEXT m_physical_device_image_compression_control_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_COMPRESSION_CONTROL_FEATURES_EXT }; // Chained if supported
+		VkPhysicalDeviceImageCompressionControlSwapchainFeaturesEXT m_physical_device_swapchain_compression_control_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN_FEATURES_EXT }; // Ditto
+		bool m_full_screen_exclusive_supported = false; // VK_EXT_full_screen_exclusive enabled (FULL_SCREEN_EXCLUSIVE on Windows)
+		VkPhysicalDeviceGlobalPriorityQueryFeaturesKHR m_physical_device_global_priority_query_features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GLOBAL_PRIORITY_QUERY_FEATURES_KHR }; // Chained if supported
+		const char* m_global_priority_extension = nullptr; // VK_KHR_global_priority or VK_EXT_global_priority enabled
 
 		VkDevice									m_device										= VK_NULL_HANDLE;
+		DeviceDispatchTable				m_dispatch;									// Entry points of m_device (Skip the loader trampoline)
 		QueueFamilyIndex					m_device_queue_family_graphics;
 		QueueFamilyIndex					m_device_queue_family_present;
 		QueueFamilyIndex					m_device_queue_family_compute;
 		QueueFamilyIndex					m_device_queue_family_transfer;
 		QueueFamilyIndex					m_device_queue_family_sparsebinding;
+		QueueFamilyIndex					m_device_queue_family_video_encode; // Optional (See IsVideoEncodeSupported())
 
 		std::shared_ptr<VMA>				m_memory_allocator;
-		VkAllocationCallbacks*			m_memory_allocation_callback = VK_NULL_HANDLE;
+		VkAllocationCallbacks*			m_memory_allocation_callback = HostAllocator::GetCallbacks(); // Latched on creation (Null unless HostAllocator::Enable())
 
 		VkSwapchainKHR					m_swapchain								= VK_NULL_HANDLE;
 		class											swapchain_error							: public std::exception {}; // Recreation Signal
-		uint32_t										m_swapchain_image_count;		// clamp(minImageCount + 1, maxImageCount)
+		class											swapchain_suspended				: public swapchain_error {}; // Not presentable (Minimized), skip the frame
+		SwapchainConfig						m_swapchain_config					= SwapchainConfig::FromPreset(SwapchainConfig::LOW_LATENCY);
+		uint32_t										m_swapchain_image_count;		// clamp(minImageCount + extra_image_count, maxImageCount)
 		VkFormat									m_swapchain_image_format		= VK_FORMAT_B8G8R8A8_SRGB;
+		VkImageUsageFlags					m_swapchain_image_usage		= 0; // SAMPLED if the surface supports it (e.g. VideoEncoder sources)
 		VkColorSpaceKHR					m_swapchain_color_space		= VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
-		VkPresentModeKHR				m_swapchain_present_mode	= VK_PRESENT_MODE_MAILBOX_KHR;
-		VkFormat									m_swapchain_depth_stencil_format	= VK_FORMAT_D32_SFLOAT;
+		VkPresentModeKHR				m_swapchain_present_mode	= VK_PRESENT_MODE_FIFO_KHR; // Chosen from m_swapchain_config
+		VkFormat									m_swapchain_depth_stencil_format	= VK_FORMAT_D32_SFLOAT; // Chosen from m_swapchain_config
 		VkImageTiling							m_swapchain_depth_stencil_tiling		= VK_IMAGE_TILING_OPTIMAL;
 		uint32_t										m_swapchain_depth_channel;	// Deduced in check_swap_chain_depth_format_support()
 		uint32_t										m_swapchain_stencil_channel;	// Ditto, and you can use this to judge whether has a stencil component
-		VkExtent2D								m_swapchain_current_extent;
+		VkExtent2D								m_swapchain_current_extent{}; // Zero until the swap chain is created
 		std::vector<VkImage>				m_swapchain_images;
 		std::vector<VkImageView>		m_swapchain_imageviews;
 		uint32_t										m_swapchain_current_image_index{ 0 };
+		bool												m_swapchain_image_acquired = false; // Not presented yet (Released by the recreation with maintenance1)
+		std::vector<VkPresentModeKHR> m_swapchain_present_modes; // Switchable without recreation (Maintenance1, includes the current mode)
 		std::shared_ptr<VMA::Image>m_swapchain_depth_stencil_image;
+		std::vector<std::shared_ptr<VMA::Image>> m_offscreen_images; // Headless only (Owns m_swapchain_images and m_swapchain_imageviews)
+		uint64_t										m_swapchain_generation = 0; // Increased by every (re)creation (Dependents rebuild lazily)
 
-		VkDebugUtilsMessengerEXT	m_debug_messenger					= VK_NULL_HANDLE;
+		VkPipelineCache						m_pipeline_cache						= VK_NULL_HANDLE; // Shared by all pipelines (internally synchronized)
+		std::string								m_pipeline_cache_file;			// Empty means not persistent
+		std::string								m_pipeline_cache_delta_file;	// Not empty: SavePipelineCache() writes it instead
+		uint64_t									m_pipeline_cache_generation	= 0;
+
+		VkDebugUtilsMessengerEXT	m_debug_messenger					= VK_NULL_HANDLE; // Owned by the shared instance
 
 	private:
-		std::vector<std::pair<QueueFamilyIndex*, std::vector<float>>>
-			m_required_queue_families_with_priorities{
-				{&m_device_queue_family_graphics,		{1.0f}},
-				{&m_device_queue_family_transfer,			{1.0f}},
-				{&m_device_queue_family_present,			{1.0f}}};
+		// Shared by all contexts of the process (Destroyed with the last context)
+		struct SharedInstance
+		{
+			VkInstance instance = VK_NULL_HANDLE;
+			VkDebugUtilsMessengerEXT debug_messenger = VK_NULL_HANDLE;
+			std::unique_ptr<DebugMessageQueue> debug_message_queue; // User data of the messenger (Outlives it)
+			const VkAllocationCallbacks* allocation_callbacks = nullptr; // Of the creating context (HostAllocator)
+			bool wsi = false; // Created with the surface extensions
+			bool surface_maintenance1 = false; // VK_EXT_surface_maintenance1 & VK_KHR_get_surface_capabilities2 enabled (Windowed only)
+			bool surface_capabilities2 = false; // VK_KHR_get_surface_capabilities2 enabled (With surface_maintenance1 or FULL_SCREEN_EXCLUSIVE)
+			bool display = false; // VK_KHR_display enabled (DIRECT_DISPLAY)
+			~SharedInstance();
+		};
+		std::shared_ptr<SharedInstance> m_shared_instance;
+
+		std::vector<QueueFamilyIndex*>	m_required_queue_families{
+																			&m_device_queue_family_graphics,
+																			&m_device_queue_family_transfer,
+																			&m_device_queue_family_compute,
+																			&m_device_queue_family_present };
+		QueueConfig								m_queue_config;
+		bool											m_device_group_enabled = false; // DEVICE_GROUP_ENABLED at creation
+		SurfaceConfig								m_surface_config; // SURFACE_CONFIG at creation
+		VkDisplayKHR								m_display = VK_NULL_HANDLE; // Presented by DIRECT_DISPLAY
+
+		// Enumerated once per candidate GPU, in parallel on the worker pool (See create_physical_device())
+		struct PhysicalDeviceCapabilities
+		{
+			VkPhysicalDeviceProperties properties;
+			VkPhysicalDeviceFeatures features;
+			std::unordered_set<std::string> extensions;
+		};
+		std::unordered_map<VkPhysicalDevice, PhysicalDeviceCapabilities> m_physical_device_capabilities;
 		
 #ifdef NDEBUG
 		std::vector<const char*>			m_validation_layers{"VK_LAYER_RENDERDOC_Capture"};
@@ -84,19 +267,299 @@ namespace RHI
 #endif	
 
 	public:
-		void WaitDeviceIdle() { vkDeviceWaitIdle(m_device); }	
-
-		VkQueue GetQueue(QueueFamilyIndex& queue_family_index, uint32_t queue_index = 0) { VkQueue res; vkGetDeviceQueue(m_device, queue_family_index.value(), queue_index, &res); return res; }
+		void WaitDeviceIdle(); // Also run all deferred deletions
+		bool IsHeadless() const { return m_window == nullptr; } // Set m_swapchain_current_extent and call RecreateSwapChain() to resize
+		std::shared_ptr<VMA::Image> GetOffscreenImage(uint32_t index) { assert(IsHeadless() && index < m_offscreen_images.size()); return m_offscreen_images[index]; }
+
+		// Compute work submitted to m_device_queue_family_compute overlaps with rasterization (Wait graphics ticks via SubmitTick())
+		bool IsAsyncComputeSupported() const { return m_device_queue_family_compute != m_device_queue_family_graphics; }
+		// Partially resident 2D images with binds on m_device_queue_family_sparsebinding (see ResidencyManager)
+		// Format capabilities of the device (Constant time, no vkGetPhysicalDeviceFormatProperties calls)
+		const FormatTable& GetFormatTable() const { return m_format_table; }
+		// Highest sample count <= samples supported by framebuffer attachments of these aspects (framebufferXXXSampleCounts)
+		VkSampleCountFlagBits ClampSampleCount(VkSampleCountFlagBits samples, VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT) const;
+		// Pipeline statistics QueryPool (Occlusion queries are core)
+		bool IsPipelineStatisticsQuerySupported() const { return m_physical_device_features.pipelineStatisticsQuery; }
+		bool IsSparseResidencySupported() const { return m_device_queue_family_sparsebinding.has_value() && m_physical_device_features.sparseBinding && m_physical_device_features.sparseResidencyImage2D; }
+		VkQueue GetQueue(QueueFamilyIndex& queue_family_index, uint32_t queue_index = 0) { assert(queue_index < GetQueueCount(queue_family_index)); VkQueue res; vkGetDeviceQueue(m_device, queue_family_index.value(), queue_index, &res); return res; }
+		// Queues (See QueueConfig)
+		static void SetQueueConfig(const QueueConfig& config); // Applied to the next creations
+		uint32_t GetQueueCount(QueueFamilyIndex& queue_family_index) const { return m_device_queue_counts[queue_family_index.value()]; }
+		uint32_t GetQueueIndex(QueueFamilyIndex& queue_family_index, QueuePriority priority = QueuePriority::NORMAL, std::thread::id thread_id = std::this_thread::get_id()) const;
+		// Global Queue Priority (QueueConfig::*_global_priority): Granted priority of the family's queues (MEDIUM without the extensions)
+		bool IsGlobalQueuePrioritySupported() const { return m_global_priority_extension != nullptr; }
+		VkQueueGlobalPriorityKHR GetQueueGlobalPriority(QueueFamilyIndex& queue_family_index) const { return m_device_queue_global_priorities[queue_family_index.value()]; }
+
+		// Device Groups (Linked multi-GPU): One logical device spans every GPU of the group of the selected one. Command buffers run on
+		// every device unless CommandBuffer::SetDeviceMask() narrows them, and device-local memory has one instance per device, reached
+		// across GPUs by peer bindings (VMA::BindPeerBuffer()). FrameContext::SetDeviceGroupMode() spreads the frames over the devices.
+		// Windowed contexts present the instance of device 0 (Copy the results of the other devices there first).
+		static void SetDeviceGroupEnabled(bool enable); // Applied to the next creations (Default: Only the selected GPU)
+
+		// Presentation without the compositor (See SurfaceConfig): Flipped images skip the composition copy and its frame of latency
+		static void SetSurfaceConfig(const SurfaceConfig& config); // Applied to the next windowed creations
+		const SurfaceConfig& GetSurfaceConfig() const { return m_surface_config; }
+		bool IsFullScreenExclusiveSupported() const { return m_full_screen_exclusive_supported; }
+		bool IsDirectDisplay() const { return m_display != VK_NULL_HANDLE; }
+		uint32_t GetDeviceCount() const { return std::max(1U, static_cast<uint32_t>(m_device_group.size())); }
+		uint32_t GetAllDevicesMask() const { return (1U << GetDeviceCount()) - 1; }
+		// Accesses of local_device_index to the memory instance of remote_device_index in a heap (Every access if both are the same)
+		VkPeerMemoryFeatureFlags GetPeerMemoryFeatures(uint32_t heap_index, uint32_t local_device_index, uint32_t remote_device_index) const;
 
 		// Swapchain Functions (throw swapchain_error means recreation)
-		void Screenshot(std::shared_ptr<VMA::Image> screenshot, std::vector<VkSemaphore> wait_semaphores = {}, std::vector<VkSemaphore> signal_semaphores = {}, VkFence fence = nullptr);
+		// Blocking (Waits for its submission), see ReadbackEngine::CaptureCommand() or FrameCaptureRing for captures without stalls
+		void Screenshot(VMA::Image& screenshot, std::span<const VkSemaphore> wait_semaphores = {}, std::span<const VkSemaphore> signal_semaphores = {}, VkFence fence = nullptr);
+		// Throws swapchain_suspended without blocking while the window is minimized (Poll events and retry, it resumes itself)
 		void NextSwapChainImageIndex(VkSemaphore semaphore, VkFence fence,
 			uint64_t timeout = std::numeric_limits<uint64_t>::max()) throw (swapchain_error);
-		void PresentSwapChain(const std::vector<VkSemaphore>& wait_semaphore) throw (swapchain_error);
-		void RecreateSwapChain();
+		bool IsSuspended() const { return m_swapchain_suspended; } // e.g. glfwWaitEvents() instead of rendering
+		// Distinct graphics & present families: The images are exclusive, and ownership is released on the graphics queue and acquired
+		// on the present queue here (Render into them from VK_IMAGE_LAYOUT_UNDEFINED and leave them in PRESENT_SRC_KHR, as RenderPass does).
+		void PresentSwapChain(std::span<const VkSemaphore> wait_semaphores) throw (swapchain_error);
+		bool IsPresentOwnershipTransferred() const { return m_present_ownership_transfer.has_value(); }
+		void RecreateSwapChain(); // Chains the old swap chain and retires it via the deletion queue (No device idle)
+		void SetSwapChainConfig(const SwapchainConfig& config); // Applied by recreation (Present mode switches by the next present with maintenance1)
+		// Multiple Windows (See WindowSwapChain, not in headless contexts)
+		std::shared_ptr<WindowSwapChain> CreateWindowSwapChain(GLFWwindow* window);
+		// Acquire the next images of the windows concurrently on the worker pool (FIFO acquisitions block independently), semaphores[i]
+		// is signaled for windows[i] if it was acquired (WindowSwapChain::IsAcquired()). Out-of-date windows are recreated here.
+		void AcquireSwapChains(std::span<WindowSwapChain* const> windows, std::span<const VkSemaphore> semaphores,
+			uint64_t timeout = std::numeric_limits<uint64_t>::max());
+		// One vkQueuePresentKHR (swapchainCount > 1) for the main swap chain and the acquired windows, waits the wait semaphores once.
+		// Throws swapchain_error after presenting if the main swap chain is out of date (Windows are recreated by their next acquisition).
+		void PresentSwapChains(std::span<WindowSwapChain* const> windows, std::span<const VkSemaphore> wait_semaphores) throw (swapchain_error);
+
+		// Swapchain Maintenance (VK_EXT_swapchain_maintenance1): Compatible present modes are switched per present, acquired images are
+		// released instead of leaking into a recreation, and every present of the main swap chain signals a pooled fence.
+		bool IsSwapchainMaintenance1Supported() const { return m_physical_device_swapchain_maintenance1_features.swapchainMaintenance1; }
+		PFN_vkReleaseSwapchainImagesEXT m_release_swapchain_images = nullptr; // Loaded if supported
+		// Give the acquired image back without presenting it (e.g. An aborted frame that never rendered into it), returns false without maintenance1.
+		// Its acquire semaphore stays signaled: Wait it in a submission or destroy it.
+		bool ReleaseSwapChainImage();
+		uint64_t GetPresentCount() const { return m_present_count; } // Presents of the main swap chain so far
+		// Wait until the presentation engine has consumed the wait semaphores of that present (Index: GetPresentCount() - 1 after it),
+		// so they can be signaled again. No-op without maintenance1 or once completed.
+		void WaitPresent(uint64_t present_index);
+
+		// Frame Pacing (Presents are tagged and the acquisitions are paced by the displayed frames)
+		bool IsFramePacingSupported() const { return m_physical_device_present_id_features.presentId && m_physical_device_present_wait_features.presentWait; }
+		void EnableFramePacing(uint32_t max_queued_frames = 1, double safety_margin = 1.0 /*ms*/);
+		void DisableFramePacing() { m_frame_pacer.reset(); }
+		FramePacer* GetFramePacer() { return m_frame_pacer.get(); } // Null if not enabled
+
+		// Mesh Shaders (VK_EXT_mesh_shader, see CommandBuffer::DrawMeshTasks())
+		bool IsMeshShaderSupported() const { return m_physical_device_mesh_shader_features.meshShader; }
+		bool IsTaskShaderSupported() const { return m_physical_device_mesh_shader_features.taskShader; }
+		PFN_vkCmdDrawMeshTasksEXT						m_cmd_draw_mesh_tasks						= nullptr; // Loaded if supported
+		PFN_vkCmdDrawMeshTasksIndirectEXT			m_cmd_draw_mesh_tasks_indirect			= nullptr;
+		PFN_vkCmdDrawMeshTasksIndirectCountEXT	m_cmd_draw_mesh_tasks_indirect_count	= nullptr;
+
+		// Graphics Pipeline Libraries (VK_EXT_graphics_pipeline_library, see GraphicsPipeline::GetVariant())
+		bool IsGraphicsPipelineLibrarySupported() const { return m_physical_device_pipeline_library_features.graphicsPipelineLibrary; }
+
+		// Buffer Device Address (Vulkan 1.2 bufferDeviceAddress, see VMA::Buffer::DeviceAddress())
+		bool IsBufferDeviceAddressSupported() const { return m_physical_device_features2.has_value() && m_physical_device_features12.bufferDeviceAddress; }
+
+		// Imageless Framebuffers (Vulkan 1.2 imagelessFramebuffer, see RenderPass::set_imageless_attachments())
+		bool IsImagelessFramebufferSupported() const { return m_physical_device_features2.has_value() && m_physical_device_features12.imagelessFramebuffer; }
+
+		// Acceleration Structures (VK_KHR_acceleration_structure, see AccelerationStructureBuilder)
+		bool IsAccelerationStructureSupported() const { return m_physical_device_acceleration_structure_features.accelerationStructure && IsBufferDeviceAddressSupported(); }
+		PFN_vkCreateAccelerationStructureKHR							m_create_acceleration_structure							= nullptr; // Loaded if supported
+		PFN_vkDestroyAccelerationStructureKHR							m_destroy_acceleration_structure							= nullptr;
+		PFN_vkGetAccelerationStructureBuildSizesKHR				m_get_acceleration_structure_build_sizes				= nullptr;
+		PFN_vkGetAccelerationStructureDeviceAddressKHR		m_get_acceleration_structure_device_address		= nullptr;
+		PFN_vkCmdBuildAccelerationStructuresKHR					m_cmd_build_acceleration_structures					= nullptr;
+		PFN_vkCmdWriteAccelerationStructuresPropertiesKHR	m_cmd_write_acceleration_structures_properties	= nullptr;
+		PFN_vkCmdCopyAccelerationStructureKHR						m_cmd_copy_acceleration_structure						= nullptr;
+
+		// Push Descriptors (VK_KHR_push_descriptor, see GraphicsPipeline::prepare_push_descriptor_set() and CommandBuffer::PushDescriptors())
+		bool IsPushDescriptorSupported() const { return m_push_descriptor_supported; }
+		PFN_vkCmdPushDescriptorSetKHR									m_cmd_push_descriptor_set									= nullptr; // Loaded if supported
+
+		// Descriptor Buffers (VK_EXT_descriptor_buffer, see DescriptorBuffer and GraphicsPipeline::use_descriptor_buffers())
+		bool IsDescriptorBufferSupported() const { return m_physical_device_descriptor_buffer_features.descriptorBuffer && IsBufferDeviceAddressSupported(); }
+		PFN_vkGetDescriptorSetLayoutSizeEXT						m_get_descriptor_set_layout_size						= nullptr; // Loaded if supported
+		PFN_vkGetDescriptorSetLayoutBindingOffsetEXT		m_get_descriptor_set_layout_binding_offset		= nullptr;
+		PFN_vkGetDescriptorEXT												m_get_descriptor												= nullptr;
+		PFN_vkCmdBindDescriptorBuffersEXT							m_cmd_bind_descriptor_buffers							= nullptr;
+		PFN_vkCmdSetDescriptorBufferOffsetsEXT					m_cmd_set_descriptor_buffer_offsets					= nullptr;
+
+		// Conditional Rendering (VK_EXT_conditional_rendering, see CommandBuffer::BeginConditional() and QueryPool::CopyPredicates())
+		bool IsConditionalRenderingSupported() const { return m_physical_device_conditional_rendering_features.conditionalRendering; }
+		PFN_vkCmdBeginConditionalRenderingEXT						m_cmd_begin_conditional_rendering						= nullptr; // Loaded if supported
+		PFN_vkCmdEndConditionalRenderingEXT							m_cmd_end_conditional_rendering						= nullptr;
+
+		// Variable Rate Shading (VK_KHR_fragment_shading_rate): Per pipeline (GraphicsPipeline::prepare_fragment_shading_rate_state()),
+		// per draw (CommandBuffer::SetFragmentShadingRate()) and per region of the screen (ShadingRateImage)
+		bool IsFragmentShadingRateSupported() const { return m_physical_device_fragment_shading_rate_features.pipelineFragmentShadingRate; }
+		bool IsShadingRateAttachmentSupported() const { return m_physical_device_fragment_shading_rate_features.attachmentFragmentShadingRate; }
+		PFN_vkCmdSetFragmentShadingRateKHR							m_cmd_set_fragment_shading_rate							= nullptr; // Loaded if supported
+
+		// GPU Crash Breadcrumbs (Markers around every render graph pass, reported by OnDeviceLost(), see CrashBreadcrumbs)
+		void EnableCrashBreadcrumbs(uint32_t max_markers = 4096); // Before recording (Markers are written into recorded command buffers)
+		CrashBreadcrumbs* GetCrashBreadcrumbs() { return m_crash_breadcrumbs.get(); } // Null if not enabled
+		void OnDeviceLost(); // Logs the breadcrumbs once (Called by the submissions and presents that return VK_ERROR_DEVICE_LOST)
+		PFN_vkCmdWriteBufferMarkerAMD									m_cmd_write_buffer_marker									= nullptr; // Loaded if supported
+		PFN_vkCmdSetCheckpointNV											m_cmd_set_checkpoint											= nullptr;
+		PFN_vkGetQueueCheckpointDataNV									m_get_queue_checkpoint_data									= nullptr;
+
+		// Host Image Copy (VK_EXT_host_image_copy, see VMA::Image::WriteFromHost())
+		bool IsHostImageCopySupported() const { return m_physical_device_host_image_copy_features.hostImageCopy; }
+		bool IsHostImageCopyDstLayout(VkImageLayout layout) const { return std::ranges::find(m_host_image_copy_dst_layouts, layout) != m_host_image_copy_dst_layouts.end(); }
+		PFN_vkCopyMemoryToImageEXT										m_copy_memory_to_image										= nullptr; // Loaded if supported
+		PFN_vkTransitionImageLayoutEXT									m_transition_image_layout									= nullptr;
+
+		// Memory Priority (VK_EXT_memory_priority, see VMA::MemoryPriority): The driver evicts low priority memory first when VRAM is oversubscribed.
+		// VK_EXT_pageable_device_local_memory lets the OS page device memory by these priorities, and re-prioritize dedicated allocations.
+		bool IsMemoryPrioritySupported() const { return m_physical_device_memory_priority_features.memoryPriority; }
+		bool IsPageableDeviceLocalMemorySupported() const { return m_physical_device_pageable_memory_features.pageableDeviceLocalMemory; }
+		PFN_vkSetDeviceMemoryPriorityEXT									m_set_device_memory_priority									= nullptr; // Loaded if supported
+
+		// Image Compression Control (VK_EXT_image_compression_control, see VMA::ImageCompression): Disabled or lossy fixed-rate compression
+		// of images (AllocateImage()) and swap chain images (SwapchainConfig::compression, VK_EXT_image_compression_control_swapchain)
+		bool IsImageCompressionControlSupported() const { return m_physical_device_image_compression_control_features.imageCompressionControl; }
+		bool IsSwapchainCompressionControlSupported() const { return m_physical_device_swapchain_compression_control_features.imageCompressionControlSwapchain; }
+		PFN_vkGetImageSubresourceLayout2EXT								m_get_image_subresource_layout2							= nullptr; // Loaded if supported
+
+		// Multi Draw (VK_EXT_multi_draw, see CommandBuffer::DrawMulti() and DrawQueue): Batches of direct draws in one command
+		bool IsMultiDrawSupported() const { return m_physical_device_multi_draw_features.multiDraw; }
+		PFN_vkCmdDrawMultiEXT													m_cmd_draw_multi													= nullptr; // Loaded if supported
+		PFN_vkCmdDrawMultiIndexedEXT											m_cmd_draw_multi_indexed										= nullptr;
+
+		// Shader Objects (VK_EXT_shader_object, see ShaderObjectProgram): Linked shader stages bound without pipelines, every state is dynamic
+		bool IsShaderObjectSupported() const { return m_physical_device_shader_object_features.shaderObject; }
+		PFN_vkCreateShadersEXT													m_create_shaders													= nullptr; // Loaded if supported
+		PFN_vkDestroyShaderEXT													m_destroy_shader													= nullptr;
+		PFN_vkCmdBindShadersEXT												m_cmd_bind_shaders												= nullptr;
+		PFN_vkCmdSetVertexInputEXT											m_cmd_set_vertex_input											= nullptr;
+		PFN_vkCmdSetPolygonModeEXT											m_cmd_set_polygon_mode										= nullptr;
+		PFN_vkCmdSetRasterizationSamplesEXT							m_cmd_set_rasterization_samples							= nullptr;
+		PFN_vkCmdSetSampleMaskEXT												m_cmd_set_sample_mask											= nullptr;
+		PFN_vkCmdSetAlphaToCoverageEnableEXT							m_cmd_set_alpha_to_coverage_enable					= nullptr;
+		PFN_vkCmdSetAlphaToOneEnableEXT									m_cmd_set_alpha_to_one_enable								= nullptr;
+		PFN_vkCmdSetLogicOpEnableEXT										m_cmd_set_logic_op_enable									= nullptr;
+		PFN_vkCmdSetDepthClampEnableEXT									m_cmd_set_depth_clamp_enable								= nullptr;
+		PFN_vkCmdSetColorBlendEnableEXT									m_cmd_set_color_blend_enable								= nullptr;
+		PFN_vkCmdSetColorBlendEquationEXT								m_cmd_set_color_blend_equation							= nullptr;
+		PFN_vkCmdSetColorWriteMaskEXT										m_cmd_set_color_write_mask									= nullptr;
+		PFN_vkCmdSetPatchControlPointsEXT								m_cmd_set_patch_control_points							= nullptr;
+
+		// Video Encode (VK_KHR_video_encode_queue with H.264 on m_device_queue_family_video_encode, see VideoEncoder)
+		bool IsVideoEncodeSupported() const { return m_video_encode_h264_supported; }
+		PFN_vkGetPhysicalDeviceVideoCapabilitiesKHR						m_get_physical_device_video_capabilities						= nullptr; // Loaded if supported
+		PFN_vkGetPhysicalDeviceVideoFormatPropertiesKHR				m_get_physical_device_video_format_properties			= nullptr;
+		PFN_vkCreateVideoSessionKHR										m_create_video_session										= nullptr;
+		PFN_vkDestroyVideoSessionKHR										m_destroy_video_session										= nullptr;
+		PFN_vkGetVideoSessionMemoryRequirementsKHR				m_get_video_session_memory_requirements				= nullptr;
+		PFN_vkBindVideoSessionMemoryKHR									m_bind_video_session_memory								= nullptr;
+		PFN_vkCreateVideoSessionParametersKHR							m_create_video_session_parameters						= nullptr;
+		PFN_vkDestroyVideoSessionParametersKHR						m_destroy_video_session_parameters						= nullptr;
+		PFN_vkGetEncodedVideoSessionParametersKHR					m_get_encoded_video_session_parameters				= nullptr;
+		PFN_vkCmdBeginVideoCodingKHR										m_cmd_begin_video_coding									= nullptr;
+		PFN_vkCmdEndVideoCodingKHR											m_cmd_end_video_coding										= nullptr;
+		PFN_vkCmdControlVideoCodingKHR									m_cmd_control_video_coding									= nullptr;
+		PFN_vkCmdEncodeVideoKHR												m_cmd_encode_video												= nullptr;
+
+		// Calibrated Timestamps (VK_EXT_calibrated_timestamps, see GPUProfiler): Samples the device clock together with the host clock of Trace::Now()
+		bool IsCalibratedTimestampsSupported() const { return m_calibrated_timestamps_supported; }
+		PFN_vkGetCalibratedTimestampsEXT								m_get_calibrated_timestamps								= nullptr; // Loaded if supported
+
+		// Memory Budget (VK_EXT_memory_budget, see VMA::GetMemoryBudgets() - VMA estimates the budget without it)
+		bool IsMemoryBudgetSupported() const { return m_memory_budget_supported; }
+		// Host Pointer Import (VK_EXT_external_memory_host, see UploadEngine::UploadImageFile())
+		bool IsExternalMemoryHostSupported() const { return m_external_memory_host_supported; }
+		// External Memory (Cross-process sharing without copies, see VMA::AllocateExportableImage() and Semaphore::Export()):
+		// Opaque file descriptors (DMA_BUF buffers with VK_EXT_external_memory_dma_buf) or NT handles on Windows, exported timeline semaphores.
+		// Both processes must pick the same device (GetPhysicalDeviceUUID() & PinPhysicalDevice()) and driver.
+		bool IsExternalMemorySupported() const { return m_external_memory_supported; }
+		bool IsDmaBufSupported() const { return m_external_memory_dma_buf_supported; }
+		PFN_vkGetMemoryFdKHR														m_get_memory_fd													= nullptr; // Loaded if supported
+		PFN_vkGetMemoryFdPropertiesKHR											m_get_memory_fd_properties									= nullptr;
+		PFN_vkGetSemaphoreFdKHR													m_get_semaphore_fd												= nullptr;
+		PFN_vkImportSemaphoreFdKHR												m_import_semaphore_fd											= nullptr;
+		// Windows (Cast to the PFNs of <vulkan/vulkan_win32.h> where <windows.h> is included)
+		PFN_vkVoidFunction															m_get_memory_win32_handle									= nullptr;
+		PFN_vkVoidFunction															m_get_semaphore_win32_handle								= nullptr;
+		PFN_vkVoidFunction															m_import_semaphore_win32_handle							= nullptr;
+		PFN_vkVoidFunction															m_acquire_full_screen_exclusive_mode					= nullptr; // Loaded if IsFullScreenExclusiveSupported()
+
+		// Pipeline Cache (checkpoint - the cache will be also saved when the context is destroyed)
+		void SavePipelineCache();
+		// Shared Pipeline Cache: Worker processes read <pipeline_cache_file> (e.g. on shared storage) but save their caches to private delta
+		// files, then a single merge step combines the deltas into <pipeline_cache_file> by vkMergePipelineCaches() (Replaced atomically,
+		// its generation counts the merges). Deltas of other devices or drivers are skipped, returns the number of merged deltas.
+		void SetPipelineCacheDeltaFile(std::string_view delta_file); // Empty: Save to <pipeline_cache_file> again
+		size_t MergePipelineCaches(const std::vector<std::string>& delta_files); // Also warms the cache of this context
+		uint64_t GetPipelineCacheGeneration() const { return m_pipeline_cache_generation; }
+
+		// Caches
+		ShaderCache& GetShaderCache() { return *m_shader_cache; }
+
+		// Bindless (Check IsBindlessSupported() before accessing the heap)
+		bool IsBindlessSupported() const { return m_bindless_heap != nullptr; }
+		BindlessHeap& GetBindlessHeap() { assert(m_bindless_heap && "Bindless is not supported by this device!"); return *m_bindless_heap; }
+
+		// Resource Registry (Generational handles of registered buffers & images, see ResourceRegistry)
+		ResourceRegistry& GetResourceRegistry() { return *m_resource_registry; }
+
+		// Sync Pool (Recycled binary semaphores & fences behind CreateSemaphore() and CreateFence())
+		SyncPool& GetSyncPool() { return *m_sync_pool; }
+
+		// Per-frame RHI counters (Published by FrameContext::EndFrame(), see RHIStatistics)
+		RHIStatistics& GetStatistics() { return m_statistics; }
+
+		// Deferred Deletion (Destroyed once the GPU has passed all submitted work, or immediately during teardown)
+		DeletionQueue& GetDeletionQueue() { return *m_deletion_queue; }
+		void DeferDeletion(DeletionQueue::Deleter deleter);
+		// DeletionQueue::Collect() at a frame boundary: Every command buffer using the deleted objects must have been submitted.
+		// FrameContext::BeginFrame() calls it, contexts without a FrameContext call it after submitting their frame (or batch).
+		void CollectDeletions();
+
+		// Baked Command Buffers (see CommandBufferBaked) & Descriptor Set Caches: Called before a buffer, image, pipeline or descriptor set is destroyed or moved
+		template<typename VulkanHandle>
+		void InvalidateBakedCommands(VulkanHandle handle)
+		{
+			if (m_baked_command_buffer_count.load(std::memory_order_relaxed)) invalidate_baked_commands((uint64_t)handle);
+			if (m_descriptor_set_cache_count.load(std::memory_order_relaxed)) invalidate_descriptor_set_caches((uint64_t)handle);
+		}
+
+		// Parallel Services
+		WorkerPool& GetWorkerPool() { return *m_worker_pool; } // Work-stealing (Wait() inside jobs instead of blocking on futures)
+		UploadEngine& GetUploadEngine() { return *m_upload_engine; } // Asynchronous uploads on the transfer queue
+		CompletionPoller& GetCompletionPoller() { return *m_completion_poller; } // Resumes the coroutines waiting for the GPU
+		// Initialize pipelines on the worker pool (Note that prepare_xxx() functions will be called on worker threads)
+		std::vector<std::future<void>> InitializeGraphicsPipelines(const std::vector<GraphicsPipeline*>& graphics_pipelines);
+
+		// Pipeline Trace (see PipelineTrace): Attach before creating pipelines to record them, nullptr detaches
+		void SetPipelineTrace(std::shared_ptr<PipelineTrace> pipeline_trace) { m_pipeline_trace = std::move(pipeline_trace); }
+		PipelineTrace* GetPipelineTrace() const { return m_pipeline_trace.get(); }
+		// Compiles the records into the pipeline cache on the worker pool (false: Skipped record), later creations of them are cache hits
+		std::vector<std::future<bool>> PrewarmPipelines(PipelineTrace& pipeline_trace);
+		// Command Capture (see CommandCapture): Attach before creating the resources and pipelines of the workload, nullptr detaches
+		void SetCommandCapture(std::shared_ptr<CommandCapture> command_capture) { m_command_capture = std::move(command_capture); }
+		CommandCapture* GetCommandCapture() const { return m_command_capture.get(); }
+
+		// Shader Hot Reload (see GraphicsPipeline::EnableHotReload())
+		// Called by FrameContext::BeginFrame(): Swaps the rebuilt pipelines in, and checks the shader files on the worker pool
+		void UpdateShaderHotReload();
+		void WatchShaderFiles(GraphicsPipeline* graphics_pipeline, bool watch); // Unwatching waits for a running reload
 
 	public:
-		static std::shared_ptr<VulkanContext>	 Create(GLFWwindow* window); // Create Vulkan Context
+		// The persisted files (<pipeline_cache_file>, .reflection and the shader archive .archive if present) are loaded on the worker pool
+		// while the instance and device are created, the bindless heap and the upload engine are created alongside the swap chain.
+		static std::shared_ptr<VulkanContext>	 Create(GLFWwindow* window, std::string_view pipeline_cache_file = "AlbedoRHI.pipeline_cache"); // Create Vulkan Context
+		// Without surface, swap chain and present queue (Several headless contexts are allowed, e.g. one per batch job)
+		// The swap chain images are replaced by an offscreen image ring, so RenderPass and GraphicsPipeline work unchanged.
+		static std::shared_ptr<VulkanContext>	 CreateHeadless(VkExtent2D extent, uint32_t image_count = 3, std::string_view pipeline_cache_file = "");
+		// One headless context per suitable GPU (Dispatch jobs across them via DeviceScheduler)
+		// All contexts of a process share one VkInstance, and identical GPUs share one pipeline cache file.
+		static std::vector<std::shared_ptr<VulkanContext>> CreateHeadlessGroup(VkExtent2D extent, uint32_t image_count = 3, std::string_view pipeline_cache_file = "");
+
+		// Physical Device Selection (The suitable GPU with the highest score wins, the decision is cached in <pipeline_cache_file>.device)
+		using PhysicalDeviceUUID = std::array<uint8_t, VK_UUID_SIZE>;
+		static void PinPhysicalDevice(std::optional<PhysicalDeviceUUID> device_uuid); // Applied to the next creations (std::nullopt: Scored)
+		PhysicalDeviceUUID GetPhysicalDeviceUUID();
 
 		// Common Products (Command Buffers and Descriptor Sets are created from Global Pools with Lazy Creation)
 		std::weak_ptr<VulkanContext>				CreateVulkanContextView() { return shared_from_this(); }
@@ -104,71 +567,242 @@ namespace RHI
 		std::shared_ptr<CommandBuffer>		CreateOneTimeCommandBuffer(QueueFamilyIndex& submit_queue_family_index, bool primary = true, std::thread::id thread_id = std::this_thread::get_id());
 		std::shared_ptr<CommandBuffer>		CreateResetableCommandBuffer(QueueFamilyIndex& submit_queue_family_index, bool primary = true, std::thread::id thread_id = std::this_thread::get_id());
 
-		std::shared_ptr<DescriptorSetLayout>	CreateDescripotrSetLayout(std::vector<VkDescriptorSetLayoutBinding> descriptor_bindings);
+		std::shared_ptr<DescriptorSetLayout>	CreateDescripotrSetLayout(std::vector<VkDescriptorSetLayoutBinding> descriptor_bindings, // Identical layouts are shared
+																										std::vector<std::shared_ptr<Sampler>> immutable_samplers = {}, // Of pImmutableSamplers (Kept alive)
+																										VkDescriptorSetLayoutCreateFlags flags = 0); // e.g. PUSH_DESCRIPTOR_BIT_KHR
+		std::shared_ptr<PipelineLayout>				CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts,
+																										const std::vector<VkPushConstantRange>& push_constant_ranges); // Identical layouts are shared
+		// Pipeline Registry: create_pipeline() only runs for unknown state keys (Thread-safe, compiled outside the lock)
+		std::shared_ptr<PipelineStateObject>		AcquirePipeline(std::vector<uint8_t> state_key, const std::function<VkPipeline()>& create_pipeline);
 		std::shared_ptr<DescriptorSet>				CreateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout, std::thread::id thread_id = std::this_thread::get_id());
 
+		// Sampler Cache: Identical descriptions share one immutable sampler (maxSamplerAllocationCount is small)
+		std::shared_ptr<Sampler>						CreateSampler(const Sampler::Desc& desc);
 		std::shared_ptr<Sampler>						CreateSampler(VkSamplerAddressMode address_mode,
 																										VkBorderColor border_color = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
 																										VkCompareOp compare_mode = VK_COMPARE_OP_NEVER,
-																										bool anisotropy_enable = true);
+																										bool anisotropy_enable = true,
+																										float max_lod = VK_LOD_CLAMP_NONE); // Linear filters & mipmaps
+		// Named descriptions for ImmutableSamplerBinding (Re-registering a name with another description throws)
+		void													RegisterImmutableSampler(std::string name, const Sampler::Desc& desc);
+		std::shared_ptr<Sampler>						GetImmutableSampler(std::string_view name); // From the sampler cache
 
 		std::unique_ptr<Semaphore>					CreateSemaphore(VkSemaphoreCreateFlags flags);
 		std::unique_ptr<Fence>							CreateFence(VkFenceCreateFlags flags);
+		std::unique_ptr<Event>							CreateEvent(); // Device-only with synchronization2 (Split Barriers)
 
 		// Advanced Products (Create Local Pools)
 		std::shared_ptr<CommandPool>			CreateCommandPool(QueueFamilyIndex& submit_queue_family_index,
-																													VkCommandPoolCreateFlags command_pool_flags);
-		std::shared_ptr<DescriptorPool>			CreateDescriptorPool(std::vector<VkDescriptorPoolSize> pool_size, uint32_t limit_max_sets);
+																													VkCommandPoolCreateFlags command_pool_flags,
+																													uint32_t submit_queue_index = 0); // GetQueueIndex()
+		std::shared_ptr<DescriptorPool>			CreateDescriptorPool(std::vector<VkDescriptorPoolSize> pool_size, uint32_t limit_max_sets,
+																													VkDescriptorPoolCreateFlags flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+		std::shared_ptr<DescriptorAllocator>	CreateDescriptorAllocator(bool free_descriptor_sets = true, uint32_t initial_sets_per_pool = 128);
+		std::shared_ptr<DescriptorArena>		CreateDescriptorArena(uint32_t frames_in_flight, uint32_t initial_sets_per_pool = 256);
+		std::shared_ptr<DescriptorBuffer>		CreateDescriptorBuffer(uint32_t frames_in_flight, VkDeviceSize capacity_per_frame = 1024 * 1024); // IsDescriptorBufferSupported()
+		std::shared_ptr<FrameContext>				CreateFrameContext(uint32_t frames_in_flight = 2, VkDeviceSize staging_capacity_per_frame = 8 * 1024 * 1024);
+		std::shared_ptr<GPUProfiler>				CreateGPUProfiler(uint32_t frames_in_flight, uint32_t max_zones_per_frame = 512);
+		std::shared_ptr<QueryPool>					CreateQueryPool(QueryPool::Type type, uint32_t frames_in_flight, uint32_t max_queries_per_frame = 256);
+		std::shared_ptr<RenderGraph>				CreateRenderGraph(uint32_t frames_in_flight);
 
 	public:
 		// Global Objects
+		// Thread-safe, usually called from the thread itself (Command Pools must only be used by one thread at a time)
 		std::shared_ptr<CommandPool>			GetGlobalOneTimeCommandPool(QueueFamilyIndex& queue_family_index, std::thread::id thread_id = std::this_thread::get_id());
 		std::shared_ptr<CommandPool>			GetGlobalResetableCommandPool(QueueFamilyIndex& queue_family_index, std::thread::id thread_id = std::this_thread::get_id());
 		
-		std::shared_ptr<DescriptorPool>			GetGlobalDescriptorPool(std::thread::id thread_id = std::this_thread::get_id());
+		std::shared_ptr<QueueTimeline>			GetGlobalQueueTimeline(QueueFamilyIndex& queue_family_index, uint32_t queue_index = 0); // Thread-safe
+		std::shared_ptr<DescriptorAllocator>	GetGlobalDescriptorAllocator(std::thread::id thread_id = std::this_thread::get_id());
+		std::shared_ptr<DescriptorPool>			GetGlobalDescriptorPool(std::thread::id thread_id = std::this_thread::get_id()); // Current pool of the global allocator
 
 	private:
-		// Global Resource
-		using GlobalCommandPool = std::unordered_map<QueueFamilyIndex, std::shared_ptr<CommandPool>>;
-		std::unordered_map<std::thread::id, GlobalCommandPool> m_global_onetime_command_pools;
-		std::unordered_map<std::thread::id, GlobalCommandPool> m_global_resetable_command_pools;
-
-		using GlobalDescriptorPool = std::shared_ptr<DescriptorPool>;
-		std::unordered_map<std::thread::id, GlobalDescriptorPool> m_global_descriptor_pool;
+		// Global Resource (Registered per thread, lookups from the owner thread are lock-free)
+		static constexpr uint32_t MAX_QUEUE_FAMILY_COUNT = 16;
+		struct GlobalThreadSlot
+		{
+			using GlobalCommandPool = std::array<std::atomic<std::shared_ptr<CommandPool>>, MAX_QUEUE_FAMILY_COUNT>; // Queue Family Index
+			GlobalCommandPool onetime_command_pools;
+			GlobalCommandPool resetable_command_pools;
+			std::atomic<std::shared_ptr<DescriptorAllocator>> descriptor_allocator;
+		};
+		GlobalThreadSlot& get_global_thread_slot(std::thread::id thread_id);
+		std::array<uint32_t, MAX_QUEUE_FAMILY_COUNT> m_device_queue_counts{}; // Created queues per family
+		std::array<VkQueueGlobalPriorityKHR, MAX_QUEUE_FAMILY_COUNT> m_device_queue_global_priorities; // Granted per family (Filled by create_logical_device())
+		const uint64_t m_context_id; // Validate thread_local slot caches
+		std::shared_mutex m_global_thread_slots_mutex;
+		std::unordered_map<std::thread::id, std::unique_ptr<GlobalThreadSlot>> m_global_thread_slots; // Registered threads
+
+		std::mutex m_global_queue_timelines_mutex;
+		std::unordered_map<uint64_t, std::shared_ptr<QueueTimeline>> m_global_queue_timelines; // (Family << 32 | Queue Index)
+
+		std::mutex m_descriptor_set_layout_cache_mutex;
+		std::unordered_map<uint64_t, std::weak_ptr<DescriptorSetLayout>> m_descriptor_set_layout_cache;
+
+		std::mutex m_sampler_cache_mutex;
+		std::unordered_map<uint64_t, std::weak_ptr<Sampler>> m_sampler_cache;
+		std::unordered_map<std::string, Sampler::Desc> m_immutable_samplers; // Name -> Description
+
+		void invalidate_baked_commands(uint64_t handle);
+		std::mutex m_baked_command_buffers_mutex;
+		std::vector<CommandBufferBaked*> m_baked_command_buffers; // Valid ones
+		std::atomic<size_t> m_baked_command_buffer_count = 0; // Skip the lock without any
+
+		void invalidate_descriptor_set_caches(uint64_t handle);
+		std::mutex m_descriptor_set_caches_mutex;
+		std::vector<DescriptorSetCache*> m_descriptor_set_caches;
+		std::atomic<size_t> m_descriptor_set_cache_count = 0; // Ditto
+
+		std::mutex m_pipeline_registry_mutex;
+		std::unordered_map<uint64_t, std::weak_ptr<PipelineLayout>> m_pipeline_layout_registry;
+		std::unordered_map<uint64_t, std::weak_ptr<PipelineStateObject>> m_pipeline_registry;
+
+		static constexpr auto SHADER_WATCH_INTERVAL = std::chrono::milliseconds(250);
+		std::mutex m_hot_reload_mutex; // Held by the watch job while rebuilding
+		std::vector<GraphicsPipeline*> m_hot_reload_pipelines;
+		std::future<void> m_shader_watch_job; // Render thread
+		std::chrono::steady_clock::time_point m_next_shader_watch;
+
+		std::unique_ptr<WorkerPool> m_worker_pool;
+		std::unique_ptr<ShaderCache> m_shader_cache;
+		std::shared_ptr<PipelineTrace> m_pipeline_trace;
+		std::shared_ptr<CommandCapture> m_command_capture;
+		std::unique_ptr<BindlessHeap> m_bindless_heap;
+		std::unique_ptr<ResourceRegistry> m_resource_registry;
+		std::unique_ptr<SyncPool> m_sync_pool;
+		RHIStatistics m_statistics;
+		std::unique_ptr<UploadEngine> m_upload_engine;
+		std::unique_ptr<CompletionPoller> m_completion_poller;
+		std::unique_ptr<DeletionQueue> m_deletion_queue;
+		std::unique_ptr<FramePacer> m_frame_pacer;
+		std::unique_ptr<CrashBreadcrumbs> m_crash_breadcrumbs;
+		std::atomic<bool> m_device_lost{ false };
+
+		std::atomic<bool> m_swapchain_recreating{ false };
+		bool m_swapchain_suspended = false; // Zero framebuffer extent: No swap chain and depth image (Resumed by the acquisitions)
+		std::optional<PresentOwnershipTransfer> m_present_ownership_transfer; // Empty: Identical families (Concurrent sharing is never used)
+		// Present fences of the main swap chain (Maintenance1, in present order)
+		struct PresentFence
+		{
+			uint64_t present_index;
+			VkFence fence;
+			VkSwapchainKHR swapchain;
+		};
+		std::mutex m_present_fences_mutex;
+		std::deque<PresentFence> m_present_fences;
+		uint64_t m_present_count = 0;
+		void collect_present_fences(); // Return the signaled fences to the SyncPool
 
 	private:
 		VulkanContext() = delete;
 		VulkanContext(GLFWwindow* window); // VulkanContext::Create(GLFWwindow* window)
+		static std::shared_ptr<VulkanContext> create(GLFWwindow* window, std::string_view pipeline_cache_file, VkExtent2D headless_extent = {}, uint32_t headless_image_count = 0,
+			VkPhysicalDevice physical_device = VK_NULL_HANDLE /*First suitable*/, uint32_t worker_count = 0 /*Hardware concurrency*/);
 		~VulkanContext();
 
 	protected:
 		// Creation
 		static std::mutex	VULKAN_CONTEXT_CREATION_MUTEX;
-		static bool				NO_VULKAN_CONTEXTS;	
+		static std::weak_ptr<SharedInstance> SHARED_INSTANCE; // Guarded by VULKAN_CONTEXT_CREATION_MUTEX
+		static std::optional<PhysicalDeviceUUID> PINNED_PHYSICAL_DEVICE; // Ditto
+		static QueueConfig QUEUE_CONFIG; // Ditto
+		static bool DEVICE_GROUP_ENABLED; // Ditto
+		static SurfaceConfig SURFACE_CONFIG; // Ditto
 		// Initialization
 		void enable_validation_layers();
+		void create_worker_pool(uint32_t worker_count);
+		void register_worker_threads(); // Global command pools & descriptor allocators of the workers (No registration in their first job)
 		void create_vulkan_instance();
 		void create_debug_messenger();
 		void create_surface();
+		void create_display_surface(); // DIRECT_DISPLAY (Pins the physical device driving the display)
 		void create_physical_device();
 		void create_logical_device();
+		void create_sync_pool();
 		void create_memory_allocator();
+		void create_deletion_queue();
+		void create_resource_registry();
+		std::vector<char> read_pipeline_cache_file() const; // Worker thread (Validated by create_pipeline_cache())
+		void create_pipeline_cache(std::span<const char> pipeline_cache_file);
+		std::span<const char> validate_pipeline_cache_file(std::span<const char> pipeline_cache_file, std::string_view name, uint64_t* generation) const; // Cache data (Empty: Invalid)
+		VkPipelineCache create_pipeline_cache_object(std::span<const char> cache_data) const;
+		void write_pipeline_cache_file(const std::string& pipeline_cache_file, uint64_t generation) const;
+		std::future<void> create_shader_cache(); // The persisted reflections & archive are loaded on a worker
+		void create_bindless_heap();
+		void create_upload_engine();
+		void create_completion_poller();
 		void create_swap_chain();
+		void create_offscreen_images(); // Headless swap chain
+		void create_depth_stencil_image();
+		PresentOwnershipTransfer create_present_ownership_transfer(std::span<const VkImage> swapchain_images); // Distinct graphics & present families only
 		// Destroy (reverse order of initialization) 
 		// Physical Devices will be implicitly destroyed when the VkInstance is destroyed.
+		void retire_swap_chain(); // Deferred destruction of the current swap chain (Recreation)
+		void suspend_swap_chain(); // Zero framebuffer extent
 		void destroy_swap_chain();
+		void destroy_present_ownership_transfer(const PresentOwnershipTransfer& transfer);
+		void destroy_upload_engine();
+		void destroy_completion_poller();
+		void destroy_bindless_heap();
+		void destroy_shader_cache();
+		void destroy_pipeline_cache();
+		void destroy_resource_registry();
+		void destroy_deletion_queue();
 		void destroy_memory_allocator();
+		void destroy_sync_pool();
 		void destroy_logical_device();
 		void destroy_surface();
-		void destroy_debug_messenger();
-		void destroy_vulkan_instance();
+		void destroy_vulkan_instance(); // Also the debug messenger (If this context is the last owner)
+		void destroy_worker_pool();
+		// Shader Hot Reload
+		void watch_shader_files(); // Worker thread
 
 	protected:
+		// Physical Device Selection
+		bool select_physical_device(VkPhysicalDevice physical_device); // Return false if not suitable
+		uint64_t score_physical_device(); // Of the selected one
+		void select_device_group(); // Group of the selected one if it is linked to other GPUs
+		VkPhysicalDevice load_physical_device_decision(const std::vector<VkPhysicalDevice>& physical_devices); // Null if outdated
+		void save_physical_device_decision(uint32_t physical_device_count);
+
 		// Physical Device Support
 		bool check_physical_device_features_support();
+		void query_physical_device_advanced_features();
+		// Feature structs of an extension (With the structs chained to them) are queried on their own: Querying the whole chain again
+		// would undo the clean-ups of the earlier structs. The clean-ups are applied once after the last query.
+		void query_physical_device_features(void* features);
+		void chain_physical_device_features(void* features); // Append to the device creation chain
+		void disable_unused_physical_device_features();
+		void query_physical_device_present_wait_support(); // Optional VK_KHR_present_id & VK_KHR_present_wait
+		void query_physical_device_swapchain_maintenance1_support(); // Optional VK_EXT_swapchain_maintenance1
+		void query_physical_device_mesh_shader_support(); // Optional VK_EXT_mesh_shader
+		void query_physical_device_pipeline_library_support(); // Optional VK_EXT_graphics_pipeline_library
+		void query_physical_device_memory_budget_support(); // Optional VK_EXT_memory_budget
+		void query_physical_device_external_memory_host_support(); // Optional VK_EXT_external_memory_host
+		void query_physical_device_external_memory_support(); // Optional VK_KHR_external_memory_fd & VK_KHR_external_semaphore_fd (Win32 on Windows)
+		void query_physical_device_acceleration_structure_support(); // Optional VK_KHR_acceleration_structure
+		void query_physical_device_push_descriptor_support(); // Optional VK_KHR_push_descriptor
+		void query_physical_device_descriptor_buffer_support(); // Optional VK_EXT_descriptor_buffer
+		void query_physical_device_conditional_rendering_support(); // Optional VK_EXT_conditional_rendering
+		void query_physical_device_fragment_shading_rate_support(); // Optional VK_KHR_fragment_shading_rate
+		void query_physical_device_crash_diagnostics_support(); // Optional VK_AMD_buffer_marker & VK_NV_device_diagnostic_checkpoints
+		void query_physical_device_host_image_copy_support(); // Optional VK_EXT_host_image_copy
+		void query_physical_device_memory_priority_support(); // Optional VK_EXT_memory_priority & VK_EXT_pageable_device_local_memory
+		void query_physical_device_multi_draw_support(); // Optional VK_EXT_multi_draw
+		void query_physical_device_shader_object_support(); // Optional VK_EXT_shader_object
+		void query_physical_device_video_encode_support(); // Optional VK_KHR_video_queue & VK_KHR_video_encode_queue & VK_KHR_video_encode_h264
+		void query_physical_device_calibrated_timestamps_support(); // Optional VK_EXT_calibrated_timestamps
+		void query_physical_device_global_priority_support(); // Optional VK_KHR_global_priority (Queryable) or VK_EXT_global_priority
+		void query_physical_device_image_compression_control_support(); // Optional VK_EXT_image_compression_control & VK_EXT_image_compression_control_swapchain
+		void query_physical_device_full_screen_exclusive_support(); // Optional VK_EXT_full_screen_exclusive (Windows, FULL_SCREEN_EXCLUSIVE)
+		VkQueueGlobalPriorityKHR get_queue_family_global_priority(uint32_t queue_family_index) const; // Requested by m_queue_config, clamped to the family's support
+		bool check_physical_device_bindless_support();
 		bool check_physical_device_queue_families_support();
 		bool check_physical_device_extensions_support();
 		bool check_physical_device_surface_support();
+		bool is_device_extension_available(const char* extension_name);
+		void enumerate_physical_device_capabilities(const std::vector<VkPhysicalDevice>& physical_devices); // In parallel
+		const PhysicalDeviceCapabilities& get_physical_device_capabilities(); // Of m_physical_device
+		static PhysicalDeviceCapabilities query_physical_device_capabilities(VkPhysicalDevice physical_device);
 
 		// Swap Chain Support
 		bool check_swap_chain_image_format_support();
@@ -177,10 +811,7 @@ namespace RHI
 
 	protected:
 		// Debug Messenger
-		enum vulkan_message_type { VERBOSE, INFO, WARN, ERROR, MAX_MESSAGE_TYPE };
-		static std::vector<uint32_t> s_debug_message_statistics;
-
-		inline static auto GetDefaultDebuggerMessengerCreateInfo()
+		inline static auto GetDefaultDebuggerMessengerCreateInfo(DebugMessageQueue* debug_message_queue = nullptr)
 		{
 			return VkDebugUtilsMessengerCreateInfoEXT
 			{
@@ -195,7 +826,7 @@ namespace RHI
 				VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
 				VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
 				.pfnUserCallback = VulkanContext::callback_debug_messenger,
-				.pUserData = nullptr
+				.pUserData = debug_message_queue
 			};
 		}
 
@@ -208,26 +839,10 @@ namespace RHI
 				void* pUserData
 			)
 		{
-			if (VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT & messageSeverity)
-			{
-				VulkanContext::s_debug_message_statistics[VERBOSE]++;
-			}
-			else if (VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT & messageSeverity)
-			{
-				VulkanContext::s_debug_message_statistics[INFO]++;
-				//log::info("\n[Vulkan]: {}", pCallbackData->pMessage);
-			}
-			else if (VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT & messageSeverity)
-			{
-				VulkanContext::s_debug_message_statistics[WARN]++;
-				log::warn("\n[Vulkan]: {}", pCallbackData->pMessage);
-			}
-			else if (VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT & messageSeverity)
-			{
-				VulkanContext::s_debug_message_statistics[ERROR]++;
-				log::error("\n[Vulkan]: {}", pCallbackData->pMessage);
-			}
-			else log::critical("\n[Vulkan]: Unknow Message Severity {}", messageSeverity);
+			// Queued for the logger thread (Without user data: vkCreateInstance & vkDestroyInstance, logged here)
+			if (pUserData) static_cast<DebugMessageQueue*>(pUserData)->Push(messageSeverity, *pCallbackData);
+			else if (VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT & messageSeverity) log::error("\n[Vulkan]: {}", pCallbackData->pMessage);
+			else if (VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT & messageSeverity) log::warn("\n[Vulkan]: {}", pCallbackData->pMessage);
 
 			return VK_FALSE; // Always return false
 		}
@@ -0,0 +1,293 @@
+#include "vulkan_culling.h"
+#include "vulkan_indirect.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr uint32_t SIMD_WIDTH = 8; // Padding of the sphere arrays (Multiple of every kernel width)
+		constexpr float CULLED_RADIUS = -std::numeric_limits<float>::max(); // Fails every plane
+		constexpr uint32_t INVALID_INDEX = ~0u;
+
+		size_t get_padded_count(size_t count) { return (count + SIMD_WIDTH - 1) & ~size_t(SIMD_WIDTH - 1); }
+
+		// Round to nearest even, overflow to infinity (Scalar fallback of F16C & NEON)
+		[[maybe_unused]] uint16_t to_half(float value)
+		{
+			const uint32_t bits = std::bit_cast<uint32_t>(value);
+			const uint32_t sign = (bits >> 16) & 0x8000;
+			const uint32_t magnitude = bits & 0x7FFFFFFF;
+			if (magnitude >= 0x7F800000) return static_cast<uint16_t>(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0)); // Infinity & NaN
+			if (magnitude >= 0x477FF000) return static_cast<uint16_t>(sign | 0x7C00); // Rounds beyond 65504
+			if (magnitude < 0x38800000) // Subnormal
+			{
+				if (magnitude < 0x33000000) return static_cast<uint16_t>(sign);
+				const uint32_t shift = 126 - (magnitude >> 23);
+				const uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+				uint32_t half = mantissa >> shift;
+				const uint32_t remainder = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+				if (remainder > halfway || (remainder == halfway && (half & 1))) ++half;
+				return static_cast<uint16_t>(sign | half);
+			}
+			uint32_t half = (magnitude - 0x38000000) >> 13; // Rebias the exponent from 127 to 15
+			const uint32_t remainder = magnitude & 0x1FFF;
+			if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) ++half;
+			return static_cast<uint16_t>(sign | half);
+		}
+	} // namespace
+
+	InstanceCuller::Frustum InstanceCuller::ExtractFrustum(const float(&view_projection)[16])
+	{
+		const auto row = [&](uint32_t index) { return Plane{ view_projection[index], view_projection[4 + index], view_projection[8 + index], view_projection[12 + index] }; };
+		const auto add = [](const Plane& a, const Plane& b) { return Plane{ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; };
+		const auto subtract = [](const Plane& a, const Plane& b) { return Plane{ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; };
+
+		const Plane x = row(0), y = row(1), z = row(2), w = row(3);
+		Frustum frustum{ add(w, x), subtract(w, x), add(w, y), subtract(w, y), z /*Depth >= 0*/, subtract(w, z) };
+		for (auto& plane : frustum)
+		{
+			const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			assert(length > 0.0f && "Degenerate view-projection matrix!");
+			plane = Plane{ plane.x / length, plane.y / length, plane.z / length, plane.w / length };
+		}
+		return frustum;
+	}
+
+	InstanceCuller::InstanceCuller(TransformFormat transform_format/* = TransformFormat::FLOAT_3X4*/) :
+		m_transform_format{ transform_format }
+	{
+
+	}
+
+	uint32_t InstanceCuller::AddMesh(const Mesh& mesh)
+	{
+		assert(mesh.index_count > 0 && "Invalid mesh!");
+		m_meshes.emplace_back(mesh);
+		return static_cast<uint32_t>(m_meshes.size() - 1);
+	}
+
+	InstanceCuller::Handle InstanceCuller::Add(uint32_t mesh, const float(&transform)[12], const float(&bounding_sphere)[4])
+	{
+		assert(mesh < m_meshes.size() && "Invalid mesh!");
+		Handle handle;
+		if (!m_free_handles.empty()) { handle = m_free_handles.back(); m_free_handles.pop_back(); }
+		else { handle = static_cast<Handle>(m_index_of.size()); m_index_of.emplace_back(INVALID_INDEX); }
+
+		const auto index = static_cast<uint32_t>(m_mesh_of.size());
+		m_index_of[handle] = index;
+		m_handle_of.emplace_back(handle);
+		m_mesh_of.emplace_back(mesh);
+		m_transforms.emplace_back(std::to_array(transform));
+		m_local_spheres.emplace_back(std::to_array(bounding_sphere));
+
+		const size_t paddedCount = get_padded_count(index + 1);
+		m_center_x.resize(paddedCount, 0.0f);
+		m_center_y.resize(paddedCount, 0.0f);
+		m_center_z.resize(paddedCount, 0.0f);
+		m_radius.resize(paddedCount, CULLED_RADIUS);
+		update_sphere(index);
+		return handle;
+	}
+
+	void InstanceCuller::SetTransform(Handle handle, const float(&transform)[12])
+	{
+		assert(handle < m_index_of.size() && m_index_of[handle] != INVALID_INDEX && "Invalid instance handle!");
+		const uint32_t index = m_index_of[handle];
+		m_transforms[index] = std::to_array(transform);
+		update_sphere(index);
+	}
+
+	void InstanceCuller::Remove(Handle handle)
+	{
+		assert(handle < m_index_of.size() && m_index_of[handle] != INVALID_INDEX && "Invalid instance handle!");
+		const uint32_t index = m_index_of[handle];
+		const uint32_t last = GetInstanceCount() - 1;
+		if (index != last)
+		{
+			m_handle_of[index] = m_handle_of[last];
+			m_mesh_of[index] = m_mesh_of[last];
+			m_transforms[index] = m_transforms[last];
+			m_local_spheres[index] = m_local_spheres[last];
+			m_center_x[index] = m_center_x[last];
+			m_center_y[index] = m_center_y[last];
+			m_center_z[index] = m_center_z[last];
+			m_radius[index] = m_radius[last];
+			m_index_of[m_handle_of[index]] = index;
+		}
+		m_handle_of.pop_back();
+		m_mesh_of.pop_back();
+		m_transforms.pop_back();
+		m_local_spheres.pop_back();
+		m_radius[last] = CULLED_RADIUS; // Padding from now on
+
+		const size_t paddedCount = get_padded_count(last);
+		m_center_x.resize(paddedCount);
+		m_center_y.resize(paddedCount);
+		m_center_z.resize(paddedCount);
+		m_radius.resize(paddedCount);
+
+		m_index_of[handle] = INVALID_INDEX;
+		m_free_handles.emplace_back(handle);
+	}
+
+	InstanceCuller::Statistics InstanceCuller::Cull(const Frustum& frustum, VMA::Buffer& instance_buffer, IndirectDrawBuffer& draws)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::InstanceCuller::Cull");
+		assert(draws.GetCommandType() == IndirectDrawBuffer::CommandType::DRAW_INDEXED && "Instances are drawn by indexed draws!");
+		Statistics statistics{ .visible_instances = cull_spheres(frustum) };
+		const uint32_t stride = GetTransformStride();
+		if (static_cast<VkDeviceSize>(statistics.visible_instances) * stride > instance_buffer.Size())
+			throw std::runtime_error(std::format("Failed to cull the instances - {} visible instances exceed the instance buffer!", statistics.visible_instances));
+
+		// Count the visible instances per mesh, then turn the counts into the first instances of the draws
+		m_mesh_cursors.assign(m_meshes.size(), 0);
+		for (uint32_t visible = 0; visible < statistics.visible_instances; ++visible) ++m_mesh_cursors[m_mesh_of[m_visible[visible]]];
+
+		auto commands = static_cast<VkDrawIndexedIndirectCommand*>(draws.GetArgumentBuffer()->Access());
+		uint32_t firstInstance = 0;
+		for (uint32_t mesh = 0; mesh < m_meshes.size(); ++mesh)
+		{
+			const uint32_t instanceCount = m_mesh_cursors[mesh];
+			m_mesh_cursors[mesh] = firstInstance;
+			if (!instanceCount) continue;
+			if (statistics.draw_count == draws.GetMaxDrawCount())
+				throw std::runtime_error(std::format("Failed to cull the instances - More than {} meshes are visible!", draws.GetMaxDrawCount()));
+			commands[statistics.draw_count++] = VkDrawIndexedIndirectCommand
+			{
+				.indexCount = m_meshes[mesh].index_count,
+				.instanceCount = instanceCount,
+				.firstIndex = m_meshes[mesh].first_index,
+				.vertexOffset = m_meshes[mesh].vertex_offset,
+				.firstInstance = firstInstance
+			};
+			firstInstance += instanceCount;
+		}
+
+		// Scatter the transforms into the ranges of their meshes
+		auto instances = static_cast<std::byte*>(instance_buffer.Access());
+		for (uint32_t visible = 0; visible < statistics.visible_instances; ++visible)
+		{
+			const uint32_t index = m_visible[visible];
+			pack_transform(index, instances + static_cast<size_t>(m_mesh_cursors[m_mesh_of[index]]++) * stride);
+		}
+
+		if (statistics.visible_instances) instance_buffer.Flush(0, static_cast<VkDeviceSize>(statistics.visible_instances) * stride);
+		if (statistics.draw_count) draws.GetArgumentBuffer()->Flush(0, static_cast<VkDeviceSize>(statistics.draw_count) * draws.GetStride());
+		draws.SetDrawCount(statistics.draw_count);
+		return statistics;
+	}
+
+	void InstanceCuller::update_sphere(uint32_t index)
+	{
+		const auto& transform = m_transforms[index];
+		const auto& sphere = m_local_spheres[index];
+		m_center_x[index] = transform[0] * sphere[0] + transform[1] * sphere[1] + transform[2] * sphere[2] + transform[3];
+		m_center_y[index] = transform[4] * sphere[0] + transform[5] * sphere[1] + transform[6] * sphere[2] + transform[7];
+		m_center_z[index] = transform[8] * sphere[0] + transform[9] * sphere[1] + transform[10] * sphere[2] + transform[11];
+
+		// Largest axis scale (Non-uniform scales keep the sphere conservative)
+		float scale = 0.0f;
+		for (uint32_t column = 0; column < 3; ++column)
+			scale = std::max(scale, transform[column] * transform[column] + transform[4 + column] * transform[4 + column] + transform[8 + column] * transform[8 + column]);
+		m_radius[index] = sphere[3] * std::sqrt(scale);
+	}
+
+	uint32_t InstanceCuller::cull_spheres(const Frustum& frustum)
+	{
+		const size_t paddedCount = m_radius.size();
+		m_visible.resize(paddedCount);
+		uint32_t visibleCount = 0;
+		size_t first = 0;
+
+#if defined(__AVX2__)
+		std::array<__m256, 6> planeX, planeY, planeZ, planeW;
+		for (size_t plane = 0; plane < frustum.size(); ++plane)
+		{
+			planeX[plane] = _mm256_set1_ps(frustum[plane].x);
+			planeY[plane] = _mm256_set1_ps(frustum[plane].y);
+			planeZ[plane] = _mm256_set1_ps(frustum[plane].z);
+			planeW[plane] = _mm256_set1_ps(frustum[plane].w);
+		}
+		for (; first + 8 <= paddedCount; first += 8)
+		{
+			const __m256 centerX = _mm256_loadu_ps(&m_center_x[first]);
+			const __m256 centerY = _mm256_loadu_ps(&m_center_y[first]);
+			const __m256 centerZ = _mm256_loadu_ps(&m_center_z[first]);
+			const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&m_radius[first]));
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (size_t plane = 0; plane < frustum.size(); ++plane)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(centerX, planeX[plane]), planeW[plane]);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(centerY, planeY[plane]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(centerZ, planeZ[plane]));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+			}
+			for (auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside)); mask; mask &= mask - 1)
+				m_visible[visibleCount++] = static_cast<uint32_t>(first) + std::countr_zero(mask);
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		static constexpr uint32_t LANE_BITS[4] = { 1, 2, 4, 8 };
+		const uint32x4_t laneBits = vld1q_u32(LANE_BITS);
+		for (; first + 4 <= paddedCount; first += 4)
+		{
+			const float32x4_t centerX = vld1q_f32(&m_center_x[first]);
+			const float32x4_t centerY = vld1q_f32(&m_center_y[first]);
+			const float32x4_t centerZ = vld1q_f32(&m_center_z[first]);
+			const float32x4_t negativeRadius = vnegq_f32(vld1q_f32(&m_radius[first]));
+			uint32x4_t inside = vdupq_n_u32(~0u);
+			for (const auto& plane : frustum)
+			{
+				float32x4_t distance = vfmaq_n_f32(vdupq_n_f32(plane.w), centerX, plane.x);
+				distance = vfmaq_n_f32(distance, centerY, plane.y);
+				distance = vfmaq_n_f32(distance, centerZ, plane.z);
+				inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+			}
+			for (uint32_t mask = vaddvq_u32(vandq_u32(inside, laneBits)); mask; mask &= mask - 1)
+				m_visible[visibleCount++] = static_cast<uint32_t>(first) + std::countr_zero(mask);
+		}
+#endif
+		for (; first < paddedCount; ++first)
+		{
+			bool isInside = true;
+			for (const auto& plane : frustum)
+				isInside &= plane.x * m_center_x[first] + plane.y * m_center_y[first] + plane.z * m_center_z[first] + plane.w >= -m_radius[first];
+			if (isInside) m_visible[visibleCount++] = static_cast<uint32_t>(first);
+		}
+		return visibleCount;
+	}
+
+	void InstanceCuller::pack_transform(uint32_t index, std::byte* destination) const
+	{
+		const float* transform = m_transforms[index].data();
+		if (m_transform_format == TransformFormat::FLOAT_3X4)
+		{
+			std::memcpy(destination, transform, 12 * sizeof(float));
+			return;
+		}
+#if defined(__AVX2__) && defined(__F16C__)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm256_cvtps_ph(_mm256_loadu_ps(transform), _MM_FROUND_TO_NEAREST_INT));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + 16), _mm_cvtps_ph(_mm_loadu_ps(transform + 8), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		auto halfs = reinterpret_cast<uint16_t*>(destination);
+		for (uint32_t row = 0; row < 3; ++row)
+			vst1_u16(halfs + 4 * row, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(transform + 4 * row))));
+#else
+		uint16_t halfs[12];
+		for (uint32_t element = 0; element < 12; ++element) halfs[element] = to_half(transform[element]);
+		std::memcpy(destination, halfs, sizeof(halfs));
+#endif
+	}
+
+}} // namespace Albedo::RHI
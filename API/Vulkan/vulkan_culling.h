@@ -0,0 +1,87 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <array>
+
+namespace Albedo {
+namespace RHI
+{
+	class IndirectDrawBuffer;
+
+	// CPU Instance Culling: World-space bounding spheres are kept in SoA arrays and tested against the frustum 8 (AVX2) or 4 (NEON)
+	// at a time (Scalar elsewhere, see ALBEDO_RHI_AVX2). Cull() groups the visible instances by mesh and packs their transforms straight
+	// into a persistently mapped instance buffer, along with one DRAW_INDEXED command per mesh into a host-writable IndirectDrawBuffer,
+	// so the frame records a single DrawCommand(). Bridges the CPU path until the culling compute shader (IndirectDrawBuffer::CullCommand()).
+	// Not thread-safe.
+	class InstanceCuller
+	{
+	public:
+		using Handle = uint32_t;
+		struct Plane { float x, y, z, w; }; // Inside: dot(xyz, point) + w >= 0 (Normalized)
+		using Frustum = std::array<Plane, 6>; // Left, right, bottom, top, near, far
+		// Column-major view-projection (e.g. GLM) into Vulkan clip space (Depth [0, 1])
+		static Frustum ExtractFrustum(const float(&view_projection)[16]);
+
+		enum class TransformFormat
+		{
+			FLOAT_3X4,	// Row-major 3x4 floats, 48 bytes (Same as VkTransformMatrixKHR)
+			HALF_3X4	// Row-major 3x4 halfs, 24 bytes (11-bit precision: Keep the translations camera-relative)
+		};
+		struct Mesh
+		{
+			uint32_t index_count;
+			uint32_t first_index = 0;
+			int32_t vertex_offset = 0; // See GeometryArena::Mesh::GetVertexOffset()
+		};
+		uint32_t AddMesh(const Mesh& mesh); // Draw of the mesh's visible instances
+
+		// transform: Row-major 3x4 (Object to world), bounding_sphere: Object-space center xyz & radius
+		Handle Add(uint32_t mesh, const float(&transform)[12], const float(&bounding_sphere)[4]);
+		void SetTransform(Handle handle, const float(&transform)[12]);
+		void Remove(Handle handle);
+
+		struct Statistics
+		{
+			uint32_t visible_instances = 0;
+			uint32_t draw_count = 0;
+		};
+		// The visible instances of a mesh are consecutive in instance_buffer (GetTransformStride() bytes each) from the firstInstance of
+		// its draw, so shaders read their transform at gl_InstanceIndex. Both buffers are flushed, and must not be in use by the GPU
+		// (e.g. One set per frame in flight). Throws if the visible instances or draws exceed the buffers.
+		Statistics Cull(const Frustum& frustum, VMA::Buffer& instance_buffer, IndirectDrawBuffer& draws);
+
+		uint32_t GetInstanceCount() const { return static_cast<uint32_t>(m_mesh_of.size()); }
+		uint32_t GetMeshCount() const { return static_cast<uint32_t>(m_meshes.size()); }
+		uint32_t GetTransformStride() const { return m_transform_format == TransformFormat::FLOAT_3X4 ? 48 : 24; }
+		TransformFormat GetTransformFormat() const { return m_transform_format; }
+
+	public:
+		InstanceCuller(TransformFormat transform_format = TransformFormat::FLOAT_3X4);
+		InstanceCuller(const InstanceCuller&) = delete;
+
+	private:
+		void update_sphere(uint32_t index);
+		uint32_t cull_spheres(const Frustum& frustum); // Visible indices into m_visible
+		void pack_transform(uint32_t index, std::byte* destination) const;
+
+	private:
+		const TransformFormat m_transform_format;
+		std::vector<Mesh> m_meshes;
+
+		// SoA by dense index (Swapped with the last on Remove()), world spheres are padded to the SIMD width with culled ones
+		std::vector<float> m_center_x, m_center_y, m_center_z, m_radius;
+		std::vector<std::array<float, 12>> m_transforms;
+		std::vector<std::array<float, 4>> m_local_spheres;
+		std::vector<uint32_t> m_mesh_of;
+		std::vector<Handle> m_handle_of;
+
+		std::vector<uint32_t> m_index_of; // By handle
+		std::vector<Handle> m_free_handles;
+
+		// Kept across Cull() calls
+		std::vector<uint32_t> m_visible;
+		std::vector<uint32_t> m_mesh_cursors;
+	};
+
+}} // namespace Albedo::RHI
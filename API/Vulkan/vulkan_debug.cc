@@ -0,0 +1,152 @@
+#include "vulkan_debug.h"
+
+#include <AlbedoLog.hpp>
+
+#include <string_view>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+namespace Albedo {
+namespace RHI
+{
+	void DebugUtils::Load(VkInstance instance)
+	{
+		if constexpr (!EnableDebugMarkers) return;
+
+		s_set_object_name	= (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT");
+		s_begin_label			= (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT");
+		s_end_label				= (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT");
+		s_insert_label			= (PFN_vkCmdInsertDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdInsertDebugUtilsLabelEXT");
+	}
+
+	DebugMessageQueue::DebugMessageQueue(uint32_t ring_capacity/* = 256*/, uint32_t rate_limit/* = 10*/) :
+		m_rate_limit{ rate_limit },
+		m_ring_capacity{ ring_capacity },
+		m_ring{ std::make_unique<Message[]>(ring_capacity) }
+	{
+		assert(ring_capacity > 0 && rate_limit > 0 && "Invalid debug message queue!");
+		for (uint32_t position = 0; position < ring_capacity; ++position)
+			m_ring[position].sequence.store(position, std::memory_order_relaxed);
+		m_thread = std::thread(&DebugMessageQueue::log_loop, this);
+	}
+
+	DebugMessageQueue::~DebugMessageQueue()
+	{
+		m_stop = true;
+		++m_doorbell;
+		m_doorbell.notify_one();
+		m_thread.join(); // Drains the ring first
+	}
+
+	void DebugMessageQueue::Push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, const VkDebugUtilsMessengerCallbackDataEXT& callback_data)
+	{
+		Severity messageSeverity = VERBOSE;
+		if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) messageSeverity = ERROR;
+		else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) messageSeverity = WARN;
+		else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) messageSeverity = INFO;
+		m_message_counts[messageSeverity].fetch_add(1, std::memory_order_relaxed);
+		if (messageSeverity < WARN) return;
+
+		// Claim a free slot without waiting (The logger thread frees them in order)
+		uint64_t position = m_enqueue_position.load(std::memory_order_relaxed);
+		Message* message = nullptr;
+		while (!message)
+		{
+			auto& slot = m_ring[position % m_ring_capacity];
+			uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+			if (sequence == position)
+			{
+				if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) message = &slot;
+			}
+			else if (sequence < position) { m_dropped_count.fetch_add(1, std::memory_order_relaxed); return; } // Full
+			else position = m_enqueue_position.load(std::memory_order_relaxed);
+		}
+
+		const char* text = callback_data.pMessage ? callback_data.pMessage : "";
+		size_t length = std::strlen(text);
+		message->severity = messageSeverity;
+		message->id = callback_data.messageIdNumber;
+		message->is_truncated = length > MAX_MESSAGE_LENGTH;
+		message->length = static_cast<uint32_t>(std::min(length, MAX_MESSAGE_LENGTH));
+		std::memcpy(message->text.data(), text, message->length);
+		message->sequence.store(position + 1, std::memory_order_release);
+		++m_doorbell;
+		m_doorbell.notify_one();
+	}
+
+	void DebugMessageQueue::Flush()
+	{
+		uint64_t target = m_enqueue_position.load(std::memory_order_acquire);
+		for (uint64_t logged = m_logged_position.load(std::memory_order_acquire); logged < target;
+			logged = m_logged_position.load(std::memory_order_acquire))
+			m_logged_position.wait(logged, std::memory_order_acquire);
+	}
+
+	DebugMessageQueue::Statistics DebugMessageQueue::GetStatistics() const
+	{
+		Statistics statistics
+		{
+			.suppressed = m_suppressed_count.load(std::memory_order_relaxed),
+			.dropped = m_dropped_count.load(std::memory_order_relaxed)
+		};
+		for (uint32_t severity = 0; severity < MAX_SEVERITY; ++severity)
+			statistics.messages[severity] = m_message_counts[severity].load(std::memory_order_relaxed);
+		return statistics;
+	}
+
+	void DebugMessageQueue::log_loop()
+	{
+		uint64_t position = 0;
+		while (true)
+		{
+			uint64_t doorbell = m_doorbell.load(std::memory_order_acquire);
+			auto& message = m_ring[position % m_ring_capacity];
+			if (message.sequence.load(std::memory_order_acquire) != position + 1)
+			{
+				if (m_stop && position == m_enqueue_position.load(std::memory_order_acquire)) break;
+				m_doorbell.wait(doorbell, std::memory_order_acquire);
+				continue;
+			}
+
+			log_message(message);
+			message.sequence.store(position + m_ring_capacity, std::memory_order_release);
+			m_logged_position.store(++position, std::memory_order_release);
+			m_logged_position.notify_all();
+		}
+
+		for (const auto& [id, rateLimit] : m_rate_limits)
+			if (rateLimit.suppressed) log::warn("[Vulkan]: Suppressed {} repeats of message {:#x}", rateLimit.suppressed, static_cast<uint32_t>(id));
+	}
+
+	void DebugMessageQueue::log_message(const Message& message)
+	{
+		auto now = std::chrono::steady_clock::now();
+		auto& rateLimit = m_rate_limits[message.id];
+		if (now - rateLimit.window_begin >= std::chrono::seconds(1))
+		{
+			rateLimit.window_begin = now;
+			rateLimit.logged = 0;
+		}
+		if (rateLimit.logged == m_rate_limit)
+		{
+			++rateLimit.suppressed;
+			m_suppressed_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		++rateLimit.logged;
+
+		std::string_view text{ message.text.data(), message.length };
+		const char* truncated = message.is_truncated ? "..." : "";
+		if (rateLimit.suppressed)
+		{
+			auto suppressed = std::exchange(rateLimit.suppressed, 0);
+			if (message.severity == ERROR) log::error("\n[Vulkan]: {}{} (Suppressed {} repeats)", text, truncated, suppressed);
+			else log::warn("\n[Vulkan]: {}{} (Suppressed {} repeats)", text, truncated, suppressed);
+		}
+		else if (message.severity == ERROR) log::error("\n[Vulkan]: {}{}", text, truncated);
+		else log::warn("\n[Vulkan]: {}{}", text, truncated);
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <array>
+
+// Debug Markers (Labels & object names for RenderDoc / Nsight, compiled out when disabled)
+// Define ALBEDO_RHI_DEBUG_MARKERS=1 to keep them in release builds
+#ifndef ALBEDO_RHI_DEBUG_MARKERS
+#ifdef NDEBUG
+#define ALBEDO_RHI_DEBUG_MARKERS 0
+#else
+#define ALBEDO_RHI_DEBUG_MARKERS 1
+#endif
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	constexpr const bool EnableDebugMarkers = ALBEDO_RHI_DEBUG_MARKERS;
+
+	// VK_EXT_debug_utils entry points (Loaded by VulkanContext, null if the extension is not available)
+	class DebugUtils
+	{
+	public:
+		using Color = std::array<float, 4>;
+
+		template<typename VulkanHandle>
+		static void SetObjectName(VkDevice device, VkObjectType type, VulkanHandle handle, const char* name)
+		{
+			if constexpr (EnableDebugMarkers)
+			{
+				if (!s_set_object_name) return;
+				VkDebugUtilsObjectNameInfoEXT objectNameInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+					.objectType = type,
+					.objectHandle = (uint64_t)handle, // Dispatchable or not
+					.pObjectName = name
+				};
+				s_set_object_name(device, &objectNameInfo);
+			}
+		}
+
+		static void BeginLabel(VkCommandBuffer command_buffer, const char* name, const Color& color)
+		{
+			if constexpr (EnableDebugMarkers)
+			{
+				if (!s_begin_label) return;
+				auto label = make_label(name, color);
+				s_begin_label(command_buffer, &label);
+			}
+		}
+
+		static void EndLabel(VkCommandBuffer command_buffer)
+		{
+			if constexpr (EnableDebugMarkers) { if (s_end_label) s_end_label(command_buffer); }
+		}
+
+		static void InsertLabel(VkCommandBuffer command_buffer, const char* name, const Color& color)
+		{
+			if constexpr (EnableDebugMarkers)
+			{
+				if (!s_insert_label) return;
+				auto label = make_label(name, color);
+				s_insert_label(command_buffer, &label);
+			}
+		}
+
+		static bool IsEnabled() { return EnableDebugMarkers && s_set_object_name != nullptr; }
+		static void Load(VkInstance instance); // The instance must enable VK_EXT_debug_utils
+
+	private:
+		static VkDebugUtilsLabelEXT make_label(const char* name, const Color& color)
+		{
+			return VkDebugUtilsLabelEXT
+			{
+				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+				.pLabelName = name,
+				.color = { color[0], color[1], color[2], color[3] }
+			};
+		}
+
+	private:
+		static inline PFN_vkSetDebugUtilsObjectNameEXT		s_set_object_name	= nullptr;
+		static inline PFN_vkCmdBeginDebugUtilsLabelEXT		s_begin_label			= nullptr;
+		static inline PFN_vkCmdEndDebugUtilsLabelEXT			s_end_label				= nullptr;
+		static inline PFN_vkCmdInsertDebugUtilsLabelEXT		s_insert_label			= nullptr;
+	};
+
+	// Debug Message Queue (Validation): The messenger callback only counts a message and copies it into a bounded lock-free ring,
+	// the logger thread formats and logs it. Each message ID (messageIdNumber) is logged at most rate_limit times per second,
+	// the repeats in between are suppressed and reported with its next logged message. A full ring drops the message (Counted).
+	class DebugMessageQueue
+	{
+	public:
+		enum Severity { VERBOSE, INFO, WARN, ERROR, MAX_SEVERITY };
+		struct Statistics
+		{
+			std::array<uint64_t, MAX_SEVERITY> messages{};
+			uint64_t suppressed = 0;	// Rate limited repeats
+			uint64_t dropped = 0;		// Full ring
+		};
+
+		// Any thread (e.g. The driver thread of the callback), never blocks. INFO & VERBOSE messages are only counted.
+		void Push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, const VkDebugUtilsMessengerCallbackDataEXT& callback_data);
+		void Flush(); // Wait until every pushed message was logged (e.g. Before a crash report)
+		Statistics GetStatistics() const;
+
+	public:
+		DebugMessageQueue() = delete;
+		DebugMessageQueue(uint32_t ring_capacity = 256, uint32_t rate_limit = 10);
+		~DebugMessageQueue(); // Drains the ring
+		DebugMessageQueue(const DebugMessageQueue&) = delete;
+
+	private:
+		static constexpr size_t MAX_MESSAGE_LENGTH = 2048; // Longer messages are truncated
+		// Bounded MPSC ring (Vyukov: == position: Free, == position + 1: Ready)
+		struct Message
+		{
+			std::atomic<uint64_t> sequence{ 0 };
+			Severity severity = ERROR;
+			int32_t id = 0;
+			uint32_t length = 0;
+			bool is_truncated = false;
+			std::array<char, MAX_MESSAGE_LENGTH> text;
+		};
+		// Logger thread only
+		struct RateLimit
+		{
+			std::chrono::steady_clock::time_point window_begin;
+			uint32_t logged = 0;			// In the current window
+			uint64_t suppressed = 0;	// Since the last logged message
+		};
+		void log_loop();
+		void log_message(const Message& message);
+
+	private:
+		const uint32_t m_rate_limit;
+		const uint32_t m_ring_capacity;
+		std::unique_ptr<Message[]> m_ring;
+		std::atomic<uint64_t> m_enqueue_position{ 0 };
+		std::atomic<uint64_t> m_logged_position{ 0 };
+		std::atomic<uint64_t> m_doorbell{ 0 }; // Wakes the logger thread
+		std::atomic<bool> m_stop{ false };
+		std::array<std::atomic<uint64_t>, MAX_SEVERITY> m_message_counts{};
+		std::atomic<uint64_t> m_suppressed_count{ 0 };
+		std::atomic<uint64_t> m_dropped_count{ 0 };
+		std::unordered_map<int32_t, RateLimit> m_rate_limits;
+		std::thread m_thread;
+	};
+
+}} // namespace Albedo::RHI
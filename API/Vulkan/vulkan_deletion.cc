@@ -0,0 +1,89 @@
+#include "vulkan_deletion.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	DeletionQueue::DeletionQueue(VulkanContext* vulkan_context) :
+		m_context{ vulkan_context }
+	{
+
+	}
+
+	DeletionQueue::~DeletionQueue()
+	{
+		vkDeviceWaitIdle(m_context->m_device);
+		Flush();
+	}
+
+	void DeletionQueue::Enqueue(Deleter deleter)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_pending_deleters.emplace_back(std::move(deleter));
+	}
+
+	void DeletionQueue::Collect()
+	{
+		std::vector<Deleter> completedDeleters;
+		{
+			std::scoped_lock guard{ m_mutex };
+			if (!m_pending_deleters.empty())
+			{
+				Retirement retirement{ .deleters = std::move(m_pending_deleters) };
+				{
+					std::scoped_lock timelineGuard{ m_context->m_global_queue_timelines_mutex };
+					retirement.ticks.reserve(m_context->m_global_queue_timelines.size());
+					for (auto& [key, queue_timeline] : m_context->m_global_queue_timelines)
+						retirement.ticks.emplace_back(queue_timeline.get(), queue_timeline->GetSubmittedTick());
+				}
+				m_retirements.emplace_back(std::move(retirement));
+				m_pending_deleters.clear();
+			}
+
+			while (!m_retirements.empty() && is_complete(m_retirements.front()))
+			{
+				auto& deleters = m_retirements.front().deleters;
+				completedDeleters.insert(completedDeleters.end(),
+					std::make_move_iterator(deleters.begin()), std::make_move_iterator(deleters.end()));
+				m_retirements.pop_front();
+			}
+		}
+		// Out of the lock, deleters may enqueue again (e.g. a buffer owning other resources)
+		for (auto& deleter : completedDeleters) deleter();
+	}
+
+	void DeletionQueue::Flush()
+	{
+		while (true)
+		{
+			std::vector<Deleter> deleters;
+			{
+				std::scoped_lock guard{ m_mutex };
+				for (auto& retirement : m_retirements)
+					deleters.insert(deleters.end(),
+						std::make_move_iterator(retirement.deleters.begin()), std::make_move_iterator(retirement.deleters.end()));
+				m_retirements.clear();
+				deleters.insert(deleters.end(),
+					std::make_move_iterator(m_pending_deleters.begin()), std::make_move_iterator(m_pending_deleters.end()));
+				m_pending_deleters.clear();
+			}
+			if (deleters.empty()) break;
+			for (auto& deleter : deleters) deleter();
+		}
+	}
+
+	size_t DeletionQueue::GetPendingCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		size_t count = m_pending_deleters.size();
+		for (const auto& retirement : m_retirements) count += retirement.deleters.size();
+		return count;
+	}
+
+	bool DeletionQueue::is_complete(const Retirement& retirement)
+	{
+		return std::all_of(retirement.ticks.begin(), retirement.ticks.end(),
+			[](const auto& tick) { return tick.first->IsComplete(tick.second); });
+	}
+
+}} // namespace Albedo::RHI
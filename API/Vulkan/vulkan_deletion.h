@@ -0,0 +1,47 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <deque>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class QueueTimeline;
+
+	// Defer destructions until every queue has passed the work submitted before them (Queue Timeline ticks)
+	class DeletionQueue
+	{
+	public:
+		using Deleter = std::function<void()>;
+		void Enqueue(Deleter deleter); // Thread-safe
+
+		// Seal the pending deletions with the current ticks and run all completed ones (Once per frame, after its command buffers were submitted)
+		void Collect();
+		void Flush(); // Run all deletions, the device must be idle
+
+		size_t GetPendingCount();
+
+	public:
+		DeletionQueue() = delete;
+		DeletionQueue(VulkanContext* vulkan_context);
+		~DeletionQueue(); // Wait device idle and flush
+		DeletionQueue(const DeletionQueue&) = delete;
+
+	private:
+		struct Retirement
+		{
+			std::vector<std::pair<QueueTimeline*, uint64_t>> ticks; // Timelines are owned by the context
+			std::vector<Deleter> deleters;
+		};
+		bool is_complete(const Retirement& retirement);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		std::mutex m_mutex;
+		std::vector<Deleter> m_pending_deleters;
+		std::deque<Retirement> m_retirements; // In submission order
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,236 @@
+#include "vulkan_descriptor_buffer.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		VkDeviceSize align_up(VkDeviceSize size, VkDeviceSize alignment)
+		{
+			return (size + alignment - 1) / alignment * alignment;
+		}
+
+		// Immutable samplers are part of the layout, but descriptor buffers still need them in the written descriptors
+		VkSampler find_immutable_sampler(const DescriptorSetLayout& descriptor_set_layout, uint32_t binding, uint32_t array_element)
+		{
+			const auto& bindings = descriptor_set_layout.GetBindings();
+			auto target = std::lower_bound(bindings.begin(), bindings.end(), binding,
+				[](const VkDescriptorSetLayoutBinding& layout_binding, uint32_t binding) { return layout_binding.binding < binding; });
+			assert(target != bindings.end() && target->binding == binding && "Binding is not in this Descriptor Set Layout!");
+			if (target->pImmutableSamplers == nullptr) return VK_NULL_HANDLE;
+			assert(array_element < target->descriptorCount && "Array element is out of range!");
+			return target->pImmutableSamplers[array_element];
+		}
+	} // namespace
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, VkDeviceAddress address, VkDeviceSize range, uint32_t array_element/* = 0*/)
+	{
+		assert((buffer_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || buffer_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) && "Not a buffer descriptor!");
+		VkDescriptorAddressInfoEXT addressInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+			.address = address,
+			.range = range,
+			.format = VK_FORMAT_UNDEFINED
+		};
+		VkDescriptorGetInfoEXT descriptorGetInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT, .type = buffer_type };
+		if (buffer_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) descriptorGetInfo.data.pUniformBuffer = &addressInfo;
+		else descriptorGetInfo.data.pStorageBuffer = &addressInfo;
+		write_descriptor(buffer_type, buffer_binding, array_element, descriptorGetInfo);
+		return *this;
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data)
+	{
+		return WriteBuffer(buffer_type, buffer_binding, data->DeviceAddress(), data->Size());
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice)
+	{
+		return WriteBuffer(buffer_type, buffer_binding, slice.GetDeviceAddress(), slice.GetSize());
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, BufferHandle buffer)
+	{
+		const auto& registry = m_parent->m_context->GetResourceRegistry();
+		return WriteBuffer(buffer_type, buffer_binding, registry.GetDeviceAddress(buffer), registry.GetSize(buffer));
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteImage(VkDescriptorType image_type, uint32_t image_binding,
+		VkImageView image_view, VkImageLayout image_layout, VkSampler sampler/* = VK_NULL_HANDLE*/, uint32_t array_element/* = 0*/)
+	{
+		if (image_type == VK_DESCRIPTOR_TYPE_SAMPLER || image_type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+		{
+			if (auto immutableSampler = find_immutable_sampler(*m_layout, image_binding, array_element))
+				sampler = immutableSampler;
+			assert(sampler != VK_NULL_HANDLE && "Cannot write the sampler descriptor without a sampler!");
+		}
+		VkDescriptorImageInfo imageInfo
+		{
+			.sampler = sampler,
+			.imageView = image_view,
+			.imageLayout = image_layout
+		};
+		VkDescriptorGetInfoEXT descriptorGetInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT, .type = image_type };
+		switch (image_type)
+		{
+		case VK_DESCRIPTOR_TYPE_SAMPLER:
+			descriptorGetInfo.data.pSampler = &imageInfo.sampler; break;
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			descriptorGetInfo.data.pCombinedImageSampler = &imageInfo; break;
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			descriptorGetInfo.data.pSampledImage = &imageInfo; break;
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			descriptorGetInfo.data.pStorageImage = &imageInfo; break;
+		case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			descriptorGetInfo.data.pInputAttachmentImage = &imageInfo; break;
+		default: assert(false && "Not an image descriptor!");
+		}
+		write_descriptor(image_type, image_binding, array_element, descriptorGetInfo);
+		return *this;
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data)
+	{
+		const bool needsSampler = image_type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+			find_immutable_sampler(*m_layout, image_binding, 0) == VK_NULL_HANDLE;
+		return WriteImage(image_type, image_binding, data->GetSampledImageView(), data->GetImageLayout(),
+			needsSampler ? data->GetImageSampler() : VK_NULL_HANDLE); // Asserts a bound sampler
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteImage(VkDescriptorType image_type, uint32_t image_binding, ImageHandle image)
+	{
+		auto& data = m_parent->m_context->GetResourceRegistry().Resolve(image);
+		const bool needsSampler = image_type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+			find_immutable_sampler(*m_layout, image_binding, 0) == VK_NULL_HANDLE;
+		return WriteImage(image_type, image_binding, data.GetSampledImageView(), data.GetImageLayout(),
+			needsSampler ? data.GetImageSampler() : VK_NULL_HANDLE);
+	}
+
+	DescriptorBufferSet& DescriptorBufferSet::
+		WriteTexelBuffer(VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding,
+		VkDeviceAddress address, VkDeviceSize range, VkFormat format, uint32_t array_element/* = 0*/)
+	{
+		assert((texel_buffer_type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || texel_buffer_type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER) &&
+			"Not a texel buffer descriptor!");
+		VkDescriptorAddressInfoEXT addressInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+			.address = address,
+			.range = range,
+			.format = format
+		};
+		VkDescriptorGetInfoEXT descriptorGetInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT, .type = texel_buffer_type };
+		if (texel_buffer_type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) descriptorGetInfo.data.pUniformTexelBuffer = &addressInfo;
+		else descriptorGetInfo.data.pStorageTexelBuffer = &addressInfo;
+		write_descriptor(texel_buffer_type, texel_buffer_binding, array_element, descriptorGetInfo);
+		return *this;
+	}
+
+	void DescriptorBufferSet::
+		write_descriptor(VkDescriptorType type, uint32_t binding, uint32_t array_element, const VkDescriptorGetInfoEXT& descriptor_info)
+	{
+		assert(IsValid() && "Allocate the set from a Descriptor Buffer first!");
+		const size_t descriptorSize = m_parent->get_descriptor_size(type);
+		auto target = m_data + m_layout->GetDescriptorBufferOffset(binding) + array_element * descriptorSize;
+		auto& context = *m_parent->m_context;
+		context.m_get_descriptor(context.m_device, &descriptor_info, descriptorSize, target);
+	}
+
+	DescriptorBuffer::DescriptorBuffer(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight, VkDeviceSize capacity_per_frame) :
+		m_context{ std::move(vulkan_context) },
+		m_usage{ VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT },
+		m_frame_count{ frames_in_flight }
+	{
+		assert(frames_in_flight > 0 && capacity_per_frame > 0);
+		if (!m_context->IsDescriptorBufferSupported())
+			throw std::runtime_error("Failed to create the Descriptor Buffer - VK_EXT_descriptor_buffer is not supported by this device!");
+
+		const auto& properties = m_context->m_physical_device_descriptor_buffer_properties;
+		m_alignment = properties.descriptorBufferOffsetAlignment;
+		m_frame_capacity = align_up(capacity_per_frame, m_alignment);
+		const VkDeviceSize bufferSize = m_frame_capacity * m_frame_count;
+		// Sampler descriptors share the buffer, so it is limited by both ranges
+		const VkDeviceSize maxBufferSize = std::min({ properties.maxResourceDescriptorBufferRange, properties.maxSamplerDescriptorBufferRange,
+			properties.samplerDescriptorBufferAddressSpaceSize });
+		if (bufferSize > maxBufferSize)
+			throw std::runtime_error(std::format("Failed to create the Descriptor Buffer - {} bytes exceed the descriptor buffer range ({} bytes)!", bufferSize, maxBufferSize));
+
+		m_buffer = m_context->m_memory_allocator->AllocateBuffer(bufferSize, m_usage,
+			true, true, false, true); // Host writable (Persistently mapped)
+		m_buffer->SetDebugName("Descriptor Buffer");
+		m_mapped = static_cast<std::byte*>(m_buffer->Access());
+		m_device_address = m_buffer->DeviceAddress();
+	}
+
+	void DescriptorBuffer::BeginFrame(uint32_t frame_index)
+	{
+		assert(frame_index < m_frame_count && "Frame index is out of range!");
+		m_frame_index = frame_index;
+		m_frame_usage.store(0, std::memory_order_relaxed);
+	}
+
+	DescriptorBufferSet DescriptorBuffer::Allocate(const DescriptorSetLayout& descriptor_set_layout)
+	{
+		assert(descriptor_set_layout.IsDescriptorBuffer() && "The layout was not created for descriptor buffers (use_descriptor_buffers())!");
+		const VkDeviceSize size = align_up(descriptor_set_layout.GetDescriptorBufferSize(), m_alignment);
+		const VkDeviceSize offset = m_frame_usage.fetch_add(size, std::memory_order_relaxed);
+		if (offset + size > m_frame_capacity)
+			throw std::runtime_error(std::format("Failed to allocate the descriptor buffer set - the frame capacity ({} bytes) is exhausted!", m_frame_capacity));
+
+		DescriptorBufferSet descriptorSet;
+		descriptorSet.m_parent = this;
+		descriptorSet.m_layout = &descriptor_set_layout;
+		descriptorSet.m_offset = m_frame_index * m_frame_capacity + offset;
+		descriptorSet.m_data = m_mapped + descriptorSet.m_offset;
+		return descriptorSet;
+	}
+
+	void DescriptorBuffer::Flush()
+	{
+		m_buffer->Flush(m_frame_index * m_frame_capacity, std::min(GetFrameUsage(), m_frame_capacity));
+	}
+
+	void DescriptorBuffer::Bind(CommandBuffer& command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout pipeline_layout,
+		uint32_t first_set, const std::vector<DescriptorBufferSet>& descriptor_sets)
+	{
+		std::vector<VkDeviceSize> offsets;
+		offsets.reserve(descriptor_sets.size());
+		for (const auto& descriptor_set : descriptor_sets)
+		{
+			assert(descriptor_set.m_parent == this && "The set was allocated from another Descriptor Buffer!");
+			offsets.emplace_back(descriptor_set.GetOffset());
+		}
+		command_buffer.BindDescriptorBuffer(m_device_address, m_usage);
+		command_buffer.SetDescriptorBufferOffsets(bind_point, pipeline_layout, first_set, offsets);
+	}
+
+	size_t DescriptorBuffer::get_descriptor_size(VkDescriptorType descriptor_type) const
+	{
+		const auto& properties = m_context->m_physical_device_descriptor_buffer_properties;
+		const bool isRobust = m_context->m_physical_device_features.robustBufferAccess;
+		switch (descriptor_type)
+		{
+		case VK_DESCRIPTOR_TYPE_SAMPLER:								return properties.samplerDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:		return properties.combinedImageSamplerDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:					return properties.sampledImageDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:					return properties.storageImageDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:				return properties.inputAttachmentDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:		return isRobust ? properties.robustUniformTexelBufferDescriptorSize : properties.uniformTexelBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:		return isRobust ? properties.robustStorageTexelBufferDescriptorSize : properties.storageTexelBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:					return isRobust ? properties.robustUniformBufferDescriptorSize : properties.uniformBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:					return isRobust ? properties.robustStorageBufferDescriptorSize : properties.storageBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:	return properties.accelerationStructureDescriptorSize;
+		default: throw std::runtime_error(std::format("Failed to get the descriptor size - descriptor type {} is not supported by descriptor buffers!", static_cast<uint32_t>(descriptor_type)));
+		}
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "vulkan_memory.h"
+#include "vulkan_registry.h"
+
+#include <atomic>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class CommandBuffer;
+	class DescriptorSetLayout;
+	class DescriptorBuffer;
+
+	// Descriptor set suballocated from a DescriptorBuffer (Plain handle without ownership, valid until its frame begins again)
+	// Writes are vkGetDescriptorEXT straight into the mapped buffer: no pool, no vkUpdateDescriptorSets and no driver lock,
+	// so worker threads can write their own sets concurrently. Resources are referenced by device addresses and image views.
+	class DescriptorBufferSet
+	{
+		friend class DescriptorBuffer;
+	public:
+		// UNIFORM_BUFFER, STORAGE_BUFFER (The buffer needs VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+		DescriptorBufferSet& WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, VkDeviceAddress address, VkDeviceSize range, uint32_t array_element = 0);
+		DescriptorBufferSet& WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data); // Whole buffer
+		DescriptorBufferSet& WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice);
+		DescriptorBufferSet& WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, BufferHandle buffer);
+		// SAMPLER, COMBINED_IMAGE_SAMPLER, SAMPLED_IMAGE, STORAGE_IMAGE, INPUT_ATTACHMENT (Immutable samplers of the layout are written for you)
+		DescriptorBufferSet& WriteImage(VkDescriptorType image_type, uint32_t image_binding,
+			VkImageView image_view, VkImageLayout image_layout, VkSampler sampler = VK_NULL_HANDLE, uint32_t array_element = 0);
+		DescriptorBufferSet& WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data);
+		DescriptorBufferSet& WriteImage(VkDescriptorType image_type, uint32_t image_binding, ImageHandle image);
+		// UNIFORM_TEXEL_BUFFER, STORAGE_TEXEL_BUFFER
+		DescriptorBufferSet& WriteTexelBuffer(VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding,
+			VkDeviceAddress address, VkDeviceSize range, VkFormat format, uint32_t array_element = 0);
+
+		VkDeviceSize GetOffset() const { return m_offset; } // From the start of the descriptor buffer
+		const DescriptorSetLayout& GetDescriptorSetLayout() const { assert(m_layout); return *m_layout; }
+		bool IsValid() const { return m_layout != nullptr; }
+
+	public:
+		DescriptorBufferSet() = default; // Invalid
+
+	private:
+		void write_descriptor(VkDescriptorType type, uint32_t binding, uint32_t array_element, const VkDescriptorGetInfoEXT& descriptor_info);
+
+	private:
+		DescriptorBuffer* m_parent = nullptr;
+		const DescriptorSetLayout* m_layout = nullptr; // Kept alive by the pipelines
+		std::byte* m_data = nullptr; // Mapped
+		VkDeviceSize m_offset = 0;
+	};
+
+	// Descriptor Buffer (VK_EXT_descriptor_buffer, see VulkanContext::IsDescriptorBufferSupported())
+	// Per-frame rings of descriptor sets in one persistently mapped buffer, bound by offsets instead of allocated sets.
+	// The layouts must be descriptor buffer layouts (GraphicsPipeline::use_descriptor_buffers()).
+	class DescriptorBuffer
+	{
+		friend class DescriptorBufferSet;
+	public:
+		// Call after the fence of this frame signaled, all sets of the last use of this frame become invalid
+		void BeginFrame(uint32_t frame_index);
+		DescriptorBufferSet Allocate(const DescriptorSetLayout& descriptor_set_layout); // Thread-safe (Lock-free bump allocation, throws if the frame is full)
+		void Flush(); // Non-coherent memory: Call after writing the sets of this frame and before submitting (No-op on coherent memory)
+		// vkCmdBindDescriptorBuffersEXT (Filtered per command buffer) + vkCmdSetDescriptorBufferOffsetsEXT
+		void Bind(CommandBuffer& command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout pipeline_layout,
+			uint32_t first_set, const std::vector<DescriptorBufferSet>& descriptor_sets);
+
+		VkDeviceAddress GetDeviceAddress() const { return m_device_address; }
+		VkBufferUsageFlags GetUsage() const { return m_usage; }
+		VkDeviceSize GetFrameCapacity() const { return m_frame_capacity; }
+		VkDeviceSize GetFrameUsage() const { return m_frame_usage.load(std::memory_order_relaxed); } // Bytes allocated since BeginFrame()
+		uint32_t GetFrameIndex() const { return m_frame_index; }
+		uint32_t GetFrameCount() const { return m_frame_count; }
+
+	public:
+		DescriptorBuffer() = delete;
+		DescriptorBuffer(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight, VkDeviceSize capacity_per_frame);
+		DescriptorBuffer(const DescriptorBuffer&) = delete;
+
+	private:
+		size_t get_descriptor_size(VkDescriptorType descriptor_type) const;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::shared_ptr<VMA::Buffer> m_buffer; // Resource & sampler descriptors (Bound once per command buffer)
+		std::byte* m_mapped = nullptr;
+		VkDeviceAddress m_device_address = 0;
+		VkBufferUsageFlags m_usage;
+		VkDeviceSize m_alignment; // descriptorBufferOffsetAlignment
+
+		VkDeviceSize m_frame_capacity; // Aligned
+		uint32_t m_frame_count;
+		uint32_t m_frame_index = 0;
+		std::atomic<VkDeviceSize> m_frame_usage{ 0 };
+	};
+
+}} // namespace Albedo::RHI
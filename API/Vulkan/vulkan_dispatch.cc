@@ -0,0 +1,22 @@
+#include "vulkan_dispatch.h"
+
+#include <stdexcept>
+#include <format>
+
+namespace Albedo {
+namespace RHI
+{
+	void DeviceDispatchTable::Load(VkDevice device)
+	{
+#define ALBEDO_RHI_LOAD_FUNCTION(function) \
+		function = (PFN_##function)vkGetDeviceProcAddr(device, #function); \
+		if (!function) throw std::runtime_error(std::format("Failed to load the device function {}!", #function));
+		ALBEDO_RHI_DEVICE_FUNCTIONS(ALBEDO_RHI_LOAD_FUNCTION)
+#undef ALBEDO_RHI_LOAD_FUNCTION
+
+#define ALBEDO_RHI_LOAD_OPTIONAL_FUNCTION(function) function = (PFN_##function)vkGetDeviceProcAddr(device, #function);
+		ALBEDO_RHI_DEVICE_SWAPCHAIN_FUNCTIONS(ALBEDO_RHI_LOAD_OPTIONAL_FUNCTION)
+#undef ALBEDO_RHI_LOAD_OPTIONAL_FUNCTION
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// Device-level entry points of the hot paths (Recording, submission, presentation & synchronization)
+#define ALBEDO_RHI_DEVICE_FUNCTIONS(X) \
+	X(vkCmdBeginQuery) X(vkCmdBeginRenderPass) X(vkCmdBeginRendering) X(vkCmdBindDescriptorSets) X(vkCmdBindIndexBuffer) \
+	X(vkCmdBindPipeline) X(vkCmdBindVertexBuffers) X(vkCmdBlitImage) X(vkCmdClearColorImage) X(vkCmdCopyBuffer) \
+	X(vkCmdCopyBufferToImage) X(vkCmdCopyImage) X(vkCmdCopyImageToBuffer) X(vkCmdCopyQueryPoolResults) X(vkCmdDispatch) \
+	X(vkCmdDraw) X(vkCmdDrawIndexed) X(vkCmdDrawIndexedIndirect) X(vkCmdDrawIndexedIndirectCount) X(vkCmdDrawIndirect) \
+	X(vkCmdDrawIndirectCount) X(vkCmdEndQuery) X(vkCmdEndRenderPass) X(vkCmdEndRendering) X(vkCmdExecuteCommands) \
+	X(vkCmdFillBuffer) X(vkCmdNextSubpass) X(vkCmdPipelineBarrier) X(vkCmdPipelineBarrier2) X(vkCmdPushConstants) X(vkCmdResetQueryPool) \
+	X(vkCmdSetCullMode) X(vkCmdSetDepthBias) X(vkCmdSetDepthBiasEnable) X(vkCmdSetDepthBoundsTestEnable) X(vkCmdSetDepthCompareOp) \
+	X(vkCmdSetDepthTestEnable) X(vkCmdSetDepthWriteEnable) X(vkCmdSetDeviceMask) X(vkCmdSetEvent) X(vkCmdSetEvent2) \
+	X(vkCmdSetFrontFace) X(vkCmdSetLineWidth) X(vkCmdSetPrimitiveRestartEnable) X(vkCmdSetPrimitiveTopology) \
+	X(vkCmdSetRasterizerDiscardEnable) X(vkCmdSetScissorWithCount) X(vkCmdSetStencilOp) X(vkCmdSetStencilTestEnable) \
+	X(vkCmdSetViewportWithCount) X(vkCmdUpdateBuffer) X(vkCmdWaitEvents) \
+	X(vkCmdWaitEvents2) X(vkCmdWriteTimestamp) \
+	X(vkBeginCommandBuffer) X(vkEndCommandBuffer) X(vkResetCommandBuffer) \
+	X(vkQueueSubmit) X(vkQueueSubmit2) X(vkQueueBindSparse) \
+	X(vkGetSemaphoreCounterValue) X(vkWaitSemaphores) X(vkSignalSemaphore)
+
+// Optional (Null without VK_KHR_swapchain, e.g. Headless contexts)
+#define ALBEDO_RHI_DEVICE_SWAPCHAIN_FUNCTIONS(X) \
+	X(vkAcquireNextImageKHR) X(vkQueuePresentKHR)
+
+namespace Albedo {
+namespace RHI
+{
+	// Device Dispatch Table: Entry points of one VkDevice from vkGetDeviceProcAddr (Loaded by VulkanContext::create_logical_device()).
+	// Calls through it skip the trampoline of the loader's exported vk* symbols, which looks up the device of the handle first.
+	// Every VulkanContext owns the table of its device (Multiple devices never share one), call them as m_context->m_dispatch.vkCmdDraw(...).
+	struct DeviceDispatchTable
+	{
+#define ALBEDO_RHI_DECLARE_FUNCTION(function) PFN_##function function = nullptr;
+		ALBEDO_RHI_DEVICE_FUNCTIONS(ALBEDO_RHI_DECLARE_FUNCTION)
+		ALBEDO_RHI_DEVICE_SWAPCHAIN_FUNCTIONS(ALBEDO_RHI_DECLARE_FUNCTION)
+#undef ALBEDO_RHI_DECLARE_FUNCTION
+
+		void Load(VkDevice device); // Throws if a core entry point is missing
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,193 @@
+#include "vulkan_draw_queue.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr size_t PARALLEL_SORT_THRESHOLD = 8192; // Draws per worker chunk worth a job
+		constexpr uint64_t DEPTH_MAX = (1ull << 24) - 1;
+	} // namespace
+
+	DrawQueue::DrawQueue(std::shared_ptr<VulkanContext> vulkan_context, uint32_t material_set/* = 0*/, Order order/* = Order::STATE*/) :
+		m_context{ std::move(vulkan_context) },
+		m_material_set{ material_set },
+		m_order{ order }
+	{
+
+	}
+
+	void DrawQueue::Add(const Draw& draw, float depth/* = 0.0f*/)
+	{
+		AddKeyed(draw, make_sort_key(draw, depth));
+	}
+
+	void DrawQueue::AddKeyed(const Draw& draw, uint64_t sort_key)
+	{
+		assert(draw.pipeline != VK_NULL_HANDLE && "Every queued draw needs a pipeline!");
+		m_entries.emplace_back(SortEntry{ .key = sort_key, .draw = static_cast<uint32_t>(m_draws.size()) });
+		m_draws.emplace_back(draw);
+		m_is_sorted = false;
+	}
+
+	void DrawQueue::Clear()
+	{
+		m_draws.clear();
+		m_entries.clear();
+		m_pipeline_ids.clear();
+		m_material_ids.clear();
+		m_mesh_ids.clear();
+		m_is_sorted = true;
+	}
+
+	void DrawQueue::Sort()
+	{
+		if (m_is_sorted) return;
+		const size_t count = m_entries.size();
+		m_scratch.resize(count);
+
+		// Chunks are histogrammed and scattered by the workers, the chunk order keeps every pass stable
+		auto& workerPool = m_context->GetWorkerPool();
+		const size_t chunkCount = std::clamp(count / PARALLEL_SORT_THRESHOLD, size_t{ 1 }, std::max(workerPool.GetWorkerCount(), size_t{ 1 }));
+		auto for_each_chunk = [&workerPool, chunkCount](const auto& function)
+		{
+			if (chunkCount == 1) { function(0); return; }
+			std::vector<std::future<void>> futures;
+			futures.reserve(chunkCount);
+			for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+				futures.emplace_back(workerPool.Submit([&function, chunk]() { function(chunk); }));
+			for (auto& future : futures) workerPool.Wait(future);
+		};
+		auto chunk_begin = [count, chunkCount](size_t chunk) { return count * chunk / chunkCount; };
+
+		std::vector<std::array<uint32_t, 256>> histograms(chunkCount);
+		for (uint32_t shift = 0; shift < 64; shift += 8)
+		{
+			for_each_chunk([&](size_t chunk)
+				{
+					auto& histogram = histograms[chunk];
+					histogram.fill(0);
+					for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+						++histogram[(m_entries[i].key >> shift) & 0xFF];
+				});
+
+			// Exclusive prefix over (digit, chunk), a digit shared by all entries is skipped
+			uint32_t offset = 0;
+			bool isUniform = false;
+			for (uint32_t digit = 0; digit < 256 && !isUniform; ++digit)
+			{
+				uint32_t digitCount = 0;
+				for (auto& histogram : histograms) digitCount += histogram[digit];
+				isUniform = digitCount == count;
+				for (auto& histogram : histograms) offset += std::exchange(histogram[digit], offset);
+			}
+			if (isUniform) continue;
+
+			for_each_chunk([&](size_t chunk)
+				{
+					auto& histogram = histograms[chunk];
+					for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+						m_scratch[histogram[(m_entries[i].key >> shift) & 0xFF]++] = m_entries[i];
+				});
+			m_entries.swap(m_scratch);
+		}
+		m_is_sorted = true;
+	}
+
+	void DrawQueue::Record(CommandBuffer& command_buffer)
+	{
+		Record(command_buffer, 0, GetDrawCount());
+	}
+
+	void DrawQueue::Record(CommandBuffer& command_buffer, uint32_t first, uint32_t count)
+	{
+		assert(command_buffer.IsRecording() && "You must Begin() the command buffer before recording the draw queue!");
+		assert(m_is_sorted && "You must Sort() the draw queue before recording it!");
+		assert(static_cast<size_t>(first) + count <= m_entries.size() && "Invalid range of the draw queue!");
+
+		// Last recorded state of this range (Binding helpers build vectors, so unchanged state is skipped before calling them)
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkDescriptorSet material = VK_NULL_HANDLE;
+		std::pair<VkBuffer, VkDeviceSize> vertexBuffer{ VK_NULL_HANDLE, 0 };
+
+		// Consecutive draws with identical state are coalesced into one multi-draw
+		const Draw* batch = nullptr; // First draw of the pending batch
+		InlineVector<VkMultiDrawInfoEXT, 64> draws;
+		InlineVector<VkMultiDrawIndexedInfoEXT, 64> indexedDraws;
+		auto flush_batch = [&]()
+		{
+			if (batch->index_buffer != VK_NULL_HANDLE)
+				command_buffer.DrawMultiIndexed({ indexedDraws.data(), indexedDraws.size() }, batch->instance_count, batch->first_instance);
+			else command_buffer.DrawMulti({ draws.data(), draws.size() }, batch->instance_count, batch->first_instance);
+			draws.clear();
+			indexedDraws.clear();
+			batch = nullptr;
+		};
+
+		for (uint32_t i = first; i < first + count; ++i)
+		{
+			const auto& draw = m_draws[m_entries[i].draw];
+			if (batch && !is_batchable(*batch, draw)) flush_batch();
+			if (!batch)
+			{
+				batch = &draw;
+				if (draw.pipeline != pipeline)
+				{
+					pipeline = draw.pipeline;
+					command_buffer.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				}
+				if (draw.material != VK_NULL_HANDLE && (draw.material != material || draw.pipeline_layout != pipelineLayout))
+				{
+					material = draw.material;
+					pipelineLayout = draw.pipeline_layout;
+					command_buffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, m_material_set, { material });
+				}
+				if (draw.vertex_buffer != VK_NULL_HANDLE && std::pair{ draw.vertex_buffer, draw.vertex_buffer_offset } != vertexBuffer)
+				{
+					vertexBuffer = { draw.vertex_buffer, draw.vertex_buffer_offset };
+					command_buffer.BindVertexBuffers(0, { vertexBuffer.first }, { vertexBuffer.second });
+				}
+				if (draw.index_buffer != VK_NULL_HANDLE)
+					command_buffer.BindIndexBuffer(draw.index_buffer, draw.index_buffer_offset, draw.index_type); // Filtered without allocations
+			}
+
+			if (draw.index_buffer != VK_NULL_HANDLE)
+				indexedDraws.emplace_back(VkMultiDrawIndexedInfoEXT{ .firstIndex = draw.first, .indexCount = draw.count, .vertexOffset = draw.vertex_offset });
+			else draws.emplace_back(VkMultiDrawInfoEXT{ .firstVertex = draw.first, .vertexCount = draw.count });
+		}
+		if (batch) flush_batch();
+	}
+
+	bool DrawQueue::is_batchable(const Draw& batch, const Draw& draw)
+	{
+		return batch.pipeline == draw.pipeline &&
+			batch.pipeline_layout == draw.pipeline_layout &&
+			batch.material == draw.material &&
+			batch.vertex_buffer == draw.vertex_buffer &&
+			batch.vertex_buffer_offset == draw.vertex_buffer_offset &&
+			batch.index_buffer == draw.index_buffer &&
+			(draw.index_buffer == VK_NULL_HANDLE || (batch.index_buffer_offset == draw.index_buffer_offset && batch.index_type == draw.index_type)) &&
+			batch.instance_count == draw.instance_count &&
+			batch.first_instance == draw.first_instance;
+	}
+
+	uint64_t DrawQueue::make_sort_key(const Draw& draw, float depth)
+	{
+		const uint64_t pipelineId = number(m_pipeline_ids, (uint64_t)draw.pipeline) & 0xFFFF;
+		const uint64_t materialId = number(m_material_ids, (uint64_t)draw.material) & 0xFFFF;
+		const uint64_t meshId = number(m_mesh_ids, draw.index_buffer != VK_NULL_HANDLE ? (uint64_t)draw.index_buffer : (uint64_t)draw.vertex_buffer) & 0xFF;
+		const uint64_t depthBits = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * DEPTH_MAX);
+
+		if (m_order == Order::BACK_TO_FRONT)
+			return ((DEPTH_MAX - depthBits) << 40) | (pipelineId << 24) | (materialId << 8) | meshId;
+		return (pipelineId << 48) | (materialId << 32) | (meshId << 24) | depthBits;
+	}
+
+	uint32_t DrawQueue::number(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t handle)
+	{
+		return ids.try_emplace(handle, static_cast<uint32_t>(ids.size())).first->second;
+	}
+
+}} // namespace Albedo::RHI
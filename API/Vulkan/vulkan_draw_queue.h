@@ -0,0 +1,86 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Draw Queue: Draws of a pass are added in any order with a 64-bit sort key, sorted by a parallel LSD radix sort on the worker pool
+	// and recorded in key order, so consecutive draws sharing the pipeline, material set or mesh cost no state change.
+	// Changes are skipped while recording a range, and the CommandBuffer filter drops the rest (e.g. across RecordParallel() ranges).
+	// Consecutive draws with identical state and instances are coalesced into one CommandBuffer::DrawMulti() (VK_EXT_multi_draw),
+	// so per-object data indexed by gl_DrawID keeps batches intact while distinct first instances split them.
+	class DrawQueue
+	{
+	public:
+		struct Draw
+		{
+			VkPipeline pipeline;
+			VkPipelineLayout pipeline_layout;
+			VkDescriptorSet material = VK_NULL_HANDLE; // Bound at the material set of the queue (None: Not bound)
+			VkBuffer vertex_buffer = VK_NULL_HANDLE; // Binding 0 (None: Not bound)
+			VkDeviceSize vertex_buffer_offset = 0;
+			VkBuffer index_buffer = VK_NULL_HANDLE; // None: vkCmdDraw
+			VkDeviceSize index_buffer_offset = 0;
+			VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+			uint32_t count = 0; // Indices or vertices
+			uint32_t instance_count = 1;
+			uint32_t first = 0; // First index or vertex
+			int32_t vertex_offset = 0; // Indexed draws only (See GeometryArena::Mesh::GetVertexOffset())
+			uint32_t first_instance = 0; // Per-batch data (Distinct values split multi-draw batches)
+		};
+
+		enum class Order
+		{
+			STATE,				// Opaque: Pipeline 16 bits | Material 16 bits | Mesh 8 bits | Depth 24 bits (Front to back)
+			BACK_TO_FRONT	// Translucent: Inverted depth 24 bits | Pipeline 16 bits | Material 16 bits | Mesh 8 bits
+		};
+
+		// Not thread-safe (Fill one queue per recording thread). Pipelines, materials and meshes (Vertex or index buffer)
+		// are numbered by their first appearance since Clear(), depth is normalized to [0, 1].
+		void Add(const Draw& draw, float depth = 0.0f);
+		void AddKeyed(const Draw& draw, uint64_t sort_key); // Custom key layout (Ascending)
+		void Sort(); // Call it after the last Add() (Sorted again only if draws were added)
+		void Clear(); // Keep the capacity for the next frame
+
+		// Record the sorted draws [first, first + count) (Inside RenderPass::RecordParallel(): Pass GetDrawCount() and the range)
+		void Record(CommandBuffer& command_buffer);
+		void Record(CommandBuffer& command_buffer, uint32_t first, uint32_t count);
+
+		uint32_t GetDrawCount() const { return static_cast<uint32_t>(m_draws.size()); }
+		uint32_t GetMaterialSet() const { return m_material_set; }
+		Order GetOrder() const { return m_order; }
+
+	public:
+		DrawQueue() = delete;
+		DrawQueue(std::shared_ptr<VulkanContext> vulkan_context, uint32_t material_set = 0, Order order = Order::STATE);
+		DrawQueue(const DrawQueue&) = delete;
+
+	private:
+		uint64_t make_sort_key(const Draw& draw, float depth);
+		static bool is_batchable(const Draw& batch, const Draw& draw); // Same state and instances
+		static uint32_t number(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t handle); // First appearance order
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const uint32_t m_material_set;
+		const Order m_order;
+
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t draw; // Index into m_draws
+		};
+		std::vector<Draw> m_draws;
+		std::vector<SortEntry> m_entries; // Sorted by Sort()
+		std::vector<SortEntry> m_scratch; // Radix sort ping-pong
+		bool m_is_sorted = true;
+
+		std::unordered_map<uint64_t, uint32_t> m_pipeline_ids;
+		std::unordered_map<uint64_t, uint32_t> m_material_ids;
+		std::unordered_map<uint64_t, uint32_t> m_mesh_ids;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,243 @@
+#include "vulkan_format.h"
+
+namespace Albedo {
+namespace RHI
+{
+	FormatBlockInfo GetFormatBlockInfo(VkFormat format)
+	{
+		switch (format)
+		{
+		// Uncompressed
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8_SNORM:
+		case VK_FORMAT_R8_UINT:
+		case VK_FORMAT_R8_SINT:
+		case VK_FORMAT_R8_SRGB:
+		case VK_FORMAT_S8_UINT:
+			return { 1 };
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SNORM:
+		case VK_FORMAT_R8G8_UINT:
+		case VK_FORMAT_R8G8_SINT:
+		case VK_FORMAT_R8G8_SRGB:
+		case VK_FORMAT_R16_UNORM:
+		case VK_FORMAT_R16_SNORM:
+		case VK_FORMAT_R16_UINT:
+		case VK_FORMAT_R16_SINT:
+		case VK_FORMAT_R16_SFLOAT:
+		case VK_FORMAT_R5G6B5_UNORM_PACK16:
+		case VK_FORMAT_B5G6R5_UNORM_PACK16:
+		case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
+		case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
+		case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
+		case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+		case VK_FORMAT_D16_UNORM:
+			return { 2 };
+		case VK_FORMAT_R8G8B8_UNORM:
+		case VK_FORMAT_R8G8B8_SRGB:
+		case VK_FORMAT_B8G8R8_UNORM:
+		case VK_FORMAT_B8G8R8_SRGB:
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+			return { 3 };
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8G8B8A8_UINT:
+		case VK_FORMAT_R8G8B8A8_SINT:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+		case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+		case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+		case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16_SNORM:
+		case VK_FORMAT_R16G16_UINT:
+		case VK_FORMAT_R16G16_SINT:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R32_SINT:
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT:
+			return { 4 };
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return { 5 };
+		case VK_FORMAT_R16G16B16_UNORM:
+		case VK_FORMAT_R16G16B16_SFLOAT:
+			return { 6 };
+		case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R16G16B16A16_SNORM:
+		case VK_FORMAT_R16G16B16A16_UINT:
+		case VK_FORMAT_R16G16B16A16_SINT:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R32G32_SINT:
+		case VK_FORMAT_R32G32_SFLOAT:
+			return { 8 };
+		case VK_FORMAT_R32G32B32_UINT:
+		case VK_FORMAT_R32G32B32_SINT:
+		case VK_FORMAT_R32G32B32_SFLOAT:
+			return { 12 };
+		case VK_FORMAT_R32G32B32A32_UINT:
+		case VK_FORMAT_R32G32B32A32_SINT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return { 16 };
+
+		// BC (4x4)
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+			return { 8, 4, 4 };
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return { 16, 4, 4 };
+
+		// ETC2 & EAC (4x4)
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+			return { 8, 4, 4 };
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+			return { 16, 4, 4 };
+
+		// ASTC LDR (16 bytes per block)
+		case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:		case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:		return { 16, 4, 4 };
+		case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:		case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:		return { 16, 5, 4 };
+		case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:		case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:		return { 16, 5, 5 };
+		case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:		case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:		return { 16, 6, 5 };
+		case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:		case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:		return { 16, 6, 6 };
+		case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:		case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:		return { 16, 8, 5 };
+		case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:		case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:		return { 16, 8, 6 };
+		case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:		case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:		return { 16, 8, 8 };
+		case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:	case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:	return { 16, 10, 5 };
+		case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:	case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:	return { 16, 10, 6 };
+		case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:	case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:	return { 16, 10, 8 };
+		case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:	case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:	return { 16, 10, 10 };
+		case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:	case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:	return { 16, 12, 10 };
+		case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:	case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:	return { 16, 12, 12 };
+
+		default: return {};
+		}
+	}
+
+	VkImageAspectFlags GetFormatAspect(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:					return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_S8_UINT:							return VK_IMAGE_ASPECT_STENCIL_BIT;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		default:													return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	FormatTable::FormatTable(VkPhysicalDevice physical_device, uint32_t api_version) :
+		m_is_built{ true }
+	{
+		for (size_t format = 0; format < CORE_FORMAT_COUNT; ++format)
+			vkGetPhysicalDeviceFormatProperties(physical_device, static_cast<VkFormat>(format), &m_core_formats[format]);
+
+		// Promoted formats are only valid to query on devices of that version
+		auto query_range = [&](VkFormat first, VkFormat last)
+		{
+			for (int32_t format = first; format <= last; ++format)
+				vkGetPhysicalDeviceFormatProperties(physical_device, static_cast<VkFormat>(format), &m_promoted_formats[static_cast<VkFormat>(format)]);
+		};
+		if (api_version >= VK_API_VERSION_1_1)
+			query_range(VK_FORMAT_G8B8G8R8_422_UNORM, VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM); // Y'CbCr
+		if (api_version >= VK_API_VERSION_1_3)
+		{
+			query_range(VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK, VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK); // ASTC HDR
+			query_range(VK_FORMAT_G8_B8R8_2PLANE_444_UNORM, VK_FORMAT_G16_B16R16_2PLANE_444_UNORM);
+			query_range(VK_FORMAT_A4R4G4B4_UNORM_PACK16, VK_FORMAT_A4B4G4R4_UNORM_PACK16);
+		}
+	}
+
+	const VkFormatProperties* FormatTable::find(VkFormat format) const
+	{
+		if (!m_is_built || format == VK_FORMAT_UNDEFINED) return nullptr;
+		if (static_cast<size_t>(format) < CORE_FORMAT_COUNT) return &m_core_formats[format];
+		auto properties = m_promoted_formats.find(format);
+		return properties != m_promoted_formats.end() ? &properties->second : nullptr;
+	}
+
+	VkFormatFeatureFlags FormatTable::GetFeatures(VkFormat format, VkImageTiling tiling) const
+	{
+		auto properties = find(format);
+		if (!properties) return 0;
+		return (tiling == VK_IMAGE_TILING_LINEAR) ? properties->linearTilingFeatures : properties->optimalTilingFeatures;
+	}
+
+	VkFormatFeatureFlags FormatTable::GetBufferFeatures(VkFormat format) const
+	{
+		auto properties = find(format);
+		return properties ? properties->bufferFeatures : 0;
+	}
+
+	VkFormat FormatTable::FindSupported(std::span<const VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const
+	{
+		for (auto format : candidates)
+			if (IsSupported(format, tiling, features)) return format;
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	VkFormat FormatTable::FindDepthFormat(DepthPreference preference,
+		VkFormatFeatureFlags features/* = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT*/, VkImageTiling tiling/* = VK_IMAGE_TILING_OPTIMAL*/) const
+	{
+		return FindSupported(GetDepthFormats(preference), tiling, features);
+	}
+
+	std::span<const VkFormat> FormatTable::GetDepthFormats(DepthPreference preference)
+	{
+		// D16_UNORM and one of D24_UNORM_S8_UINT & D32_SFLOAT_S8_UINT are guaranteed depth attachments
+		static constexpr std::array precisionFormats{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+		static constexpr std::array stencilFormats{ VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D16_UNORM_S8_UINT };
+		static constexpr std::array bandwidthFormats{ VK_FORMAT_D16_UNORM, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D32_SFLOAT };
+		switch (preference)
+		{
+		case DepthPreference::PRECISION:	return precisionFormats;
+		case DepthPreference::STENCIL:		return stencilFormats;
+		case DepthPreference::BANDWIDTH:	return bandwidthFormats;
+		default: return {};
+		}
+	}
+
+	VkFormatFeatureFlags FormatTable::GetRequiredFeatures(VkImageUsageFlags usage)
+	{
+		VkFormatFeatureFlags features = 0;
+		if (usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)					features |= VK_FORMAT_FEATURE_TRANSFER_SRC_BIT;
+		if (usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT)					features |= VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+		if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)								features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+		if (usage & VK_IMAGE_USAGE_STORAGE_BIT)								features |= VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+		if (usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)				features |= VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+		if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)	features |= VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		if (usage & VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR) features |= VK_FORMAT_FEATURE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+		return features;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+
+namespace Albedo {
+namespace RHI
+{
+	// Texel block of a format (1x1 blocks for uncompressed formats), buffer copies are addressed in whole blocks
+	struct FormatBlockInfo
+	{
+		uint32_t block_size = 0; // Bytes (0: Unknown format)
+		uint32_t block_width = 1;
+		uint32_t block_height = 1;
+
+		bool IsKnown() const { return block_size != 0; }
+		bool IsCompressed() const { return block_width > 1 || block_height > 1; }
+		// Tightly packed bytes of a width x height x depth region (Partial blocks at the edges are padded to whole blocks)
+		uint64_t GetRegionSize(uint32_t width, uint32_t height, uint32_t depth = 1) const
+		{
+			return uint64_t{ block_size } * ((width + block_width - 1) / block_width) * ((height + block_height - 1) / block_height) * depth;
+		}
+	};
+	// Color formats (uncompressed, BC, ETC2/EAC and ASTC LDR) and depth formats
+	FormatBlockInfo GetFormatBlockInfo(VkFormat format);
+	// All aspects of a format (DEPTH | STENCIL for combined depth stencil formats, COLOR for the others)
+	VkImageAspectFlags GetFormatAspect(VkFormat format);
+
+	// Ranked depth formats of FormatTable::FindDepthFormat()
+	enum class DepthPreference
+	{
+		PRECISION,	// D32 -> D24S8 -> D16 (Main depth buffers)
+		STENCIL,		// D24S8 -> D32S8 -> D16S8
+		BANDWIDTH	// D16 -> X8D24 -> D32 (Half the bandwidth of 32-bit depth, e.g. shadow maps)
+	};
+
+	// Format Capability Table (VulkanContext::GetFormatTable()): The linear, optimal and buffer features of every core format
+	// (and the promoted Vulkan 1.1 & 1.3 formats the device version has) are queried once at device selection, then read-only.
+	class FormatTable
+	{
+	public:
+		bool IsKnown(VkFormat format) const { return find(format) != nullptr; } // Queried (Unknown formats support nothing)
+		VkFormatFeatureFlags GetFeatures(VkFormat format, VkImageTiling tiling) const;
+		VkFormatFeatureFlags GetBufferFeatures(VkFormat format) const;
+		bool IsSupported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) const { return (GetFeatures(format, tiling) & features) == features; }
+		bool IsBufferSupported(VkFormat format, VkFormatFeatureFlags features) const { return (GetBufferFeatures(format) & features) == features; }
+		// The first candidate with all features (VK_FORMAT_UNDEFINED if none)
+		VkFormat FindSupported(std::span<const VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
+		// The first ranked depth format with the features (Add SAMPLED_IMAGE_BIT for shadow maps)
+		VkFormat FindDepthFormat(DepthPreference preference,
+			VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL) const;
+
+		static VkFormatFeatureFlags GetRequiredFeatures(VkImageUsageFlags usage); // Image usage -> format features
+		static std::span<const VkFormat> GetDepthFormats(DepthPreference preference);
+
+	public:
+		FormatTable() = default; // Empty until built
+		FormatTable(VkPhysicalDevice physical_device, uint32_t api_version);
+
+	private:
+		const VkFormatProperties* find(VkFormat format) const;
+
+	private:
+		static constexpr size_t CORE_FORMAT_COUNT = VK_FORMAT_ASTC_12x12_SRGB_BLOCK + 1; // Vulkan 1.0 (Indexed by VkFormat)
+		std::array<VkFormatProperties, CORE_FORMAT_COUNT> m_core_formats{};
+		bool m_is_built = false;
+		std::unordered_map<VkFormat, VkFormatProperties> m_promoted_formats; // Extension enum ranges
+	};
+
+}} // namespace Albedo::RHI
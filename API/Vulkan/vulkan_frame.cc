@@ -0,0 +1,153 @@
+#include "vulkan_frame.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	FrameContext::FrameContext(std::shared_ptr<VulkanContext> vulkan_context,
+		uint32_t frames_in_flight/* = 2*/,
+		VkDeviceSize staging_capacity_per_frame/* = 8 * 1024 * 1024*/) :
+		m_context{ std::move(vulkan_context) },
+		m_frames(frames_in_flight)
+	{
+		assert(frames_in_flight > 0 && "Frame Context needs at least one frame in flight!");
+
+		for (uint32_t index = 0; index < frames_in_flight; ++index)
+		{
+			auto& frame = m_frames[index];
+			frame.index = index;
+			frame.fence = m_context->CreateFence(VK_FENCE_CREATE_SIGNALED_BIT);
+			frame.image_available = m_context->CreateSemaphore(0x0);
+			frame.render_finished = m_context->CreateSemaphore(0x0);
+		}
+		m_descriptor_arena = m_context->CreateDescriptorArena(frames_in_flight);
+		m_staging_ring = m_context->m_memory_allocator->CreateStagingRing(staging_capacity_per_frame, frames_in_flight);
+		m_readback_engine = std::make_unique<ReadbackEngine>(m_context, frames_in_flight);
+		m_frame_timings = std::make_unique<FrameTimings>(m_context, frames_in_flight);
+	}
+
+	FrameContext::~FrameContext()
+	{
+		InlineVector<Fence*, 8> fences;
+		for (auto& frame : m_frames) fences.emplace_back(frame.fence.get());
+		Fence::WaitAll(fences);
+		for (auto& frame : m_frames) frame.command_buffer.reset(); // Before the frame pools (Not owned by their command buffers)
+	}
+
+	FrameContext::Frame& FrameContext::BeginFrame()
+	{
+		assert(!m_is_recording && "You cannot BeginFrame() twice without EndFrame()!");
+
+		auto& frame = m_frames[m_frame_index];
+		frame.fence->Wait(); // Reset after acquiring, or a failed acquisition would never signal it again
+		if (frame.present_index) m_context->WaitPresent(*frame.present_index); // Usually complete (No-op without maintenance1)
+		const auto acquireBegin = std::chrono::steady_clock::now();
+		m_context->NextSwapChainImageIndex(*frame.image_available, VK_NULL_HANDLE);
+		m_frame_timings->Record(FrameTimings::ACQUIRE_WAIT, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - acquireBegin));
+		frame.fence->Reset();
+
+		// The GPU has finished this frame, so its transient objects can be recycled
+		{
+			std::scoped_lock guard{ frame.command_pools_mutex };
+			for (auto& [thread_id, command_pool] : frame.command_pools) command_pool->Reset();
+			frame.semaphores.clear(); // Waited by the finished submissions, so unsignaled again
+		}
+		frame.allocator.Reset();
+		m_context->GetDeletionQueue().Collect();
+		m_context->m_memory_allocator->UpdateMemoryBudget(); // After the retired resources were freed
+		m_context->UpdateShaderHotReload(); // Retired pipelines are deferred to the deletion queue
+		m_context->GetCompletionPoller().Poll(); // Coroutines waiting for the GPU resume on the frame thread
+		m_descriptor_arena->BeginFrame(m_frame_index);
+		m_staging_ring->BeginFrame(m_frame_index);
+		m_readback_engine->BeginFrame(m_frame_index);
+
+		const uint32_t deviceCount = m_context->GetDeviceCount();
+		frame.device_mask = (deviceCount > 1 && m_device_group_mode == DeviceGroupMode::ALTERNATE_FRAME) ?
+			1U << static_cast<uint32_t>(m_frame_number % deviceCount) : 0;
+		++m_frame_number;
+
+		frame.command_buffer = CreateCommandBuffer(true);
+		frame.command_buffer->SetDeviceMask(frame.device_mask, deviceCount > 1 && m_device_group_mode == DeviceGroupMode::SPLIT_FRAME);
+		frame.command_buffer->Begin();
+		m_frame_timings->BeginGPUFrame(m_frame_index, *frame.command_buffer);
+		if (m_gpu_profiler) m_gpu_profiler->BeginFrame(m_frame_index, *frame.command_buffer);
+		m_is_recording = true;
+		return frame;
+	}
+
+	void FrameContext::EndFrame(std::span<const SemaphoreWaitInfo> wait_semaphores/* = {}*/)
+	{
+		assert(m_is_recording && "You must BeginFrame() before EndFrame()!");
+
+		auto& frame = m_frames[m_frame_index];
+		frame.command_buffer->FlushBarriers(); // Timed by the end timestamp
+		m_frame_timings->EndGPUFrame(m_frame_index, *frame.command_buffer);
+		frame.command_buffer->End();
+		{
+			std::scoped_lock guard{ frame.command_pools_mutex };
+			m_recording_statistics = {};
+			for (auto& [thread_id, command_pool] : frame.command_pools) m_recording_statistics += command_pool->TakeRecordingStatistics();
+		}
+
+		InlineVector<SemaphoreWaitInfo, 8> waitSemaphores;
+		waitSemaphores.emplace_back(SemaphoreWaitInfo{ .semaphore = *frame.image_available, .stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT });
+		for (const auto& wait_semaphore : wait_semaphores) waitSemaphores.emplace_back(wait_semaphore);
+
+		if (m_gpu_profiler) m_gpu_profiler->EndFrame();
+		const VkSemaphore renderFinished = *frame.render_finished;
+		frame.submitted_tick = frame.command_buffer->SubmitTick(waitSemaphores, { &renderFinished, 1 }, *frame.fence);
+		frame.command_buffer.reset();
+		m_is_recording = false;
+		if (auto capture = m_context->GetCommandCapture()) capture->EndFrame();
+
+		m_frame_index = (m_frame_index + 1) % GetFrameCount(); // Advance before presenting, recreation is signaled by throwing
+		frame.present_index = m_context->GetPresentCount();
+		const auto presentBegin = std::chrono::steady_clock::now();
+		try { m_context->PresentSwapChain({ &renderFinished, 1 }); }
+		catch (...) { end_frame_telemetry(presentBegin); throw; } // Recreation still ends the frame
+		end_frame_telemetry(presentBegin);
+	}
+
+	void FrameContext::end_frame_telemetry(std::chrono::steady_clock::time_point present_begin)
+	{
+		m_frame_timings->Record(FrameTimings::PRESENT_WAIT, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - present_begin));
+		auto& statistics = m_context->GetStatistics();
+		statistics.EndFrame();
+		m_frame_timings->EndFrame(statistics.GetLastFrame());
+	}
+
+	void FrameContext::EnableGPUProfiler(uint32_t max_zones_per_frame/* = 512*/)
+	{
+		assert(!m_is_recording && "You cannot enable the GPU Profiler inside a frame!");
+		m_gpu_profiler = m_context->CreateGPUProfiler(GetFrameCount(), max_zones_per_frame);
+	}
+
+	std::shared_ptr<CommandBuffer> FrameContext::
+		CreateCommandBuffer(bool primary/* = false*/, std::thread::id thread_id/* = std::this_thread::get_id()*/)
+	{
+		auto& frame = m_frames[m_frame_index];
+		std::shared_ptr<CommandPool> commandPool;
+		{
+			std::scoped_lock guard{ frame.command_pools_mutex };
+			auto& framePool = frame.command_pools[thread_id];
+			if (framePool == nullptr)
+				framePool = m_context->CreateCommandPool(m_context->m_device_queue_family_graphics, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			commandPool = framePool;
+		}
+		auto level = primary ? VK_COMMAND_BUFFER_LEVEL_PRIMARY : VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		auto commandBuffer = commandPool->AllocateCommandBuffer(level);
+		commandBuffer->SetDeviceMask(frame.device_mask); // The devices of the frame
+		return commandBuffer;
+	}
+
+	VkSemaphore FrameContext::CreateSemaphore()
+	{
+		auto& frame = m_frames[m_frame_index];
+		auto semaphore = m_context->CreateSemaphore(0x0); // Drawn from the SyncPool
+		VkSemaphore handle = *semaphore;
+		std::scoped_lock guard{ frame.command_pools_mutex };
+		frame.semaphores.emplace_back(std::move(semaphore));
+		return handle;
+	}
+
+}} // namespace Albedo::RHI
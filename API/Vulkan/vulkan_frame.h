@@ -0,0 +1,94 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+#include "vulkan_profiler.h"
+#include "vulkan_readback.h"
+#include "vulkan_frame_timing.h"
+
+namespace Albedo {
+namespace RHI
+{
+	// Frames-in-flight Ring (Each frame owns its synchronization and transient resources)
+	class FrameContext
+	{
+	public:
+		// BeginFrame() and EndFrame() throw VulkanContext::swapchain_error for recreation (same as the swap chain functions)
+		struct Frame
+		{
+			uint32_t index = 0;
+			std::unique_ptr<Fence> fence;							// Signaled when the frame has completed on the GPU
+			std::unique_ptr<Semaphore> image_available;	// Signaled by vkAcquireNextImageKHR
+			std::unique_ptr<Semaphore> render_finished;	// Waited by vkQueuePresentKHR
+			std::shared_ptr<CommandBuffer> command_buffer; // Primary (Recording between BeginFrame() and EndFrame())
+			uint64_t submitted_tick = 0;								// Graphics QueueTimeline tick of the last submission
+			std::optional<uint64_t> present_index;				// Of the last present (Waited before render_finished is signaled again)
+			uint32_t device_mask = 0;									// Devices of this frame (See DeviceGroupMode), 0: Every device
+
+			std::mutex command_pools_mutex;
+			std::unordered_map<std::thread::id, std::shared_ptr<CommandPool>> command_pools; // Transient, reset in BeginFrame()
+			std::vector<std::unique_ptr<Semaphore>> semaphores; // Transient, returned to the SyncPool in BeginFrame() (Guarded by command_pools_mutex)
+			LinearArena allocator; // Reset in BeginFrame()
+		};
+
+		// Device Groups (VulkanContext::GetDeviceCount() > 1): Devices rendering each frame, set on the primary and the frame command buffers
+		enum class DeviceGroupMode
+		{
+			ALL_DEVICES,			// Every device runs the whole frame
+			ALTERNATE_FRAME,	// Frame n runs on device n % count (Keep at least as many frames in flight as devices)
+			SPLIT_FRAME			// Every device renders a band of each dynamic render pass of the primary
+		};
+		void SetDeviceGroupMode(DeviceGroupMode mode) { m_device_group_mode = mode; } // From the next BeginFrame()
+
+		// Wait this frame slot, acquire the next swap chain image and begin the primary command buffer
+		Frame& BeginFrame();
+		// Submit the primary command buffer (Waiting the acquired image) and present
+		void EndFrame(std::span<const SemaphoreWaitInfo> wait_semaphores = {});
+
+		Frame& GetCurrentFrame() { return m_frames[m_frame_index]; }
+		uint32_t GetFrameIndex() const { return m_frame_index; }
+		uint32_t GetFrameCount() const { return static_cast<uint32_t>(m_frames.size()); }
+
+		// Per-frame transient objects of the current frame
+		std::shared_ptr<CommandBuffer> CreateCommandBuffer(bool primary = false, std::thread::id thread_id = std::this_thread::get_id()); // Thread-safe
+		VkSemaphore CreateSemaphore(); // Thread-safe, binary (Must be signaled and waited by submissions of this frame)
+		DescriptorArena& GetDescriptorArena() { return *m_descriptor_arena; }
+		VMA::StagingRing& GetStagingRing() { return *m_staging_ring; }
+		ReadbackEngine& GetReadbackEngine() { return *m_readback_engine; } // Futures of a frame are resolved when its slot begins again
+		// Transient CPU memory of the current frame for std::pmr containers (Frame thread only, valid until this frame slot begins again)
+		std::pmr::memory_resource& GetFrameAllocator() { return m_frames[m_frame_index].allocator; }
+
+		// Optional GPU profiler driven by BeginFrame() (Created with the same frame count)
+		void EnableGPUProfiler(uint32_t max_zones_per_frame = 512);
+		GPUProfiler* GetGPUProfiler() { return m_gpu_profiler.get(); } // Null if not enabled
+
+		// Recorder telemetry of the last ended frame (Command buffers of the frame pools ended before EndFrame())
+		const RecordingStatistics& GetRecordingStatistics() const { return m_recording_statistics; }
+		// Frame-time histograms & hitches (p50/p95/p99/max per window, see FrameTimings)
+		FrameTimings& GetFrameTimings() { return *m_frame_timings; }
+
+	public:
+		FrameContext() = delete;
+		FrameContext(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight = 2, VkDeviceSize staging_capacity_per_frame = 8 * 1024 * 1024);
+		~FrameContext(); // Wait all frames in flight
+		FrameContext(const FrameContext&) = delete;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::vector<Frame> m_frames;
+		uint32_t m_frame_index = 0;
+		uint64_t m_frame_number = 0; // Frames begun so far
+		bool m_is_recording = false;
+		DeviceGroupMode m_device_group_mode = DeviceGroupMode::ALL_DEVICES;
+
+		std::shared_ptr<DescriptorArena> m_descriptor_arena;
+		std::shared_ptr<VMA::StagingRing> m_staging_ring;
+		std::unique_ptr<ReadbackEngine> m_readback_engine;
+		std::shared_ptr<GPUProfiler> m_gpu_profiler;
+		RecordingStatistics m_recording_statistics;
+		std::unique_ptr<FrameTimings> m_frame_timings;
+
+	private:
+		void end_frame_telemetry(std::chrono::steady_clock::time_point present_begin); // Also when presenting throws
+	};
+
+}} // namespace Albedo::RHI
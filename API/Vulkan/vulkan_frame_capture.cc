@@ -0,0 +1,264 @@
+#include "vulkan_frame_capture.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr uint32_t CONVERT_GROUP_SIZE = 8;
+
+		uint32_t align_up(uint32_t value, uint32_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+	}
+
+	std::span<const std::byte> FrameCaptureRing::Frame::GetPlane(uint32_t plane) const
+	{
+		assert((plane == 0 || (m_format == Format::YUV420 && plane < 3)) && "Invalid plane!");
+		if (m_format != Format::YUV420) return GetData();
+		const size_t chromaSize = static_cast<size_t>(m_chroma_row_pitch) * (m_extent.height / 2);
+		switch (plane)
+		{
+		case 0: return { m_data, static_cast<size_t>(m_row_pitch) * m_extent.height };
+		case 1: return { m_data + m_chroma_offset, chromaSize };
+		default: return { m_data + m_chroma_offset + chromaSize, chromaSize };
+		}
+	}
+
+	FrameCaptureRing::FrameCaptureRing(std::shared_ptr<VulkanContext> vulkan_context, const Config& config, Callback callback) :
+		m_context{ std::move(vulkan_context) },
+		m_config{ config },
+		m_callback{ std::move(callback) }
+	{
+		assert(m_config.extent.width > 0 && m_config.extent.height > 0 && "Invalid capture extent!");
+		assert(m_config.ring_size > 0 && "Invalid ring size!");
+		assert(m_callback && "Invalid capture callback!");
+
+		// Rows padded to whole invocations, so no invocation writes into the next row
+		const auto& extent = m_config.extent;
+		m_push_constants = { .extent = extent, .format = static_cast<uint32_t>(m_config.format) };
+		switch (m_config.format)
+		{
+		case Format::RGB8:
+			m_push_constants.row_pitch = align_up(extent.width, 4) * 3;
+			m_frame_size = VkDeviceSize{ m_push_constants.row_pitch } * extent.height;
+			break;
+		case Format::RGBA16F:
+			m_push_constants.row_pitch = extent.width * 8;
+			m_frame_size = VkDeviceSize{ m_push_constants.row_pitch } * extent.height;
+			break;
+		case Format::YUV420:
+			if (extent.width % 2 || extent.height % 2)
+				throw std::runtime_error("Failed to create the Frame Capture Ring - YUV420 needs an even width & height!");
+			m_push_constants.row_pitch = align_up(extent.width, 8);
+			m_push_constants.chroma_row_pitch = m_push_constants.row_pitch / 2;
+			m_push_constants.chroma_offset = m_push_constants.row_pitch * extent.height;
+			m_frame_size = m_push_constants.chroma_offset + VkDeviceSize{ m_push_constants.chroma_row_pitch } * extent.height;
+			break;
+		}
+
+		// Allocated once: Capturing never touches the allocator
+		m_slots.resize(m_config.ring_size);
+		for (auto& slot : m_slots)
+		{
+			slot.readback = m_context->m_memory_allocator->AllocateBuffer(m_frame_size,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, false, true /*HOST_ACCESS_RANDOM*/, true);
+			if constexpr (EnableDebugMarkers)
+				slot.readback->SetDebugName("FrameCaptureRing::Readback");
+		}
+	}
+
+	FrameCaptureRing::~FrameCaptureRing()
+	{
+		for (auto slotIndex : m_in_flight_slots)
+		{
+			const auto& slot = m_slots[slotIndex];
+			slot.timeline->Wait(slot.tick);
+		}
+	}
+
+	bool FrameCaptureRing::CaptureCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VMA::Image& source)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(source.Width() >= m_config.extent.width && source.Height() >= m_config.extent.height && "The source is smaller than the capture!");
+
+		auto slotIndex = acquire_slot();
+		if (!slotIndex.has_value()) return false;
+
+		source.TransitionCommand(command_buffer, ResourceAccess
+			{
+				.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+				.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			}, 0, 1);
+		convert_command(command_buffer, convert_pipeline, source.GetSampledImageView(), *slotIndex);
+		return true;
+	}
+
+	bool FrameCaptureRing::CaptureCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline)
+	{
+		if (m_context->IsHeadless())
+			return CaptureCommand(command_buffer, convert_pipeline, *m_context->GetOffscreenImage(m_context->m_swapchain_current_image_index));
+
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(m_context->m_swapchain_current_extent.width >= m_config.extent.width &&
+			m_context->m_swapchain_current_extent.height >= m_config.extent.height && "The swap chain is smaller than the capture!");
+		if (!(m_context->m_swapchain_image_usage & VK_IMAGE_USAGE_SAMPLED_BIT))
+			throw std::runtime_error("Failed to capture the swap chain image - The surface does not support sampled swap chain images!");
+
+		auto slotIndex = acquire_slot();
+		if (!slotIndex.has_value()) return false;
+
+		const uint32_t imageIndex = m_context->m_swapchain_current_image_index;
+		const VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = m_context->m_swapchain_images[imageIndex],
+				.subresourceRange = subresourceRange
+			});
+		convert_command(command_buffer, convert_pipeline, m_context->m_swapchain_imageviews[imageIndex], *slotIndex);
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.srcAccessMask = VK_ACCESS_2_NONE,
+				.dstStageMask = VK_PIPELINE_STAGE_2_NONE,
+				.dstAccessMask = VK_ACCESS_2_NONE,
+				.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = m_context->m_swapchain_images[imageIndex],
+				.subresourceRange = subresourceRange
+			});
+		command_buffer.FlushBarriers();
+		return true;
+	}
+
+	void FrameCaptureRing::Submitted(QueueTimeline& queue_timeline, uint64_t tick)
+	{
+		for (auto slotIndex : m_captured_slots)
+		{
+			auto& slot = m_slots[slotIndex];
+			slot.state = SlotState::IN_FLIGHT;
+			slot.timeline = &queue_timeline;
+			slot.tick = tick;
+			m_in_flight_slots.push_back(slotIndex);
+		}
+		m_captured_slots.clear();
+	}
+
+	uint32_t FrameCaptureRing::Poll()
+	{
+		uint32_t deliveredCount = 0;
+		while (!m_in_flight_slots.empty())
+		{
+			const uint32_t slotIndex = m_in_flight_slots.front();
+			auto& slot = m_slots[slotIndex];
+			if (!slot.timeline->IsComplete(slot.tick)) break; // Completed in submission order
+			m_in_flight_slots.pop_front();
+			slot.state = SlotState::FREE; // Held by the frame until it is released
+
+			slot.readback->Invalidate(0, m_frame_size);
+			Frame frame;
+			frame.m_buffer = slot.readback;
+			frame.m_data = static_cast<const std::byte*>(slot.readback->Access());
+			frame.m_size = m_frame_size;
+			frame.m_extent = m_config.extent;
+			frame.m_format = m_config.format;
+			frame.m_row_pitch = m_push_constants.row_pitch;
+			frame.m_chroma_row_pitch = m_push_constants.chroma_row_pitch;
+			frame.m_chroma_offset = m_push_constants.chroma_offset;
+			frame.m_frame_index = slot.frame_index;
+			m_callback(std::move(frame));
+			++deliveredCount;
+		}
+		return deliveredCount;
+	}
+
+	VkExtent2D FrameCaptureRing::GetDispatchExtent() const
+	{
+		const auto& extent = m_config.extent;
+		VkExtent2D invocations{};
+		switch (m_config.format)
+		{
+		case Format::RGB8:		invocations = { (extent.width + 3) / 4, extent.height }; break;
+		case Format::RGBA16F:	invocations = extent; break;
+		case Format::YUV420:	invocations = { (extent.width + 7) / 8, extent.height / 2 }; break;
+		}
+		return
+		{
+			(invocations.width + CONVERT_GROUP_SIZE - 1) / CONVERT_GROUP_SIZE,
+			(invocations.height + CONVERT_GROUP_SIZE - 1) / CONVERT_GROUP_SIZE
+		};
+	}
+
+	std::optional<uint32_t> FrameCaptureRing::acquire_slot()
+	{
+		auto isFree = [this]() { return m_slots[m_next_slot].state == SlotState::FREE && m_slots[m_next_slot].readback.use_count() == 1; };
+		if (!isFree())
+		{
+			Poll();
+			if (!isFree())
+			{
+				++m_dropped_frame_count;
+				return std::nullopt;
+			}
+		}
+		const uint32_t slotIndex = m_next_slot;
+		m_next_slot = (m_next_slot + 1) % m_config.ring_size;
+		return slotIndex;
+	}
+
+	void FrameCaptureRing::convert_command(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VkImageView source_view, uint32_t slot_index)
+	{
+		auto& slot = m_slots[slot_index];
+		convert_pipeline.Bind(command_buffer);
+
+		// The previous capture of the slot completed, so its descriptor set is rewritten in place instead of allocating one per frame
+		auto descriptorSetLayout = convert_pipeline.GetSharedDescriptorSetLayout(0);
+		if (slot.descriptor_set_layout != descriptorSetLayout)
+		{
+			slot.descriptor_set = m_context->CreateDescriptorSet(descriptorSetLayout); // Freed through the deletion queue
+			slot.descriptor_set_layout = std::move(descriptorSetLayout);
+		}
+		DescriptorWriteBatch{ m_context, 2 }
+			.WriteImage(*slot.descriptor_set, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0, source_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+			.WriteBuffer(*slot.descriptor_set, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, slot.readback)
+			.Flush();
+
+		command_buffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, convert_pipeline.GetPipelineLayout(), 0, { *slot.descriptor_set });
+		command_buffer.PushConstants(convert_pipeline.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ConvertPushConstants), &m_push_constants);
+		const auto groups = GetDispatchExtent();
+		convert_pipeline.Dispatch(command_buffer, groups.width, groups.height);
+
+		command_buffer.QueueBarrier(VkBufferMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+				.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = *slot.readback,
+				.offset = 0,
+				.size = VK_WHOLE_SIZE
+			}); // Flushed by End() or the next barriers
+
+		slot.state = SlotState::CAPTURED;
+		slot.frame_index = m_frame_count++;
+		m_captured_slots.push_back(slot_index);
+	}
+
+}} // namespace Albedo::RHI
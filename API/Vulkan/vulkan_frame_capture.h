@@ -0,0 +1,124 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <deque>
+#include <functional>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ComputePipeline;
+
+	// Frame Capture Ring: Records rendered frames continuously (e.g. Gameplay capture at 60 fps) without stalling the renderer, unlike
+	// VulkanContext::Screenshot(). CaptureCommand() converts the source (e.g. the swap chain image) by a compute shader in the recording
+	// command buffer straight into the host-cached readback buffer of a ring slot, and Poll() hands the completed frames to the callback
+	// in capture order, mapped in place. Frames are dropped instead of waited for when every slot is in flight or held (Backpressure).
+	// Not thread-safe: Record, submit and poll it from one thread (Frames can be released anywhere).
+	class FrameCaptureRing
+	{
+	public:
+		enum class Format
+		{
+			RGB8,		// Packed 3 bytes per pixel, sRGB sources read linear values
+			RGBA16F,	// 8 bytes per pixel (Linear)
+			YUV420		// I420 planes: Y, then U & V at half resolution (BT.709 limited range), even width & height
+		};
+		struct Config
+		{
+			VkExtent2D extent;				// Of the captured region (From the origin of the source)
+			Format format = Format::RGB8;
+			uint32_t ring_size = 4;			// Frames in flight between CaptureCommand() and the release of their Frame
+		};
+
+		// Converted frame in mapped readback memory (The ring slot is reused once every copy of the frame is released)
+		class Frame
+		{
+			friend class FrameCaptureRing;
+		public:
+			std::span<const std::byte> GetData() const { return { m_data, static_cast<size_t>(m_size) }; } // Every plane
+			std::span<const std::byte> GetPlane(uint32_t plane) const; // 0 (Y or every pixel), 1 (U), 2 (V)
+			uint32_t GetRowPitch(uint32_t plane = 0) const { return plane ? m_chroma_row_pitch : m_row_pitch; } // Bytes
+			VkExtent2D GetExtent() const { return m_extent; }
+			Format GetFormat() const { return m_format; }
+			uint64_t GetFrameIndex() const { return m_frame_index; } // Of the captured frames (Dropped ones are not counted)
+
+		private:
+			std::shared_ptr<VMA::Buffer> m_buffer;
+			const std::byte* m_data = nullptr;
+			VkDeviceSize m_size = 0;
+			VkExtent2D m_extent{};
+			Format m_format = Format::RGB8;
+			uint32_t m_row_pitch = 0;
+			uint32_t m_chroma_row_pitch = 0;
+			VkDeviceSize m_chroma_offset = 0;
+			uint64_t m_frame_index = 0;
+		};
+		using Callback = std::function<void(Frame frame)>; // Called by Poll() (Keep the frame to process it elsewhere)
+
+		// Set 0 of the convert pipeline: binding 0 - source (Sampled image read by texelFetch), binding 1 - destination (Storage buffer
+		// of uint words), push constant: ConvertPushConstants. Rows start at multiples of the row pitches (Padded to whole invocations),
+		// invocation (x, y) converts the 4 pixels at (4x, y) into 3 words for RGB8, the pixel at (x, y) into 2 words for RGBA16F and
+		// the 8x2 block at (8x, 2y) into 4 Y words, 1 U word & 1 V word for YUV420. Reads are clamped to extent, dispatched with 8x8x1
+		// work groups over GetDispatchExtent().
+		struct ConvertPushConstants
+		{
+			VkExtent2D extent;				// Config::extent
+			uint32_t format;				// Format
+			uint32_t row_pitch;				// Of plane 0
+			uint32_t chroma_row_pitch;		// Of the U & V planes (YUV420)
+			uint32_t chroma_offset;			// Of the U plane, the V plane follows it after chroma_row_pitch * height / 2 bytes (YUV420)
+		};
+		// Returns false if the frame is dropped because every ring slot is in flight or held. The source is left as a compute shader read.
+		bool CaptureCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VMA::Image& source);
+		// Current swap chain image in PRESENT_SRC_KHR (Needs SAMPLED in m_swapchain_image_usage), record it after the last pass
+		bool CaptureCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline);
+		// Track the frames captured so far once their command buffer was submitted,
+		// e.g. Submitted(frame.command_buffer->GetSubmittedQueueTimeline(), frame.submitted_tick) after FrameContext::EndFrame()
+		void Submitted(QueueTimeline& queue_timeline, uint64_t tick);
+		// Deliver the completed frames to the callback without blocking (e.g. Once per frame), returns the number of delivered frames
+		uint32_t Poll();
+
+		VkExtent2D GetDispatchExtent() const; // Work groups of the convert pipeline
+		VkDeviceSize GetFrameSize() const { return m_frame_size; }
+		uint64_t GetCapturedFrameCount() const { return m_frame_count; }
+		uint64_t GetDroppedFrameCount() const { return m_dropped_frame_count; }
+
+	public:
+		FrameCaptureRing() = delete;
+		FrameCaptureRing(std::shared_ptr<VulkanContext> vulkan_context, const Config& config, Callback callback);
+		~FrameCaptureRing(); // Wait the captures in flight (Undelivered frames are discarded)
+		FrameCaptureRing(const FrameCaptureRing&) = delete;
+
+	private:
+		enum class SlotState { FREE, CAPTURED, IN_FLIGHT };
+		struct Slot
+		{
+			SlotState state = SlotState::FREE;
+			std::shared_ptr<VMA::Buffer> readback;				// Free if only the slot holds it
+			std::shared_ptr<DescriptorSet> descriptor_set;		// Rewritten per capture (Never in flight when the slot is free)
+			std::shared_ptr<DescriptorSetLayout> descriptor_set_layout;
+			QueueTimeline* timeline = nullptr;
+			uint64_t tick = 0;
+			uint64_t frame_index = 0;
+		};
+		std::optional<uint32_t> acquire_slot(); // std::nullopt: Drop the frame
+		void convert_command(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VkImageView source_view, uint32_t slot_index);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		Config m_config;
+		Callback m_callback;
+		ConvertPushConstants m_push_constants{};
+		VkDeviceSize m_frame_size = 0;
+
+		std::vector<Slot> m_slots;
+		std::deque<uint32_t> m_captured_slots;		// In capture order
+		std::deque<uint32_t> m_in_flight_slots;		// In submission order
+		uint32_t m_next_slot = 0;
+		uint64_t m_frame_count = 0;
+		uint64_t m_dropped_frame_count = 0;
+	};
+
+}} // namespace Albedo::RHI
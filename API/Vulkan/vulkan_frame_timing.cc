@@ -0,0 +1,194 @@
+#include "vulkan_frame_timing.h"
+#include "vulkan_context.h"
+
+#include <bit>
+#include <cmath>
+
+namespace Albedo {
+namespace RHI
+{
+	void DurationHistogram::Record(std::chrono::nanoseconds duration)
+	{
+		const uint64_t nanoseconds = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+		m_buckets[bucket_of(nanoseconds / 1000)].fetch_add(1, std::memory_order_relaxed);
+		uint64_t maximum = m_max_ns.load(std::memory_order_relaxed);
+		while (nanoseconds > maximum && !m_max_ns.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed)) {}
+	}
+
+	DurationHistogram::Summary DurationHistogram::Summarize() const
+	{
+		std::array<uint32_t, BUCKET_COUNT> counts;
+		Summary summary{};
+		for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+		{
+			counts[bucket] = m_buckets[bucket].load(std::memory_order_relaxed);
+			summary.count += counts[bucket];
+		}
+		if (summary.count == 0) return summary;
+		summary.max_ms = m_max_ns.load(std::memory_order_relaxed) * 1e-6;
+
+		auto percentile = [&](double fraction)
+		{
+			const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(fraction * summary.count)), 1);
+			uint64_t cumulative = 0;
+			for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+			{
+				cumulative += counts[bucket];
+				if (cumulative >= rank) return std::min(bucket_upper_bound(bucket) * 1e-3, summary.max_ms);
+			}
+			return summary.max_ms;
+		};
+		summary.p50_ms = percentile(0.50);
+		summary.p95_ms = percentile(0.95);
+		summary.p99_ms = percentile(0.99);
+		return summary;
+	}
+
+	void DurationHistogram::Reset()
+	{
+		for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+		m_max_ns.store(0, std::memory_order_relaxed);
+	}
+
+	uint32_t DurationHistogram::bucket_of(uint64_t microseconds)
+	{
+		microseconds = std::min(microseconds, (uint64_t(1) << MAX_BITS) - 1);
+		if (microseconds < SUB_BUCKETS) return static_cast<uint32_t>(microseconds); // Exact
+		const uint32_t shift = static_cast<uint32_t>(std::bit_width(microseconds)) - 1 - SUB_BUCKET_BITS;
+		return (shift + 1) * SUB_BUCKETS + static_cast<uint32_t>(microseconds >> shift) - SUB_BUCKETS;
+	}
+
+	uint64_t DurationHistogram::bucket_upper_bound(uint32_t bucket)
+	{
+		if (bucket < SUB_BUCKETS) return bucket;
+		const uint32_t shift = bucket / SUB_BUCKETS - 1;
+		return ((uint64_t(SUB_BUCKETS + bucket % SUB_BUCKETS) + 1) << shift) - 1;
+	}
+
+	FrameTimings::FrameTimings(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight, uint32_t window_frames/* = 300*/) :
+		m_context{ std::move(vulkan_context) },
+		m_window_frames{ std::max(window_frames, 1u) },
+		m_pending_queries(frames_in_flight, false),
+		m_timestamp_period_ns{ m_context->m_physical_device_properties.limits.timestampPeriod },
+		m_swapchain_generation{ m_context->m_swapchain_generation }
+	{
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_context->m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_context->m_physical_device, &queueFamilyCount, queueFamilies.data());
+		const uint32_t validBits = queueFamilies[m_context->m_device_queue_family_graphics.value()].timestampValidBits;
+		if (validBits == 0 || m_context->GetDeviceCount() > 1)
+		{
+			log::info("Frame Timings without GPU frame times (No timestamps on the graphics queue, or a device group)");
+			return;
+		}
+		m_timestamp_mask = validBits >= 64 ? std::numeric_limits<uint64_t>::max() : ((uint64_t(1) << validBits) - 1);
+
+		VkQueryPoolCreateInfo queryPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = 2 * frames_in_flight
+		};
+		if (vkCreateQueryPool(
+			m_context->m_device,
+			&queryPoolCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_query_pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Query Pool!");
+	}
+
+	FrameTimings::~FrameTimings()
+	{
+		if (m_query_pool != VK_NULL_HANDLE)
+			vkDestroyQueryPool(m_context->m_device, m_query_pool, m_context->m_memory_allocation_callback);
+	}
+
+	FrameTimingWindow FrameTimings::GetLastWindow() const
+	{
+		std::scoped_lock guard{ m_last_window_mutex };
+		return m_last_window;
+	}
+
+	void FrameTimings::BeginGPUFrame(uint32_t frame_index, VkCommandBuffer command_buffer)
+	{
+		if (m_query_pool == VK_NULL_HANDLE) return;
+		assert(frame_index < m_pending_queries.size() && "Frame index is out of the frames in flight!");
+
+		// No WAIT bit: the frame fence has signaled
+		if (m_pending_queries[frame_index])
+		{
+			std::array<uint64_t, 2> timestamps{};
+			if (vkGetQueryPoolResults(
+				m_context->m_device,
+				m_query_pool,
+				2 * frame_index, 2,
+				sizeof(timestamps), timestamps.data(),
+				sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+			{
+				const uint64_t ticks = (timestamps[1] - timestamps[0]) & m_timestamp_mask;
+				Record(GPU_FRAME, std::chrono::nanoseconds{ static_cast<int64_t>(ticks * m_timestamp_period_ns) });
+			}
+			m_pending_queries[frame_index] = false;
+		}
+		m_context->m_dispatch.vkCmdResetQueryPool(command_buffer, m_query_pool, 2 * frame_index, 2);
+		m_context->m_dispatch.vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_query_pool, 2 * frame_index);
+	}
+
+	void FrameTimings::EndGPUFrame(uint32_t frame_index, VkCommandBuffer command_buffer)
+	{
+		if (m_query_pool == VK_NULL_HANDLE) return;
+		m_context->m_dispatch.vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, 2 * frame_index + 1);
+		m_pending_queries[frame_index] = true;
+	}
+
+	void FrameTimings::EndFrame(const FrameStatistics& frame_statistics)
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const bool isSwapchainRecreated = m_swapchain_generation != m_context->m_swapchain_generation;
+		m_swapchain_generation = m_context->m_swapchain_generation;
+		if (m_window.frame_count++ == 0) m_window.first_frame = frame_statistics.frame_number;
+
+		if (m_last_frame_end.has_value())
+		{
+			const auto frameTime = now - *m_last_frame_end;
+			Record(CPU_FRAME, std::chrono::duration_cast<std::chrono::nanoseconds>(frameTime));
+
+			double referenceMedianMs = m_reference_median_ms;
+			if (referenceMedianMs == 0.0)
+			{
+				auto running = m_histograms[CPU_FRAME].Summarize();
+				if (running.count >= MIN_REFERENCE_FRAMES) referenceMedianMs = running.p50_ms;
+			}
+			const double frameTimeMs = std::chrono::duration<double, std::milli>(frameTime).count();
+			if (referenceMedianMs > 0.0 && frameTimeMs > HITCH_FACTOR * referenceMedianMs)
+			{
+				const bool hasPipelineCompiles = frame_statistics.pipelines_created > 0;
+				const bool hasAllocations = frame_statistics.buffer_allocations + frame_statistics.image_allocations > 0;
+				++m_window.hitches;
+				if (hasPipelineCompiles) ++m_window.hitches_with_pipeline_compiles;
+				if (hasAllocations) ++m_window.hitches_with_allocations;
+				if (isSwapchainRecreated) ++m_window.hitches_with_swapchain_recreation;
+				if (!hasPipelineCompiles && !hasAllocations && !isSwapchainRecreated) ++m_window.unattributed_hitches;
+				log::debug("Frame {} hitched: {:.2f} ms (Median {:.2f} ms){}{}{}", frame_statistics.frame_number, frameTimeMs, referenceMedianMs,
+					hasPipelineCompiles ? std::format(", {} pipelines created", frame_statistics.pipelines_created) : "",
+					hasAllocations ? std::format(", {} allocations", frame_statistics.buffer_allocations + frame_statistics.image_allocations) : "",
+					isSwapchainRecreated ? ", swap chain recreated" : "");
+			}
+		}
+		m_last_frame_end = now;
+
+		if (m_window.frame_count < m_window_frames) return;
+		m_window.cpu_frame = m_histograms[CPU_FRAME].Summarize();
+		m_window.gpu_frame = m_histograms[GPU_FRAME].Summarize();
+		m_window.acquire_wait = m_histograms[ACQUIRE_WAIT].Summarize();
+		m_window.present_wait = m_histograms[PRESENT_WAIT].Summarize();
+		if (m_window.cpu_frame.count > 0) m_reference_median_ms = m_window.cpu_frame.p50_ms;
+		{
+			std::scoped_lock guard{ m_last_window_mutex };
+			m_last_window = std::exchange(m_window, {});
+		}
+		for (auto& histogram : m_histograms) histogram.Reset();
+	}
+
+}} // namespace Albedo::RHI
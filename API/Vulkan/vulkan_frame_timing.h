@@ -0,0 +1,118 @@
+#pragma once
+
+#include "vulkan_stats.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Lock-free log-linear histogram of durations: Microsecond buckets, 16 per power of two (Percentiles within 6.25%)
+	class DurationHistogram
+	{
+	public:
+		struct Summary
+		{
+			uint64_t count = 0;
+			double p50_ms = 0.0; // Upper bounds of the buckets (Never above the maximum)
+			double p95_ms = 0.0;
+			double p99_ms = 0.0;
+			double max_ms = 0.0; // Exact
+		};
+		void Record(std::chrono::nanoseconds duration); // Wait-free (Any thread)
+		Summary Summarize() const; // Lock-free, records racing with it may be missing
+		void Reset(); // Records racing with it may survive
+
+	private:
+		static constexpr uint32_t SUB_BUCKET_BITS = 4;
+		static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+		static constexpr uint32_t MAX_BITS = 30; // Longer durations (~18 minutes) land in the last bucket
+		static constexpr uint32_t BUCKET_COUNT = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+		static uint32_t bucket_of(uint64_t microseconds);
+		static uint64_t bucket_upper_bound(uint32_t bucket); // Microseconds
+
+	private:
+		std::array<std::atomic<uint32_t>, BUCKET_COUNT> m_buckets{};
+		std::atomic<uint64_t> m_max_ns{ 0 };
+	};
+
+	// Frame timings of one window (FrameTimings::GetLastWindow())
+	struct FrameTimingWindow
+	{
+		uint64_t first_frame = 0; // RHIStatistics frame numbers
+		uint64_t frame_count = 0;
+		DurationHistogram::Summary cpu_frame;
+		DurationHistogram::Summary gpu_frame; // Empty without timestamps on the graphics queue (Or with device groups)
+		DurationHistogram::Summary acquire_wait;
+		DurationHistogram::Summary present_wait;
+		uint32_t hitches = 0;
+		uint32_t hitches_with_pipeline_compiles = 0; // A hitch counts for every coinciding cause
+		uint32_t hitches_with_allocations = 0;
+		uint32_t hitches_with_swapchain_recreation = 0;
+		uint32_t unattributed_hitches = 0;
+	};
+
+	// Frame-time Telemetry of a FrameContext (FrameContext::GetFrameTimings())
+	// Histograms of the CPU frame time (Period between the ends of consecutive frames), the GPU frame time (Timestamps around the frame's
+	// primary command buffer), and the acquire & present wait times, summarized every window of frames. A CPU frame longer than
+	// HITCH_FACTOR x the median of the last window is a hitch, attributed to the pipeline compiles, buffer & image allocations and swap chain
+	// recreations of the same frame (RHIStatistics counters of the frame).
+	class FrameTimings
+	{
+	public:
+		enum Metric
+		{
+			CPU_FRAME,
+			GPU_FRAME,
+			ACQUIRE_WAIT,
+			PRESENT_WAIT,
+			METRIC_COUNT
+		};
+		static constexpr double HITCH_FACTOR = 2.0;
+		static constexpr uint64_t MIN_REFERENCE_FRAMES = 16; // Until the first window ends, hitches are judged by the running median
+
+		const DurationHistogram& GetHistogram(Metric metric) const { return m_histograms[metric]; } // Of the current window (Lock-free)
+		FrameTimingWindow GetLastWindow() const; // Last completed window
+		void SetWindowFrames(uint32_t window_frames) { m_window_frames = std::max(window_frames, 1u); } // Frame thread
+
+		// Called by FrameContext (Frame thread)
+		void BeginGPUFrame(uint32_t frame_index, VkCommandBuffer command_buffer); // After the frame fence: resolves the last use of the slot
+		void EndGPUFrame(uint32_t frame_index, VkCommandBuffer command_buffer);
+		void Record(Metric metric, std::chrono::nanoseconds duration) { m_histograms[metric].Record(duration); }
+		void EndFrame(const FrameStatistics& frame_statistics); // After RHIStatistics::EndFrame() (CPU frame time, hitches and windows)
+
+	public:
+		FrameTimings() = delete;
+		FrameTimings(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight, uint32_t window_frames = 300);
+		~FrameTimings();
+		FrameTimings(const FrameTimings&) = delete;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::array<DurationHistogram, METRIC_COUNT> m_histograms;
+		uint32_t m_window_frames;
+
+		// GPU frame timestamps: Queries 2 * frame index & 2 * frame index + 1 (Null without timestamp support)
+		VkQueryPool m_query_pool = VK_NULL_HANDLE;
+		std::vector<bool> m_pending_queries; // Per frame slot, written by a submitted frame
+		double m_timestamp_period_ns = 0.0;
+		uint64_t m_timestamp_mask = 0;
+
+		std::optional<std::chrono::steady_clock::time_point> m_last_frame_end;
+		uint64_t m_swapchain_generation = 0;
+		double m_reference_median_ms = 0.0; // Of the last window (0: None yet)
+		FrameTimingWindow m_window; // Current (Counts only)
+
+		mutable std::mutex m_last_window_mutex; // Taken once per window by the frame thread
+		FrameTimingWindow m_last_window;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,260 @@
+#include "vulkan_geometry.h"
+#include "vulkan_context.h"
+
+#include <vk_mem_alloc.h>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		uint32_t get_index_size(VkIndexType index_type)
+		{
+			switch (index_type)
+			{
+			case VK_INDEX_TYPE_UINT8_EXT:	return 1;
+			case VK_INDEX_TYPE_UINT16:		return 2;
+			case VK_INDEX_TYPE_UINT32:		return 4;
+			default: throw std::runtime_error("Failed to create the Geometry Arena - Unsupported index type!");
+			}
+		}
+
+		constexpr ResourceAccess VertexInput
+		{
+			.stages = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+			.access = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT
+		};
+		constexpr ResourceAccess IndexInput
+		{
+			.stages = VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT,
+			.access = VK_ACCESS_2_INDEX_READ_BIT
+		};
+	}
+
+	GeometryArena::GeometryArena(std::shared_ptr<VulkanContext> vulkan_context, uint32_t vertex_stride, uint32_t vertex_capacity, uint32_t index_capacity,
+		VkIndexType index_type/* = VK_INDEX_TYPE_UINT32*/, VkBufferUsageFlags extra_usage/* = 0*/) :
+		m_context{ std::move(vulkan_context) },
+		m_vertex_stride{ vertex_stride },
+		m_index_size{ get_index_size(index_type) },
+		m_index_type{ index_type },
+		m_extra_usage{ extra_usage }
+	{
+		assert(vertex_stride > 0 && vertex_capacity > 0 && index_capacity > 0 && "Invalid layout of the Geometry Arena!");
+		create_buffers(vertex_capacity, index_capacity);
+	}
+
+	GeometryArena::~GeometryArena()
+	{
+		// Every mesh and pending release holds this arena
+		destroy_blocks();
+	}
+
+	std::shared_ptr<GeometryArena::Mesh> GeometryArena::
+		Allocate(uint32_t vertex_count, uint32_t index_count)
+	{
+		assert(vertex_count > 0 && "Cannot allocate a mesh without vertices!");
+		auto mesh = std::make_shared<Mesh>(shared_from_this());
+		mesh->m_vertex_count = vertex_count;
+		mesh->m_index_count = index_count;
+
+		std::scoped_lock guard{ m_mutex };
+		allocate_ranges(*mesh);
+		m_meshes.emplace(mesh.get());
+		return mesh;
+	}
+
+	void GeometryArena::UploadCommand(CommandBuffer& command_buffer, const Mesh& mesh,
+		std::span<const std::byte> vertices, std::span<const std::byte> indices, VMA::StagingRing& staging_ring)
+	{
+		assert(mesh.m_parent.get() == this && "The mesh belongs to another Geometry Arena!");
+		assert(vertices.size() <= static_cast<size_t>(mesh.m_vertex_count) * m_vertex_stride && "Too many vertices for the mesh!");
+		assert(indices.size() <= static_cast<size_t>(mesh.m_index_count) * m_index_size && "Too many indices for the mesh!");
+
+		const VkDeviceSize vertexOffset = static_cast<VkDeviceSize>(mesh.m_vertex_offset) * m_vertex_stride;
+		const VkDeviceSize indexOffset = static_cast<VkDeviceSize>(mesh.m_first_index) * m_index_size;
+		if (!vertices.empty())
+		{
+			m_vertex_buffer->UpdateCommand(command_buffer, vertices, vertexOffset, &staging_ring);
+			m_vertex_buffer->TransitionCommand(command_buffer, VertexInput, vertexOffset, vertices.size());
+		}
+		if (!indices.empty())
+		{
+			m_index_buffer->UpdateCommand(command_buffer, indices, indexOffset, &staging_ring);
+			m_index_buffer->TransitionCommand(command_buffer, IndexInput, indexOffset, indices.size());
+		}
+	}
+
+	void GeometryArena::BindCommand(CommandBuffer& command_buffer, uint32_t vertex_binding/* = 0*/)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		command_buffer.BindVertexBuffers(vertex_binding, { *m_vertex_buffer }, { 0 });
+		command_buffer.BindIndexBuffer(*m_index_buffer, 0, m_index_type);
+	}
+
+	void GeometryArena::CompactCommand(CommandBuffer& command_buffer, uint32_t vertex_capacity/* = 0*/, uint32_t index_capacity/* = 0*/)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		std::scoped_lock guard{ m_mutex };
+		vertex_capacity = vertex_capacity ? vertex_capacity : m_vertex_capacity;
+		index_capacity = index_capacity ? index_capacity : m_index_capacity;
+
+		// Packed in the order of the old vertex ranges, so neighbouring meshes become one copy region
+		std::vector<Mesh*> meshes{ m_meshes.begin(), m_meshes.end() };
+		std::sort(meshes.begin(), meshes.end(), [](const Mesh* lhs, const Mesh* rhs) { return lhs->m_vertex_offset < rhs->m_vertex_offset; });
+		uint64_t vertexCount = 0, indexCount = 0;
+		for (const auto* mesh : meshes)
+		{
+			vertexCount += mesh->m_vertex_count;
+			indexCount += mesh->m_index_count;
+		}
+		if (vertexCount > vertex_capacity || indexCount > index_capacity)
+			throw std::runtime_error(std::format("Failed to compact the Geometry Arena - {} vertices and {} indices do not fit into {} and {}!",
+				vertexCount, indexCount, vertex_capacity, index_capacity));
+
+		// The old buffers are still read by the frames in flight, and released with the last reference
+		auto oldVertexBuffer = std::move(m_vertex_buffer);
+		auto oldIndexBuffer = std::move(m_index_buffer);
+		destroy_blocks();
+		create_buffers(vertex_capacity, index_capacity);
+		++m_generation;
+
+		std::vector<VkBufferCopy> vertexCopies, indexCopies;
+		vertexCopies.reserve(meshes.size());
+		indexCopies.reserve(meshes.size());
+		for (auto* mesh : meshes)
+		{
+			const uint32_t oldVertexOffset = mesh->m_vertex_offset, oldFirstIndex = mesh->m_first_index;
+			allocate_ranges(*mesh);
+			vertexCopies.emplace_back(VkBufferCopy
+				{
+					.srcOffset = static_cast<VkDeviceSize>(oldVertexOffset) * m_vertex_stride,
+					.dstOffset = static_cast<VkDeviceSize>(mesh->m_vertex_offset) * m_vertex_stride,
+					.size = static_cast<VkDeviceSize>(mesh->m_vertex_count) * m_vertex_stride
+				});
+			if (mesh->m_index_count) indexCopies.emplace_back(VkBufferCopy
+				{
+					.srcOffset = static_cast<VkDeviceSize>(oldFirstIndex) * m_index_size,
+					.dstOffset = static_cast<VkDeviceSize>(mesh->m_first_index) * m_index_size,
+					.size = static_cast<VkDeviceSize>(mesh->m_index_count) * m_index_size
+				});
+		}
+
+		const ResourceAccess copySource{ .stages = VK_PIPELINE_STAGE_2_COPY_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT };
+		const ResourceAccess copyDestination{ .stages = VK_PIPELINE_STAGE_2_COPY_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT };
+		oldVertexBuffer->TransitionCommand(command_buffer, copySource);
+		oldIndexBuffer->TransitionCommand(command_buffer, copySource);
+		m_vertex_buffer->TransitionCommand(command_buffer, copyDestination);
+		m_index_buffer->TransitionCommand(command_buffer, copyDestination);
+		oldVertexBuffer->CopyCommand(command_buffer, *m_vertex_buffer, vertexCopies);
+		oldIndexBuffer->CopyCommand(command_buffer, *m_index_buffer, indexCopies);
+		m_vertex_buffer->TransitionCommand(command_buffer, VertexInput);
+		m_index_buffer->TransitionCommand(command_buffer, IndexInput);
+	}
+
+	size_t GeometryArena::GetMeshCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_meshes.size();
+	}
+
+	void GeometryArena::create_buffers(uint32_t vertex_capacity, uint32_t index_capacity)
+	{
+		constexpr VkBufferUsageFlags copyUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		auto& allocator = m_context->m_memory_allocator;
+		m_vertex_buffer = allocator->AllocateBuffer(static_cast<size_t>(vertex_capacity) * m_vertex_stride,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | copyUsage | m_extra_usage);
+		m_index_buffer = allocator->AllocateBuffer(static_cast<size_t>(index_capacity) * m_index_size,
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | copyUsage | m_extra_usage);
+		if constexpr (EnableDebugMarkers)
+		{
+			m_vertex_buffer->SetDebugName(std::format("Geometry Arena Vertices (Generation {})", m_generation + 1).c_str());
+			m_index_buffer->SetDebugName(std::format("Geometry Arena Indices (Generation {})", m_generation + 1).c_str());
+		}
+
+		// Virtual blocks in units of vertices and indices, so every offset is a valid vertexOffset / firstIndex
+		VmaVirtualBlockCreateInfo vertexBlockCreateInfo{ .size = vertex_capacity };
+		VmaVirtualBlockCreateInfo indexBlockCreateInfo{ .size = index_capacity };
+		if (vmaCreateVirtualBlock(&vertexBlockCreateInfo, &m_vertex_block) != VK_SUCCESS ||
+			vmaCreateVirtualBlock(&indexBlockCreateInfo, &m_index_block) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the virtual blocks of the Geometry Arena!");
+		m_vertex_capacity = vertex_capacity;
+		m_index_capacity = index_capacity;
+	}
+
+	void GeometryArena::destroy_blocks()
+	{
+		// Live ranges are either repacked or retired, and the retired ones are skipped by release()
+		for (auto* block : { &m_vertex_block, &m_index_block })
+		{
+			if (*block == VK_NULL_HANDLE) continue;
+			vmaClearVirtualBlock(*block);
+			vmaDestroyVirtualBlock(*block);
+			*block = VK_NULL_HANDLE;
+		}
+	}
+
+	void GeometryArena::allocate_ranges(Mesh& mesh)
+	{
+		VmaVirtualAllocationCreateInfo vertexCreateInfo{ .size = mesh.m_vertex_count };
+		VkDeviceSize vertexOffset = 0;
+		if (vmaVirtualAllocate(m_vertex_block, &vertexCreateInfo, &mesh.m_vertex_allocation, &vertexOffset) != VK_SUCCESS)
+			throw std::runtime_error(std::format("Failed to allocate {} vertices from the Geometry Arena - It is exhausted or fragmented!", mesh.m_vertex_count));
+
+		VkDeviceSize indexOffset = 0;
+		mesh.m_index_allocation = VK_NULL_HANDLE;
+		if (mesh.m_index_count)
+		{
+			VmaVirtualAllocationCreateInfo indexCreateInfo{ .size = mesh.m_index_count };
+			if (vmaVirtualAllocate(m_index_block, &indexCreateInfo, &mesh.m_index_allocation, &indexOffset) != VK_SUCCESS)
+			{
+				vmaVirtualFree(m_vertex_block, mesh.m_vertex_allocation);
+				mesh.m_vertex_allocation = VK_NULL_HANDLE;
+				throw std::runtime_error(std::format("Failed to allocate {} indices from the Geometry Arena - It is exhausted or fragmented!", mesh.m_index_count));
+			}
+		}
+		mesh.m_vertex_offset = static_cast<uint32_t>(vertexOffset);
+		mesh.m_first_index = static_cast<uint32_t>(indexOffset);
+	}
+
+	void GeometryArena::retire(Mesh& mesh)
+	{
+		uint32_t generation = 0;
+		{
+			std::scoped_lock guard{ m_mutex };
+			m_meshes.erase(&mesh);
+			generation = m_generation;
+		}
+		m_context->DeferDeletion([arena = mesh.m_parent, vertex = mesh.m_vertex_allocation, index = mesh.m_index_allocation, generation]()
+			{ arena->release(vertex, index, generation); });
+	}
+
+	void GeometryArena::release(VmaVirtualAllocation vertex_allocation, VmaVirtualAllocation index_allocation, uint32_t generation)
+	{
+		std::scoped_lock guard{ m_mutex };
+		if (generation != m_generation) return; // Its blocks were cleared by a compaction
+		vmaVirtualFree(m_vertex_block, vertex_allocation);
+		if (index_allocation != VK_NULL_HANDLE) vmaVirtualFree(m_index_block, index_allocation);
+	}
+
+	VkDrawIndexedIndirectCommand GeometryArena::Mesh::
+		GetDrawCommand(uint32_t instance_count/* = 1*/, uint32_t first_instance/* = 0*/) const
+	{
+		return VkDrawIndexedIndirectCommand
+		{
+			.indexCount = m_index_count,
+			.instanceCount = instance_count,
+			.firstIndex = m_first_index,
+			.vertexOffset = static_cast<int32_t>(m_vertex_offset),
+			.firstInstance = first_instance
+		};
+	}
+
+	GeometryArena::Mesh::~Mesh()
+	{
+		if (m_vertex_allocation == VK_NULL_HANDLE) return; // Failed allocation
+		m_parent->retire(*this);
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Geometry Arena: Vertices and indices of many meshes in one vertex and one index buffer, suballocated by TLSF virtual blocks
+	// in units of vertices and indices. Draws bind the arena once and select their mesh by vertexOffset / firstIndex
+	// (GetDrawCommand(), e.g. the arguments of an IndirectDrawBuffer), so a whole scene can be drawn by a single multi-draw.
+	// Offsets are stable until CompactCommand(), which repacks the live meshes into new buffers and bumps GetGeneration().
+	class GeometryArena : public std::enable_shared_from_this<GeometryArena>
+	{
+	public:
+		class Mesh
+		{
+			friend class GeometryArena;
+		public:
+			uint32_t GetVertexOffset() const { return m_vertex_offset; } // vertexOffset (In vertices)
+			uint32_t GetFirstIndex() const { return m_first_index; }
+			uint32_t GetVertexCount() const { return m_vertex_count; }
+			uint32_t GetIndexCount() const { return m_index_count; }
+			VkDrawIndexedIndirectCommand GetDrawCommand(uint32_t instance_count = 1, uint32_t first_instance = 0) const;
+
+		public:
+			Mesh() = delete;
+			Mesh(std::shared_ptr<GeometryArena> parent) : m_parent{ std::move(parent) } {};
+			~Mesh(); // Its ranges are released after the frames in flight
+			Mesh(const Mesh&) = delete;
+
+		private:
+			std::shared_ptr<GeometryArena> m_parent;
+			VmaVirtualAllocation m_vertex_allocation = VK_NULL_HANDLE;
+			VmaVirtualAllocation m_index_allocation = VK_NULL_HANDLE;
+			uint32_t m_vertex_offset = 0;
+			uint32_t m_first_index = 0;
+			uint32_t m_vertex_count = 0;
+			uint32_t m_index_count = 0;
+		};
+
+		// Thread-safe, throws if the arena is exhausted (CompactCommand() it, optionally into larger buffers)
+		std::shared_ptr<Mesh> Allocate(uint32_t vertex_count, uint32_t index_count);
+		// Vertices (GetVertexStride() bytes each) and indices of the mesh through Buffer::UpdateCommand() (Large meshes are copied from
+		// the staging ring), then both ranges are transitioned for vertex input. Record it outside render passes.
+		void UploadCommand(CommandBuffer& command_buffer, const Mesh& mesh, std::span<const std::byte> vertices, std::span<const std::byte> indices,
+			VMA::StagingRing& staging_ring);
+		void BindCommand(CommandBuffer& command_buffer, uint32_t vertex_binding = 0); // Vertex & index buffers of the arena
+
+		// Repack the live meshes to the front of new buffers (0: Keep the capacity) with one multi-region copy per buffer, the old buffers
+		// are released after the frames in flight. Offsets of the meshes are rewritten, so rebuild the draw arguments recorded with the
+		// last generation. Not thread-safe against draws being recorded with the arena.
+		void CompactCommand(CommandBuffer& command_buffer, uint32_t vertex_capacity = 0, uint32_t index_capacity = 0);
+
+		std::shared_ptr<VMA::Buffer> GetVertexBuffer() { return m_vertex_buffer; }
+		std::shared_ptr<VMA::Buffer> GetIndexBuffer() { return m_index_buffer; }
+		uint32_t GetVertexStride() const { return m_vertex_stride; }
+		VkIndexType GetIndexType() const { return m_index_type; }
+		uint32_t GetVertexCapacity() const { return m_vertex_capacity; }
+		uint32_t GetIndexCapacity() const { return m_index_capacity; }
+		uint32_t GetGeneration() const { return m_generation; } // Incremented by every compaction
+		size_t GetMeshCount();
+
+	public:
+		GeometryArena() = delete;
+		// extra_usage: e.g. STORAGE_BUFFER (Mesh shaders, compute skinning) or acceleration structure build inputs
+		GeometryArena(std::shared_ptr<VulkanContext> vulkan_context, uint32_t vertex_stride, uint32_t vertex_capacity, uint32_t index_capacity,
+			VkIndexType index_type = VK_INDEX_TYPE_UINT32, VkBufferUsageFlags extra_usage = 0);
+		~GeometryArena();
+		GeometryArena(const GeometryArena&) = delete;
+
+	private:
+		void create_buffers(uint32_t vertex_capacity, uint32_t index_capacity); // And their virtual blocks
+		void destroy_blocks();
+		void allocate_ranges(Mesh& mesh); // Locked by the caller
+		void retire(Mesh& mesh); // Unregistered now, its ranges are freed after the frames in flight
+		void release(VmaVirtualAllocation vertex_allocation, VmaVirtualAllocation index_allocation, uint32_t generation); // Skipped if compacted meanwhile
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const uint32_t m_vertex_stride;
+		const uint32_t m_index_size;
+		const VkIndexType m_index_type;
+		const VkBufferUsageFlags m_extra_usage;
+		uint32_t m_vertex_capacity = 0;
+		uint32_t m_index_capacity = 0;
+		uint32_t m_generation = 0;
+
+		std::shared_ptr<VMA::Buffer> m_vertex_buffer;
+		std::shared_ptr<VMA::Buffer> m_index_buffer;
+		std::mutex m_mutex;
+		VmaVirtualBlock m_vertex_block = VK_NULL_HANDLE;
+		VmaVirtualBlock m_index_block = VK_NULL_HANDLE;
+		std::unordered_set<Mesh*> m_meshes; // Live meshes (Repacked by CompactCommand())
+	};
+
+}} // namespace Albedo::RHI
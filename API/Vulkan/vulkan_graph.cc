@@ -0,0 +1,940 @@
+#include "vulkan_graph.h"
+#include "vulkan_context.h"
+#include "vulkan_hash.h"
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		struct UsageInfo
+		{
+			VkPipelineStageFlags2	stages;
+			VkAccessFlags2			read_access;
+			VkAccessFlags2			write_access;
+			VkImageLayout				layout; // Images only
+		};
+
+		constexpr std::array<UsageInfo, static_cast<size_t>(RenderGraph::Usage::MAX_USAGE)> USAGE_INFOS
+		{{
+			// COLOR_ATTACHMENT
+			{ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+			// DEPTH_STENCIL_ATTACHMENT
+			{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL },
+			// DEPTH_STENCIL_READ
+			{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL },
+			// SAMPLED_GRAPHICS
+			{ VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			// SAMPLED_COMPUTE
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			// STORAGE_GRAPHICS
+			{ VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+			// STORAGE_COMPUTE
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+			// UNIFORM_GRAPHICS
+			{ VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_UNIFORM_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED },
+			// UNIFORM_COMPUTE
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				VK_ACCESS_2_UNIFORM_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED },
+			// VERTEX_BUFFER
+			{ VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+				VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED },
+			// INDEX_BUFFER
+			{ VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT,
+				VK_ACCESS_2_INDEX_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED },
+			// INDIRECT_BUFFER
+			{ VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+				VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED },
+			// TRANSFER_SRC
+			{ VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+				VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+			// TRANSFER_DST
+			{ VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+				VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+		}};
+	}
+
+	RenderGraph::RenderGraph(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight) :
+		m_context{ std::move(vulkan_context) },
+		m_graphics_family{ m_context->m_device_queue_family_graphics.value() },
+		m_frame_pools(frames_in_flight)
+	{
+		assert(frames_in_flight > 0 && "Render Graph needs at least one frame in flight!");
+	}
+
+	void RenderGraph::Reset(uint32_t frame_index)
+	{
+		m_frame_index = frame_index % static_cast<uint32_t>(m_frame_pools.size());
+		m_passes.clear();
+		m_resources.clear();
+		m_order.clear();
+		m_is_compiled = false;
+		m_is_plan_cached = false;
+		m_culled_pass_count = 0;
+		++m_reset_count;
+
+		// The fence of this frame slot has signaled, so the previous use of its physical resources is complete
+		auto& framePool = m_frame_pools[m_frame_index];
+		for (auto& physical_image : framePool.images) { physical_image.state = {}; physical_image.busy_until = 0; }
+		for (auto& physical_buffer : framePool.buffers) { physical_buffer.state = {}; physical_buffer.busy_until = 0; }
+		retire_stale();
+	}
+
+	RenderGraph::Handle RenderGraph::
+		ImportImage(std::string_view name, std::shared_ptr<VMA::Image> image, VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_UNDEFINED*/)
+	{
+		Resource resource
+		{
+			.name = std::string(name),
+			.is_image = true,
+			.is_imported = true,
+			.image = *image,
+			.image_view = image->GetImageView(),
+			.aspect = GetFormatAspect(image->m_image_format),
+			.final_layout = final_layout
+		};
+		resource.state = State
+		{
+			.layout = image->GetImageLayout(),
+			.family = m_graphics_family,
+			.write_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, // Unknown previous use
+			.write_access = VK_ACCESS_2_MEMORY_WRITE_BIT
+		};
+		resource.imported_image = std::move(image);
+		m_resources.emplace_back(std::move(resource));
+		return static_cast<Handle>(m_resources.size() - 1);
+	}
+
+	RenderGraph::Handle RenderGraph::
+		ImportImage(std::string_view name, VkImage image, VkImageView image_view, VkImageAspectFlags aspect,
+			VkImageLayout current_layout, VkImageLayout final_layout)
+	{
+		Resource resource
+		{
+			.name = std::string(name),
+			.is_image = true,
+			.is_imported = true,
+			.image = image,
+			.image_view = image_view,
+			.aspect = aspect,
+			.final_layout = final_layout
+		};
+		resource.state = State
+		{
+			.layout = current_layout,
+			.family = m_graphics_family,
+			.write_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.write_access = VK_ACCESS_2_MEMORY_WRITE_BIT
+		};
+		m_resources.emplace_back(std::move(resource));
+		return static_cast<Handle>(m_resources.size() - 1);
+	}
+
+	RenderGraph::Handle RenderGraph::
+		ImportBuffer(std::string_view name, std::shared_ptr<VMA::Buffer> buffer)
+	{
+		Resource resource
+		{
+			.name = std::string(name),
+			.is_image = false,
+			.is_imported = true,
+			.buffer = *buffer
+		};
+		resource.state = State
+		{
+			.family = m_graphics_family,
+			.write_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.write_access = VK_ACCESS_2_MEMORY_WRITE_BIT
+		};
+		resource.imported_buffer = std::move(buffer);
+		m_resources.emplace_back(std::move(resource));
+		return static_cast<Handle>(m_resources.size() - 1);
+	}
+
+	void RenderGraph::AddPass(std::string_view name, Queue queue, const SetupFunction& setup, ExecuteFunction execute)
+	{
+		assert(!m_is_compiled && "You cannot AddPass() after Compile(), Reset() the graph first!");
+		m_passes.emplace_back(Pass
+			{
+				.name = std::string(name),
+				.queue = queue,
+				.family = m_graphics_family,
+				.execute = std::move(execute)
+			});
+		PassBuilder builder{ *this, static_cast<uint32_t>(m_passes.size() - 1) };
+		setup(builder);
+	}
+
+	RenderGraph::Handle RenderGraph::PassBuilder::
+		CreateImage(std::string_view name, const ImageDescription& description)
+	{
+		m_graph.m_resources.emplace_back(Resource
+			{
+				.name = std::string(name),
+				.is_image = true,
+				.is_imported = false,
+				.image_description = description,
+				.aspect = description.aspect
+			});
+		return static_cast<Handle>(m_graph.m_resources.size() - 1);
+	}
+
+	RenderGraph::Handle RenderGraph::PassBuilder::
+		CreateBuffer(std::string_view name, const BufferDescription& description)
+	{
+		m_graph.m_resources.emplace_back(Resource
+			{
+				.name = std::string(name),
+				.is_image = false,
+				.is_imported = false,
+				.buffer_description = description
+			});
+		return static_cast<Handle>(m_graph.m_resources.size() - 1);
+	}
+
+	RenderGraph::Handle RenderGraph::PassBuilder::Read(Handle resource, Usage usage)
+	{
+		m_graph.add_access(m_pass, resource, usage, false);
+		return resource;
+	}
+
+	RenderGraph::Handle RenderGraph::PassBuilder::Write(Handle resource, Usage usage)
+	{
+		m_graph.add_access(m_pass, resource, usage, true);
+		return resource;
+	}
+
+	void RenderGraph::PassBuilder::SetSideEffects()
+	{
+		m_graph.m_passes[m_pass].has_side_effects = true;
+	}
+
+	void RenderGraph::add_access(uint32_t pass, Handle resource, Usage usage, bool is_write)
+	{
+		assert(resource < m_resources.size() && "Invalid Render Graph resource handle!");
+		const auto& usageInfo = USAGE_INFOS[static_cast<size_t>(usage)];
+		assert((!is_write || usageInfo.write_access != VK_ACCESS_2_NONE) && "This usage cannot be written!");
+		assert((m_resources[resource].is_image || usageInfo.layout == VK_IMAGE_LAYOUT_UNDEFINED ||
+			usage == Usage::STORAGE_GRAPHICS || usage == Usage::STORAGE_COMPUTE ||
+			usage == Usage::TRANSFER_SRC || usage == Usage::TRANSFER_DST) && "This usage is for images only!");
+
+		VkAccessFlags2 access = usageInfo.read_access | (is_write ? usageInfo.write_access : VK_ACCESS_2_NONE);
+		if (access == VK_ACCESS_2_NONE) access = usageInfo.write_access; // TRANSFER_DST
+
+		auto& accesses = m_passes[pass].accesses;
+		auto target = std::find_if(accesses.begin(), accesses.end(), [resource](const Access& access) { return access.resource == resource; });
+		if (target == accesses.end())
+		{
+			accesses.emplace_back(Access
+				{
+					.resource = resource,
+					.stages = usageInfo.stages,
+					.access = access,
+					.layout = usageInfo.layout,
+					.is_read = !is_write,
+					.is_write = is_write
+				});
+			return;
+		}
+		// Merge different usages of the same resource in one pass
+		target->stages |= usageInfo.stages;
+		target->access |= access;
+		if (target->layout != usageInfo.layout) target->layout = VK_IMAGE_LAYOUT_GENERAL;
+		target->is_read |= !is_write;
+		target->is_write |= is_write;
+	}
+
+	void RenderGraph::Compile()
+	{
+		assert(!m_is_compiled && "You cannot Compile() a Render Graph twice, Reset() it first!");
+		ALBEDO_RHI_TRACE_ZONE("RHI::RenderGraph::Compile");
+		make_topology_key(m_topology_key);
+		const uint64_t topology = HashBytes(m_topology_key.data(), m_topology_key.size() * sizeof(uint64_t));
+		auto [target, isInserted] = m_plans.try_emplace(topology);
+		auto& plan = target->second;
+		m_is_plan_cached = !isInserted && plan.topology_key == m_topology_key;
+		if (m_is_plan_cached) apply_plan(plan);
+		else
+		{
+			if (!isInserted) plan = Plan{}; // Hash collision, the other topology compiles again on its next use
+			cull_passes();
+			assign_queues();
+			store_plan(plan);
+			plan.topology_key = m_topology_key;
+		}
+		plan.used_reset = m_reset_count;
+
+		// Physical resources are assigned once per frame slot, then only patched in (Until the pool retires resources)
+		auto& assignment = plan.assignments[m_frame_index];
+		const auto& framePool = m_frame_pools[m_frame_index];
+		if (assignment.is_assigned && assignment.pool_generation == framePool.generation) patch_physical_resources(assignment);
+		else
+		{
+			assign_physical_resources();
+			assignment.is_assigned = true;
+			assignment.pool_generation = framePool.generation;
+			assignment.physicals.resize(m_resources.size());
+			for (Handle handle = 0; handle < m_resources.size(); ++handle) assignment.physicals[handle] = m_resources[handle].physical;
+		}
+		m_is_compiled = true;
+	}
+
+	void RenderGraph::make_topology_key(std::vector<uint64_t>& key) const
+	{
+		// Everything the compilation depends on (Imported handles & layouts are patched in by Execute())
+		key.clear();
+		auto append = [&key](auto... values) { (key.emplace_back(static_cast<uint64_t>(values)), ...); };
+		append(m_passes.size(), m_resources.size());
+		for (const auto& resource : m_resources)
+		{
+			append(resource.is_image, resource.is_imported);
+			if (resource.is_imported) continue;
+			if (resource.is_image)
+			{
+				const auto& description = resource.image_description;
+				append(description.width, description.height, description.format, description.usage, description.aspect, description.samples);
+			}
+			else append(resource.buffer_description.size, resource.buffer_description.usage);
+		}
+		for (const auto& pass : m_passes)
+		{
+			append(pass.queue, pass.has_side_effects, pass.accesses.size());
+			for (const auto& access : pass.accesses)
+				append(access.resource, access.stages, access.access, access.layout, access.is_read, access.is_write);
+		}
+	}
+
+	void RenderGraph::store_plan(Plan& plan) const
+	{
+		plan.order = m_order;
+		plan.pass_families.resize(m_passes.size());
+		plan.prologue_passes.resize(m_passes.size());
+		for (size_t index = 0; index < m_passes.size(); ++index)
+		{
+			plan.pass_families[index] = m_passes[index].family;
+			plan.prologue_passes[index] = m_passes[index].is_prologue;
+		}
+		plan.resources.resize(m_resources.size());
+		for (size_t index = 0; index < m_resources.size(); ++index)
+		{
+			const auto& resource = m_resources[index];
+			plan.resources[index] = { .first_use = resource.first_use, .last_use = resource.last_use, .async_family = resource.async_family };
+		}
+		plan.assignments.resize(m_frame_pools.size());
+	}
+
+	void RenderGraph::apply_plan(const Plan& plan)
+	{
+		m_order = plan.order;
+		for (size_t index = 0; index < m_passes.size(); ++index)
+		{
+			m_passes[index].family = plan.pass_families[index];
+			m_passes[index].is_prologue = plan.prologue_passes[index];
+			m_passes[index].is_culled = true;
+		}
+		for (auto index : m_order) m_passes[index].is_culled = false;
+		m_culled_pass_count = m_passes.size() - m_order.size();
+		for (size_t index = 0; index < m_resources.size(); ++index)
+		{
+			auto& resource = m_resources[index];
+			const auto& resourcePlan = plan.resources[index];
+			resource.first_use = resourcePlan.first_use;
+			resource.last_use = resourcePlan.last_use;
+			resource.async_family = resourcePlan.async_family;
+		}
+	}
+
+	void RenderGraph::patch_physical_resources(const Plan::Assignment& assignment)
+	{
+		auto& framePool = m_frame_pools[m_frame_index];
+		for (Handle handle = 0; handle < m_resources.size(); ++handle)
+		{
+			auto& resource = m_resources[handle];
+			if (resource.is_imported || resource.first_use == INVALID_HANDLE) continue;
+			resource.physical = assignment.physicals[handle];
+			resource.is_discarded = true;
+			if (resource.is_image) framePool.images[resource.physical].used_reset = m_reset_count;
+			else framePool.buffers[resource.physical].used_reset = m_reset_count;
+		}
+	}
+
+	void RenderGraph::retire_stale()
+	{
+		std::erase_if(m_plans, [this](const auto& plan) { return plan.second.used_reset + RETIREMENT_RESETS < m_reset_count; });
+
+		// e.g. Render targets of the previous window size (Retired slots keep the indices of the others stable)
+		auto& framePool = m_frame_pools[m_frame_index];
+		bool isRetired = false;
+		for (auto& physical_image : framePool.images)
+		{
+			if (!physical_image.image || physical_image.used_reset + RETIREMENT_RESETS >= m_reset_count) continue;
+			physical_image = {}; // Released through the deletion queue
+			isRetired = true;
+		}
+		for (auto& physical_buffer : framePool.buffers)
+		{
+			if (!physical_buffer.buffer || physical_buffer.used_reset + RETIREMENT_RESETS >= m_reset_count) continue;
+			physical_buffer = {};
+			isRetired = true;
+		}
+		if (isRetired) ++framePool.generation;
+	}
+
+	void RenderGraph::cull_passes()
+	{
+		// Walk backwards from the passes with visible results
+		std::vector<bool> isNeeded(m_resources.size(), false);
+		for (size_t index = m_passes.size(); index-- > 0;)
+		{
+			auto& pass = m_passes[index];
+			bool isPassNeeded = pass.has_side_effects;
+			for (const auto& access : pass.accesses)
+			{
+				if (access.is_write && (m_resources[access.resource].is_imported || isNeeded[access.resource]))
+					isPassNeeded = true;
+			}
+			pass.is_culled = !isPassNeeded;
+			if (pass.is_culled) continue;
+
+			for (const auto& access : pass.accesses)
+				if (access.is_write && !access.is_read) isNeeded[access.resource] = false; // Earlier contents are discarded
+			for (const auto& access : pass.accesses)
+				if (access.is_read) isNeeded[access.resource] = true;
+		}
+
+		for (uint32_t index = 0; index < m_passes.size(); ++index)
+			if (!m_passes[index].is_culled) m_order.emplace_back(index);
+		m_culled_pass_count = m_passes.size() - m_order.size();
+	}
+
+	uint32_t RenderGraph::resolve_family(Queue queue) const
+	{
+		auto& transferFamily = m_context->m_device_queue_family_transfer;
+		auto& computeFamily = m_context->m_device_queue_family_compute;
+		switch (queue)
+		{
+		case Queue::TRANSFER:
+			if (transferFamily.has_value()) return transferFamily.value();
+			break;
+		case Queue::COMPUTE:
+			if (computeFamily.has_value()) return computeFamily.value();
+			break;
+		default: break;
+		}
+		return m_graphics_family;
+	}
+
+	QueueFamilyIndex& RenderGraph::get_family_index(uint32_t family)
+	{
+		if (m_context->m_device_queue_family_transfer == family) return m_context->m_device_queue_family_transfer;
+		if (m_context->m_device_queue_family_compute == family) return m_context->m_device_queue_family_compute;
+		return m_context->m_device_queue_family_graphics;
+	}
+
+	void RenderGraph::assign_queues()
+	{
+		// Submitted as prologue (Graphics) -> async passes -> graphics passes, so async passes overlap the graphics passes they are independent of
+		for (auto index : m_order) m_passes[index].is_prologue = false;
+		for (uint32_t order = 0; order < m_order.size(); ++order)
+		{
+			auto& pass = m_passes[m_order[order]];
+			uint32_t family = resolve_family(pass.queue);
+			if (family != m_graphics_family && !schedule_async(order, family)) family = m_graphics_family;
+			pass.family = family;
+
+			for (const auto& access : pass.accesses)
+			{
+				auto& resource = m_resources[access.resource];
+				if (resource.first_use == INVALID_HANDLE) resource.first_use = order;
+				resource.last_use = order;
+				if (family != m_graphics_family) resource.async_family = family;
+			}
+		}
+	}
+
+	bool RenderGraph::schedule_async(uint32_t order, uint32_t family)
+	{
+		// Async passes and their prologue only touch transient resources of one async queue (Imported states belong to the graphics queue)
+		auto isAsyncEligible = [this, family](const Access& access)
+		{
+			const auto& resource = m_resources[access.resource];
+			return !resource.is_imported && (resource.async_family == VK_QUEUE_FAMILY_IGNORED || resource.async_family == family);
+		};
+		const auto& pass = m_passes[m_order[order]];
+		if (!std::all_of(pass.accesses.begin(), pass.accesses.end(), isAsyncEligible)) return false;
+
+		// Earlier graphics passes sharing a resource with a writer on either side, transitively (Reads of both sides do not order them)
+		auto isDependent = [](const Pass& earlier, const Pass& later)
+		{
+			for (const auto& access : later.accesses)
+			{
+				auto target = std::find_if(earlier.accesses.begin(), earlier.accesses.end(),
+					[&access](const Access& earlier_access) { return earlier_access.resource == access.resource; });
+				if (target != earlier.accesses.end() && (target->is_write || access.is_write)) return true;
+			}
+			return false;
+		};
+		ScratchScope scratch;
+		std::pmr::vector<uint32_t> prologue{ scratch.Resource() };
+		std::pmr::vector<uint32_t> pending{ scratch.Resource() };
+		pending.emplace_back(order);
+		std::pmr::vector<bool> isAdded(order, false, scratch.Resource());
+		while (!pending.empty())
+		{
+			const uint32_t dependentOrder = pending.back();
+			pending.pop_back();
+			const auto& dependent = m_passes[m_order[dependentOrder]];
+			for (uint32_t earlierOrder = 0; earlierOrder < dependentOrder; ++earlierOrder)
+			{
+				const auto& earlier = m_passes[m_order[earlierOrder]];
+				if (earlier.family != m_graphics_family || earlier.is_prologue || isAdded[earlierOrder] || !isDependent(earlier, dependent)) continue;
+				// A prologue pass cannot consume async results (They are submitted after it)
+				if (!std::all_of(earlier.accesses.begin(), earlier.accesses.end(), [this](const Access& access)
+					{ const auto& resource = m_resources[access.resource]; return !resource.is_imported && resource.async_family == VK_QUEUE_FAMILY_IGNORED; }))
+					return false;
+				isAdded[earlierOrder] = true;
+				prologue.emplace_back(earlierOrder);
+				pending.emplace_back(earlierOrder);
+			}
+		}
+		for (auto prologueOrder : prologue) m_passes[m_order[prologueOrder]].is_prologue = true;
+		return true;
+	}
+
+	void RenderGraph::assign_physical_resources()
+	{
+		std::vector<Handle> transients;
+		for (Handle handle = 0; handle < m_resources.size(); ++handle)
+		{
+			auto& resource = m_resources[handle];
+			if (resource.is_imported) continue;
+			if (resource.first_use == INVALID_HANDLE) continue; // Only used by culled passes
+			resource.is_discarded = true;
+			transients.emplace_back(handle);
+		}
+		std::sort(transients.begin(), transients.end(),
+			[this](Handle lhs, Handle rhs) { return m_resources[lhs].first_use < m_resources[rhs].first_use; });
+
+		// Resources of async & prologue passes run out of the compiled order, so they never share a physical resource in a frame
+		std::vector<bool> isPinned(m_resources.size(), false);
+		for (auto index : m_order)
+		{
+			const auto& pass = m_passes[index];
+			if (pass.family == m_graphics_family && !pass.is_prologue) continue;
+			for (const auto& access : pass.accesses) isPinned[access.resource] = true;
+		}
+
+		// Alias physical resources whose previous lifetime has ended
+		auto& framePool = m_frame_pools[m_frame_index];
+		for (auto handle : transients)
+		{
+			auto& resource = m_resources[handle];
+			const uint32_t firstUse = isPinned[handle] ? 0 : resource.first_use; // Pinned ones only take unused resources
+			const uint32_t busyUntil = isPinned[handle] ? std::numeric_limits<uint32_t>::max() : resource.last_use + 1;
+
+			if (resource.is_image)
+			{
+				auto& images = framePool.images;
+				auto target = std::find_if(images.begin(), images.end(), [&resource, firstUse](const PhysicalImage& physical)
+					{ return physical.image && physical.description == resource.image_description && physical.busy_until <= firstUse; });
+				if (target == images.end())
+				{
+					const auto& description = resource.image_description;
+					target = std::find_if(images.begin(), images.end(), [](const PhysicalImage& physical) { return !physical.image; });
+					if (target == images.end()) target = images.emplace(images.end());
+					*target = PhysicalImage
+						{
+							.description = description,
+							.image = (description.samples != VK_SAMPLE_COUNT_1_BIT)?
+								m_context->m_memory_allocator->AllocateMultisampledAttachment(description.aspect, description.usage,
+									description.width, description.height, description.format, description.samples) :
+								m_context->m_memory_allocator->AllocateImage(description.aspect, description.usage,
+									description.width, description.height, 4, description.format,
+									VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL, 1, VMA::MemoryPool::RENDER_TARGET)
+						};
+					if constexpr (EnableDebugMarkers) target->image->SetDebugName(resource.name.c_str());
+				}
+				target->busy_until = busyUntil;
+				target->used_reset = m_reset_count;
+				resource.physical = static_cast<uint32_t>(target - images.begin());
+			}
+			else
+			{
+				auto& buffers = framePool.buffers;
+				auto target = std::find_if(buffers.begin(), buffers.end(), [&resource, firstUse](const PhysicalBuffer& physical)
+					{ return physical.buffer && physical.description == resource.buffer_description && physical.busy_until <= firstUse; });
+				if (target == buffers.end())
+				{
+					const auto& description = resource.buffer_description;
+					target = std::find_if(buffers.begin(), buffers.end(), [](const PhysicalBuffer& physical) { return !physical.buffer; });
+					if (target == buffers.end()) target = buffers.emplace(buffers.end());
+					*target = PhysicalBuffer
+						{
+							.description = description,
+							.buffer = m_context->m_memory_allocator->AllocateBuffer(description.size, description.usage)
+						};
+					if constexpr (EnableDebugMarkers) target->buffer->SetDebugName(resource.name.c_str());
+				}
+				target->busy_until = busyUntil;
+				target->used_reset = m_reset_count;
+				resource.physical = static_cast<uint32_t>(target - buffers.begin());
+			}
+		}
+	}
+
+	std::vector<SemaphoreWaitInfo> RenderGraph::Execute(std::shared_ptr<CommandBuffer> graphics_command_buffer)
+	{
+		assert(m_is_compiled && "You must Compile() the Render Graph before Execute()!");
+		assert(graphics_command_buffer->IsRecording() && "You must Begin() the graphics command buffer before Execute()!");
+
+		// First access in the compiled order among the passes of a segment
+		auto find_consumer = [this](Handle handle, auto is_in_segment) -> const Access*
+		{
+			for (auto index : m_order)
+			{
+				const auto& pass = m_passes[index];
+				if (!is_in_segment(pass)) continue;
+				auto target = std::find_if(pass.accesses.begin(), pass.accesses.end(), [handle](const Access& access) { return access.resource == handle; });
+				if (target != pass.accesses.end()) return &(*target);
+			}
+			return nullptr;
+		};
+		auto isMainPass = [this](const Pass& pass) { return pass.family == m_graphics_family && !pass.is_prologue; };
+		std::vector<bool> isPrologueResource(m_resources.size(), false);
+		for (auto index : m_order)
+		{
+			if (!m_passes[index].is_prologue) continue;
+			for (const auto& access : m_passes[index].accesses) isPrologueResource[access.resource] = true;
+		}
+
+		// 1. Graphics prologue, then release its results to the async passes reading them (Their first writes discard instead)
+		std::optional<SemaphoreWaitInfo> prologueSignal;
+		if (std::any_of(m_order.begin(), m_order.end(), [this](uint32_t index) { return m_passes[index].is_prologue; }))
+		{
+			auto commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_graphics);
+			commandBuffer->Begin();
+			for (auto index : m_order)
+				if (m_passes[index].is_prologue) record_pass(m_passes[index], commandBuffer);
+
+			m_barrier_batch.clear();
+			for (Handle handle = 0; handle < m_resources.size(); ++handle)
+			{
+				auto& resource = m_resources[handle];
+				if (!isPrologueResource[handle] || resource.async_family == VK_QUEUE_FAMILY_IGNORED) continue;
+				const Access* consumer = find_consumer(handle, [this](const Pass& pass) { return pass.family != m_graphics_family; });
+				if (consumer == nullptr || !consumer->is_read) continue;
+				auto& state = get_state(resource);
+				push_barrier(resource, m_barrier_batch,
+					state.write_stages | state.read_stages, state.write_access, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+					state.layout, resource.is_image ? consumer->layout : VK_IMAGE_LAYOUT_UNDEFINED,
+					m_graphics_family, resource.async_family);
+			}
+			record_barriers(*commandBuffer, m_barrier_batch);
+			commandBuffer->End();
+			const uint64_t tick = commandBuffer->SubmitTick();
+			prologueSignal = SemaphoreWaitInfo
+			{
+				.semaphore = commandBuffer->GetSubmittedQueueTimeline().GetSemaphore(),
+				.stages = VK_PIPELINE_STAGE_2_NONE, // Stages of the consumers
+				.value = tick
+			};
+		}
+
+		// 2. Async passes
+		struct AsyncBatch
+		{
+			uint32_t family;
+			std::shared_ptr<CommandBuffer> command_buffer;
+			VkPipelineStageFlags2 consumer_stages = VK_PIPELINE_STAGE_2_NONE; // Of the graphics passes waiting for it
+			VkPipelineStageFlags2 prologue_stages = VK_PIPELINE_STAGE_2_NONE; // Of its passes waiting for the prologue
+			BarrierBatch releases;
+		};
+		std::vector<AsyncBatch> asyncBatches;
+		auto get_async_batch = [&](uint32_t family) -> AsyncBatch&
+		{
+			auto target = std::find_if(asyncBatches.begin(), asyncBatches.end(), [family](const AsyncBatch& batch) { return batch.family == family; });
+			if (target != asyncBatches.end()) return *target;
+			auto& batch = asyncBatches.emplace_back(AsyncBatch{ .family = family, .command_buffer = m_context->CreateOneTimeCommandBuffer(get_family_index(family)) });
+			batch.command_buffer->Begin();
+			return batch;
+		};
+		for (auto index : m_order)
+		{
+			auto& pass = m_passes[index];
+			if (pass.family == m_graphics_family) continue;
+			auto& batch = get_async_batch(pass.family);
+			for (const auto& access : pass.accesses)
+				if (isPrologueResource[access.resource]) batch.prologue_stages |= access.stages;
+			record_pass(pass, batch.command_buffer);
+		}
+
+		// 3. Release async resources to their first graphics consumers, then submit the async batches
+		std::vector<SemaphoreWaitInfo> graphicsWaits;
+		if (!asyncBatches.empty())
+		{
+			for (Handle handle = 0; handle < m_resources.size(); ++handle)
+			{
+				auto& resource = m_resources[handle];
+				if (resource.async_family == VK_QUEUE_FAMILY_IGNORED) continue;
+				const Access* consumer = find_consumer(handle, isMainPass);
+				if (consumer == nullptr) continue;
+
+				auto& batch = get_async_batch(resource.async_family);
+				batch.consumer_stages |= consumer->stages; // Write-after-read needs the wait too
+				if (!consumer->is_read) continue; // Discarded by the consumer, no ownership transfer
+				auto& state = get_state(resource);
+				push_barrier(resource, batch.releases,
+					state.write_stages | state.read_stages, state.write_access, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+					state.layout, resource.is_image ? consumer->layout : VK_IMAGE_LAYOUT_UNDEFINED,
+					resource.async_family, m_graphics_family);
+				// The acquisition is recorded by the consumer (State::family still differs)
+			}
+
+			for (auto& batch : asyncBatches)
+			{
+				record_barriers(*batch.command_buffer, batch.releases);
+				batch.command_buffer->End();
+				std::optional<SemaphoreWaitInfo> prologueWait;
+				if (prologueSignal.has_value() && batch.prologue_stages != VK_PIPELINE_STAGE_2_NONE)
+				{
+					prologueWait = *prologueSignal;
+					prologueWait->stages = batch.prologue_stages;
+				}
+				uint64_t tick = prologueWait.has_value() ? batch.command_buffer->SubmitTick({ &prologueWait.value(), 1 }) : batch.command_buffer->SubmitTick();
+				if (batch.consumer_stages != VK_PIPELINE_STAGE_2_NONE)
+				{
+					graphicsWaits.emplace_back(SemaphoreWaitInfo
+						{
+							.semaphore = m_context->GetGlobalQueueTimeline(get_family_index(batch.family))->GetSemaphore(),
+							.stages = batch.consumer_stages,
+							.value = tick
+						});
+				}
+			}
+		}
+
+		// 4. Graphics passes (Ordered after the prologue even if the command buffer goes to another graphics queue)
+		if (prologueSignal.has_value())
+		{
+			for (Handle handle = 0; handle < m_resources.size(); ++handle)
+			{
+				if (!isPrologueResource[handle]) continue;
+				if (const Access* consumer = find_consumer(handle, isMainPass)) prologueSignal->stages |= consumer->stages;
+			}
+			if (prologueSignal->stages != VK_PIPELINE_STAGE_2_NONE) graphicsWaits.emplace_back(*prologueSignal);
+		}
+		for (auto index : m_order)
+		{
+			auto& pass = m_passes[index];
+			if (isMainPass(pass)) record_pass(pass, graphics_command_buffer);
+		}
+
+		// 5. Final layouts of imported images
+		m_barrier_batch.clear();
+		for (auto& resource : m_resources)
+		{
+			if (!resource.is_imported || !resource.is_image) continue;
+			auto& state = resource.state;
+			if (resource.final_layout != VK_IMAGE_LAYOUT_UNDEFINED && resource.final_layout != state.layout)
+			{
+				push_barrier(resource, m_barrier_batch,
+					state.write_stages | state.read_stages, state.write_access, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+					state.layout, resource.final_layout);
+				state.layout = resource.final_layout;
+			}
+			if (resource.imported_image) resource.imported_image->assume_access(ResourceAccess
+				{
+					.stages = state.write_stages | state.read_stages,
+					.access = state.write_access,
+					.layout = state.layout
+				});
+		}
+		record_barriers(*graphics_command_buffer, m_barrier_batch);
+
+		return graphicsWaits;
+	}
+
+	void RenderGraph::record_pass(Pass& pass, std::shared_ptr<CommandBuffer> command_buffer)
+	{
+		m_barrier_batch.clear();
+		for (const auto& access : pass.accesses)
+			transition(m_resources[access.resource], access, pass.family, m_barrier_batch);
+		record_barriers(*command_buffer, m_barrier_batch); // One barrier call per pass
+
+		command_buffer->PushLabel(pass.name.c_str());
+		{
+			CrashBreadcrumbs::Scope breadcrumb{ m_context->GetCrashBreadcrumbs(), *command_buffer, pass.name }; // Outside the pass's render pass
+			pass.execute(command_buffer, *this);
+		}
+		command_buffer->PopLabel();
+	}
+
+	RenderGraph::State& RenderGraph::get_state(Resource& resource)
+	{
+		if (resource.is_imported) return resource.state;
+		auto& framePool = m_frame_pools[m_frame_index];
+		return resource.is_image ? framePool.images[resource.physical].state : framePool.buffers[resource.physical].state;
+	}
+
+	void RenderGraph::transition(Resource& resource, const Access& access, uint32_t family, BarrierBatch& batch)
+	{
+		auto& state = get_state(resource);
+		VkImageLayout oldLayout = state.layout;
+		if (resource.is_discarded)
+		{
+			// First use of a transient in this frame (The previous user of an aliased resource is still synchronized)
+			oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			state.family = family;
+			resource.is_discarded = false;
+		}
+
+		if (state.family != family && !access.is_read)
+		{
+			// Overwritten on another queue without a release (Ordered by the timeline wait of the submission)
+			oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			state = State{ .family = family };
+		}
+
+		if (state.family != family)
+		{
+			// Acquire the ownership released by another queue (Same layouts as the release)
+			push_barrier(resource, batch,
+				VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, access.stages, access.access,
+				oldLayout, resource.is_image ? access.layout : VK_IMAGE_LAYOUT_UNDEFINED,
+				state.family, family);
+			state = State
+			{
+				.layout = access.layout,
+				.family = family,
+				.write_stages = access.stages,
+				.write_access = access.access & ResourceAccess::WRITE_ACCESS_MASK,
+				.read_stages = access.is_write ? VK_PIPELINE_STAGE_2_NONE : access.stages,
+				.synced_stages = access.stages,
+				.synced_access = access.access
+			};
+			return;
+		}
+
+		bool isLayoutChanged = resource.is_image && (oldLayout != access.layout || oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+		if (access.is_write || isLayoutChanged)
+		{
+			// Write-after-read, write-after-write or a layout transition
+			VkPipelineStageFlags2 srcStages = state.write_stages | state.read_stages;
+			if (isLayoutChanged || srcStages != VK_PIPELINE_STAGE_2_NONE)
+			{
+				push_barrier(resource, batch,
+					srcStages, state.write_access, access.stages, access.access,
+					oldLayout, resource.is_image ? access.layout : VK_IMAGE_LAYOUT_UNDEFINED);
+			}
+			state.layout = access.layout;
+			state.write_stages = access.stages; // The transition counts as a write in these stages
+			state.write_access = access.access & ResourceAccess::WRITE_ACCESS_MASK;
+			state.read_stages = access.is_write ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+			state.synced_stages = access.is_write ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+			state.synced_access = access.is_write ? VK_ACCESS_2_NONE : access.access;
+			return;
+		}
+
+		// Read-after-write (Skipped if the last write is already visible to these readers)
+		if (state.write_stages != VK_PIPELINE_STAGE_2_NONE &&
+			((access.stages & ~state.synced_stages) || (access.access & ~state.synced_access)))
+		{
+			push_barrier(resource, batch,
+				state.write_stages, state.write_access, access.stages, access.access,
+				state.layout, state.layout);
+			state.synced_stages |= access.stages;
+			state.synced_access |= access.access;
+		}
+		state.read_stages |= access.stages;
+	}
+
+	void RenderGraph::push_barrier(Resource& resource, BarrierBatch& batch,
+		VkPipelineStageFlags2 src_stages, VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stages, VkAccessFlags2 dst_access,
+		VkImageLayout old_layout, VkImageLayout new_layout,
+		uint32_t src_family/* = VK_QUEUE_FAMILY_IGNORED*/, uint32_t dst_family/* = VK_QUEUE_FAMILY_IGNORED*/)
+	{
+		if (resource.is_image)
+		{
+			batch.image_barriers.emplace_back(VkImageMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = src_stages,
+					.srcAccessMask = src_access,
+					.dstStageMask = dst_stages,
+					.dstAccessMask = dst_access,
+					.oldLayout = old_layout,
+					.newLayout = new_layout,
+					.srcQueueFamilyIndex = src_family,
+					.dstQueueFamilyIndex = dst_family,
+					.image = GetImage(static_cast<Handle>(&resource - m_resources.data())),
+					.subresourceRange
+					{
+						.aspectMask = resource.aspect,
+						.baseMipLevel = 0,
+						.levelCount = VK_REMAINING_MIP_LEVELS,
+						.baseArrayLayer = 0,
+						.layerCount = VK_REMAINING_ARRAY_LAYERS
+					}
+				});
+		}
+		else
+		{
+			batch.buffer_barriers.emplace_back(VkBufferMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					.srcStageMask = src_stages,
+					.srcAccessMask = src_access,
+					.dstStageMask = dst_stages,
+					.dstAccessMask = dst_access,
+					.srcQueueFamilyIndex = src_family,
+					.dstQueueFamilyIndex = dst_family,
+					.buffer = GetBuffer(static_cast<Handle>(&resource - m_resources.data())),
+					.offset = 0,
+					.size = VK_WHOLE_SIZE
+				});
+		}
+	}
+
+	void RenderGraph::record_barriers(CommandBuffer& command_buffer, BarrierBatch& batch)
+	{
+		if (batch.empty()) return;
+		command_buffer.PipelineBarrier(batch.image_barriers, batch.buffer_barriers);
+		batch.clear();
+	}
+
+	VkImage RenderGraph::GetImage(Handle resource)
+	{
+		auto& target = m_resources[resource];
+		assert(target.is_image && "This Render Graph resource is not an image!");
+		if (target.is_imported) return target.image;
+		assert(target.physical != INVALID_HANDLE && "This Render Graph image was culled!");
+		return *m_frame_pools[m_frame_index].images[target.physical].image;
+	}
+
+	VkImageView RenderGraph::GetImageView(Handle resource)
+	{
+		auto& target = m_resources[resource];
+		assert(target.is_image && "This Render Graph resource is not an image!");
+		if (target.is_imported) return target.image_view;
+		assert(target.physical != INVALID_HANDLE && "This Render Graph image was culled!");
+		return m_frame_pools[m_frame_index].images[target.physical].image->GetImageView();
+	}
+
+	VkBuffer RenderGraph::GetBuffer(Handle resource)
+	{
+		auto& target = m_resources[resource];
+		assert(!target.is_image && "This Render Graph resource is not a buffer!");
+		if (target.is_imported) return target.buffer;
+		assert(target.physical != INVALID_HANDLE && "This Render Graph buffer was culled!");
+		return *m_frame_pools[m_frame_index].buffers[target.physical].buffer;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+
+namespace Albedo {
+namespace RHI
+{
+	// Frame Render Graph (Rebuilt every frame: Reset() -> Import / AddPass() -> Compile() -> Execute())
+	// Passes declare their reads and writes; the graph culls unused passes, hoists async compute / transfer work,
+	// aliases transient resources with disjoint lifetimes and batches all barriers before each pass into one call.
+	// Async passes overlap the graphics passes they are independent of: The graphics passes they depend on (e.g. A depth prepass
+	// before SSAO) are submitted ahead as a prologue, and timeline waits & queue ownership transfers are only inserted where data flows.
+	// Compiled plans are cached by the topology (Passes, accesses & transient descriptions, not the imported handles), so an unchanged
+	// frame skips the compilation. A resize or a settings change alters the topology and compiles a new plan, the stale ones retire.
+	class RenderGraph
+	{
+	public:
+		using Handle = uint32_t;
+		static constexpr Handle INVALID_HANDLE = std::numeric_limits<uint32_t>::max();
+
+		// Async queues fall back to graphics if unavailable, or if the pass or its prologue touches imported resources
+		enum class Queue : uint32_t { GRAPHICS, COMPUTE, TRANSFER };
+		enum class Usage : uint32_t
+		{
+			COLOR_ATTACHMENT, DEPTH_STENCIL_ATTACHMENT, DEPTH_STENCIL_READ,
+			SAMPLED_GRAPHICS, SAMPLED_COMPUTE,
+			STORAGE_GRAPHICS, STORAGE_COMPUTE,
+			UNIFORM_GRAPHICS, UNIFORM_COMPUTE,
+			VERTEX_BUFFER, INDEX_BUFFER, INDIRECT_BUFFER,
+			TRANSFER_SRC, TRANSFER_DST,
+			MAX_USAGE
+		};
+
+		struct ImageDescription
+		{
+			uint32_t width;
+			uint32_t height;
+			VkFormat format;
+			VkImageUsageFlags usage;
+			VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT; // MSAA: VMA::AllocateMultisampledAttachment()
+			bool operator==(const ImageDescription&) const = default;
+		};
+		struct BufferDescription
+		{
+			VkDeviceSize size;
+			VkBufferUsageFlags usage;
+			bool operator==(const BufferDescription&) const = default;
+		};
+
+		class PassBuilder
+		{
+			friend class RenderGraph;
+		public:
+			// Transient resources (Contents are undefined at their first use)
+			Handle CreateImage(std::string_view name, const ImageDescription& description);
+			Handle CreateBuffer(std::string_view name, const BufferDescription& description);
+			// Write() does not preserve the previous contents unless the resource is also Read() by this pass
+			Handle Read(Handle resource, Usage usage);
+			Handle Write(Handle resource, Usage usage);
+			void SetSideEffects(); // Never culled
+
+		private:
+			PassBuilder(RenderGraph& graph, uint32_t pass) : m_graph{ graph }, m_pass{ pass } {}
+			RenderGraph& m_graph;
+			uint32_t m_pass;
+		};
+		using SetupFunction = std::function<void(PassBuilder& builder)>;
+		using ExecuteFunction = std::function<void(std::shared_ptr<CommandBuffer> command_buffer, RenderGraph& graph)>;
+
+		// Build (Call Reset() after the fence of this frame signaled)
+		void Reset(uint32_t frame_index);
+		// Imported resources are kept by the graph and their writers are never culled
+		Handle ImportImage(std::string_view name, std::shared_ptr<VMA::Image> image, VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED /*Keep*/);
+		Handle ImportImage(std::string_view name, VkImage image, VkImageView image_view, VkImageAspectFlags aspect,
+			VkImageLayout current_layout, VkImageLayout final_layout); // e.g. Swap Chain Images (UNDEFINED -> PRESENT_SRC_KHR)
+		Handle ImportBuffer(std::string_view name, std::shared_ptr<VMA::Buffer> buffer);
+		void AddPass(std::string_view name, Queue queue, const SetupFunction& setup, ExecuteFunction execute);
+
+		void Compile();
+		// Record graphics passes into the command buffer and submit the prologue & hoisted async passes on their queues.
+		// Return the waits the graphics submission needs (e.g. FrameContext::EndFrame(waits))
+		std::vector<SemaphoreWaitInfo> Execute(std::shared_ptr<CommandBuffer> graphics_command_buffer);
+
+		// Inside Execute Functions
+		VkImage			GetImage(Handle resource);
+		VkImageView	GetImageView(Handle resource);
+		VkBuffer			GetBuffer(Handle resource);
+
+		size_t GetPassCount() const { return m_passes.size(); }
+		size_t GetCulledPassCount() const { return m_culled_pass_count; }
+
+		// Drop every cached plan (Their transient resources are retired once the next plans leave them unused)
+		void InvalidatePlans() { m_plans.clear(); }
+		bool IsPlanCached() const { return m_is_plan_cached; } // The last Compile() reused a cached plan
+		size_t GetCachedPlanCount() const { return m_plans.size(); }
+
+	public:
+		RenderGraph() = delete;
+		RenderGraph(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight);
+		RenderGraph(const RenderGraph&) = delete;
+
+	private:
+		static constexpr uint64_t RETIREMENT_RESETS = 240; // Unused plans & physical resources are released after these many Reset()
+		struct State
+		{
+			VkImageLayout					layout					= VK_IMAGE_LAYOUT_UNDEFINED;
+			uint32_t							family					= VK_QUEUE_FAMILY_IGNORED;
+			VkPipelineStageFlags2		write_stages		= VK_PIPELINE_STAGE_2_NONE; // Last write (or layout transition)
+			VkAccessFlags2				write_access		= VK_ACCESS_2_NONE;
+			VkPipelineStageFlags2		read_stages		= VK_PIPELINE_STAGE_2_NONE; // Readers since the last write
+			VkPipelineStageFlags2		synced_stages	= VK_PIPELINE_STAGE_2_NONE; // Readers the last write is visible to
+			VkAccessFlags2				synced_access	= VK_ACCESS_2_NONE;
+		};
+		struct Access
+		{
+			Handle resource;
+			VkPipelineStageFlags2 stages;
+			VkAccessFlags2 access;
+			VkImageLayout layout;
+			bool is_read;
+			bool is_write;
+		};
+		struct Pass
+		{
+			std::string name;
+			Queue queue;
+			uint32_t family;
+			ExecuteFunction execute;
+			std::vector<Access> accesses; // Merged per resource
+			bool has_side_effects = false;
+			bool is_culled = true;
+			bool is_prologue = false; // Graphics pass submitted ahead of the async passes depending on it
+		};
+		struct Resource
+		{
+			std::string name;
+			bool is_image;
+			bool is_imported;
+			ImageDescription image_description{};
+			BufferDescription buffer_description{};
+			// Imported
+			std::shared_ptr<VMA::Image> imported_image;
+			std::shared_ptr<VMA::Buffer> imported_buffer;
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView image_view = VK_NULL_HANDLE;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			State state;
+			// Compiled
+			uint32_t first_use = INVALID_HANDLE;
+			uint32_t last_use = INVALID_HANDLE;
+			uint32_t async_family = VK_QUEUE_FAMILY_IGNORED; // Touched by an async queue
+			uint32_t physical = INVALID_HANDLE;
+			bool is_discarded = false; // Transient before its first use in this frame
+		};
+		struct PhysicalImage
+		{
+			ImageDescription description;
+			std::shared_ptr<VMA::Image> image; // Null once retired (The slot is reused by the next allocation)
+			State state;
+			uint32_t busy_until = 0; // Last use in the compiled order (+1)
+			uint64_t used_reset = 0;
+		};
+		struct PhysicalBuffer
+		{
+			BufferDescription description;
+			std::shared_ptr<VMA::Buffer> buffer; // Ditto
+			State state;
+			uint32_t busy_until = 0;
+			uint64_t used_reset = 0;
+		};
+		struct FramePool // Physical resources are reused by the same frame slot only
+		{
+			std::vector<PhysicalImage> images;
+			std::vector<PhysicalBuffer> buffers;
+			uint64_t generation = 0; // Bumped when resources are retired (Invalidates the assignments of the plans)
+		};
+		struct Plan // Compiled topology (Keyed by the hash of its topology key)
+		{
+			struct ResourcePlan
+			{
+				uint32_t first_use;
+				uint32_t last_use;
+				uint32_t async_family;
+			};
+			struct Assignment // Physical resources of one frame slot
+			{
+				bool is_assigned = false;
+				uint64_t pool_generation = 0;
+				std::vector<uint32_t> physicals; // Per resource
+			};
+			std::vector<uint32_t> order;
+			std::vector<uint32_t> pass_families;
+			std::vector<bool> prologue_passes;
+			std::vector<ResourcePlan> resources;
+			std::vector<Assignment> assignments; // Per frame slot
+			std::vector<uint64_t> topology_key; // Compared on a hash hit (Collisions compile again)
+			uint64_t used_reset = 0;
+		};
+		struct BarrierBatch
+		{
+			std::vector<VkImageMemoryBarrier2> image_barriers;
+			std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+			bool empty() const { return image_barriers.empty() && buffer_barriers.empty(); }
+			void clear() { image_barriers.clear(); buffer_barriers.clear(); }
+		};
+
+		void add_access(uint32_t pass, Handle resource, Usage usage, bool is_write);
+		uint32_t resolve_family(Queue queue) const;
+		void assign_queues();
+		bool schedule_async(uint32_t order, uint32_t family); // Moves the graphics passes it depends on into the prologue
+		void cull_passes();
+		void assign_physical_resources();
+		void make_topology_key(std::vector<uint64_t>& key) const;
+		void store_plan(Plan& plan) const; // Culling & queues
+		void apply_plan(const Plan& plan);
+		void patch_physical_resources(const Plan::Assignment& assignment);
+		void retire_stale();
+
+		State& get_state(Resource& resource);
+		void push_barrier(Resource& resource, BarrierBatch& batch,
+			VkPipelineStageFlags2 src_stages, VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stages, VkAccessFlags2 dst_access,
+			VkImageLayout old_layout, VkImageLayout new_layout,
+			uint32_t src_family = VK_QUEUE_FAMILY_IGNORED, uint32_t dst_family = VK_QUEUE_FAMILY_IGNORED);
+		void transition(Resource& resource, const Access& access, uint32_t family, BarrierBatch& batch);
+		void record_barriers(CommandBuffer& command_buffer, BarrierBatch& batch);
+		void record_pass(Pass& pass, std::shared_ptr<CommandBuffer> command_buffer);
+		QueueFamilyIndex& get_family_index(uint32_t family);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		uint32_t m_graphics_family;
+		uint32_t m_frame_index = 0;
+		uint64_t m_reset_count = 0;
+		bool m_is_compiled = false;
+		bool m_is_plan_cached = false;
+		size_t m_culled_pass_count = 0;
+
+		std::vector<Pass> m_passes;
+		std::vector<Resource> m_resources;
+		std::vector<uint32_t> m_order; // Compiled passes
+		std::vector<FramePool> m_frame_pools;
+		BarrierBatch m_barrier_batch; // Keep the capacity across passes
+		std::vector<uint64_t> m_topology_key; // Ditto
+		std::unordered_map<uint64_t, Plan> m_plans;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,73 @@
+#include "vulkan_growable.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	GrowableBuffer::GrowableBuffer(std::shared_ptr<VulkanContext> vulkan_context, VkBufferUsageFlags usage, VkDeviceSize initial_capacity,
+		float growth_factor/* = 2.0f*/) :
+		m_context{ std::move(vulkan_context) },
+		m_usage{ usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT },
+		m_growth_factor{ growth_factor }
+	{
+		assert(initial_capacity > 0 && growth_factor > 1.0f && "Invalid Growable Buffer!");
+		create_buffer(initial_capacity);
+	}
+
+	GrowableBuffer::~GrowableBuffer()
+	{
+		release_bindless_index();
+	}
+
+	bool GrowableBuffer::ReserveCommand(CommandBuffer& command_buffer, VkDeviceSize capacity, VkDeviceSize used_bytes/* = VK_WHOLE_SIZE*/)
+	{
+		if (capacity <= m_capacity) return false;
+
+		// The old buffer is still read by the frames in flight (And this copy), and released with the last reference
+		auto oldBuffer = std::move(m_buffer);
+		const VkDeviceSize copySize = std::min(used_bytes, m_capacity);
+		create_buffer(std::max(capacity, static_cast<VkDeviceSize>(m_capacity * static_cast<double>(m_growth_factor))));
+		if (copySize)
+		{
+			oldBuffer->TransitionCommand(command_buffer, ResourceAccess{ .stages = VK_PIPELINE_STAGE_2_COPY_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT });
+			m_buffer->TransitionCommand(command_buffer, ResourceAccess{ .stages = VK_PIPELINE_STAGE_2_COPY_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT });
+			oldBuffer->CopyCommand(command_buffer, *m_buffer, copySize);
+		}
+
+		if (m_bindless_index != ~0u)
+		{
+			release_bindless_index();
+			m_bindless_index = m_context->GetBindlessHeap().RegisterStorageBuffer(*m_buffer);
+		}
+		if (m_on_grown) m_on_grown(*this);
+		return true;
+	}
+
+	uint32_t GrowableBuffer::EnableBindless()
+	{
+		if (!m_context->IsBindlessSupported())
+			throw std::runtime_error("Failed to enable the bindless slot of the Growable Buffer - Bindless is not supported by this device!");
+		assert((m_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) && "Bindless buffers must be storage buffers!");
+		if (m_bindless_index == ~0u) m_bindless_index = m_context->GetBindlessHeap().RegisterStorageBuffer(*m_buffer);
+		return m_bindless_index;
+	}
+
+	void GrowableBuffer::create_buffer(VkDeviceSize capacity)
+	{
+		m_buffer = m_context->m_memory_allocator->AllocateBuffer(capacity, m_usage);
+		m_capacity = capacity;
+		++m_generation;
+		if constexpr (EnableDebugMarkers)
+			m_buffer->SetDebugName(std::format("Growable Buffer ({} bytes, generation {})", capacity, m_generation).c_str());
+	}
+
+	void GrowableBuffer::release_bindless_index()
+	{
+		if (m_bindless_index == ~0u) return;
+		// Frames in flight may still read the old buffer through the slot
+		m_context->DeferDeletion([context = m_context.get(), bindlessIndex = m_bindless_index]()
+			{ if (context->IsBindlessSupported()) context->GetBindlessHeap().Release(BindlessHeap::STORAGE_BUFFER, bindlessIndex); });
+		m_bindless_index = ~0u;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Growable Device Buffer (e.g. Instance buffers and light lists rebuilt every frame): ReserveCommand() beyond the capacity allocates
+	// a larger buffer (growth_factor times the capacity, at least the requested one), copies the used bytes of the old buffer on the GPU
+	// and releases it (Deleted after the frames in flight, which keep reading it), so growing costs no CPU re-upload.
+	// The handles change with every growth: The bindless slot (EnableBindless()) is re-registered and the old index released after the
+	// frames in flight, and the grow callback rewrites the descriptors referencing the buffer. Not thread-safe.
+	class GrowableBuffer
+	{
+	public:
+		using GrowCallback = std::function<void(GrowableBuffer&)>;
+
+		// Record it outside render passes before the commands using the new capacity, true if it grew. The new buffer is left as a
+		// transfer write (TransitionCommand() it to its consumer access), bytes beyond used_bytes are undefined.
+		bool ReserveCommand(CommandBuffer& command_buffer, VkDeviceSize capacity, VkDeviceSize used_bytes = VK_WHOLE_SIZE);
+		uint32_t EnableBindless(); // STORAGE_BUFFER slot of the whole buffer (Needs VulkanContext::IsBindlessSupported())
+		void SetGrowCallback(GrowCallback on_grown) { m_on_grown = std::move(on_grown); } // Called after every growth
+
+		std::shared_ptr<VMA::Buffer> GetBuffer() { return m_buffer; }
+		VkDeviceSize GetCapacity() const { return m_capacity; }
+		uint32_t GetBindlessIndex() const { return m_bindless_index; } // ~0u without EnableBindless() (Changes with every growth)
+		uint32_t GetGeneration() const { return m_generation; } // Incremented by every growth
+
+	public:
+		GrowableBuffer() = delete;
+		// TRANSFER_SRC & TRANSFER_DST are added to the usage
+		GrowableBuffer(std::shared_ptr<VulkanContext> vulkan_context, VkBufferUsageFlags usage, VkDeviceSize initial_capacity, float growth_factor = 2.0f);
+		~GrowableBuffer(); // The bindless slot is released after the frames in flight
+		GrowableBuffer(const GrowableBuffer&) = delete;
+
+	private:
+		void create_buffer(VkDeviceSize capacity);
+		void release_bindless_index(); // Deferred
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const VkBufferUsageFlags m_usage;
+		const float m_growth_factor;
+		std::shared_ptr<VMA::Buffer> m_buffer;
+		VkDeviceSize m_capacity = 0;
+		uint32_t m_generation = 0;
+		uint32_t m_bindless_index = ~0u;
+		GrowCallback m_on_grown;
+	};
+
+}} // namespace Albedo::RHI
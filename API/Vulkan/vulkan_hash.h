@@ -0,0 +1,90 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <initializer_list> // HashWords()
+
+namespace Albedo {
+namespace RHI
+{
+	// FNV-1a (64 bits) - Stable across runs, so it can be persisted (e.g. cache keys)
+	constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	template<typename T>
+	inline uint64_t HashValue(const T& value, uint64_t seed = HASH_SEED) { return HashBytes(&value, sizeof(T), seed); }
+
+	// Compile-time FNV-1a over 64-bit words (Little-endian bytes, e.g. the constexpr pipeline states of PipelineDesc)
+	template<typename... Words>
+	constexpr uint64_t HashWords(Words... words)
+	{
+		uint64_t hash = HASH_SEED;
+		for (uint64_t word : { static_cast<uint64_t>(words)... })
+		{
+			for (uint32_t byte = 0; byte < 8; ++byte)
+			{
+				hash ^= (word >> (byte * 8)) & 0xFF;
+				hash *= 0x100000001b3ULL;
+			}
+		}
+		return hash;
+	}
+
+	inline uint64_t HashCombine(uint64_t hash, uint64_t value)
+	{
+		return hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+	}
+
+	// Word-wide hash of large contents (xxHash64: 4 independent 64-bit lanes per 32-byte stripe, far faster than HashBytes() on
+	// images). Different seeds give independent hashes, e.g. a key and a digest verifying the hits of a content-addressed cache.
+	inline uint64_t HashContent(const void* data, size_t size, uint64_t seed = 0)
+	{
+		constexpr uint64_t P1 = 0x9e3779b185ebca87ULL, P2 = 0xc2b2ae3d27d4eb4fULL, P3 = 0x165667b19e3779f9ULL;
+		constexpr uint64_t P4 = 0x85ebca77c2b2ae63ULL, P5 = 0x27d4eb2f165667c5ULL;
+		auto round = [](uint64_t accumulator, uint64_t input) { return std::rotl(accumulator + input * P2, 31) * P1; };
+		auto read64 = [](const uint8_t* bytes) { uint64_t word; memcpy(&word, bytes, sizeof(word)); return word; };
+
+		auto bytes = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = bytes + size;
+		uint64_t hash;
+		if (size >= 32)
+		{
+			uint64_t lanes[4] = { seed + P1 + P2, seed + P2, seed, seed - P1 };
+			for (; end - bytes >= 32; bytes += 32)
+				for (int lane = 0; lane < 4; ++lane) lanes[lane] = round(lanes[lane], read64(bytes + lane * 8));
+			hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+			for (uint64_t lane : lanes) hash = (hash ^ round(0, lane)) * P1 + P4;
+		}
+		else hash = seed + P5;
+		hash += size;
+
+		for (; end - bytes >= 8; bytes += 8) hash = std::rotl(hash ^ round(0, read64(bytes)), 27) * P1 + P4;
+		if (end - bytes >= 4)
+		{
+			uint32_t word;
+			memcpy(&word, bytes, sizeof(word));
+			hash = std::rotl(hash ^ (word * P1), 23) * P2 + P3;
+			bytes += 4;
+		}
+		for (; bytes < end; ++bytes) hash = std::rotl(hash ^ (*bytes * P5), 11) * P1;
+
+		hash ^= hash >> 33; hash *= P2;
+		hash ^= hash >> 29; hash *= P3;
+		return hash ^ (hash >> 32);
+	}
+
+}} // namespace Albedo::RHI
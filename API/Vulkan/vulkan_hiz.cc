@@ -0,0 +1,103 @@
+#include "vulkan_hiz.h"
+#include "vulkan_context.h"
+
+#include <bit>
+
+namespace Albedo {
+namespace RHI
+{
+	HiZPyramid::HiZPyramid(std::shared_ptr<VulkanContext> vulkan_context, VkExtent2D depth_extent) :
+		m_context{ std::move(vulkan_context) },
+		m_depth_extent{ depth_extent }
+	{
+		assert(depth_extent.width > 0 && depth_extent.height > 0 && "Invalid depth extent of the Hi-Z Pyramid!");
+		m_extent = { (depth_extent.width + 1) / 2, (depth_extent.height + 1) / 2 };
+		m_mip_levels = static_cast<uint32_t>(std::bit_width(std::max(m_extent.width, m_extent.height)));
+		if (m_mip_levels > MAX_MIP_LEVELS)
+			throw std::runtime_error(std::format("Failed to create the Hi-Z Pyramid - The depth extent {}x{} needs more than {} levels!",
+				depth_extent.width, depth_extent.height, MAX_MIP_LEVELS));
+		if (!m_context->GetFormatTable().IsSupported(VK_FORMAT_R32G32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+			throw std::runtime_error("Failed to create the Hi-Z Pyramid - RG32F storage images are not supported by this device!");
+
+		m_image = m_context->m_memory_allocator->AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, m_extent.width, m_extent.height, 2, VK_FORMAT_R32G32_SFLOAT,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL, m_mip_levels);
+		m_counter = m_context->m_memory_allocator->AllocateBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		m_sampler = m_context->CreateSampler(Sampler::Desc
+			{
+				.mag_filter = VK_FILTER_NEAREST,
+				.min_filter = VK_FILTER_NEAREST,
+				.mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+				.address_mode_u = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+				.address_mode_v = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+				.address_mode_w = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+				.anisotropy_enable = false
+			});
+		if constexpr (EnableDebugMarkers)
+		{
+			m_image->SetDebugName(std::format("Hi-Z Pyramid ({}x{}, {} levels)", m_extent.width, m_extent.height, m_mip_levels).c_str());
+			m_counter->SetDebugName("Hi-Z Pyramid Counter");
+		}
+	}
+
+	void HiZPyramid::BuildCommand(CommandBuffer& command_buffer, ComputePipeline& build_pipeline, VMA::Image& depth)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::HiZPyramid::BuildCommand");
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(depth.Width() == m_depth_extent.width && depth.Height() == m_depth_extent.height && "Recreate the Hi-Z Pyramid for this depth extent!");
+
+		// The last group is found by counting the finished ones
+		m_counter->TransitionCommand(command_buffer, ResourceAccess
+			{
+				.stages = VK_PIPELINE_STAGE_2_CLEAR_BIT,
+				.access = VK_ACCESS_2_TRANSFER_WRITE_BIT
+			});
+		command_buffer.FlushBarriers();
+		command_buffer.GetDispatch().vkCmdFillBuffer(command_buffer, *m_counter, 0, sizeof(uint32_t), 0);
+
+		depth.TransitionCommand(command_buffer,
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, 0, 1);
+		m_counter->TransitionCommand(command_buffer, ResourceAccess::StorageBuffer());
+		m_image->DiscardContents(); // Every level is rewritten
+		m_image->TransitionCommand(command_buffer, ResourceAccess::StorageImage());
+
+		build_pipeline.Bind(command_buffer);
+		auto descriptorSet = m_context->CreateDescriptorSet(build_pipeline.GetSharedDescriptorSetLayout(0)); // Freed through the deletion queue
+		DescriptorWriteBatch descriptorWrites{ m_context, MAX_MIP_LEVELS + 2 };
+		descriptorWrites.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0, depth.GetSampledImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		for (uint32_t element = 0; element < MAX_MIP_LEVELS; ++element)
+		{
+			const uint32_t mipLevel = std::min(element, m_mip_levels - 1);
+			descriptorWrites.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1,
+				m_image->GetView({ .aspect = VK_IMAGE_ASPECT_COLOR_BIT, .base_mip_level = mipLevel, .mip_level_count = 1 }),
+				VK_IMAGE_LAYOUT_GENERAL, VK_NULL_HANDLE, element);
+		}
+		descriptorWrites.WriteBuffer(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, m_counter);
+		descriptorWrites.Flush();
+
+		const VkExtent2D groups{ (m_depth_extent.width + TILE_SIZE - 1) / TILE_SIZE, (m_depth_extent.height + TILE_SIZE - 1) / TILE_SIZE };
+		const BuildPushConstants pushConstants
+		{
+			.depth_extent = m_depth_extent,
+			.mip_levels = m_mip_levels,
+			.group_count = groups.width * groups.height
+		};
+		command_buffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, build_pipeline.GetPipelineLayout(), 0, { *descriptorSet });
+		command_buffer.PushConstants(build_pipeline.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BuildPushConstants), &pushConstants);
+		build_pipeline.Dispatch(command_buffer, groups.width, groups.height);
+		ReadCommand(command_buffer);
+	}
+
+	void HiZPyramid::ReadCommand(CommandBuffer& command_buffer, VkPipelineStageFlags2 stages/* = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT*/)
+	{
+		m_image->TransitionCommand(command_buffer, { stages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+	}
+
+	DescriptorWriteBatch& HiZPyramid::WriteDescriptor(DescriptorWriteBatch& descriptor_writes, VkDescriptorSet descriptor_set, uint32_t binding)
+	{
+		return descriptor_writes.WriteImage(descriptor_set, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, binding,
+			m_image->GetView({ .aspect = VK_IMAGE_ASPECT_COLOR_BIT }), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, *m_sampler);
+	}
+
+}} // namespace Albedo::RHI
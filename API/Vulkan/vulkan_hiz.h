@@ -0,0 +1,62 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ComputePipeline;
+	class DescriptorWriteBatch;
+
+	// Hierarchical-Z Pyramid for GPU occlusion culling: An RG32F mip chain of the min (r) & max (g) depth, level 0 at half the depth
+	// resolution, built in one compute dispatch after the depth pre-pass (or from the last frame's depth), and then sampled by the culling
+	// pass (IndirectDrawBuffer::CullCommand()) to reject the instances whose bounds lie behind the farthest depth of their footprint.
+	// Recreate it when the depth image is resized.
+	class HiZPyramid
+	{
+	public:
+		static constexpr uint32_t MAX_MIP_LEVELS = 12; // Depth images up to 8192x8192
+		static constexpr uint32_t TILE_SIZE = 64; // Depth texels per work group side
+
+		// Set 0 of the pipeline: binding 0 - depth (Sampled image, texelFetch), binding 1 - the levels (Storage image array [MAX_MIP_LEVELS],
+		// rg32f, unused elements repeat the last level), binding 2 - uint counter (Storage buffer, zeroed before the dispatch), push constant:
+		// BuildPushConstants. Single pass: Each 256-invocation work group reduces a 64x64 depth tile into levels 0-5 through shared memory,
+		// texels of odd source edges fold the extra row & column in. The work group whose atomicAdd on the counter returns group_count - 1
+		// finishes last and reduces level 5 into the remaining levels (Declare level 5 coherent and memoryBarrierImage() before the add).
+		struct BuildPushConstants
+		{
+			VkExtent2D depth_extent;
+			uint32_t mip_levels;
+			uint32_t group_count;	// Of the dispatch (x * y)
+		};
+		// The depth image needs SAMPLED usage (e.g. m_swapchain_depth_stencil_image or a render graph depth target), and is left in
+		// SHADER_READ_ONLY_OPTIMAL. The pyramid is left readable by ReadCommand() stages.
+		void BuildCommand(CommandBuffer& command_buffer, ComputePipeline& build_pipeline, VMA::Image& depth);
+
+		// Make the pyramid readable by the culling pass (Called by IndirectDrawBuffer::CullCommand() given the pyramid)
+		void ReadCommand(CommandBuffer& command_buffer, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		// Combined image sampler of every level (Nearest, clamped to the edges: Pick the level by the projected size of the bounds)
+		DescriptorWriteBatch& WriteDescriptor(DescriptorWriteBatch& descriptor_writes, VkDescriptorSet descriptor_set, uint32_t binding);
+
+		std::shared_ptr<VMA::Image> GetImage() { return m_image; }
+		VkExtent2D GetExtent() const { return m_extent; } // Of level 0
+		VkExtent2D GetDepthExtent() const { return m_depth_extent; }
+		uint32_t GetMipLevels() const { return m_mip_levels; }
+
+	public:
+		HiZPyramid() = delete;
+		HiZPyramid(std::shared_ptr<VulkanContext> vulkan_context, VkExtent2D depth_extent);
+		HiZPyramid(const HiZPyramid&) = delete;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::shared_ptr<VMA::Image> m_image;
+		std::shared_ptr<VMA::Buffer> m_counter; // uint32_t
+		std::shared_ptr<Sampler> m_sampler;
+		VkExtent2D m_depth_extent;
+		VkExtent2D m_extent;
+		uint32_t m_mip_levels;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,233 @@
+#include "vulkan_host_allocator.h"
+
+#include <bit>
+#include <new>
+#include <cassert>
+#include <algorithm>
+#include <format>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Albedo {
+namespace RHI
+{
+	struct HostAllocator::Header
+	{
+		uint64_t size;				// Requested
+		uint32_t offset;			// From the block (or the large allocation) to the returned memory
+		uint8_t size_class;		// LARGE: Aligned operator new
+		uint8_t scope;
+		uint8_t alignment_log2;	// Of the large allocation
+		uint8_t padding;
+	};
+	namespace
+	{
+		constexpr size_t HEADER_SIZE = 16;
+		constexpr size_t SizeOfClass(uint32_t size_class) { return size_t{ 16 } << size_class; }
+	}
+
+	HostAllocator::HostAllocator() :
+		m_callbacks
+		{
+			.pUserData = this,
+			.pfnAllocation = &HostAllocator::allocation_callback,
+			.pfnReallocation = &HostAllocator::reallocation_callback,
+			.pfnFree = &HostAllocator::free_callback,
+			.pfnInternalAllocation = &HostAllocator::internal_allocation_callback,
+			.pfnInternalFree = &HostAllocator::internal_free_callback
+		}
+	{
+
+	}
+
+	void HostAllocator::Enable()
+	{
+		static std::mutex mutex;
+		std::scoped_lock guard{ mutex };
+		if (IsEnabled()) return;
+		s_allocator.store(new HostAllocator(), std::memory_order_release); // Never deleted (Drivers may free after the last context)
+	}
+
+	VkAllocationCallbacks* HostAllocator::GetCallbacks()
+	{
+		auto* allocator = s_allocator.load(std::memory_order_acquire);
+		return allocator ? &allocator->m_callbacks : nullptr;
+	}
+
+	HostMemoryStatistics HostAllocator::GetStatistics()
+	{
+		HostMemoryStatistics statistics;
+		auto* allocator = s_allocator.load(std::memory_order_acquire);
+		if (!allocator) return statistics;
+
+		for (size_t scope = 0; scope < statistics.scopes.size(); ++scope)
+		{
+			const auto& counters = allocator->m_scopes[scope];
+			statistics.scopes[scope] = HostMemoryScopeStatistics
+			{
+				.bytes = counters.bytes.load(std::memory_order_relaxed),
+				.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed),
+				.allocations = counters.allocations.load(std::memory_order_relaxed),
+				.total_allocations = counters.total_allocations.load(std::memory_order_relaxed),
+				.internal_bytes = counters.internal_bytes.load(std::memory_order_relaxed)
+			};
+		}
+		statistics.pooled_bytes = allocator->m_pooled_bytes.load(std::memory_order_relaxed);
+		statistics.large_bytes = allocator->m_large_bytes.load(std::memory_order_relaxed);
+		return statistics;
+	}
+
+	void HostAllocator::DumpJson(std::string_view path)
+	{
+		static constexpr const char* scopeNames[] = { "command", "object", "cache", "device", "instance" };
+		auto statistics = GetStatistics();
+
+		std::string json = std::format("{{\n\t\"enabled\": {},\n\t\"pooled_bytes\": {},\n\t\"large_bytes\": {},\n\t\"scopes\": {{",
+			IsEnabled(), statistics.pooled_bytes, statistics.large_bytes);
+		for (size_t scope = 0; scope < statistics.scopes.size(); ++scope)
+		{
+			const auto& counters = statistics.scopes[scope];
+			json += std::format("{}\n\t\t\"{}\": {{ \"bytes\": {}, \"peak_bytes\": {}, \"allocations\": {}, \"total_allocations\": {}, \"internal_bytes\": {} }}",
+				scope ? "," : "", scopeNames[scope], counters.bytes, counters.peak_bytes, counters.allocations, counters.total_allocations, counters.internal_bytes);
+		}
+		json += "\n\t}\n}\n";
+
+		std::ofstream file(std::string(path), std::ios::trunc);
+		if (!file.is_open() || !(file << json)) throw std::runtime_error(std::format("Failed to dump the host memory statistics to {}!", path));
+	}
+
+	void* HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		static_assert(sizeof(Header) == HEADER_SIZE);
+		assert(std::has_single_bit(alignment) && "Vulkan allocation alignments must be powers of two!");
+		const size_t offset = std::max(alignment, HEADER_SIZE); // Keeps the returned memory aligned
+		const size_t total = offset + size;
+
+		std::byte* block = nullptr;
+		uint32_t sizeClass = LARGE;
+		if (alignment <= MAX_POOLED_ALIGNMENT && total <= SizeOfClass(SIZE_CLASS_COUNT - 1))
+		{
+			sizeClass = static_cast<uint32_t>(std::countr_zero(std::bit_ceil(std::max(total, SizeOfClass(0))))) - 4;
+			block = static_cast<std::byte*>(pop_block(sizeClass));
+		}
+		else
+		{
+			block = static_cast<std::byte*>(::operator new(total, std::align_val_t{ offset }, std::nothrow));
+			if (block) m_large_bytes.fetch_add(total, std::memory_order_relaxed);
+		}
+		if (!block) return nullptr; // VK_ERROR_OUT_OF_HOST_MEMORY
+
+		std::byte* memory = block + offset;
+		*reinterpret_cast<Header*>(memory - HEADER_SIZE) = Header
+		{
+			.size = size,
+			.offset = static_cast<uint32_t>(offset),
+			.size_class = static_cast<uint8_t>(sizeClass),
+			.scope = static_cast<uint8_t>(scope),
+			.alignment_log2 = static_cast<uint8_t>(std::countr_zero(offset))
+		};
+
+		auto& counters = m_scopes[scope];
+		const uint64_t bytes = counters.bytes.fetch_add(size, std::memory_order_relaxed) + size;
+		for (uint64_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+			peak < bytes && !counters.peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed);) {}
+		counters.allocations.fetch_add(1, std::memory_order_relaxed);
+		counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+		return memory;
+	}
+
+	void HostAllocator::release(void* memory)
+	{
+		if (!memory) return;
+		auto* bytes = static_cast<std::byte*>(memory);
+		const Header header = *reinterpret_cast<const Header*>(bytes - HEADER_SIZE);
+
+		auto& counters = m_scopes[header.scope];
+		counters.bytes.fetch_sub(header.size, std::memory_order_relaxed);
+		counters.allocations.fetch_sub(1, std::memory_order_relaxed);
+
+		std::byte* block = bytes - header.offset;
+		if (header.size_class != LARGE) push_block(header.size_class, block);
+		else
+		{
+			m_large_bytes.fetch_sub(header.offset + header.size, std::memory_order_relaxed);
+			::operator delete(block, std::align_val_t{ size_t{ 1 } << header.alignment_log2 });
+		}
+	}
+
+	void* HostAllocator::pop_block(uint32_t size_class)
+	{
+		auto& sizeClass = m_size_classes[size_class];
+		std::scoped_lock guard{ sizeClass.mutex };
+		if (!sizeClass.free_list)
+		{
+			// Carve a new chunk into blocks (Chunks are kept until the process exits)
+			auto* chunk = static_cast<std::byte*>(::operator new(CHUNK_SIZE, std::align_val_t{ MAX_POOLED_ALIGNMENT }, std::nothrow));
+			if (!chunk) return nullptr;
+			m_pooled_bytes.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+			const size_t blockSize = SizeOfClass(size_class);
+			for (size_t offset = CHUNK_SIZE; offset >= blockSize; offset -= blockSize)
+				sizeClass.free_list = new (chunk + offset - blockSize) FreeBlock{ sizeClass.free_list };
+		}
+		FreeBlock* block = sizeClass.free_list;
+		sizeClass.free_list = block->next;
+		return block;
+	}
+
+	void HostAllocator::push_block(uint32_t size_class, void* block)
+	{
+		auto& sizeClass = m_size_classes[size_class];
+		std::scoped_lock guard{ sizeClass.mutex };
+		sizeClass.free_list = new (block) FreeBlock{ sizeClass.free_list };
+	}
+
+	void* HostAllocator::allocation_callback(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		return static_cast<HostAllocator*>(user_data)->allocate(size, alignment, scope);
+	}
+
+	void* HostAllocator::reallocation_callback(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		auto* allocator = static_cast<HostAllocator*>(user_data);
+		if (!original) return allocator->allocate(size, alignment, scope);
+		if (!size)
+		{
+			allocator->release(original);
+			return nullptr;
+		}
+
+		auto& header = *reinterpret_cast<Header*>(static_cast<std::byte*>(original) - HEADER_SIZE);
+		if (header.size_class != LARGE && header.scope == scope && header.offset >= alignment &&
+			header.offset + size <= SizeOfClass(header.size_class)) // Still fits the block
+		{
+			auto& counters = allocator->m_scopes[scope];
+			counters.bytes.fetch_add(size - header.size, std::memory_order_relaxed); // Wraps around when shrinking
+			counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+			header.size = size;
+			return original;
+		}
+
+		void* memory = allocator->allocate(size, alignment, scope);
+		if (!memory) return nullptr; // The original allocation stays valid
+		std::memcpy(memory, original, std::min<size_t>(size, header.size));
+		allocator->release(original);
+		return memory;
+	}
+
+	void HostAllocator::free_callback(void* user_data, void* memory)
+	{
+		static_cast<HostAllocator*>(user_data)->release(memory);
+	}
+
+	void HostAllocator::internal_allocation_callback(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+	{
+		static_cast<HostAllocator*>(user_data)->m_scopes[scope].internal_bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void HostAllocator::internal_free_callback(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+	{
+		static_cast<HostAllocator*>(user_data)->m_scopes[scope].internal_bytes.fetch_sub(size, std::memory_order_relaxed);
+	}
+
+}} // namespace Albedo::RHI
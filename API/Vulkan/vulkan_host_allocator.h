@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+
+namespace Albedo {
+namespace RHI
+{
+	// Driver host memory of one VkSystemAllocationScope
+	struct HostMemoryScopeStatistics
+	{
+		uint64_t bytes = 0;								// Live (Requested sizes)
+		uint64_t peak_bytes = 0;
+		uint64_t allocations = 0;						// Live
+		uint64_t total_allocations = 0;				// Since Enable() (Reallocations included)
+		uint64_t internal_bytes = 0;					// Reported by the driver (pfnInternalAllocation, e.g. executable memory)
+	};
+
+	struct HostMemoryStatistics
+	{
+		std::array<HostMemoryScopeStatistics, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1> scopes{}; // Indexed by VkSystemAllocationScope
+		uint64_t pooled_bytes = 0;					// Reserved by the size-class pools (Free blocks included)
+		uint64_t large_bytes = 0;						// Live allocations above the largest size class
+	};
+
+	// Tracking Host Allocator (VkAllocationCallbacks of every vkCreate*/vkDestroy* call, opt-in)
+	// Small driver allocations are served by size-class pools (Free lists of power-of-two blocks, 16 bytes to 4 KiB), so the object
+	// churn of pipeline and descriptor creation stops hitting malloc. Larger ones go to the aligned operator new.
+	// Enable() before the first VulkanContext is created: a context latches the callbacks on creation, objects have to be destroyed
+	// with the callbacks they were created with. The allocator lives until the process exits (Drivers may free after the last context).
+	class HostAllocator
+	{
+	public:
+		static void Enable();
+		static bool IsEnabled() { return s_allocator.load(std::memory_order_acquire) != nullptr; }
+		static VkAllocationCallbacks* GetCallbacks(); // Null if not enabled (The driver's own allocator)
+
+		static HostMemoryStatistics GetStatistics(); // Zeros if not enabled
+		static void DumpJson(std::string_view path);
+
+	private:
+		HostAllocator();
+		HostAllocator(const HostAllocator&) = delete;
+
+		static VKAPI_ATTR void* VKAPI_CALL allocation_callback(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static VKAPI_ATTR void* VKAPI_CALL reallocation_callback(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static VKAPI_ATTR void VKAPI_CALL free_callback(void* user_data, void* memory);
+		static VKAPI_ATTR void VKAPI_CALL internal_allocation_callback(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+		static VKAPI_ATTR void VKAPI_CALL internal_free_callback(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+		void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+		void release(void* memory);
+		void* pop_block(uint32_t size_class);
+		void push_block(uint32_t size_class, void* block);
+
+	private:
+		struct Header; // In front of every allocation
+		struct FreeBlock { FreeBlock* next; };
+		static constexpr uint32_t SIZE_CLASS_COUNT = 9; // 16 << 0 ... 16 << 8 bytes (Header included)
+		static constexpr uint32_t LARGE = SIZE_CLASS_COUNT;
+		static constexpr size_t MAX_POOLED_ALIGNMENT = 64; // Blocks are aligned to their size (Up to the chunk alignment)
+		static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+		struct alignas(64) SizeClass
+		{
+			std::mutex mutex;
+			FreeBlock* free_list = nullptr;
+		};
+		std::array<SizeClass, SIZE_CLASS_COUNT> m_size_classes;
+		std::atomic<uint64_t> m_pooled_bytes{ 0 };
+		std::atomic<uint64_t> m_large_bytes{ 0 };
+
+		struct alignas(64) ScopeCounters
+		{
+			std::atomic<uint64_t> bytes{ 0 };
+			std::atomic<uint64_t> peak_bytes{ 0 };
+			std::atomic<uint64_t> allocations{ 0 };
+			std::atomic<uint64_t> total_allocations{ 0 };
+			std::atomic<uint64_t> internal_bytes{ 0 };
+		};
+		std::array<ScopeCounters, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1> m_scopes;
+
+		VkAllocationCallbacks m_callbacks;
+		static inline std::atomic<HostAllocator*> s_allocator{ nullptr };
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,140 @@
+#include "vulkan_indirect.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		uint32_t get_command_stride(IndirectDrawBuffer::CommandType command_type)
+		{
+			switch (command_type)
+			{
+			case IndirectDrawBuffer::CommandType::DRAW:						return sizeof(VkDrawIndirectCommand);
+			case IndirectDrawBuffer::CommandType::DRAW_INDEXED:			return sizeof(VkDrawIndexedIndirectCommand);
+			case IndirectDrawBuffer::CommandType::DRAW_MESH_TASKS:	return sizeof(VkDrawMeshTasksIndirectCommandEXT);
+			default: throw std::runtime_error("Failed to create the Indirect Draw Buffer - Unknown command type!");
+			}
+		}
+	} // namespace
+
+	IndirectDrawBuffer::IndirectDrawBuffer(std::shared_ptr<VulkanContext> vulkan_context, CommandType command_type, uint32_t max_draw_count, bool host_writable/* = false*/) :
+		m_context{ std::move(vulkan_context) },
+		m_command_type{ command_type },
+		m_max_draw_count{ max_draw_count },
+		m_stride{ get_command_stride(command_type) },
+		m_host_writable{ host_writable }
+	{
+		assert(max_draw_count > 0 && "Invalid count of indirect draws!");
+		if (command_type == CommandType::DRAW_MESH_TASKS && !m_context->IsMeshShaderSupported())
+			throw std::runtime_error("Failed to create the Indirect Draw Buffer - Mesh shaders are not supported by this device!");
+		m_draw_count_supported = m_context->m_physical_device_features2.has_value() && m_context->m_physical_device_features12.drawIndirectCount;
+		m_multi_draw_supported = m_context->m_physical_device_features.multiDrawIndirect;
+		if (max_draw_count > m_context->m_physical_device_properties.limits.maxDrawIndirectCount)
+			throw std::runtime_error("Failed to create the Indirect Draw Buffer - max_draw_count exceeds maxDrawIndirectCount!");
+
+		constexpr VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		m_argument_buffer = m_context->m_memory_allocator->AllocateBuffer(static_cast<size_t>(m_stride) * max_draw_count, usage, true, host_writable, false, host_writable);
+		m_count_buffer = m_context->m_memory_allocator->AllocateBuffer(sizeof(uint32_t), usage, true, host_writable, false, host_writable);
+		if constexpr (EnableDebugMarkers)
+		{
+			m_argument_buffer->SetDebugName(std::format("Indirect Arguments ({} draws)", max_draw_count).c_str());
+			m_count_buffer->SetDebugName("Indirect Draw Count");
+		}
+	}
+
+	void IndirectDrawBuffer::Write(uint32_t index, const VkDrawIndirectCommand& command)
+	{
+		assert(m_host_writable && m_command_type == CommandType::DRAW && index < m_max_draw_count);
+		m_argument_buffer->Write(std::as_bytes(std::span{ &command, 1 }), static_cast<VkDeviceSize>(index) * m_stride);
+	}
+
+	void IndirectDrawBuffer::Write(uint32_t index, const VkDrawIndexedIndirectCommand& command)
+	{
+		assert(m_host_writable && m_command_type == CommandType::DRAW_INDEXED && index < m_max_draw_count);
+		m_argument_buffer->Write(std::as_bytes(std::span{ &command, 1 }), static_cast<VkDeviceSize>(index) * m_stride);
+	}
+
+	void IndirectDrawBuffer::Write(uint32_t index, const VkDrawMeshTasksIndirectCommandEXT& command)
+	{
+		assert(m_host_writable && m_command_type == CommandType::DRAW_MESH_TASKS && index < m_max_draw_count);
+		m_argument_buffer->Write(std::as_bytes(std::span{ &command, 1 }), static_cast<VkDeviceSize>(index) * m_stride);
+	}
+
+	void IndirectDrawBuffer::SetDrawCount(uint32_t draw_count)
+	{
+		assert(m_host_writable && draw_count <= m_max_draw_count);
+		m_count_buffer->Write(std::as_bytes(std::span{ &draw_count, 1 }));
+		m_host_draw_count = draw_count;
+	}
+
+	void IndirectDrawBuffer::ResetCountCommand(CommandBuffer& command_buffer)
+	{
+		m_count_buffer->TransitionCommand(command_buffer, ResourceAccess
+			{
+				.stages = VK_PIPELINE_STAGE_2_CLEAR_BIT,
+				.access = VK_ACCESS_2_TRANSFER_WRITE_BIT
+			});
+		command_buffer.FlushBarriers();
+		command_buffer.GetDispatch().vkCmdFillBuffer(command_buffer, *m_count_buffer, 0, sizeof(uint32_t), 0);
+	}
+
+	void IndirectDrawBuffer::CullCommand(CommandBuffer& command_buffer, ComputePipeline& culling_pipeline, uint32_t object_count, uint32_t group_size/* = 64*/)
+	{
+		assert(group_size > 0 && "Invalid size of the culling work group!");
+		const ResourceAccess culling
+		{
+			.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			.access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+		};
+		m_argument_buffer->TransitionCommand(command_buffer, culling);
+		m_count_buffer->TransitionCommand(command_buffer, culling);
+		culling_pipeline.Dispatch(command_buffer, (object_count + group_size - 1) / group_size);
+
+		// Before the render pass begins (Barriers are not allowed between the draws)
+		transition_for_draws(command_buffer);
+	}
+
+	void IndirectDrawBuffer::CullCommand(CommandBuffer& command_buffer, ComputePipeline& culling_pipeline, uint32_t object_count, HiZPyramid& occlusion, uint32_t group_size/* = 64*/)
+	{
+		occlusion.ReadCommand(command_buffer); // Flushed by the dispatch
+		CullCommand(command_buffer, culling_pipeline, object_count, group_size);
+	}
+
+	void IndirectDrawBuffer::DrawCommand(CommandBuffer& command_buffer)
+	{
+		transition_for_draws(command_buffer); // No-op after CullCommand() or on the CPU path
+		command_buffer.FlushBarriers();
+
+		if (m_draw_count_supported)
+		{
+			if (m_command_type == CommandType::DRAW_MESH_TASKS)
+				command_buffer.DrawMeshTasksIndirectCount(*m_argument_buffer, 0, *m_count_buffer, 0, m_max_draw_count, m_stride);
+			else command_buffer.DrawIndirectCount(*m_argument_buffer, 0, *m_count_buffer, 0, m_max_draw_count, m_stride, m_command_type == CommandType::DRAW_INDEXED);
+			return;
+		}
+
+		// Fallback: The CPU path knows its count, culled GPU slots are drawn with zero instances
+		const uint32_t drawCount = m_host_writable ? m_host_draw_count : m_max_draw_count;
+		const uint32_t drawsPerCall = m_multi_draw_supported ? drawCount : 1;
+		for (uint32_t first_draw = 0; first_draw < drawCount; first_draw += drawsPerCall)
+		{
+			VkDeviceSize offset = static_cast<VkDeviceSize>(first_draw) * m_stride;
+			if (m_command_type == CommandType::DRAW_MESH_TASKS)
+				command_buffer.DrawMeshTasksIndirect(*m_argument_buffer, offset, drawsPerCall, m_stride);
+			else command_buffer.DrawIndirect(*m_argument_buffer, offset, drawsPerCall, m_stride, m_command_type == CommandType::DRAW_INDEXED);
+		}
+	}
+
+	void IndirectDrawBuffer::transition_for_draws(CommandBuffer& command_buffer)
+	{
+		const ResourceAccess indirectRead
+		{
+			.stages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+			.access = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT
+		};
+		m_argument_buffer->TransitionCommand(command_buffer, indirectRead);
+		m_count_buffer->TransitionCommand(command_buffer, indirectRead);
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ComputePipeline;
+	class HiZPyramid;
+
+	// GPU-driven Draws: Typed argument buffer (VkDraw(Indexed|MeshTasks)IndirectCommand[]) and its draw count
+	// Written by the CPU (host_writable) or by a culling compute shader (Bind both as storage buffers and append with atomicAdd on the count).
+	// Without drawIndirectCount all max_draw_count arguments are drawn, so the culling shader must zero instanceCount (groupCountX) of culled slots.
+	class IndirectDrawBuffer
+	{
+	public:
+		enum class CommandType { DRAW, DRAW_INDEXED, DRAW_MESH_TASKS /*VK_EXT_mesh_shader*/ };
+
+		// CPU Path (host_writable)
+		void Write(uint32_t index, const VkDrawIndirectCommand& command);
+		void Write(uint32_t index, const VkDrawIndexedIndirectCommand& command);
+		void Write(uint32_t index, const VkDrawMeshTasksIndirectCommandEXT& command);
+		void SetDrawCount(uint32_t draw_count);
+
+		// GPU Path: Reset the count, dispatch the culling pass, and then make the arguments visible to the indirect draws
+		void ResetCountCommand(CommandBuffer& command_buffer); // vkCmdFillBuffer 0
+		// The pipeline and its descriptor sets must be bound, one invocation per object (group_size: local_size_x)
+		void CullCommand(CommandBuffer& command_buffer, ComputePipeline& culling_pipeline, uint32_t object_count, uint32_t group_size = 64);
+		// Occlusion culling against the pyramid built this frame (Write it into the bound sets with HiZPyramid::WriteDescriptor())
+		void CullCommand(CommandBuffer& command_buffer, ComputePipeline& culling_pipeline, uint32_t object_count, HiZPyramid& occlusion, uint32_t group_size = 64);
+
+		// vkCmdDraw(Indexed|MeshTasks)IndirectCount (Bind the graphics pipeline and the vertex/index buffers first, see RenderPass::DrawIndirect())
+		void DrawCommand(CommandBuffer& command_buffer);
+
+		std::shared_ptr<VMA::Buffer> GetArgumentBuffer() { return m_argument_buffer; }
+		std::shared_ptr<VMA::Buffer> GetCountBuffer() { return m_count_buffer; }
+		CommandType GetCommandType() const { return m_command_type; }
+		uint32_t GetMaxDrawCount() const { return m_max_draw_count; }
+		uint32_t GetStride() const { return m_stride; }
+		bool IsDrawCountSupported() const { return m_draw_count_supported; } // drawIndirectCount (Vulkan 1.2)
+
+	public:
+		IndirectDrawBuffer() = delete;
+		IndirectDrawBuffer(std::shared_ptr<VulkanContext> vulkan_context, CommandType command_type, uint32_t max_draw_count, bool host_writable = false);
+		IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+
+	private:
+		void transition_for_draws(CommandBuffer& command_buffer);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const CommandType m_command_type;
+		const uint32_t m_max_draw_count;
+		const uint32_t m_stride;
+		const bool m_host_writable;
+		bool m_draw_count_supported = false;
+		bool m_multi_draw_supported = false;
+		uint32_t m_host_draw_count = 0; // Draws without drawIndirectCount on the CPU path
+
+		std::shared_ptr<VMA::Buffer> m_argument_buffer;
+		std::shared_ptr<VMA::Buffer> m_count_buffer; // uint32_t
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+namespace Albedo {
+namespace RHI
+{
+	// Vector of Vulkan structs with inline storage for the first N elements (No heap allocation until it spills)
+	// Hot paths build their short per-call lists (Semaphores, command buffers) on the stack, pass them on as std::span.
+	template<typename T, size_t N>
+	class InlineVector
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "InlineVector only holds Vulkan handles & structs!");
+	public:
+		template<typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if (m_size < N && m_spilled.empty()) return m_inline[m_size++] = T{ std::forward<Args>(args)... };
+			if (m_spilled.empty()) m_spilled.assign(m_inline.begin(), m_inline.begin() + m_size);
+			++m_size;
+			return m_spilled.emplace_back(T{ std::forward<Args>(args)... });
+		}
+		void pop_back() { --m_size; if (!m_spilled.empty()) m_spilled.pop_back(); }
+		void clear() { m_size = 0; m_spilled.clear(); }
+
+		T* data() { return m_spilled.empty()? m_inline.data() : m_spilled.data(); }
+		const T* data() const { return m_spilled.empty()? m_inline.data() : m_spilled.data(); }
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		T* begin() { return data(); }
+		T* end() { return data() + m_size; }
+		const T* begin() const { return data(); }
+		const T* end() const { return data() + m_size; }
+		T& operator[](size_t index) { return data()[index]; }
+		const T& operator[](size_t index) const { return data()[index]; }
+		T& back() { return data()[m_size - 1]; }
+
+	private:
+		std::array<T, N> m_inline;
+		std::vector<T> m_spilled; // Holds every element once the inline storage overflowed
+		size_t m_size = 0;
+	};
+
+}} // namespace Albedo::RHI
@@ -4,18 +4,142 @@
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
 
+#include <bit>
 #include <cstring>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <vulkan/vulkan_win32.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace Albedo {
 namespace RHI
 {
+	namespace
+	{
+		VkImageCreateInfo make_image_create_info(VkImageUsageFlags usage, uint32_t width, uint32_t height, VkFormat format,
+			VkImageTiling tiling_mode, uint32_t miplevel,
+			VMA::ImageType image_type = VMA::ImageType::IMAGE_2D, uint32_t depth_or_layers = 1,
+			VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT)
+		{
+			// Transient attachments cannot be written by transfers (Their contents live in the tile memory only)
+			if (!(usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)) usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+			uint32_t depth = 1, arrayLayers = 1;
+			VkImageCreateFlags flags = 0x0;
+			switch (image_type)
+			{
+			case VMA::ImageType::IMAGE_2D:				break;
+			case VMA::ImageType::IMAGE_2D_ARRAY:	arrayLayers = depth_or_layers; break;
+			case VMA::ImageType::IMAGE_CUBE:			arrayLayers = 6; flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT; break;
+			case VMA::ImageType::IMAGE_CUBE_ARRAY:	arrayLayers = depth_or_layers; flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT; break;
+			case VMA::ImageType::IMAGE_3D:				depth = depth_or_layers; break;
+			}
+			if (!depth || !arrayLayers || (flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT && arrayLayers % 6))
+				throw std::runtime_error("Failed to create the Vulkan Image - Invalid depth or array layers!");
+			if (flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT && width != height)
+				throw std::runtime_error("Failed to create the Vulkan Image - Cube faces must be square!");
+			if (!miplevel) miplevel = static_cast<uint32_t>(std::bit_width(std::max({ width, height, depth }))); // Down to 1x1x1
+			if (samples != VK_SAMPLE_COUNT_1_BIT && (miplevel != 1 || flags || depth != 1 || tiling_mode != VK_IMAGE_TILING_OPTIMAL))
+				throw std::runtime_error("Failed to create the Vulkan Image - Multisampled images must be optimal 2D images with one mip level!");
+
+			return VkImageCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+				.flags = flags,
+				.imageType = (image_type == VMA::ImageType::IMAGE_3D)? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D,
+				.format = format,
+				.extent{.width = width, .height = height, .depth = depth},
+				.mipLevels = miplevel,
+				.arrayLayers = arrayLayers,
+				.samples = samples,
+				.tiling = tiling_mode, // P206
+				.usage = usage,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE, // The image will only be used by one queue family: the one that supports graphics (and therefore also) transfer operations.
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED // P207 Top
+			};
+		}
+
+		// Single plane, fixed_rate is referenced (FIXED_RATE_EXPLICIT)
+		VkImageCompressionControlEXT make_image_compression_control(VkImageCompressionFlagsEXT flags, const VkImageCompressionFixedRateFlagsEXT& fixed_rate,
+			const void* next)
+		{
+			const bool isExplicit = flags == VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT;
+			return VkImageCompressionControlEXT
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT,
+				.pNext = next,
+				.flags = flags,
+				.compressionControlPlaneCount = isExplicit? 1u : 0u,
+				.pFixedRateFlags = isExplicit? &fixed_rate : nullptr
+			};
+		}
+
+		VmaAllocationCreateFlags make_host_access_flags(bool is_writable, bool is_readable, bool is_persistent)
+		{
+			VmaAllocationCreateFlags allocation_flags = 0;
+			if (is_writable)		allocation_flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+			if (is_readable)		allocation_flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+			if (is_persistent || is_writable || is_readable)
+				allocation_flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT; // Mapping once is cheaper than per write
+			return allocation_flags;
+		}
+
+		// Concurrent buffers are shared by the graphics, compute and transfer families (Exclusive if they are the same one)
+		std::vector<uint32_t> get_concurrent_queue_families(const VulkanContext& vulkan_context)
+		{
+			std::vector<uint32_t> queueFamilies;
+			for (auto queue_family : { vulkan_context.m_device_queue_family_graphics, vulkan_context.m_device_queue_family_compute, vulkan_context.m_device_queue_family_transfer })
+				if (std::find(queueFamilies.begin(), queueFamilies.end(), queue_family.value()) == queueFamilies.end()) queueFamilies.emplace_back(queue_family.value());
+			if (queueFamilies.size() < 2) queueFamilies.clear();
+			return queueFamilies;
+		}
+
+		// Runs body(index) over [0, count) in ranges of at least MIN_RANGE on the worker pool (Inline if there is only one range)
+		template<typename Body>
+		void parallel_for(WorkerPool& worker_pool, size_t count, Body&& body)
+		{
+			constexpr size_t MIN_RANGE = 16;
+			const size_t rangeCount = std::clamp<size_t>(std::min(worker_pool.GetWorkerCount(), (count + MIN_RANGE - 1) / MIN_RANGE), 1, std::max<size_t>(count, 1));
+			if (rangeCount == 1)
+			{
+				for (size_t index = 0; index < count; ++index) body(index);
+				return;
+			}
+
+			std::vector<std::future<void>> futures;
+			futures.reserve(rangeCount);
+			for (size_t range = 0; range < rangeCount; ++range)
+			{
+				const size_t first = count * range / rangeCount, last = count * (range + 1) / rangeCount;
+				futures.emplace_back(worker_pool.Submit([&body, first, last]() { for (size_t index = first; index < last; ++index) body(index); }));
+			}
+			std::exception_ptr failure;
+			for (auto& future : futures) // Join all ranges before rethrowing, they reference the caller's frame
+			{
+				try { worker_pool.Wait(future); }
+				catch (...) { if (!failure) failure = std::current_exception(); }
+			}
+			if (failure) std::rethrow_exception(failure);
+		}
+	} // namespace
 
 	VMA::VulkanMemoryAllocator(std::shared_ptr<VulkanContext> vulkan_context) :
-		m_context{ std::move(vulkan_context) }
+		m_context{ std::move(vulkan_context) },
+		m_memory_budget_tracked{ m_context->IsMemoryBudgetSupported() }
 	{
 		VmaAllocatorCreateInfo vmaAllocatorCreateInfo
 		{ 
-			.flags = 0x0, //VmaAllocatorCreateFlagBits
+			.flags = (m_memory_budget_tracked? VmaAllocatorCreateFlags(VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT) : VmaAllocatorCreateFlags(0)) |
+							(m_context->IsBufferDeviceAddressSupported()? VmaAllocatorCreateFlags(VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT) : VmaAllocatorCreateFlags(0)) |
+							(m_context->IsMemoryPrioritySupported()? VmaAllocatorCreateFlags(VMA_ALLOCATOR_CREATE_EXT_MEMORY_PRIORITY_BIT) : VmaAllocatorCreateFlags(0)), //VmaAllocatorCreateFlagBits
 			.physicalDevice = m_context->m_physical_device,
 			.device = m_context->m_device,
 			.preferredLargeHeapBlockSize = 0, // 0 means Default (256MiB)
@@ -27,73 +151,602 @@ namespace RHI
 		
 		if (vmaCreateAllocator(&vmaAllocatorCreateInfo, &m_allocator) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create the VMA (Vulkan Memory Allocator)!");
+
+		const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+		vmaGetMemoryProperties(m_allocator, &memoryProperties);
+		for (uint32_t memory_type = 0; memory_type < memoryProperties->memoryTypeCount; ++memory_type)
+		{
+			if (memoryProperties->memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+				m_lazily_allocated_memory_types |= 1u << memory_type;
+		}
+
+		// Resizable BAR: The whole VRAM heap is host-visible (Without it, the window is 256 MiB and too precious for generic buffers)
+		constexpr VkDeviceSize LEGACY_BAR_SIZE = 256ull * 1024 * 1024;
+		constexpr VkMemoryPropertyFlags BAR_PROPERTIES = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		const auto& deviceMemoryProperties = m_context->m_physical_device_memory_properties;
+		for (uint32_t memory_type = 0; memory_type < deviceMemoryProperties.memoryTypeCount; ++memory_type)
+		{
+			const auto& memoryType = deviceMemoryProperties.memoryTypes[memory_type];
+			const VkDeviceSize heapSize = deviceMemoryProperties.memoryHeaps[memoryType.heapIndex].size;
+			if ((memoryType.propertyFlags & BAR_PROPERTIES) != BAR_PROPERTIES || heapSize <= LEGACY_BAR_SIZE) continue;
+			if (!m_resizable_bar_heap || heapSize > deviceMemoryProperties.memoryHeaps[*m_resizable_bar_heap].size)
+				m_resizable_bar_heap = memoryType.heapIndex;
+		}
 	}
 
 	VMA::~VulkanMemoryAllocator()
 	{
+		cancel_defragmentation();
+		for (auto& [key, memory_pool] : m_memory_pools) vmaDestroyPool(m_allocator, memory_pool); // Resources keep the allocator alive
+		for (auto& [key, exportable_pool] : m_exportable_pools) vmaDestroyPool(m_allocator, exportable_pool.pool);
 		vmaDestroyAllocator(m_allocator);
 	}
 
+	void VMA::ConfigureMemoryPool(MemoryPool memory_pool, VkDeviceSize block_size, size_t max_block_count/* = 0*/)
+	{
+		assert(memory_pool != MemoryPool::GENERAL && memory_pool != MemoryPool::COUNT && "The general heap is managed by VMA!");
+		assert(block_size > 0 && "Invalid block size of the memory pool!");
+		std::scoped_lock guard{ m_memory_pool_mutex };
+		auto poolIndex = static_cast<uint64_t>(memory_pool);
+		if (std::any_of(m_memory_pools.begin(), m_memory_pools.end(), [poolIndex](const auto& pool) { return (pool.first >> 32) == poolIndex; }))
+			throw std::runtime_error("Failed to configure the memory pool - It has already been used!");
+		auto& config = m_memory_pool_configs[poolIndex];
+		config.block_size = block_size;
+		config.max_block_count = (memory_pool == MemoryPool::FRAME)? 1 : max_block_count; // Ring buffers need a single block
+	}
+
+	void VMA::ConfigureMemoryPriority(MemoryPool memory_pool, MemoryPriority priority)
+	{
+		assert(memory_pool != MemoryPool::COUNT && "Invalid memory pool!");
+		std::scoped_lock guard{ m_memory_pool_mutex };
+		auto poolIndex = static_cast<uint64_t>(memory_pool);
+		if (std::any_of(m_memory_pools.begin(), m_memory_pools.end(), [poolIndex](const auto& pool) { return (pool.first >> 32) == poolIndex; }))
+			throw std::runtime_error("Failed to configure the memory priority - The memory pool has already been used!");
+		m_memory_pool_configs[poolIndex].priority = priority;
+	}
+
+	VMA::MemoryPoolStatistics VMA::GetMemoryPoolStatistics(MemoryPool memory_pool)
+	{
+		std::scoped_lock guard{ m_memory_pool_mutex };
+		auto poolIndex = static_cast<uint64_t>(memory_pool);
+		const auto& config = m_memory_pool_configs[poolIndex];
+		MemoryPoolStatistics statistics{ .budget = config.block_size * config.max_block_count };
+		for (auto& [key, pool] : m_memory_pools)
+		{
+			if ((key >> 32) != poolIndex) continue;
+			VmaStatistics poolStatistics{};
+			vmaGetPoolStatistics(m_allocator, pool, &poolStatistics);
+			statistics.block_bytes += poolStatistics.blockBytes;
+			statistics.allocation_bytes += poolStatistics.allocationBytes;
+			statistics.allocation_count += poolStatistics.allocationCount;
+		}
+		return statistics;
+	}
+
+	VMA::MemoryStatistics VMA::GetStatistics()
+	{
+		VmaTotalStatistics totalStatistics{};
+		vmaCalculateStatistics(m_allocator, &totalStatistics);
+		auto makeDetail = [](const VmaDetailedStatistics& statistics)
+		{
+			VkDeviceSize unusedBytes = statistics.statistics.blockBytes - statistics.statistics.allocationBytes;
+			return MemoryStatistics::Detail
+			{
+				.block_count = statistics.statistics.blockCount,
+				.block_bytes = statistics.statistics.blockBytes,
+				.allocation_count = statistics.statistics.allocationCount,
+				.allocation_bytes = statistics.statistics.allocationBytes,
+				.unused_range_count = statistics.unusedRangeCount,
+				.largest_unused_range = statistics.unusedRangeSizeMax,
+				.fragmentation = unusedBytes ? 1.0f - static_cast<float>(statistics.unusedRangeSizeMax) / static_cast<float>(unusedBytes) : 0.0f
+			};
+		};
+
+		const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+		vmaGetMemoryProperties(m_allocator, &memoryProperties);
+		MemoryStatistics statistics{ .total = makeDetail(totalStatistics.total) };
+		for (uint32_t heap_index = 0; heap_index < memoryProperties->memoryHeapCount; ++heap_index)
+			statistics.heaps.emplace_back(makeDetail(totalStatistics.memoryHeap[heap_index]));
+		for (uint32_t type_index = 0; type_index < memoryProperties->memoryTypeCount; ++type_index)
+			statistics.memory_types.emplace_back(makeDetail(totalStatistics.memoryType[type_index]));
+		return statistics;
+	}
+
+	void VMA::DumpJson(std::string_view path, bool detailed/* = true*/)
+	{
+		char* statsString = nullptr;
+		vmaBuildStatsString(m_allocator, &statsString, detailed ? VK_TRUE : VK_FALSE);
+		std::ofstream file(std::string(path), std::ios::trunc);
+		bool written = file.is_open() && (file << statsString);
+		vmaFreeStatsString(m_allocator, statsString);
+		if (!written) throw std::runtime_error(std::format("Failed to dump the VMA statistics to {}!", path));
+	}
+
+	void VMA::UpdateMemoryBudget()
+	{
+		vmaSetCurrentFrameIndex(m_allocator, ++m_frame_number);
+
+		std::vector<MemoryPressureHandler> handlers;
+		{
+			std::scoped_lock guard{ m_memory_pressure_mutex };
+			if (m_memory_pressure_handlers.empty()) return;
+			handlers = m_memory_pressure_handlers; // Callbacks may (un)register handlers
+		}
+		auto heapBudgets = GetMemoryBudgets();
+		for (uint32_t heap_index = 0; heap_index < heapBudgets.size(); ++heap_index)
+		{
+			const auto& heapBudget = heapBudgets[heap_index];
+			for (auto& handler : handlers)
+			{
+				if (handler.device_local_only && !heapBudget.device_local) continue;
+				if (heapBudget.GetPressure() >= handler.pressure_threshold) handler.callback(heap_index, heapBudget);
+			}
+		}
+	}
+
+	VkDeviceSize VMA::TrimMemory()
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::TrimMemory");
+		std::vector<MemoryPressureHandler> handlers;
+		{
+			std::scoped_lock guard{ m_memory_pressure_mutex };
+			handlers = m_memory_pressure_handlers;
+		}
+		auto heapBudgets = GetMemoryBudgets();
+		for (uint32_t heap_index = 0; heap_index < heapBudgets.size(); ++heap_index)
+		{
+			for (auto& handler : handlers)
+				if (!handler.device_local_only || heapBudgets[heap_index].device_local) handler.callback(heap_index, heapBudgets[heap_index]);
+		}
+		m_context->WaitDeviceIdle(); // The evicted resources are deferred
+
+		// Each pool keeps one empty block for reuse (The default heap is left to VMA)
+		VkDeviceSize trimmedBytes = 0;
+		std::scoped_lock guard{ m_memory_pool_mutex };
+		for (auto iter = m_memory_pools.begin(); iter != m_memory_pools.end();)
+		{
+			VmaStatistics poolStatistics{};
+			vmaGetPoolStatistics(m_allocator, iter->second, &poolStatistics);
+			if (poolStatistics.allocationCount != 0) { ++iter; continue; }
+			trimmedBytes += poolStatistics.blockBytes;
+			vmaDestroyPool(m_allocator, iter->second);
+			iter = m_memory_pools.erase(iter);
+		}
+		return trimmedBytes;
+	}
+
+	std::vector<VMA::MemoryHeapBudget> VMA::GetMemoryBudgets()
+	{
+		const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+		vmaGetMemoryProperties(m_allocator, &memoryProperties);
+		std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> vmaBudgets{};
+		vmaGetHeapBudgets(m_allocator, vmaBudgets.data());
+
+		std::vector<MemoryHeapBudget> heapBudgets(memoryProperties->memoryHeapCount);
+		for (uint32_t heap_index = 0; heap_index < memoryProperties->memoryHeapCount; ++heap_index)
+		{
+			heapBudgets[heap_index] = MemoryHeapBudget
+			{
+				.budget = vmaBudgets[heap_index].budget,
+				.usage = vmaBudgets[heap_index].usage,
+				.block_bytes = vmaBudgets[heap_index].statistics.blockBytes,
+				.allocation_bytes = vmaBudgets[heap_index].statistics.allocationBytes,
+				.device_local = bool(memoryProperties->memoryHeaps[heap_index].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			};
+		}
+		return heapBudgets;
+	}
+
+	uint64_t VMA::RegisterMemoryPressureCallback(MemoryPressureCallback callback, float pressure_threshold/* = 0.9f*/, bool device_local_only/* = true*/)
+	{
+		assert(callback && pressure_threshold > 0.0f && "Invalid memory pressure callback!");
+		std::scoped_lock guard{ m_memory_pressure_mutex };
+		uint64_t callbackId = m_next_memory_pressure_handler_id++;
+		m_memory_pressure_handlers.emplace_back(MemoryPressureHandler
+			{
+				.id = callbackId,
+				.callback = std::move(callback),
+				.pressure_threshold = pressure_threshold,
+				.device_local_only = device_local_only
+			});
+		return callbackId;
+	}
+
+	void VMA::UnregisterMemoryPressureCallback(uint64_t callback_id)
+	{
+		std::scoped_lock guard{ m_memory_pressure_mutex };
+		std::erase_if(m_memory_pressure_handlers, [callback_id](const MemoryPressureHandler& handler) { return handler.id == callback_id; });
+	}
+
+	VmaPool VMA::get_memory_pool(MemoryPool memory_pool, uint32_t memory_type_index)
+	{
+		auto poolIndex = static_cast<uint64_t>(memory_pool);
+		std::scoped_lock guard{ m_memory_pool_mutex };
+		auto& pool = m_memory_pools[(poolIndex << 32) | memory_type_index];
+		if (pool != VK_NULL_HANDLE) return pool;
+
+		const auto& config = m_memory_pool_configs[poolIndex];
+		VmaPoolCreateInfo poolCreateInfo
+		{
+			.memoryTypeIndex = memory_type_index,
+			.flags = (memory_pool == MemoryPool::FRAME)? VmaPoolCreateFlags(VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT) : VmaPoolCreateFlags(0), // Default: TLSF
+			.blockSize = config.block_size,
+			.minBlockCount = 0,
+			.maxBlockCount = config.max_block_count,
+			.priority = GetMemoryPriorityValue(config.priority) // Overrides the priorities of its allocations
+		};
+		if (vmaCreatePool(m_allocator, &poolCreateInfo, &pool) != VK_SUCCESS)
+		{
+			m_memory_pools.erase((poolIndex << 32) | memory_type_index);
+			throw std::runtime_error("Failed to create the VMA memory pool!");
+		}
+		return pool;
+	}
+
+	template<typename Resource>
+	VkDeviceSize VMA::allocate_batch(std::span<const std::shared_ptr<Resource>> resources, std::span<const VkMemoryRequirements> requirements,
+		std::span<const uint32_t> memory_types, std::span<const VkFlags> allocation_flags)
+	{
+		std::map<uint32_t, VkDeviceSize> blockSizes; // Per memory type
+		for (size_t index = 0; index < resources.size(); ++index)
+		{
+			const auto& requirement = requirements[index];
+			blockSizes[memory_types[index]] += (requirement.size + requirement.alignment - 1) / requirement.alignment * requirement.alignment;
+		}
+		std::map<uint32_t, std::shared_ptr<VmaPool_T>> pools;
+		for (auto [memory_type, block_size] : blockSizes)
+		{
+			VmaPoolCreateInfo poolCreateInfo
+			{
+				.memoryTypeIndex = memory_type,
+				.flags = 0x0, // TLSF
+				.blockSize = block_size,
+				.minBlockCount = 1, // Allocated by vmaCreatePool()
+				.maxBlockCount = 0,
+				.priority = GetMemoryPriorityValue(MemoryPriority::NORMAL)
+			};
+			VmaPool pool = VK_NULL_HANDLE;
+			if (vmaCreatePool(m_allocator, &poolCreateInfo, &pool) != VK_SUCCESS)
+				throw std::runtime_error(std::format("Failed to reserve {} bytes of the memory type {} for the batch!", block_size, memory_type));
+			// Destroyed after the deferred deletion of the last resource of the batch
+			pools[memory_type] = std::shared_ptr<VmaPool_T>{ pool, [allocator = shared_from_this()](VmaPool pool)
+				{ vmaDestroyPool(allocator->m_allocator, pool); } };
+		}
+
+		// Largest alignment first, so every offset stays aligned and the block fits exactly
+		// (Linear & optimal images may still be padded by bufferImageGranularity, the pool then grows by another block)
+		std::vector<size_t> order(resources.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&requirements](size_t left, size_t right)
+			{ return requirements[left].alignment > requirements[right].alignment; });
+
+		VkDeviceSize allocatedBytes = 0;
+		for (auto index : order)
+		{
+			auto& resource = *resources[index];
+			auto& pool = pools[memory_types[index]];
+			VmaAllocationCreateInfo allocationInfo
+			{
+				.flags = allocation_flags[index],
+				.pool = pool.get()
+			};
+			VmaAllocationInfo allocatedInfo{};
+			if (vmaAllocateMemory(m_allocator, &requirements[index], &allocationInfo, &resource.m_allocation, &allocatedInfo) != VK_SUCCESS)
+				throw std::runtime_error("Failed to allocate the memory of the batch!");
+			resource.m_batch_pool = pool;
+			allocatedBytes += allocatedInfo.size;
+		}
+		return allocatedBytes;
+	}
+
 	std::shared_ptr<VMA::Buffer> VMA::AllocateBuffer(size_t size, VkBufferUsageFlags usage, 
-			bool is_exclusive /*= true*/, bool is_writable/* = false*/, bool is_readable/* = false*/, bool is_persistent/* = false*/)
+			bool is_exclusive /*= true*/, bool is_writable/* = false*/, bool is_readable/* = false*/, bool is_persistent/* = false*/,
+			MemoryPool memory_pool/* = MemoryPool::GENERAL*/)
 		// If both is_writable and is_readable are false, the memory property is Device Local
 	{
+		return allocate_buffer(size, usage, is_exclusive, make_host_access_flags(is_writable, is_readable, is_persistent), memory_pool);
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::AllocateDirectBuffer(size_t size, VkBufferUsageFlags usage, MemoryPool memory_pool/* = MemoryPool::GENERAL*/)
+	{
+		usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT; // vkCmdUpdateBuffer fallback
+		// VMA prefers the BAR memory, and only falls back to device-only memory when it is exhausted (Never to system memory)
+		VmaAllocationCreateFlags allocation_flags = IsResizableBarEnabled()?
+			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT : 0;
+		return allocate_buffer(size, usage, true, allocation_flags, memory_pool);
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::allocate_buffer(size_t size, VkBufferUsageFlags usage, bool is_exclusive,
+		VkFlags allocation_flags, MemoryPool memory_pool, const void* p_next/* = nullptr*/)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateBuffer");
+		if ((usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) && !m_context->IsBufferDeviceAddressSupported())
+			throw std::runtime_error("Failed to create the Vulkan Buffer - Buffer device addresses are not supported by this device!");
+
+		std::vector<uint32_t> queueFamilies;
+		if (!is_exclusive) queueFamilies = get_concurrent_queue_families(*m_context);
 		VkBufferCreateInfo bufferCreateInfo
 		{
 			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = p_next,
 			.size = size,
 			.usage = usage,
-			.sharingMode = is_exclusive? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT
+			.sharingMode = queueFamilies.empty()? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT,
+			.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size()),
+			.pQueueFamilyIndices = queueFamilies.data()
 		};
 
-		VmaAllocationCreateFlags allocation_flags = 0;
-		if (is_writable)		allocation_flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
-		if (is_readable)		allocation_flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
-		if (is_persistent)	allocation_flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
 		VmaAllocationCreateInfo allocationInfo
 		{
 			.flags = allocation_flags,
 			.usage = VMA_MEMORY_USAGE_AUTO,
 			//.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
 		}; 
+		if (memory_pool != MemoryPool::GENERAL)
+		{
+			uint32_t memoryTypeIndex = 0;
+			if (vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &bufferCreateInfo, &allocationInfo, &memoryTypeIndex) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Buffer - No suitable memory type!");
+			allocationInfo.pool = get_memory_pool(memory_pool, memoryTypeIndex);
+		}
 
 		auto buffer = std::make_shared<VMA::Buffer>(shared_from_this());
 
+		VmaAllocationInfo allocatedInfo{};
 		if (vmaCreateBuffer(
 			m_allocator,
 			&bufferCreateInfo,
 			&allocationInfo,
 			&buffer->m_buffer,
 			&buffer->m_allocation,
-			nullptr) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Buffer!");
+			&allocatedInfo) != VK_SUCCESS)
+			throw std::runtime_error((memory_pool == MemoryPool::GENERAL)? "Failed to create the Vulkan Buffer!" :
+				"Failed to create the Vulkan Buffer - The budget of the memory pool is exhausted!");
+		m_context->GetStatistics().Add(RHIStatistics::BUFFER_ALLOCATIONS);
+		m_context->GetStatistics().Add(RHIStatistics::BUFFER_BYTES, allocatedInfo.size);
+		if (auto capture = m_context->GetCommandCapture(); capture && !p_next) // Video buffers cannot be replayed without their profiles
+			capture->AddBuffer(buffer->m_buffer, size, usage);
+
+		buffer->m_state_tracker.Reset(size);
+		buffer->m_buffer_size = size;
+		buffer->m_buffer_usage = usage;
+		buffer->m_sharing_mode = bufferCreateInfo.sharingMode;
+		buffer->m_queue_families = std::move(queueFamilies);
+		VkMemoryPropertyFlags memoryProperties = 0;
+		vmaGetAllocationMemoryProperties(m_allocator, buffer->m_allocation, &memoryProperties);
+		buffer->m_is_host_visible = memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+		if constexpr (EnableDebugMarkers)
+			buffer->SetDebugName(std::format("VMA::Buffer ({} bytes, usage {:#x})", size, usage).c_str());
 		
 		return buffer;
 	}
 
+	std::vector<std::shared_ptr<VMA::Buffer>> VMA::AllocateBuffers(std::span<const BufferDesc> buffer_descs)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateBuffers");
+		if (buffer_descs.empty()) return {};
+
+		const std::vector<uint32_t> concurrentQueueFamilies = get_concurrent_queue_families(*m_context);
+		auto make_buffer_create_info = [&concurrentQueueFamilies](const BufferDesc& buffer_desc)
+		{
+			const bool isConcurrent = !buffer_desc.is_exclusive && !concurrentQueueFamilies.empty();
+			return VkBufferCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				.size = buffer_desc.size,
+				.usage = buffer_desc.usage,
+				.sharingMode = isConcurrent? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+				.queueFamilyIndexCount = isConcurrent? static_cast<uint32_t>(concurrentQueueFamilies.size()) : 0u,
+				.pQueueFamilyIndices = isConcurrent? concurrentQueueFamilies.data() : nullptr
+			};
+		};
+
+		// Memory types by usage, host access & sharing mode (Buffers only differing in their sizes share them)
+		std::vector<uint32_t> memoryTypes(buffer_descs.size());
+		std::vector<VkFlags> allocationFlags(buffer_descs.size());
+		std::map<std::tuple<VkBufferUsageFlags, VkFlags, VkSharingMode>, uint32_t> memoryTypeCache;
+		for (size_t index = 0; index < buffer_descs.size(); ++index)
+		{
+			const auto& buffer_desc = buffer_descs[index];
+			if ((buffer_desc.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) && !m_context->IsBufferDeviceAddressSupported())
+				throw std::runtime_error("Failed to create the Vulkan Buffers - Buffer device addresses are not supported by this device!");
+			allocationFlags[index] = make_host_access_flags(buffer_desc.is_writable, buffer_desc.is_readable, buffer_desc.is_persistent);
+			const VkBufferCreateInfo bufferCreateInfo = make_buffer_create_info(buffer_desc);
+			auto [cached, isNew] = memoryTypeCache.try_emplace({ buffer_desc.usage, allocationFlags[index], bufferCreateInfo.sharingMode }, 0);
+			if (isNew)
+			{
+				VmaAllocationCreateInfo allocationInfo{ .flags = allocationFlags[index], .usage = VMA_MEMORY_USAGE_AUTO };
+				if (vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &bufferCreateInfo, &allocationInfo, &cached->second) != VK_SUCCESS)
+					throw std::runtime_error("Failed to create the Vulkan Buffers - No suitable memory type!");
+			}
+			memoryTypes[index] = cached->second;
+		}
+
+		std::vector<std::shared_ptr<Buffer>> buffers(buffer_descs.size());
+		std::vector<VkMemoryRequirements> memoryRequirements(buffer_descs.size());
+		auto& workerPool = m_context->GetWorkerPool();
+		parallel_for(workerPool, buffer_descs.size(), [&, self = shared_from_this()](size_t index)
+		{
+			const auto& buffer_desc = buffer_descs[index];
+			const VkBufferCreateInfo bufferCreateInfo = make_buffer_create_info(buffer_desc);
+			auto buffer = std::make_shared<VMA::Buffer>(self);
+			if (vkCreateBuffer(
+				m_context->m_device,
+				&bufferCreateInfo,
+				m_context->m_memory_allocation_callback,
+				&buffer->m_buffer) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Buffer!");
+			vkGetBufferMemoryRequirements(m_context->m_device, buffer->m_buffer, &memoryRequirements[index]);
+			if (!(memoryRequirements[index].memoryTypeBits & (1u << memoryTypes[index])))
+				throw std::runtime_error("Failed to create the Vulkan Buffers - No suitable memory type!");
+
+			buffer->m_state_tracker.Reset(buffer_desc.size);
+			buffer->m_buffer_size = buffer_desc.size;
+			buffer->m_buffer_usage = buffer_desc.usage;
+			buffer->m_sharing_mode = bufferCreateInfo.sharingMode;
+			if (bufferCreateInfo.sharingMode == VK_SHARING_MODE_CONCURRENT) buffer->m_queue_families = concurrentQueueFamilies;
+			buffers[index] = std::move(buffer);
+		});
+
+		const VkDeviceSize allocatedBytes = allocate_batch<Buffer>(buffers, memoryRequirements, memoryTypes, allocationFlags);
+		parallel_for(workerPool, buffers.size(), [&](size_t index)
+		{
+			auto& buffer = *buffers[index];
+			if (vmaBindBufferMemory(m_allocator, buffer.m_allocation, buffer.m_buffer) != VK_SUCCESS)
+				throw std::runtime_error("Failed to bind the Vulkan Buffer to the memory of the batch!");
+			VkMemoryPropertyFlags memoryProperties = 0;
+			vmaGetAllocationMemoryProperties(m_allocator, buffer.m_allocation, &memoryProperties);
+			buffer.m_is_host_visible = memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+			if constexpr (EnableDebugMarkers)
+				buffer.SetDebugName(std::format("VMA::Buffer ({} bytes, usage {:#x}, batch)", buffer.m_buffer_size, buffer.m_buffer_usage).c_str());
+		});
+
+		m_context->GetStatistics().Add(RHIStatistics::BUFFER_ALLOCATIONS, buffers.size());
+		m_context->GetStatistics().Add(RHIStatistics::BUFFER_BYTES, allocatedBytes);
+		if (auto capture = m_context->GetCommandCapture())
+			for (auto& buffer : buffers) capture->AddBuffer(buffer->m_buffer, buffer->m_buffer_size, buffer->m_buffer_usage);
+		return buffers;
+	}
+
+	VkDeviceAddress VMA::Buffer::DeviceAddress()
+	{
+		assert((m_buffer_usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) && "The buffer was not allocated with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT!");
+		if (!m_device_address)
+		{
+			VkBufferDeviceAddressInfo bufferDeviceAddressInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+				.buffer = m_buffer
+			};
+			m_device_address = vkGetBufferDeviceAddress(m_parent->m_context->m_device, &bufferDeviceAddressInfo);
+		}
+		return m_device_address;
+	}
+
+	void VMA::Buffer::SetDebugName(const char* name)
+	{
+		DebugUtils::SetObjectName(m_parent->m_context->m_device, VK_OBJECT_TYPE_BUFFER, m_buffer, name);
+		if (m_allocation != VK_NULL_HANDLE) vmaSetAllocationName(m_parent->m_allocator, m_allocation, name); // Listed by DumpJson()
+	}
+
 	VMA::Buffer::~Buffer() 
 	{ 
-		vmaDestroyBuffer(m_parent->m_allocator, m_buffer, m_allocation); 
+		bool isMoving = m_is_movable && m_parent->release_movable(m_allocation); // The memory is freed by the defragmentation pass
+		std::vector<VkBufferView> bufferViews;
+		for (const auto& texel_view : m_texel_views) bufferViews.emplace_back(texel_view.view);
+		m_parent->m_context->InvalidateBakedCommands(m_buffer);
+		m_parent->m_context->DeferDeletion([allocator = m_parent, buffer = m_buffer, buffer_views = std::move(bufferViews),
+			allocation = isMoving? VK_NULL_HANDLE : m_allocation, imported_memory = m_imported_memory, peer_source = m_peer_source,
+			batch_pool = m_batch_pool]()
+			{
+				for (auto buffer_view : buffer_views)
+					vkDestroyBufferView(allocator->m_context->m_device, buffer_view, allocator->m_context->m_memory_allocation_callback);
+				vmaDestroyBuffer(allocator->m_allocator, buffer, allocation); // Imported & peer buffers release their memory with this deleter, batches their pool
+			});
+	}
+
+	void VMA::Buffer::EnableDefragmentation(std::function<void(Buffer&)> on_moved/* = {}*/)
+	{
+		if (m_export_handle_type || m_imported_memory)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Buffer - External memory cannot be moved!");
+		if (m_has_peers || m_peer_source)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Buffer - Peer bound memory cannot be moved!");
+		if (m_batch_pool)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Buffer - Batch memory cannot be moved!");
+		constexpr VkBufferUsageFlags copyUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		if ((m_buffer_usage & copyUsage) != copyUsage)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Buffer - It cannot be copied!");
+		m_on_moved = std::move(on_moved);
+		if (m_is_movable) return;
+		std::scoped_lock guard{ m_parent->m_defragmentation_mutex };
+		m_parent->m_movable_resources[m_allocation] = { this, nullptr };
+		m_is_movable = true;
 	}
 
 
 
-	void VMA::Buffer::Write(void* data)
+	void VMA::Buffer::Write(const void* data)
+	{
+		Write(std::span{ static_cast<const std::byte*>(data), static_cast<size_t>(m_buffer_size) });
+	}
+
+	void VMA::Buffer::Write(std::span<const std::byte> data, VkDeviceSize offset/* = 0*/)
 	{
 		assert(m_allocation->IsMappingAllowed() && "This buffer is not mapping-allowed!");
+		assert(offset + data.size() <= m_buffer_size && "Writing out of the buffer!");
 
-		void* mappedArea;
 		if (m_allocation->IsPersistentMap())
 		{
-			mappedArea = m_allocation->GetMappedData();
-			memcpy(mappedArea, data, m_allocation->GetSize());
+			memcpy(static_cast<std::byte*>(m_allocation->GetMappedData()) + offset, data.data(), data.size());
 		}
 		else
 		{
+			void* mappedArea;
 			vmaMapMemory(m_parent->m_allocator, m_allocation, &mappedArea);
-			memcpy(mappedArea, data, m_allocation->GetSize());
+			memcpy(static_cast<std::byte*>(mappedArea) + offset, data.data(), data.size());
 			vmaUnmapMemory(m_parent->m_allocator, m_allocation);
 		}
+		Flush(offset, data.size());
+	}
+
+	void VMA::Buffer::WriteCommand(CommandBuffer& commandBuffer, std::span<const std::byte> data, VkDeviceSize offset/* = 0*/)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(offset + data.size() <= m_buffer_size && "Writing out of the buffer!");
+		if (m_is_host_visible && m_allocation->IsPersistentMap())
+			return Write(data, offset); // In place (Host writes are made visible by the submission)
+
+		UpdateCommand(commandBuffer, data, offset);
+	}
+
+	void VMA::Buffer::UpdateCommand(CommandBuffer& commandBuffer, std::span<const std::byte> data,
+		VkDeviceSize offset/* = 0*/, StagingRing* staging_ring/* = nullptr*/)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(offset + data.size() <= m_buffer_size && "Writing out of the buffer!");
+		assert((m_buffer_usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && "Updated buffers need VK_BUFFER_USAGE_TRANSFER_DST_BIT!");
+		if (data.empty()) return;
+
+		constexpr VkDeviceSize MAX_UPDATE_SIZE = 65536; // vkCmdUpdateBuffer limit (The data is stored in the command buffer)
+		const bool isAligned = offset % 4 == 0 && data.size() % 4 == 0;
+		TransitionCommand(commandBuffer, ResourceAccess{ .stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT }, offset, data.size());
+		commandBuffer.FlushBarriers();
+
+		if (staging_ring && (data.size() > MAX_UPDATE_SIZE || !isAligned))
+		{
+			auto allocation = staging_ring->Allocate(data.size());
+			memcpy(allocation.data, data.data(), data.size());
+			staging_ring->Flush(allocation);
+			VkBufferCopy region
+			{
+				.srcOffset = allocation.offset,
+				.dstOffset = offset,
+				.size = data.size()
+			};
+			commandBuffer.GetDispatch().vkCmdCopyBuffer(commandBuffer, allocation.buffer, m_buffer, 1, &region);
+			return;
+		}
+
+		assert(isAligned && "vkCmdUpdateBuffer needs 4-byte aligned offsets and sizes!");
+		for (VkDeviceSize written = 0; written < data.size(); written += MAX_UPDATE_SIZE)
+		{
+			const VkDeviceSize chunkSize = std::min<VkDeviceSize>(MAX_UPDATE_SIZE, data.size() - written);
+			commandBuffer.GetDispatch().vkCmdUpdateBuffer(commandBuffer, m_buffer, offset + written, chunkSize, data.data() + written);
+		}
+	}
+
+	void VMA::Buffer::Flush(VkDeviceSize offset/* = 0*/, VkDeviceSize size/* = VK_WHOLE_SIZE*/)
+	{
+		vmaFlushAllocation(m_parent->m_allocator, m_allocation, offset, size); // Aligned to nonCoherentAtomSize by VMA
+	}
+
+	void VMA::Buffer::Invalidate(VkDeviceSize offset/* = 0*/, VkDeviceSize size/* = VK_WHOLE_SIZE*/)
+	{
+		vmaInvalidateAllocation(m_parent->m_allocator, m_allocation, offset, size);
 	}
 
 	void* VMA::Buffer::Access()
@@ -108,20 +761,20 @@ namespace RHI
 		auto commandBuffer = m_parent->m_context->
 			CreateOneTimeCommandBuffer(m_parent->m_context->m_device_queue_family_graphics);
 		commandBuffer->Begin();
-		CopyCommand(commandBuffer, destination, size, offset_src, offset_dst);
+		CopyCommand(*commandBuffer, *destination, size, offset_src, offset_dst);
 		commandBuffer->End();
 		commandBuffer->Submit(true); // Must wait for transfer operation
 	}
 
 	void VMA::Buffer::CopyCommand(
-		std::shared_ptr<CommandBuffer> commandBuffer, 
-		std::shared_ptr<Buffer> destination,
+		CommandBuffer& commandBuffer,
+		Buffer& destination,
 		VkDeviceSize size /* = ALL*/, VkDeviceSize offset_src/* = 0*/, VkDeviceSize offset_dst/* = 0*/)
 	{
-		assert(commandBuffer->IsRecording() &&
+		assert(commandBuffer.IsRecording() &&
 			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
 		size = size ? size : Size();
-		assert(size <= (destination->Size() - offset_dst) && "You cannot copy data to another small buffer!");
+		assert(size <= (destination.Size() - offset_dst) && "You cannot copy data to another small buffer!");
 		VkBufferCopy bufferCopy
 		{
 			.srcOffset = offset_src,
@@ -129,12 +782,82 @@ namespace RHI
 			.size = size ? size : Size()
 		};
 
-		vkCmdCopyBuffer(*commandBuffer, m_buffer, *destination, 1, &bufferCopy);
+		commandBuffer.FlushBarriers();
+		commandBuffer.capture(CaptureOpcode::COPY_BUFFER, m_buffer, destination.m_buffer, std::span<const VkBufferCopy>{ &bufferCopy, 1 });
+		commandBuffer.GetDispatch().vkCmdCopyBuffer(commandBuffer, m_buffer, destination, 1, &bufferCopy);
+	}
+
+	void VMA::Buffer::CopyCommand(CommandBuffer& commandBuffer, Buffer& destination, std::span<const VkBufferCopy> regions)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		if (regions.empty()) return;
+
+		std::vector<VkBufferCopy> bufferCopies{ regions.begin(), regions.end() };
+		std::sort(bufferCopies.begin(), bufferCopies.end(),
+			[](const VkBufferCopy& lhs, const VkBufferCopy& rhs) { return lhs.srcOffset < rhs.srcOffset; });
+		size_t mergedCount = 0;
+		for (const auto& region : bufferCopies)
+		{
+			assert(region.srcOffset + region.size <= Size() && "Copying out of the source buffer!");
+			assert(region.dstOffset + region.size <= destination.Size() && "You cannot copy data to another small buffer!");
+			if (mergedCount)
+			{
+				auto& last = bufferCopies[mergedCount - 1];
+				if (last.srcOffset + last.size == region.srcOffset && last.dstOffset + last.size == region.dstOffset)
+				{
+					last.size += region.size;
+					continue;
+				}
+			}
+			bufferCopies[mergedCount++] = region;
+		}
+		bufferCopies.resize(mergedCount);
+
+		commandBuffer.FlushBarriers();
+		commandBuffer.capture(CaptureOpcode::COPY_BUFFER, m_buffer, destination.m_buffer, bufferCopies);
+		commandBuffer.GetDispatch().vkCmdCopyBuffer(commandBuffer, m_buffer, destination, static_cast<uint32_t>(bufferCopies.size()), bufferCopies.data());
 	}
 
 	VkDeviceSize VMA::Buffer::Size()
 	{
-		return m_allocation->GetSize();
+		return m_buffer_size;
+	}
+
+	void VMA::Buffer::TransitionCommand(CommandBuffer& commandBuffer, const ResourceAccess& access,
+		VkDeviceSize offset/* = 0*/, VkDeviceSize size/* = VK_WHOLE_SIZE*/)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		thread_local std::vector<VkBufferMemoryBarrier2> bufferBarriers; // Keeps its capacity, so transitions do not allocate
+		bufferBarriers.clear();
+		m_state_tracker.Transition(m_buffer, offset, size, access, bufferBarriers);
+		for (const auto& buffer_barrier : bufferBarriers) commandBuffer.QueueBarrier(buffer_barrier); // Flushed before the next command
+	}
+
+	VkBufferView VMA::Buffer::GetTexelView(VkFormat format, VkDeviceSize offset/* = 0*/, VkDeviceSize range/* = VK_WHOLE_SIZE*/)
+	{
+		assert((m_buffer_usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT)) &&
+			"The buffer was not allocated with a texel buffer usage!");
+		assert(offset < m_buffer_size && (range == VK_WHOLE_SIZE || offset + range <= m_buffer_size) && "The view is out of the buffer!");
+		std::scoped_lock guard{ m_view_mutex };
+		auto cached = std::find_if(m_texel_views.begin(), m_texel_views.end(), [=](const TexelView& view)
+			{ return view.format == format && view.offset == offset && view.range == range; });
+		if (cached != m_texel_views.end()) return cached->view;
+
+		VkBufferViewCreateInfo bufferViewCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,
+			.buffer = m_buffer,
+			.format = format,
+			.offset = offset,
+			.range = range
+		};
+		VkBufferView bufferView = VK_NULL_HANDLE;
+		if (vkCreateBufferView(m_parent->m_context->m_device, &bufferViewCreateInfo, m_parent->m_context->m_memory_allocation_callback, &bufferView) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Buffer View!");
+		m_texel_views.emplace_back(TexelView{ .format = format, .offset = offset, .range = range, .view = bufferView });
+		return bufferView;
 	}
 
 	std::shared_ptr<VMA::Image> VMA::AllocateImage(
@@ -144,326 +867,2027 @@ namespace RHI
 		uint32_t channel, VkFormat format,
 		VkImageLayout layout/* = VK_IMAGE_LAYOUT_UNDEFINED*/,
 		VkImageTiling tiling_mode/* = VK_IMAGE_TILING_OPTIMAL*/,
-		uint32_t miplevel/* = 1*/)
+		uint32_t miplevel/* = 1*/,
+		MemoryPool memory_pool/* = MemoryPool::GENERAL*/,
+		ImageType image_type/* = ImageType::IMAGE_2D*/,
+		uint32_t depth_or_layers/* = 1*/,
+		VkSampleCountFlagBits samples/* = VK_SAMPLE_COUNT_1_BIT*/,
+		ImageCompression compression/* = {}*/)
 	{
-		VkImageCreateInfo imageCreateInfo
-		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-			.flags = 0x0,
-			.imageType = VK_IMAGE_TYPE_2D,
-			.format = format,
-			.extent{.width = width, .height = height, .depth = 1}, // 2D Texture
-			.mipLevels = miplevel,
-			.arrayLayers = 1,
-			.samples = VK_SAMPLE_COUNT_1_BIT,
-			.tiling = tiling_mode, // P206
-			.usage = usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-			.sharingMode = VK_SHARING_MODE_EXCLUSIVE, // The image will only be used by one queue family: the one that supports graphics (and therefore also) transfer operations.
-			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED // P207 Top
-		};
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateImage");
+		if (const auto& formatTable = m_context->GetFormatTable(); formatTable.IsKnown(format) &&
+			!formatTable.IsSupported(format, tiling_mode, FormatTable::GetRequiredFeatures(usage)))
+			throw std::runtime_error(std::format("Failed to create the Vulkan Image - The format {} does not support the usage {:#x}!", static_cast<int>(format), usage));
+		samples = m_context->ClampSampleCount(samples, GetFormatAspect(format));
+		VkImageCreateInfo imageCreateInfo = make_image_create_info(usage, width, height, format, tiling_mode, miplevel, image_type, depth_or_layers, samples);
+		VkImageCompressionFlagsEXT compressionFlags = VK_IMAGE_COMPRESSION_DEFAULT_EXT;
+		VkImageCompressionFixedRateFlagsEXT compressionFixedRate = 0;
+		if (compression.mode != ImageCompression::DEFAULT && m_context->IsImageCompressionControlSupported())
+			std::tie(compressionFlags, compressionFixedRate) = resolve_image_compression(compression, imageCreateInfo);
+		const auto compressionControl = make_image_compression_control(compressionFlags, compressionFixedRate, imageCreateInfo.pNext);
+		if (compressionFlags != VK_IMAGE_COMPRESSION_DEFAULT_EXT) imageCreateInfo.pNext = &compressionControl;
 
+		bool isLazilyAllocated = (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) && m_lazily_allocated_memory_types;
+		const bool isRenderTarget = usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		MemoryPriority priority = isRenderTarget? MemoryPriority::HIGH : MemoryPriority::NORMAL;
+		{
+			std::scoped_lock guard{ m_memory_pool_mutex };
+			if (memory_pool != MemoryPool::GENERAL) priority = m_memory_pool_configs[static_cast<size_t>(memory_pool)].priority;
+		}
 		VmaAllocationCreateInfo allocationInfo
 		{
 			.flags = 0x0,
-			.usage = VMA_MEMORY_USAGE_AUTO,
-			.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			.usage = isLazilyAllocated? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_AUTO, // Tile-based GPUs may never back it
+			.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			.priority = GetMemoryPriorityValue(priority)
 		};
+		// Large render targets own their memory instead of sharing blocks with textures, so they are paged by their own priority
+		constexpr VkDeviceSize DEDICATED_RENDER_TARGET_SIZE = 16ull * 1024 * 1024;
+		const auto& swapchainExtent = m_context->m_swapchain_current_extent;
+		const uint64_t imageSize = GetFormatBlockInfo(format).GetRegionSize(width, height, depth_or_layers) * samples;
+		if (isRenderTarget && !isLazilyAllocated &&
+			((swapchainExtent.width && width >= swapchainExtent.width && height >= swapchainExtent.height) || imageSize >= DEDICATED_RENDER_TARGET_SIZE))
+			allocationInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		if (memory_pool != MemoryPool::GENERAL && !isLazilyAllocated) // Lazily allocated memory must not be suballocated from blocks
+		{
+			uint32_t memoryTypeIndex = 0;
+			if (vmaFindMemoryTypeIndexForImageInfo(m_allocator, &imageCreateInfo, &allocationInfo, &memoryTypeIndex) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Image - No suitable memory type!");
+			allocationInfo.pool = get_memory_pool(memory_pool, memoryTypeIndex);
+		}
 
 		auto image = std::make_shared<VMA::Image>(shared_from_this());
+		VmaAllocationInfo allocatedInfo{};
 		if (vmaCreateImage(
 			m_allocator,
 			&imageCreateInfo,
 			&allocationInfo,
 			&image->m_image,
 			&image->m_allocation,
-			nullptr) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Image!");
+			&allocatedInfo) != VK_SUCCESS)
+			throw std::runtime_error((allocationInfo.pool == VK_NULL_HANDLE)? "Failed to create the Vulkan Image!" :
+				"Failed to create the Vulkan Image - The budget of the memory pool is exhausted!");
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_ALLOCATIONS);
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_BYTES, allocatedInfo.size);
+		if (auto capture = m_context->GetCommandCapture()) capture->AddImage(image->m_image, imageCreateInfo);
 
-		image->m_image_format = format;
-		image->m_image_width = width;
-		image->m_image_height = height;
-		image->m_image_channel = channel;
-		image->m_mipmap_level = miplevel;
-		//image->m_image_layout = layout; (AUTO)
-
-		VkImageViewCreateInfo imageViewCreateInfo
+		setup_image(*image, aspect, imageCreateInfo.usage, width, height, channel, format, imageCreateInfo.mipLevels,
+			image_type, imageCreateInfo.extent.depth, imageCreateInfo.arrayLayers);
+		image->m_image_tiling = tiling_mode;
+		image->m_sample_count = samples;
+		image->m_is_dedicated = allocationInfo.flags & VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		if (compressionFlags != VK_IMAGE_COMPRESSION_DEFAULT_EXT)
 		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-			.image = image->m_image,
-			.viewType = VK_IMAGE_VIEW_TYPE_2D,
-			.format = format,
-			.components = VK_COMPONENT_SWIZZLE_IDENTITY,
-			.subresourceRange
-			{
-				.aspectMask = aspect,
-				.baseMipLevel = 0,
-				.levelCount = 1,
-				.baseArrayLayer = 0,
-				.layerCount = 1
-			}
-		};
-		if (vkCreateImageView(
-			m_context->m_device,
-			&imageViewCreateInfo,
-			m_context->m_memory_allocation_callback,
-			&image->m_image_view
-			) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Image View!");
+			image->m_compression_request = compressionFlags;
+			image->m_compression_fixed_rate_request = compressionFixedRate;
+			query_image_compression(*image);
+		}
 
 		// Transition Layout
 		if (VK_IMAGE_LAYOUT_UNDEFINED != layout) image->TransitionLayout(layout);
 
 		return image;
 	}
-	
-	VMA::Image::~Image()
-	{
-		vmaDestroyImage(m_parent->m_allocator, m_image, m_allocation);
-		vkDestroyImageView(m_parent->m_context->m_device, m_image_view, m_parent->m_context->m_memory_allocation_callback);
-	}
 
-	void VMA::Image::Write(std::shared_ptr<RHI::VMA::Buffer> data)
+	VkImageCompressionFixedRateFlagsEXT VMA::ImageCompression::SelectFixedRate(VkImageCompressionFixedRateFlagsEXT supported) const
 	{
-		auto commandBuffer = m_parent->m_context->
-			CreateOneTimeCommandBuffer(m_parent->m_context->m_device_queue_family_graphics);
-		commandBuffer->Begin();
-		WriteCommand(commandBuffer, data);
-		commandBuffer->End();
-		commandBuffer->Submit(true); // Must wait for transfer operation
+		if (!supported) return 0;
+		// Bit n is (n + 1) bits per component
+		const uint32_t requestedBit = std::clamp(bits_per_component, 1u, 24u) - 1;
+		const VkImageCompressionFixedRateFlagsEXT atOrAbove = supported & ~((VkImageCompressionFixedRateFlagsEXT(1) << requestedBit) - 1);
+		if (atOrAbove) return atOrAbove & (~atOrAbove + 1); // Lowest
+		return VkImageCompressionFixedRateFlagsEXT(1) << (std::bit_width(supported) - 1); // Highest
 	}
 
-	void VMA::Image::WriteCommand(std::shared_ptr<RHI::CommandBuffer> commandBuffer, std::shared_ptr<VMA::Buffer> data)
+	std::pair<VkImageCompressionFlagsEXT, VkImageCompressionFixedRateFlagsEXT> VMA::resolve_image_compression(const ImageCompression& compression,
+		const VkImageCreateInfo& image_create_info) const
 	{
-		assert(commandBuffer->IsRecording() &&
-			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
-		assert(data->Size() <= Size() && "It is not recommanded to write the image from a bigger buffer!");
-		if (m_image_channel != 4) log::warn("Writing a {} channels image, but automatically treating it as 4 channels", m_image_channel);
-
-		// Staging Buffer
-		size_t image_size = static_cast<size_t>(m_image_width) * m_image_height * 4;
+		if (compression.mode == ImageCompression::DISABLED) return { VK_IMAGE_COMPRESSION_DISABLED_EXT, 0 };
+		if (!compression.bits_per_component) return { VK_IMAGE_COMPRESSION_FIXED_RATE_DEFAULT_EXT, 0 };
 
-		// Copy buffer to image requires the image to be in the right layout first
-		VkBufferImageCopy copyRegion
+		// Fixed rates of the format for this image (A rate it does not support would fail the creation)
+		VkImageCompressionControlEXT queryControl
 		{
-			.bufferOffset = 0,
-			.bufferRowLength = 0,
-			.bufferImageHeight = 0,
-			.imageSubresource
-			{
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.mipLevel = 0,
-				.baseArrayLayer = 0,
-				.layerCount = 1,
-			},
-			.imageOffset = {0,0,0},
-			.imageExtent = {m_image_width, m_image_height, 1}
+			.sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT,
+			.flags = VK_IMAGE_COMPRESSION_FIXED_RATE_DEFAULT_EXT
 		};
-
-		auto oldLayout = m_image_layout;
-		TransitionLayoutCommand(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		vkCmdCopyBufferToImage(*commandBuffer, *data, m_image, m_image_layout, 1, &copyRegion);
-		TransitionLayoutCommand(commandBuffer, m_image_layout);
+		const VkPhysicalDeviceImageFormatInfo2 formatInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+			.pNext = &queryControl,
+			.format = image_create_info.format,
+			.type = image_create_info.imageType,
+			.tiling = image_create_info.tiling,
+			.usage = image_create_info.usage,
+			.flags = image_create_info.flags
+		};
+		VkImageCompressionPropertiesEXT compressionProperties{ .sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_PROPERTIES_EXT };
+		VkImageFormatProperties2 formatProperties{ .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2, .pNext = &compressionProperties };
+		if (vkGetPhysicalDeviceImageFormatProperties2(m_context->m_physical_device, &formatInfo, &formatProperties) != VK_SUCCESS)
+			return { VK_IMAGE_COMPRESSION_DEFAULT_EXT, 0 };
+		const auto fixedRate = compression.SelectFixedRate(compressionProperties.imageCompressionFixedRateFlags);
+		if (!fixedRate) return { VK_IMAGE_COMPRESSION_DEFAULT_EXT, 0 }; // No fixed-rate compression for the format
+		return { VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT, fixedRate };
 	}
 
-	void VMA::Image::WriteAndTransition(std::shared_ptr<Buffer> data, VkImageLayout final_layout)
+	void VMA::query_image_compression(Image& image)
 	{
-		auto commandBuffer = m_parent->m_context->
-			CreateOneTimeCommandBuffer(m_parent->m_context->m_device_queue_family_graphics);
-		commandBuffer->Begin();
-		WriteAndTransitionCommand(commandBuffer, data, final_layout);
-		commandBuffer->End();
-		commandBuffer->Submit(true); // Must wait for transfer operation
+		const VkImageAspectFlags aspect = GetFormatAspect(image.m_image_format);
+		VkImageCompressionPropertiesEXT compressionProperties{ .sType = VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_PROPERTIES_EXT };
+		VkSubresourceLayout2EXT subresourceLayout{ .sType = VK_STRUCTURE_TYPE_SUBRESOURCE_LAYOUT_2_EXT, .pNext = &compressionProperties };
+		const VkImageSubresource2EXT subresource
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_SUBRESOURCE_2_EXT,
+			.imageSubresource{ .aspectMask = (aspect & VK_IMAGE_ASPECT_COLOR_BIT)? VK_IMAGE_ASPECT_COLOR_BIT :
+				(aspect & VK_IMAGE_ASPECT_DEPTH_BIT)? VK_IMAGE_ASPECT_DEPTH_BIT : aspect } // One aspect
+		};
+		m_context->m_get_image_subresource_layout2(m_context->m_device, image.m_image, &subresource, &subresourceLayout);
+		image.m_compression_flags = compressionProperties.imageCompressionFlags;
+		image.m_compression_fixed_rate = compressionProperties.imageCompressionFixedRateFlags;
 	}
 
-	void VMA::Image::WriteAndTransitionCommand(
-		std::shared_ptr<RHI::CommandBuffer> commandBuffer, 
-		std::shared_ptr<Buffer> data, VkImageLayout final_layout)
+	std::vector<std::shared_ptr<VMA::Image>> VMA::AllocateImages(std::span<const ImageDesc> image_descs)
 	{
-		assert(commandBuffer->IsRecording() &&
-			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
-		assert(data->Size() <= Size() && "It is not recommanded to write the image from a bigger buffer!");
-		if (m_image_channel != 4) log::warn("Writing a {} channels image, but automatically treating it as 4 channels", m_image_channel);
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateImages");
+		if (image_descs.empty()) return {};
 
-		// Staging Buffer
-		size_t image_size = static_cast<size_t>(m_image_width) * m_image_height * 4;
+		// Memory types by format, tiling, usage & flags (Images only differing in their extents share them)
+		std::vector<VkImageCreateInfo> imageCreateInfos(image_descs.size());
+		std::vector<uint32_t> memoryTypes(image_descs.size());
+		std::map<std::tuple<VkFormat, VkImageTiling, VkImageUsageFlags, VkImageCreateFlags, VkImageType>, uint32_t> memoryTypeCache;
+		const auto& formatTable = m_context->GetFormatTable();
+		for (size_t index = 0; index < image_descs.size(); ++index)
+		{
+			const auto& image_desc = image_descs[index];
+			if (image_desc.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+				throw std::runtime_error("Failed to create the Vulkan Images - Transient attachments cannot be allocated in batches!");
+			if (formatTable.IsKnown(image_desc.format) &&
+				!formatTable.IsSupported(image_desc.format, image_desc.tiling_mode, FormatTable::GetRequiredFeatures(image_desc.usage)))
+				throw std::runtime_error(std::format("Failed to create the Vulkan Image - The format {} does not support the usage {:#x}!", static_cast<int>(image_desc.format), image_desc.usage));
+			auto& imageCreateInfo = imageCreateInfos[index] = make_image_create_info(image_desc.usage, image_desc.width, image_desc.height,
+				image_desc.format, image_desc.tiling_mode, image_desc.miplevel, image_desc.image_type, image_desc.depth_or_layers);
+			auto [cached, isNew] = memoryTypeCache.try_emplace(
+				{ imageCreateInfo.format, imageCreateInfo.tiling, imageCreateInfo.usage, imageCreateInfo.flags, imageCreateInfo.imageType }, 0);
+			if (isNew)
+			{
+				VmaAllocationCreateInfo allocationInfo{ .usage = VMA_MEMORY_USAGE_AUTO, .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+				if (vmaFindMemoryTypeIndexForImageInfo(m_allocator, &imageCreateInfo, &allocationInfo, &cached->second) != VK_SUCCESS)
+					throw std::runtime_error("Failed to create the Vulkan Images - No suitable memory type!");
+			}
+			memoryTypes[index] = cached->second;
+		}
 
-		// Copy buffer to image requires the image to be in the right layout first
-		VkBufferImageCopy copyRegion
+		std::vector<std::shared_ptr<Image>> images(image_descs.size());
+		std::vector<VkMemoryRequirements> memoryRequirements(image_descs.size());
+		auto& workerPool = m_context->GetWorkerPool();
+		parallel_for(workerPool, image_descs.size(), [&, self = shared_from_this()](size_t index)
+		{
+			const auto& image_desc = image_descs[index];
+			const auto& imageCreateInfo = imageCreateInfos[index];
+			auto image = std::make_shared<VMA::Image>(self);
+			if (vkCreateImage(
+				m_context->m_device,
+				&imageCreateInfo,
+				m_context->m_memory_allocation_callback,
+				&image->m_image) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Image!");
+			vkGetImageMemoryRequirements(m_context->m_device, image->m_image, &memoryRequirements[index]);
+			if (!(memoryRequirements[index].memoryTypeBits & (1u << memoryTypes[index])))
+				throw std::runtime_error("Failed to create the Vulkan Images - No suitable memory type!");
+
+			setup_image(*image, image_desc.aspect, imageCreateInfo.usage, image_desc.width, image_desc.height, image_desc.channel, image_desc.format,
+				imageCreateInfo.mipLevels, image_desc.image_type, imageCreateInfo.extent.depth, imageCreateInfo.arrayLayers);
+			image->m_image_tiling = image_desc.tiling_mode;
+			images[index] = std::move(image);
+		});
+
+		const std::vector<VkFlags> allocationFlags(image_descs.size(), 0x0);
+		const VkDeviceSize allocatedBytes = allocate_batch<Image>(images, memoryRequirements, memoryTypes, allocationFlags);
+		parallel_for(workerPool, images.size(), [&](size_t index)
+		{
+			auto& image = *images[index];
+			if (vmaBindImageMemory(m_allocator, image.m_allocation, image.m_image) != VK_SUCCESS)
+				throw std::runtime_error("Failed to bind the Vulkan Image to the memory of the batch!");
+		});
+
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_ALLOCATIONS, images.size());
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_BYTES, allocatedBytes);
+		if (auto capture = m_context->GetCommandCapture())
+			for (size_t index = 0; index < images.size(); ++index) capture->AddImage(images[index]->m_image, imageCreateInfos[index]);
+		return images;
+	}
+
+	std::shared_ptr<VMA::Image> VMA::AllocateMultisampledAttachment(
+		VkImageAspectFlags aspect,
+		VkImageUsageFlags usage,
+		uint32_t width, uint32_t height,
+		VkFormat format, VkSampleCountFlagBits samples,
+		MemoryPool memory_pool/* = MemoryPool::RENDER_TARGET*/)
+	{
+		constexpr VkImageUsageFlags AttachmentUsages = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+			VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		assert((usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) && "MSAA images must be attachments!");
+		if (!(usage & ~AttachmentUsages)) usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT; // Never leaves the tile memory
+		return AllocateImage(aspect, usage, width, height, 4, format,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL, 1, memory_pool, ImageType::IMAGE_2D, 1, samples);
+	}
+
+	std::shared_ptr<VMA::Image> VMA::AllocateSparseImage(
+		VkImageAspectFlags aspect,
+		VkImageUsageFlags usage,
+		uint32_t width, uint32_t height,
+		uint32_t channel, VkFormat format,
+		uint32_t miplevel/* = 0*/,
+		ImageType image_type/* = ImageType::IMAGE_2D*/,
+		uint32_t depth_or_layers/* = 1*/)
+	{
+		const auto& features = m_context->m_physical_device_features;
+		if (!m_context->IsSparseResidencySupported() ||
+			(image_type == ImageType::IMAGE_3D && !features.sparseResidencyImage3D))
+			throw std::runtime_error("Failed to create the Sparse Vulkan Image - Sparse residency is not supported by this device!");
+
+		VkImageCreateInfo imageCreateInfo = make_image_create_info(usage, width, height, format, VK_IMAGE_TILING_OPTIMAL, miplevel, image_type, depth_or_layers);
+		imageCreateInfo.flags |= VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
+
+		auto image = std::make_shared<VMA::Image>(shared_from_this());
+		if (vkCreateImage(
+			m_context->m_device,
+			&imageCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&image->m_image) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Sparse Vulkan Image!");
+
+		setup_image(*image, aspect, imageCreateInfo.usage, width, height, channel, format, imageCreateInfo.mipLevels,
+			image_type, imageCreateInfo.extent.depth, imageCreateInfo.arrayLayers);
+		return image; // vmaDestroyImage() without an allocation only destroys the image
+	}
+
+	std::vector<std::shared_ptr<VMA::Image>> VMA::
+		AllocateAliasedImages(const std::vector<TransientImageInfo>& image_infos)
+	{
+		if (image_infos.empty()) return {};
+
+		std::vector<std::shared_ptr<Image>> images;
+		images.reserve(image_infos.size());
+		std::vector<VkMemoryRequirements> memoryRequirements(image_infos.size());
+		uint32_t memoryTypeBits = ~0u;
+		bool isTransient = true;
+		for (size_t index = 0; index < image_infos.size(); ++index)
+		{
+			auto& image_info = image_infos[index];
+			assert(image_info.first_use <= image_info.last_use && "Invalid lifetime of the transient image!");
+			VkImageCreateInfo imageCreateInfo = make_image_create_info(image_info.usage,
+				image_info.width, image_info.height, image_info.format, VK_IMAGE_TILING_OPTIMAL, 1);
+
+			auto& image = images.emplace_back(std::make_shared<VMA::Image>(shared_from_this()));
+			if (vkCreateImage(
+				m_context->m_device,
+				&imageCreateInfo,
+				m_context->m_memory_allocation_callback,
+				&image->m_image) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Image!");
+			vkGetImageMemoryRequirements(m_context->m_device, image->m_image, &memoryRequirements[index]);
+			memoryTypeBits &= memoryRequirements[index].memoryTypeBits;
+			isTransient = isTransient && (image_info.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT);
+		}
+		if (!memoryTypeBits) throw std::runtime_error("Failed to alias the transient images (No common memory type)!");
+
+		// Largest first, each one takes the lowest offset that does not overlap images alive at the same time
+		std::vector<size_t> order(image_infos.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&memoryRequirements](size_t left, size_t right)
+			{ return memoryRequirements[left].size > memoryRequirements[right].size; });
+
+		std::vector<VkDeviceSize> offsets(image_infos.size());
+		std::vector<size_t> placedImages;
+		VkDeviceSize heapSize = 0, heapAlignment = 1;
+		for (auto index : order)
 		{
-			.bufferOffset = 0,
-			.bufferRowLength = 0,
-			.bufferImageHeight = 0,
-			.imageSubresource
+			auto& memoryRequirement = memoryRequirements[index];
+			std::vector<std::pair<VkDeviceSize, VkDeviceSize>> occupiedRanges; // [Begin, End)
+			for (auto placed_image : placedImages)
 			{
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.mipLevel = 0,
-				.baseArrayLayer = 0,
-				.layerCount = 1,
-			},
-			.imageOffset = {0,0,0},
-			.imageExtent = {m_image_width, m_image_height, 1}
+				if (image_infos[placed_image].first_use <= image_infos[index].last_use &&
+					image_infos[index].first_use <= image_infos[placed_image].last_use)
+					occupiedRanges.emplace_back(offsets[placed_image], offsets[placed_image] + memoryRequirements[placed_image].size);
+			}
+			std::sort(occupiedRanges.begin(), occupiedRanges.end());
+
+			VkDeviceSize offset = 0;
+			for (auto& [begin, end] : occupiedRanges)
+			{
+				if (offset + memoryRequirement.size <= begin) break; // Fits in the gap
+				offset = std::max(offset, (end + memoryRequirement.alignment - 1) / memoryRequirement.alignment * memoryRequirement.alignment);
+			}
+			offsets[index] = offset;
+			placedImages.emplace_back(index);
+			heapSize = std::max(heapSize, offset + memoryRequirement.size);
+			heapAlignment = std::max(heapAlignment, memoryRequirement.alignment);
+		}
+
+		VkMemoryRequirements heapRequirements
+		{
+			.size = heapSize,
+			.alignment = heapAlignment,
+			.memoryTypeBits = memoryTypeBits
+		};
+		VmaAllocationCreateInfo allocationInfo
+		{
+			.flags = 0x0,
+			.usage = VMA_MEMORY_USAGE_UNKNOWN, // AUTO needs the resource
+			.preferredFlags = static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+				((isTransient && (memoryTypeBits & m_lazily_allocated_memory_types))? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0))
 		};
+		VmaAllocation heapAllocation = VK_NULL_HANDLE;
+		if (vmaAllocateMemory(m_allocator, &heapRequirements, &allocationInfo, &heapAllocation, nullptr) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate the Transient Image Heap!");
+		// Freed after the deferred deletion of the last aliased image
+		std::shared_ptr<VmaAllocation_T> heap{ heapAllocation, [allocator = shared_from_this()](VmaAllocation allocation)
+			{ vmaFreeMemory(allocator->m_allocator, allocation); } };
 
-		TransitionLayoutCommand(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		vkCmdCopyBufferToImage(*commandBuffer, *data, m_image, m_image_layout, 1, &copyRegion);
-		TransitionLayoutCommand(commandBuffer, final_layout);
+		for (size_t index = 0; index < image_infos.size(); ++index)
+		{
+			auto& image_info = image_infos[index];
+			auto& image = images[index];
+			if (vmaBindImageMemory2(m_allocator, heapAllocation, offsets[index], image->m_image, nullptr) != VK_SUCCESS)
+				throw std::runtime_error("Failed to bind the Vulkan Image to the Transient Image Heap!");
+			image->m_aliased_heap = heap;
+			image->m_aliased_size = memoryRequirements[index].size;
+			setup_image(*image, image_info.aspect, image_info.usage, image_info.width, image_info.height, image_info.channel, image_info.format, 1);
+		}
+		return images;
 	}
 
-	void VMA::Image::BindSampler(std::shared_ptr<RHI::Sampler> sampler)
+	void VMA::setup_image(Image& image, VkImageAspectFlags aspect, VkImageUsageFlags usage, uint32_t width, uint32_t height,
+		uint32_t channel, VkFormat format, uint32_t miplevel,
+		ImageType image_type/* = ImageType::IMAGE_2D*/, uint32_t depth/* = 1*/, uint32_t array_layers/* = 1*/)
 	{
-		m_image_sampler = std::move(sampler);
+		image.m_image_format = format;
+		image.m_image_width = width;
+		image.m_image_height = height;
+		image.m_image_channel = channel;
+		image.m_mipmap_level = miplevel;
+		image.m_image_depth = depth;
+		image.m_array_layers = array_layers;
+		image.m_image_type = image_type;
+		image.m_image_usage = usage;
+		//image.m_image_layout = layout; (AUTO)
+		// Depth stencil formats: Barriers and attachment views need both aspects, sampled views exactly one (Depth wins)
+		const VkImageAspectFlags formatAspect = GetFormatAspect(format);
+		const bool isDepthStencil = formatAspect == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+		image.m_sampled_aspect = (isDepthStencil && (aspect & VK_IMAGE_ASPECT_DEPTH_BIT)) ? VK_IMAGE_ASPECT_DEPTH_BIT : aspect;
+		image.m_view_aspect = (isDepthStencil && (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) ? formatAspect : image.m_sampled_aspect;
+		image.m_state_tracker.Reset(miplevel, array_layers, isDepthStencil ? formatAspect : aspect);
+		// Views are created on first use (Transfer-only images never need one)
+
+		if constexpr (EnableDebugMarkers)
+			image.SetDebugName(std::format("VMA::Image ({}x{}, format {})", width, height, static_cast<int>(format)).c_str());
 	}
 
-	void VMA::Image::TransitionLayout(VkImageLayout target_layout)
+	VkImageView VMA::create_image_view(VkImage image, VkFormat format, VkImageAspectFlags aspect,
+		ImageType image_type/* = ImageType::IMAGE_2D*/, uint32_t mip_levels/* = 1*/, uint32_t array_layers/* = 1*/, uint32_t base_mip_level/* = 0*/,
+		uint32_t base_array_layer/* = 0*/, VkComponentMapping components/* = {}*/)
+	{
+		VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
+		switch (image_type)
+		{
+		case ImageType::IMAGE_2D:				viewType = VK_IMAGE_VIEW_TYPE_2D; break;
+		case ImageType::IMAGE_2D_ARRAY:	viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY; break;
+		case ImageType::IMAGE_CUBE:			viewType = VK_IMAGE_VIEW_TYPE_CUBE; break;
+		case ImageType::IMAGE_CUBE_ARRAY:	viewType = VK_IMAGE_VIEW_TYPE_CUBE_ARRAY; break;
+		case ImageType::IMAGE_3D:				viewType = VK_IMAGE_VIEW_TYPE_3D; break;
+		}
+		VkImageViewCreateInfo imageViewCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = image,
+			.viewType = viewType,
+			.format = format,
+			.components = components,
+			.subresourceRange
+			{
+				.aspectMask = aspect,
+				.baseMipLevel = base_mip_level,
+				.levelCount = mip_levels,
+				.baseArrayLayer = base_array_layer,
+				.layerCount = array_layers
+			}
+		};
+		VkImageView imageView = VK_NULL_HANDLE;
+		if (vkCreateImageView(
+			m_context->m_device,
+			&imageViewCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&imageView
+			) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Image View!");
+		return imageView;
+	}
+
+	void VMA::Image::SetDebugName(const char* name)
+	{
+		auto& device = m_parent->m_context->m_device;
+		DebugUtils::SetObjectName(device, VK_OBJECT_TYPE_IMAGE, m_image, name);
+		{
+			std::scoped_lock guard{ m_view_mutex };
+			m_debug_name = name;
+			for (auto& [viewDesc, view] : m_views) DebugUtils::SetObjectName(device, VK_OBJECT_TYPE_IMAGE_VIEW, view, name);
+		}
+		if (m_allocation != VK_NULL_HANDLE) vmaSetAllocationName(m_parent->m_allocator, m_allocation, name);
+	}
+
+	VkImageView VMA::Image::GetImageView()
+	{
+		if (VkImageView imageView = m_image_view.load(std::memory_order_acquire)) return imageView;
+		VkImageView imageView = GetView({});
+		m_image_view.store(imageView, std::memory_order_release);
+		return imageView;
+	}
+
+	VkImageView VMA::Image::GetSampledImageView()
+	{
+		if (m_sampled_aspect == m_view_aspect) return GetImageView();
+		if (VkImageView sampledView = m_sampled_view.load(std::memory_order_acquire)) return sampledView;
+		VkImageView sampledView = GetView({ .aspect = m_sampled_aspect });
+		m_sampled_view.store(sampledView, std::memory_order_release);
+		return sampledView;
+	}
+
+	VkImageView VMA::Image::GetView(const ViewDesc& view_desc)
+	{
+		// Resolved, so equivalent descriptions share a view
+		ViewDesc key = view_desc;
+		if (!key.aspect) key.aspect = m_view_aspect;
+		if (key.mip_level_count == VK_REMAINING_MIP_LEVELS) key.mip_level_count = m_mipmap_level - key.base_mip_level;
+		if (key.array_layer_count == VK_REMAINING_ARRAY_LAYERS) key.array_layer_count = m_array_layers - key.base_array_layer;
+		if (key.format == VK_FORMAT_UNDEFINED) key.format = m_image_format;
+		if (!key.view_type.has_value()) key.view_type = m_image_type;
+		assert(key.base_mip_level + key.mip_level_count <= m_mipmap_level && "The view is out of the mip levels!");
+		assert(key.base_array_layer + key.array_layer_count <= m_array_layers && "The view is out of the array layers!");
+
+		auto isSameView = [&key](const std::pair<ViewDesc, VkImageView>& view)
+			{
+				const auto& desc = view.first;
+				return desc.aspect == key.aspect && desc.base_mip_level == key.base_mip_level && desc.mip_level_count == key.mip_level_count &&
+					desc.base_array_layer == key.base_array_layer && desc.array_layer_count == key.array_layer_count &&
+					desc.format == key.format && desc.view_type == key.view_type &&
+					desc.components.r == key.components.r && desc.components.g == key.components.g &&
+					desc.components.b == key.components.b && desc.components.a == key.components.a;
+			};
+		std::scoped_lock guard{ m_view_mutex };
+		if (auto cached = std::find_if(m_views.begin(), m_views.end(), isSameView); cached != m_views.end())
+			return cached->second;
+
+		VkImageView imageView = m_parent->create_image_view(m_image, key.format, key.aspect, key.view_type.value(),
+			key.mip_level_count, key.array_layer_count, key.base_mip_level, key.base_array_layer, key.components);
+		if (!m_debug_name.empty()) DebugUtils::SetObjectName(m_parent->m_context->m_device, VK_OBJECT_TYPE_IMAGE_VIEW, imageView, m_debug_name.c_str());
+		m_views.emplace_back(key, imageView);
+		return imageView;
+	}
+
+	VMA::Image::~Image()
+	{
+		bool isMoving = m_is_movable && m_parent->release_movable(m_allocation); // The memory is freed by the defragmentation pass
+		std::vector<VkImageView> imageViews;
+		for (auto& [viewDesc, view] : m_views) imageViews.emplace_back(view);
+		m_parent->m_context->InvalidateBakedCommands(m_image);
+		m_parent->m_context->DeferDeletion([allocator = m_parent, image = m_image, image_views = std::move(imageViews),
+			allocation = isMoving? VK_NULL_HANDLE : m_allocation, aliased_heap = m_aliased_heap, imported_memory = m_imported_memory,
+			batch_pool = m_batch_pool, bindless_index = m_bindless_index]()
+			{
+				auto& context = allocator->m_context;
+				if (bindless_index.has_value() && context->IsBindlessSupported()) // The heap may have been destroyed during teardown
+					context->GetBindlessHeap().Release(BindlessHeap::SAMPLED_IMAGE, bindless_index.value());
+				for (auto image_view : image_views) vkDestroyImageView(context->m_device, image_view, context->m_memory_allocation_callback);
+				vmaDestroyImage(allocator->m_allocator, image, allocation); // Aliased & imported images release their memory with this deleter, batches their pool
+			});
+	}
+
+	void VMA::Image::EnableDefragmentation(std::function<void(Image&)> on_moved/* = {}*/)
+	{
+		if (m_aliased_heap || !m_allocation)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Image - Aliased images cannot be moved!");
+		if (m_export_handle_type)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Image - External memory cannot be moved!");
+		if (m_batch_pool)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Image - Batch memory cannot be moved!");
+		if (m_host_data)
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Image - Host-readable images stay mapped!");
+		if (!(m_image_usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+			throw std::runtime_error("Failed to enable the defragmentation of the Vulkan Image - It cannot be copied!");
+		m_on_moved = std::move(on_moved);
+		if (m_is_movable) return;
+		std::scoped_lock guard{ m_parent->m_defragmentation_mutex };
+		m_parent->m_movable_resources[m_allocation] = { nullptr, this };
+		m_is_movable = true;
+	}
+
+	bool VMA::Image::SetMemoryPriority(MemoryPriority priority)
+	{
+		const auto& context = m_parent->m_context;
+		if (!m_is_dedicated || !context->IsPageableDeviceLocalMemorySupported()) return false;
+		VmaAllocationInfo allocationInfo{};
+		vmaGetAllocationInfo(m_parent->m_allocator, m_allocation, &allocationInfo);
+		context->m_set_device_memory_priority(context->m_device, allocationInfo.deviceMemory, GetMemoryPriorityValue(priority));
+		return true;
+	}
+
+	uint32_t VMA::Image::GetBindlessIndex()
+	{
+		if (!m_bindless_index.has_value())
+			m_bindless_index = m_parent->m_context->GetBindlessHeap().RegisterSampledImage(GetSampledImageView());
+		return m_bindless_index.value();
+	}
+
+	void VMA::Image::Write(std::shared_ptr<RHI::VMA::Buffer> data,
+		uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/)
 	{
 		auto commandBuffer = m_parent->m_context->
 			CreateOneTimeCommandBuffer(m_parent->m_context->m_device_queue_family_graphics);
 		commandBuffer->Begin();
-		TransitionLayoutCommand(commandBuffer, target_layout);
+		WriteCommand(*commandBuffer, *data, base_mip_level, mip_level_count);
 		commandBuffer->End();
 		commandBuffer->Submit(true); // Must wait for transfer operation
-
-		m_image_layout = target_layout; // Update Layout
 	}
 
-	void VMA::Image::TransitionLayoutCommand(std::shared_ptr<RHI::CommandBuffer> commandBuffer, VkImageLayout target_layout)
+	void VMA::Image::WriteCommand(RHI::CommandBuffer& commandBuffer, Buffer& data,
+		uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/)
 	{
-		assert(commandBuffer->IsRecording() &&
+		assert(commandBuffer.IsRecording() &&
 			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
-		VkPipelineStageFlags sourceStage, destinationStage;
-		auto imageMemoryBarrier = deduce_transition_layout_barrier(target_layout, sourceStage, destinationStage);
-
-		vkCmdPipelineBarrier( // P213
-			*commandBuffer,
-			sourceStage,
-			destinationStage,
-			0x0,				// Dependency Flags
-			0, nullptr,	// Memory Barrier
-			0, nullptr,	// Buffer Memory Barrier
-			1, &imageMemoryBarrier);
+		assert(data.Size() <= Size() && "It is not recommanded to write the image from a bigger buffer!");
+		assert(data.Size() >= GetDataSize(base_mip_level, mip_level_count) && "The buffer is smaller than the mip levels!");
+		if (!GetFormatBlockInfo(m_image_format).IsKnown())
+			log::warn("Writing an image of unknown format {}, but automatically treating it as 4-byte texels", static_cast<int>(m_image_format));
 
-		m_image_layout = target_layout; // Update Layout
+		// Copy buffer to image requires the image to be in the right layout first
+		mip_level_count = resolve_mip_level_count(base_mip_level, mip_level_count);
+		auto copyRegions = make_copy_regions(0, base_mip_level, mip_level_count);
+		TransitionCommand(commandBuffer, { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+			base_mip_level, mip_level_count);
+		commandBuffer.FlushBarriers();
+		commandBuffer.GetDispatch().vkCmdCopyBufferToImage(commandBuffer, data, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
 	}
 
-	VkSampler VMA::Image::GetImageSampler()
-	{ 
-		assert(m_image_sampler != nullptr && "You must call BindSampler() first!");
-		return *m_image_sampler;
+	void VMA::Image::WriteCommand(RHI::CommandBuffer& commandBuffer, Buffer& data, std::span<const VkBufferImageCopy> regions)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		if (regions.empty()) return;
+
+		uint32_t minMipLevel = std::numeric_limits<uint32_t>::max(), maxMipLevel = 0;
+		for (const auto& region : regions)
+		{
+			assert(region.imageSubresource.mipLevel < m_mipmap_level && "Writing a mip level out of the image!");
+			minMipLevel = std::min(minMipLevel, region.imageSubresource.mipLevel);
+			maxMipLevel = std::max(maxMipLevel, region.imageSubresource.mipLevel);
+		}
+		TransitionCommand(commandBuffer, { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+			minMipLevel, maxMipLevel - minMipLevel + 1);
+		commandBuffer.FlushBarriers();
+		commandBuffer.GetDispatch().vkCmdCopyBufferToImage(commandBuffer, data, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(regions.size()), regions.data());
 	}
 
-	bool VMA::Image::HasStencilComponent()
+	void VMA::Image::WriteAndTransition(std::shared_ptr<Buffer> data, VkImageLayout final_layout,
+		uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/)
 	{
-		if (VK_FORMAT_S8_UINT <= m_image_format &&
-			m_image_format <= VK_FORMAT_D32_SFLOAT_S8_UINT)
-			return true;
-		return false;
+		auto commandBuffer = m_parent->m_context->
+			CreateOneTimeCommandBuffer(m_parent->m_context->m_device_queue_family_graphics);
+		commandBuffer->Begin();
+		WriteAndTransitionCommand(*commandBuffer, *data, final_layout, base_mip_level, mip_level_count);
+		commandBuffer->End();
+		commandBuffer->Submit(true); // Must wait for transfer operation
 	}
 
-	VkDeviceSize VMA::Image::Size()
+	void VMA::Image::WriteAndTransitionCommand(
+		RHI::CommandBuffer& commandBuffer,
+		Buffer& data, VkImageLayout final_layout,
+		uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/)
 	{
-		return m_allocation->GetSize();
+		WriteCommand(commandBuffer, data, base_mip_level, mip_level_count);
+		TransitionCommand(commandBuffer, ResourceAccess::FromLayout(final_layout),
+			base_mip_level, resolve_mip_level_count(base_mip_level, mip_level_count));
 	}
 
-	VkImageMemoryBarrier VMA::Image::
-		deduce_transition_layout_barrier(VkImageLayout target_layout, 
-		VkPipelineStageFlags& stage_src, VkPipelineStageFlags& stage_dst)
+	void VMA::Image::WriteFromHost(std::span<const std::byte> data, VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/,
+		uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/)
 	{
-		// Barriers are primarily used for synchronization purposes, so you must specify which types of operations that involve 
-		//the resource must happen before the barrier, 
-		//and which operations that involve the resource must wait on the barrier.
-		VkImageAspectFlags imageAspect;
-		VkAccessFlags srcAccessMask;
-		VkAccessFlags dstAccessMask;
+		ALBEDO_RHI_TRACE_ZONE("RHI::WriteImageFromHost");
+		mip_level_count = resolve_mip_level_count(base_mip_level, mip_level_count);
+		assert(data.size() >= GetDataSize(base_mip_level, mip_level_count) && "The data is smaller than the mip levels!");
 
-		if ( // Undefined Image => Transfer Destination Image
-			VK_IMAGE_LAYOUT_UNDEFINED == m_image_layout &&
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL == target_layout)
+		std::vector<VkMemoryToImageCopyEXT> regions;
+		for (const auto& copyRegion : make_copy_regions(0, base_mip_level, mip_level_count))
 		{
-			imageAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			regions.emplace_back(VkMemoryToImageCopyEXT
+				{
+					.sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+					.pHostPointer = data.data() + copyRegion.bufferOffset,
+					.memoryRowLength = 0,
+					.memoryImageHeight = 0, // Tightly packed
+					.imageSubresource = copyRegion.imageSubresource,
+					.imageOffset = copyRegion.imageOffset,
+					.imageExtent = copyRegion.imageExtent
+				});
+		}
+		copy_from_host(regions, VkImageSubresourceRange
+			{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = base_mip_level,
+				.levelCount = mip_level_count,
+				.baseArrayLayer = 0,
+				.layerCount = m_array_layers
+			}, true, final_layout);
+	}
+
+	void VMA::Image::WriteFromHost(std::span<const std::byte> data, const VkImageSubresourceLayers& subresource, VkOffset3D offset, VkExtent3D extent,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::WriteImageFromHost");
+		const uint32_t layerCount = (subresource.layerCount == VK_REMAINING_ARRAY_LAYERS)? m_array_layers - subresource.baseArrayLayer : subresource.layerCount;
+		assert(data.size() >= get_block_info().GetRegionSize(extent.width, extent.height, extent.depth) * layerCount && "The data is smaller than the region!");
 
-			srcAccessMask = 0;
-			dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		const VkExtent3D mipExtent = get_mip_extent(subresource.mipLevel);
+		const bool isWholeLevel = offset.x == 0 && offset.y == 0 && offset.z == 0 &&
+			extent.width == mipExtent.width && extent.height == mipExtent.height && extent.depth == mipExtent.depth;
+		copy_from_host({ VkMemoryToImageCopyEXT
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+				.pHostPointer = data.data(),
+				.memoryRowLength = 0,
+				.memoryImageHeight = 0,
+				.imageSubresource = subresource,
+				.imageOffset = offset,
+				.imageExtent = extent
+			} }, VkImageSubresourceRange
+			{
+				.aspectMask = subresource.aspectMask,
+				.baseMipLevel = subresource.mipLevel,
+				.levelCount = 1,
+				.baseArrayLayer = subresource.baseArrayLayer,
+				.layerCount = layerCount
+			}, isWholeLevel, final_layout);
+	}
 
-			stage_src = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			stage_dst = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	void VMA::Image::copy_from_host(const std::vector<VkMemoryToImageCopyEXT>& regions, const VkImageSubresourceRange& range,
+		bool is_overwritten, VkImageLayout final_layout)
+	{
+		auto& context = *m_parent->m_context;
+		assert(context.IsHostImageCopySupported() && "VK_EXT_host_image_copy is not supported by this device!");
+		assert((m_image_usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT) && "The image was not allocated with VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT!");
+
+		// Copied in the final layout if the device allows it, otherwise in GENERAL (The next TransitionCommand() moves it on the GPU)
+		const VkImageLayout copyLayout = context.IsHostImageCopyDstLayout(final_layout)? final_layout : VK_IMAGE_LAYOUT_GENERAL;
+		std::vector<VkHostImageLayoutTransitionInfoEXT> transitions;
+		for (uint32_t mipLevel = range.baseMipLevel; mipLevel < range.baseMipLevel + range.levelCount; ++mipLevel)
+		{
+			const VkImageLayout currentLayout = m_state_tracker.GetLayout(mipLevel, range.baseArrayLayer);
+			if (currentLayout == copyLayout) continue;
+			transitions.emplace_back(VkHostImageLayoutTransitionInfoEXT
+				{
+					.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+					.image = m_image,
+					.oldLayout = is_overwritten? VK_IMAGE_LAYOUT_UNDEFINED : currentLayout,
+					.newLayout = copyLayout,
+					.subresourceRange
+					{
+						.aspectMask = range.aspectMask,
+						.baseMipLevel = mipLevel,
+						.levelCount = 1,
+						.baseArrayLayer = range.baseArrayLayer,
+						.layerCount = range.layerCount
+					}
+				});
 		}
-		else if ( // Undefined Image => Depth Stencil Image
-			VK_IMAGE_LAYOUT_UNDEFINED == m_image_layout &&
-			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL == target_layout)
+		if (!transitions.empty() &&
+			context.m_transition_image_layout(context.m_device, static_cast<uint32_t>(transitions.size()), transitions.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to transition the Vulkan Image on the host!");
+
+		VkCopyMemoryToImageInfoEXT copyInfo
 		{
-			imageAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-			if (HasStencilComponent()) imageAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+			.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+			.dstImage = m_image,
+			.dstImageLayout = copyLayout,
+			.regionCount = static_cast<uint32_t>(regions.size()),
+			.pRegions = regions.data()
+		};
+		if (context.m_copy_memory_to_image(context.m_device, &copyInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to copy the host memory to the Vulkan Image!");
+
+		// Host writes are visible to the later submissions, so the GPU has nothing to wait for (Only the layout is tracked)
+		m_state_tracker.Assume(range, ResourceAccess{ .stages = VK_PIPELINE_STAGE_2_NONE, .access = VK_ACCESS_2_NONE, .layout = copyLayout });
+		m_image_layout = m_state_tracker.GetLayout();
+	}
+
+	VkDeviceSize VMA::Image::GetDataSize(uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/) const
+	{
+		const auto blockInfo = get_block_info();
+		VkDeviceSize dataSize = 0;
+		for (const auto& copy_region : make_copy_regions(0, base_mip_level, resolve_mip_level_count(base_mip_level, mip_level_count)))
+			dataSize += blockInfo.GetRegionSize(copy_region.imageExtent.width, copy_region.imageExtent.height, copy_region.imageExtent.depth) * m_array_layers;
+		return dataSize;
+	}
 
-			srcAccessMask = 0;
-			dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-											 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	uint32_t VMA::Image::resolve_mip_level_count(uint32_t base_mip_level, uint32_t mip_level_count) const
+	{
+		assert(base_mip_level < m_mipmap_level && "Mip level is out of range!");
+		return (mip_level_count == VK_REMAINING_MIP_LEVELS)? m_mipmap_level - base_mip_level : mip_level_count;
+	}
 
-			stage_src = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			stage_dst = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	std::vector<VkBufferImageCopy> VMA::Image::make_copy_regions(VkDeviceSize buffer_offset, uint32_t base_mip_level, uint32_t mip_level_count) const
+	{
+		assert(base_mip_level + mip_level_count <= m_mipmap_level && "Mip levels are out of range!");
+		const auto blockInfo = get_block_info();
+		std::vector<VkBufferImageCopy> copyRegions(mip_level_count);
+		for (uint32_t index = 0; index < mip_level_count; ++index)
+		{
+			const uint32_t mipLevel = base_mip_level + index;
+			const VkExtent3D extent = get_mip_extent(mipLevel);
+			copyRegions[index] = VkBufferImageCopy
+			{
+				.bufferOffset = buffer_offset,
+				.bufferRowLength = 0,
+				.bufferImageHeight = 0, // Tightly packed rows & layers (Rounded up to whole blocks)
+				.imageSubresource
+				{
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = mipLevel,
+					.baseArrayLayer = 0,
+					.layerCount = m_array_layers,
+				},
+				.imageOffset = {0,0,0},
+				.imageExtent = extent // Partial edge blocks are allowed as the extent reaches the edge of the level
+			};
+			buffer_offset += blockInfo.GetRegionSize(extent.width, extent.height, extent.depth) * m_array_layers;
 		}
-		else if ( // Undefined Image => Shader Read-only Image
-			VK_IMAGE_LAYOUT_UNDEFINED == m_image_layout &&
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL == target_layout)
+		return copyRegions;
+	}
+
+	std::vector<VMA::Image::CopyBand> VMA::Image::make_copy_bands(VkDeviceSize max_band_size) const
+	{
+		assert(max_band_size > 0 && "Invalid band size!");
+		const auto blockInfo = get_block_info();
+		const VkDeviceSize alignment = get_copy_alignment();
+		std::vector<CopyBand> copyBands(1);
+		VkDeviceSize dataOffset = 0;
+		for (uint32_t mipLevel = 0; mipLevel < m_mipmap_level; ++mipLevel)
 		{
-			imageAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			const VkExtent3D extent = get_mip_extent(mipLevel);
+			const uint32_t blockRows = (extent.height + blockInfo.block_height - 1) / blockInfo.block_height;
+			const VkDeviceSize rowSize = blockInfo.GetRegionSize(extent.width, 1);
+			// Slices in GetDataSize() order: Array layers, or depth slices of 3D images
+			for (uint32_t slice = 0; slice < m_array_layers * extent.depth; ++slice)
+			{
+				for (uint32_t row = 0; row < blockRows;)
+				{
+					auto* copyBand = &copyBands.back();
+					uint32_t rowCount = static_cast<uint32_t>(std::min<VkDeviceSize>(blockRows - row,
+						copyBand->size < max_band_size ? (max_band_size - copyBand->size) / rowSize : 0));
+					// A region of the band must start at an aligned offset, otherwise it starts the next band
+					if (rowCount == 0 || copyBand->size % alignment)
+					{
+						if (copyBand->size) copyBand = &copyBands.emplace_back(CopyBand{ .data_offset = dataOffset });
+						rowCount = static_cast<uint32_t>(std::clamp<VkDeviceSize>(max_band_size / rowSize, 1, blockRows - row));
+					}
+
+					copyBand->regions.emplace_back(VkBufferImageCopy
+					{
+						.bufferOffset = copyBand->size,
+						.bufferRowLength = 0,
+						.bufferImageHeight = 0,
+						.imageSubresource
+						{
+							.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+							.mipLevel = mipLevel,
+							.baseArrayLayer = slice / extent.depth,
+							.layerCount = 1,
+						},
+						.imageOffset = { 0, static_cast<int32_t>(row * blockInfo.block_height), static_cast<int32_t>(slice % extent.depth) },
+						.imageExtent = { extent.width, std::min(rowCount * blockInfo.block_height, extent.height - row * blockInfo.block_height), 1 }
+					});
+					copyBand->size += rowSize * rowCount;
+					dataOffset += rowSize * rowCount;
+					row += rowCount;
+				}
+			}
+		}
+		return copyBands;
+	}
+
+	void VMA::Image::GenerateMipsCommand(RHI::CommandBuffer& commandBuffer, VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		if (!(m_image_usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) || !IsMipBlitSupported())
+			throw std::runtime_error("Failed to generate the mipmaps - The image cannot be blitted with linear filtering!");
 
-			srcAccessMask = 0;
-			dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		for (uint32_t mip_level = 1; mip_level < m_mipmap_level; ++mip_level)
+		{
+			TransitionCommand(commandBuffer, { VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+				mip_level - 1, 1);
+			TransitionCommand(commandBuffer, { VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+				mip_level, 1);
+			commandBuffer.FlushBarriers();
 
-			stage_src = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			stage_dst = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			const auto srcExtent = get_mip_extent(mip_level - 1), dstExtent = get_mip_extent(mip_level);
+			VkImageBlit blitRegion
+			{
+				.srcSubresource
+				{
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = mip_level - 1,
+					.baseArrayLayer = 0,
+					.layerCount = m_array_layers
+				},
+				.srcOffsets = {{0,0,0}, {(int32_t)srcExtent.width, (int32_t)srcExtent.height, (int32_t)srcExtent.depth}},
+				.dstSubresource
+				{
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = mip_level,
+					.baseArrayLayer = 0,
+					.layerCount = m_array_layers
+				},
+				.dstOffsets = {{0,0,0}, {(int32_t)dstExtent.width, (int32_t)dstExtent.height, (int32_t)dstExtent.depth}}
+			};
+			commandBuffer.GetDispatch().vkCmdBlitImage(commandBuffer,
+				m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blitRegion, VK_FILTER_LINEAR);
 		}
-		else if ( // Transfer Destination Image => Shader Read-only Image
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL == m_image_layout &&
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL == target_layout)
+		TransitionLayoutCommand(commandBuffer, final_layout);
+	}
+
+	void VMA::Image::GenerateMipsCommand(RHI::CommandBuffer& commandBuffer, RHI::ComputePipeline& downsample_pipeline,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		if ((m_image_usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) && IsMipBlitSupported())
+			return GenerateMipsCommand(commandBuffer, final_layout);
+
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		if (!(m_image_usage & VK_IMAGE_USAGE_STORAGE_BIT))
+			throw std::runtime_error("Failed to generate the mipmaps - The image cannot be downsampled by compute shaders (No storage usage)!");
+
+		// One storage view per level (Cached by the image, so repeated generations reuse them)
+		auto& context = m_parent->m_context;
+		const ImageType viewType = (m_image_type == ImageType::IMAGE_3D)? ImageType::IMAGE_3D : ImageType::IMAGE_2D_ARRAY;
+		std::vector<VkImageView> levelViews(m_mipmap_level);
+		for (uint32_t mip_level = 0; mip_level < m_mipmap_level; ++mip_level)
+			levelViews[mip_level] = GetView({ .aspect = VK_IMAGE_ASPECT_COLOR_BIT, .base_mip_level = mip_level, .mip_level_count = 1, .view_type = viewType });
+
+		downsample_pipeline.Bind(commandBuffer);
+		DescriptorWriteBatch descriptorWrites{ context, m_mipmap_level * 2 };
+		std::vector<std::shared_ptr<DescriptorSet>> descriptorSets; // Freed through the deletion queue
+		for (uint32_t mip_level = 1; mip_level < m_mipmap_level; ++mip_level)
 		{
-			imageAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			auto& descriptorSet = descriptorSets.emplace_back(context->CreateDescriptorSet(downsample_pipeline.GetSharedDescriptorSetLayout(0)));
+			descriptorWrites.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, levelViews[mip_level - 1], VK_IMAGE_LAYOUT_GENERAL);
+			descriptorWrites.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, levelViews[mip_level], VK_IMAGE_LAYOUT_GENERAL);
+		}
+		descriptorWrites.Flush();
 
-			srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		for (uint32_t mip_level = 1; mip_level < m_mipmap_level; ++mip_level)
+		{
+			TransitionCommand(commandBuffer, { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL },
+				mip_level - 1, 1);
+			TransitionCommand(commandBuffer, { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+				mip_level, 1);
 
-			stage_src = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			stage_dst = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			auto dstExtent = get_mip_extent(mip_level);
+			if (m_image_type != ImageType::IMAGE_3D) dstExtent.depth = m_array_layers;
+			commandBuffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, downsample_pipeline.GetPipelineLayout(), 0, { *descriptorSets[mip_level - 1] });
+			commandBuffer.PushConstants(downsample_pipeline.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VkExtent3D), &dstExtent);
+			downsample_pipeline.Dispatch(commandBuffer, (dstExtent.width + 7) / 8, (dstExtent.height + 7) / 8, dstExtent.depth);
 		}
-		else if ( // Shader Read-only Image => Transfer Destination Image
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL == m_image_layout &&
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL == target_layout)
+		TransitionLayoutCommand(commandBuffer, final_layout);
+	}
+
+	bool VMA::Image::IsMipBlitSupported()
+	{
+		constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+			VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		return m_parent->m_context->GetFormatTable().IsSupported(m_image_format, m_image_tiling, required);
+	}
+
+	VkExtent3D VMA::Image::get_mip_extent(uint32_t mip_level) const
+	{
+		return { std::max(m_image_width >> mip_level, 1u), std::max(m_image_height >> mip_level, 1u), std::max(m_image_depth >> mip_level, 1u) };
+	}
+
+	FormatBlockInfo VMA::Image::get_block_info() const
+	{
+		auto blockInfo = GetFormatBlockInfo(m_image_format);
+		return blockInfo.IsKnown()? blockInfo : FormatBlockInfo{ 4 };
+	}
+
+	VkDeviceSize VMA::Image::get_copy_alignment() const
+	{
+		return std::lcm(VkDeviceSize{ 4 }, VkDeviceSize{ get_block_info().block_size });
+	}
+
+	void VMA::Image::HostReadBarrierCommand(RHI::CommandBuffer& commandBuffer)
+	{
+		assert(IsHostReadable() && "The image is not host-readable (VMA::AllocateHostReadableImage())!");
+		TransitionCommand(commandBuffer, ResourceAccess // Host access to linear images needs GENERAL
+			{
+				.stages = VK_PIPELINE_STAGE_2_HOST_BIT,
+				.access = VK_ACCESS_2_HOST_READ_BIT,
+				.layout = VK_IMAGE_LAYOUT_GENERAL
+			});
+	}
+
+	VMA::Image::HostView VMA::Image::MapHostView()
+	{
+		assert(IsHostReadable() && "The image is not host-readable (VMA::AllocateHostReadableImage())!");
+		vmaInvalidateAllocation(m_parent->m_allocator, m_allocation, m_host_layout.offset, m_host_layout.size);
+		return HostView
 		{
-			imageAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			.data = m_host_data + m_host_layout.offset,
+			.row_pitch = m_host_layout.rowPitch,
+			.row_size = get_block_info().GetRegionSize(m_image_width, 1),
+			.size = m_host_layout.size,
+			.extent = { m_image_width, m_image_height }
+		};
+	}
 
-			srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	void VMA::Image::BindSampler(std::shared_ptr<RHI::Sampler> sampler)
+	{
+		m_image_sampler = std::move(sampler);
+	}
 
-			stage_src = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			stage_dst = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		}
-		else throw std::invalid_argument("Failed to transition the Vulkan Image Layout - Unsupported layout transition!");
+	void VMA::Image::TransitionLayout(VkImageLayout target_layout)
+	{
+		auto commandBuffer = m_parent->m_context->
+			CreateOneTimeCommandBuffer(m_parent->m_context->m_device_queue_family_graphics);
+		commandBuffer->Begin();
+		TransitionLayoutCommand(*commandBuffer, target_layout);
+		commandBuffer->End();
+		commandBuffer->Submit(true); // Must wait for transfer operation
+
+		m_image_layout = target_layout; // Update Layout
+	}
+
+	void VMA::Image::TransitionLayoutCommand(RHI::CommandBuffer& commandBuffer, VkImageLayout target_layout)
+	{
+		TransitionCommand(commandBuffer, ResourceAccess::FromLayout(target_layout));
+	}
 
-		return VkImageMemoryBarrier
+	void VMA::Image::TransitionCommand(RHI::CommandBuffer& commandBuffer, const ResourceAccess& access,
+		uint32_t base_mip_level/* = 0*/, uint32_t mip_level_count/* = VK_REMAINING_MIP_LEVELS*/,
+		uint32_t base_array_layer/* = 0*/, uint32_t array_layer_count/* = VK_REMAINING_ARRAY_LAYERS*/)
+	{
+		assert(commandBuffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		VkImageSubresourceRange subresourceRange
 		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = srcAccessMask,
-			.dstAccessMask = dstAccessMask,
-			.oldLayout = m_image_layout,
-			.newLayout = target_layout,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = m_image,
-			.subresourceRange
-			{
-				.aspectMask = imageAspect,
-				.baseMipLevel = 0,
-				.levelCount = 1,
-				.baseArrayLayer = 0,
-				.layerCount = 1
-			}
+			.aspectMask = m_state_tracker.GetAspect(),
+			.baseMipLevel = base_mip_level,
+			.levelCount = mip_level_count,
+			.baseArrayLayer = base_array_layer,
+			.layerCount = array_layer_count
 		};
+		thread_local std::vector<VkImageMemoryBarrier2> imageBarriers; // Ditto
+		imageBarriers.clear();
+		m_state_tracker.Transition(m_image, subresourceRange, access, imageBarriers);
+		for (const auto& image_barrier : imageBarriers) commandBuffer.QueueBarrier(image_barrier); // Flushed before the next command
+
+		m_image_layout = m_state_tracker.GetLayout(); // Update Layout
 	}
 
-	std::shared_ptr<VMA::Buffer> VMA::
-		AllocateStagingBuffer(VkDeviceSize buffer_size)
+	void VMA::Image::assume_access(const ResourceAccess& access)
 	{
-		return AllocateBuffer(buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true, true, false);
+		m_state_tracker.Assume(m_state_tracker.GetWholeRange(), access);
+		m_image_layout = m_state_tracker.GetLayout();
+	}
+
+	VkSampler VMA::Image::GetImageSampler()
+	{ 
+		assert(m_image_sampler != nullptr && "You must call BindSampler() first!");
+		return *m_image_sampler;
+	}
+
+	bool VMA::Image::HasStencilComponent()
+	{
+		if (VK_FORMAT_S8_UINT <= m_image_format &&
+			m_image_format <= VK_FORMAT_D32_SFLOAT_S8_UINT)
+			return true;
+		return false;
+	}
+
+	VkDeviceSize VMA::Image::Size()
+	{
+		return m_allocation? m_allocation->GetSize() : m_aliased_size;
+	}
+
+	void VMA::Image::DiscardContents()
+	{
+		// The previous aliased image may still access the memory
+		m_state_tracker.Reset(m_mipmap_level, m_array_layers, m_state_tracker.GetAspect());
+		m_state_tracker.Assume(m_state_tracker.GetWholeRange(),
+			ResourceAccess{ .stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_WRITE_BIT });
+		m_image_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::
+		AllocateStagingBuffer(VkDeviceSize buffer_size)
+	{
+		return AllocateBuffer(buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true, true, false);
+	}
+
+	std::shared_ptr<VMA::Image> VMA::
+		AllocateHostReadableImage(VkImageUsageFlags usage, uint32_t width, uint32_t height, uint32_t channel, VkFormat format)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateHostReadableImage");
+		if (!IsHostReadableImageSupported(format, usage, width, height))
+			throw std::runtime_error(std::format("Failed to create the host-readable Vulkan Image - The format {} does not support linear {}x{} images with the usage {:#x}!",
+				static_cast<int>(format), width, height, usage));
+		VkImageCreateInfo imageCreateInfo = make_image_create_info(usage, width, height, format, VK_IMAGE_TILING_LINEAR, 1);
+		VmaAllocationCreateInfo allocationInfo
+		{
+			.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+			.usage = VMA_MEMORY_USAGE_AUTO,
+			.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT // Uncached reads are slow
+		};
+
+		auto image = std::make_shared<VMA::Image>(shared_from_this());
+		VmaAllocationInfo allocatedInfo{};
+		if (vmaCreateImage(
+			m_allocator,
+			&imageCreateInfo,
+			&allocationInfo,
+			&image->m_image,
+			&image->m_allocation,
+			&allocatedInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the host-readable Vulkan Image!");
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_ALLOCATIONS);
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_BYTES, allocatedInfo.size);
+
+		setup_image(*image, VK_IMAGE_ASPECT_COLOR_BIT, imageCreateInfo.usage, width, height, channel, format, 1);
+		image->m_image_tiling = VK_IMAGE_TILING_LINEAR;
+		// Row pitch & offset chosen by the driver
+		const VkImageSubresource subresource{ .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .arrayLayer = 0 };
+		vkGetImageSubresourceLayout(m_context->m_device, image->m_image, &subresource, &image->m_host_layout);
+		image->m_host_data = static_cast<std::byte*>(allocatedInfo.pMappedData);
+		return image;
+	}
+
+	bool VMA::IsHostReadableImageSupported(VkFormat format, VkImageUsageFlags usage, uint32_t width, uint32_t height)
+	{
+		if (GetFormatAspect(format) != VK_IMAGE_ASPECT_COLOR_BIT) return false;
+		const VkImageCreateInfo imageCreateInfo = make_image_create_info(usage, width, height, format, VK_IMAGE_TILING_LINEAR, 1);
+		VkImageFormatProperties formatProperties{};
+		if (vkGetPhysicalDeviceImageFormatProperties(
+			m_context->m_physical_device,
+			format,
+			imageCreateInfo.imageType,
+			VK_IMAGE_TILING_LINEAR,
+			imageCreateInfo.usage,
+			imageCreateInfo.flags,
+			&formatProperties) != VK_SUCCESS) return false;
+		return width <= formatProperties.maxExtent.width && height <= formatProperties.maxExtent.height;
+	}
+
+	std::shared_ptr<VMA::Image> VMA::
+		AllocateVideoImage(VkImageUsageFlags usage, uint32_t width, uint32_t height, VkFormat format,
+			const VkVideoProfileListInfoKHR& profile_list, VkImageCreateFlags flags/* = 0*/, uint32_t array_layers/* = 1*/)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateVideoImage");
+		assert(m_context->IsVideoEncodeSupported() && "Vulkan Video is not supported by this device!");
+		VkImageCreateInfo imageCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.pNext = &profile_list,
+			.flags = flags,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = format,
+			.extent = { width, height, 1 },
+			.mipLevels = 1,
+			.arrayLayers = array_layers,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE, // Queue family ownership is transferred by the video coders
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		};
+		VmaAllocationCreateInfo allocationInfo
+		{
+			.usage = VMA_MEMORY_USAGE_AUTO,
+			.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			.priority = GetMemoryPriorityValue(MemoryPriority::HIGH)
+		};
+
+		auto image = std::make_shared<VMA::Image>(shared_from_this());
+		VmaAllocationInfo allocatedInfo{};
+		if (vmaCreateImage(
+			m_allocator,
+			&imageCreateInfo,
+			&allocationInfo,
+			&image->m_image,
+			&image->m_allocation,
+			&allocatedInfo) != VK_SUCCESS)
+			throw std::runtime_error(std::format("Failed to create the Vulkan Video Image (format {}, usage {:#x})!", static_cast<int>(format), usage));
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_ALLOCATIONS);
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_BYTES, allocatedInfo.size);
+
+		setup_image(*image, VK_IMAGE_ASPECT_COLOR_BIT, usage, width, height, 1, format, 1,
+			(array_layers > 1)? ImageType::IMAGE_2D_ARRAY : ImageType::IMAGE_2D, 1, array_layers);
+		return image;
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::
+		AllocateVideoBuffer(size_t size, VkBufferUsageFlags usage, const VkVideoProfileListInfoKHR& profile_list, bool is_readable/* = false*/)
+	{
+		assert(m_context->IsVideoEncodeSupported() && "Vulkan Video is not supported by this device!");
+		VmaAllocationCreateFlags allocation_flags = is_readable?
+			VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT : 0;
+		return allocate_buffer(size, usage, true, allocation_flags, MemoryPool::GENERAL, &profile_list);
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::
+		AllocateExportableBuffer(size_t size, VkBufferUsageFlags usage, VkExternalMemoryHandleTypeFlagBits handle_type/* = ExternalMemoryHandleType*/)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateExportableBuffer");
+		if (!m_context->IsExternalMemorySupported() ||
+			(handle_type == VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT && !m_context->IsDmaBufSupported()))
+			throw std::runtime_error("Failed to create the exportable Vulkan Buffer - The handle type is not supported by this device!");
+		const VkPhysicalDeviceExternalBufferInfo externalBufferInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_BUFFER_INFO,
+			.usage = usage,
+			.handleType = handle_type
+		};
+		VkExternalBufferProperties externalBufferProperties{ .sType = VK_STRUCTURE_TYPE_EXTERNAL_BUFFER_PROPERTIES };
+		vkGetPhysicalDeviceExternalBufferProperties(m_context->m_physical_device, &externalBufferInfo, &externalBufferProperties);
+		if (!(externalBufferProperties.externalMemoryProperties.externalMemoryFeatures & VK_EXTERNAL_MEMORY_FEATURE_EXPORTABLE_BIT))
+			throw std::runtime_error(std::format("Failed to create the exportable Vulkan Buffer - The usage {:#x} cannot be exported!", usage));
+
+		VkExternalMemoryBufferCreateInfo externalMemoryCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+			.handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(handle_type)
+		};
+		VkBufferCreateInfo bufferCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = &externalMemoryCreateInfo,
+			.size = size,
+			.usage = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE // Ownership is transferred to VK_QUEUE_FAMILY_EXTERNAL by the producer
+		};
+		VmaAllocationCreateInfo allocationInfo
+		{
+			.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, // The exported handle covers this buffer only
+			.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+		};
+		uint32_t memoryTypeIndex = 0;
+		if (vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &bufferCreateInfo, &allocationInfo, &memoryTypeIndex) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the exportable Vulkan Buffer - No suitable memory type!");
+		allocationInfo.pool = get_exportable_pool(handle_type, memoryTypeIndex);
+
+		auto buffer = std::make_shared<VMA::Buffer>(shared_from_this());
+		VmaAllocationInfo allocatedInfo{};
+		if (vmaCreateBuffer(m_allocator, &bufferCreateInfo, &allocationInfo, &buffer->m_buffer, &buffer->m_allocation, &allocatedInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the exportable Vulkan Buffer!");
+		m_context->GetStatistics().Add(RHIStatistics::BUFFER_ALLOCATIONS);
+		m_context->GetStatistics().Add(RHIStatistics::BUFFER_BYTES, allocatedInfo.size);
+
+		buffer->m_state_tracker.Reset(size);
+		buffer->m_buffer_size = size;
+		buffer->m_buffer_usage = usage;
+		buffer->m_export_handle_type = handle_type;
+		if constexpr (EnableDebugMarkers)
+			buffer->SetDebugName(std::format("VMA::Buffer (Exportable, {} bytes, usage {:#x})", size, usage).c_str());
+		return buffer;
+	}
+
+	std::shared_ptr<VMA::Image> VMA::
+		AllocateExportableImage(VkImageAspectFlags aspect, VkImageUsageFlags usage, uint32_t width, uint32_t height, uint32_t channel, VkFormat format)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::AllocateExportableImage");
+		if (!m_context->IsExternalMemorySupported())
+			throw std::runtime_error("Failed to create the exportable Vulkan Image - External memory is not supported by this device!");
+		VkImageCreateInfo imageCreateInfo = make_image_create_info(usage, width, height, format, VK_IMAGE_TILING_OPTIMAL, 1);
+		VkPhysicalDeviceExternalImageFormatInfo externalImageFormatInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_IMAGE_FORMAT_INFO,
+			.handleType = ExternalMemoryHandleType
+		};
+		const VkPhysicalDeviceImageFormatInfo2 imageFormatInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+			.pNext = &externalImageFormatInfo,
+			.format = format,
+			.type = VK_IMAGE_TYPE_2D,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = imageCreateInfo.usage
+		};
+		VkExternalImageFormatProperties externalImageFormatProperties{ .sType = VK_STRUCTURE_TYPE_EXTERNAL_IMAGE_FORMAT_PROPERTIES };
+		VkImageFormatProperties2 imageFormatProperties{ .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2, .pNext = &externalImageFormatProperties };
+		if (vkGetPhysicalDeviceImageFormatProperties2(m_context->m_physical_device, &imageFormatInfo, &imageFormatProperties) != VK_SUCCESS ||
+			!(externalImageFormatProperties.externalMemoryProperties.externalMemoryFeatures & VK_EXTERNAL_MEMORY_FEATURE_EXPORTABLE_BIT))
+			throw std::runtime_error(std::format("Failed to create the exportable Vulkan Image - The format {} with the usage {:#x} cannot be exported!",
+				static_cast<int>(format), usage));
+
+		VkExternalMemoryImageCreateInfo externalMemoryCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+			.handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(ExternalMemoryHandleType)
+		};
+		imageCreateInfo.pNext = &externalMemoryCreateInfo;
+		VmaAllocationCreateInfo allocationInfo
+		{
+			.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, // Ditto
+			.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+			.priority = GetMemoryPriorityValue(MemoryPriority::HIGH)
+		};
+		uint32_t memoryTypeIndex = 0;
+		if (vmaFindMemoryTypeIndexForImageInfo(m_allocator, &imageCreateInfo, &allocationInfo, &memoryTypeIndex) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the exportable Vulkan Image - No suitable memory type!");
+		allocationInfo.pool = get_exportable_pool(ExternalMemoryHandleType, memoryTypeIndex);
+
+		auto image = std::make_shared<VMA::Image>(shared_from_this());
+		VmaAllocationInfo allocatedInfo{};
+		if (vmaCreateImage(m_allocator, &imageCreateInfo, &allocationInfo, &image->m_image, &image->m_allocation, &allocatedInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the exportable Vulkan Image!");
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_ALLOCATIONS);
+		m_context->GetStatistics().Add(RHIStatistics::IMAGE_BYTES, allocatedInfo.size);
+
+		setup_image(*image, aspect, imageCreateInfo.usage, width, height, channel, format, 1);
+		image->m_is_dedicated = true;
+		image->m_export_handle_type = ExternalMemoryHandleType;
+		return image;
+	}
+
+	VMA::ExternalMemory VMA::ExportMemory(Buffer& buffer)
+	{
+		if (!buffer.m_export_handle_type) throw std::runtime_error("Failed to export the Vulkan Buffer - It was not allocated as exportable!");
+		return export_memory(buffer.m_allocation, buffer.m_export_handle_type);
+	}
+
+	VMA::ExternalMemory VMA::ExportMemory(Image& image)
+	{
+		if (!image.m_export_handle_type) throw std::runtime_error("Failed to export the Vulkan Image - It was not allocated as exportable!");
+		return export_memory(image.m_allocation, image.m_export_handle_type);
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::ImportBuffer(const ExternalMemory& memory, size_t size, VkBufferUsageFlags usage)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::ImportBuffer");
+		VkExternalMemoryBufferCreateInfo externalMemoryCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+			.handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(memory.handle_type)
+		};
+		VkBufferCreateInfo bufferCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = &externalMemoryCreateInfo,
+			.size = size,
+			.usage = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE
+		};
+		auto buffer = std::make_shared<VMA::Buffer>(shared_from_this());
+		if (vkCreateBuffer(m_context->m_device, &bufferCreateInfo, m_context->m_memory_allocation_callback, &buffer->m_buffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the imported Vulkan Buffer!");
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(m_context->m_device, buffer->m_buffer, &memoryRequirements);
+		buffer->m_imported_memory = import_memory(memory, memoryRequirements, buffer->m_buffer, VK_NULL_HANDLE);
+		if (vkBindBufferMemory(m_context->m_device, buffer->m_buffer, buffer->m_imported_memory.get(), 0) != VK_SUCCESS)
+			throw std::runtime_error("Failed to bind the imported memory to the Vulkan Buffer!");
+
+		buffer->m_state_tracker.Reset(size);
+		buffer->m_buffer_size = size;
+		buffer->m_buffer_usage = usage;
+		if constexpr (EnableDebugMarkers)
+			buffer->SetDebugName(std::format("VMA::Buffer (Imported, {} bytes, usage {:#x})", size, usage).c_str());
+		return buffer;
+	}
+
+	std::shared_ptr<VMA::Buffer> VMA::BindPeerBuffer(std::shared_ptr<Buffer> buffer, std::span<const uint32_t> device_indices)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::BindPeerBuffer");
+		if (device_indices.size() != m_context->GetDeviceCount())
+			throw std::runtime_error(std::format("Failed to bind the peer Vulkan Buffer - {} device indices for {} devices!",
+				device_indices.size(), m_context->GetDeviceCount()));
+		if (buffer->m_allocation == VK_NULL_HANDLE || buffer->m_is_movable)
+			throw std::runtime_error("Failed to bind the peer Vulkan Buffer - The memory is not owned by the buffer or it is movable!");
+
+		VkBufferCreateInfo bufferCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.size = buffer->m_buffer_size,
+			.usage = buffer->m_buffer_usage,
+			.sharingMode = buffer->m_sharing_mode,
+			.queueFamilyIndexCount = static_cast<uint32_t>(buffer->m_queue_families.size()),
+			.pQueueFamilyIndices = buffer->m_queue_families.data()
+		};
+		auto peerBuffer = std::make_shared<VMA::Buffer>(shared_from_this());
+		if (vkCreateBuffer(m_context->m_device, &bufferCreateInfo, m_context->m_memory_allocation_callback, &peerBuffer->m_buffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the peer Vulkan Buffer!");
+		const VkBindBufferMemoryDeviceGroupInfo deviceGroupBindInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_DEVICE_GROUP_INFO,
+			.deviceIndexCount = static_cast<uint32_t>(device_indices.size()),
+			.pDeviceIndices = device_indices.data()
+		};
+		if (vmaBindBufferMemory2(m_allocator, buffer->m_allocation, 0, peerBuffer->m_buffer, &deviceGroupBindInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to bind the peer memory to the Vulkan Buffer!");
+
+		peerBuffer->m_state_tracker.Reset(buffer->m_buffer_size);
+		peerBuffer->m_buffer_size = buffer->m_buffer_size;
+		peerBuffer->m_buffer_usage = buffer->m_buffer_usage;
+		peerBuffer->m_sharing_mode = buffer->m_sharing_mode;
+		peerBuffer->m_queue_families = buffer->m_queue_families;
+		buffer->m_has_peers = true;
+		peerBuffer->m_peer_source = std::move(buffer);
+		if constexpr (EnableDebugMarkers)
+			peerBuffer->SetDebugName(std::format("VMA::Buffer (Peer, {} bytes, usage {:#x})", peerBuffer->m_buffer_size, peerBuffer->m_buffer_usage).c_str());
+		return peerBuffer;
+	}
+
+	std::shared_ptr<VMA::Image> VMA::ImportImage(const ExternalMemory& memory, VkImageAspectFlags aspect, VkImageUsageFlags usage,
+		uint32_t width, uint32_t height, uint32_t channel, VkFormat format)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::ImportImage");
+		VkImageCreateInfo imageCreateInfo = make_image_create_info(usage, width, height, format, VK_IMAGE_TILING_OPTIMAL, 1); // As exported
+		VkExternalMemoryImageCreateInfo externalMemoryCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+			.handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(memory.handle_type)
+		};
+		imageCreateInfo.pNext = &externalMemoryCreateInfo;
+		auto image = std::make_shared<VMA::Image>(shared_from_this());
+		if (vkCreateImage(m_context->m_device, &imageCreateInfo, m_context->m_memory_allocation_callback, &image->m_image) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the imported Vulkan Image!");
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(m_context->m_device, image->m_image, &memoryRequirements);
+		image->m_imported_memory = import_memory(memory, memoryRequirements, VK_NULL_HANDLE, image->m_image);
+		if (vkBindImageMemory(m_context->m_device, image->m_image, image->m_imported_memory.get(), 0) != VK_SUCCESS)
+			throw std::runtime_error("Failed to bind the imported memory to the Vulkan Image!");
+
+		setup_image(*image, aspect, imageCreateInfo.usage, width, height, channel, format, 1);
+		image->m_aliased_size = memory.size;
+		return image;
+	}
+
+	VmaPool VMA::get_exportable_pool(VkExternalMemoryHandleTypeFlagBits handle_type, uint32_t memory_type_index)
+	{
+		std::scoped_lock guard{ m_memory_pool_mutex };
+		auto& exportablePool = m_exportable_pools[(static_cast<uint64_t>(handle_type) << 32) | memory_type_index];
+		if (exportablePool.pool != VK_NULL_HANDLE) return exportablePool.pool;
+
+		exportablePool.export_info = std::make_unique<VkExportMemoryAllocateInfo>(VkExportMemoryAllocateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+				.handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(handle_type)
+			});
+		VmaPoolCreateInfo poolCreateInfo
+		{
+			.memoryTypeIndex = memory_type_index,
+			.priority = GetMemoryPriorityValue(MemoryPriority::HIGH), // Shared frames
+			.pMemoryAllocateNext = exportablePool.export_info.get() // Also chained to the dedicated allocations of the pool
+		};
+		if (vmaCreatePool(m_allocator, &poolCreateInfo, &exportablePool.pool) != VK_SUCCESS)
+		{
+			m_exportable_pools.erase((static_cast<uint64_t>(handle_type) << 32) | memory_type_index);
+			throw std::runtime_error("Failed to create the exportable VMA memory pool!");
+		}
+		return exportablePool.pool;
+	}
+
+	VMA::ExternalMemory VMA::export_memory(VmaAllocation allocation, VkExternalMemoryHandleTypeFlagBits handle_type)
+	{
+		VmaAllocationInfo allocationInfo{};
+		vmaGetAllocationInfo(m_allocator, allocation, &allocationInfo);
+		assert(allocationInfo.offset == 0 && "Exportable resources own their memory!");
+
+		ExternalMemory memory{ .handle_type = handle_type, .size = allocationInfo.size };
+#ifdef _WIN32
+		const VkMemoryGetWin32HandleInfoKHR getInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_GET_WIN32_HANDLE_INFO_KHR,
+			.memory = allocationInfo.deviceMemory,
+			.handleType = handle_type
+		};
+		HANDLE handle = nullptr;
+		VkResult result = reinterpret_cast<PFN_vkGetMemoryWin32HandleKHR>(m_context->m_get_memory_win32_handle)(m_context->m_device, &getInfo, &handle);
+		memory.handle = handle;
+#else
+		const VkMemoryGetFdInfoKHR getInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+			.memory = allocationInfo.deviceMemory,
+			.handleType = handle_type
+		};
+		VkResult result = m_context->m_get_memory_fd(m_context->m_device, &getInfo, &memory.handle);
+#endif
+		if (result != VK_SUCCESS) throw std::runtime_error("Failed to export the Vulkan memory!");
+		return memory;
+	}
+
+	std::shared_ptr<VkDeviceMemory_T> VMA::import_memory(const ExternalMemory& memory, const VkMemoryRequirements& requirements,
+		VkBuffer buffer, VkImage image)
+	{
+		if (!m_context->IsExternalMemorySupported())
+			throw std::runtime_error("Failed to import the Vulkan memory - External memory is not supported by this device!");
+		if (memory.size < requirements.size)
+			throw std::runtime_error("Failed to import the Vulkan memory - The resource does not match the exported one!");
+
+		uint32_t memoryTypeBits = requirements.memoryTypeBits;
+#ifndef _WIN32
+		if (memory.handle_type == VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT && m_context->IsDmaBufSupported())
+		{
+			VkMemoryFdPropertiesKHR fdProperties{ .sType = VK_STRUCTURE_TYPE_MEMORY_FD_PROPERTIES_KHR };
+			if (m_context->m_get_memory_fd_properties(m_context->m_device, memory.handle_type, memory.handle, &fdProperties) != VK_SUCCESS)
+				throw std::runtime_error("Failed to import the Vulkan memory - Invalid dma-buf!");
+			memoryTypeBits &= fdProperties.memoryTypeBits;
+		}
+#endif
+		const VmaAllocationCreateInfo allocationInfo{ .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+		uint32_t memoryTypeIndex = 0;
+		if (vmaFindMemoryTypeIndex(m_allocator, memoryTypeBits, &allocationInfo, &memoryTypeIndex) != VK_SUCCESS)
+			throw std::runtime_error("Failed to import the Vulkan memory - No suitable memory type!");
+
+		VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+			.image = image,
+			.buffer = buffer
+		};
+#ifdef _WIN32
+		VkImportMemoryWin32HandleInfoKHR importInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR,
+			.pNext = &dedicatedAllocateInfo,
+			.handleType = memory.handle_type,
+			.handle = memory.handle
+		};
+#else
+		VkImportMemoryFdInfoKHR importInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+			.pNext = &dedicatedAllocateInfo,
+			.handleType = memory.handle_type,
+			.fd = memory.handle
+		};
+#endif
+		const VkMemoryAllocateInfo memoryAllocateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.pNext = &importInfo,
+			.allocationSize = memory.size,
+			.memoryTypeIndex = memoryTypeIndex
+		};
+		VkDeviceMemory deviceMemory = VK_NULL_HANDLE;
+		if (vkAllocateMemory(m_context->m_device, &memoryAllocateInfo, m_context->m_memory_allocation_callback, &deviceMemory) != VK_SUCCESS)
+			throw std::runtime_error("Failed to import the Vulkan memory!");
+		// Freed after the deferred deletion of the resource
+		return { deviceMemory, [context = m_context](VkDeviceMemory device_memory)
+			{ vkFreeMemory(context->m_device, device_memory, context->m_memory_allocation_callback); } };
+	}
+
+	void CloseExternalHandle(ExternalHandle handle)
+	{
+#ifdef _WIN32
+		CloseHandle(handle);
+#else
+		close(handle);
+#endif
+	}
+
+	std::shared_ptr<VMA::StagingRing> VMA::
+		CreateStagingRing(VkDeviceSize frame_capacity, uint32_t frames_in_flight)
+	{
+		return std::make_shared<StagingRing>(shared_from_this(), frame_capacity, frames_in_flight);
+	}
+
+	VMA::StagingRing::StagingRing(std::shared_ptr<VulkanMemoryAllocator> parent, VkDeviceSize frame_capacity, uint32_t frames_in_flight) :
+		m_parent{ std::move(parent) },
+		m_frame_capacity{ frame_capacity },
+		m_copy_alignment{ std::max<VkDeviceSize>(m_parent->m_context->m_physical_device_properties.limits.optimalBufferCopyOffsetAlignment, 4) },
+		m_overflow_buffers(frames_in_flight)
+	{
+		assert(frames_in_flight > 0 && "Staging Ring needs at least one frame!");
+		// Keep every partition aligned
+		m_frame_capacity = (m_frame_capacity + m_copy_alignment - 1) / m_copy_alignment * m_copy_alignment;
+		m_buffer = m_parent->AllocateBuffer(m_frame_capacity * frames_in_flight, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, true, false, true);
+		m_mapped_data = static_cast<uint8_t*>(m_buffer->Access());
+	}
+
+	VMA::StagingRing::Allocation VMA::StagingRing::
+		Allocate(VkDeviceSize size, VkDeviceSize alignment/* = 0*/)
+	{
+		// Alignment may be a non-power-of-two texel size (e.g. 12 bytes)
+		VkDeviceSize finalAlignment = m_copy_alignment;
+		if (alignment && finalAlignment % alignment)
+			finalAlignment = std::lcm(finalAlignment, alignment);
+
+		m_parent->m_context->GetStatistics().Add(RHIStatistics::STAGING_BYTES, size);
+		std::scoped_lock guard{ m_mutex };
+		// Align the offset inside the ring (Partitions are aligned to optimalBufferCopyOffsetAlignment only, not to the lcm)
+		const VkDeviceSize partitionOffset = m_frame_capacity * m_frame_index;
+		VkDeviceSize ringOffset = (partitionOffset + m_frame_offset + finalAlignment - 1) / finalAlignment * finalAlignment;
+		VkDeviceSize offset = ringOffset - partitionOffset;
+		if (offset + size > m_frame_capacity)
+		{
+			// Oversized or exhausted - fall back to a dedicated staging buffer living until this frame retires
+			auto& overflowBuffer = m_overflow_buffers[m_frame_index].emplace_back(
+				m_parent->AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, true, false, true));
+			return Allocation
+			{
+				.buffer = *overflowBuffer,
+				.offset = 0,
+				.size = size,
+				.data = overflowBuffer->Access()
+			};
+		}
+
+		m_frame_offset = offset + size;
+		return Allocation
+		{
+			.buffer = *m_buffer,
+			.offset = ringOffset,
+			.size = size,
+			.data = m_mapped_data + ringOffset
+		};
+	}
+
+	void VMA::StagingRing::Flush(const Allocation& allocation)
+	{
+		std::scoped_lock guard{ m_mutex }; // Allocate() may append to m_overflow_buffers concurrently
+		if (allocation.buffer == *m_buffer)
+			vmaFlushAllocation(m_parent->m_allocator, m_buffer->m_allocation, allocation.offset, allocation.size);
+		else for (auto& overflowBuffer : m_overflow_buffers[m_frame_index])
+		{
+			if (allocation.buffer == *overflowBuffer)
+			{
+				vmaFlushAllocation(m_parent->m_allocator, overflowBuffer->m_allocation, 0, VK_WHOLE_SIZE);
+				break;
+			}
+		}
+	}
+
+	VkDeviceSize VMA::StagingRing::GetFrameAvailable()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_frame_capacity - m_frame_offset;
+	}
+
+	void VMA::StagingRing::BeginFrame(uint32_t frame_index)
+	{
+		assert(frame_index < m_overflow_buffers.size() && "Frame index is out of range!");
+		std::scoped_lock guard{ m_mutex };
+		m_frame_index = frame_index;
+		m_frame_offset = 0;
+		m_overflow_buffers[m_frame_index].clear();
+	}
+
+	std::shared_ptr<VMA::BufferSuballocator> VMA::
+		CreateBufferSuballocator(VkBufferUsageFlags usage, VkDeviceSize page_size/* = 4 * 1024 * 1024*/)
+	{
+		return std::make_shared<BufferSuballocator>(shared_from_this(), usage, page_size);
+	}
+
+	VMA::BufferSuballocator::BufferSuballocator(std::shared_ptr<VulkanMemoryAllocator> parent, VkBufferUsageFlags usage, VkDeviceSize page_size) :
+		m_parent{ std::move(parent) },
+		m_usage{ usage },
+		m_page_size{ page_size },
+		m_alignment{ 4 }
+	{
+		assert(page_size > 0 && "Invalid page size of the Buffer Suballocator!");
+		assert((usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) && "Buffer Suballocator serves uniform or storage buffers!");
+		const auto& limits = m_parent->m_context->m_physical_device_properties.limits;
+		// Both limits are powers of two
+		if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) m_alignment = std::max(m_alignment, limits.minUniformBufferOffsetAlignment);
+		if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) m_alignment = std::max(m_alignment, limits.minStorageBufferOffsetAlignment);
+	}
+
+	VMA::BufferSuballocator::~BufferSuballocator()
+	{
+		// Every slice holds this suballocator, so all virtual allocations have been released
+		for (auto& page : m_pages) vmaDestroyVirtualBlock(page.block);
+	}
+
+	std::shared_ptr<VMA::BufferSuballocator::Slice> VMA::BufferSuballocator::
+		Allocate(VkDeviceSize size)
+	{
+		assert(size > 0 && "Cannot allocate an empty slice!");
+		if ((m_usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) && size > m_parent->m_context->m_physical_device_properties.limits.maxUniformBufferRange)
+			throw std::runtime_error("Failed to allocate the Buffer Slice - Size exceeds maxUniformBufferRange!");
+
+		VmaVirtualAllocationCreateInfo allocationCreateInfo
+		{
+			.size = size,
+			.alignment = m_alignment
+		};
+		auto slice = std::make_shared<Slice>(shared_from_this());
+
+		std::scoped_lock guard{ m_mutex };
+		for (uint32_t page_index = 0; page_index <= m_pages.size(); ++page_index)
+		{
+			if (page_index == m_pages.size())
+			{
+				// Exhausted - open a new page
+				VmaVirtualBlockCreateInfo blockCreateInfo{ .size = std::max(size, m_page_size) };
+				Page page{ .buffer = m_parent->AllocateBuffer(blockCreateInfo.size, m_usage, true, true, false, true) };
+				if (vmaCreateVirtualBlock(&blockCreateInfo, &page.block) != VK_SUCCESS)
+					throw std::runtime_error("Failed to create the virtual block of the Buffer Suballocator!");
+				page.data = static_cast<uint8_t*>(page.buffer->Access());
+				if constexpr (EnableDebugMarkers)
+					page.buffer->SetDebugName(std::format("Buffer Suballocator Page {}", page_index).c_str());
+				m_pages.emplace_back(std::move(page));
+			}
+
+			auto& page = m_pages[page_index];
+			if (vmaVirtualAllocate(page.block, &allocationCreateInfo, &slice->m_allocation, &slice->m_offset) == VK_SUCCESS)
+			{
+				slice->m_page_index = page_index;
+				slice->m_page = page.buffer;
+				slice->m_size = size;
+				slice->m_data = page.data + slice->m_offset;
+				break;
+			}
+		}
+		return slice;
+	}
+
+	size_t VMA::BufferSuballocator::GetPageCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_pages.size();
+	}
+
+	void VMA::BufferSuballocator::release(uint32_t page_index, VmaVirtualAllocation allocation)
+	{
+		std::scoped_lock guard{ m_mutex };
+		vmaVirtualFree(m_pages[page_index].block, allocation);
+	}
+
+	VMA::BufferSuballocator::Slice::~Slice()
+	{
+		if (m_allocation == VK_NULL_HANDLE) return;
+		m_parent->m_parent->m_context->DeferDeletion([suballocator = m_parent, page_index = m_page_index, allocation = m_allocation]()
+			{ suballocator->release(page_index, allocation); });
+	}
+
+	void VMA::BufferSuballocator::Slice::Write(const void* data, VkDeviceSize size/* = 0*/, VkDeviceSize offset/* = 0*/)
+	{
+		if (!size) size = m_size - offset;
+		assert(offset + size <= m_size && "Writing out of the Buffer Slice!");
+		memcpy(m_data + offset, data, size);
+		vmaFlushAllocation(m_parent->m_parent->m_allocator, m_page->m_allocation, m_offset + offset, size);
+	}
+
+	void VMA::BufferSuballocator::Slice::Flush()
+	{
+		vmaFlushAllocation(m_parent->m_parent->m_allocator, m_page->m_allocation, m_offset, m_size);
+	}
+
+	bool VMA::Defragment(VkDeviceSize budget_per_frame/* = 16 * 1024 * 1024*/)
+	{
+		switch (m_defragmentation.state)
+		{
+		case DefragmentationState::IDLE:
+		{
+			VmaDefragmentationInfo defragmentationInfo
+			{
+				.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+				.pool = VK_NULL_HANDLE, // Default heap
+				.maxBytesPerPass = budget_per_frame,
+				.maxAllocationsPerPass = 0
+			};
+			if (vmaBeginDefragmentation(m_allocator, &defragmentationInfo, &m_defragmentation.context) != VK_SUCCESS)
+				throw std::runtime_error("Failed to begin the VMA defragmentation!");
+			m_defragmentation.budget = budget_per_frame;
+			m_defragmentation.statistics = {};
+			m_defragmentation.state = DefragmentationState::READY;
+			[[fallthrough]];
+		}
+		case DefragmentationState::READY:
+			begin_defragmentation_pass(); break;
+		case DefragmentationState::COPYING:
+			if (m_defragmentation.timeline->IsComplete(m_defragmentation.tick))
+				patch_defragmentation_pass();
+			break;
+		case DefragmentationState::RETIRING: break; // end_defragmentation_pass() is deferred
+		}
+		return IsDefragmenting();
+	}
+
+	void VMA::begin_defragmentation_pass()
+	{
+		auto& defragmentation = m_defragmentation;
+		defragmentation.pass = std::make_unique<VmaDefragmentationPassMoveInfo>();
+		if (vmaBeginDefragmentationPass(m_allocator, defragmentation.context, defragmentation.pass.get()) == VK_SUCCESS)
+		{
+			// Nothing left to move
+			defragmentation.pass.reset();
+			vmaEndDefragmentation(m_allocator, defragmentation.context, nullptr);
+			defragmentation.context = VK_NULL_HANDLE;
+			defragmentation.state = DefragmentationState::IDLE;
+			if (defragmentation.statistics.allocations_moved)
+				log::info("[VMA] Defragmentation moved {} allocations ({} bytes) in {} passes",
+					defragmentation.statistics.allocations_moved, defragmentation.statistics.bytes_moved, defragmentation.statistics.passes);
+			return;
+		}
+
+		std::scoped_lock guard{ m_defragmentation_mutex };
+		defragmentation.moves.clear();
+		std::shared_ptr<CommandBuffer> commandBuffer;
+		for (uint32_t move_index = 0; move_index < defragmentation.pass->moveCount; ++move_index)
+		{
+			auto& vmaMove = defragmentation.pass->pMoves[move_index];
+			auto target = m_movable_resources.find(vmaMove.srcAllocation);
+			if (target == m_movable_resources.end())
+			{
+				vmaMove.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE; // Not opted in (e.g. mapped rings & suballocator pages)
+				continue;
+			}
+			if (!commandBuffer)
+			{
+				commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_graphics);
+				commandBuffer->Begin();
+			}
+
+			auto& move = defragmentation.moves.emplace_back(DefragmentationMove
+				{
+					.move_index = move_index,
+					.buffer = target->second.first,
+					.image = target->second.second
+				});
+			if (move.buffer)
+			{
+				auto& buffer = *move.buffer;
+				VkBufferCreateInfo bufferCreateInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+					.size = buffer.m_buffer_size,
+					.usage = buffer.m_buffer_usage,
+					.sharingMode = buffer.m_sharing_mode,
+					.queueFamilyIndexCount = static_cast<uint32_t>(buffer.m_queue_families.size()),
+					.pQueueFamilyIndices = buffer.m_queue_families.data()
+				};
+				if (vmaCreateAliasingBuffer(m_allocator, vmaMove.dstTmpAllocation, &bufferCreateInfo, &move.new_buffer) != VK_SUCCESS)
+					throw std::runtime_error("Failed to create the moved Vulkan Buffer!");
+				if (auto capture = m_context->GetCommandCapture()) capture->AddBuffer(move.new_buffer, buffer.m_buffer_size, buffer.m_buffer_usage);
+
+				buffer.TransitionCommand(*commandBuffer, ResourceAccess
+					{
+						.stages = VK_PIPELINE_STAGE_2_COPY_BIT,
+						.access = VK_ACCESS_2_TRANSFER_READ_BIT
+					});
+				commandBuffer->FlushBarriers();
+				VkBufferCopy bufferCopy{ .srcOffset = 0, .dstOffset = 0, .size = buffer.m_buffer_size };
+				commandBuffer->GetDispatch().vkCmdCopyBuffer(*commandBuffer, buffer.m_buffer, move.new_buffer, 1, &bufferCopy);
+				commandBuffer->QueueBarrier(VkBufferMemoryBarrier2
+					{
+						.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+						.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+						.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+						.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+						.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.buffer = move.new_buffer,
+						.offset = 0,
+						.size = VK_WHOLE_SIZE
+					});
+				defragmentation.statistics.bytes_moved += buffer.m_buffer_size;
+			}
+			else
+			{
+				auto& image = *move.image;
+				VkImageCreateInfo imageCreateInfo = make_image_create_info(image.m_image_usage,
+					image.m_image_width, image.m_image_height, image.m_image_format, image.m_image_tiling, image.m_mipmap_level,
+					image.m_image_type, (image.m_image_type == ImageType::IMAGE_3D)? image.m_image_depth : image.m_array_layers, image.m_sample_count);
+				const auto compressionControl = make_image_compression_control(image.m_compression_request, image.m_compression_fixed_rate_request, nullptr);
+				if (image.m_compression_request != VK_IMAGE_COMPRESSION_DEFAULT_EXT) imageCreateInfo.pNext = &compressionControl;
+				if (vmaCreateAliasingImage(m_allocator, vmaMove.dstTmpAllocation, &imageCreateInfo, &move.new_image) != VK_SUCCESS)
+					throw std::runtime_error("Failed to create the moved Vulkan Image!");
+
+				move.layout = image.m_state_tracker.GetLayout();
+				if (move.layout != VK_IMAGE_LAYOUT_UNDEFINED) // Otherwise nothing to preserve
+				{
+					const auto wholeRange = image.m_state_tracker.GetWholeRange();
+					image.TransitionCommand(*commandBuffer, ResourceAccess
+						{
+							.stages = VK_PIPELINE_STAGE_2_COPY_BIT,
+							.access = VK_ACCESS_2_TRANSFER_READ_BIT,
+							.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+						});
+					commandBuffer->QueueBarrier(VkImageMemoryBarrier2
+						{
+							.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+							.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+							.srcAccessMask = VK_ACCESS_2_NONE,
+							.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+							.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+							.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+							.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.image = move.new_image,
+							.subresourceRange = wholeRange
+						});
+					commandBuffer->FlushBarriers();
+
+					std::vector<VkImageCopy> imageCopies(image.m_mipmap_level);
+					for (uint32_t mip_level = 0; mip_level < image.m_mipmap_level; ++mip_level)
+					{
+						const VkImageSubresourceLayers subresource
+						{
+							.aspectMask = wholeRange.aspectMask,
+							.mipLevel = mip_level,
+							.baseArrayLayer = 0,
+							.layerCount = image.m_array_layers
+						};
+						imageCopies[mip_level] = VkImageCopy
+						{
+							.srcSubresource = subresource,
+							.srcOffset = {0, 0, 0},
+							.dstSubresource = subresource,
+							.dstOffset = {0, 0, 0},
+							.extent = { std::max(image.m_image_width >> mip_level, 1u), std::max(image.m_image_height >> mip_level, 1u),
+								std::max(image.m_image_depth >> mip_level, 1u) }
+						};
+					}
+					commandBuffer->GetDispatch().vkCmdCopyImage(*commandBuffer, image.m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						move.new_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(imageCopies.size()), imageCopies.data());
+					commandBuffer->QueueBarrier(VkImageMemoryBarrier2
+						{
+							.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+							.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+							.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+							.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+							.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+							.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							.newLayout = move.layout, // Restored as the tracked layout of the source
+							.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.image = move.new_image,
+							.subresourceRange = wholeRange
+						});
+				}
+				defragmentation.statistics.bytes_moved += image.Size();
+			}
+		}
+		++defragmentation.statistics.passes;
+		defragmentation.statistics.allocations_moved += static_cast<uint32_t>(defragmentation.moves.size());
+
+		if (!commandBuffer)
+		{
+			// Nothing movable in this pass
+			defragmentation.state = DefragmentationState::RETIRING;
+			end_defragmentation_pass();
+			return;
+		}
+		commandBuffer->End();
+		defragmentation.tick = commandBuffer->SubmitTick(); // Recycled by the pool after the tick
+		defragmentation.timeline = &commandBuffer->GetSubmittedQueueTimeline();
+		defragmentation.state = DefragmentationState::COPYING;
+	}
+
+	void VMA::patch_defragmentation_pass()
+	{
+		auto& defragmentation = m_defragmentation;
+		auto& context = m_context;
+		std::vector<Buffer*> movedBuffers;
+		std::vector<Image*> movedImages;
+		{
+			std::scoped_lock guard{ m_defragmentation_mutex };
+			for (auto& move : defragmentation.moves)
+			{
+				auto& vmaMove = defragmentation.pass->pMoves[move.move_index];
+				if (move.is_abandoned)
+				{
+					// The resource is gone, its memory is freed with the pass (The copy has completed)
+					vmaMove.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+					vkDestroyImage(context->m_device, move.new_image, context->m_memory_allocation_callback);
+					vkDestroyBuffer(context->m_device, move.new_buffer, context->m_memory_allocation_callback);
+					continue;
+				}
+
+				if (move.buffer)
+				{
+					auto& buffer = *move.buffer;
+					std::vector<VkBufferView> oldBufferViews;
+					{
+						// The texel views of the new buffer are created again on first use
+						std::scoped_lock viewGuard{ buffer.m_view_mutex };
+						for (const auto& texel_view : buffer.m_texel_views) oldBufferViews.emplace_back(texel_view.view);
+						buffer.m_texel_views.clear();
+					}
+					// Recorded frames still use the old handle until they retire
+					context->InvalidateBakedCommands(buffer.m_buffer);
+					context->DeferDeletion([allocator = shared_from_this(), old_buffer = buffer.m_buffer, old_buffer_views = std::move(oldBufferViews)]()
+						{
+							for (auto old_buffer_view : old_buffer_views)
+								vkDestroyBufferView(allocator->m_context->m_device, old_buffer_view, allocator->m_context->m_memory_allocation_callback);
+							vkDestroyBuffer(allocator->m_context->m_device, old_buffer, allocator->m_context->m_memory_allocation_callback);
+						});
+					buffer.m_buffer = move.new_buffer;
+					buffer.m_device_address = 0; // Queried again
+					buffer.m_state_tracker.Reset(buffer.m_buffer_size);
+					movedBuffers.emplace_back(&buffer);
+				}
+				else
+				{
+					auto& image = *move.image;
+					std::vector<VkImageView> oldImageViews;
+					{
+						// The views of the new image are created again on first use
+						std::scoped_lock viewGuard{ image.m_view_mutex };
+						for (auto& [viewDesc, view] : image.m_views) oldImageViews.emplace_back(view);
+						image.m_views.clear();
+						image.m_image_view = VK_NULL_HANDLE;
+						image.m_sampled_view = VK_NULL_HANDLE;
+					}
+					context->InvalidateBakedCommands(image.m_image);
+					context->DeferDeletion([allocator = shared_from_this(), old_image = image.m_image, old_image_views = std::move(oldImageViews),
+						bindless_index = image.m_bindless_index]()
+						{
+							auto& context = allocator->m_context;
+							if (bindless_index.has_value() && context->IsBindlessSupported())
+								context->GetBindlessHeap().Release(BindlessHeap::SAMPLED_IMAGE, bindless_index.value());
+							for (auto old_image_view : old_image_views)
+								vkDestroyImageView(context->m_device, old_image_view, context->m_memory_allocation_callback);
+							vkDestroyImage(context->m_device, old_image, context->m_memory_allocation_callback);
+						});
+					image.m_image = move.new_image;
+					image.m_state_tracker.Reset(image.m_mipmap_level, image.m_array_layers, image.m_state_tracker.GetAspect(), move.layout);
+					image.m_image_layout = move.layout;
+					// Rewriting the slot in place would race the pending command buffers reading it
+					if (image.m_bindless_index.has_value())
+						image.m_bindless_index = context->GetBindlessHeap().RegisterSampledImage(image.GetSampledImageView());
+					movedImages.emplace_back(&image);
+				}
+			}
+			defragmentation.moves.clear();
+			defragmentation.state = DefragmentationState::RETIRING;
+		}
+
+		// The old memory is released after the old handles (Deletions run in order)
+		context->DeferDeletion([allocator = shared_from_this()]() { allocator->end_defragmentation_pass(); });
+
+		for (auto buffer : movedBuffers) if (buffer->m_on_moved) buffer->m_on_moved(*buffer);
+		for (auto image : movedImages) if (image->m_on_moved) image->m_on_moved(*image);
+	}
+
+	void VMA::end_defragmentation_pass()
+	{
+		auto& defragmentation = m_defragmentation;
+		if (defragmentation.state != DefragmentationState::RETIRING) return; // Canceled
+		bool isComplete = vmaEndDefragmentationPass(m_allocator, defragmentation.context, defragmentation.pass.get()) == VK_SUCCESS;
+		defragmentation.pass.reset();
+		defragmentation.state = DefragmentationState::READY;
+		if (isComplete)
+		{
+			vmaEndDefragmentation(m_allocator, defragmentation.context, nullptr);
+			defragmentation.context = VK_NULL_HANDLE;
+			defragmentation.state = DefragmentationState::IDLE;
+		}
+	}
+
+	bool VMA::release_movable(VmaAllocation allocation)
+	{
+		std::scoped_lock guard{ m_defragmentation_mutex };
+		m_movable_resources.erase(allocation);
+		if (m_defragmentation.state != DefragmentationState::COPYING) return false;
+		for (auto& move : m_defragmentation.moves)
+		{
+			if (m_defragmentation.pass->pMoves[move.move_index].srcAllocation != allocation) continue;
+			move.is_abandoned = true;
+			return true;
+		}
+		return false;
+	}
+
+	void VMA::cancel_defragmentation()
+	{
+		auto& defragmentation = m_defragmentation;
+		if (!defragmentation.context) return;
+		if (defragmentation.state == DefragmentationState::COPYING)
+		{
+			// Teardown: Every resource is gone, so only the abandoned copies are left
+			defragmentation.timeline->Wait(defragmentation.tick);
+			defragmentation.state = DefragmentationState::RETIRING;
+			for (auto& move : defragmentation.moves)
+			{
+				defragmentation.pass->pMoves[move.move_index].operation = move.is_abandoned?
+					VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY : VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+				vkDestroyImage(m_context->m_device, move.new_image, m_context->m_memory_allocation_callback);
+				vkDestroyBuffer(m_context->m_device, move.new_buffer, m_context->m_memory_allocation_callback);
+			}
+			defragmentation.moves.clear();
+			vmaEndDefragmentationPass(m_allocator, defragmentation.context, defragmentation.pass.get());
+			defragmentation.pass.reset();
+		}
+		vmaEndDefragmentation(m_allocator, defragmentation.context, nullptr);
+		defragmentation.context = VK_NULL_HANDLE;
+		defragmentation.state = DefragmentationState::IDLE;
 	}
 
 }} // namespace Albedo::RHI
\ No newline at end of file
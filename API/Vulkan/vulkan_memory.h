@@ -2,48 +2,210 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vulkan_debug.h"
+#include "vulkan_dispatch.h"
+#include "vulkan_trace.h"
+#include "vulkan_state.h"
+#include "vulkan_format.h"
+
 #include <unordered_map>
 #include <unordered_set>
 #include <string_view>
 #include <stdexcept>
 #include <algorithm>
+#include <functional>
 #include <optional>
 #include <memory>
 #include <numeric>
+#include <span>
 #include <cassert>
 #include <format>
 #include <thread>
 #include <vector>
 #include <string>
 #include <array>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
 
 // Predeclaration
 typedef struct VmaAllocator_T* VmaAllocator;
 typedef struct VmaAllocation_T* VmaAllocation;
+typedef struct VmaPool_T* VmaPool;
+typedef struct VmaDefragmentationContext_T* VmaDefragmentationContext;
+struct VmaDefragmentationPassMoveInfo;
+typedef struct VmaVirtualBlock_T* VmaVirtualBlock;
+typedef struct VmaVirtualAllocation_T* VmaVirtualAllocation; // 64-bit non-dispatchable handle
 
 namespace Albedo {
 namespace RHI
 {
 	class VulkanContext;
 	class CommandBuffer;
+	class ComputePipeline;
 	class Sampler;
+	class UploadEngine;
+	class ReadbackEngine;
+	class SparseImage;
+	class ResidencyManager;
+	class AccelerationStructureBuilder;
+	class ResourceRegistry;
+	class RenderGraph;
+	class QueueTimeline;
+	class VideoEncoder;
+
+	// Native handles of exported memory & semaphores (VulkanContext::IsExternalMemorySupported()), owned by whoever holds them:
+	// Close them by CloseExternalHandle() or import them (A successful import consumes a file descriptor, NT handles stay open).
+#ifdef _WIN32
+	using ExternalHandle = void*; // HANDLE
+	constexpr VkExternalMemoryHandleTypeFlagBits ExternalMemoryHandleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+	constexpr VkExternalSemaphoreHandleTypeFlagBits ExternalSemaphoreHandleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+#else
+	using ExternalHandle = int; // File descriptor
+	constexpr VkExternalMemoryHandleTypeFlagBits ExternalMemoryHandleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+	constexpr VkExternalSemaphoreHandleTypeFlagBits ExternalSemaphoreHandleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+#endif
+	void CloseExternalHandle(ExternalHandle handle);
 
 	class VulkanMemoryAllocator : public std::enable_shared_from_this<VulkanMemoryAllocator>
 	{
 		friend class VulkanContext;
 		friend class Buffer;
 		friend class Image;
+		friend class RHI::SparseImage;
+		friend class RHI::ResidencyManager;
+		friend class RHI::VideoEncoder;
 	public:
+		class StagingRing;
+		class BufferSuballocator;
+
+		// Memory Pools: Each category allocates from its own blocks, so its fragmentation and budget stay isolated
+		enum class MemoryPool
+		{
+			GENERAL,				// Default VMA heap
+			FRAME,					// Linear ring: Per-frame uniform & scratch buffers (Released in allocation order)
+			STREAMING,			// Streaming textures & geometry (TLSF)
+			RENDER_TARGET,	// Attachments (Lazily allocated attachments stay in the default heap)
+			COUNT
+		};
+		// Memory Priorities (VK_EXT_memory_priority): When VRAM is oversubscribed the lowest priorities are moved to system memory first
+		enum class MemoryPriority
+		{
+			LOW,		// Streaming resources that can be requested again
+			NORMAL,	// Default of the general heap
+			HIGH		// Render targets & per-frame memory (Keep them resident)
+		};
+		static constexpr float GetMemoryPriorityValue(MemoryPriority priority)
+		{
+			switch (priority)
+			{
+			case MemoryPriority::LOW:	return 0.25f;
+			case MemoryPriority::HIGH:	return 1.0f;
+			default:								return 0.5f;
+			}
+		}
+		// Image Compression (VK_EXT_image_compression_control, see VulkanContext::IsImageCompressionControlSupported()): Drivers compress
+		// attachments losslessly by default. Fixed-rate compression is lossy with a guaranteed bandwidth saving, e.g. for intermediate targets.
+		struct ImageCompression
+		{
+			enum Mode
+			{
+				DEFAULT,		// Chosen by the driver
+				DISABLED,		// e.g. Images read as raw bytes by other devices
+				FIXED_RATE	// Lossy
+			};
+			Mode mode = DEFAULT;
+			uint32_t bits_per_component = 0; // FIXED_RATE: The lowest supported rate at or above it (Else the highest one), 0: Chosen by the driver
+
+			// Rate among the supported ones of the format (0 if there are none)
+			VkImageCompressionFixedRateFlagsEXT SelectFixedRate(VkImageCompressionFixedRateFlagsEXT supported) const;
+		};
+		// Image Types of AllocateImage(), depth_or_layers is the depth of IMAGE_3D and the array layers of the others (6 faces per cube)
+		enum class ImageType
+		{
+			IMAGE_2D,
+			IMAGE_2D_ARRAY,
+			IMAGE_CUBE,				// 6 layers
+			IMAGE_CUBE_ARRAY,	// 6 layers per cube
+			IMAGE_3D
+		};
+		struct MemoryPoolStatistics
+		{
+			VkDeviceSize block_bytes = 0;			// Allocated from Vulkan
+			VkDeviceSize allocation_bytes = 0;	// Used by resources
+			uint32_t allocation_count = 0;
+			VkDeviceSize budget = 0;					// block_size * max_block_count (0: Unlimited)
+		};
+
+		// Detailed Statistics (vmaCalculateStatistics(), walks every block: diagnostics only)
+		struct MemoryStatistics
+		{
+			struct Detail
+			{
+				uint32_t block_count = 0;
+				VkDeviceSize block_bytes = 0;			// Allocated from Vulkan
+				uint32_t allocation_count = 0;
+				VkDeviceSize allocation_bytes = 0;	// Used by resources
+				uint32_t unused_range_count = 0;
+				VkDeviceSize largest_unused_range = 0;
+				float fragmentation = 0.0f;				// 1 - largest unused range / unused bytes (0: All free memory is contiguous)
+			};
+			std::vector<Detail> heaps;				// Indexed by heap
+			std::vector<Detail> memory_types;	// Indexed by memory type
+			Detail total;
+		};
+
+		// Memory Budget (Per heap, refreshed by UpdateMemoryBudget())
+		struct MemoryHeapBudget
+		{
+			VkDeviceSize budget = 0;					// Available to this process (Decided by the OS)
+			VkDeviceSize usage = 0;					// Used by this process (Including swap chains, pipelines, etc.)
+			VkDeviceSize block_bytes = 0;			// Allocated by VMA
+			VkDeviceSize allocation_bytes = 0;	// Used by resources
+			bool device_local = false;
+			float GetPressure() const { return budget ? static_cast<float>(usage) / static_cast<float>(budget) : 0.0f; }
+		};
+		// Evict (release resources) inside the callback, it is called on the thread updating the budget
+		using MemoryPressureCallback = std::function<void(uint32_t heap_index, const MemoryHeapBudget& heap_budget)>;
+
 		// Buffer
 		class Buffer
 		{
 			friend class VulkanMemoryAllocator;
+			friend class StagingRing;
+			friend class BufferSuballocator;
+			friend class RHI::AccelerationStructureBuilder;
+			friend class RHI::ResourceRegistry;
 		public:
-			void		Write(void* data);	// The buffer must be mapping-allowed and writable
+			void		Write(const void* data);	// Size() bytes, the buffer must be mapping-allowed and writable
+			void		Write(std::span<const std::byte> data, VkDeviceSize offset = 0); // Copy and flush only this range
+			// Direct buffers (VMA::AllocateDirectBuffer()): Written in place if host-visible, otherwise by vkCmdUpdateBuffer on the GPU
+			// (Outside render passes, 4-byte aligned offset & size, tracked as a transfer write: TransitionCommand() to the consumer access).
+			void		WriteCommand(CommandBuffer& commandBuffer, std::span<const std::byte> data, VkDeviceSize offset = 0);
+			// Small updates (<= 64 KB, 4-byte aligned) are embedded in the command buffer by vkCmdUpdateBuffer, larger or unaligned ones
+			// are copied from the staging ring (e.g. FrameContext::GetStagingRing()) if given. No staging buffers or submits of their own.
+			void		UpdateCommand(CommandBuffer& commandBuffer, std::span<const std::byte> data, VkDeviceSize offset = 0, StagingRing* staging_ring = nullptr);
+			bool		IsHostVisible() const { return m_is_host_visible; }
 			void*	Access();				// If the buffer is persistently mapped, you can access its memory directly
+			// Non-coherent memory: Flush() after writing through Access(), Invalidate() before reading (No-op on coherent memory)
+			void		Flush(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+			void		Invalidate(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
 			void		Copy(std::shared_ptr<Buffer> destination, VkDeviceSize size = 0/*ALL*/, VkDeviceSize offset_src = 0, VkDeviceSize offset_dst = 0);
-			void		CopyCommand(std::shared_ptr<CommandBuffer> commandBuffer, std::shared_ptr<Buffer> destination, VkDeviceSize size = 0/*ALL*/, VkDeviceSize offset_src = 0, VkDeviceSize offset_dst = 0);
-			VkDeviceSize Size();
+			void		CopyCommand(CommandBuffer& commandBuffer, Buffer& destination, VkDeviceSize size = 0/*ALL*/, VkDeviceSize offset_src = 0, VkDeviceSize offset_dst = 0);
+			// Scatter / Gather: All regions in one vkCmdCopyBuffer, regions contiguous in both buffers are coalesced first
+			void		CopyCommand(CommandBuffer& commandBuffer, Buffer& destination, std::span<const VkBufferCopy> regions);
+			VkDeviceSize Size(); // Requested size (The allocation may be larger)
+			// GPU pointer of the buffer (Allocate it with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, changes if the buffer is moved)
+			VkDeviceAddress DeviceAddress();
+			void		SetDebugName(const char* name); // Also names the VMA allocation (Object name is a no-op without debug markers)
+			// Barriers against the last tracked accesses of the range (e.g. Storage Buffer writes -> Vertex Input)
+			void		TransitionCommand(CommandBuffer& commandBuffer, const ResourceAccess& access, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+			// Texel view for UNIFORM_TEXEL_BUFFER / STORAGE_TEXEL_BUFFER descriptors (Needs the texel buffer usage), created on first use
+			// and cached like Image::GetView() (Thread-safe, destroyed with the buffer, created again after a defragmentation move)
+			VkBufferView GetTexelView(VkFormat format, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+			// Let VMA::Defragment() move it (Needs TRANSFER_SRC & TRANSFER_DST usages). GPU writes after a move began are lost,
+			// so only opt in resources that are not written after their upload. on_moved rewrites descriptors of the new handle.
+			void		EnableDefragmentation(std::function<void(Buffer&)> on_moved = {});
 
 		public:
 			Buffer() = delete;
@@ -55,30 +217,135 @@ namespace RHI
 			std::shared_ptr<VulkanMemoryAllocator> m_parent;
 			VmaAllocation m_allocation = VK_NULL_HANDLE;
 			VkBuffer m_buffer = VK_NULL_HANDLE;
+			BufferStateTracker m_state_tracker;
+
+			VkDeviceSize m_buffer_size = 0; // Requested (The allocation may be larger)
+			VkBufferUsageFlags m_buffer_usage = 0;
+			VkSharingMode m_sharing_mode = VK_SHARING_MODE_EXCLUSIVE;
+			std::vector<uint32_t> m_queue_families; // Concurrent only
+			VkDeviceAddress m_device_address = 0; // Cached (0: Not queried yet)
+			bool m_is_host_visible = false; // Of the memory type (Direct buffers may fall back to device-only memory)
+			bool m_is_movable = false;
+			std::function<void(Buffer&)> m_on_moved;
+			VkExternalMemoryHandleTypeFlagBits m_export_handle_type{}; // AllocateExportableBuffer()
+			std::shared_ptr<VkDeviceMemory_T> m_imported_memory; // ImportBuffer() (m_allocation is VK_NULL_HANDLE)
+			std::shared_ptr<Buffer> m_peer_source; // BindPeerBuffer() (Ditto)
+			std::shared_ptr<VmaPool_T> m_batch_pool; // AllocateBuffers()
+			bool m_has_peers = false; // Never moved
+			struct TexelView
+			{
+				VkFormat format;
+				VkDeviceSize offset;
+				VkDeviceSize range;
+				VkBufferView view;
+			};
+			std::mutex m_view_mutex;
+			std::vector<TexelView> m_texel_views; // Few per buffer, searched linearly
 		};
 
 		// Image
 		class Image
 		{
 			friend class VulkanMemoryAllocator;
+			friend class RHI::UploadEngine;
+			friend class RHI::RenderGraph;
+			friend class RHI::ReadbackEngine;
+			friend class RHI::SparseImage;
+			friend class RHI::ResourceRegistry;
 		public:
-			void Write(std::shared_ptr<Buffer> data); // Write from Staging Buffer
-			void WriteCommand(std::shared_ptr<RHI::CommandBuffer> commandBuffer, std::shared_ptr<Buffer> data); // Write from Staging Buffer
-			void WriteAndTransition(std::shared_ptr<Buffer> data, VkImageLayout final_layout);
-			void WriteAndTransitionCommand(std::shared_ptr<RHI::CommandBuffer> commandBuffer, std::shared_ptr<Buffer> data, VkImageLayout final_layout);
+			// Write from Staging Buffer: Tightly packed texel blocks (GetFormatBlockInfo()) of the mip levels in order, each level holds all of its array layers
+			// (One VkBufferImageCopy per level in a single copy command, see GetDataSize()). Stream mips by writing the levels separately.
+			void Write(std::shared_ptr<Buffer> data, uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS);
+			void WriteCommand(RHI::CommandBuffer& commandBuffer, Buffer& data,
+				uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS);
+			// Arbitrary regions (e.g. tiles of an atlas or streamed array layers) in one vkCmdCopyBufferToImage, only the mip levels they touch are transitioned
+			void WriteCommand(RHI::CommandBuffer& commandBuffer, Buffer& data, std::span<const VkBufferImageCopy> regions);
+			void WriteAndTransition(std::shared_ptr<Buffer> data, VkImageLayout final_layout,
+				uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS);
+			void WriteAndTransitionCommand(RHI::CommandBuffer& commandBuffer, Buffer& data, VkImageLayout final_layout,
+				uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS); // Only these levels are transitioned
+			VkDeviceSize GetDataSize(uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS) const; // Bytes expected by Write()
+			// Host Image Copy (VulkanContext::IsHostImageCopySupported(), allocate it with VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT): vkCopyMemoryToImageEXT
+			// copies straight from host memory (Same layout as Write()), no staging buffer, command buffer or queue is involved.
+			// The image must be idle on the GPU, and different images can be written on different threads (e.g. streaming on the worker pool).
+			void WriteFromHost(std::span<const std::byte> data, VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS);
+			// One region of a mip level (Tightly packed texel blocks of the extent per layer)
+			void WriteFromHost(std::span<const std::byte> data, const VkImageSubresourceLayers& subresource, VkOffset3D offset, VkExtent3D extent,
+				VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			// Downsample mip 0 into the other levels with a vkCmdBlitImage chain (Needs TRANSFER_SRC usage and IsMipBlitSupported())
+			void GenerateMipsCommand(RHI::CommandBuffer& commandBuffer, VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			// Falls back to one dispatch per level if the format cannot be blitted with linear filtering (Needs STORAGE usage).
+			// Set 0 of the pipeline: binding 0 - source level, binding 1 - destination level (Storage images, 2D arrays unless 3D),
+			// push constant: uvec3 destination extent (z: layers or depth), dispatched with 8x8x1 work groups.
+			void GenerateMipsCommand(RHI::CommandBuffer& commandBuffer, RHI::ComputePipeline& downsample_pipeline,
+				VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			bool IsMipBlitSupported(); // Blit source & destination and linear filtering features of the format
 			void BindSampler(std::shared_ptr<RHI::Sampler> sampler);
 
 			void TransitionLayout(VkImageLayout target_layout);
-			void TransitionLayoutCommand(std::shared_ptr<RHI::CommandBuffer> commandBuffer, VkImageLayout target_layout);
+			void TransitionLayoutCommand(RHI::CommandBuffer& commandBuffer, VkImageLayout target_layout); // ResourceAccess::FromLayout()
+			// Barriers against the last tracked accesses of the subresources (e.g. one mip level while generating mipmaps)
+			void TransitionCommand(RHI::CommandBuffer& commandBuffer, const ResourceAccess& access,
+				uint32_t base_mip_level = 0, uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS,
+				uint32_t base_array_layer = 0, uint32_t array_layer_count = VK_REMAINING_ARRAY_LAYERS);
 
-			VkImageLayout GetImageLayout() { return m_image_layout; }
-			VkImageView GetImageView() { return m_image_view; }
+			VkImageLayout GetImageLayout() { return m_image_layout; } // Layout of the first subresource
+			// Views are created on first use and cached by the image (Destroyed with it, or replaced when it is moved by the defragmentation)
+			VkImageView GetImageView(); // Attachment view (Both aspects of depth stencil attachments)
+			VkImageView GetSampledImageView(); // One aspect (Depth of depth stencil formats)
+			struct ViewDesc
+			{
+				VkImageAspectFlags aspect = 0; // 0: Aspect of GetImageView()
+				uint32_t base_mip_level = 0;
+				uint32_t mip_level_count = VK_REMAINING_MIP_LEVELS;
+				uint32_t base_array_layer = 0;
+				uint32_t array_layer_count = VK_REMAINING_ARRAY_LAYERS;
+				VkFormat format = VK_FORMAT_UNDEFINED; // Format of the image (Others need an image created with VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT)
+				std::optional<ImageType> view_type; // Type of the image (e.g. IMAGE_2D_ARRAY for one face of a cube)
+				VkComponentMapping components{}; // Identity
+			};
+			// Subresource views, e.g. per-mip storage views for compute or the stencil aspect of a depth stencil image (Thread-safe)
+			VkImageView GetView(const ViewDesc& view_desc);
 			VkSampler GetImageSampler();
+			uint32_t GetBindlessIndex(); // Registered as a sampled image in the Bindless Heap on first call (Stable until destroyed or moved)
 			bool HasStencilComponent();
 			VkDeviceSize Size();
+			// The next transition starts from UNDEFINED after every access of the memory (First use of an aliased image per frame)
+			void DiscardContents();
 			uint32_t Width() const { return m_image_width; }
 			uint32_t Height() const { return m_image_height; }
 			uint32_t Channel() const { return m_image_channel; }
+			uint32_t Depth() const { return m_image_depth; } // 1 unless IMAGE_3D
+			uint32_t ArrayLayers() const { return m_array_layers; } // Including cube faces
+			uint32_t MipLevels() const { return m_mipmap_level; }
+			VkSampleCountFlagBits Samples() const { return m_sample_count; } // After clamping
+			ImageType Type() const { return m_image_type; }
+			void SetDebugName(const char* name); // Names the image, its view and its VMA allocation (Object names are a no-op without debug markers)
+			// Let VMA::Defragment() move it (Needs TRANSFER_SRC usage, see Buffer::EnableDefragmentation()).
+			// The image, its view and its bindless index change, query them again in on_moved.
+			void EnableDefragmentation(std::function<void(Image&)> on_moved = {});
+			// Dedicated allocations only (Large render targets): Re-prioritize the memory with VK_EXT_pageable_device_local_memory,
+			// e.g. lower the targets of a disabled effect. False if the priority is fixed at allocation.
+			bool SetMemoryPriority(MemoryPriority priority);
+			bool IsDedicated() const { return m_is_dedicated; }
+			// Compression granted by the driver (AllocateImage() with an ImageCompression other than DEFAULT, otherwise DEFAULT & 0)
+			VkImageCompressionFlagsEXT CompressionFlags() const { return m_compression_flags; }
+			VkImageCompressionFixedRateFlagsEXT CompressionFixedRate() const { return m_compression_fixed_rate; }
+			// Host-readable images (VMA::AllocateHostReadableImage()): The texel block rows of the mapped memory, row_pitch bytes apart
+			struct HostView
+			{
+				const std::byte* data = nullptr;
+				VkDeviceSize row_pitch = 0;
+				VkDeviceSize row_size = 0; // Texel blocks of one row (Without the padding up to row_pitch)
+				VkDeviceSize size = 0;
+				VkExtent2D extent{ 0, 0 };
+				std::span<const std::byte> Row(uint32_t row) const { return { data + row * row_pitch, static_cast<size_t>(row_size) }; }
+			};
+			// Record it after the last GPU write: Transitions the image to GENERAL and makes the writes available to the host
+			void HostReadBarrierCommand(RHI::CommandBuffer& commandBuffer);
+			HostView MapHostView(); // After the fence of the barrier above has signaled (Invalidates non-coherent memory)
+			bool IsHostReadable() const { return m_host_data != nullptr; }
 
 		public:
 			Image() = delete;
@@ -90,8 +357,13 @@ namespace RHI
 			std::shared_ptr<VulkanMemoryAllocator> m_parent;
 			VmaAllocation m_allocation = VK_NULL_HANDLE;
 			VkImage m_image = VK_NULL_HANDLE;
-			VkImageView m_image_view = VK_NULL_HANDLE;
+			std::atomic<VkImageView> m_image_view{ VK_NULL_HANDLE }; // Cached GetView() results (Null until first use)
+			std::atomic<VkImageView> m_sampled_view{ VK_NULL_HANDLE };
+			std::mutex m_view_mutex;
+			std::vector<std::pair<ViewDesc, VkImageView>> m_views; // Few per image, searched linearly
+			std::string m_debug_name; // Also given to the views created later
 			std::shared_ptr<RHI::Sampler> m_image_sampler;
+			std::optional<uint32_t> m_bindless_index;
 
 			VkImageLayout m_image_layout = VK_IMAGE_LAYOUT_UNDEFINED;
 			VkFormat m_image_format;
@@ -99,22 +371,307 @@ namespace RHI
 			uint32_t m_image_height;
 			uint32_t m_image_channel;
 			uint32_t m_mipmap_level;
+			uint32_t m_image_depth = 1;
+			uint32_t m_array_layers = 1;
+			ImageType m_image_type = ImageType::IMAGE_2D;
+			ImageStateTracker m_state_tracker;
+
+			std::shared_ptr<VmaAllocation_T> m_aliased_heap; // AllocateAliasedImages() (m_allocation is VK_NULL_HANDLE)
+			std::shared_ptr<VkDeviceMemory_T> m_imported_memory; // ImportImage() (Ditto)
+			std::shared_ptr<VmaPool_T> m_batch_pool; // AllocateImages()
+			VkDeviceSize m_aliased_size = 0; // Size() of both
+			VkExternalMemoryHandleTypeFlagBits m_export_handle_type{}; // AllocateExportableImage()
+
+			VkImageUsageFlags m_image_usage = 0;
+			VkImageTiling m_image_tiling = VK_IMAGE_TILING_OPTIMAL;
+			VkSampleCountFlagBits m_sample_count = VK_SAMPLE_COUNT_1_BIT;
+			VkImageAspectFlags m_view_aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			VkImageAspectFlags m_sampled_aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			bool m_is_dedicated = false; // Own VkDeviceMemory (Never moved by the defragmentation)
+			bool m_is_movable = false;
+			VkImageCompressionFlagsEXT m_compression_request = VK_IMAGE_COMPRESSION_DEFAULT_EXT; // Chained again by moves
+			VkImageCompressionFixedRateFlagsEXT m_compression_fixed_rate_request = 0; // FIXED_RATE_EXPLICIT
+			VkImageCompressionFlagsEXT m_compression_flags = VK_IMAGE_COMPRESSION_DEFAULT_EXT;
+			VkImageCompressionFixedRateFlagsEXT m_compression_fixed_rate = 0;
+			std::byte* m_host_data = nullptr; // AllocateHostReadableImage() (Persistently mapped, never moved)
+			VkSubresourceLayout m_host_layout{};
+			std::function<void(Image&)> m_on_moved;
+
+		private:
+			void assume_access(const ResourceAccess& access); // Synchronized by the caller
+			uint32_t resolve_mip_level_count(uint32_t base_mip_level, uint32_t mip_level_count) const;
+			// Host transitions & copy (Fully overwritten subresources are transitioned from UNDEFINED)
+			void copy_from_host(const std::vector<VkMemoryToImageCopyEXT>& regions, const VkImageSubresourceRange& range,
+				bool is_overwritten, VkImageLayout final_layout);
+			// Regions of GetDataSize() layout starting at buffer_offset
+			std::vector<VkBufferImageCopy> make_copy_regions(VkDeviceSize buffer_offset, uint32_t base_mip_level, uint32_t mip_level_count) const;
+			// Bands of whole block rows of GetDataSize() layout, at most max_band_size bytes each unless a single row is larger
+			// (Small mip levels & slices share a band). Regions are relative to the band and aligned to get_copy_alignment().
+			struct CopyBand
+			{
+				VkDeviceSize data_offset = 0; // In GetDataSize() layout
+				VkDeviceSize size = 0;
+				std::vector<VkBufferImageCopy> regions;
+			};
+			std::vector<CopyBand> make_copy_bands(VkDeviceSize max_band_size) const;
+			VkExtent3D get_mip_extent(uint32_t mip_level) const;
+			FormatBlockInfo get_block_info() const; // Unknown formats are treated as 4-byte texels
+			VkDeviceSize get_copy_alignment() const; // bufferOffset of the copies: Multiple of the block size and 4
+		};
+
+		// Staging Ring (Persistently mapped & frame-partitioned upload memory, also bindable as a storage buffer for GPU scatter uploads)
+		class StagingRing
+		{
+		public:
+			struct Allocation
+			{
+				VkBuffer			buffer = VK_NULL_HANDLE;
+				VkDeviceSize	offset = 0; // Use it as srcOffset / bufferOffset
+				VkDeviceSize	size = 0;
+				void*				data = nullptr; // Mapped memory of this sub-allocation
+			};
+			// Aligned to optimalBufferCopyOffsetAlignment (and the given alignment, e.g. texel size). Thread-safe.
+			Allocation	Allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+			void			Flush(const Allocation& allocation); // Needed for non-coherent memory only
+			// Call after the fence of this frame signaled, the allocations of its last use will be reclaimed
+			void			BeginFrame(uint32_t frame_index);
+
+			VkDeviceSize GetFrameCapacity() const { return m_frame_capacity; }
+			VkDeviceSize GetFrameAvailable(); // Bytes left in the current frame partition (Before alignment)
+			uint32_t GetFrameIndex() const { return m_frame_index; }
+
+		public:
+			StagingRing() = delete;
+			StagingRing(std::shared_ptr<VulkanMemoryAllocator> parent, VkDeviceSize frame_capacity, uint32_t frames_in_flight);
+
+		private:
+			std::shared_ptr<VulkanMemoryAllocator> m_parent;
+			std::shared_ptr<Buffer> m_buffer;
+			uint8_t* m_mapped_data = nullptr;
+			VkDeviceSize m_frame_capacity;
+			VkDeviceSize m_copy_alignment;
+
+			std::mutex m_mutex;
+			uint32_t m_frame_index = 0;
+			VkDeviceSize m_frame_offset = 0; // Offset inside the current frame partition
+			std::vector<std::vector<std::shared_ptr<Buffer>>> m_overflow_buffers; // Oversized uploads per frame
+		};
+
+		// Packs small uniform / storage blocks into large persistently mapped buffers (pages), one VmaVirtualBlock per page.
+		// Slices are aligned to min(Uniform|Storage)BufferOffsetAlignment, so a page can be bound once as a *_DYNAMIC descriptor
+		// with range = slice size and every slice of that size selected by its dynamic offset (No descriptor updates per draw).
+		class BufferSuballocator : public std::enable_shared_from_this<BufferSuballocator>
+		{
+		public:
+			class Slice
+			{
+				friend class BufferSuballocator;
+			public:
+				void		Write(const void* data, VkDeviceSize size = 0/*ALL*/, VkDeviceSize offset = 0); // Flushed for non-coherent memory
+				void*	Access() { return m_data; } // Call Flush() after writing non-coherent memory
+				void		Flush();
+
+				VkBuffer			GetBuffer() const { return m_page->m_buffer; }
+				VkDeviceSize	GetOffset() const { return m_offset; } // Offset of the descriptor (non-dynamic)
+				VkDeviceSize	GetSize() const { return m_size; } // Range of the descriptor
+				uint32_t			GetDynamicOffset() const { return static_cast<uint32_t>(m_offset); } // Descriptor written with offset 0
+				uint32_t			GetPageIndex() const { return m_page_index; } // Slices of one page share a dynamic descriptor
+				VkDeviceAddress	GetDeviceAddress() const { return m_page->DeviceAddress() + m_offset; } // Suballocator usage with SHADER_DEVICE_ADDRESS_BIT
+
+			public:
+				Slice() = delete;
+				Slice(std::shared_ptr<BufferSuballocator> parent) : m_parent{ std::move(parent) } {};
+				~Slice(); // Released after the frames in flight
+				Slice(const Slice&) = delete;
+
+			private:
+				std::shared_ptr<BufferSuballocator> m_parent;
+				VmaVirtualAllocation m_allocation = VK_NULL_HANDLE;
+				uint32_t			m_page_index = 0;
+				std::shared_ptr<Buffer> m_page;
+				VkDeviceSize	m_offset = 0;
+				VkDeviceSize	m_size = 0;
+				uint8_t*			m_data = nullptr;
+			};
+
+			std::shared_ptr<Slice> Allocate(VkDeviceSize size); // Thread-safe, oversized slices get a page of their own
+			VkDeviceSize GetAlignment() const { return m_alignment; }
+			VkDeviceSize GetPageSize() const { return m_page_size; }
+			size_t GetPageCount();
 
 		public:
-			VkImageMemoryBarrier deduce_transition_layout_barrier(VkImageLayout target_layout, VkPipelineStageFlags& stage_src, VkPipelineStageFlags& stage_dst);
+			BufferSuballocator() = delete;
+			BufferSuballocator(std::shared_ptr<VulkanMemoryAllocator> parent, VkBufferUsageFlags usage, VkDeviceSize page_size);
+			~BufferSuballocator();
+			BufferSuballocator(const BufferSuballocator&) = delete;
+
+		private:
+			void release(uint32_t page_index, VmaVirtualAllocation allocation);
+
+		private:
+			std::shared_ptr<VulkanMemoryAllocator> m_parent;
+			const VkBufferUsageFlags m_usage;
+			const VkDeviceSize m_page_size;
+			VkDeviceSize m_alignment;
+
+			struct Page
+			{
+				std::shared_ptr<Buffer> buffer;
+				VmaVirtualBlock block = VK_NULL_HANDLE;
+				uint8_t* data = nullptr;
+			};
+			std::mutex m_mutex;
+			std::vector<Page> m_pages;
+		};
+
+		// Render target alive from first_use to last_use (e.g. pass indices of a frame)
+		struct TransientImageInfo
+		{
+			VkImageAspectFlags	aspect;
+			VkImageUsageFlags		usage;
+			uint32_t					width;
+			uint32_t					height;
+			uint32_t					channel;
+			VkFormat					format;
+			uint32_t					first_use;
+			uint32_t					last_use;
+		};
+
+		// Resources of AllocateBuffers() & AllocateImages(), the arguments of AllocateBuffer() & AllocateImage()
+		struct BufferDesc
+		{
+			size_t						size;
+			VkBufferUsageFlags		usage;
+			bool							is_exclusive = true;
+			bool							is_writable = false;
+			bool							is_readable = false;
+			bool							is_persistent = false;
+		};
+		struct ImageDesc
+		{
+			VkImageAspectFlags	aspect;
+			VkImageUsageFlags		usage;
+			uint32_t					width;
+			uint32_t					height;
+			uint32_t					channel;
+			VkFormat					format;
+			VkImageTiling				tiling_mode = VK_IMAGE_TILING_OPTIMAL;
+			uint32_t					miplevel = 1; // 0: Full mip chain
+			ImageType					image_type = ImageType::IMAGE_2D;
+			uint32_t					depth_or_layers = 1;
 		};
 
 	public:
+		// VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT opts in Buffer::DeviceAddress() (Needs VulkanContext::IsBufferDeviceAddressSupported())
 		std::shared_ptr<Buffer> AllocateBuffer(size_t size, VkBufferUsageFlags usage, 
-			bool is_exclusive = true, bool is_writable = false, bool is_readable = false, bool is_persistent = false);
+			bool is_exclusive = true, bool is_writable = false, bool is_readable = false, bool is_persistent = false, // Host accessible buffers are always persistently mapped
+			MemoryPool memory_pool = MemoryPool::GENERAL);
+		// Device-local buffer written by the host in place through a Resizable BAR (Smart Access Memory) heap, so per-frame vertex & uniform
+		// streams skip the staging copy. With the legacy 256 MiB BAR, or once the large one is exhausted, it is device-only memory written
+		// by Buffer::WriteCommand() on the GPU instead (TRANSFER_DST is added to the usage).
+		std::shared_ptr<Buffer> AllocateDirectBuffer(size_t size, VkBufferUsageFlags usage, MemoryPool memory_pool = MemoryPool::GENERAL);
+		bool IsResizableBarEnabled() const { return m_resizable_bar_heap.has_value(); } // DEVICE_LOCAL | HOST_VISIBLE heap beyond 256 MiB
 		std::shared_ptr<Image> AllocateImage(	VkImageAspectFlags aspect,
 																				VkImageUsageFlags usage,
 																				uint32_t width, uint32_t height, 
 																				uint32_t channel, VkFormat format,
 																				VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED,
 																				VkImageTiling tiling_mode = VK_IMAGE_TILING_OPTIMAL,
-																				uint32_t miplevel = 1);
+																				uint32_t miplevel = 1, // 0: Full mip chain
+																				MemoryPool memory_pool = MemoryPool::GENERAL, // VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT: Lazily allocated memory on tile-based GPUs
+																				ImageType image_type = ImageType::IMAGE_2D,
+																				uint32_t depth_or_layers = 1, // IMAGE_CUBE: Always 6
+																				VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT, // Clamped by VulkanContext::ClampSampleCount()
+																				ImageCompression compression = {}); // Capped by the format (Ignored without VulkanContext::IsImageCompressionControlSupported())
+		// Batches (e.g. the resources of a level): The handles are created on the worker pool, then each memory type reserves one pool
+		// block sized for the whole batch, so VMA allocates device memory once instead of growing its heap resource by resource.
+		// The block is released with the last resource of the batch. Batch resources are never dedicated, never moved by Defragment(),
+		// images are left in VK_IMAGE_LAYOUT_UNDEFINED and cannot be transient attachments.
+		std::vector<std::shared_ptr<Buffer>> AllocateBuffers(std::span<const BufferDesc> buffer_descs);
+		std::vector<std::shared_ptr<Image>> AllocateImages(std::span<const ImageDesc> image_descs);
+		// MSAA attachment resolved inside the render pass: Transient and lazily allocated unless usage needs more than attachment access,
+		// so tile-based GPUs keep the samples in tile memory and only write the resolved image (Store DONT_CARE, see DynamicRenderPass).
+		std::shared_ptr<Image> AllocateMultisampledAttachment(VkImageAspectFlags aspect, VkImageUsageFlags usage,
+																				uint32_t width, uint32_t height, VkFormat format, VkSampleCountFlagBits samples,
+																				MemoryPool memory_pool = MemoryPool::RENDER_TARGET);
+		// Sparse Residency: Created without memory (VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT), bind its pages via RHI::ResidencyManager
+		std::shared_ptr<Image> AllocateSparseImage(VkImageAspectFlags aspect, VkImageUsageFlags usage,
+																				uint32_t width, uint32_t height, uint32_t channel, VkFormat format,
+																				uint32_t miplevel = 0, ImageType image_type = ImageType::IMAGE_2D, uint32_t depth_or_layers = 1);
+		// Budget = block_size * max_block_count (0: Unlimited), allocations beyond it throw. Call it before the first allocation of the pool.
+		// The FRAME ring is a single linear block, so its max_block_count is always 1.
+		void ConfigureMemoryPool(MemoryPool memory_pool, VkDeviceSize block_size, size_t max_block_count = 0);
+		// Priority of the blocks of the pool (Defaults: GENERAL - NORMAL, STREAMING - LOW, FRAME & RENDER_TARGET - HIGH), call it before the first allocation.
+		// Attachments of the general heap are always HIGH, and render targets of at least the swap chain size or 16 MiB get dedicated allocations.
+		void ConfigureMemoryPriority(MemoryPool memory_pool, MemoryPriority priority);
+		MemoryPoolStatistics GetMemoryPoolStatistics(MemoryPool memory_pool); // Summed over memory types
+		MemoryStatistics GetStatistics();
+		// vmaBuildStatsString() JSON (Open it with GpuMemDumpVis.py), allocations are listed with their debug names
+		void DumpJson(std::string_view path, bool detailed = true);
+		// Called once per frame (FrameContext::BeginFrame()), fires the pressure callbacks of heaps above their thresholds
+		void UpdateMemoryBudget();
+		std::vector<MemoryHeapBudget> GetMemoryBudgets(); // Indexed by heap
+		bool IsMemoryBudgetTracked() const { return m_memory_budget_tracked; } // False: Budgets are estimated (80% of the heaps)
+		// Called every update while usage / budget >= pressure_threshold, returns the id to unregister
+		uint64_t RegisterMemoryPressureCallback(MemoryPressureCallback callback, float pressure_threshold = 0.9f, bool device_local_only = true);
+		void UnregisterMemoryPressureCallback(uint64_t callback_id);
+		// Give memory back to the system (e.g. While the swap chain is suspended): Fires every pressure callback regardless of its threshold,
+		// waits the device idle for their deferred deletions and destroys the empty pools (Recreated by their next allocation).
+		// Not concurrently with allocations, returns the released block bytes of the pools.
+		VkDeviceSize TrimMemory();
+		// Defragmentation (Default heap): Each pass moves up to budget_per_frame bytes of movable resources. Its copies are submitted
+		// to the graphics queue, the handles are patched once they completed, and the old memory is released after the frames in flight.
+		// Call it once per frame outside of recording (e.g. after FrameContext::EndFrame()) until it returns false.
+		struct DefragmentationStatistics
+		{
+			VkDeviceSize bytes_moved = 0;
+			uint32_t allocations_moved = 0;
+			uint32_t passes = 0;
+		};
+		bool Defragment(VkDeviceSize budget_per_frame = 16 * 1024 * 1024); // True while in progress
+		bool IsDefragmenting() const { return m_defragmentation.context != VK_NULL_HANDLE; }
+		const DefragmentationStatistics& GetDefragmentationStatistics() const { return m_defragmentation.statistics; } // Since the last start
+		// Images with disjoint lifetimes share one allocation, call DiscardContents() before the first use of each one every frame
+		std::vector<std::shared_ptr<Image>> AllocateAliasedImages(const std::vector<TransientImageInfo>& image_infos);
+		bool IsLazilyAllocatedMemorySupported() const { return m_lazily_allocated_memory_types != 0; }
 		std::shared_ptr<Buffer> AllocateStagingBuffer(VkDeviceSize buffer_size);
+		// Zero-copy readback (e.g. Headless rendering): 2D color image with linear tiling in persistently mapped host-visible memory (Host-cached
+		// if available), read through Image::MapHostView() after the fence instead of copying it into a readback buffer. Linear images support
+		// few formats & usages and render slower than optimal ones on most GPUs, check IsHostReadableImageSupported() first.
+		std::shared_ptr<Image> AllocateHostReadableImage(VkImageUsageFlags usage, uint32_t width, uint32_t height, uint32_t channel, VkFormat format);
+		bool IsHostReadableImageSupported(VkFormat format, VkImageUsageFlags usage, uint32_t width, uint32_t height);
+		// Vulkan Video (VulkanContext::IsVideoEncodeSupported()): Resources of a video session are created with its profiles.
+		// Images have no implicit TRANSFER_DST usage, flags are e.g. MUTABLE_FORMAT | EXTENDED_USAGE for per-plane storage views.
+		std::shared_ptr<Image> AllocateVideoImage(VkImageUsageFlags usage, uint32_t width, uint32_t height, VkFormat format,
+			const VkVideoProfileListInfoKHR& profile_list, VkImageCreateFlags flags = 0, uint32_t array_layers = 1);
+		std::shared_ptr<Buffer> AllocateVideoBuffer(size_t size, VkBufferUsageFlags usage, const VkVideoProfileListInfoKHR& profile_list,
+			bool is_readable = false); // Readable: Persistently mapped host-cached memory (e.g. encoded bitstreams)
+		// External Memory (VulkanContext::IsExternalMemorySupported()): Exportable resources come from dedicated pools of their handle type
+		// (VkExportMemoryAllocateInfo) and own their VkDeviceMemory, so an exported handle exposes nothing else. The importing process
+		// recreates the resource with the same parameters. Images are optimal opaque handles (DMA_BUF is for buffers, no DRM modifiers).
+		struct ExternalMemory
+		{
+			ExternalHandle handle;
+			VkExternalMemoryHandleTypeFlagBits handle_type;
+			VkDeviceSize size; // Of the VkDeviceMemory
+		};
+		std::shared_ptr<Buffer> AllocateExportableBuffer(size_t size, VkBufferUsageFlags usage,
+			VkExternalMemoryHandleTypeFlagBits handle_type = ExternalMemoryHandleType); // Device-local
+		std::shared_ptr<Image> AllocateExportableImage(VkImageAspectFlags aspect, VkImageUsageFlags usage, uint32_t width, uint32_t height,
+			uint32_t channel, VkFormat format); // 2D, one mip level
+		ExternalMemory ExportMemory(Buffer& buffer); // A new handle per call (Owned by the caller)
+		ExternalMemory ExportMemory(Image& image);
+		// Import the memory of a resource exported by another process (Not exportable again, no defragmentation or host access)
+		std::shared_ptr<Buffer> ImportBuffer(const ExternalMemory& memory, size_t size, VkBufferUsageFlags usage);
+		std::shared_ptr<Image> ImportImage(const ExternalMemory& memory, VkImageAspectFlags aspect, VkImageUsageFlags usage,
+			uint32_t width, uint32_t height, uint32_t channel, VkFormat format);
+		// Device Groups (VulkanContext::GetDeviceCount() > 1): Another buffer on the memory of buffer, whose device i accesses the memory
+		// instance of device_indices[i] (One per device), e.g. device 1 copies its band of a split frame into the instance of device 0.
+		// Check VulkanContext::GetPeerMemoryFeatures() of the heap first. The buffer is kept alive and can no longer be defragmented.
+		std::shared_ptr<Buffer> BindPeerBuffer(std::shared_ptr<Buffer> buffer, std::span<const uint32_t> device_indices);
+		std::shared_ptr<StagingRing> CreateStagingRing(VkDeviceSize frame_capacity, uint32_t frames_in_flight); // Prefer it to AllocateStagingBuffer() for streaming
+		// Usage: VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT and/or VK_BUFFER_USAGE_STORAGE_BUFFER_BIT (Host writable pages)
+		std::shared_ptr<BufferSuballocator> CreateBufferSuballocator(VkBufferUsageFlags usage, VkDeviceSize page_size = 4 * 1024 * 1024);
 
 		~VulkanMemoryAllocator();
 
@@ -127,9 +684,101 @@ namespace RHI
 		}
 		VulkanMemoryAllocator(std::shared_ptr<VulkanContext> vulkan_context);
 
+		std::shared_ptr<Buffer> allocate_buffer(size_t size, VkBufferUsageFlags usage, bool is_exclusive,
+			VkFlags allocation_flags /*VmaAllocationCreateFlags*/, MemoryPool memory_pool,
+			const void* p_next = nullptr); // Shared by AllocateBuffer(), AllocateDirectBuffer() & AllocateVideoBuffer()
+		void setup_image(Image& image, VkImageAspectFlags aspect, VkImageUsageFlags usage, uint32_t width, uint32_t height,
+			uint32_t channel, VkFormat format, uint32_t miplevel,
+			ImageType image_type = ImageType::IMAGE_2D, uint32_t depth = 1, uint32_t array_layers = 1); // Members & state tracker of a bound image (Views are lazy)
+		VmaPool get_memory_pool(MemoryPool memory_pool, uint32_t memory_type_index); // Created on first use
+		// AllocateImage(): Flags & explicit fixed rate of the request capped by the format (DEFAULT if the format has no fixed rates)
+		std::pair<VkImageCompressionFlagsEXT, VkImageCompressionFixedRateFlagsEXT> resolve_image_compression(const ImageCompression& compression,
+			const VkImageCreateInfo& image_create_info) const;
+		void query_image_compression(Image& image); // Granted compression of a created image
+		// AllocateBuffers() & AllocateImages(): Reserves one pool block per memory type and allocates the resources from it (Unbound)
+		template<typename Resource>
+		VkDeviceSize allocate_batch(std::span<const std::shared_ptr<Resource>> resources, std::span<const VkMemoryRequirements> requirements,
+			std::span<const uint32_t> memory_types, std::span<const VkFlags /*VmaAllocationCreateFlags*/> allocation_flags);
+		VmaPool get_exportable_pool(VkExternalMemoryHandleTypeFlagBits handle_type, uint32_t memory_type_index); // Ditto
+		ExternalMemory export_memory(VmaAllocation allocation, VkExternalMemoryHandleTypeFlagBits handle_type);
+		std::shared_ptr<VkDeviceMemory_T> import_memory(const ExternalMemory& memory, const VkMemoryRequirements& requirements,
+			VkBuffer buffer, VkImage image); // Dedicated to the resource
+		VkImageView create_image_view(VkImage image, VkFormat format, VkImageAspectFlags aspect,
+			ImageType image_type = ImageType::IMAGE_2D, uint32_t mip_levels = 1, uint32_t array_layers = 1, uint32_t base_mip_level = 0,
+			uint32_t base_array_layer = 0, VkComponentMapping components = {});
+		// Defragmentation
+		bool release_movable(VmaAllocation allocation); // True if the allocation is being copied (Free the handles only)
+		void begin_defragmentation_pass();
+		void patch_defragmentation_pass();
+		void end_defragmentation_pass(); // Deferred after the old handles
+		void cancel_defragmentation();
+
 	private:
 		std::shared_ptr<VulkanContext> m_context;
 		VmaAllocator m_allocator = VK_NULL_HANDLE;
+		uint32_t m_lazily_allocated_memory_types = 0; // Memory type bits
+		std::optional<uint32_t> m_resizable_bar_heap; // Largest DEVICE_LOCAL heap with HOST_VISIBLE memory types beyond the legacy BAR window
+		bool m_memory_budget_tracked = false;
+		uint32_t m_frame_number = 0; // vmaSetCurrentFrameIndex() refreshes the budget
+
+		struct MemoryPressureHandler
+		{
+			uint64_t id;
+			MemoryPressureCallback callback;
+			float pressure_threshold;
+			bool device_local_only;
+		};
+		struct DefragmentationMove
+		{
+			uint32_t move_index; // In the pass
+			Buffer* buffer = nullptr;
+			Image* image = nullptr;
+			VkBuffer new_buffer = VK_NULL_HANDLE;
+			VkImage new_image = VK_NULL_HANDLE;
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED; // Of the new image
+			bool is_abandoned = false; // Destroyed while being copied
+		};
+		enum class DefragmentationState { IDLE, READY, COPYING, RETIRING };
+		struct Defragmentation
+		{
+			VmaDefragmentationContext context = VK_NULL_HANDLE;
+			DefragmentationState state = DefragmentationState::IDLE;
+			VkDeviceSize budget = 0;
+			std::unique_ptr<VmaDefragmentationPassMoveInfo> pass;
+			std::vector<DefragmentationMove> moves;
+			QueueTimeline* timeline = nullptr; // Of the copies (Owned by the context)
+			uint64_t tick = 0;
+			DefragmentationStatistics statistics;
+		};
+		std::mutex m_defragmentation_mutex; // Guards the movable resources and the moves against destructions on other threads
+		std::unordered_map<VmaAllocation, std::pair<Buffer*, Image*>> m_movable_resources;
+		Defragmentation m_defragmentation; // Render thread
+
+		std::mutex m_memory_pressure_mutex;
+		std::vector<MemoryPressureHandler> m_memory_pressure_handlers;
+		uint64_t m_next_memory_pressure_handler_id = 1;
+
+		struct MemoryPoolConfig
+		{
+			VkDeviceSize block_size;
+			size_t max_block_count; // 0: Unlimited
+			MemoryPriority priority;
+		};
+		std::mutex m_memory_pool_mutex;
+		std::array<MemoryPoolConfig, static_cast<size_t>(MemoryPool::COUNT)> m_memory_pool_configs
+		{{
+			{ 0, 0, MemoryPriority::NORMAL },										// GENERAL (Priority of the allocations only)
+			{ 64ull * 1024 * 1024, 1, MemoryPriority::HIGH },				// FRAME
+			{ 128ull * 1024 * 1024, 0, MemoryPriority::LOW },				// STREAMING
+			{ 256ull * 1024 * 1024, 0, MemoryPriority::HIGH },				// RENDER_TARGET
+		}};
+		std::unordered_map<uint64_t, VmaPool> m_memory_pools; // (MemoryPool << 32 | Memory Type Index)
+		struct ExportablePool
+		{
+			VmaPool pool = VK_NULL_HANDLE;
+			std::unique_ptr<VkExportMemoryAllocateInfo> export_info; // pMemoryAllocateNext (Must outlive the pool)
+		};
+		std::unordered_map<uint64_t, ExportablePool> m_exportable_pools; // (Handle Type << 32 | Memory Type Index)
 	};
 	using VMA = VulkanMemoryAllocator;
 
@@ -0,0 +1,101 @@
+#include "vulkan_pacing.h"
+#include "vulkan_context.h"
+
+#include <cmath>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		double to_milliseconds(FramePacer::Clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+	} // namespace
+
+	FramePacer::FramePacer(VulkanContext* vulkan_context, uint32_t max_queued_frames/* = 1*/, double safety_margin/* = 1.0*/) :
+		m_context{ vulkan_context },
+		m_max_queued_frames{ max_queued_frames },
+		m_safety_margin{ safety_margin },
+		m_swapchain_generation{ vulkan_context->m_swapchain_generation }
+	{
+		assert(max_queued_frames > 0 && max_queued_frames < MAX_TRACKED_FRAMES && "Invalid count of queued frames!");
+		m_wait_for_present = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(m_context->m_device, "vkWaitForPresentKHR");
+		if (!m_wait_for_present)
+			throw std::runtime_error("Failed to create the Frame Pacer - vkWaitForPresentKHR is not available!");
+		m_next_begin = Clock::now();
+	}
+
+	uint64_t FramePacer::OnPresent()
+	{
+		uint64_t presentId = ++m_last_present_id;
+		timing(presentId) = FrameTiming
+		{
+			.present_id = presentId,
+			.begin = m_next_begin,
+			.present = Clock::now()
+		};
+		return presentId;
+	}
+
+	void FramePacer::Pace()
+	{
+		if (m_swapchain_generation != m_context->m_swapchain_generation)
+		{
+			// Ids presented to a retired swap chain will never complete on the new one
+			m_swapchain_generation = m_context->m_swapchain_generation;
+			m_first_present_id = m_last_present_id + 1;
+			m_last_displayed_id = m_last_present_id;
+		}
+
+		// Keep at most m_max_queued_frames presented but not displayed
+		if (m_last_present_id + 1 >= m_first_present_id + m_max_queued_frames)
+		{
+			uint64_t waitId = m_last_present_id + 1 - m_max_queued_frames;
+			if (waitId > m_last_displayed_id)
+			{
+				constexpr uint64_t TIMEOUT = 100'000'000; // 100ms (Hidden windows may never display)
+				auto result = m_wait_for_present(m_context->m_device, m_context->m_swapchain, waitId, TIMEOUT);
+				if (result == VK_SUCCESS) on_displayed(waitId, Clock::now());
+				// VK_TIMEOUT or VK_ERROR_OUT_OF_DATE_KHR: The acquisition reports the recreation
+			}
+		}
+
+		if (m_input_delay > 0.0)
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(m_input_delay));
+		m_next_begin = Clock::now();
+	}
+
+	void FramePacer::on_displayed(uint64_t present_id, Clock::time_point display_time)
+	{
+		constexpr double SMOOTHING = 0.1;
+		auto& frameTiming = timing(present_id);
+		if (frameTiming.present_id != present_id) return; // Overwritten
+
+		if (m_last_displayed_id >= m_first_present_id) // Both were displayed by the current swap chain
+		{
+			double interval = to_milliseconds(display_time - m_last_display_time) / static_cast<double>(present_id - m_last_displayed_id);
+			if (m_display_interval > 0.0 && interval > 1.5 * m_display_interval)
+			{
+				// Missed the vblank (The slack also hides the GPU time of the frame), back off quickly
+				++m_missed_frame_count;
+				m_input_delay *= 0.5;
+			}
+			else
+			{
+				m_display_interval = (m_display_interval > 0.0) ? std::lerp(m_display_interval, interval, SMOOTHING) : interval;
+				// Time the frame waited for its vblank after the present, spend it on sampling input later
+				double slack = to_milliseconds(display_time - frameTiming.present);
+				m_input_delay = std::clamp(m_input_delay + 0.5 * (slack - m_safety_margin),
+					0.0, std::max(0.0, m_display_interval - m_safety_margin));
+			}
+		}
+
+		double latency = to_milliseconds(display_time - frameTiming.begin);
+		m_frame_latency = (m_frame_latency > 0.0) ? std::lerp(m_frame_latency, latency, SMOOTHING) : latency;
+		m_last_displayed_id = present_id;
+		m_last_display_time = display_time;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <chrono>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Frame Pacing (VK_KHR_present_id & VK_KHR_present_wait)
+	// Presents are tagged with increasing ids, and the next acquisition waits for the display of the previous frames
+	// and is then delayed by the measured slack, so the CPU samples input as late as possible without missing the vblank.
+	class FramePacer
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		uint64_t	OnPresent(); // Called by PresentSwapChain(), return the present id
+		void			Pace();			// Called by NextSwapChainImageIndex()
+
+		// Statistics (Milliseconds, exponential moving averages)
+		double GetDisplayInterval() const	{ return m_display_interval; }	// Between two displayed frames
+		double GetFrameLatency() const		{ return m_frame_latency; }		// From Pace() returning to the frame being displayed
+		double GetInputDelay() const			{ return m_input_delay; }			// Current delay before the acquisition
+		uint64_t GetMissedFrameCount() const { return m_missed_frame_count; }
+
+	public:
+		FramePacer() = delete;
+		// max_queued_frames: Presented frames not displayed yet (1: Lowest latency)
+		// safety_margin: Slack kept before the vblank to absorb CPU jitter (Milliseconds)
+		FramePacer(VulkanContext* vulkan_context, uint32_t max_queued_frames = 1, double safety_margin = 1.0);
+		FramePacer(const FramePacer&) = delete;
+
+	private:
+		static constexpr uint32_t MAX_TRACKED_FRAMES = 8; // >= max_queued_frames + 1
+		struct FrameTiming
+		{
+			uint64_t present_id = 0;
+			Clock::time_point begin;		// Pace() returned
+			Clock::time_point present;	// vkQueuePresentKHR()
+		};
+		FrameTiming& timing(uint64_t present_id) { return m_timings[present_id % MAX_TRACKED_FRAMES]; }
+		void on_displayed(uint64_t present_id, Clock::time_point display_time);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		PFN_vkWaitForPresentKHR m_wait_for_present = nullptr;
+		const uint32_t m_max_queued_frames;
+		const double m_safety_margin;
+
+		uint64_t m_last_present_id = 0;
+		uint64_t m_first_present_id = 1;	// First present of the current swap chain
+		uint64_t m_swapchain_generation = 0;
+		uint64_t m_last_displayed_id = 0;
+		Clock::time_point m_last_display_time;
+		Clock::time_point m_next_begin;		// Begin of the frame being recorded
+		std::array<FrameTiming, MAX_TRACKED_FRAMES> m_timings;
+
+		double m_display_interval = 0.0;
+		double m_frame_latency = 0.0;
+		double m_input_delay = 0.0;
+		uint64_t m_missed_frame_count = 0;
+	};
+
+}} // namespace Albedo::RHI
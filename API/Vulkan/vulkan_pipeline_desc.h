@@ -0,0 +1,283 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+#include "vulkan_hash.h"
+
+#include <bit>
+
+namespace Albedo {
+namespace RHI
+{
+	// Compile-time Pipeline States: Policies of the common fixed-function states, combined by PipelineDesc into constexpr create info
+	// blocks and a precomputed hash. DescribedGraphicsPipeline<PipelineDesc<...>> returns the blocks from final prepare_xxx_state()
+	// overrides, and the hash replaces their serialization in the pipeline state key (VulkanContext::AcquirePipeline()).
+	constexpr uint64_t HashState(const VkPipelineInputAssemblyStateCreateInfo& state)
+	{
+		return HashWords(state.topology, state.primitiveRestartEnable);
+	}
+
+	constexpr uint64_t HashState(const VkPipelineRasterizationStateCreateInfo& state)
+	{
+		return HashWords(state.depthClampEnable, state.rasterizerDiscardEnable, state.polygonMode, state.cullMode, state.frontFace, state.depthBiasEnable,
+			std::bit_cast<uint32_t>(state.depthBiasConstantFactor), std::bit_cast<uint32_t>(state.depthBiasClamp),
+			std::bit_cast<uint32_t>(state.depthBiasSlopeFactor), std::bit_cast<uint32_t>(state.lineWidth));
+	}
+
+	constexpr uint64_t HashState(const VkPipelineDepthStencilStateCreateInfo& state)
+	{
+		return HashWords(state.depthTestEnable, state.depthWriteEnable, state.depthCompareOp, state.depthBoundsTestEnable, state.stencilTestEnable,
+			std::bit_cast<uint32_t>(state.minDepthBounds), std::bit_cast<uint32_t>(state.maxDepthBounds));
+	}
+
+	constexpr uint64_t HashState(const VkPipelineColorBlendAttachmentState& state)
+	{
+		return HashWords(state.blendEnable, state.srcColorBlendFactor, state.dstColorBlendFactor, state.colorBlendOp,
+			state.srcAlphaBlendFactor, state.dstAlphaBlendFactor, state.alphaBlendOp, state.colorWriteMask);
+	}
+
+	namespace Blend
+	{
+		constexpr VkColorComponentFlags RGBA = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+		struct Opaque
+		{
+			static constexpr VkPipelineColorBlendAttachmentState ATTACHMENT
+			{
+				.blendEnable = VK_FALSE,
+				.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+				.colorBlendOp = VK_BLEND_OP_ADD,
+				.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+				.alphaBlendOp = VK_BLEND_OP_ADD,
+				.colorWriteMask = RGBA
+			};
+		};
+
+		struct Alpha // Straight alpha (Translucent, draw back to front)
+		{
+			static constexpr VkPipelineColorBlendAttachmentState ATTACHMENT
+			{
+				.blendEnable = VK_TRUE,
+				.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+				.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+				.colorBlendOp = VK_BLEND_OP_ADD,
+				.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+				.alphaBlendOp = VK_BLEND_OP_ADD,
+				.colorWriteMask = RGBA
+			};
+		};
+
+		struct Premultiplied // Colors already multiplied by their alpha (UI, particles)
+		{
+			static constexpr VkPipelineColorBlendAttachmentState ATTACHMENT
+			{
+				.blendEnable = VK_TRUE,
+				.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+				.colorBlendOp = VK_BLEND_OP_ADD,
+				.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+				.alphaBlendOp = VK_BLEND_OP_ADD,
+				.colorWriteMask = RGBA
+			};
+		};
+
+		struct Additive // Lights, glows (Order independent)
+		{
+			static constexpr VkPipelineColorBlendAttachmentState ATTACHMENT
+			{
+				.blendEnable = VK_TRUE,
+				.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstColorBlendFactor = VK_BLEND_FACTOR_ONE,
+				.colorBlendOp = VK_BLEND_OP_ADD,
+				.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+				.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+				.alphaBlendOp = VK_BLEND_OP_ADD,
+				.colorWriteMask = RGBA
+			};
+		};
+	} // namespace Blend
+
+	namespace Depth
+	{
+		constexpr VkPipelineDepthStencilStateCreateInfo make_state(bool test, bool write, VkCompareOp compare_op)
+		{
+			return VkPipelineDepthStencilStateCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+				.depthTestEnable = test ? VK_TRUE : VK_FALSE,
+				.depthWriteEnable = write ? VK_TRUE : VK_FALSE,
+				.depthCompareOp = compare_op,
+				.depthBoundsTestEnable = VK_FALSE,
+				.stencilTestEnable = VK_FALSE,
+				.front = {},
+				.back = {},
+				.minDepthBounds = 0.0f,
+				.maxDepthBounds = 1.0f
+			};
+		}
+
+		struct Disabled			{ static constexpr auto STATE = make_state(false, false, VK_COMPARE_OP_ALWAYS); };
+		struct LessWrite			{ static constexpr auto STATE = make_state(true, true, VK_COMPARE_OP_LESS); };
+		struct LessRead			{ static constexpr auto STATE = make_state(true, false, VK_COMPARE_OP_LESS); }; // Translucent
+		struct EqualRead			{ static constexpr auto STATE = make_state(true, false, VK_COMPARE_OP_EQUAL); }; // After a depth pre-pass
+		struct GreaterWrite		{ static constexpr auto STATE = make_state(true, true, VK_COMPARE_OP_GREATER); }; // Reversed-Z
+		struct GreaterRead		{ static constexpr auto STATE = make_state(true, false, VK_COMPARE_OP_GREATER); };
+	} // namespace Depth
+
+	namespace Cull
+	{
+		constexpr VkPipelineRasterizationStateCreateInfo make_state(VkCullModeFlags cull_mode, VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL)
+		{
+			return VkPipelineRasterizationStateCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+				.depthClampEnable = VK_FALSE,
+				.rasterizerDiscardEnable = VK_FALSE,
+				.polygonMode = polygon_mode,
+				.cullMode = cull_mode,
+				.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+				.depthBiasEnable = VK_FALSE,
+				.depthBiasConstantFactor = 0.0f,
+				.depthBiasClamp = 0.0f,
+				.depthBiasSlopeFactor = 0.0f,
+				.lineWidth = 1.0f
+			};
+		}
+
+		struct None			{ static constexpr auto STATE = make_state(VK_CULL_MODE_NONE); };
+		struct Back			{ static constexpr auto STATE = make_state(VK_CULL_MODE_BACK_BIT); }; // Counter-clockwise front faces
+		struct Front			{ static constexpr auto STATE = make_state(VK_CULL_MODE_FRONT_BIT); };
+		struct Wireframe	{ static constexpr auto STATE = make_state(VK_CULL_MODE_NONE, VK_POLYGON_MODE_LINE); }; // Requires fillModeNonSolid
+	} // namespace Cull
+
+	namespace Topology
+	{
+		constexpr VkPipelineInputAssemblyStateCreateInfo make_state(VkPrimitiveTopology topology)
+		{
+			return VkPipelineInputAssemblyStateCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+				.topology = topology,
+				.primitiveRestartEnable = VK_FALSE
+			};
+		}
+
+		struct TriangleList	{ static constexpr auto STATE = make_state(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST); };
+		struct TriangleStrip	{ static constexpr auto STATE = make_state(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP); };
+		struct LineList			{ static constexpr auto STATE = make_state(VK_PRIMITIVE_TOPOLOGY_LINE_LIST); };
+		struct PointList			{ static constexpr auto STATE = make_state(VK_PRIMITIVE_TOPOLOGY_POINT_LIST); };
+	} // namespace Topology
+
+	template<typename BlendMode, typename DepthMode, typename CullMode, typename TopologyMode = Topology::TriangleList>
+	struct PipelineDesc
+	{
+		static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8; // Every attachment blends the same way
+
+		static constexpr VkPipelineInputAssemblyStateCreateInfo INPUT_ASSEMBLY = TopologyMode::STATE;
+		static constexpr VkPipelineRasterizationStateCreateInfo RASTERIZATION = CullMode::STATE;
+		static constexpr VkPipelineDepthStencilStateCreateInfo DEPTH_STENCIL = DepthMode::STATE;
+		static constexpr std::array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> COLOR_BLEND_ATTACHMENTS = []()
+			{
+				std::array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> attachments{};
+				attachments.fill(BlendMode::ATTACHMENT);
+				return attachments;
+			}();
+
+		// Never 0 (0 marks pipelines with serialized states)
+		static constexpr uint64_t HASH = HashWords(HashState(INPUT_ASSEMBLY), HashState(RASTERIZATION),
+			HashState(DEPTH_STENCIL), HashState(BlendMode::ATTACHMENT)) | 1;
+	};
+
+	// Graphics pipeline of a PipelineDesc: Only the shaders (And optionally the layouts, vertex formats, specialization ...) are
+	// prepared by the derived class. Viewports and scissors are dynamic (CommandBuffer::SetViewports() & SetScissors()), without
+	// Vulkan 1.3 the derived constructor fills m_viewports and m_scissors instead.
+	template<typename Desc>
+	class DescribedGraphicsPipeline : public GraphicsPipeline
+	{
+	public:
+		DescribedGraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+			VkRenderPass owner, uint32_t subpass_bind_point, uint32_t color_attachment_count = 1) :
+			GraphicsPipeline{ std::move(vulkan_context), owner, subpass_bind_point },
+			m_color_attachment_count{ color_attachment_count }
+		{
+			setup();
+		}
+		DescribedGraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context, const RenderingFormats& rendering_formats) :
+			GraphicsPipeline{ std::move(vulkan_context), rendering_formats },
+			m_color_attachment_count{ static_cast<uint32_t>(rendering_formats.color_formats.size()) }
+		{
+			setup();
+		}
+
+	protected:
+		VkPipelineInputAssemblyStateCreateInfo prepare_input_assembly_state() final { return Desc::INPUT_ASSEMBLY; }
+		VkPipelineRasterizationStateCreateInfo prepare_rasterization_state() final { return Desc::RASTERIZATION; }
+		VkPipelineDepthStencilStateCreateInfo prepare_depth_stencil_state() final { return Desc::DEPTH_STENCIL; }
+		VkPipelineColorBlendStateCreateInfo prepare_color_blend_state() final
+		{
+			return VkPipelineColorBlendStateCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+				.logicOpEnable = VK_FALSE,
+				.logicOp = VK_LOGIC_OP_COPY,
+				.attachmentCount = m_color_attachment_count,
+				.pAttachments = Desc::COLOR_BLEND_ATTACHMENTS.data(),
+				.blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
+			};
+		}
+		VkPipelineViewportStateCreateInfo prepare_viewport_state() override
+		{
+			return VkPipelineViewportStateCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+				.viewportCount = std::max(static_cast<uint32_t>(m_viewports.size()), 1u), // Dynamic counts drop them
+				.pViewports = m_viewports.empty()? nullptr : m_viewports.data(),
+				.scissorCount = std::max(static_cast<uint32_t>(m_scissors.size()), 1u),
+				.pScissors = m_scissors.empty()? nullptr : m_scissors.data()
+			};
+		}
+
+	private:
+		void setup()
+		{
+			assert(m_color_attachment_count <= Desc::MAX_COLOR_ATTACHMENTS && "Too many color attachments for a PipelineDesc!");
+			m_fixed_state_hash = Desc::HASH;
+			use_dynamic_viewports();
+		}
+
+	private:
+		const uint32_t m_color_attachment_count;
+	};
+
+	// Dynamic state of a PipelineDesc for ShaderObjectProgram::Bind() (Built once, not per draw)
+	template<typename Desc>
+	ShaderObjectProgram::State MakeShaderObjectState(uint32_t color_attachment_count = 1, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT)
+	{
+		assert(color_attachment_count <= Desc::MAX_COLOR_ATTACHMENTS && "Too many color attachments for a PipelineDesc!");
+		return ShaderObjectProgram::State
+		{
+			.topology = Desc::INPUT_ASSEMBLY.topology,
+			.primitive_restart = Desc::INPUT_ASSEMBLY.primitiveRestartEnable == VK_TRUE,
+			.rasterizer_discard = Desc::RASTERIZATION.rasterizerDiscardEnable == VK_TRUE,
+			.polygon_mode = Desc::RASTERIZATION.polygonMode,
+			.cull_mode = Desc::RASTERIZATION.cullMode,
+			.front_face = Desc::RASTERIZATION.frontFace,
+			.line_width = Desc::RASTERIZATION.lineWidth,
+			.depth_clamp = Desc::RASTERIZATION.depthClampEnable == VK_TRUE,
+			.depth_bias = Desc::RASTERIZATION.depthBiasEnable == VK_TRUE,
+			.depth_bias_constant_factor = Desc::RASTERIZATION.depthBiasConstantFactor,
+			.depth_bias_clamp = Desc::RASTERIZATION.depthBiasClamp,
+			.depth_bias_slope_factor = Desc::RASTERIZATION.depthBiasSlopeFactor,
+			.depth_test = Desc::DEPTH_STENCIL.depthTestEnable == VK_TRUE,
+			.depth_write = Desc::DEPTH_STENCIL.depthWriteEnable == VK_TRUE,
+			.depth_compare_op = Desc::DEPTH_STENCIL.depthCompareOp,
+			.stencil_test = Desc::DEPTH_STENCIL.stencilTestEnable == VK_TRUE,
+			.samples = samples,
+			.color_blend_attachments{ Desc::COLOR_BLEND_ATTACHMENTS.begin(), Desc::COLOR_BLEND_ATTACHMENTS.begin() + color_attachment_count }
+		};
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,496 @@
+#include "vulkan_pipeline_trace.h"
+#include "vulkan_context.h"
+
+#include <fstream>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		// Trace File: [MAGIC][VERSION][LAYOUT HASH][COUNT] { [N]{Serialized Record} } ...
+		constexpr uint32_t PIPELINE_TRACE_FILE_MAGIC = 0x41505452; // "APTR"
+		constexpr uint32_t PIPELINE_TRACE_FILE_VERSION = 1;
+		// Records hold native structs, so a build with other struct layouts must not read them
+		constexpr uint64_t PIPELINE_TRACE_LAYOUT_HASH = HashWords(sizeof(VkPipelineRasterizationStateCreateInfo), sizeof(VkPipelineColorBlendStateCreateInfo),
+			sizeof(VkPipelineMultisampleStateCreateInfo), sizeof(VkPipelineDepthStencilStateCreateInfo), sizeof(VkDescriptorSetLayoutBinding),
+			sizeof(Sampler::Desc), alignof(void*));
+
+		// Absent states keep sType 0 and pNext is cleared (Pointers are restored by PipelineTrace::Compile())
+		template<typename State>
+		State persist(const State* state)
+		{
+			if (state == nullptr) return State{};
+			State copy = *state;
+			copy.pNext = nullptr;
+			return copy;
+		}
+
+		class TraceWriter
+		{
+		public:
+			template<typename T>
+			void Write(const T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>, "Write the fields of the struct instead!");
+				auto bytes = reinterpret_cast<const char*>(&value);
+				m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+			}
+			template<typename Array>
+			void WriteArray(const Array& values)
+			{
+				Write(static_cast<uint32_t>(values.size()));
+				auto bytes = reinterpret_cast<const char*>(values.data());
+				m_data.insert(m_data.end(), bytes, bytes + values.size() * sizeof(values[0]));
+			}
+			std::vector<char> Take() { return std::move(m_data); }
+
+		private:
+			std::vector<char> m_data;
+		};
+
+		class TraceReader
+		{
+		public:
+			template<typename T>
+			void Read(T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>, "Read the fields of the struct instead!");
+				if (m_cursor + sizeof(T) > m_data.size()) throw std::runtime_error("The pipeline trace record is truncated!");
+				memcpy(&value, m_data.data() + m_cursor, sizeof(T));
+				m_cursor += sizeof(T);
+			}
+			template<typename Array>
+			void ReadArray(Array& values)
+			{
+				uint32_t size = 0;
+				Read(size);
+				if (m_cursor + size * sizeof(values[0]) > m_data.size()) throw std::runtime_error("The pipeline trace record is truncated!");
+				values.resize(size);
+				memcpy(values.data(), m_data.data() + m_cursor, size * sizeof(values[0]));
+				m_cursor += size * sizeof(values[0]);
+			}
+
+		public:
+			TraceReader(std::span<const char> data) : m_data{ data } {}
+
+		private:
+			std::span<const char> m_data;
+			size_t m_cursor = 0;
+		};
+
+		// std::nullopt if an immutable sampler was not created by the sampler cache
+		std::optional<std::vector<PipelineTrace::SetLayout>> trace_set_layouts(const std::vector<std::shared_ptr<DescriptorSetLayout>>& set_layouts)
+		{
+			std::vector<PipelineTrace::SetLayout> traced;
+			traced.reserve(set_layouts.size());
+			for (const auto& set_layout : set_layouts)
+			{
+				auto& setLayout = traced.emplace_back(PipelineTrace::SetLayout{ .flags = set_layout->GetFlags(), .bindings = set_layout->GetBindings() });
+				for (auto& binding : setLayout.bindings)
+				{
+					if (binding.pImmutableSamplers)
+					{
+						auto sampler = set_layout->GetImmutableSampler(binding.binding);
+						if (sampler == nullptr) return std::nullopt;
+						setLayout.immutable_samplers.emplace_back(PipelineTrace::SetLayout::ImmutableSampler{ .binding = binding.binding, .desc = sampler->GetDesc() });
+					}
+					binding.pImmutableSamplers = nullptr;
+				}
+			}
+			return traced;
+		}
+
+		void trace_specialization(PipelineTrace::Record& record, const VkSpecializationInfo* specialization)
+		{
+			record.has_specialization = specialization != nullptr;
+			if (specialization == nullptr) return;
+			record.specialization_entries.assign(specialization->pMapEntries, specialization->pMapEntries + specialization->mapEntryCount);
+			auto data = static_cast<const uint8_t*>(specialization->pData);
+			record.specialization_data.assign(data, data + specialization->dataSize);
+		}
+	} // namespace
+
+	void PipelineTrace::Add(Record record)
+	{
+		auto data = Serialize(record);
+		auto hash = HashBytes(data.data(), data.size());
+		std::scoped_lock guard{ m_mutex };
+		if (m_record_hashes.insert(hash).second) m_records.emplace_back(std::move(record));
+	}
+
+	size_t PipelineTrace::GetRecordCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_records.size();
+	}
+
+	std::vector<PipelineTrace::Record> PipelineTrace::GetRecords()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_records;
+	}
+
+	void PipelineTrace::Save(std::string_view trace_file)
+	{
+		std::ofstream file(trace_file.data(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the pipeline trace {}!", trace_file));
+
+		auto write = [&file](const auto& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+		std::scoped_lock guard{ m_mutex };
+		write(PIPELINE_TRACE_FILE_MAGIC);
+		write(PIPELINE_TRACE_FILE_VERSION);
+		write(PIPELINE_TRACE_LAYOUT_HASH);
+		write(static_cast<uint32_t>(m_records.size()));
+		for (const auto& record : m_records)
+		{
+			auto data = Serialize(record);
+			write(static_cast<uint32_t>(data.size()));
+			file.write(data.data(), data.size());
+		}
+		if (!file) throw std::runtime_error(std::format("Failed to write the pipeline trace {}!", trace_file));
+		log::info("Saved {} pipelines into the pipeline trace {}", m_records.size(), trace_file);
+	}
+
+	void PipelineTrace::Load(std::string_view trace_file)
+	{
+		std::ifstream file(trace_file.data(), std::ios::binary);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the pipeline trace {}!", trace_file));
+
+		auto read = [&file](auto& value) { return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+		uint32_t magic = 0, version = 0, count = 0;
+		uint64_t layoutHash = 0;
+		if (!read(magic) || magic != PIPELINE_TRACE_FILE_MAGIC || !read(version) || version != PIPELINE_TRACE_FILE_VERSION ||
+			!read(layoutHash) || layoutHash != PIPELINE_TRACE_LAYOUT_HASH || !read(count))
+			throw std::runtime_error(std::format("Failed to load the pipeline trace {} - Invalid header or another build!", trace_file));
+
+		std::vector<char> data;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t size = 0;
+			if (!read(size)) throw std::runtime_error(std::format("Failed to load the pipeline trace {} - The file is truncated!", trace_file));
+			data.resize(size);
+			if (!file.read(data.data(), size)) throw std::runtime_error(std::format("Failed to load the pipeline trace {} - The file is truncated!", trace_file));
+			Add(Deserialize(data));
+		}
+		log::info("Loaded {} pipelines from the pipeline trace {}", count, trace_file);
+	}
+
+	std::optional<PipelineTrace::Record> PipelineTrace::MakeGraphicsRecord(const VkGraphicsPipelineCreateInfo& create_info, const VkPipelineRenderingCreateInfo& rendering_info,
+		const VkPipelineFragmentShadingRateStateCreateInfoKHR* shading_rate_state, const std::vector<std::string>& shader_files,
+		const std::vector<std::shared_ptr<ShaderModule>>& shader_modules, const std::vector<std::shared_ptr<DescriptorSetLayout>>& set_layouts,
+		const std::vector<VkPushConstantRange>& push_constants)
+	{
+		if (create_info.renderPass != VK_NULL_HANDLE || (create_info.flags & VK_PIPELINE_CREATE_LIBRARY_BIT_KHR)) return std::nullopt;
+
+		Record record{ .bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS, .flags = create_info.flags };
+		for (uint32_t i = 0; i < create_info.stageCount; ++i)
+		{
+			const auto& stage = create_info.pStages[i];
+			auto shaderModule = std::find_if(shader_modules.begin(), shader_modules.end(),
+				[&stage](const auto& shader_module) { return static_cast<VkShaderModule>(*shader_module) == stage.module; });
+			assert(shaderModule != shader_modules.end() && "Shader stages must come from the shader cache!");
+			record.shader_files.emplace_back(shader_files[shaderModule - shader_modules.begin()]);
+			record.shader_hashes.emplace_back((*shaderModule)->GetHash());
+			record.shader_stages.emplace_back(stage.stage);
+		}
+		trace_specialization(record, create_info.stageCount ? create_info.pStages[0].pSpecializationInfo : nullptr);
+		auto setLayouts = trace_set_layouts(set_layouts);
+		if (!setLayouts) return std::nullopt;
+		record.set_layouts = std::move(*setLayouts);
+		record.push_constants = push_constants;
+
+		if (const auto* state = create_info.pVertexInputState)
+		{
+			record.has_vertex_input = true;
+			record.vertex_bindings.assign(state->pVertexBindingDescriptions, state->pVertexBindingDescriptions + state->vertexBindingDescriptionCount);
+			record.vertex_attributes.assign(state->pVertexAttributeDescriptions, state->pVertexAttributeDescriptions + state->vertexAttributeDescriptionCount);
+		}
+		record.input_assembly = persist(create_info.pInputAssemblyState);
+		record.tessellation = persist(create_info.pTessellationState);
+		record.viewport = persist(create_info.pViewportState);
+		if (const auto* state = create_info.pViewportState)
+		{
+			if (state->pViewports) record.viewports.assign(state->pViewports, state->pViewports + state->viewportCount);
+			if (state->pScissors) record.scissors.assign(state->pScissors, state->pScissors + state->scissorCount);
+			record.viewport.pViewports = nullptr;
+			record.viewport.pScissors = nullptr;
+		}
+		record.rasterization = persist(create_info.pRasterizationState);
+		record.multisample = persist(create_info.pMultisampleState);
+		if (const auto* state = create_info.pMultisampleState; state && state->pSampleMask)
+		{
+			record.sample_mask.assign(state->pSampleMask, state->pSampleMask + (state->rasterizationSamples + 31) / 32);
+			record.multisample.pSampleMask = nullptr;
+		}
+		record.depth_stencil = persist(create_info.pDepthStencilState);
+		record.color_blend = persist(create_info.pColorBlendState);
+		if (const auto* state = create_info.pColorBlendState)
+		{
+			record.blend_attachments.assign(state->pAttachments, state->pAttachments + state->attachmentCount);
+			record.color_blend.pAttachments = nullptr;
+		}
+		if (const auto* state = create_info.pDynamicState)
+			record.dynamic_states.assign(state->pDynamicStates, state->pDynamicStates + state->dynamicStateCount);
+		record.color_formats.assign(rendering_info.pColorAttachmentFormats, rendering_info.pColorAttachmentFormats + rendering_info.colorAttachmentCount);
+		record.depth_format = rendering_info.depthAttachmentFormat;
+		record.stencil_format = rendering_info.stencilAttachmentFormat;
+		record.shading_rate = persist(shading_rate_state);
+		return record;
+	}
+
+	std::optional<PipelineTrace::Record> PipelineTrace::MakeComputeRecord(const VkComputePipelineCreateInfo& create_info, const std::string& shader_file,
+		const ShaderModule& shader_module, const std::vector<std::shared_ptr<DescriptorSetLayout>>& set_layouts,
+		const std::vector<VkPushConstantRange>& push_constants)
+	{
+		Record record
+		{
+			.bind_point = VK_PIPELINE_BIND_POINT_COMPUTE,
+			.flags = create_info.flags,
+			.shader_files = { shader_file },
+			.shader_hashes = { shader_module.GetHash() },
+			.shader_stages = { VK_SHADER_STAGE_COMPUTE_BIT }
+		};
+		trace_specialization(record, create_info.stage.pSpecializationInfo);
+		auto setLayouts = trace_set_layouts(set_layouts);
+		if (!setLayouts) return std::nullopt;
+		record.set_layouts = std::move(*setLayouts);
+		record.push_constants = push_constants;
+		return record;
+	}
+
+	bool PipelineTrace::Replay(VulkanContext& vulkan_context, const Record& record)
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::PipelineTrace::Replay");
+		auto compiled = Compile(vulkan_context, record);
+		if (!compiled) return false;
+		vkDestroyPipeline(vulkan_context.m_device, compiled->pipeline, vulkan_context.m_memory_allocation_callback); // Never used by commands
+		return true;
+	}
+
+	std::optional<PipelineTrace::Compiled> PipelineTrace::Compile(VulkanContext& vulkan_context, const Record& record)
+	{
+
+		// 1. Shaders (Skipped if the files were modified or removed since the trace)
+		auto& shaderCache = vulkan_context.GetShaderCache();
+		std::vector<std::shared_ptr<ShaderModule>> shaderModules;
+		for (size_t i = 0; i < record.shader_files.size(); ++i)
+		{
+			try { shaderModules.emplace_back(shaderCache.GetShaderModule(record.shader_files[i])); }
+			catch (const std::runtime_error&) { return std::nullopt; }
+			if (shaderModules.back()->GetHash() != record.shader_hashes[i]) return std::nullopt;
+		}
+
+		// 2. Layouts (From the context caches, so the pipelines created later share them)
+		std::vector<std::shared_ptr<DescriptorSetLayout>> setLayouts;
+		std::vector<VkDescriptorSetLayout> setLayoutHandles;
+		for (const auto& set_layout : record.set_layouts)
+		{
+			auto bindings = set_layout.bindings;
+			std::vector<std::shared_ptr<Sampler>> samplerOwners;
+			std::vector<std::vector<VkSampler>> samplers;
+			samplers.reserve(set_layout.immutable_samplers.size());
+			for (const auto& immutable_sampler : set_layout.immutable_samplers)
+			{
+				auto binding = std::find_if(bindings.begin(), bindings.end(),
+					[&immutable_sampler](const auto& binding) { return binding.binding == immutable_sampler.binding; });
+				if (binding == bindings.end()) throw std::runtime_error("Failed to replay the pipeline trace record - Invalid immutable sampler!");
+				auto& sampler = samplerOwners.emplace_back(vulkan_context.CreateSampler(immutable_sampler.desc));
+				binding->pImmutableSamplers = samplers.emplace_back(binding->descriptorCount, static_cast<VkSampler>(*sampler)).data();
+			}
+			setLayoutHandles.emplace_back(*setLayouts.emplace_back(vulkan_context.CreateDescripotrSetLayout(std::move(bindings), std::move(samplerOwners), set_layout.flags)));
+		}
+		auto pipelineLayout = vulkan_context.CreatePipelineLayout(setLayoutHandles, record.push_constants);
+
+		// 3. Pipeline (Compiled into the pipeline cache)
+		VkSpecializationInfo specializationInfo
+		{
+			.mapEntryCount = static_cast<uint32_t>(record.specialization_entries.size()),
+			.pMapEntries = record.specialization_entries.data(),
+			.dataSize = record.specialization_data.size(),
+			.pData = record.specialization_data.data()
+		};
+		std::vector<VkPipelineShaderStageCreateInfo> stageInfos;
+		for (size_t i = 0; i < shaderModules.size(); ++i)
+		{
+			stageInfos.emplace_back(VkPipelineShaderStageCreateInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					.stage = record.shader_stages[i],
+					.module = *shaderModules[i],
+					.pName = "main",
+					.pSpecializationInfo = record.has_specialization ? &specializationInfo : nullptr
+				});
+		}
+
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkResult result = VK_SUCCESS;
+		if (record.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE)
+		{
+			VkComputePipelineCreateInfo computePipelineCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+				.flags = record.flags,
+				.stage = stageInfos.front(),
+				.layout = *pipelineLayout,
+				.basePipelineIndex = -1
+			};
+			result = vkCreateComputePipelines(vulkan_context.m_device, vulkan_context.m_pipeline_cache, 1, &computePipelineCreateInfo,
+				vulkan_context.m_memory_allocation_callback, &pipeline);
+		}
+		else
+		{
+			VkPipelineVertexInputStateCreateInfo vertexInputState
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+				.vertexBindingDescriptionCount = static_cast<uint32_t>(record.vertex_bindings.size()),
+				.pVertexBindingDescriptions = record.vertex_bindings.data(),
+				.vertexAttributeDescriptionCount = static_cast<uint32_t>(record.vertex_attributes.size()),
+				.pVertexAttributeDescriptions = record.vertex_attributes.data()
+			};
+			auto viewportState = record.viewport;
+			viewportState.pViewports = record.viewports.empty() ? nullptr : record.viewports.data();
+			viewportState.pScissors = record.scissors.empty() ? nullptr : record.scissors.data();
+			auto multisampleState = record.multisample;
+			multisampleState.pSampleMask = record.sample_mask.empty() ? nullptr : record.sample_mask.data();
+			auto colorBlendState = record.color_blend;
+			colorBlendState.pAttachments = record.blend_attachments.data();
+			VkPipelineDynamicStateCreateInfo dynamicState
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+				.dynamicStateCount = static_cast<uint32_t>(record.dynamic_states.size()),
+				.pDynamicStates = record.dynamic_states.data()
+			};
+			VkPipelineRenderingCreateInfo renderingCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+				.pNext = record.shading_rate.sType ? &record.shading_rate : nullptr,
+				.colorAttachmentCount = static_cast<uint32_t>(record.color_formats.size()),
+				.pColorAttachmentFormats = record.color_formats.data(),
+				.depthAttachmentFormat = record.depth_format,
+				.stencilAttachmentFormat = record.stencil_format
+			};
+			auto present = [](const auto& state) { return state.sType ? &state : nullptr; }; // Absent states have sType 0
+			VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+				.pNext = &renderingCreateInfo,
+				.flags = record.flags,
+				.stageCount = static_cast<uint32_t>(stageInfos.size()),
+				.pStages = stageInfos.data(),
+				.pVertexInputState = record.has_vertex_input ? &vertexInputState : nullptr,
+				.pInputAssemblyState = present(record.input_assembly),
+				.pTessellationState = present(record.tessellation),
+				.pViewportState = present(viewportState),
+				.pRasterizationState = present(record.rasterization),
+				.pMultisampleState = present(multisampleState),
+				.pDepthStencilState = present(record.depth_stencil),
+				.pColorBlendState = present(colorBlendState),
+				.pDynamicState = &dynamicState,
+				.layout = *pipelineLayout,
+				.basePipelineIndex = -1
+			};
+			result = vkCreateGraphicsPipelines(vulkan_context.m_device, vulkan_context.m_pipeline_cache, 1, &graphicsPipelineCreateInfo,
+				vulkan_context.m_memory_allocation_callback, &pipeline);
+		}
+		if (result != VK_SUCCESS) throw std::runtime_error(std::format("Failed to replay the pipeline trace record ({})!", record.shader_files.front()));
+		return Compiled{ .pipeline = pipeline, .pipeline_layout = std::move(pipelineLayout), .set_layouts = std::move(setLayouts) };
+	}
+
+	std::vector<char> PipelineTrace::Serialize(const Record& record)
+	{
+		TraceWriter writer;
+		writer.Write(record.bind_point);
+		writer.Write(record.flags);
+		writer.Write(static_cast<uint32_t>(record.shader_files.size()));
+		for (const auto& shader_file : record.shader_files) writer.WriteArray(shader_file);
+		writer.WriteArray(record.shader_hashes);
+		writer.WriteArray(record.shader_stages);
+		writer.Write(record.has_specialization);
+		writer.WriteArray(record.specialization_entries);
+		writer.WriteArray(record.specialization_data);
+		writer.Write(static_cast<uint32_t>(record.set_layouts.size()));
+		for (const auto& set_layout : record.set_layouts)
+		{
+			writer.Write(set_layout.flags);
+			writer.WriteArray(set_layout.bindings);
+			writer.WriteArray(set_layout.immutable_samplers);
+		}
+		writer.WriteArray(record.push_constants);
+		if (record.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE) return writer.Take();
+
+		writer.Write(record.has_vertex_input);
+		writer.WriteArray(record.vertex_bindings);
+		writer.WriteArray(record.vertex_attributes);
+		writer.Write(record.input_assembly);
+		writer.Write(record.tessellation);
+		writer.Write(record.viewport);
+		writer.WriteArray(record.viewports);
+		writer.WriteArray(record.scissors);
+		writer.Write(record.rasterization);
+		writer.Write(record.multisample);
+		writer.WriteArray(record.sample_mask);
+		writer.Write(record.depth_stencil);
+		writer.Write(record.color_blend);
+		writer.WriteArray(record.blend_attachments);
+		writer.WriteArray(record.dynamic_states);
+		writer.WriteArray(record.color_formats);
+		writer.Write(record.depth_format);
+		writer.Write(record.stencil_format);
+		writer.Write(record.shading_rate);
+		return writer.Take();
+	}
+
+	PipelineTrace::Record PipelineTrace::Deserialize(std::span<const char> data)
+	{
+		TraceReader reader{ data };
+		Record record;
+		reader.Read(record.bind_point);
+		reader.Read(record.flags);
+		uint32_t count = 0;
+		reader.Read(count);
+		record.shader_files.resize(count);
+		for (auto& shader_file : record.shader_files) reader.ReadArray(shader_file);
+		reader.ReadArray(record.shader_hashes);
+		reader.ReadArray(record.shader_stages);
+		if (record.shader_hashes.size() != count || record.shader_stages.size() != count || count == 0)
+			throw std::runtime_error("The pipeline trace record has inconsistent shader stages!");
+		reader.Read(record.has_specialization);
+		reader.ReadArray(record.specialization_entries);
+		reader.ReadArray(record.specialization_data);
+		reader.Read(count);
+		record.set_layouts.resize(count);
+		for (auto& set_layout : record.set_layouts)
+		{
+			reader.Read(set_layout.flags);
+			reader.ReadArray(set_layout.bindings);
+			reader.ReadArray(set_layout.immutable_samplers);
+		}
+		reader.ReadArray(record.push_constants);
+		if (record.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE) return record;
+
+		reader.Read(record.has_vertex_input);
+		reader.ReadArray(record.vertex_bindings);
+		reader.ReadArray(record.vertex_attributes);
+		reader.Read(record.input_assembly);
+		reader.Read(record.tessellation);
+		reader.Read(record.viewport);
+		reader.ReadArray(record.viewports);
+		reader.ReadArray(record.scissors);
+		reader.Read(record.rasterization);
+		reader.Read(record.multisample);
+		reader.ReadArray(record.sample_mask);
+		reader.Read(record.depth_stencil);
+		reader.Read(record.color_blend);
+		reader.ReadArray(record.blend_attachments);
+		reader.ReadArray(record.dynamic_states);
+		reader.ReadArray(record.color_formats);
+		reader.Read(record.depth_format);
+		reader.Read(record.stencil_format);
+		reader.Read(record.shading_rate);
+		if (record.color_blend.attachmentCount != record.blend_attachments.size())
+			throw std::runtime_error("The pipeline trace record has inconsistent blend attachments!");
+		return record;
+	}
+
+}} // namespace Albedo::RHI
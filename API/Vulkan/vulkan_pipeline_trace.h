@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Pipeline Trace: Self-contained descriptions of the pipelines compiled by a run (Shader paths and hashes, reflected set layouts and
+	// the complete create info), recorded while attached to the context (VulkanContext::SetPipelineTrace()). A later run replays them
+	// by VulkanContext::PrewarmPipelines() into the pipeline cache, e.g. behind a loading screen or at install time, so no pipeline is
+	// compiled for the first time during gameplay. Render pass pipelines and layouts of prepare_descriptor_layouts() are not recorded
+	// (Their handles cannot be recreated from a file), records are in native layout (Same build, like the pipeline cache).
+	class PipelineTrace
+	{
+	public:
+		struct SetLayout
+		{
+			struct ImmutableSampler
+			{
+				uint32_t binding;
+				Sampler::Desc desc; // Recreated from the sampler cache
+			};
+			VkDescriptorSetLayoutCreateFlags flags = 0;
+			std::vector<VkDescriptorSetLayoutBinding> bindings; // pImmutableSamplers is not persisted
+			std::vector<ImmutableSampler> immutable_samplers;
+		};
+
+		struct Record
+		{
+			VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			VkPipelineCreateFlags flags = 0;
+			std::vector<std::string> shader_files; // Loaded by the shader cache (Records of modified shaders are skipped)
+			std::vector<uint64_t> shader_hashes;
+			std::vector<VkShaderStageFlagBits> shader_stages;
+			std::vector<VkSpecializationMapEntry> specialization_entries; // Shared by all stages
+			std::vector<uint8_t> specialization_data;
+			bool has_specialization = false;
+			std::vector<SetLayout> set_layouts;
+			std::vector<VkPushConstantRange> push_constants;
+
+			// Graphics pipelines (Dynamic Rendering), absent states have sType 0 and pointers are not persisted
+			std::vector<VkVertexInputBindingDescription> vertex_bindings;
+			std::vector<VkVertexInputAttributeDescription> vertex_attributes;
+			bool has_vertex_input = false;
+			VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+			VkPipelineTessellationStateCreateInfo tessellation{};
+			VkPipelineViewportStateCreateInfo viewport{};
+			std::vector<VkViewport> viewports;
+			std::vector<VkRect2D> scissors;
+			VkPipelineRasterizationStateCreateInfo rasterization{};
+			VkPipelineMultisampleStateCreateInfo multisample{};
+			std::vector<VkSampleMask> sample_mask;
+			VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+			VkPipelineColorBlendStateCreateInfo color_blend{};
+			std::vector<VkPipelineColorBlendAttachmentState> blend_attachments;
+			std::vector<VkDynamicState> dynamic_states;
+			std::vector<VkFormat> color_formats;
+			VkFormat depth_format = VK_FORMAT_UNDEFINED;
+			VkFormat stencil_format = VK_FORMAT_UNDEFINED;
+			VkPipelineFragmentShadingRateStateCreateInfoKHR shading_rate{};
+		};
+
+		// Thread-safe, identical records are kept once
+		void Add(Record record);
+		size_t GetRecordCount();
+		std::vector<Record> GetRecords(); // Copy (Replayed on the worker pool)
+
+		void Save(std::string_view trace_file);
+		void Load(std::string_view trace_file); // Appended (Throws if the file is broken or of another build)
+
+		// Records of the pipeline classes (std::nullopt: Not traceable), the shader modules of the stages come from the shader cache
+		static std::optional<Record> MakeGraphicsRecord(const VkGraphicsPipelineCreateInfo& create_info, const VkPipelineRenderingCreateInfo& rendering_info,
+			const VkPipelineFragmentShadingRateStateCreateInfoKHR* shading_rate_state, const std::vector<std::string>& shader_files,
+			const std::vector<std::shared_ptr<ShaderModule>>& shader_modules, const std::vector<std::shared_ptr<DescriptorSetLayout>>& set_layouts,
+			const std::vector<VkPushConstantRange>& push_constants);
+		static std::optional<Record> MakeComputeRecord(const VkComputePipelineCreateInfo& create_info, const std::string& shader_file,
+			const ShaderModule& shader_module, const std::vector<std::shared_ptr<DescriptorSetLayout>>& set_layouts,
+			const std::vector<VkPushConstantRange>& push_constants);
+
+		// Compiles the record into the pipeline cache of the context and destroys the pipeline (false: Skipped, e.g. modified shaders)
+		static bool Replay(VulkanContext& vulkan_context, const Record& record);
+		struct Compiled
+		{
+			VkPipeline pipeline; // Owned by the caller
+			std::shared_ptr<PipelineLayout> pipeline_layout;
+			std::vector<std::shared_ptr<DescriptorSetLayout>> set_layouts;
+		};
+		static std::optional<Compiled> Compile(VulkanContext& vulkan_context, const Record& record); // std::nullopt: Skipped
+
+		static std::vector<char> Serialize(const Record& record); // Native layout (Same build)
+		static Record Deserialize(std::span<const char> data); // Throws if the data is broken
+
+	private:
+		std::mutex m_mutex;
+		std::vector<Record> m_records;
+		std::unordered_set<uint64_t> m_record_hashes; // Of the serialized records
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,348 @@
+#include "vulkan_profiler.h"
+#include "vulkan_context.h"
+
+#include <bit>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr uint32_t CALIBRATION_ATTEMPTS = 4;
+
+		// Timestamp of HostTimeDomain on the steady clock
+		std::chrono::steady_clock::time_point to_steady_clock(uint64_t host_timestamp)
+		{
+#ifdef _WIN32
+			// QueryPerformanceCounter ticks (The source of MSVC's steady_clock), split to avoid overflowing
+			static const int64_t frequency = [] { LARGE_INTEGER value; QueryPerformanceFrequency(&value); return value.QuadPart; }();
+			const auto ticks = static_cast<int64_t>(host_timestamp);
+			const std::chrono::nanoseconds time{ ticks / frequency * 1000000000 + ticks % frequency * 1000000000 / frequency };
+#else
+			const std::chrono::nanoseconds time{ static_cast<int64_t>(host_timestamp) }; // CLOCK_MONOTONIC (The source of steady_clock)
+#endif
+			return std::chrono::steady_clock::time_point{ std::chrono::duration_cast<std::chrono::steady_clock::duration>(time) };
+		}
+	} // namespace
+
+	GPUProfiler::GPUProfiler(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight, uint32_t max_zones_per_frame/* = 512*/) :
+		m_context{ std::move(vulkan_context) },
+		m_timestamp_period_ms { m_context->m_physical_device_properties.limits.timestampPeriod / 1e6 },
+		m_max_queries{ 2 * max_zones_per_frame },
+		m_frames(frames_in_flight)
+	{
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_context->m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_context->m_physical_device, &queueFamilyCount, queueFamilies.data());
+		uint32_t validBits = queueFamilies[m_context->m_device_queue_family_graphics.value()].timestampValidBits;
+		if (validBits == 0) throw std::runtime_error("Failed to create the GPU Profiler - Timestamps are not supported by the graphics queue!");
+		m_timestamp_mask = validBits >= 64 ? std::numeric_limits<uint64_t>::max() : ((uint64_t(1) << validBits) - 1);
+		m_timestamp_valid_bits = std::min(validBits, 64u);
+
+		VkQueryPoolCreateInfo queryPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = m_max_queries
+		};
+		for (auto& frame : m_frames)
+		{
+			if (vkCreateQueryPool(
+				m_context->m_device,
+				&queryPoolCreateInfo,
+				m_context->m_memory_allocation_callback,
+				&frame.query_pool) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Query Pool!");
+			frame.zones.reserve(max_zones_per_frame);
+			frame.begin_queries.reserve(max_zones_per_frame);
+		}
+		m_timestamps.resize(m_max_queries);
+		Calibrate();
+	}
+
+	GPUProfiler::~GPUProfiler()
+	{
+		for (auto& frame : m_frames)
+			vkDestroyQueryPool(m_context->m_device, frame.query_pool, m_context->m_memory_allocation_callback);
+	}
+
+	void GPUProfiler::BeginFrame(uint32_t frame_index, VkCommandBuffer command_buffer)
+	{
+		assert(m_zone_stack.empty() && "Some GPU Profiler zones were not ended in the last frame!");
+		m_zone_stack.clear();
+
+		m_frame_index = frame_index;
+		auto& frame = m_frames[m_frame_index];
+		if (m_context->IsCalibratedTimestampsSupported() && Trace::Now() - m_calibrated_at_us >= CALIBRATION_INTERVAL_US) Calibrate();
+		resolve(frame);
+
+		m_context->m_dispatch.vkCmdResetQueryPool(command_buffer, frame.query_pool, 0, m_max_queries);
+		frame.query_count = 0;
+		frame.frame_number = ++m_frame_number;
+		frame.submitted_us = -1;
+		frame.zones.clear();
+		frame.begin_queries.clear();
+	}
+
+	void GPUProfiler::BeginZone(VkCommandBuffer command_buffer, std::string_view name)
+	{
+		auto& frame = m_frames[m_frame_index];
+		if (frame.query_count + 2 > m_max_queries)
+		{
+			m_zone_stack.emplace_back(ROOT); // Dropped (Out of queries)
+			return;
+		}
+
+		uint32_t parent = ROOT;
+		for (auto open_zone = m_zone_stack.rbegin(); open_zone != m_zone_stack.rend(); ++open_zone)
+			if (*open_zone != ROOT) { parent = *open_zone; break; }
+
+		uint32_t zone = static_cast<uint32_t>(frame.zones.size());
+		frame.zones.emplace_back(Zone
+			{
+				.name = std::string(name),
+				.parent = parent,
+				.depth = static_cast<uint32_t>(m_zone_stack.size())
+			});
+		frame.begin_queries.emplace_back(frame.query_count);
+		m_zone_stack.emplace_back(zone);
+
+		m_context->m_dispatch.vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.query_pool, frame.query_count);
+		frame.query_count += 2; // The end query is reserved
+	}
+
+	void GPUProfiler::EndZone(VkCommandBuffer command_buffer)
+	{
+		assert(!m_zone_stack.empty() && "You cannot EndZone() without BeginZone()!");
+		uint32_t zone = m_zone_stack.back();
+		m_zone_stack.pop_back();
+		if (zone == ROOT) return;
+
+		auto& frame = m_frames[m_frame_index];
+		m_context->m_dispatch.vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.query_pool, frame.begin_queries[zone] + 1);
+	}
+
+	void GPUProfiler::EndFrame()
+	{
+		if (Trace::IsEnabled()) m_frames[m_frame_index].submitted_us = Trace::Now();
+	}
+
+	bool GPUProfiler::Calibrate()
+	{
+		if (!m_context->IsCalibratedTimestampsSupported()) return false;
+		const std::array timestampInfos
+		{
+			VkCalibratedTimestampInfoEXT{ .sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, .timeDomain = VK_TIME_DOMAIN_DEVICE_EXT },
+			VkCalibratedTimestampInfoEXT{ .sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, .timeDomain = HostTimeDomain }
+		};
+
+		// Keep the tightest sample (Preemption between the clock reads widens maxDeviation)
+		std::array<uint64_t, 2> calibration{};
+		uint64_t calibrationDeviation = std::numeric_limits<uint64_t>::max();
+		for (uint32_t attempt = 0; attempt < CALIBRATION_ATTEMPTS; ++attempt)
+		{
+			std::array<uint64_t, 2> timestamps{};
+			uint64_t deviation = 0;
+			if (m_context->m_get_calibrated_timestamps(m_context->m_device, static_cast<uint32_t>(timestampInfos.size()), timestampInfos.data(),
+				timestamps.data(), &deviation) != VK_SUCCESS) continue;
+			if (deviation >= calibrationDeviation) continue;
+			calibration = timestamps;
+			calibrationDeviation = deviation;
+		}
+		if (calibrationDeviation == std::numeric_limits<uint64_t>::max()) return false;
+
+		m_calibration_timestamp = calibration[0] & m_timestamp_mask;
+		m_calibration_us = Trace::ToTraceTime(to_steady_clock(calibration[1]));
+		m_calibrated_at_us = Trace::Now();
+		m_calibration_deviation_us = calibrationDeviation / 1000.0;
+		return true;
+	}
+
+	void GPUProfiler::resolve(Frame& frame)
+	{
+		if (frame.query_count == 0) return;
+
+		// No WAIT bit: the frame fence has signaled, so a not-ready result only means the frame was not submitted
+		if (vkGetQueryPoolResults(
+			m_context->m_device,
+			frame.query_pool,
+			0, frame.query_count,
+			frame.query_count * sizeof(uint64_t), m_timestamps.data(),
+			sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) return;
+
+		uint64_t origin = m_timestamps[frame.begin_queries.front()] & m_timestamp_mask;
+		for (size_t zone = 0; zone < frame.zones.size(); ++zone)
+		{
+			uint64_t begin = m_timestamps[frame.begin_queries[zone]] & m_timestamp_mask;
+			uint64_t end = m_timestamps[frame.begin_queries[zone] + 1] & m_timestamp_mask;
+			frame.zones[zone].begin_ms = ((begin - origin) & m_timestamp_mask) * m_timestamp_period_ms;
+			frame.zones[zone].duration_ms = ((end - begin) & m_timestamp_mask) * m_timestamp_period_ms;
+		}
+		if (auto* sink = Trace::GetSink(); sink && frame.submitted_us >= 0)
+		{
+			for (size_t zone = 0; zone < frame.zones.size(); ++zone)
+			{
+				const auto& resolvedZone = frame.zones[zone];
+				int64_t begin = frame.submitted_us + static_cast<int64_t>(resolvedZone.begin_ms * 1000.0);
+				if (IsCalibrated()) begin = to_trace_time(m_timestamps[frame.begin_queries[zone]] & m_timestamp_mask);
+				sink->GPUZone(resolvedZone.name, resolvedZone.depth, begin, begin + static_cast<int64_t>(resolvedZone.duration_ms * 1000.0));
+			}
+		}
+		m_resolved_zones.swap(frame.zones);
+		m_resolved_frame_number = frame.frame_number;
+	}
+
+	int64_t GPUProfiler::to_trace_time(uint64_t timestamp) const
+	{
+		// Signed distance from the calibration (Timestamps wrap at timestampValidBits)
+		const uint64_t distance = (timestamp - m_calibration_timestamp) & m_timestamp_mask;
+		int64_t ticks = static_cast<int64_t>(distance);
+		if (m_timestamp_valid_bits < 64 && (distance >> (m_timestamp_valid_bits - 1))) ticks -= int64_t(1) << m_timestamp_valid_bits;
+		return m_calibration_us + static_cast<int64_t>(ticks * m_timestamp_period_ms * 1000.0);
+	}
+
+	// Written in bit order, matching the members of QueryPool::PipelineStatistics
+	static constexpr VkQueryPipelineStatisticFlags QUERY_PIPELINE_STATISTICS =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+	QueryPool::QueryPool(std::shared_ptr<VulkanContext> vulkan_context, Type type, uint32_t frames_in_flight, uint32_t max_queries_per_frame/* = 256*/) :
+		m_context{ std::move(vulkan_context) },
+		m_type{ type },
+		m_max_queries{ max_queries_per_frame },
+		m_values_per_query{ type == Type::OCCLUSION ? 1u : static_cast<uint32_t>(std::popcount(QUERY_PIPELINE_STATISTICS)) },
+		m_frames(frames_in_flight)
+	{
+		if (type == Type::PIPELINE_STATISTICS && !m_context->IsPipelineStatisticsQuerySupported())
+			throw std::runtime_error("Failed to create the Query Pool - Pipeline statistics queries are not supported by this device!");
+
+		VkQueryPoolCreateInfo queryPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = type == Type::OCCLUSION ? VK_QUERY_TYPE_OCCLUSION : VK_QUERY_TYPE_PIPELINE_STATISTICS,
+			.queryCount = m_max_queries,
+			.pipelineStatistics = type == Type::OCCLUSION ? 0 : QUERY_PIPELINE_STATISTICS
+		};
+		for (auto& frame : m_frames)
+		{
+			if (vkCreateQueryPool(
+				m_context->m_device,
+				&queryPoolCreateInfo,
+				m_context->m_memory_allocation_callback,
+				&frame.query_pool) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Query Pool!");
+			frame.results.reserve(m_max_queries);
+		}
+		m_values.resize(m_max_queries * m_values_per_query);
+	}
+
+	QueryPool::~QueryPool()
+	{
+		for (auto& frame : m_frames)
+			vkDestroyQueryPool(m_context->m_device, frame.query_pool, m_context->m_memory_allocation_callback);
+	}
+
+	void QueryPool::BeginFrame(uint32_t frame_index, VkCommandBuffer command_buffer)
+	{
+		m_frame_index = frame_index;
+		auto& frame = m_frames[m_frame_index];
+		resolve(frame);
+
+		m_context->m_dispatch.vkCmdResetQueryPool(command_buffer, frame.query_pool, 0, m_max_queries);
+		frame.frame_number = ++m_frame_number;
+		frame.results.clear();
+	}
+
+	uint32_t QueryPool::BeginQuery(VkCommandBuffer command_buffer, std::string_view name, bool precise/* = false*/)
+	{
+		auto& frame = m_frames[m_frame_index];
+		if (frame.results.size() >= m_max_queries) return INVALID; // Dropped (Out of queries)
+		assert((!precise || m_context->m_physical_device_features.occlusionQueryPrecise) && "Precise occlusion queries are not supported by this device!");
+
+		uint32_t query = static_cast<uint32_t>(frame.results.size());
+		frame.results.emplace_back(Result{ .name = std::string(name) });
+		m_context->m_dispatch.vkCmdBeginQuery(command_buffer, frame.query_pool, query, (precise && m_type == Type::OCCLUSION) ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+		return query;
+	}
+
+	void QueryPool::EndQuery(VkCommandBuffer command_buffer, uint32_t query)
+	{
+		if (query == INVALID) return;
+		m_context->m_dispatch.vkCmdEndQuery(command_buffer, m_frames[m_frame_index].query_pool, query);
+	}
+
+	void QueryPool::CopyPredicates(VkCommandBuffer command_buffer, VkBuffer predicate_buffer, VkDeviceSize offset, uint32_t first_query, uint32_t query_count)
+	{
+		assert(m_type == Type::OCCLUSION && "Only occlusion queries can be copied as predicates!");
+		assert(first_query + query_count <= m_frames[m_frame_index].results.size() && "You cannot copy queries which were not begun this frame!");
+		assert(m_context->IsConditionalRenderingSupported() && "Conditional rendering is not supported by this device!");
+		if (query_count == 0) return;
+
+		m_context->m_dispatch.vkCmdCopyQueryPoolResults(command_buffer, m_frames[m_frame_index].query_pool,
+			first_query, query_count,
+			predicate_buffer, offset, sizeof(uint32_t),
+			VK_QUERY_RESULT_WAIT_BIT); // 32-bit sample counts, non-zero means visible
+
+		VkBufferMemoryBarrier2 predicateBarrier
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+			.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_CONDITIONAL_RENDERING_BIT_EXT,
+			.dstAccessMask = VK_ACCESS_2_CONDITIONAL_RENDERING_READ_BIT_EXT,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.buffer = predicate_buffer,
+			.offset = offset,
+			.size = query_count * sizeof(uint32_t)
+		};
+		CommandBuffer::PipelineBarrier(command_buffer, *m_context, {}, { predicateBarrier });
+	}
+
+	void QueryPool::resolve(Frame& frame)
+	{
+		if (frame.results.empty()) return;
+
+		// No WAIT bit: the frame fence has signaled, so a not-ready result only means the frame was not submitted
+		const uint32_t queryCount = static_cast<uint32_t>(frame.results.size());
+		const VkDeviceSize stride = m_values_per_query * sizeof(uint64_t);
+		if (vkGetQueryPoolResults(
+			m_context->m_device,
+			frame.query_pool,
+			0, queryCount,
+			queryCount * stride, m_values.data(),
+			stride, VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) return;
+
+		for (uint32_t query = 0; query < queryCount; ++query)
+		{
+			const uint64_t* values = m_values.data() + query * m_values_per_query;
+			auto& result = frame.results[query];
+			if (m_type == Type::OCCLUSION) result.samples = values[0];
+			else result.statistics = PipelineStatistics
+			{
+				.input_assembly_vertices			= values[0],
+				.input_assembly_primitives		= values[1],
+				.vertex_shader_invocations		= values[2],
+				.clipping_invocations					= values[3],
+				.clipping_primitives					= values[4],
+				.fragment_shader_invocations	= values[5],
+				.compute_shader_invocations		= values[6]
+			};
+		}
+		m_resolved_results.swap(frame.results);
+		m_resolved_frame_number = frame.frame_number;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Host clock of std::chrono::steady_clock (Trace::Now()) for VK_EXT_calibrated_timestamps
+#ifdef _WIN32
+	constexpr VkTimeDomainEXT HostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+	constexpr VkTimeDomainEXT HostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+
+	// GPU Timestamp Profiler (One query pool per frame in flight, read back without stalling)
+	// With calibrated timestamps (VulkanContext::IsCalibratedTimestampsSupported()), the device clock is sampled together with the host
+	// clock every CALIBRATION_INTERVAL_US, so resolved zones land on the CPU trace timeline where they actually ran (Submission latency
+	// and GPU bubbles line up with the CPU zones). Without it, the zones of a frame are offset from its submission instead.
+	class GPUProfiler
+	{
+	public:
+		struct Zone
+		{
+			std::string name;
+			uint32_t parent = ROOT;	// Index in the zone list of the same frame
+			uint32_t depth = 0;
+			double begin_ms = 0.0;	// Relative to the first zone of the frame
+			double duration_ms = 0.0;
+		};
+		static constexpr uint32_t ROOT = std::numeric_limits<uint32_t>::max();
+		static constexpr int64_t CALIBRATION_INTERVAL_US = 1000000; // Bounds the drift between the clocks
+
+		// Call after the fence of this frame signaled, with the primary command buffer outside any render pass
+		// (Resolves the zones of the last use of this frame slot, then resets its queries)
+		void BeginFrame(uint32_t frame_index, VkCommandBuffer command_buffer);
+		// Zones must be nested and recorded in submission order (Not thread-safe)
+		void BeginZone(VkCommandBuffer command_buffer, std::string_view name);
+		void EndZone(VkCommandBuffer command_buffer);
+		// Call right before submitting the frame: its zones are forwarded to the Trace sink, at their calibrated times or from this CPU time on
+		// (Uncalibrated: The submission is the closest CPU point to the first GPU timestamp, queue latency shows up as an offset)
+		void EndFrame();
+		// Sample both clocks now (Also done by BeginFrame() once the interval elapsed), returns false without calibrated timestamps
+		bool Calibrate();
+		bool IsCalibrated() const { return m_calibration_us >= 0; }
+		double GetCalibrationDeviation() const { return m_calibration_deviation_us; } // Microseconds (maxDeviation of the best sample)
+
+		// Zone tree of the latest resolved frame in pre-order (children follow their parent)
+		const std::vector<Zone>& GetResolvedZones() const { return m_resolved_zones; }
+		uint64_t GetResolvedFrameNumber() const { return m_resolved_frame_number; }
+
+		class Scope // RAII Zone
+		{
+		public:
+			Scope(GPUProfiler& profiler, VkCommandBuffer command_buffer, std::string_view name) :
+				m_profiler{ profiler }, m_command_buffer{ command_buffer } { m_profiler.BeginZone(m_command_buffer, name); }
+			~Scope() { m_profiler.EndZone(m_command_buffer); }
+			Scope(const Scope&) = delete;
+		private:
+			GPUProfiler& m_profiler;
+			VkCommandBuffer m_command_buffer;
+		};
+
+	public:
+		GPUProfiler() = delete;
+		GPUProfiler(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight, uint32_t max_zones_per_frame = 512);
+		~GPUProfiler();
+		GPUProfiler(const GPUProfiler&) = delete;
+
+	private:
+		struct Frame
+		{
+			VkQueryPool query_pool = VK_NULL_HANDLE;
+			uint32_t query_count = 0;
+			uint64_t frame_number = 0;
+			int64_t submitted_us = -1; // Trace::Now() at EndFrame()
+			std::vector<Zone> zones;
+			std::vector<uint32_t> begin_queries; // Zone -> Timestamp query, the end query follows
+		};
+		void resolve(Frame& frame);
+		int64_t to_trace_time(uint64_t timestamp) const; // Calibrated only
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		double m_timestamp_period_ms;	// limits.timestampPeriod (ns per tick) in milliseconds
+		uint64_t m_timestamp_mask;		// timestampValidBits of the graphics queue family
+		uint32_t m_timestamp_valid_bits;
+		uint32_t m_max_queries;
+
+		// Device timestamp & Trace::Now() time sampled together (-1: Not calibrated)
+		uint64_t m_calibration_timestamp = 0;
+		int64_t m_calibration_us = -1;
+		int64_t m_calibrated_at_us = 0; // Trace::Now() of the last calibration
+		double m_calibration_deviation_us = 0.0;
+
+		std::vector<Frame> m_frames;
+		uint32_t m_frame_index = 0;
+		uint64_t m_frame_number = 0;
+		std::vector<uint32_t> m_zone_stack; // Open zones of the current frame (ROOT if dropped)
+		std::vector<uint64_t> m_timestamps;	// Readback storage
+
+		std::vector<Zone> m_resolved_zones;
+		uint64_t m_resolved_frame_number = 0;
+	};
+
+	// Occlusion & Pipeline Statistics Queries (One query pool per frame in flight, read back without stalling)
+	// Same frame protocol as GPUProfiler: results of a frame slot are resolved when the slot begins again.
+	class QueryPool
+	{
+	public:
+		enum class Type
+		{
+			OCCLUSION,						// Samples passing the depth & stencil tests
+			PIPELINE_STATISTICS		// VulkanContext::IsPipelineStatisticsQuerySupported()
+		};
+		struct PipelineStatistics
+		{
+			uint64_t input_assembly_vertices = 0;
+			uint64_t input_assembly_primitives = 0;
+			uint64_t vertex_shader_invocations = 0;
+			uint64_t clipping_invocations = 0;
+			uint64_t clipping_primitives = 0;
+			uint64_t fragment_shader_invocations = 0;
+			uint64_t compute_shader_invocations = 0;
+		};
+		struct Result
+		{
+			std::string name;
+			uint64_t samples = 0;						// OCCLUSION
+			PipelineStatistics statistics;	// PIPELINE_STATISTICS
+		};
+		static constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+
+		// Call after the fence of this frame signaled, with a command buffer outside any render pass (Resets the queries)
+		void BeginFrame(uint32_t frame_index, VkCommandBuffer command_buffer);
+		// Queries must not nest and must begin & end in the same subpass (Not thread-safe). Returns INVALID once the frame is out of queries.
+		uint32_t BeginQuery(VkCommandBuffer command_buffer, std::string_view name, bool precise = false /*Exact occlusion sample counts*/);
+		void EndQuery(VkCommandBuffer command_buffer, uint32_t query);
+		// GPU Occlusion Culling (OCCLUSION only): Copies the sample counts of the ended queries [first_query, first_query + query_count)
+		// of this frame as 32-bit predicates into predicate_buffer, then makes them visible to CommandBuffer::BeginConditional().
+		// Waits for the queries on the GPU only (No readback), record it outside any render pass.
+		void CopyPredicates(VkCommandBuffer command_buffer, VkBuffer predicate_buffer, VkDeviceSize offset, uint32_t first_query, uint32_t query_count);
+
+		// Results of the latest resolved frame in query order
+		const std::vector<Result>& GetResolvedResults() const { return m_resolved_results; }
+		uint64_t GetResolvedFrameNumber() const { return m_resolved_frame_number; }
+		Type GetType() const { return m_type; }
+
+		class Scope // RAII Query
+		{
+		public:
+			Scope(QueryPool& query_pool, VkCommandBuffer command_buffer, std::string_view name) :
+				m_query_pool{ query_pool }, m_command_buffer{ command_buffer }, m_query{ m_query_pool.BeginQuery(m_command_buffer, name) } {}
+			~Scope() { m_query_pool.EndQuery(m_command_buffer, m_query); }
+			Scope(const Scope&) = delete;
+		private:
+			QueryPool& m_query_pool;
+			VkCommandBuffer m_command_buffer;
+			uint32_t m_query;
+		};
+
+	public:
+		QueryPool() = delete;
+		QueryPool(std::shared_ptr<VulkanContext> vulkan_context, Type type, uint32_t frames_in_flight, uint32_t max_queries_per_frame = 256);
+		~QueryPool();
+		QueryPool(const QueryPool&) = delete;
+
+	private:
+		struct Frame
+		{
+			VkQueryPool query_pool = VK_NULL_HANDLE;
+			uint64_t frame_number = 0;
+			std::vector<Result> results; // One per query
+		};
+		void resolve(Frame& frame);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const Type m_type;
+		uint32_t m_max_queries;
+		uint32_t m_values_per_query; // 1 sample count or one value per statistic
+
+		std::vector<Frame> m_frames;
+		uint32_t m_frame_index = 0;
+		uint64_t m_frame_number = 0;
+		std::vector<uint64_t> m_values; // Readback storage
+
+		std::vector<Result> m_resolved_results;
+		uint64_t m_resolved_frame_number = 0;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,484 @@
+#include "vulkan_raytracing.h"
+#include "vulkan_context.h"
+
+#include <bit>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr VkBufferUsageFlags INPUT_USAGE = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+		constexpr VkBufferUsageFlags SCRATCH_USAGE = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+		VkAccelerationStructureGeometryKHR make_instance_geometry(VkDeviceAddress instances)
+		{
+			return VkAccelerationStructureGeometryKHR
+			{
+				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+				.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
+				.geometry{ .instances
+				{
+					.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+					.arrayOfPointers = VK_FALSE,
+					.data{ .deviceAddress = instances }
+				}}
+			};
+		}
+	} // namespace
+
+	AccelerationStructure::AccelerationStructure(std::shared_ptr<VulkanContext> vulkan_context, VkAccelerationStructureTypeKHR type, VkDeviceSize size) :
+		m_context{ std::move(vulkan_context) },
+		m_type{ type }
+	{
+		if (!m_context->IsAccelerationStructureSupported())
+			throw std::runtime_error("Failed to create the Acceleration Structure - VK_KHR_acceleration_structure is not supported by this device!");
+		if (size) m_storage = create_storage(size); // 0: Created by the derived class
+	}
+
+	AccelerationStructure::~AccelerationStructure()
+	{
+		release_storage(m_storage);
+	}
+
+	void AccelerationStructure::SetDebugName(const char* name)
+	{
+		DebugUtils::SetObjectName(m_context->m_device, VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, m_storage.handle, name);
+		m_storage.buffer->SetDebugName(name);
+	}
+
+	AccelerationStructure::Storage AccelerationStructure::create_storage(VkDeviceSize size)
+	{
+		Storage storage{ .size = size };
+		storage.buffer = m_context->m_memory_allocator->AllocateBuffer(size,
+			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			!m_context->IsAsyncComputeSupported()); // Built on the compute family, traced on the graphics family
+
+		VkAccelerationStructureCreateInfoKHR accelerationStructureCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
+			.buffer = *storage.buffer,
+			.offset = 0,
+			.size = size,
+			.type = m_type
+		};
+		if (m_context->m_create_acceleration_structure(m_context->m_device, &accelerationStructureCreateInfo,
+			m_context->m_memory_allocation_callback, &storage.handle) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Acceleration Structure!");
+
+		VkAccelerationStructureDeviceAddressInfoKHR deviceAddressInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+			.accelerationStructure = storage.handle
+		};
+		storage.device_address = m_context->m_get_acceleration_structure_device_address(m_context->m_device, &deviceAddressInfo);
+		return storage;
+	}
+
+	void AccelerationStructure::release_storage(Storage& storage)
+	{
+		if (storage.handle == VK_NULL_HANDLE) return;
+		m_context->DeferDeletion([context = m_context.get(), handle = storage.handle, buffer = std::move(storage.buffer)]()
+			{
+				context->m_destroy_acceleration_structure(context->m_device, handle, context->m_memory_allocation_callback);
+			}); // The buffer is released after the handle
+		storage = {};
+	}
+
+	TopLevelAccelerationStructure::TopLevelAccelerationStructure(std::shared_ptr<VulkanContext> vulkan_context,
+		uint32_t max_instance_count, uint32_t frames_in_flight, VkBuildAccelerationStructureFlagsKHR flags) :
+		AccelerationStructure{ vulkan_context, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, 0 },
+		m_max_instance_count{ max_instance_count },
+		m_flags{ flags }
+	{
+		assert(max_instance_count > 0 && frames_in_flight > 0 && "Invalid count of instances or frames!");
+		if (max_instance_count > m_context->m_physical_device_acceleration_structure_properties.maxInstanceCount)
+			throw std::runtime_error("Failed to create the Top Level Acceleration Structure - max_instance_count exceeds maxInstanceCount!");
+
+		// Sizes of the maximum instance count
+		auto instanceGeometry = make_instance_geometry(0);
+		VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+			.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+			.flags = flags,
+			.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+			.geometryCount = 1,
+			.pGeometries = &instanceGeometry
+		};
+		VkAccelerationStructureBuildSizesInfoKHR buildSizesInfo{ .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+		m_context->m_get_acceleration_structure_build_sizes(m_context->m_device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+			&buildGeometryInfo, &max_instance_count, &buildSizesInfo);
+
+		m_storage = create_storage(buildSizesInfo.accelerationStructureSize);
+		auto alignment = m_context->m_physical_device_acceleration_structure_properties.minAccelerationStructureScratchOffsetAlignment;
+		m_scratch_buffer = m_context->m_memory_allocator->AllocateBuffer(
+			std::max(buildSizesInfo.buildScratchSize, buildSizesInfo.updateScratchSize) + alignment, SCRATCH_USAGE);
+
+		m_instance_buffers.reserve(frames_in_flight);
+		for (uint32_t frame = 0; frame < frames_in_flight; ++frame)
+		{
+			m_instance_buffers.emplace_back(m_context->m_memory_allocator->AllocateBuffer(
+				sizeof(VkAccelerationStructureInstanceKHR) * max_instance_count, INPUT_USAGE, true, true));
+		}
+		if constexpr (EnableDebugMarkers)
+			SetDebugName(std::format("Top Level Acceleration Structure ({} instances)", max_instance_count).c_str());
+	}
+
+	AccelerationStructureBuilder::AccelerationStructureBuilder(std::shared_ptr<VulkanContext> vulkan_context, uint32_t max_refits/* = 64*/) :
+		m_context{ std::move(vulkan_context) },
+		m_max_refits{ max_refits },
+		m_scratch_alignment{ m_context->m_physical_device_acceleration_structure_properties.minAccelerationStructureScratchOffsetAlignment }
+	{
+		if (!m_context->IsAccelerationStructureSupported())
+			throw std::runtime_error("Failed to create the Acceleration Structure Builder - VK_KHR_acceleration_structure is not supported by this device!");
+		m_compute_timeline = m_context->GetGlobalQueueTimeline(m_context->m_device_queue_family_compute);
+	}
+
+	AccelerationStructureBuilder::~AccelerationStructureBuilder()
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_compute_timeline->Wait(m_last_tick);
+		for (auto& batch : m_batches)
+		{
+			if (batch.query_pool != VK_NULL_HANDLE)
+				vkDestroyQueryPool(m_context->m_device, batch.query_pool, m_context->m_memory_allocation_callback);
+		}
+		for (auto& compaction : m_compactions) // Completed but not swapped in
+		{
+			for (auto& [acceleration_structure, storage] : compaction.copies) acceleration_structure->release_storage(storage);
+		}
+	}
+
+	std::shared_ptr<AccelerationStructure> AccelerationStructureBuilder::AddBottomLevel(const std::vector<TriangleGeometry>& geometries,
+		VkBuildAccelerationStructureFlagsKHR flags/* = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR*/)
+	{
+		assert(!geometries.empty() && "Bottom levels need at least one geometry!");
+		PendingBuild pendingBuild{ .flags = flags };
+		std::vector<uint32_t> primitiveCounts;
+		pendingBuild.geometries.reserve(geometries.size());
+		pendingBuild.ranges.reserve(geometries.size());
+		for (const auto& geometry : geometries)
+		{
+			assert(geometry.vertex_buffer && (geometry.vertex_buffer->m_buffer_usage & INPUT_USAGE) == INPUT_USAGE &&
+				(!geometry.index_buffer || (geometry.index_buffer->m_buffer_usage & INPUT_USAGE) == INPUT_USAGE) &&
+				"Geometry buffers need the device address and build input usages!");
+			uint32_t primitiveCount = (geometry.index_buffer ? geometry.index_count : geometry.vertex_count) / 3;
+			pendingBuild.geometries.emplace_back(VkAccelerationStructureGeometryKHR
+				{
+					.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+					.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR,
+					.geometry{ .triangles
+					{
+						.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
+						.vertexFormat = geometry.vertex_format,
+						.vertexData{ .deviceAddress = geometry.vertex_buffer->DeviceAddress() + geometry.vertex_offset },
+						.vertexStride = geometry.vertex_stride,
+						.maxVertex = geometry.vertex_count ? geometry.vertex_count - 1 : 0,
+						.indexType = geometry.index_buffer ? geometry.index_type : VK_INDEX_TYPE_NONE_KHR,
+						.indexData{ .deviceAddress = geometry.index_buffer ? geometry.index_buffer->DeviceAddress() + geometry.index_offset : 0 }
+					}},
+					.flags = geometry.opaque ? VkGeometryFlagsKHR(VK_GEOMETRY_OPAQUE_BIT_KHR) : VkGeometryFlagsKHR(0)
+				});
+			pendingBuild.ranges.emplace_back(VkAccelerationStructureBuildRangeInfoKHR{ .primitiveCount = primitiveCount });
+			primitiveCounts.emplace_back(primitiveCount);
+			pendingBuild.inputs.emplace_back(geometry.vertex_buffer);
+			if (geometry.index_buffer) pendingBuild.inputs.emplace_back(geometry.index_buffer);
+		}
+
+		VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+			.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+			.flags = flags,
+			.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+			.geometryCount = static_cast<uint32_t>(pendingBuild.geometries.size()),
+			.pGeometries = pendingBuild.geometries.data()
+		};
+		VkAccelerationStructureBuildSizesInfoKHR buildSizesInfo{ .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+		m_context->m_get_acceleration_structure_build_sizes(m_context->m_device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+			&buildGeometryInfo, primitiveCounts.data(), &buildSizesInfo);
+
+		auto accelerationStructure = std::make_shared<AccelerationStructure>(m_context, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, buildSizesInfo.accelerationStructureSize);
+		pendingBuild.acceleration_structure = accelerationStructure;
+		pendingBuild.scratch_size = buildSizesInfo.buildScratchSize;
+
+		std::scoped_lock guard{ m_mutex };
+		m_pending_builds.emplace_back(std::move(pendingBuild));
+		return accelerationStructure;
+	}
+
+	uint64_t AccelerationStructureBuilder::Build(const std::vector<SemaphoreWaitInfo>& wait_semaphores/* = {}*/)
+	{
+		std::scoped_lock guard{ m_mutex };
+		if (m_pending_builds.empty()) return 0;
+
+		Batch batch{ .builds = std::move(m_pending_builds) };
+		m_pending_builds.clear();
+
+		// One scratch buffer, each build takes an aligned slice
+		VkDeviceSize scratchSize = 0;
+		for (const auto& build : batch.builds)
+			scratchSize += (build.scratch_size + m_scratch_alignment - 1) / m_scratch_alignment * m_scratch_alignment;
+		auto scratchBuffer = acquire_scratch(scratchSize + m_scratch_alignment);
+		VkDeviceAddress scratchAddress = align_scratch(*scratchBuffer);
+
+		std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildGeometryInfos;
+		std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> buildRangeInfos;
+		std::vector<VkAccelerationStructureKHR> compactions;
+		buildGeometryInfos.reserve(batch.builds.size());
+		buildRangeInfos.reserve(batch.builds.size());
+		for (auto& build : batch.builds)
+		{
+			buildGeometryInfos.emplace_back(VkAccelerationStructureBuildGeometryInfoKHR
+				{
+					.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+					.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+					.flags = build.flags,
+					.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+					.dstAccelerationStructure = *build.acceleration_structure,
+					.geometryCount = static_cast<uint32_t>(build.geometries.size()),
+					.pGeometries = build.geometries.data(),
+					.scratchData{ .deviceAddress = scratchAddress }
+				});
+			buildRangeInfos.emplace_back(build.ranges.data());
+			scratchAddress += (build.scratch_size + m_scratch_alignment - 1) / m_scratch_alignment * m_scratch_alignment;
+			if (build.flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
+			{
+				compactions.emplace_back(*build.acceleration_structure);
+				batch.compactions.emplace_back(build.acceleration_structure);
+			}
+		}
+
+		if (!compactions.empty())
+		{
+			VkQueryPoolCreateInfo queryPoolCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+				.queryCount = static_cast<uint32_t>(compactions.size())
+			};
+			if (vkCreateQueryPool(m_context->m_device, &queryPoolCreateInfo, m_context->m_memory_allocation_callback, &batch.query_pool) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Query Pool of the compacted sizes!");
+		}
+
+		auto commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_compute);
+		commandBuffer->Begin();
+		if (batch.query_pool != VK_NULL_HANDLE)
+			commandBuffer->GetDispatch().vkCmdResetQueryPool(*commandBuffer, batch.query_pool, 0, static_cast<uint32_t>(compactions.size()));
+		m_context->m_cmd_build_acceleration_structures(*commandBuffer, static_cast<uint32_t>(buildGeometryInfos.size()),
+			buildGeometryInfos.data(), buildRangeInfos.data());
+		if (batch.query_pool != VK_NULL_HANDLE)
+		{
+			commandBuffer->QueueBarrier(VkMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+					.srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+					.dstStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+					.dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR
+				});
+			commandBuffer->FlushBarriers();
+			m_context->m_cmd_write_acceleration_structures_properties(*commandBuffer, static_cast<uint32_t>(compactions.size()), compactions.data(),
+				VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, batch.query_pool, 0);
+		}
+		commandBuffer->End();
+		batch.tick = commandBuffer->SubmitTick(wait_semaphores);
+
+		m_scratch_pool.emplace_back(ScratchBuffer{ std::move(scratchBuffer), batch.tick });
+		m_last_tick = batch.tick;
+		m_batches.emplace_back(std::move(batch));
+		return m_last_tick;
+	}
+
+	void AccelerationStructureBuilder::Update()
+	{
+		std::scoped_lock guard{ m_mutex };
+
+		// Swap in the completed compactions (Frames in flight may still trace the original storage)
+		std::erase_if(m_compactions, [this](Compaction& compaction)
+			{
+				if (!m_compute_timeline->IsComplete(compaction.tick)) return false;
+				for (auto& [acceleration_structure, storage] : compaction.copies)
+				{
+					std::swap(acceleration_structure->m_storage, storage);
+					acceleration_structure->m_is_compacted = true;
+					acceleration_structure->release_storage(storage);
+				}
+				return true;
+			});
+
+		// Completed builds (In submission order)
+		std::vector<VkCopyAccelerationStructureInfoKHR> copyInfos;
+		Compaction compaction;
+		size_t completedCount = 0;
+		for (auto& batch : m_batches)
+		{
+			if (!m_compute_timeline->IsComplete(batch.tick)) break;
+			++completedCount;
+			for (auto& build : batch.builds) build.acceleration_structure->m_is_built = true;
+			if (batch.query_pool == VK_NULL_HANDLE) continue;
+
+			std::vector<VkDeviceSize> compactedSizes(batch.compactions.size());
+			VkResult result = vkGetQueryPoolResults(m_context->m_device, batch.query_pool, 0, static_cast<uint32_t>(compactedSizes.size()),
+				compactedSizes.size() * sizeof(VkDeviceSize), compactedSizes.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT);
+			vkDestroyQueryPool(m_context->m_device, batch.query_pool, m_context->m_memory_allocation_callback);
+			batch.query_pool = VK_NULL_HANDLE;
+			if (result != VK_SUCCESS) continue; // Keep the original storage
+
+			for (size_t index = 0; index < batch.compactions.size(); ++index)
+			{
+				auto& accelerationStructure = batch.compactions[index];
+				if (!compactedSizes[index] || compactedSizes[index] >= accelerationStructure->Size()) continue;
+				auto& copy = compaction.copies.emplace_back(accelerationStructure, accelerationStructure->create_storage(compactedSizes[index]));
+				copyInfos.emplace_back(VkCopyAccelerationStructureInfoKHR
+					{
+						.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
+						.src = *accelerationStructure,
+						.dst = copy.second.handle,
+						.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR
+					});
+			}
+		}
+		m_batches.erase(m_batches.begin(), m_batches.begin() + completedCount); // Releases the geometry inputs
+
+		if (copyInfos.empty()) return;
+		auto commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_compute);
+		commandBuffer->Begin();
+		for (const auto& copy_info : copyInfos) m_context->m_cmd_copy_acceleration_structure(*commandBuffer, &copy_info);
+		commandBuffer->End();
+		compaction.tick = commandBuffer->SubmitTick();
+		m_last_tick = compaction.tick;
+		m_compactions.emplace_back(std::move(compaction));
+	}
+
+	SemaphoreWaitInfo AccelerationStructureBuilder::GetWaitInfo()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return SemaphoreWaitInfo
+		{
+			.semaphore = m_compute_timeline->GetSemaphore(),
+			.stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, // Top level builds, ray queries and ray tracing shaders
+			.value = m_last_tick
+		};
+	}
+
+	size_t AccelerationStructureBuilder::GetPendingCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		size_t pendingCount = m_pending_builds.size();
+		for (const auto& batch : m_batches) pendingCount += batch.builds.size();
+		for (const auto& compaction : m_compactions) pendingCount += compaction.copies.size();
+		return pendingCount;
+	}
+
+	std::shared_ptr<TopLevelAccelerationStructure> AccelerationStructureBuilder::CreateTopLevel(uint32_t max_instance_count, uint32_t frames_in_flight,
+		VkBuildAccelerationStructureFlagsKHR flags/* = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR*/)
+	{
+		return std::make_shared<TopLevelAccelerationStructure>(m_context, max_instance_count, frames_in_flight, flags);
+	}
+
+	void AccelerationStructureBuilder::BuildTopLevelCommand(CommandBuffer& command_buffer, TopLevelAccelerationStructure& top_level,
+		std::span<const Instance> instances, uint32_t frame_index)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+
+		std::vector<VkAccelerationStructureInstanceKHR> instanceData;
+		std::vector<VkDeviceAddress> references;
+		instanceData.reserve(std::min<size_t>(instances.size(), top_level.m_max_instance_count));
+		references.reserve(instanceData.capacity());
+		for (const auto& instance : instances)
+		{
+			if (!instance.bottom_level || !instance.bottom_level->IsBuilt()) continue;
+			if (instanceData.size() == top_level.m_max_instance_count) break;
+			references.emplace_back(instance.bottom_level->DeviceAddress());
+			instanceData.emplace_back(VkAccelerationStructureInstanceKHR
+				{
+					.transform = instance.transform,
+					.instanceCustomIndex = instance.custom_index,
+					.mask = instance.mask,
+					.instanceShaderBindingTableRecordOffset = instance.hit_group_offset,
+					.flags = instance.flags,
+					.accelerationStructureReference = references.back()
+				});
+		}
+		auto& instanceBuffer = top_level.m_instance_buffers[frame_index % top_level.m_instance_buffers.size()];
+		if (!instanceData.empty()) instanceBuffer->Write(std::as_bytes(std::span{ instanceData })); // Visible to the submission
+
+		// Refit while the same bottom levels are referenced in the same order (Only the transforms changed)
+		bool isRefit = (top_level.m_flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR) && top_level.m_is_built &&
+			top_level.m_refit_count < m_max_refits && references == top_level.m_references;
+
+		auto instanceGeometry = make_instance_geometry(instanceBuffer->DeviceAddress());
+		VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+			.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+			.flags = top_level.m_flags,
+			.mode = isRefit ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+			.srcAccelerationStructure = isRefit ? VkAccelerationStructureKHR(top_level) : VK_NULL_HANDLE,
+			.dstAccelerationStructure = top_level,
+			.geometryCount = 1,
+			.pGeometries = &instanceGeometry,
+			.scratchData{ .deviceAddress = align_scratch(*top_level.m_scratch_buffer) }
+		};
+		VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{ .primitiveCount = static_cast<uint32_t>(instanceData.size()) };
+		const VkAccelerationStructureBuildRangeInfoKHR* buildRangeInfos = &buildRangeInfo;
+
+		// After the traces of the previous frame and the last build (Scratch)
+		command_buffer.QueueBarrier(VkMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+				.dstStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+				.dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR
+			});
+		command_buffer.FlushBarriers();
+		m_context->m_cmd_build_acceleration_structures(command_buffer, 1, &buildGeometryInfo, &buildRangeInfos);
+		command_buffer.QueueBarrier(VkMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+				.srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+				.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR
+			});
+
+		top_level.m_refit_count = isRefit ? top_level.m_refit_count + 1 : 0;
+		top_level.m_references = std::move(references);
+		top_level.m_is_built = true;
+	}
+
+	std::shared_ptr<VMA::Buffer> AccelerationStructureBuilder::acquire_scratch(VkDeviceSize size)
+	{
+		// Smallest completed buffer that fits
+		auto best = m_scratch_pool.end();
+		for (auto scratch = m_scratch_pool.begin(); scratch != m_scratch_pool.end(); ++scratch)
+		{
+			if (scratch->buffer->Size() < size || !m_compute_timeline->IsComplete(scratch->release_tick)) continue;
+			if (best == m_scratch_pool.end() || scratch->buffer->Size() < best->buffer->Size()) best = scratch;
+		}
+		if (best != m_scratch_pool.end())
+		{
+			auto buffer = std::move(best->buffer);
+			m_scratch_pool.erase(best);
+			return buffer;
+		}
+
+		constexpr VkDeviceSize MIN_SCRATCH_SIZE = 1024 * 1024;
+		auto buffer = m_context->m_memory_allocator->AllocateBuffer(std::bit_ceil(std::max(size, MIN_SCRATCH_SIZE)), SCRATCH_USAGE);
+		if constexpr (EnableDebugMarkers)
+			buffer->SetDebugName(std::format("Acceleration Structure Scratch ({} bytes)", buffer->Size()).c_str());
+		return buffer;
+	}
+
+	VkDeviceAddress AccelerationStructureBuilder::align_scratch(VMA::Buffer& scratch_buffer)
+	{
+		// The buffers are allocated with one extra alignment
+		VkDeviceAddress alignment = std::max<VkDeviceAddress>(m_scratch_alignment, 1);
+		return (scratch_buffer.DeviceAddress() + alignment - 1) / alignment * alignment;
+	}
+
+}} // namespace Albedo::RHI
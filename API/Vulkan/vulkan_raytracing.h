@@ -0,0 +1,171 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class AccelerationStructureBuilder;
+	struct SemaphoreWaitInfo;
+
+	// Bottom / Top Level Acceleration Structure in a VMA buffer (VK_KHR_acceleration_structure, built by the AccelerationStructureBuilder)
+	class AccelerationStructure
+	{
+		friend class AccelerationStructureBuilder;
+	public:
+		VkDeviceAddress DeviceAddress() const { return m_storage.device_address; } // Changes once the compacted copy is swapped in
+		VkAccelerationStructureTypeKHR GetType() const { return m_type; }
+		VkDeviceSize Size() const { return m_storage.size; }
+		bool IsBuilt() const { return m_is_built; } // Bottom levels: Observed by AccelerationStructureBuilder::Update()
+		bool IsCompacted() const { return m_is_compacted; }
+		void SetDebugName(const char* name); // No-op without debug markers
+		operator VkAccelerationStructureKHR() const { return m_storage.handle; }
+
+	public:
+		AccelerationStructure() = delete;
+		AccelerationStructure(std::shared_ptr<VulkanContext> vulkan_context, VkAccelerationStructureTypeKHR type, VkDeviceSize size); // From the build sizes
+		virtual ~AccelerationStructure(); // Destroyed after the GPU has passed the submitted work
+		AccelerationStructure(const AccelerationStructure&) = delete;
+
+	protected:
+		struct Storage
+		{
+			std::shared_ptr<VMA::Buffer> buffer;
+			VkAccelerationStructureKHR handle = VK_NULL_HANDLE;
+			VkDeviceAddress device_address = 0;
+			VkDeviceSize size = 0;
+		};
+		Storage create_storage(VkDeviceSize size); // Concurrent on the graphics & compute families
+		void release_storage(Storage& storage); // Deferred
+
+	protected:
+		std::shared_ptr<VulkanContext> m_context;
+		const VkAccelerationStructureTypeKHR m_type;
+		Storage m_storage;
+		bool m_is_built = false;
+		bool m_is_compacted = false;
+	};
+
+	// Rebuilt or refitted every frame by AccelerationStructureBuilder::BuildTopLevelCommand()
+	class TopLevelAccelerationStructure : public AccelerationStructure
+	{
+		friend class AccelerationStructureBuilder;
+	public:
+		uint32_t GetMaxInstanceCount() const { return m_max_instance_count; }
+		uint32_t GetInstanceCount() const { return static_cast<uint32_t>(m_references.size()); } // Of the last build
+		uint32_t GetRefitCount() const { return m_refit_count; } // Since the last full build
+
+	public:
+		TopLevelAccelerationStructure() = delete;
+		TopLevelAccelerationStructure(std::shared_ptr<VulkanContext> vulkan_context, uint32_t max_instance_count, uint32_t frames_in_flight,
+			VkBuildAccelerationStructureFlagsKHR flags);
+
+	private:
+		const uint32_t m_max_instance_count;
+		const VkBuildAccelerationStructureFlagsKHR m_flags;
+		std::vector<std::shared_ptr<VMA::Buffer>> m_instance_buffers; // Per frame slot (VkAccelerationStructureInstanceKHR[], host writable)
+		std::shared_ptr<VMA::Buffer> m_scratch_buffer; // max(Build, Update) scratch
+		std::vector<VkDeviceAddress> m_references; // Bottom levels of the last build (Refitted while identical)
+		uint32_t m_refit_count = 0;
+	};
+
+	// Batches the builds of many bottom levels into one vkCmdBuildAccelerationStructuresKHR on the compute queue (Async if supported),
+	// then queries their compacted sizes and swaps in compacted copies. Scratch buffers are pooled and reused once their builds completed.
+	// Bottom levels are read by the graphics queue, so wait GetWaitInfo() in the first submission tracing newly built ones.
+	class AccelerationStructureBuilder
+	{
+	public:
+		// Vertex & index buffers need VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT and VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR
+		// (Allocate them with is_exclusive = false if IsAsyncComputeSupported(), they are read by the compute family)
+		struct TriangleGeometry
+		{
+			std::shared_ptr<VMA::Buffer> vertex_buffer;
+			VkDeviceSize vertex_offset = 0;
+			uint32_t vertex_count = 0;
+			uint32_t vertex_stride = 3 * sizeof(float);
+			VkFormat vertex_format = VK_FORMAT_R32G32B32_SFLOAT; // Position (The other attributes are skipped by the stride)
+			std::shared_ptr<VMA::Buffer> index_buffer; // Null: Non-indexed triangles
+			VkDeviceSize index_offset = 0;
+			uint32_t index_count = 0;
+			VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+			bool opaque = true; // No any-hit shaders
+		};
+		struct Instance
+		{
+			std::shared_ptr<AccelerationStructure> bottom_level; // Skipped until built
+			VkTransformMatrixKHR transform{ { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } } }; // Row-major 3x4
+			uint32_t custom_index = 0;	// 24 bits (gl_InstanceCustomIndexEXT)
+			uint8_t mask = 0xFF;
+			uint32_t hit_group_offset = 0;	// 24 bits
+			VkGeometryInstanceFlagsKHR flags = 0; // 8 bits
+		};
+
+		// Queued until Build() (The structure is created here and IsBuilt() once its build completed)
+		std::shared_ptr<AccelerationStructure> AddBottomLevel(const std::vector<TriangleGeometry>& geometries,
+			VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR);
+		// One submission for all queued bottom levels (Wait the uploads of their geometries), returns the tick of the compute queue (0: Nothing queued)
+		uint64_t Build(const std::vector<SemaphoreWaitInfo>& wait_semaphores = {});
+		// Call once per frame: Observes completed builds, compacts them (ALLOW_COMPACTION) and swaps the compacted copies in
+		void Update();
+		SemaphoreWaitInfo GetWaitInfo(); // The compute timeline at the last submission
+		size_t GetPendingCount(); // Queued, building or compacting
+
+		std::shared_ptr<TopLevelAccelerationStructure> CreateTopLevel(uint32_t max_instance_count, uint32_t frames_in_flight,
+			VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR);
+		// Refits (ALLOW_UPDATE) while the instances reference the same bottom levels in the same order, otherwise rebuilds.
+		// Record it on the graphics queue before the passes tracing it (Instances beyond the max count are dropped).
+		void BuildTopLevelCommand(CommandBuffer& command_buffer, TopLevelAccelerationStructure& top_level,
+			std::span<const Instance> instances, uint32_t frame_index);
+
+	public:
+		AccelerationStructureBuilder() = delete;
+		AccelerationStructureBuilder(std::shared_ptr<VulkanContext> vulkan_context, uint32_t max_refits = 64 /*Then rebuilt for the trace quality*/);
+		~AccelerationStructureBuilder(); // Waits for the submitted builds
+		AccelerationStructureBuilder(const AccelerationStructureBuilder&) = delete;
+
+	private:
+		struct PendingBuild
+		{
+			std::shared_ptr<AccelerationStructure> acceleration_structure;
+			std::vector<VkAccelerationStructureGeometryKHR> geometries;
+			std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges;
+			std::vector<std::shared_ptr<VMA::Buffer>> inputs; // Alive until built
+			VkBuildAccelerationStructureFlagsKHR flags;
+			VkDeviceSize scratch_size;
+		};
+		struct Batch
+		{
+			uint64_t tick;
+			std::vector<PendingBuild> builds;
+			VkQueryPool query_pool = VK_NULL_HANDLE; // Compacted sizes
+			std::vector<std::shared_ptr<AccelerationStructure>> compactions; // In query order
+		};
+		struct Compaction
+		{
+			uint64_t tick;
+			std::vector<std::pair<std::shared_ptr<AccelerationStructure>, AccelerationStructure::Storage>> copies;
+		};
+		struct ScratchBuffer
+		{
+			std::shared_ptr<VMA::Buffer> buffer;
+			uint64_t release_tick; // Of the compute queue
+		};
+		std::shared_ptr<VMA::Buffer> acquire_scratch(VkDeviceSize size); // Synchronized by the caller
+		VkDeviceAddress align_scratch(VMA::Buffer& scratch_buffer);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::shared_ptr<QueueTimeline> m_compute_timeline;
+		const uint32_t m_max_refits;
+		const VkDeviceSize m_scratch_alignment; // minAccelerationStructureScratchOffsetAlignment
+
+		std::mutex m_mutex;
+		std::vector<PendingBuild> m_pending_builds;
+		std::vector<Batch> m_batches; // In submission order
+		std::vector<Compaction> m_compactions;
+		std::vector<ScratchBuffer> m_scratch_pool;
+		uint64_t m_last_tick = 0;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,226 @@
+#include "vulkan_readback.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr VkDeviceSize TEXEL_SIZE = 4;
+	} // namespace
+
+	ReadbackEngine::ReadbackEngine(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight) :
+		m_context{ std::move(vulkan_context) },
+		m_pending_requests(frames_in_flight)
+	{
+		assert(frames_in_flight > 0 && "Readback Engine needs at least one frame!");
+	}
+
+	ReadbackEngine::~ReadbackEngine()
+	{
+
+	}
+
+	ReadbackEngine::Future ReadbackEngine::ReadBufferCommand(CommandBuffer& command_buffer, VMA::Buffer& source,
+		VkDeviceSize offset/* = 0*/, VkDeviceSize size/* = VK_WHOLE_SIZE*/)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		if (size == VK_WHOLE_SIZE) size = source.Size() - offset;
+		assert(offset + size <= source.Size() && "Reading out of the buffer!");
+
+		auto buffer = acquire_buffer(size);
+		source.TransitionCommand(command_buffer, ResourceAccess
+			{
+				.stages = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.access = VK_ACCESS_2_TRANSFER_READ_BIT
+			}, offset, size);
+		command_buffer.FlushBarriers();
+		VkBufferCopy bufferCopy
+		{
+			.srcOffset = offset,
+			.dstOffset = 0,
+			.size = size
+		};
+		command_buffer.GetDispatch().vkCmdCopyBuffer(command_buffer, source, *buffer, 1, &bufferCopy);
+		host_read_barrier(command_buffer, *buffer);
+		return push_request(std::move(buffer), size, { 0, 0 });
+	}
+
+	ReadbackEngine::Future ReadbackEngine::ReadImageCommand(CommandBuffer& command_buffer, VMA::Image& source,
+		VkOffset2D offset/* = { 0, 0 }*/, VkExtent2D extent/* = { 0, 0 }*/)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		if (!extent.width || !extent.height)
+			extent = { source.Width() - static_cast<uint32_t>(offset.x), source.Height() - static_cast<uint32_t>(offset.y) };
+
+		auto buffer = acquire_buffer(TEXEL_SIZE * extent.width * extent.height);
+		source.TransitionCommand(command_buffer, ResourceAccess
+			{
+				.stages = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.access = VK_ACCESS_2_TRANSFER_READ_BIT,
+				.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			}, 0, 1);
+		command_buffer.FlushBarriers();
+		auto aspect = source.m_state_tracker.GetAspect();
+		if (aspect & VK_IMAGE_ASPECT_DEPTH_BIT) aspect = VK_IMAGE_ASPECT_DEPTH_BIT; // One aspect per copy
+		copy_image(command_buffer, source, aspect, *buffer, offset, extent);
+		host_read_barrier(command_buffer, *buffer);
+		return push_request(std::move(buffer), TEXEL_SIZE * extent.width * extent.height, extent);
+	}
+
+	ReadbackEngine::Future ReadbackEngine::CaptureCommand(CommandBuffer& command_buffer,
+		VkOffset2D offset/* = { 0, 0 }*/, VkExtent2D extent/* = { 0, 0 }*/)
+	{
+		if (m_context->IsHeadless())
+			return ReadImageCommand(command_buffer, *m_context->GetOffscreenImage(m_context->m_swapchain_current_image_index), offset, extent);
+
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		const auto& swapchainExtent = m_context->m_swapchain_current_extent;
+		if (!extent.width || !extent.height)
+			extent = { swapchainExtent.width - static_cast<uint32_t>(offset.x), swapchainExtent.height - static_cast<uint32_t>(offset.y) };
+		VkImage swapchainImage = m_context->m_swapchain_images[m_context->m_swapchain_current_image_index];
+		const VkImageSubresourceRange subresourceRange
+		{
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = 1,
+			.baseArrayLayer = 0,
+			.layerCount = 1
+		};
+
+		auto buffer = acquire_buffer(TEXEL_SIZE * extent.width * extent.height);
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, // The last pass
+				.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = swapchainImage,
+				.subresourceRange = subresourceRange
+			});
+		command_buffer.FlushBarriers();
+		copy_image(command_buffer, swapchainImage, VK_IMAGE_ASPECT_COLOR_BIT, *buffer, offset, extent);
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.srcAccessMask = VK_ACCESS_2_NONE,
+				.dstStageMask = VK_PIPELINE_STAGE_2_NONE, // Presentation waits on semaphores
+				.dstAccessMask = VK_ACCESS_2_NONE,
+				.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = swapchainImage,
+				.subresourceRange = subresourceRange
+			});
+		host_read_barrier(command_buffer, *buffer);
+		return push_request(std::move(buffer), TEXEL_SIZE * extent.width * extent.height, extent);
+	}
+
+	void ReadbackEngine::BeginFrame(uint32_t frame_index)
+	{
+		assert(frame_index < m_pending_requests.size() && "Frame index is out of range!");
+		std::vector<Request> completedRequests;
+		{
+			std::scoped_lock guard{ m_mutex };
+			m_frame_index = frame_index;
+			completedRequests.swap(m_pending_requests[frame_index]);
+		}
+		// Fulfilled out of the lock, continuations may record new readbacks
+		for (auto& request : completedRequests)
+		{
+			request.result.m_buffer->Invalidate(0, request.result.m_size); // Host-cached memory may be non-coherent
+			request.promise.set_value(std::move(request.result));
+		}
+	}
+
+	size_t ReadbackEngine::GetPooledBufferCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_buffer_pool.size();
+	}
+
+	ReadbackEngine::Future ReadbackEngine::push_request(std::shared_ptr<VMA::Buffer> buffer, VkDeviceSize size, VkExtent2D extent)
+	{
+		Request request;
+		request.result.m_data = static_cast<const std::byte*>(buffer->Access());
+		request.result.m_buffer = std::move(buffer);
+		request.result.m_size = size;
+		request.result.m_extent = extent;
+		auto future = request.promise.get_future();
+
+		std::scoped_lock guard{ m_mutex };
+		m_pending_requests[m_frame_index].emplace_back(std::move(request));
+		return future;
+	}
+
+	std::shared_ptr<VMA::Buffer> ReadbackEngine::acquire_buffer(VkDeviceSize size)
+	{
+		std::scoped_lock guard{ m_mutex };
+		std::shared_ptr<VMA::Buffer>* bestFit = nullptr;
+		for (auto& pooled_buffer : m_buffer_pool)
+		{
+			// Released by every result and not pending (Only the pool holds it)
+			if (pooled_buffer.use_count() != 1 || pooled_buffer->Size() < size) continue;
+			if (!bestFit || pooled_buffer->Size() < (*bestFit)->Size()) bestFit = &pooled_buffer;
+		}
+		if (bestFit) return *bestFit;
+
+		// Power-of-two sizes (at least 64KiB) keep the pool small
+		VkDeviceSize bufferSize = 64 * 1024;
+		while (bufferSize < size) bufferSize <<= 1;
+		auto& buffer = m_buffer_pool.emplace_back(m_context->m_memory_allocator->AllocateBuffer(bufferSize,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, false, true /*HOST_ACCESS_RANDOM*/, true));
+		if constexpr (EnableDebugMarkers)
+			buffer->SetDebugName(std::format("Readback Buffer ({} bytes)", bufferSize).c_str());
+		return buffer;
+	}
+
+	void ReadbackEngine::copy_image(CommandBuffer& command_buffer, VkImage image, VkImageAspectFlags aspect,
+		VkBuffer buffer, VkOffset2D offset, VkExtent2D extent)
+	{
+		VkBufferImageCopy copyRegion
+		{
+			.bufferOffset = 0,
+			.bufferRowLength = 0, // Tightly packed
+			.bufferImageHeight = 0,
+			.imageSubresource
+			{
+				.aspectMask = aspect,
+				.mipLevel = 0,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			},
+			.imageOffset = { offset.x, offset.y, 0 },
+			.imageExtent = { extent.width, extent.height, 1 }
+		};
+		command_buffer.GetDispatch().vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &copyRegion);
+	}
+
+	void ReadbackEngine::host_read_barrier(CommandBuffer& command_buffer, VkBuffer buffer)
+	{
+		command_buffer.QueueBarrier(VkBufferMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+				.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = buffer,
+				.offset = 0,
+				.size = VK_WHOLE_SIZE
+			}); // Flushed by End() or the next XXXCommand function
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <future>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// GPU -> CPU copies into a pool of host-cached buffers (HOST_ACCESS_RANDOM), resolved when the frame fence has signaled.
+	// Record into command buffers submitted to the graphics queue before FrameContext::EndFrame() of the same frame.
+	// Render targets read back every frame can skip the copy: VMA::AllocateHostReadableImage() is mapped by the host directly.
+	class ReadbackEngine
+	{
+	public:
+		// Mapped result of a completed readback (The buffer returns to the pool once every copy of the result is released)
+		class Result
+		{
+			friend class ReadbackEngine;
+		public:
+			std::span<const std::byte> GetData() const { return { m_data, static_cast<size_t>(m_size) }; }
+			template<typename T>
+			std::span<const T> As() const { return { reinterpret_cast<const T*>(m_data), static_cast<size_t>(m_size / sizeof(T)) }; }
+			VkExtent2D GetExtent() const { return m_extent; } // Image readbacks only (Tightly packed rows of 4-byte texels)
+
+		private:
+			std::shared_ptr<VMA::Buffer> m_buffer;
+			const std::byte* m_data = nullptr;
+			VkDeviceSize m_size = 0;
+			VkExtent2D m_extent{ 0, 0 };
+		};
+		using Future = std::future<Result>;
+
+		Future ReadBufferCommand(CommandBuffer& command_buffer, VMA::Buffer& source,
+			VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+		// Mip level 0 (4 bytes per texel like VMA::Image::WriteCommand()), the image is left in TRANSFER_SRC_OPTIMAL
+		Future ReadImageCommand(CommandBuffer& command_buffer, VMA::Image& source,
+			VkOffset2D offset = { 0, 0 }, VkExtent2D extent = { 0, 0 } /*Whole image*/);
+		// Current swap chain image in PRESENT_SRC_KHR, record it after the last pass (e.g. GPU picking of one texel or a capture)
+		Future CaptureCommand(CommandBuffer& command_buffer, VkOffset2D offset = { 0, 0 }, VkExtent2D extent = { 0, 0 });
+
+		// Called by FrameContext::BeginFrame() after the fence of the frame slot has signaled
+		void BeginFrame(uint32_t frame_index);
+		size_t GetPooledBufferCount();
+
+	public:
+		ReadbackEngine() = delete;
+		ReadbackEngine(std::shared_ptr<VulkanContext> vulkan_context, uint32_t frames_in_flight);
+		~ReadbackEngine(); // Pending requests are broken (std::future_error)
+		ReadbackEngine(const ReadbackEngine&) = delete;
+
+	private:
+		struct Request
+		{
+			Result result;
+			std::promise<Result> promise;
+		};
+		Future push_request(std::shared_ptr<VMA::Buffer> buffer, VkDeviceSize size, VkExtent2D extent);
+		std::shared_ptr<VMA::Buffer> acquire_buffer(VkDeviceSize size); // Smallest free pooled buffer that fits
+		void copy_image(CommandBuffer& command_buffer, VkImage image, VkImageAspectFlags aspect,
+			VkBuffer buffer, VkOffset2D offset, VkExtent2D extent);
+		static void host_read_barrier(CommandBuffer& command_buffer, VkBuffer buffer);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::mutex m_mutex;
+		uint32_t m_frame_index = 0;
+		std::vector<std::vector<Request>> m_pending_requests; // Per frame slot
+		std::vector<std::shared_ptr<VMA::Buffer>> m_buffer_pool; // Free if only the pool holds it
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,129 @@
+#include "vulkan_registry.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	// Live slots hold odd generations and released slots even ones, so 0 (Null) is never live even after wrapping
+
+	ResourceRegistry::ResourceRegistry(VulkanContext* vulkan_context, uint32_t buffer_capacity/* = 65536*/, uint32_t image_capacity/* = 16384*/) :
+		m_context{ vulkan_context }
+	{
+		initialize_slots(m_buffers, buffer_capacity);
+		m_buffers.buffers					= std::make_unique<VkBuffer[]>(buffer_capacity);
+		m_buffers.sizes						= std::make_unique<VkDeviceSize[]>(buffer_capacity);
+		m_buffers.device_addresses	= std::make_unique<VkDeviceAddress[]>(buffer_capacity);
+		m_buffers.owners					= std::make_unique<std::shared_ptr<VMA::Buffer>[]>(buffer_capacity);
+
+		initialize_slots(m_images, image_capacity);
+		m_images.images						= std::make_unique<VkImage[]>(image_capacity);
+		m_images.image_views			= std::make_unique<VkImageView[]>(image_capacity);
+		m_images.owners						= std::make_unique<std::shared_ptr<VMA::Image>[]>(image_capacity);
+	}
+
+	BufferHandle ResourceRegistry::Register(std::shared_ptr<VMA::Buffer> buffer)
+	{
+		assert(buffer && "Cannot register an empty buffer!");
+		std::scoped_lock guard{ m_mutex };
+		uint32_t index = acquire_slot(m_buffers, "Buffer");
+		m_buffers.owners[index] = std::move(buffer);
+		cache_buffer(index);
+		uint32_t generation = m_buffers.generations[index].load(std::memory_order_relaxed) + 1;
+		m_buffers.generations[index].store(generation, std::memory_order_release); // Publish the cached handles
+		return { .index = index, .generation = generation };
+	}
+
+	ImageHandle ResourceRegistry::Register(std::shared_ptr<VMA::Image> image)
+	{
+		assert(image && "Cannot register an empty image!");
+		std::scoped_lock guard{ m_mutex };
+		uint32_t index = acquire_slot(m_images, "Image");
+		m_images.owners[index] = std::move(image);
+		cache_image(index);
+		uint32_t generation = m_images.generations[index].load(std::memory_order_relaxed) + 1;
+		m_images.generations[index].store(generation, std::memory_order_release);
+		return { .index = index, .generation = generation };
+	}
+
+	void ResourceRegistry::Release(BufferHandle handle)
+	{
+		std::shared_ptr<VMA::Buffer> owner; // Dropped outside of the lock (The destructor defers its deletion)
+		{
+			std::scoped_lock guard{ m_mutex };
+			if (!IsValid(handle)) throw std::runtime_error("Failed to release the Buffer Handle - It is stale or null!");
+			m_buffers.generations[handle.index].store(handle.generation + 1, std::memory_order_release);
+			owner = std::move(m_buffers.owners[handle.index]);
+			release_slot(m_buffers, handle.index);
+		}
+	}
+
+	void ResourceRegistry::Release(ImageHandle handle)
+	{
+		std::shared_ptr<VMA::Image> owner;
+		{
+			std::scoped_lock guard{ m_mutex };
+			if (!IsValid(handle)) throw std::runtime_error("Failed to release the Image Handle - It is stale or null!");
+			m_images.generations[handle.index].store(handle.generation + 1, std::memory_order_release);
+			owner = std::move(m_images.owners[handle.index]);
+			release_slot(m_images, handle.index);
+		}
+	}
+
+	void ResourceRegistry::Update(BufferHandle handle)
+	{
+		assert(IsValid(handle) && "Stale Buffer Handle!");
+		cache_buffer(handle.index);
+	}
+
+	void ResourceRegistry::Update(ImageHandle handle)
+	{
+		assert(IsValid(handle) && "Stale Image Handle!");
+		cache_image(handle.index);
+	}
+
+	void ResourceRegistry::initialize_slots(SlotAllocator& slots, uint32_t capacity)
+	{
+		slots.capacity = capacity;
+		slots.generations = std::make_unique<std::atomic<uint32_t>[]>(capacity); // Value-initialized: 0 (Released)
+	}
+
+	uint32_t ResourceRegistry::acquire_slot(SlotAllocator& slots, const char* resource)
+	{
+		uint32_t index;
+		if (!slots.free_list.empty())
+		{
+			index = slots.free_list.back();
+			slots.free_list.pop_back();
+		}
+		else
+		{
+			if (slots.next >= slots.capacity)
+				throw std::runtime_error(std::format("Failed to register the Vulkan {} - The Resource Registry is full ({} slots)!", resource, slots.capacity));
+			index = slots.next++;
+		}
+		slots.count.fetch_add(1, std::memory_order_relaxed);
+		return index;
+	}
+
+	void ResourceRegistry::release_slot(SlotAllocator& slots, uint32_t index)
+	{
+		slots.free_list.emplace_back(index);
+		slots.count.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void ResourceRegistry::cache_buffer(uint32_t index)
+	{
+		auto& buffer = *m_buffers.owners[index];
+		m_buffers.buffers[index] = buffer.m_buffer;
+		m_buffers.sizes[index] = buffer.m_buffer_size;
+		m_buffers.device_addresses[index] = (buffer.m_buffer_usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)? buffer.DeviceAddress() : 0;
+	}
+
+	void ResourceRegistry::cache_image(uint32_t index)
+	{
+		auto& image = *m_images.owners[index];
+		m_images.images[index] = image.m_image;
+		m_images.image_views[index] = image.GetImageView();
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <mutex>
+#include <atomic>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Generational handle of a ResourceRegistry slot (POD: Copy and compare it freely, no reference counting)
+	// A released slot bumps its generation, so stale handles are detected instead of aliasing the next resource.
+	template<typename Tag>
+	struct ResourceHandle
+	{
+		uint32_t index = 0;
+		uint32_t generation = 0; // 0: Null
+
+		bool IsNull() const { return generation == 0; }
+		explicit operator bool() const { return !IsNull(); }
+		bool operator==(const ResourceHandle&) const = default;
+	};
+	using BufferHandle = ResourceHandle<struct BufferHandleTag>;
+	using ImageHandle  = ResourceHandle<struct ImageHandleTag>;
+
+	// Resource Registry (VulkanContext::GetResourceRegistry())
+	// Fixed-capacity SoA pools of the hot Vulkan handles, so per-call lookups are an index and a generation check
+	// instead of a shared_ptr copy and a pointer chase. The registry owns a reference to every registered resource until released.
+	class ResourceRegistry
+	{
+	public:
+		// Register & Release are thread-safe. The slot must not be used by in-flight command buffers when released
+		// (The resource itself is destroyed by the deletion queue once its last reference is gone).
+		BufferHandle Register(std::shared_ptr<VMA::Buffer> buffer);
+		ImageHandle  Register(std::shared_ptr<VMA::Image> image);
+		void Release(BufferHandle handle);
+		void Release(ImageHandle handle);
+		// Re-read the cached handles after the resource was moved (Call it in the on_moved of EnableDefragmentation())
+		void Update(BufferHandle handle);
+		void Update(ImageHandle handle);
+
+		// Lock-free lookups (Must not race with releasing the same handle)
+		bool IsValid(BufferHandle handle) const { return handle && handle.index < m_buffers.capacity && m_buffers.generations[handle.index].load(std::memory_order_acquire) == handle.generation; }
+		bool IsValid(ImageHandle handle) const  { return handle && handle.index < m_images.capacity  && m_images.generations[handle.index].load(std::memory_order_acquire) == handle.generation; }
+		VkBuffer				GetBuffer(BufferHandle handle) const				{ assert(IsValid(handle) && "Stale Buffer Handle!"); return m_buffers.buffers[handle.index]; }
+		VkDeviceSize		GetSize(BufferHandle handle) const					{ assert(IsValid(handle) && "Stale Buffer Handle!"); return m_buffers.sizes[handle.index]; }
+		VkDeviceAddress	GetDeviceAddress(BufferHandle handle) const	{ assert(IsValid(handle) && "Stale Buffer Handle!"); return m_buffers.device_addresses[handle.index]; } // 0 without SHADER_DEVICE_ADDRESS usage
+		VkImage				GetImage(ImageHandle handle) const					{ assert(IsValid(handle) && "Stale Image Handle!"); return m_images.images[handle.index]; }
+		VkImageView		GetImageView(ImageHandle handle) const			{ assert(IsValid(handle) && "Stale Image Handle!"); return m_images.image_views[handle.index]; }
+		// The owning objects (Cold path: transitions, copies, state tracking)
+		VMA::Buffer&		Resolve(BufferHandle handle) const				{ assert(IsValid(handle) && "Stale Buffer Handle!"); return *m_buffers.owners[handle.index]; }
+		VMA::Image&			Resolve(ImageHandle handle) const					{ assert(IsValid(handle) && "Stale Image Handle!"); return *m_images.owners[handle.index]; }
+
+		uint32_t GetBufferCapacity() const { return m_buffers.capacity; }
+		uint32_t GetImageCapacity() const { return m_images.capacity; }
+		uint32_t GetBufferCount() const { return m_buffers.count.load(std::memory_order_relaxed); }
+		uint32_t GetImageCount() const { return m_images.count.load(std::memory_order_relaxed); }
+
+	public:
+		ResourceRegistry() = delete;
+		ResourceRegistry(VulkanContext* vulkan_context, uint32_t buffer_capacity = 65536, uint32_t image_capacity = 16384);
+		ResourceRegistry(const ResourceRegistry&) = delete;
+
+	private:
+		// Arrays are allocated once and never reallocated, so lookups need no lock
+		struct SlotAllocator
+		{
+			uint32_t capacity = 0;
+			uint32_t next = 0;
+			std::vector<uint32_t> free_list; // Recycled indices
+			std::unique_ptr<std::atomic<uint32_t>[]> generations;
+			std::atomic<uint32_t> count{ 0 };
+		};
+		struct BufferPool : SlotAllocator
+		{
+			std::unique_ptr<VkBuffer[]>				buffers;
+			std::unique_ptr<VkDeviceSize[]>		sizes;
+			std::unique_ptr<VkDeviceAddress[]>	device_addresses;
+			std::unique_ptr<std::shared_ptr<VMA::Buffer>[]> owners; // Cold
+		};
+		struct ImagePool : SlotAllocator
+		{
+			std::unique_ptr<VkImage[]>			images;
+			std::unique_ptr<VkImageView[]>	image_views;
+			std::unique_ptr<std::shared_ptr<VMA::Image>[]> owners; // Cold
+		};
+		static void initialize_slots(SlotAllocator& slots, uint32_t capacity);
+		static uint32_t acquire_slot(SlotAllocator& slots, const char* resource);
+		static void release_slot(SlotAllocator& slots, uint32_t index);
+		void cache_buffer(uint32_t index);
+		void cache_image(uint32_t index);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		std::mutex m_mutex; // Register & Release
+		BufferPool m_buffers;
+		ImagePool m_images;
+	};
+
+}} // namespace Albedo::RHI
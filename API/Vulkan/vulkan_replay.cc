@@ -0,0 +1,551 @@
+#include "vulkan_replay.h"
+#include "vulkan_context.h"
+
+#include <chrono>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr VkDeviceSize PROXY_BUFFER_SIZE = 64 * 1024;
+		constexpr uint32_t MAX_PROXY_ELEMENTS = 1024; // Of one binding (Larger arrays are partially written)
+
+		template<typename VulkanHandle>
+		uint64_t handle_key(VulkanHandle handle) { return (uint64_t)handle; }
+
+		size_t get_bind_point_slot(VkPipelineBindPoint bind_point) { return bind_point == VK_PIPELINE_BIND_POINT_COMPUTE ? 1 : 0; }
+
+		// Descriptor types written with proxies (Acceleration structures and inline uniform blocks have no proxy)
+		bool is_proxy_descriptor(VkDescriptorType descriptor_type)
+		{
+			switch (descriptor_type)
+			{
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		bool is_replayable(const PipelineTrace::Record& record)
+		{
+			constexpr VkDescriptorSetLayoutCreateFlags UNSUPPORTED_FLAGS =
+				VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR | VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+			return std::all_of(record.set_layouts.begin(), record.set_layouts.end(), [](const auto& set_layout)
+				{
+					return !(set_layout.flags & UNSUPPORTED_FLAGS) && std::all_of(set_layout.bindings.begin(), set_layout.bindings.end(),
+						[](const auto& binding) { return is_proxy_descriptor(binding.descriptorType); });
+				});
+		}
+
+		VMA::ImageType get_image_type(const VkImageCreateInfo& create_info)
+		{
+			if (create_info.imageType == VK_IMAGE_TYPE_3D) return VMA::ImageType::IMAGE_3D;
+			if (create_info.flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT)
+				return create_info.arrayLayers > 6 ? VMA::ImageType::IMAGE_CUBE_ARRAY : VMA::ImageType::IMAGE_CUBE;
+			return create_info.arrayLayers > 1 ? VMA::ImageType::IMAGE_2D_ARRAY : VMA::ImageType::IMAGE_2D;
+		}
+	} // namespace
+
+	CommandReplay::CommandReplay(std::shared_ptr<VulkanContext> vulkan_context, std::string_view capture_file) :
+		m_context{ std::move(vulkan_context) },
+		m_descriptor_allocator{ m_context->CreateDescriptorAllocator() }
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::PrepareReplay");
+		const auto capture = CommandCapture::Load(capture_file);
+		create_proxies();
+
+		std::vector<std::shared_ptr<VMA::Buffer>> zeroedBuffers{ m_proxy_buffer };
+		CaptureReader packets{ capture };
+		CaptureReader payload;
+		Frame frame;
+		while (!packets.IsEnd())
+		{
+			switch (packets.Next(payload))
+			{
+			case CaptureOpcode::CREATE_BUFFER:
+				if (auto buffer = create_buffer(payload)) zeroedBuffers.emplace_back(std::move(buffer));
+				break;
+			case CaptureOpcode::CREATE_IMAGE:
+				create_image(payload);
+				break;
+			case CaptureOpcode::CREATE_PIPELINE:
+				create_pipeline(payload);
+				break;
+			case CaptureOpcode::SUBMIT:
+			{
+				CaptureReader commands{ payload.ReadBytes(payload.Read<uint32_t>()) };
+				frame.emplace_back(prepare_submission(commands));
+				break;
+			}
+			case CaptureOpcode::FRAME:
+				m_frames.emplace_back(std::move(frame));
+				frame = {};
+				break;
+			default:
+				throw std::runtime_error(std::format("Failed to prepare the command replay {} - Commands outside of a submission!", capture_file));
+			}
+		}
+		if (!frame.empty()) m_frames.emplace_back(std::move(frame)); // Submissions after the last frame
+
+		// Zeroed contents (Proxies of the captured data)
+		auto commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_graphics);
+		commandBuffer->Begin();
+		for (auto& buffer : zeroedBuffers) commandBuffer->GetDispatch().vkCmdFillBuffer(*commandBuffer, *buffer, 0, VK_WHOLE_SIZE, 0);
+		const VkClearColorValue clearColor{};
+		const VkImageSubresourceRange wholeRange{ .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .levelCount = 1, .layerCount = 1 };
+		commandBuffer->GetDispatch().vkCmdClearColorImage(*commandBuffer, *m_proxy_image, VK_IMAGE_LAYOUT_GENERAL, &clearColor, 1, &wholeRange);
+		commandBuffer->PipelineBarrier({}, {}, { VkMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+				.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT
+			} });
+		commandBuffer->End();
+		commandBuffer->Submit(true);
+
+		log::info("Prepared the command replay {} ({} frames, {} buffers, {} images, {} pipelines, {} commands - Skipped {} pipelines and {} commands)",
+			capture_file, m_frames.size(), m_statistics.buffers, m_statistics.images, m_statistics.pipelines, m_statistics.commands,
+			m_statistics.skipped_pipelines, m_statistics.skipped_commands);
+	}
+
+	CommandReplay::~CommandReplay()
+	{
+		m_context->WaitDeviceIdle();
+		for (auto pipeline : m_owned_pipelines) vkDestroyPipeline(m_context->m_device, pipeline, m_context->m_memory_allocation_callback);
+		if (m_proxy_texel_view != VK_NULL_HANDLE) vkDestroyBufferView(m_context->m_device, m_proxy_texel_view, m_context->m_memory_allocation_callback);
+	}
+
+	std::vector<double> CommandReplay::Run(uint32_t iterations/* = 1*/)
+	{
+		std::vector<double> frameTimes;
+		frameTimes.reserve(size_t{ iterations } * m_frames.size());
+		for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+		{
+			for (const auto& frame : m_frames)
+			{
+				ALBEDO_RHI_TRACE_ZONE("RHI::ReplayFrame");
+				const auto begin = std::chrono::steady_clock::now();
+				QueueTimeline* submittedTimeline = nullptr;
+				uint64_t submittedTick = 0;
+				for (const auto& submission : frame)
+				{
+					auto commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_graphics);
+					commandBuffer->Begin();
+					for (const auto& command : submission) command(*commandBuffer);
+					commandBuffer->End();
+					submittedTick = commandBuffer->SubmitTick();
+					submittedTimeline = &commandBuffer->GetSubmittedQueueTimeline();
+				}
+				if (submittedTimeline) submittedTimeline->Wait(submittedTick); // Submissions of one queue complete in order
+				frameTimes.emplace_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+				m_context->CollectDeletions(); // Frame boundary without a FrameContext (Outside the timing)
+			}
+		}
+		return frameTimes;
+	}
+
+	void CommandReplay::create_proxies()
+	{
+		auto& allocator = *m_context->m_memory_allocator;
+		m_proxy_buffer = allocator.AllocateBuffer(PROXY_BUFFER_SIZE,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+			VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT |
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+		VkBufferViewCreateInfo bufferViewCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,
+			.buffer = *m_proxy_buffer,
+			.format = VK_FORMAT_R32_UINT, // Texel buffer features are mandatory
+			.offset = 0,
+			.range = VK_WHOLE_SIZE
+		};
+		if (vkCreateBufferView(m_context->m_device, &bufferViewCreateInfo, m_context->m_memory_allocation_callback, &m_proxy_texel_view) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the proxy texel buffer view of the command replay!");
+
+		m_proxy_image = allocator.AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, 1, 1, 4, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_GENERAL);
+		m_proxy_sampler = m_context->CreateSampler({});
+	}
+
+	std::shared_ptr<VMA::Buffer> CommandReplay::create_buffer(CaptureReader& payload)
+	{
+		const auto buffer = payload.Read<VkBuffer>();
+		const auto size = payload.Read<VkDeviceSize>();
+		const auto usage = payload.Read<VkBufferUsageFlags>();
+		if (size == 0) return nullptr;
+		auto& replayBuffer = m_buffers[handle_key(buffer)];
+		replayBuffer = m_context->m_memory_allocator->AllocateBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		++m_statistics.buffers;
+		return replayBuffer;
+	}
+
+	void CommandReplay::create_image(CaptureReader& payload)
+	{
+		payload.Read<VkImage>(); // Never referenced by commands
+		const auto createInfo = payload.Read<VkImageCreateInfo>();
+		const auto imageType = get_image_type(createInfo);
+		m_images.emplace_back(m_context->m_memory_allocator->AllocateImage(GetFormatAspect(createInfo.format), createInfo.usage,
+			createInfo.extent.width, createInfo.extent.height, 4, createInfo.format, VK_IMAGE_LAYOUT_UNDEFINED, createInfo.tiling,
+			createInfo.mipLevels, VMA::MemoryPool::GENERAL, imageType,
+			(imageType == VMA::ImageType::IMAGE_3D) ? createInfo.extent.depth : createInfo.arrayLayers, createInfo.samples));
+		++m_statistics.images;
+	}
+
+	void CommandReplay::create_pipeline(CaptureReader& payload)
+	{
+		const auto pipeline = payload.Read<VkPipeline>();
+		const auto pipelineLayout = payload.Read<VkPipelineLayout>();
+		const auto record = PipelineTrace::Deserialize(payload.ReadBytes(payload.Read<uint32_t>()));
+		std::optional<PipelineTrace::Compiled> compiled;
+		if (is_replayable(record)) compiled = PipelineTrace::Compile(*m_context, record);
+		if (!compiled)
+		{
+			m_pipelines.erase(handle_key(pipeline)); // Binding it skips the commands
+			++m_statistics.skipped_pipelines;
+			return;
+		}
+		m_owned_pipelines.emplace_back(compiled->pipeline);
+		m_pipelines[handle_key(pipeline)] = compiled->pipeline;
+		m_layouts[handle_key(pipelineLayout)] = ReplayLayout{ .pipeline_layout = std::move(compiled->pipeline_layout), .set_layouts = std::move(compiled->set_layouts) };
+		++m_statistics.pipelines;
+	}
+
+	CommandReplay::Submission CommandReplay::prepare_submission(CaptureReader& commands)
+	{
+		Submission submission;
+		std::array<bool, 2> hasPipelines{}; // [Graphics, Compute] Bound and replayed
+		bool isRendering = false;
+		auto record = [&](Command command) { submission.emplace_back(std::move(command)); ++m_statistics.commands; };
+		auto skip = [this]() { ++m_statistics.skipped_commands; };
+		auto findBuffer = [this](VkBuffer buffer) -> std::shared_ptr<VMA::Buffer>
+		{
+			auto target = m_buffers.find(handle_key(buffer));
+			return (target != m_buffers.end()) ? target->second : nullptr;
+		};
+		auto findLayout = [this](VkPipelineLayout layout) -> const ReplayLayout*
+		{
+			auto target = m_layouts.find(handle_key(layout));
+			return (target != m_layouts.end()) ? &target->second : nullptr;
+		};
+
+		CaptureReader payload;
+		while (!commands.IsEnd())
+		{
+			const auto opcode = commands.Next(payload);
+			switch (opcode)
+			{
+			case CaptureOpcode::BIND_PIPELINE:
+			{
+				const auto bindPoint = payload.Read<VkPipelineBindPoint>();
+				auto target = m_pipelines.find(handle_key(payload.Read<VkPipeline>()));
+				hasPipelines[get_bind_point_slot(bindPoint)] = (target != m_pipelines.end());
+				if (target == m_pipelines.end()) { skip(); break; }
+				record([bindPoint, pipeline = target->second](CommandBuffer& command_buffer) { command_buffer.GetDispatch().vkCmdBindPipeline(command_buffer, bindPoint, pipeline); });
+				break;
+			}
+			case CaptureOpcode::BIND_DESCRIPTOR_SETS:
+			{
+				const auto bindPoint = payload.Read<VkPipelineBindPoint>();
+				const auto* layout = findLayout(payload.Read<VkPipelineLayout>());
+				const auto firstSet = payload.Read<uint32_t>();
+				const auto descriptorSets = payload.ReadArray<VkDescriptorSet>();
+				const std::vector<uint32_t> dynamicOffsets(payload.ReadArray<uint32_t>().size(), 0); // In range of the proxy buffer
+				if (!layout || firstSet + descriptorSets.size() > layout->set_layouts.size()) { skip(); break; }
+				std::vector<VkDescriptorSet> proxySets;
+				for (size_t i = 0; i < descriptorSets.size(); ++i) proxySets.emplace_back(get_proxy_set(layout->set_layouts[firstSet + i]));
+				record([bindPoint, pipelineLayout = layout->pipeline_layout, firstSet, proxySets = std::move(proxySets), dynamicOffsets](CommandBuffer& command_buffer)
+					{
+						command_buffer.GetDispatch().vkCmdBindDescriptorSets(command_buffer, bindPoint, *pipelineLayout, firstSet,
+							static_cast<uint32_t>(proxySets.size()), proxySets.data(), static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+					});
+				break;
+			}
+			case CaptureOpcode::BIND_VERTEX_BUFFERS:
+			{
+				const auto firstBinding = payload.Read<uint32_t>();
+				const auto buffers = payload.ReadArray<VkBuffer>();
+				auto offsets = payload.ReadArray<VkDeviceSize>();
+				std::vector<std::shared_ptr<VMA::Buffer>> replayBuffers;
+				std::vector<VkBuffer> handles;
+				for (size_t i = 0; i < buffers.size(); ++i)
+				{
+					auto& replayBuffer = replayBuffers.emplace_back(findBuffer(buffers[i]));
+					if (!replayBuffer) { replayBuffer = m_proxy_buffer; offsets[i] = 0; }
+					handles.emplace_back(*replayBuffer);
+				}
+				record([firstBinding, replayBuffers = std::move(replayBuffers), handles = std::move(handles), offsets = std::move(offsets)](CommandBuffer& command_buffer)
+					{ command_buffer.GetDispatch().vkCmdBindVertexBuffers(command_buffer, firstBinding, static_cast<uint32_t>(handles.size()), handles.data(), offsets.data()); });
+				break;
+			}
+			case CaptureOpcode::BIND_INDEX_BUFFER:
+			{
+				auto replayBuffer = findBuffer(payload.Read<VkBuffer>());
+				auto offset = payload.Read<VkDeviceSize>();
+				const auto indexType = payload.Read<VkIndexType>();
+				if (!replayBuffer) { replayBuffer = m_proxy_buffer; offset = 0; }
+				record([replayBuffer = std::move(replayBuffer), offset, indexType](CommandBuffer& command_buffer)
+					{ command_buffer.GetDispatch().vkCmdBindIndexBuffer(command_buffer, *replayBuffer, offset, indexType); });
+				break;
+			}
+			case CaptureOpcode::PUSH_CONSTANTS:
+			{
+				const auto* layout = findLayout(payload.Read<VkPipelineLayout>());
+				const auto stages = payload.Read<VkShaderStageFlags>();
+				const auto offset = payload.Read<uint32_t>();
+				auto data = payload.ReadArray<uint8_t>();
+				if (!layout) { skip(); break; }
+				record([pipelineLayout = layout->pipeline_layout, stages, offset, data = std::move(data)](CommandBuffer& command_buffer)
+					{ command_buffer.GetDispatch().vkCmdPushConstants(command_buffer, *pipelineLayout, stages, offset, static_cast<uint32_t>(data.size()), data.data()); });
+				break;
+			}
+			case CaptureOpcode::DRAW:
+			case CaptureOpcode::DRAW_INDEXED:
+			case CaptureOpcode::DRAW_INDIRECT:
+			case CaptureOpcode::DRAW_INDIRECT_COUNT:
+			case CaptureOpcode::DRAW_MULTI:
+			case CaptureOpcode::DRAW_MULTI_INDEXED:
+			{
+				if (!isRendering || !hasPipelines[0]) { skip(); break; }
+				if (opcode == CaptureOpcode::DRAW)
+				{
+					const auto draw = payload.Read<std::array<uint32_t, 4>>();
+					record([draw](CommandBuffer& command_buffer) { command_buffer.Draw(draw[0], draw[1], draw[2], draw[3]); });
+				}
+				else if (opcode == CaptureOpcode::DRAW_INDEXED)
+				{
+					const auto indexCount = payload.Read<uint32_t>();
+					const auto instanceCount = payload.Read<uint32_t>();
+					const auto firstIndex = payload.Read<uint32_t>();
+					const auto vertexOffset = payload.Read<int32_t>();
+					const auto firstInstance = payload.Read<uint32_t>();
+					record([=](CommandBuffer& command_buffer) { command_buffer.DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance); });
+				}
+				else if (opcode == CaptureOpcode::DRAW_INDIRECT)
+				{
+					auto replayBuffer = findBuffer(payload.Read<VkBuffer>());
+					const auto offset = payload.Read<VkDeviceSize>();
+					const auto drawCount = payload.Read<uint32_t>();
+					const auto stride = payload.Read<uint32_t>();
+					const auto indexed = payload.Read<bool>();
+					if (!replayBuffer) { skip(); break; }
+					record([replayBuffer = std::move(replayBuffer), offset, drawCount, stride, indexed](CommandBuffer& command_buffer)
+						{ command_buffer.DrawIndirect(*replayBuffer, offset, drawCount, stride, indexed); });
+				}
+				else if (opcode == CaptureOpcode::DRAW_INDIRECT_COUNT)
+				{
+					auto replayBuffer = findBuffer(payload.Read<VkBuffer>());
+					const auto offset = payload.Read<VkDeviceSize>();
+					auto countBuffer = findBuffer(payload.Read<VkBuffer>());
+					const auto countOffset = payload.Read<VkDeviceSize>();
+					const auto maxDrawCount = payload.Read<uint32_t>();
+					const auto stride = payload.Read<uint32_t>();
+					const auto indexed = payload.Read<bool>();
+					if (!replayBuffer || !countBuffer) { skip(); break; }
+					record([replayBuffer = std::move(replayBuffer), offset, countBuffer = std::move(countBuffer), countOffset, maxDrawCount, stride, indexed](CommandBuffer& command_buffer)
+						{ command_buffer.DrawIndirectCount(*replayBuffer, offset, *countBuffer, countOffset, maxDrawCount, stride, indexed); });
+				}
+				else if (opcode == CaptureOpcode::DRAW_MULTI)
+				{
+					const auto instanceCount = payload.Read<uint32_t>();
+					const auto firstInstance = payload.Read<uint32_t>();
+					auto draws = payload.ReadArray<VkMultiDrawInfoEXT>();
+					record([instanceCount, firstInstance, draws = std::move(draws)](CommandBuffer& command_buffer)
+						{ command_buffer.DrawMulti(draws, instanceCount, firstInstance); });
+				}
+				else
+				{
+					const auto instanceCount = payload.Read<uint32_t>();
+					const auto firstInstance = payload.Read<uint32_t>();
+					auto draws = payload.ReadArray<VkMultiDrawIndexedInfoEXT>();
+					record([instanceCount, firstInstance, draws = std::move(draws)](CommandBuffer& command_buffer)
+						{ command_buffer.DrawMultiIndexed(draws, instanceCount, firstInstance); });
+				}
+				break;
+			}
+			case CaptureOpcode::DISPATCH:
+			{
+				const auto groupCounts = payload.Read<std::array<uint32_t, 3>>();
+				if (isRendering || !hasPipelines[1]) { skip(); break; }
+				record([groupCounts](CommandBuffer& command_buffer) { command_buffer.Dispatch(groupCounts[0], groupCounts[1], groupCounts[2]); });
+				break;
+			}
+			case CaptureOpcode::BARRIER:
+			{
+				const auto memoryBarrier = payload.Read<VkMemoryBarrier2>();
+				record([memoryBarrier](CommandBuffer& command_buffer) { command_buffer.PipelineBarrier({}, {}, { memoryBarrier }); });
+				break;
+			}
+			case CaptureOpcode::COPY_BUFFER:
+			{
+				auto source = findBuffer(payload.Read<VkBuffer>());
+				auto destination = findBuffer(payload.Read<VkBuffer>());
+				auto regions = payload.ReadArray<VkBufferCopy>();
+				if (!source || !destination) { skip(); break; }
+				record([source = std::move(source), destination = std::move(destination), regions = std::move(regions)](CommandBuffer& command_buffer)
+					{ command_buffer.GetDispatch().vkCmdCopyBuffer(command_buffer, *source, *destination, static_cast<uint32_t>(regions.size()), regions.data()); });
+				break;
+			}
+			case CaptureOpcode::SET_VIEWPORTS:
+			{
+				auto viewports = payload.ReadArray<VkViewport>();
+				record([viewports = std::move(viewports)](CommandBuffer& command_buffer)
+					{ command_buffer.GetDispatch().vkCmdSetViewportWithCount(command_buffer, static_cast<uint32_t>(viewports.size()), viewports.data()); });
+				break;
+			}
+			case CaptureOpcode::SET_SCISSORS:
+			{
+				auto scissors = payload.ReadArray<VkRect2D>();
+				record([scissors = std::move(scissors)](CommandBuffer& command_buffer)
+					{ command_buffer.GetDispatch().vkCmdSetScissorWithCount(command_buffer, static_cast<uint32_t>(scissors.size()), scissors.data()); });
+				break;
+			}
+			case CaptureOpcode::SET_STATE:
+			{
+				const auto state = payload.Read<CaptureState>();
+				const auto values = payload.Read<std::array<uint32_t, 5>>();
+				if (state > CaptureState::STENCIL_OP) throw std::runtime_error("Invalid dynamic state of the command capture!");
+				record([state, values](CommandBuffer& command_buffer)
+					{
+						switch (state)
+						{
+						case CaptureState::CULL_MODE:						command_buffer.GetDispatch().vkCmdSetCullMode(command_buffer, values[0]); break;
+						case CaptureState::FRONT_FACE:					command_buffer.GetDispatch().vkCmdSetFrontFace(command_buffer, static_cast<VkFrontFace>(values[0])); break;
+						case CaptureState::PRIMITIVE_TOPOLOGY:		command_buffer.GetDispatch().vkCmdSetPrimitiveTopology(command_buffer, static_cast<VkPrimitiveTopology>(values[0])); break;
+						case CaptureState::DEPTH_TEST_ENABLE:		command_buffer.GetDispatch().vkCmdSetDepthTestEnable(command_buffer, values[0]); break;
+						case CaptureState::DEPTH_WRITE_ENABLE:		command_buffer.GetDispatch().vkCmdSetDepthWriteEnable(command_buffer, values[0]); break;
+						case CaptureState::DEPTH_COMPARE_OP:		command_buffer.GetDispatch().vkCmdSetDepthCompareOp(command_buffer, static_cast<VkCompareOp>(values[0])); break;
+						case CaptureState::STENCIL_TEST_ENABLE:	command_buffer.GetDispatch().vkCmdSetStencilTestEnable(command_buffer, values[0]); break;
+						case CaptureState::STENCIL_OP:
+							command_buffer.GetDispatch().vkCmdSetStencilOp(command_buffer, values[0], static_cast<VkStencilOp>(values[1]), static_cast<VkStencilOp>(values[2]),
+								static_cast<VkStencilOp>(values[3]), static_cast<VkCompareOp>(values[4]));
+							break;
+						}
+					});
+				break;
+			}
+			case CaptureOpcode::BEGIN_RENDERING:
+			{
+				const auto renderArea = payload.Read<VkRect2D>();
+				const auto samples = payload.Read<VkSampleCountFlagBits>();
+				const auto colorFormats = payload.ReadArray<VkFormat>();
+				const auto depthFormat = payload.Read<VkFormat>();
+				const auto stencilFormat = payload.Read<VkFormat>();
+				// Proxy attachments covering the render area, never loaded
+				const VkExtent2D extent{ renderArea.offset.x + renderArea.extent.width, renderArea.offset.y + renderArea.extent.height };
+				auto attachment = [&](VkFormat format, VkImageLayout layout)
+				{
+					return VkRenderingAttachmentInfo
+					{
+						.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+						.imageView = get_proxy_attachment(format, extent, samples),
+						.imageLayout = layout,
+						.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+						.storeOp = VK_ATTACHMENT_STORE_OP_STORE
+					};
+				};
+				std::vector<VkRenderingAttachmentInfo> colors;
+				for (auto format : colorFormats) colors.emplace_back(attachment(format, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+				std::optional<VkRenderingAttachmentInfo> depth, stencil;
+				if (depthFormat != VK_FORMAT_UNDEFINED) depth = attachment(depthFormat, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+				if (stencilFormat != VK_FORMAT_UNDEFINED) stencil = attachment(stencilFormat, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+				isRendering = true;
+				record([renderArea, colors = std::move(colors), depth, stencil](CommandBuffer& command_buffer)
+					{
+						VkRenderingInfo renderingInfo
+						{
+							.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+							.renderArea = renderArea,
+							.layerCount = 1,
+							.colorAttachmentCount = static_cast<uint32_t>(colors.size()),
+							.pColorAttachments = colors.data(),
+							.pDepthAttachment = depth.has_value() ? &depth.value() : nullptr,
+							.pStencilAttachment = stencil.has_value() ? &stencil.value() : nullptr
+						};
+						command_buffer.GetDispatch().vkCmdBeginRendering(command_buffer, &renderingInfo);
+					});
+				break;
+			}
+			case CaptureOpcode::END_RENDERING:
+				isRendering = false;
+				record([](CommandBuffer& command_buffer) { command_buffer.GetDispatch().vkCmdEndRendering(command_buffer); });
+				break;
+			default:
+				throw std::runtime_error("Invalid command of the command capture!");
+			}
+		}
+		if (isRendering) throw std::runtime_error("Invalid submission of the command capture - Rendering was not ended!");
+		return submission;
+	}
+
+	VkDescriptorSet CommandReplay::get_proxy_set(const std::shared_ptr<DescriptorSetLayout>& set_layout)
+	{
+		auto& proxySet = m_proxy_sets[set_layout.get()];
+		if (proxySet) return *proxySet;
+
+		proxySet = m_descriptor_allocator->AllocateDescriptorSet(set_layout);
+		DescriptorWriteBatch writes{ m_context };
+		for (const auto& binding : set_layout->GetBindings())
+		{
+			const bool hasImmutableSamplers = set_layout->HasImmutableSamplers(binding.binding);
+			if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER && hasImmutableSamplers) continue;
+			const VkSampler sampler = hasImmutableSamplers ? VK_NULL_HANDLE : static_cast<VkSampler>(*m_proxy_sampler);
+			const VkDeviceSize range = (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) ?
+				std::min<VkDeviceSize>(PROXY_BUFFER_SIZE, m_context->m_physical_device_properties.limits.maxUniformBufferRange) : PROXY_BUFFER_SIZE;
+			for (uint32_t element = 0; element < std::min(binding.descriptorCount, MAX_PROXY_ELEMENTS); ++element)
+			{
+				switch (binding.descriptorType)
+				{
+				case VK_DESCRIPTOR_TYPE_SAMPLER:
+				case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+				case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+				case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+				case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+					writes.WriteImage(*proxySet, binding.descriptorType, binding.binding,
+						(binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER) ? VK_NULL_HANDLE : m_proxy_image->GetImageView(),
+						VK_IMAGE_LAYOUT_GENERAL, sampler, element);
+					break;
+				case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+				case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+					writes.WriteTexelBuffer(*proxySet, binding.descriptorType, binding.binding, m_proxy_texel_view, element);
+					break;
+				default: // Buffers (See is_proxy_descriptor())
+					writes.WriteBuffer(*proxySet, binding.descriptorType, binding.binding, *m_proxy_buffer, 0, range, element);
+					break;
+				}
+			}
+		}
+		writes.Flush();
+		return *proxySet;
+	}
+
+	VkImageView CommandReplay::get_proxy_attachment(VkFormat format, VkExtent2D extent, VkSampleCountFlagBits samples)
+	{
+		auto& proxyAttachment = m_proxy_attachments[HashWords(format, extent.width, extent.height, samples)];
+		if (!proxyAttachment)
+		{
+			const auto aspect = GetFormatAspect(format);
+			const bool isColor = aspect & VK_IMAGE_ASPECT_COLOR_BIT;
+			proxyAttachment = m_context->m_memory_allocator->AllocateImage(aspect,
+				isColor ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT : VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, extent.width, extent.height, 4, format,
+				isColor ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_TILING_OPTIMAL, 1,
+				VMA::MemoryPool::RENDER_TARGET, VMA::ImageType::IMAGE_2D, 1, samples);
+		}
+		return proxyAttachment->GetImageView();
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Command Replay: Re-executes a CommandCapture on this device (Same build and shaders) and times every frame, e.g. AlbedoRHI_replay
+	// in CI to catch CPU or GPU regressions of a captured workload without the application. Buffers and images are recreated with their
+	// captured sizes, pipelines are compiled from their records. Descriptor sets and attachments are proxies with zeroed contents
+	// (One set per layout, 2D images in GENERAL layout), so indirect arguments are zero and barriers are global memory barriers.
+	// Commands whose pipeline or buffer was not captured are skipped (See GetStatistics()).
+	class CommandReplay
+	{
+	public:
+		// Every frame of the capture per iteration, returns the wall time of each replayed frame in milliseconds (Submitted and waited)
+		std::vector<double> Run(uint32_t iterations = 1);
+		uint32_t GetFrameCount() const { return static_cast<uint32_t>(m_frames.size()); }
+
+		struct Statistics
+		{
+			uint32_t buffers = 0;
+			uint32_t images = 0;
+			uint32_t pipelines = 0;
+			uint32_t skipped_pipelines = 0; // Modified shaders, push descriptors, descriptor buffers or unsupported descriptor types
+			uint32_t commands = 0;
+			uint32_t skipped_commands = 0;
+		};
+		const Statistics& GetStatistics() const { return m_statistics; }
+
+	public:
+		CommandReplay() = delete;
+		CommandReplay(std::shared_ptr<VulkanContext> vulkan_context, std::string_view capture_file); // Throws if the capture is broken
+		~CommandReplay(); // Wait device idle
+		CommandReplay(const CommandReplay&) = delete;
+
+	private:
+		using Command = std::function<void(CommandBuffer&)>;
+		using Submission = std::vector<Command>;
+		using Frame = std::vector<Submission>;
+
+		struct ReplayLayout
+		{
+			std::shared_ptr<PipelineLayout> pipeline_layout;
+			std::vector<std::shared_ptr<DescriptorSetLayout>> set_layouts;
+		};
+
+		void create_proxies();
+		std::shared_ptr<VMA::Buffer> create_buffer(CaptureReader& payload); // nullptr: Empty buffer
+		void create_image(CaptureReader& payload);
+		void create_pipeline(CaptureReader& payload);
+		Submission prepare_submission(CaptureReader& commands);
+		VkDescriptorSet get_proxy_set(const std::shared_ptr<DescriptorSetLayout>& set_layout);
+		VkImageView get_proxy_attachment(VkFormat format, VkExtent2D extent, VkSampleCountFlagBits samples);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::vector<Frame> m_frames;
+		Statistics m_statistics;
+
+		// Keyed by the captured handles (Redefinitions replace the entries, prepared commands own what they use)
+		std::unordered_map<uint64_t, std::shared_ptr<VMA::Buffer>> m_buffers;
+		std::unordered_map<uint64_t, VkPipeline> m_pipelines;
+		std::unordered_map<uint64_t, ReplayLayout> m_layouts;
+		std::vector<std::shared_ptr<VMA::Image>> m_images; // Only their memory is replayed
+		std::vector<VkPipeline> m_owned_pipelines;
+
+		// Proxies
+		std::shared_ptr<VMA::Buffer> m_proxy_buffer; // Unknown vertex & index buffers and buffer descriptors
+		VkBufferView m_proxy_texel_view = VK_NULL_HANDLE;
+		std::shared_ptr<VMA::Image> m_proxy_image;
+		std::shared_ptr<Sampler> m_proxy_sampler;
+		std::shared_ptr<DescriptorAllocator> m_descriptor_allocator;
+		std::unordered_map<DescriptorSetLayout*, std::shared_ptr<DescriptorSet>> m_proxy_sets;
+		std::unordered_map<uint64_t, std::shared_ptr<VMA::Image>> m_proxy_attachments; // Hash of the format, extent and samples
+	};
+
+}} // namespace Albedo::RHI
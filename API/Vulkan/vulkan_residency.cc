@@ -0,0 +1,256 @@
+#include "vulkan_residency.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	TextureResidencyManager::TextureResidencyManager(std::shared_ptr<VulkanContext> vulkan_context, const Config& config) :
+		m_context{ std::move(vulkan_context) },
+		m_config{ config }
+	{
+		assert(m_config.budget_fraction > 0.0f && m_config.budget_fraction <= 1.0f && "Invalid budget fraction!");
+		assert(m_config.min_resident_levels > 0 && m_config.max_streams_per_update > 0 && "Invalid residency config!");
+	}
+
+	TextureResidencyManager::~TextureResidencyManager()
+	{
+		std::scoped_lock guard{ m_mutex };
+		for (auto& texture : m_textures)
+		{
+			if (!texture.is_registered) continue;
+			replace_image(texture, nullptr, texture.mip_levels);
+		}
+	}
+
+	TextureResidencyManager::Handle TextureResidencyManager::Register(Streamer streamer, uint32_t mip_levels)
+	{
+		assert(streamer && mip_levels > 0 && "Invalid texture!");
+		std::scoped_lock guard{ m_mutex };
+		Handle handle;
+		if (!m_free_handles.empty()) { handle = m_free_handles.back(); m_free_handles.pop_back(); }
+		else { handle = static_cast<Handle>(m_textures.size()); m_textures.emplace_back(); }
+
+		auto& texture = m_textures[handle];
+		texture = Texture
+		{
+			.streamer = std::move(streamer),
+			.mip_levels = mip_levels,
+			.first_mip_level = mip_levels,
+			.level_sizes = std::vector<VkDeviceSize>(mip_levels, 0),
+			.is_registered = true
+		};
+		texture.lru = m_lru.insert(m_lru.end(), handle); // Least recently used
+		return handle;
+	}
+
+	void TextureResidencyManager::Unregister(Handle handle)
+	{
+		std::scoped_lock guard{ m_mutex };
+		auto& texture = get_texture(handle);
+		if (texture.streaming_image) m_resident_bytes -= release_bytes(texture.streaming_image); // The Upload Engine keeps it alive
+		replace_image(texture, nullptr, texture.mip_levels);
+		m_lru.erase(texture.lru);
+		texture = {};
+		m_free_handles.emplace_back(handle);
+	}
+
+	void TextureResidencyManager::Touch(Handle handle, uint32_t mip_level/* = 0*/)
+	{
+		std::scoped_lock guard{ m_mutex };
+		touch(get_texture(handle), mip_level);
+	}
+
+	std::shared_ptr<VMA::Image> TextureResidencyManager::GetImage(Handle handle)
+	{
+		std::scoped_lock guard{ m_mutex };
+		auto& texture = get_texture(handle);
+		touch(texture, 0);
+		return texture.image;
+	}
+
+	uint32_t TextureResidencyManager::GetBindlessIndex(Handle handle)
+	{
+		std::scoped_lock guard{ m_mutex };
+		auto& texture = get_texture(handle);
+		touch(texture, 0);
+		return texture.bindless_index;
+	}
+
+	uint32_t TextureResidencyManager::GetFirstMipLevel(Handle handle)
+	{
+		std::scoped_lock guard{ m_mutex };
+		return get_texture(handle).first_mip_level;
+	}
+
+	TextureResidencyManager::Statistics TextureResidencyManager::Update()
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::TextureResidencyManager::Update");
+		std::scoped_lock guard{ m_mutex };
+		auto& uploadEngine = m_context->GetUploadEngine();
+		Statistics statistics{ .budget = get_budget() };
+
+		// Swap in the completed streams
+		for (auto& texture : m_textures)
+		{
+			if (!texture.streaming_image || !uploadEngine.IsComplete(texture.streaming_token)) continue;
+			replace_image(texture, std::move(texture.streaming_image), texture.streaming_first_mip_level);
+		}
+
+		// Evict the least recently used textures beyond the budget (The released memory returns after the frames in flight)
+		VkDeviceSize projectedBytes = m_resident_bytes;
+		for (auto iter = m_lru.rbegin(); iter != m_lru.rend() && projectedBytes > statistics.budget; ++iter)
+		{
+			auto& texture = m_textures[*iter];
+			if (texture.used_frame + m_config.eviction_delay > m_frame) break; // The rest was used more recently
+			if (texture.streaming_image)
+			{
+				const VkDeviceSize releasedBytes = release_bytes(texture.streaming_image);
+				projectedBytes -= releasedBytes;
+				m_resident_bytes -= releasedBytes;
+				texture.streaming_image.reset(); // The Upload Engine keeps it alive until its batch completed
+			}
+			if (!texture.image || is_shared(texture.image)) continue;
+
+			const uint32_t lowestFirstLevel = texture.mip_levels - std::min(m_config.min_resident_levels, texture.mip_levels);
+			if (texture.first_mip_level < lowestFirstLevel)
+			{
+				// Drop the largest level: Re-stream the smaller levels (Swapped in by a later update)
+				const uint32_t firstMipLevel = texture.first_mip_level + 1;
+				texture.streaming_image = texture.streamer(firstMipLevel);
+				texture.streaming_first_mip_level = firstMipLevel;
+				texture.streaming_token = 0; // Flushed below
+				const VkDeviceSize streamingBytes = acquire_bytes(texture.streaming_image);
+				m_resident_bytes += streamingBytes;
+				projectedBytes -= texture.image->GetDataSize() - std::min(texture.image->GetDataSize(), streamingBytes);
+				++statistics.evicted_levels;
+			}
+			else
+			{
+				projectedBytes -= texture.image->GetDataSize();
+				replace_image(texture, nullptr, texture.mip_levels);
+				++statistics.evicted_textures;
+			}
+		}
+
+		// Re-stream the recently used textures lacking levels (Most recently used first)
+		for (auto handle : m_lru)
+		{
+			if (statistics.streamed_textures == m_config.max_streams_per_update) break;
+			auto& texture = m_textures[handle];
+			if (texture.used_frame + m_config.eviction_delay <= m_frame) break; // The rest was used less recently
+			if (texture.used_mip_level == NOT_USED || texture.streaming_image) continue;
+			uint32_t firstMipLevel = std::min(texture.used_mip_level, texture.mip_levels - 1);
+			if (texture.image && texture.first_mip_level <= firstMipLevel) continue;
+
+			// Needed levels if they fit in the budget, otherwise only the smallest ones of a non-resident texture
+			const VkDeviceSize residentSize = texture.image ? texture.image->GetDataSize() : 0;
+			if (projectedBytes + estimate_size(texture, firstMipLevel) > statistics.budget + residentSize)
+			{
+				if (texture.image) continue;
+				firstMipLevel = texture.mip_levels - std::min(m_config.min_resident_levels, texture.mip_levels);
+			}
+			texture.streaming_image = texture.streamer(firstMipLevel);
+			texture.streaming_first_mip_level = firstMipLevel;
+			texture.streaming_token = 0; // Flushed below
+			const VkDeviceSize streamingSize = acquire_bytes(texture.streaming_image);
+			m_resident_bytes += streamingSize;
+			projectedBytes += streamingSize - residentSize;
+			++statistics.streamed_textures;
+		}
+
+		if (statistics.evicted_levels || statistics.streamed_textures)
+		{
+			auto token = uploadEngine.Flush();
+			for (auto& texture : m_textures) if (texture.streaming_image && !texture.streaming_token) texture.streaming_token = token;
+		}
+
+		for (auto& texture : m_textures)
+		{
+			texture.used_mip_level = NOT_USED;
+			if (texture.image) ++statistics.resident_textures;
+		}
+		statistics.resident_bytes = m_resident_bytes;
+		++m_frame;
+		return statistics;
+	}
+
+	TextureResidencyManager::Texture& TextureResidencyManager::get_texture(Handle handle)
+	{
+		assert(handle < m_textures.size() && m_textures[handle].is_registered && "Invalid texture handle!");
+		return m_textures[handle];
+	}
+
+	void TextureResidencyManager::touch(Texture& texture, uint32_t mip_level)
+	{
+		texture.used_frame = m_frame;
+		texture.used_mip_level = std::min(texture.used_mip_level, mip_level);
+		m_lru.splice(m_lru.begin(), m_lru, texture.lru);
+	}
+
+	void TextureResidencyManager::replace_image(Texture& texture, std::shared_ptr<VMA::Image> image, uint32_t first_mip_level)
+	{
+		if (image)
+		{
+			for (uint32_t level = 0; level < image->MipLevels() && first_mip_level + level < texture.mip_levels; ++level)
+				texture.level_sizes[first_mip_level + level] = image->GetDataSize(level, 1);
+		}
+
+		const uint32_t bindlessIndex = texture.bindless_index;
+		if (texture.image) m_resident_bytes -= release_bytes(texture.image);
+		texture.bindless_index = (image && m_context->IsBindlessSupported()) ?
+			m_context->GetBindlessHeap().RegisterSampledImage(image->GetImageView()) : ~0u;
+		// Frames in flight may still sample the old image through its bindless slot
+		if (texture.image || bindlessIndex != ~0u)
+			m_context->DeferDeletion([context = m_context.get(), retired = std::move(texture.image), bindlessIndex]()
+				{ if (bindlessIndex != ~0u) context->GetBindlessHeap().Release(BindlessHeap::SAMPLED_IMAGE, bindlessIndex); });
+		texture.image = std::move(image);
+		texture.first_mip_level = first_mip_level;
+	}
+
+	VkDeviceSize TextureResidencyManager::acquire_bytes(const std::shared_ptr<VMA::Image>& image)
+	{
+		return (m_image_holders[image.get()]++ == 0) ? image->GetDataSize() : 0;
+	}
+
+	VkDeviceSize TextureResidencyManager::release_bytes(const std::shared_ptr<VMA::Image>& image)
+	{
+		auto holders = m_image_holders.find(image.get());
+		assert(holders != m_image_holders.end() && "The image is not held by any texture!");
+		if (--holders->second > 0) return 0;
+		m_image_holders.erase(holders);
+		return image->GetDataSize();
+	}
+
+	bool TextureResidencyManager::is_shared(const std::shared_ptr<VMA::Image>& image) const
+	{
+		auto holders = m_image_holders.find(image.get());
+		return holders != m_image_holders.end() && holders->second > 1;
+	}
+
+	VkDeviceSize TextureResidencyManager::get_budget()
+	{
+		if (m_config.budget) return m_config.budget;
+		VkDeviceSize budget = 0, usage = 0;
+		for (const auto& heap_budget : m_context->m_memory_allocator->GetMemoryBudgets())
+		{
+			if (!heap_budget.device_local) continue;
+			budget += heap_budget.budget;
+			usage += heap_budget.usage;
+		}
+		const VkDeviceSize otherUsage = usage - std::min(usage, m_resident_bytes); // Everything but the textures
+		const auto available = static_cast<VkDeviceSize>(static_cast<double>(budget) * m_config.budget_fraction);
+		return available - std::min(available, otherUsage);
+	}
+
+	VkDeviceSize TextureResidencyManager::estimate_size(const Texture& texture, uint32_t first_mip_level) const
+	{
+		VkDeviceSize size = 0, levelSize = 0;
+		for (uint32_t level = texture.mip_levels; level-- > first_mip_level;)
+		{
+			levelSize = texture.level_sizes[level] ? texture.level_sizes[level] : levelSize * 4;
+			size += levelSize;
+		}
+		return size;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <list>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Texture Residency of regular (Non-sparse) images under the VRAM budget: Each texture is streamed from a first mip level
+	// (Higher levels dropped) by its Streamer through the Upload Engine. Update() evicts the least recently used textures
+	// beyond the budget, first their largest level, then the whole texture once only the smallest levels remain, and re-streams
+	// the used ones when memory is available again. Replaced images are released by the deletion queue (Frames in flight keep them).
+	// Usage is tracked by Touch(), GetBindlessIndex() and GetImage() (e.g. When a material writes its descriptors or bindless indices).
+	// Streamers may return shared images (UploadEngine::UploadSharedImage()): Their bytes are charged once, and textures are not evicted
+	// while their image is shared with another one (It would free nothing).
+	class TextureResidencyManager
+	{
+	public:
+		using Handle = uint32_t;
+		// Allocate the image of the levels from first_mip_level on and queue its upload (e.g. KTX2Texture::Upload(..., first_mip_level)),
+		// called by Update() on the calling thread
+		using Streamer = std::function<std::shared_ptr<VMA::Image>(uint32_t first_mip_level)>;
+		struct Config
+		{
+			VkDeviceSize budget = 0;				// Bytes of resident textures (0: budget_fraction of the device-local heap budgets)
+			float budget_fraction = 0.8f;		// Of the budgets minus the usage of everything else
+			uint32_t eviction_delay = 3;		// Frames a used texture is never evicted (Frames in flight)
+			uint32_t min_resident_levels = 1;	// Smallest levels kept until the whole texture is evicted
+			uint32_t max_streams_per_update = 8;
+		};
+		struct Statistics
+		{
+			VkDeviceSize budget = 0;
+			VkDeviceSize resident_bytes = 0;
+			uint32_t resident_textures = 0;
+			uint32_t evicted_levels = 0;		// By the last Update()
+			uint32_t evicted_textures = 0;		// Ditto
+			uint32_t streamed_textures = 0;	// Ditto (Queued, resident once their upload completed)
+		};
+
+		// Resident from the next Update() (Streamed with every level on first use)
+		Handle Register(Streamer streamer, uint32_t mip_levels);
+		void Unregister(Handle handle);
+		void Touch(Handle handle, uint32_t mip_level = 0); // Used this frame, sampled down to mip_level (Thread-safe)
+		// Null or a smaller image while not resident, bindless index ~0u while not resident (Changes after every re-stream)
+		std::shared_ptr<VMA::Image> GetImage(Handle handle);
+		uint32_t GetBindlessIndex(Handle handle);
+		uint32_t GetFirstMipLevel(Handle handle); // Of the resident image (The registered mip_levels if not resident)
+
+		// Call once per frame (e.g. After FrameContext::BeginFrame()), flushes the Upload Engine if anything was streamed
+		Statistics Update();
+
+	public:
+		TextureResidencyManager() = delete;
+		TextureResidencyManager(std::shared_ptr<VulkanContext> vulkan_context, const Config& config);
+		~TextureResidencyManager();
+		TextureResidencyManager(const TextureResidencyManager&) = delete;
+
+	private:
+		static constexpr uint32_t NOT_USED = ~0u;
+		using LRUList = std::list<Handle>; // Most recently used first
+		struct Texture
+		{
+			Streamer streamer;
+			uint32_t mip_levels = 0;
+			std::shared_ptr<VMA::Image> image; // Resident levels from first_mip_level
+			uint32_t first_mip_level = 0;
+			uint32_t bindless_index = ~0u;
+			std::shared_ptr<VMA::Image> streaming_image; // Until its upload completed
+			uint32_t streaming_first_mip_level = 0;
+			uint64_t streaming_token = 0;
+			uint64_t used_frame = 0;
+			uint32_t used_mip_level = NOT_USED; // Finest level used since the last Update()
+			std::vector<VkDeviceSize> level_sizes; // Bytes per level once streamed (0: Unknown)
+			bool is_registered = false;
+			LRUList::iterator lru;
+		};
+		Texture& get_texture(Handle handle); // Synchronized by the caller
+		void touch(Texture& texture, uint32_t mip_level);
+		void replace_image(Texture& texture, std::shared_ptr<VMA::Image> image, uint32_t first_mip_level); // Deferred release
+		VkDeviceSize get_budget();
+		VkDeviceSize estimate_size(const Texture& texture, uint32_t first_mip_level) const; // Unknown levels: 4x the next one
+		// Resident bytes of images held by several textures are counted once
+		VkDeviceSize acquire_bytes(const std::shared_ptr<VMA::Image>& image); // Bytes charged (0 if already held)
+		VkDeviceSize release_bytes(const std::shared_ptr<VMA::Image>& image); // Bytes freed (0 if still held)
+		bool is_shared(const std::shared_ptr<VMA::Image>& image) const;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		Config m_config;
+		uint64_t m_frame = 1;
+		VkDeviceSize m_resident_bytes = 0; // Including the streaming images
+
+		std::mutex m_mutex;
+		std::vector<Texture> m_textures;
+		std::vector<Handle> m_free_handles;
+		LRUList m_lru;
+		std::unordered_map<const VMA::Image*, uint32_t> m_image_holders; // Textures holding each resident or streaming image
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,76 @@
+#include "vulkan_scatter.h"
+#include "vulkan_context.h"
+
+#include <cstring>
+
+namespace Albedo {
+namespace RHI
+{
+	ScatterUpload::ScatterUpload(std::shared_ptr<VulkanContext> vulkan_context, uint32_t element_size) :
+		m_context{ std::move(vulkan_context) },
+		m_element_size{ element_size }
+	{
+		assert(element_size > 0 && element_size % 4 == 0 && "Scattered elements are copied as uint words!");
+	}
+
+	void ScatterUpload::Add(uint32_t element_index, std::span<const std::byte> element)
+	{
+		assert(element.size() == m_element_size && "Invalid size of the scattered element!");
+		auto [slot, isNew] = m_slots.try_emplace(element_index, static_cast<uint32_t>(m_indices.size()));
+		if (isNew)
+		{
+			m_indices.emplace_back(element_index);
+			m_elements.insert(m_elements.end(), element.begin(), element.end());
+		}
+		else memcpy(m_elements.data() + static_cast<size_t>(slot->second) * m_element_size, element.data(), m_element_size);
+	}
+
+	void ScatterUpload::Clear()
+	{
+		m_indices.clear();
+		m_elements.clear();
+		m_slots.clear();
+	}
+
+	void ScatterUpload::ScatterCommand(CommandBuffer& command_buffer, ComputePipeline& scatter_pipeline, VMA::StagingRing& staging_ring,
+		VMA::Buffer& destination, uint32_t group_size/* = 64*/)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(group_size > 0 && "Invalid size of the scatter work group!");
+		if (m_indices.empty()) return;
+
+		// Indices followed by the elements in one sub-allocation
+		const VkDeviceSize indicesSize = m_indices.size() * sizeof(uint32_t);
+		auto allocation = staging_ring.Allocate(indicesSize + m_elements.size(),
+			m_context->m_physical_device_properties.limits.minStorageBufferOffsetAlignment);
+		memcpy(allocation.data, m_indices.data(), indicesSize);
+		memcpy(static_cast<std::byte*>(allocation.data) + indicesSize, m_elements.data(), m_elements.size());
+		staging_ring.Flush(allocation);
+
+		destination.TransitionCommand(command_buffer,
+			{
+				.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.access = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+			});
+
+		scatter_pipeline.Bind(command_buffer);
+		auto descriptorSet = m_context->CreateDescriptorSet(scatter_pipeline.GetSharedDescriptorSetLayout(0)); // Freed through the deletion queue
+		DescriptorWriteBatch{ m_context, 2 }
+			.WriteBuffer(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, allocation.buffer, allocation.offset, allocation.size)
+			.WriteBuffer(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, static_cast<VkBuffer>(destination))
+			.Flush();
+
+		const PushConstants pushConstants
+		{
+			.count = static_cast<uint32_t>(m_indices.size()),
+			.element_words = m_element_size / 4,
+			.data_offset = static_cast<uint32_t>(m_indices.size())
+		};
+		command_buffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, scatter_pipeline.GetPipelineLayout(), 0, { *descriptorSet });
+		command_buffer.PushConstants(scatter_pipeline.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		scatter_pipeline.Dispatch(command_buffer, (pushConstants.count + group_size - 1) / group_size);
+		Clear();
+	}
+
+}} // namespace Albedo::RHI
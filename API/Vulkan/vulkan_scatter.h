@@ -0,0 +1,51 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ComputePipeline;
+
+	// GPU Scatter Upload: Thousands of small sparse element updates of a buffer (e.g. per-instance transforms) in one dispatch
+	// instead of one copy region each. Elements are gathered into the staging ring with their destination indices, and a scatter
+	// compute shader (one invocation per element) writes them into the destination. An index added twice keeps its last element.
+	class ScatterUpload
+	{
+	public:
+		void Add(uint32_t element_index, std::span<const std::byte> element); // element_size bytes
+		template<typename Element>
+		void Add(uint32_t element_index, const Element& element) { Add(element_index, std::as_bytes(std::span{ &element, 1 })); }
+		void Clear();
+
+		// Set 0 of the pipeline: binding 0 - scatter data (Storage buffer: uint indices[count], then the elements as uint words
+		// from data_offset), binding 1 - destination (Storage buffer of uint words), push constant: PushConstants.
+		// Invocation i copies element_words words of element i to destination[indices[i] * element_words]. The pending elements are cleared,
+		// the destination is left as a compute shader storage write (TransitionCommand() to its consumer access).
+		struct PushConstants
+		{
+			uint32_t count;
+			uint32_t element_words;
+			uint32_t data_offset; // In words
+		};
+		void ScatterCommand(CommandBuffer& command_buffer, ComputePipeline& scatter_pipeline, VMA::StagingRing& staging_ring,
+			VMA::Buffer& destination, uint32_t group_size = 64);
+
+		uint32_t GetElementSize() const { return m_element_size; }
+		size_t GetPendingCount() const { return m_indices.size(); }
+
+	public:
+		ScatterUpload() = delete;
+		ScatterUpload(std::shared_ptr<VulkanContext> vulkan_context, uint32_t element_size); // Multiple of 4 bytes
+		ScatterUpload(const ScatterUpload&) = delete;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const uint32_t m_element_size;
+		std::vector<uint32_t> m_indices;
+		std::vector<std::byte> m_elements;
+		std::unordered_map<uint32_t, uint32_t> m_slots; // Element index -> Pending slot
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,34 @@
+#include "vulkan_scheduler.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	DeviceScheduler::DeviceScheduler(std::vector<std::shared_ptr<VulkanContext>> vulkan_contexts, uint32_t jobs_per_device/* = 1*/)
+	{
+		if (vulkan_contexts.empty())
+			throw std::runtime_error("Failed to create the Device Scheduler - No Vulkan Contexts!");
+
+		m_devices.reserve(vulkan_contexts.size());
+		for (auto& vulkan_context : vulkan_contexts)
+		{
+			auto& device = m_devices.emplace_back(std::make_unique<Device>());
+			device->context = std::move(vulkan_context);
+			device->dispatcher = std::make_unique<WorkerPool>(jobs_per_device);
+			log::info("Device Scheduler: [{}] {}", m_devices.size() - 1, device->context->m_physical_device_properties.deviceName);
+		}
+	}
+
+	size_t DeviceScheduler::select_device()
+	{
+		size_t start = m_next_device++ % m_devices.size();
+		size_t selected = start;
+		for (size_t offset = 1; offset < m_devices.size(); ++offset)
+		{
+			size_t index = (start + offset) % m_devices.size();
+			if (m_devices[index]->pending_jobs < m_devices[selected]->pending_jobs) selected = index;
+		}
+		return selected;
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "vulkan_worker.h"
+
+#include <atomic>
+#include <cassert>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Device Scheduler (Dispatch independent jobs across the contexts of VulkanContext::CreateHeadlessGroup())
+	// Every device owns its dispatcher threads, a job records and submits its own work on the device it was given.
+	class DeviceScheduler
+	{
+	public:
+		// Least loaded device (Pending jobs), the job is called with the chosen context
+		template<typename Job>
+		auto Submit(Job&& job) -> std::future<std::invoke_result_t<Job, VulkanContext&>>
+		{ return SubmitTo(select_device(), std::forward<Job>(job)); }
+
+		template<typename Job>
+		auto SubmitTo(size_t device_index, Job&& job) -> std::future<std::invoke_result_t<Job, VulkanContext&>>
+		{
+			assert(device_index < m_devices.size() && "Invalid device index!");
+			auto& device = *m_devices[device_index];
+			++device.pending_jobs;
+			return device.dispatcher->Submit([&device, job = std::forward<Job>(job)]() mutable
+			{
+				struct PendingGuard { std::atomic<uint32_t>& pending_jobs; ~PendingGuard() { --pending_jobs; } } guard{ device.pending_jobs };
+				return job(*device.context);
+			});
+		}
+
+		size_t GetDeviceCount() const { return m_devices.size(); }
+		VulkanContext& GetDevice(size_t device_index) { return *m_devices[device_index]->context; }
+		uint32_t GetPendingJobCount(size_t device_index) const { return m_devices[device_index]->pending_jobs; }
+
+	public:
+		DeviceScheduler() = delete;
+		// jobs_per_device: Concurrent jobs on one device (They share its queues)
+		DeviceScheduler(std::vector<std::shared_ptr<VulkanContext>> vulkan_contexts, uint32_t jobs_per_device = 1);
+		DeviceScheduler(const DeviceScheduler&) = delete;
+
+	private:
+		size_t select_device();
+
+	private:
+		struct Device
+		{
+			std::shared_ptr<VulkanContext> context;
+			std::unique_ptr<WorkerPool> dispatcher; // Joined before the context is released
+			std::atomic<uint32_t> pending_jobs{ 0 };
+		};
+		std::vector<std::unique_ptr<Device>> m_devices;
+		std::atomic<size_t> m_next_device{ 0 }; // Rotates the ties
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,635 @@
+#include "vulkan_context.h"
+#include "vulkan_shader.h"
+
+#include <fstream>
+#include <random>
+
+#include <spirv_reflect.h>
+#include <stripper.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	MappedFile::MappedFile(std::string_view path)
+	{
+		std::string filePath{ path };
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) throw std::runtime_error(std::format("Failed to open the file {}!", path));
+		LARGE_INTEGER fileSize{};
+		GetFileSizeEx(file, &fileSize);
+		m_file = file;
+		m_size = static_cast<size_t>(fileSize.QuadPart);
+		if (m_size == 0) return;
+		m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping) m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		int file = open(filePath.c_str(), O_RDONLY);
+		if (file < 0) throw std::runtime_error(std::format("Failed to open the file {}!", path));
+		struct stat fileStatus{};
+		fstat(file, &fileStatus);
+		m_size = static_cast<size_t>(fileStatus.st_size);
+		if (m_size == 0) { close(file); return; }
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file); // The mapping keeps the file alive
+		if (data != MAP_FAILED) m_data = static_cast<const char*>(data);
+#endif
+		if (m_data == nullptr)
+		{
+			unmap();
+			throw std::runtime_error(std::format("Failed to map the file {}!", path));
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		unmap();
+	}
+
+	void MappedFile::unmap()
+	{
+#ifdef _WIN32
+		if (m_data) UnmapViewOfFile(m_data);
+		if (m_mapping) CloseHandle(m_mapping);
+		if (m_file) CloseHandle(m_file);
+#else
+		if (m_data) munmap(const_cast<char*>(m_data), m_size);
+#endif
+		m_data = nullptr;
+		m_mapping = m_file = nullptr;
+	}
+
+	ShaderModule::ShaderModule(VulkanContext* vulkan_context, std::vector<char> bytecode, uint64_t hash) :
+		m_context{ vulkan_context },
+		m_owned_bytecode{ std::move(bytecode) },
+		m_bytecode{ m_owned_bytecode },
+		m_hash{ hash }
+	{
+		create_shader_module();
+	}
+
+	ShaderModule::ShaderModule(VulkanContext* vulkan_context, std::shared_ptr<const MappedFile> archive, std::span<const char> bytecode, uint64_t hash) :
+		m_context{ vulkan_context },
+		m_archive{ std::move(archive) },
+		m_bytecode{ bytecode },
+		m_hash{ hash }
+	{
+		assert(reinterpret_cast<uintptr_t>(bytecode.data()) % alignof(uint32_t) == 0 && "SPIR-V must be 4-byte aligned!");
+		create_shader_module();
+	}
+
+	void ShaderModule::create_shader_module()
+	{
+		VkShaderModuleCreateInfo shaderModuleCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+			.codeSize = m_bytecode.size(),
+			.pCode = reinterpret_cast<const uint32_t*>(m_bytecode.data())
+		};
+
+		if (vkCreateShaderModule(
+			m_context->m_device,
+			&shaderModuleCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_shader_module) != VK_SUCCESS)
+			throw std::runtime_error(std::format("Failed to create shader module {:x}!", m_hash));
+	}
+
+	ShaderModule::~ShaderModule()
+	{
+		vkDestroyShaderModule(m_context->m_device, m_shader_module, m_context->m_memory_allocation_callback);
+	}
+
+	std::shared_ptr<ShaderModule> ShaderCache::
+		GetShaderModule(std::string_view shader_file)
+	{
+		std::optional<ArchivedShader> archivedShader;
+		{
+			std::scoped_lock guard{ m_mutex };
+			auto path = m_shader_files.find(std::string{ shader_file });
+			if (path != m_shader_files.end())
+			{
+				auto shader_module = m_shader_modules.find(path->second);
+				if (shader_module != m_shader_modules.end()) return shader_module->second;
+			}
+			auto archived_shader = m_archived_shaders.find(std::string{ shader_file });
+			if (archived_shader != m_archived_shaders.end())
+			{
+				archivedShader = archived_shader->second;
+				auto shader_module = m_shader_modules.find(archivedShader->hash);
+				if (shader_module != m_shader_modules.end())
+				{
+					m_shader_files[std::string{ shader_file }] = archivedShader->hash;
+					return shader_module->second;
+				}
+			}
+		}
+
+		if (archivedShader && HashBytes(archivedShader->bytecode.data(), archivedShader->bytecode.size()) != archivedShader->hash)
+		{
+			log::warn("The archived shader {} is corrupt - it will be read from its file", shader_file);
+			std::scoped_lock guard{ m_mutex };
+			m_archived_shaders.erase(std::string{ shader_file });
+			archivedShader.reset();
+		}
+		if (archivedShader) // Zero-copy from the mapped archive
+		{
+			auto shader_module = std::make_shared<ShaderModule>(m_context, archivedShader->archive, archivedShader->bytecode, archivedShader->hash);
+			std::scoped_lock guard{ m_mutex };
+			m_shader_files[std::string{ shader_file }] = archivedShader->hash;
+			return m_shader_modules.emplace(archivedShader->hash, std::move(shader_module)).first->second;
+		}
+
+		// Read File (outside the lock, so workers can load different shaders in parallel)
+		std::error_code error;
+		auto writeTime = std::filesystem::last_write_time(shader_file, error); // Before reading, a write in between will be seen again
+		std::ifstream file(shader_file.data(), std::ios::ate | std::ios::binary);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the shader file {}!", shader_file));
+
+		size_t file_size = static_cast<size_t>(file.tellg());
+		std::vector<char> buffer(file_size);
+		file.seekg(0);
+		file.read(buffer.data(), file_size);
+		file.close();
+
+		auto shader_module = GetShaderModule(std::move(buffer));
+
+		std::scoped_lock guard{ m_mutex };
+		m_shader_files[std::string{ shader_file }] = shader_module->GetHash();
+		if (!error) m_shader_file_times[std::string{ shader_file }] = writeTime;
+		return shader_module;
+	}
+
+	std::shared_ptr<ShaderModule> ShaderCache::
+		GetShaderModule(std::vector<char> bytecode)
+	{
+		auto hash = HashBytes(bytecode.data(), bytecode.size());
+		{
+			std::scoped_lock guard{ m_mutex };
+			auto shader_module = m_shader_modules.find(hash);
+			if (shader_module != m_shader_modules.end()) return shader_module->second;
+		}
+
+		auto shader_module = std::make_shared<ShaderModule>(m_context, std::move(bytecode), hash);
+
+		std::scoped_lock guard{ m_mutex };
+		auto [target, is_new] = m_shader_modules.emplace(hash, std::move(shader_module));
+		return target->second; // Another thread may have registered the same shader first
+	}
+
+	std::shared_ptr<const ShaderReflection> ShaderCache::
+		GetShaderReflection(const ShaderModule& shader_module)
+	{
+		{
+			std::scoped_lock guard{ m_mutex };
+			auto reflection = m_shader_reflections.find(shader_module.GetHash());
+			if (reflection != m_shader_reflections.end()) return reflection->second;
+		}
+
+#if ALBEDO_RHI_RUNTIME_REFLECTION
+		auto reflection = reflect_shader(shader_module.GetBytecode());
+
+		std::scoped_lock guard{ m_mutex };
+		return m_shader_reflections.emplace(shader_module.GetHash(), std::move(reflection)).first->second;
+#else
+		throw std::runtime_error(std::format("Shader {:x} has no generated reflection table (Runtime reflection is disabled)!", shader_module.GetHash()));
+#endif
+	}
+
+	void ShaderCache::RegisterShaderReflections(std::span<const ShaderReflectionTable> tables)
+	{
+		std::scoped_lock guard{ m_mutex };
+		for (const auto& table : tables)
+		{
+			auto reflection = std::make_shared<ShaderReflection>();
+			reflection->stage = table.stage;
+			reflection->descriptor_bindings.assign(table.descriptor_bindings.begin(), table.descriptor_bindings.end());
+			reflection->push_constants.assign(table.push_constants.begin(), table.push_constants.end());
+			reflection->vertex_inputs.assign(table.vertex_inputs.begin(), table.vertex_inputs.end());
+			m_shader_reflections.insert_or_assign(table.hash, std::move(reflection));
+		}
+	}
+
+	std::shared_ptr<const ShaderReflection> ShaderCache::
+		reflect_shader(std::span<const char> bytecode)
+	{
+		SpvReflectShaderModule spvContext;
+		if (spvReflectCreateShaderModule(bytecode.size(), bytecode.data(), &spvContext) != SPV_REFLECT_RESULT_SUCCESS)
+			throw std::runtime_error("Failed to reflect shader!");
+		struct SpvContextGuard // Destroyed on the throw paths too
+		{
+			SpvReflectShaderModule& module;
+			~SpvContextGuard() { spvReflectDestroyShaderModule(&module); }
+		} spvContextGuard{ spvContext };
+
+		auto reflection = std::make_shared<ShaderReflection>();
+		reflection->stage = static_cast<VkShaderStageFlagBits>(spvContext.shader_stage);
+		uint32_t count = 0;
+
+		// 1. Descriptor Sets
+		if (spvReflectEnumerateDescriptorSets(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
+			throw std::runtime_error("Failed to reflect descriptor sets of shader!");
+		std::vector<SpvReflectDescriptorSet*> pDescriptorSets(count);
+		if (spvReflectEnumerateDescriptorSets(&spvContext, &count, pDescriptorSets.data()) != SPV_REFLECT_RESULT_SUCCESS)
+			throw std::runtime_error("Failed to enumerate descriptor sets of shader!");
+
+		for (const auto& descriptorSets : pDescriptorSets)
+		{
+			log::debug("Set {} Bindings {}", descriptorSets->set, descriptorSets->binding_count);
+			auto& bindings = descriptorSets->bindings;
+			for (uint32_t i = 0; i < descriptorSets->binding_count; ++i)
+			{
+				log::debug("binding {}, name {}, count {}", bindings[i]->binding, bindings[i]->name, bindings[i]->count);
+				reflection->descriptor_bindings.emplace_back(ShaderReflection::Binding
+					{
+						.set = descriptorSets->set,
+						.binding = bindings[i]->binding,
+						.type = static_cast<VkDescriptorType>(bindings[i]->descriptor_type),
+						.count = bindings[i]->count
+					});
+			}
+		}
+
+		// 2. Push Constants
+		if (spvReflectEnumeratePushConstants(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
+			throw std::runtime_error("Failed to reflect push constants of shader!");
+		std::vector<SpvReflectBlockVariable*> pPushConstants(count);
+		if (spvReflectEnumeratePushConstants(&spvContext, &count, pPushConstants.data()) != SPV_REFLECT_RESULT_SUCCESS)
+			throw std::runtime_error("Failed to reflect enumerate constants of shader!");
+
+		for (const auto& pushConstant : pPushConstants)
+		{
+			log::debug("Push Constant: offset {}, size {}", pushConstant->offset, pushConstant->size);
+			reflection->push_constants.emplace_back(VkPushConstantRange
+				{
+					.stageFlags = static_cast<VkShaderStageFlags>(reflection->stage),
+					.offset = pushConstant->offset,
+					.size = pushConstant->size
+				});
+		}
+
+		// 3. Vertex Inputs
+		if (VK_SHADER_STAGE_VERTEX_BIT == reflection->stage)
+		{
+			if (spvReflectEnumerateInputVariables(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
+				throw std::runtime_error("Failed to reflect input variables of vertex shader!");
+			std::vector<SpvReflectInterfaceVariable*> pInputVariables(count);
+			if (spvReflectEnumerateInputVariables(&spvContext, &count, pInputVariables.data()) != SPV_REFLECT_RESULT_SUCCESS)
+				throw std::runtime_error("Failed to enumerate input variables of vertex shader!");
+
+			for (const auto& inputVariable : pInputVariables)
+			{
+				if (inputVariable->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) continue; // e.g. gl_VertexIndex
+				reflection->vertex_inputs.emplace_back(ShaderReflection::VertexInput
+					{
+						.location = inputVariable->location,
+						.format = static_cast<VkFormat>(inputVariable->format)
+					});
+			}
+			std::sort(reflection->vertex_inputs.begin(), reflection->vertex_inputs.end(),
+				[](const auto& prev, const auto& next) { return prev.location < next.location; });
+		}
+
+		return reflection;
+	}
+
+	// Reflection File: [MAGIC][VERSION][COUNT] { [HASH][STAGE][N]{Binding} [N]{VkPushConstantRange} [N]{VertexInput} } ...
+	static constexpr uint32_t SHADER_REFLECTION_FILE_MAGIC = 0x41525246; // "ARRF"
+	static constexpr uint32_t SHADER_REFLECTION_FILE_VERSION = 1; // Bump it whenever ShaderReflection changes
+
+	void ShaderCache::LoadShaderReflections(std::string_view reflection_file)
+	{
+		std::ifstream file(std::filesystem::path{ reflection_file }, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) return; // Cold start
+		const size_t fileSize = static_cast<size_t>(file.tellg());
+		file.seekg(0);
+
+		auto read = [&file](auto& value) { return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+		auto read_array = [&file, &read, fileSize](auto& values)
+		{
+			uint32_t size = 0;
+			if (!read(size)) return false;
+			// Untrusted count: Never resize beyond the bytes left in the file
+			if (size > (fileSize - static_cast<size_t>(file.tellg())) / sizeof(values[0])) return false;
+			values.resize(size);
+			return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), size * sizeof(values[0])));
+		};
+
+		uint32_t magic = 0, version = 0, count = 0;
+		if (!read(magic) || magic != SHADER_REFLECTION_FILE_MAGIC ||
+			!read(version) || version != SHADER_REFLECTION_FILE_VERSION || !read(count))
+		{
+			log::warn("The shader reflection file {} is outdated or broken - it will be rebuilt", reflection_file);
+			return;
+		}
+
+		std::scoped_lock guard{ m_mutex };
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint64_t hash = 0;
+			auto reflection = std::make_shared<ShaderReflection>();
+			if (!read(hash) || !read(reflection->stage) ||
+				!read_array(reflection->descriptor_bindings) ||
+				!read_array(reflection->push_constants) ||
+				!read_array(reflection->vertex_inputs))
+			{
+				log::warn("The shader reflection file {} is truncated", reflection_file);
+				return;
+			}
+			m_shader_reflections.emplace(hash, std::move(reflection));
+		}
+		log::info("Loaded {} shader reflection records from {}", count, reflection_file);
+	}
+
+	void ShaderCache::SaveShaderReflections(std::string_view reflection_file)
+	{
+		// Write to a temporary file first so that a crash or a full disk never leaves a truncated file to the next run
+		const std::filesystem::path reflectionFile{ reflection_file };
+		auto temporaryFile = std::filesystem::path{ std::format("{}.{:08x}.tmp", reflection_file, std::random_device{}()) }; // Unique across processes
+		std::ofstream file(temporaryFile, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the shader reflection file {}!", temporaryFile.string()));
+
+		auto write = [&file](const auto& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+		auto write_array = [&file, &write](const auto& values)
+		{
+			write(static_cast<uint32_t>(values.size()));
+			file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(values[0]));
+		};
+
+		std::scoped_lock guard{ m_mutex };
+		write(SHADER_REFLECTION_FILE_MAGIC);
+		write(SHADER_REFLECTION_FILE_VERSION);
+		write(static_cast<uint32_t>(m_shader_reflections.size()));
+		for (const auto& [hash, reflection] : m_shader_reflections)
+		{
+			write(hash);
+			write(reflection->stage);
+			write_array(reflection->descriptor_bindings);
+			write_array(reflection->push_constants);
+			write_array(reflection->vertex_inputs);
+		}
+		file.flush();
+		if (!file.good())
+		{
+			file.close();
+			std::error_code error_code;
+			std::filesystem::remove(temporaryFile, error_code);
+			throw std::runtime_error(std::format("Failed to write the shader reflection file {}!", temporaryFile.string()));
+		}
+		file.close();
+
+		std::error_code error_code;
+		std::filesystem::rename(temporaryFile, reflectionFile, error_code);
+		if (error_code)
+		{
+			std::filesystem::remove(temporaryFile, error_code);
+			throw std::runtime_error(std::format("Failed to save the shader reflection file {}!", reflection_file));
+		}
+	}
+
+	// Shader Archive: [MAGIC][COUNT][INDEX SIZE] { [HASH][N]{Path} [STAGE][N]{Binding} [N]{VkPushConstantRange} [N]{VertexInput} [OFFSET][SIZE] } ...
+	// followed by the bytecode section (4-byte aligned, offsets are relative to it)
+	static constexpr uint32_t SHADER_ARCHIVE_FILE_MAGIC = 0x41534141; // "AASA"
+
+	void ShaderCache::LoadShaderArchive(std::string_view archive_file)
+	{
+		auto archive = std::make_shared<const MappedFile>(archive_file);
+		auto data = archive->GetData();
+
+		size_t cursor = 0;
+		auto read = [&data, &cursor](auto& value)
+		{
+			if (sizeof(value) > data.size() - cursor) return false; // Subtractions only, the sizes are untrusted
+			memcpy(&value, data.data() + cursor, sizeof(value));
+			cursor += sizeof(value);
+			return true;
+		};
+		auto read_array = [&data, &cursor, &read](auto& values)
+		{
+			uint32_t size = 0;
+			if (!read(size) || size > (data.size() - cursor) / sizeof(values[0])) return false;
+			values.resize(size);
+			memcpy(values.data(), data.data() + cursor, size * sizeof(values[0]));
+			cursor += size * sizeof(values[0]);
+			return true;
+		};
+
+		uint32_t magic = 0, count = 0;
+		uint64_t indexSize = 0;
+		if (!read(magic) || magic != SHADER_ARCHIVE_FILE_MAGIC || !read(count) || !read(indexSize) || indexSize > data.size() - cursor)
+			throw std::runtime_error(std::format("Failed to load the shader archive {} - Invalid header!", archive_file));
+		const size_t bytecodeSection = (cursor + indexSize + 3) / 4 * 4;
+		const size_t bytecodeSize = bytecodeSection < data.size() ? data.size() - bytecodeSection : 0;
+
+		std::scoped_lock guard{ m_mutex };
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint64_t hash = 0, offset = 0, size = 0;
+			std::string path;
+			auto reflection = std::make_shared<ShaderReflection>();
+			if (!read(hash) || !read_array(path) || !read(reflection->stage) ||
+				!read_array(reflection->descriptor_bindings) ||
+				!read_array(reflection->push_constants) ||
+				!read_array(reflection->vertex_inputs) ||
+				!read(offset) || !read(size) ||
+				offset > bytecodeSize || size > bytecodeSize - offset)
+				throw std::runtime_error(std::format("Failed to load the shader archive {} - The index is truncated!", archive_file));
+			if (offset % 4 || size % 4) // Handed out as SPIR-V words
+				throw std::runtime_error(std::format("Failed to load the shader archive {} - Shader {} is misaligned!", archive_file, path));
+
+			m_archived_shaders[path] = ArchivedShader{ .archive = archive, .bytecode = data.subspan(bytecodeSection + offset, size), .hash = hash };
+			m_shader_reflections.emplace(hash, std::move(reflection));
+			m_shader_files.erase(path); // Served by the archive from now on
+		}
+		log::info("Mapped {} shaders from {}", count, archive_file);
+	}
+
+	namespace
+	{
+		struct ArchiveEntry
+		{
+			const std::string& path;
+			std::span<const char> bytecode;
+			uint64_t hash;
+			const ShaderReflection& reflection;
+		};
+
+		void write_shader_archive(std::string_view archive_file, const std::vector<ArchiveEntry>& entries)
+		{
+			std::vector<char> index;
+			auto write = [&index](const auto& value)
+			{
+				auto bytes = reinterpret_cast<const char*>(&value);
+				index.insert(index.end(), bytes, bytes + sizeof(value));
+			};
+			auto write_array = [&index, &write](const auto& values)
+			{
+				write(static_cast<uint32_t>(values.size()));
+				auto bytes = reinterpret_cast<const char*>(values.data());
+				index.insert(index.end(), bytes, bytes + values.size() * sizeof(values[0]));
+			};
+
+			uint64_t bytecodeOffset = 0;
+			for (const auto& entry : entries)
+			{
+				uint64_t bytecodeSize = entry.bytecode.size();
+				write(entry.hash);
+				write_array(entry.path);
+				write(entry.reflection.stage);
+				write_array(entry.reflection.descriptor_bindings);
+				write_array(entry.reflection.push_constants);
+				write_array(entry.reflection.vertex_inputs);
+				write(bytecodeOffset);
+				write(bytecodeSize);
+				bytecodeOffset += (bytecodeSize + 3) / 4 * 4;
+			}
+
+			std::ofstream file(archive_file.data(), std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the shader archive {}!", archive_file));
+			const uint32_t count = static_cast<uint32_t>(entries.size());
+			const uint64_t indexSize = index.size();
+			file.write(reinterpret_cast<const char*>(&SHADER_ARCHIVE_FILE_MAGIC), sizeof(SHADER_ARCHIVE_FILE_MAGIC));
+			file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			file.write(reinterpret_cast<const char*>(&indexSize), sizeof(indexSize));
+			file.write(index.data(), index.size());
+
+			constexpr char PADDING[4]{};
+			auto pad = [&file, &PADDING]() { file.write(PADDING, (4 - static_cast<size_t>(file.tellp()) % 4) % 4); };
+			pad();
+			for (const auto& entry : entries)
+			{
+				file.write(entry.bytecode.data(), entry.bytecode.size());
+				pad();
+			}
+			if (!file) throw std::runtime_error(std::format("Failed to write the shader archive {}!", archive_file));
+			log::info("Packed {} shaders into {}", count, archive_file);
+		}
+
+		// SPIRV-Reflect's stripper (SPV_GOOGLE decorations, sources, strings and lines), then names and member names
+		std::vector<char> strip_shader(std::span<const char> bytecode)
+		{
+			constexpr uint32_t HEADER_WORDS = 5;
+			constexpr uint32_t OP_NAME = 5, OP_MEMBER_NAME = 6, OP_NO_LINE = 317;
+
+			std::vector<uint32_t> words(bytecode.size() / sizeof(uint32_t));
+			memcpy(words.data(), bytecode.data(), words.size() * sizeof(uint32_t));
+			const int size = SpvStripReflect(words.data(), words.size());
+			if (size < 0) throw std::runtime_error("Failed to strip shader - Invalid SPIR-V!");
+
+			size_t stripped = HEADER_WORDS;
+			for (size_t cursor = HEADER_WORDS; cursor < static_cast<size_t>(size);)
+			{
+				const uint32_t wordCount = words[cursor] >> 16, opcode = words[cursor] & 0xFFFF;
+				if (wordCount == 0 || cursor + wordCount > static_cast<size_t>(size)) throw std::runtime_error("Failed to strip shader - Truncated instruction!");
+				if (opcode != OP_NAME && opcode != OP_MEMBER_NAME && opcode != OP_NO_LINE)
+				{
+					std::copy_n(words.begin() + cursor, wordCount, words.begin() + stripped);
+					stripped += wordCount;
+				}
+				cursor += wordCount;
+			}
+
+			std::vector<char> result(stripped * sizeof(uint32_t));
+			memcpy(result.data(), words.data(), result.size());
+			return result;
+		}
+	} // namespace
+
+	void ShaderCache::SaveShaderArchive(std::string_view archive_file, const std::vector<std::string>& shader_files)
+	{
+		std::vector<std::shared_ptr<ShaderModule>> shaderModules;
+		std::vector<std::shared_ptr<const ShaderReflection>> reflections;
+		std::vector<ArchiveEntry> entries;
+		for (const auto& shader_file : shader_files)
+		{
+			auto& shaderModule = shaderModules.emplace_back(GetShaderModule(shader_file));
+			auto& reflection = reflections.emplace_back(GetShaderReflection(*shaderModule));
+			entries.emplace_back(ArchiveEntry{ .path = shader_file, .bytecode = shaderModule->GetBytecode(), .hash = shaderModule->GetHash(), .reflection = *reflection });
+		}
+		write_shader_archive(archive_file, entries);
+	}
+
+	void ShaderCache::PackShaderArchive(std::string_view archive_file, const std::vector<std::string>& shader_files, bool strip_debug_info/* = true*/)
+	{
+		std::vector<std::vector<char>> bytecodes;
+		std::vector<std::shared_ptr<const ShaderReflection>> reflections;
+		bytecodes.reserve(shader_files.size()); // Entries view them
+		size_t originalSize = 0;
+		for (const auto& shader_file : shader_files)
+		{
+			std::ifstream file(shader_file, std::ios::ate | std::ios::binary);
+			if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the shader file {}!", shader_file));
+			std::vector<char> bytecode(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(bytecode.data(), bytecode.size());
+			originalSize += bytecode.size();
+
+			reflections.emplace_back(reflect_shader(bytecode)); // Before names and decorations are gone
+			bytecodes.emplace_back(strip_debug_info ? strip_shader(bytecode) : std::move(bytecode));
+		}
+
+		std::vector<ArchiveEntry> entries;
+		size_t archivedSize = 0;
+		for (size_t i = 0; i < shader_files.size(); ++i)
+		{
+			entries.emplace_back(ArchiveEntry{ .path = shader_files[i], .bytecode = bytecodes[i],
+				.hash = HashBytes(bytecodes[i].data(), bytecodes[i].size()), .reflection = *reflections[i] });
+			archivedSize += bytecodes[i].size();
+		}
+		write_shader_archive(archive_file, entries);
+		log::info("Archived {} of {} bytes of SPIR-V", archivedSize, originalSize);
+	}
+
+	void ShaderCache::ForgetShaderFile(std::string_view shader_file)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_shader_files.erase(std::string{ shader_file });
+	}
+
+	std::vector<std::string> ShaderCache::CollectModifiedShaderFiles()
+	{
+		decltype(m_shader_file_times) shaderFileTimes;
+		{
+			std::scoped_lock guard{ m_mutex };
+			shaderFileTimes = m_shader_file_times;
+		}
+
+		// Query the file system outside the lock
+		std::vector<std::pair<std::string, std::filesystem::file_time_type>> modifiedFiles;
+		for (const auto& [path, write_time] : shaderFileTimes)
+		{
+			std::error_code error;
+			auto currentWriteTime = std::filesystem::last_write_time(path, error);
+			if (!error && currentWriteTime != write_time) modifiedFiles.emplace_back(path, currentWriteTime);
+		}
+
+		std::vector<std::string> modifiedPaths;
+		std::scoped_lock guard{ m_mutex };
+		for (auto& [path, write_time] : modifiedFiles)
+		{
+			m_shader_files.erase(path);
+			m_shader_file_times[path] = write_time; // Still watched if the next read fails (e.g. the file is being saved)
+			modifiedPaths.emplace_back(std::move(path));
+		}
+		return modifiedPaths;
+	}
+
+	size_t ShaderCache::ReleaseUnusedShaderModules()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return std::erase_if(m_shader_modules,
+			[](const auto& shader_module) { return shader_module.second.use_count() == 1; });
+	}
+
+}} // namespace Albedo::RHI
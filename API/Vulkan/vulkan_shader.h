@@ -0,0 +1,165 @@
+#pragma once
+
+#include "vulkan_memory.h"
+#include "vulkan_hash.h"
+
+#include <mutex>
+#include <filesystem>
+#include <span>
+#include <array>
+
+// Runtime SPIR-V reflection of shaders without a registered table (CMake: ALBEDO_RHI_RUNTIME_REFLECTION=OFF in release builds)
+#ifndef ALBEDO_RHI_RUNTIME_REFLECTION
+#define ALBEDO_RHI_RUNTIME_REFLECTION 1
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ShaderCache;
+
+	// Compact per-shader Reflection Record (Persistable, no SPIR-V Reflect types)
+	struct ShaderReflection
+	{
+		struct Binding
+		{
+			uint32_t set;
+			uint32_t binding;
+			VkDescriptorType type;
+			uint32_t count;
+		};
+
+		struct VertexInput
+		{
+			uint32_t location;
+			VkFormat format;
+		};
+
+		VkShaderStageFlagBits stage;
+		std::vector<Binding> descriptor_bindings;
+		std::vector<VkPushConstantRange> push_constants;	// stageFlags == stage
+		std::vector<VertexInput> vertex_inputs;					// Only vertex shaders (ascending locations, no built-ins)
+	};
+
+	// Build-time reflection record (Emitted as constexpr tables by AlbedoRHI_reflect, see albedo_rhi_reflect_shaders() in CMake)
+	struct ShaderReflectionTable
+	{
+		uint64_t hash; // HashBytes() of the SPIR-V file
+		VkShaderStageFlagBits stage;
+		std::span<const ShaderReflection::Binding> descriptor_bindings;
+		std::span<const VkPushConstantRange> push_constants;
+		std::span<const ShaderReflection::VertexInput> vertex_inputs;
+	};
+
+	// Array element of a generated block struct whose array stride exceeds the element (e.g. std140 float[N] has a 16-byte stride)
+	template<typename T, size_t STRIDE>
+	struct StridedElement
+	{
+		static_assert(STRIDE > sizeof(T), "Use T itself for tightly packed arrays!");
+		T value;
+		std::byte padding[STRIDE - sizeof(T)];
+	};
+
+	// Read-only memory mapping of a whole file (Views stay valid as long as the mapping lives)
+	class MappedFile
+	{
+	public:
+		std::span<const char> GetData() const { return { m_data, m_size }; }
+
+	public:
+		MappedFile() = delete;
+		MappedFile(std::string_view path);
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+
+	private:
+		void unmap();
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+		void* m_file = nullptr;		// Windows: File handle, POSIX: Unused
+		void* m_mapping = nullptr;	// Windows: File mapping handle
+	};
+
+	class ShaderModule
+	{
+		friend class ShaderCache;
+	public:
+		std::span<const char> GetBytecode() const { return m_bytecode; }
+		uint64_t GetHash() const { return m_hash; }
+		operator VkShaderModule() const { return m_shader_module; }
+
+	public:
+		ShaderModule() = delete;
+		ShaderModule(VulkanContext* vulkan_context, std::vector<char> bytecode, uint64_t hash);
+		// Zero-copy: The bytecode is a view of a mapped shader archive (4-byte aligned)
+		ShaderModule(VulkanContext* vulkan_context, std::shared_ptr<const MappedFile> archive, std::span<const char> bytecode, uint64_t hash);
+		~ShaderModule();
+		ShaderModule(const ShaderModule&) = delete;
+
+	private:
+		void create_shader_module();
+
+	private:
+		VulkanContext* m_context; // Modules never outlive the context (pipelines keep it alive)
+		std::vector<char> m_owned_bytecode;
+		std::shared_ptr<const MappedFile> m_archive; // Keeps the view alive
+		std::span<const char> m_bytecode;
+		uint64_t m_hash;
+		VkShaderModule m_shader_module = VK_NULL_HANDLE;
+	};
+
+	// Context-level Shader Cache (Dedupe SPIR-V files and modules by content hash)
+	class ShaderCache
+	{
+	public:
+		std::shared_ptr<ShaderModule> GetShaderModule(std::string_view shader_file); // One file read per path
+		std::shared_ptr<ShaderModule> GetShaderModule(std::vector<char> bytecode);
+		std::shared_ptr<const ShaderReflection> GetShaderReflection(const ShaderModule& shader_module); // Reflect once per content hash
+
+		// Reflection records can be persisted, so warm starts will skip SPIR-V reflection entirely
+		void LoadShaderReflections(std::string_view reflection_file);
+		void SaveShaderReflections(std::string_view reflection_file);
+		// Generated tables (e.g. Shaders::mesh_vert::REFLECTION) are served by GetShaderReflection() without reflecting the SPIR-V
+		void RegisterShaderReflections(std::span<const ShaderReflectionTable> tables);
+
+		// Shader Archive: One mapped file instead of one read per shader (Content hashes and reflections are pre-built)
+		// Archived paths are served by GetShaderModule(path) before the file system, and their bytecode is used in place.
+		void LoadShaderArchive(std::string_view archive_file);
+		void SaveShaderArchive(std::string_view archive_file, const std::vector<std::string>& shader_files); // Offline packing
+		// Build-time packing without a device (AlbedoRHI_pack): Shaders are reflected first, then their names, sources, lines and
+		// SPV_GOOGLE reflection decorations are stripped from the archived SPIR-V (Smaller archive, faster module creation)
+		static void PackShaderArchive(std::string_view archive_file, const std::vector<std::string>& shader_files, bool strip_debug_info = true);
+
+		void ForgetShaderFile(std::string_view shader_file);	// Re-read the file next time (e.g. modified on disk)
+		// Hot Reload: Files read by GetShaderModule(path) whose last write time changed since (They are forgotten, so they will be read again)
+		std::vector<std::string> CollectModifiedShaderFiles();
+		size_t ReleaseUnusedShaderModules();								// Destroy modules that are only referenced by the cache
+
+	public:
+		ShaderCache() = delete;
+		ShaderCache(VulkanContext* vulkan_context) : m_context{ vulkan_context } {}
+
+	private:
+		VulkanContext* m_context; // Owner
+		std::mutex m_mutex;
+		std::unordered_map<std::string, uint64_t> m_shader_files; // Path -> Content Hash
+		std::unordered_map<std::string, std::filesystem::file_time_type> m_shader_file_times; // Path -> Last write time before reading
+		std::unordered_map<uint64_t, std::shared_ptr<ShaderModule>> m_shader_modules;
+		std::unordered_map<uint64_t, std::shared_ptr<const ShaderReflection>> m_shader_reflections;
+
+		struct ArchivedShader
+		{
+			std::shared_ptr<const MappedFile> archive;
+			std::span<const char> bytecode;
+			uint64_t hash;
+		};
+		std::unordered_map<std::string, ArchivedShader> m_archived_shaders; // Path -> Mapped Bytecode
+
+	private:
+		static std::shared_ptr<const ShaderReflection> reflect_shader(std::span<const char> bytecode);
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,95 @@
+#include "vulkan_shading_rate.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	ShadingRateImage::ShadingRateImage(std::shared_ptr<VulkanContext> vulkan_context, uint32_t width, uint32_t height, uint32_t tile_size/* = 16*/) :
+		m_context{ std::move(vulkan_context) }
+	{
+		assert(width > 0 && height > 0 && "Invalid render area of the Shading Rate Image!");
+		if (!m_context->IsShadingRateAttachmentSupported())
+			throw std::runtime_error("Failed to create the Shading Rate Image - Shading rate attachments are not supported by this device!");
+
+		// Attachment texel sizes are powers of two
+		const auto& properties = m_context->m_physical_device_fragment_shading_rate_properties;
+		tile_size = std::bit_floor(std::max(tile_size, 1u));
+		m_tile_size =
+		{
+			.width = std::clamp(tile_size, properties.minFragmentShadingRateAttachmentTexelSize.width, properties.maxFragmentShadingRateAttachmentTexelSize.width),
+			.height = std::clamp(tile_size, properties.minFragmentShadingRateAttachmentTexelSize.height, properties.maxFragmentShadingRateAttachmentTexelSize.height)
+		};
+
+		m_image = m_context->m_memory_allocator->AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR | VK_IMAGE_USAGE_STORAGE_BIT,
+			(width + m_tile_size.width - 1) / m_tile_size.width, (height + m_tile_size.height - 1) / m_tile_size.height,
+			1, VK_FORMAT_R8_UINT);
+		if constexpr (EnableDebugMarkers)
+			m_image->SetDebugName(std::format("Shading Rate Image ({}x{} tiles)", m_tile_size.width, m_tile_size.height).c_str());
+	}
+
+	void ShadingRateImage::ClearCommand(CommandBuffer& command_buffer, VkExtent2D fragment_size/* = { 1, 1 }*/)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		m_image->TransitionCommand(command_buffer, ResourceAccess::FromLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+		command_buffer.FlushBarriers();
+
+		const VkClearColorValue clearValue{ .uint32 = { EncodeRate(fragment_size), 0, 0, 0 } };
+		const VkImageSubresourceRange range
+		{
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = 1,
+			.baseArrayLayer = 0,
+			.layerCount = 1
+		};
+		command_buffer.GetDispatch().vkCmdClearColorImage(command_buffer, *m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearValue, 1, &range);
+		transition_for_rendering(command_buffer);
+	}
+
+	void ShadingRateImage::GenerateCommand(CommandBuffer& command_buffer, ComputePipeline& rate_pipeline, VMA::Image& source, float threshold)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		source.TransitionCommand(command_buffer,
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+		m_image->TransitionCommand(command_buffer,
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL });
+
+		rate_pipeline.Bind(command_buffer);
+		auto descriptorSet = m_context->CreateDescriptorSet(rate_pipeline.GetSharedDescriptorSetLayout(0)); // Freed through the deletion queue
+		DescriptorWriteBatch{ m_context, 2 }
+			.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0, source.GetSampledImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+			.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, m_image->GetImageView(), VK_IMAGE_LAYOUT_GENERAL)
+			.Flush();
+
+		const PushConstants pushConstants
+		{
+			.tile_size = m_tile_size,
+			.source_extent = { source.Width(), source.Height() },
+			.threshold = threshold
+		};
+		command_buffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, rate_pipeline.GetPipelineLayout(), 0, { *descriptorSet });
+		command_buffer.PushConstants(rate_pipeline.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		rate_pipeline.Dispatch(command_buffer, (m_image->Width() + 7) / 8, (m_image->Height() + 7) / 8);
+		transition_for_rendering(command_buffer);
+	}
+
+	VkRenderingFragmentShadingRateAttachmentInfoKHR ShadingRateImage::GetAttachmentInfo()
+	{
+		return VkRenderingFragmentShadingRateAttachmentInfoKHR
+		{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR,
+			.imageView = m_image->GetImageView(),
+			.imageLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR,
+			.shadingRateAttachmentTexelSize = m_tile_size
+		};
+	}
+
+	void ShadingRateImage::transition_for_rendering(CommandBuffer& command_buffer)
+	{
+		m_image->TransitionCommand(command_buffer, ResourceAccess::FromLayout(VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR));
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <bit>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ComputePipeline;
+
+	// Attachment-based Variable Rate Shading (VulkanContext::IsShadingRateAttachmentSupported())
+	// One R8_UINT texel per tile of the render area holds the fragment size of the tile, encoded as (log2(width) << 2) | log2(height)
+	// (0: 1x1, 5: 2x2, 10: 4x4). Generate it from the luminance or the motion of the last frame, and pass GetAttachmentInfo() as
+	// DynamicRenderPass::Attachments::shading_rate (RenderingFormats::shading_rate_attachment). Recreate it when the render area is resized.
+	class ShadingRateImage
+	{
+	public:
+		static constexpr uint32_t EncodeRate(VkExtent2D fragment_size) { return (std::countr_zero(fragment_size.width) << 2) | std::countr_zero(fragment_size.height); }
+
+		// Uniform rate of every tile (e.g. before the first generated frame), the image is left in FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR
+		void ClearCommand(CommandBuffer& command_buffer, VkExtent2D fragment_size = { 1, 1 });
+		// Set 0 of the pipeline: binding 0 - source (Sampled image, e.g. the tonemapped color or the motion vectors of the last frame),
+		// binding 1 - this image (Storage image, r8ui), push constant: PushConstants. Dispatched with 8x8x1 work groups over the tiles,
+		// the image is left in FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR and the source in SHADER_READ_ONLY_OPTIMAL.
+		struct PushConstants
+		{
+			VkExtent2D tile_size;
+			VkExtent2D source_extent;
+			float threshold; // e.g. Luminance contrast or motion (Texels per frame) below which the tile is coarsened
+		};
+		void GenerateCommand(CommandBuffer& command_buffer, ComputePipeline& rate_pipeline, VMA::Image& source, float threshold);
+
+		VkRenderingFragmentShadingRateAttachmentInfoKHR GetAttachmentInfo();
+		VkExtent2D GetTileSize() const { return m_tile_size; }
+		std::shared_ptr<VMA::Image> GetImage() { return m_image; }
+
+	public:
+		ShadingRateImage() = delete;
+		// Covers a render area of width x height, tile_size is clamped to the supported attachment texel sizes
+		ShadingRateImage(std::shared_ptr<VulkanContext> vulkan_context, uint32_t width, uint32_t height, uint32_t tile_size = 16);
+		ShadingRateImage(const ShadingRateImage&) = delete;
+
+	private:
+		void transition_for_rendering(CommandBuffer& command_buffer);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::shared_ptr<VMA::Image> m_image;
+		VkExtent2D m_tile_size;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,430 @@
+#include "vulkan_sparse.h"
+#include "vulkan_context.h"
+
+#include <vk_mem_alloc.h>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		uint32_t divide_round_up(uint32_t value, uint32_t divisor) { return (value + divisor - 1) / divisor; }
+
+		VmaAllocationInfo get_allocation_info(VmaAllocator allocator, VmaAllocation allocation)
+		{
+			VmaAllocationInfo allocationInfo;
+			vmaGetAllocationInfo(allocator, allocation, &allocationInfo);
+			return allocationInfo;
+		}
+	} // namespace
+
+	SparseImage::SparseImage(std::shared_ptr<ResidencyManager> residency_manager, std::shared_ptr<VMA::Image> image) :
+		m_manager{ std::move(residency_manager) },
+		m_image{ std::move(image) }
+	{
+		auto device = m_manager->m_context->m_device;
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, *m_image, &memoryRequirements);
+		m_page_size = memoryRequirements.alignment; // Sparse block size
+		m_memory_type_bits = memoryRequirements.memoryTypeBits;
+
+		uint32_t requirementCount = 0;
+		vkGetImageSparseMemoryRequirements(device, *m_image, &requirementCount, nullptr);
+		std::vector<VkSparseImageMemoryRequirements> sparseRequirements(requirementCount);
+		vkGetImageSparseMemoryRequirements(device, *m_image, &requirementCount, sparseRequirements.data());
+
+		auto colorRequirement = std::find_if(sparseRequirements.begin(), sparseRequirements.end(),
+			[](const auto& requirement) { return !(requirement.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT); });
+		if (colorRequirement == sparseRequirements.end())
+			throw std::runtime_error("Failed to create the Sparse Image - The format is not supported by sparse residency!");
+		if (colorRequirement->formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_NONSTANDARD_BLOCK_SIZE_BIT)
+			log::warn("The sparse block of format {} has a non-standard size", static_cast<int>(m_image->m_image_format));
+		m_aspect = colorRequirement->formatProperties.aspectMask;
+		m_page_extent = colorRequirement->formatProperties.imageGranularity;
+		m_mip_tail_first_level = std::min(colorRequirement->imageMipTailFirstLod, m_image->MipLevels());
+
+		// Page Table
+		m_level_first_pages.reserve(m_mip_tail_first_level + 1);
+		uint32_t pageCount = 0;
+		for (uint32_t mip_level = 0; mip_level < m_mip_tail_first_level; ++mip_level)
+		{
+			m_level_first_pages.emplace_back(pageCount);
+			auto levelPages = GetPageCount(mip_level);
+			pageCount += levelPages.width * levelPages.height * levelPages.depth * m_image->ArrayLayers();
+		}
+		m_level_first_pages.emplace_back(pageCount);
+		m_page_table.resize(pageCount);
+
+		// Mip Tails (Resident, also the metadata of the whole image)
+		auto vma = m_manager->m_context->m_memory_allocator;
+		VmaAllocationCreateInfo allocationInfo{ .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+		for (const auto& requirement : sparseRequirements)
+		{
+			bool isMetadata = requirement.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT;
+			if (!isMetadata && requirement.imageMipTailFirstLod >= m_image->MipLevels()) continue;
+			bool isSingle = requirement.formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT;
+			uint32_t tailCount = isSingle ? 1 : m_image->ArrayLayers();
+			for (uint32_t tail = 0; tail < tailCount; ++tail)
+			{
+				VkMemoryRequirements tailRequirements
+				{
+					.size = requirement.imageMipTailSize,
+					.alignment = memoryRequirements.alignment,
+					.memoryTypeBits = m_memory_type_bits
+				};
+				VmaAllocation allocation = VK_NULL_HANDLE;
+				if (vmaAllocateMemory(vma->m_allocator, &tailRequirements, &allocationInfo, &allocation, nullptr) != VK_SUCCESS)
+				{
+					for (auto mip_tail : m_mip_tail_allocations) vmaFreeMemory(vma->m_allocator, mip_tail);
+					throw std::runtime_error("Failed to allocate the mip tail of the Sparse Image!");
+				}
+				m_mip_tail_allocations.emplace_back(allocation);
+			}
+		}
+	}
+
+	SparseImage::~SparseImage()
+	{
+		m_manager->release_image(*this);
+	}
+
+	uint32_t SparseImage::GetPageIndex(const Page& page) const
+	{
+		assert(page.mip_level < m_mip_tail_first_level && page.array_layer < m_image->ArrayLayers() && "The page is in the mip tail!");
+		auto levelPages = GetPageCount(page.mip_level);
+		assert(page.x < levelPages.width && page.y < levelPages.height && page.z < levelPages.depth && "Invalid page coordinate!");
+		return m_level_first_pages[page.mip_level] +
+			((page.array_layer * levelPages.depth + page.z) * levelPages.height + page.y) * levelPages.width + page.x;
+	}
+
+	SparseImage::Page SparseImage::GetPage(uint32_t page_index) const
+	{
+		assert(page_index < GetPageCount() && "Invalid page index!");
+		auto level = std::upper_bound(m_level_first_pages.begin(), m_level_first_pages.end(), page_index) - m_level_first_pages.begin() - 1;
+		auto levelPages = GetPageCount(static_cast<uint32_t>(level));
+		uint32_t index = page_index - m_level_first_pages[level];
+		Page page{ .mip_level = static_cast<uint32_t>(level) };
+		page.x = index % levelPages.width;		index /= levelPages.width;
+		page.y = index % levelPages.height;	index /= levelPages.height;
+		page.z = index % levelPages.depth;		index /= levelPages.depth;
+		page.array_layer = index;
+		return page;
+	}
+
+	VkExtent3D SparseImage::GetPageCount(uint32_t mip_level) const
+	{
+		auto extent = m_image->get_mip_extent(mip_level);
+		return VkExtent3D
+		{
+			.width = divide_round_up(extent.width, m_page_extent.width),
+			.height = divide_round_up(extent.height, m_page_extent.height),
+			.depth = divide_round_up(extent.depth, m_page_extent.depth)
+		};
+	}
+
+	VkBufferImageCopy SparseImage::GetPageCopyRegion(uint32_t page_index, VkDeviceSize buffer_offset/* = 0*/) const
+	{
+		auto bind = make_bind(page_index, VK_NULL_HANDLE);
+		return VkBufferImageCopy
+		{
+			.bufferOffset = buffer_offset,
+			.bufferRowLength = 0, // Tightly packed
+			.bufferImageHeight = 0,
+			.imageSubresource
+			{
+				.aspectMask = m_image->m_view_aspect,
+				.mipLevel = bind.subresource.mipLevel,
+				.baseArrayLayer = bind.subresource.arrayLayer,
+				.layerCount = 1
+			},
+			.imageOffset = bind.offset,
+			.imageExtent = bind.extent
+		};
+	}
+
+	VkSparseImageMemoryBind SparseImage::make_bind(uint32_t page_index, VmaAllocation allocation) const
+	{
+		auto page = GetPage(page_index);
+		auto extent = m_image->get_mip_extent(page.mip_level);
+		VmaAllocationInfo allocationInfo{};
+		if (allocation) allocationInfo = get_allocation_info(m_manager->m_context->m_memory_allocator->m_allocator, allocation);
+		VkOffset3D offset
+		{
+			.x = static_cast<int32_t>(page.x * m_page_extent.width),
+			.y = static_cast<int32_t>(page.y * m_page_extent.height),
+			.z = static_cast<int32_t>(page.z * m_page_extent.depth)
+		};
+		return VkSparseImageMemoryBind
+		{
+			.subresource{ .aspectMask = m_aspect, .mipLevel = page.mip_level, .arrayLayer = page.array_layer },
+			.offset = offset,
+			.extent // The last pages of a level may be partial
+			{
+				.width = std::min(m_page_extent.width, extent.width - static_cast<uint32_t>(offset.x)),
+				.height = std::min(m_page_extent.height, extent.height - static_cast<uint32_t>(offset.y)),
+				.depth = std::min(m_page_extent.depth, extent.depth - static_cast<uint32_t>(offset.z))
+			},
+			.memory = allocationInfo.deviceMemory, // VK_NULL_HANDLE unbinds
+			.memoryOffset = allocationInfo.offset
+		};
+	}
+
+	ResidencyManager::ResidencyManager(std::shared_ptr<VulkanContext> vulkan_context, uint32_t page_budget, uint32_t eviction_delay/* = 3*/) :
+		m_context{ std::move(vulkan_context) },
+		m_page_budget{ page_budget },
+		m_eviction_delay{ eviction_delay }
+	{
+		assert(eviction_delay > 0 && "Pages bound by an update must not be evicted by the same one!");
+		if (!m_context->IsSparseResidencySupported())
+			throw std::runtime_error("Failed to create the Residency Manager - Sparse residency is not supported by this device!");
+		m_semaphore = std::make_unique<Semaphore>(m_context, 0x0, 0);
+	}
+
+	ResidencyManager::~ResidencyManager()
+	{
+		m_semaphore->Wait(m_bind_tick);
+		collect_released_pages();
+	}
+
+	std::shared_ptr<SparseImage> ResidencyManager::CreateSparseImage(VkImageAspectFlags aspect, VkImageUsageFlags usage,
+		uint32_t width, uint32_t height, uint32_t channel, VkFormat format,
+		uint32_t miplevel/* = 0*/, VMA::ImageType image_type/* = VMA::ImageType::IMAGE_2D*/, uint32_t depth_or_layers/* = 1*/)
+	{
+		auto image = m_context->m_memory_allocator->AllocateSparseImage(aspect, usage, width, height, channel, format, miplevel, image_type, depth_or_layers);
+		auto sparseImage = std::make_shared<SparseImage>(shared_from_this(), std::move(image));
+		if (!sparseImage->m_mip_tail_allocations.empty())
+		{
+			std::scoped_lock guard{ m_mutex };
+			m_pending_mip_tails.emplace_back(sparseImage.get());
+		}
+		return sparseImage;
+	}
+
+	void ResidencyManager::Request(SparseImage& sparse_image, uint32_t page_index)
+	{
+		Request(sparse_image, std::span<const uint32_t>{ &page_index, 1 });
+	}
+
+	void ResidencyManager::Request(SparseImage& sparse_image, std::span<const uint32_t> page_indices)
+	{
+		std::scoped_lock guard{ m_mutex };
+		for (auto page_index : page_indices)
+		{
+			if (page_index >= sparse_image.GetPageCount()) continue;
+			auto& page = sparse_image.m_page_table[page_index];
+			if (page.requested_frame == m_frame) continue;
+			page.requested_frame = m_frame;
+			if (page.allocation) m_lru.splice(m_lru.begin(), m_lru, page.lru); // Most recently requested
+			else m_requests.emplace_back(&sparse_image, page_index);
+		}
+	}
+
+	ResidencyManager::ResidencyUpdate ResidencyManager::Update()
+	{
+		std::scoped_lock guard{ m_mutex };
+		collect_released_pages();
+		ResidencyUpdate update;
+
+		// Binds per image (Grouped in the order of the first touch)
+		std::vector<SparseImage*> boundImages;
+		std::vector<std::vector<VkSparseImageMemoryBind>> imageBinds;
+		auto bindsOf = [&](SparseImage* sparse_image) -> std::vector<VkSparseImageMemoryBind>&
+		{
+			auto image = std::find(boundImages.begin(), boundImages.end(), sparse_image);
+			if (image != boundImages.end()) return imageBinds[image - boundImages.begin()];
+			boundImages.emplace_back(sparse_image);
+			return imageBinds.emplace_back();
+		};
+
+		std::vector<VmaAllocation> evictedAllocations;
+		auto& vma = m_context->m_memory_allocator;
+		for (auto& [sparse_image, page_index] : m_requests)
+		{
+			auto& page = sparse_image->m_page_table[page_index];
+			if (page.allocation) continue; // Duplicated request
+
+			if (m_lru.size() >= m_page_budget)
+			{
+				// Evict the least recently requested page unless it is still in use
+				if (m_lru.empty()) break;
+				auto [victim_image, victim_index] = m_lru.back();
+				auto& victim = victim_image->m_page_table[victim_index];
+				if (victim.requested_frame + m_eviction_delay > m_frame) break; // Over budget, retried by the next requests
+				bindsOf(victim_image).emplace_back(victim_image->make_bind(victim_index, VK_NULL_HANDLE));
+				evictedAllocations.emplace_back(victim.allocation);
+				victim.allocation = VK_NULL_HANDLE;
+				--victim_image->m_resident_page_count;
+				m_lru.pop_back();
+				update.evicted_pages.emplace_back(victim_image, victim_index);
+			}
+
+			VkMemoryRequirements pageRequirements
+			{
+				.size = sparse_image->m_page_size,
+				.alignment = sparse_image->m_page_size,
+				.memoryTypeBits = sparse_image->m_memory_type_bits
+			};
+			VmaAllocationCreateInfo allocationInfo{ .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+			if (vmaAllocateMemory(vma->m_allocator, &pageRequirements, &allocationInfo, &page.allocation, nullptr) != VK_SUCCESS)
+			{
+				log::warn("Failed to allocate the memory of a sparse page - {} pages are resident", m_lru.size());
+				page.allocation = VK_NULL_HANDLE;
+				break;
+			}
+			bindsOf(sparse_image).emplace_back(sparse_image->make_bind(page_index, page.allocation));
+			page.lru = m_lru.emplace(m_lru.begin(), sparse_image, page_index);
+			++sparse_image->m_resident_page_count;
+			update.bound_pages.emplace_back(sparse_image, page_index);
+		}
+		m_requests.clear();
+
+		// Mip tails of the new images
+		std::vector<std::vector<VkSparseMemoryBind>> opaqueBinds;
+		for (auto sparse_image : m_pending_mip_tails)
+		{
+			auto device = m_context->m_device;
+			uint32_t requirementCount = 0;
+			vkGetImageSparseMemoryRequirements(device, *sparse_image->m_image, &requirementCount, nullptr);
+			std::vector<VkSparseImageMemoryRequirements> sparseRequirements(requirementCount);
+			vkGetImageSparseMemoryRequirements(device, *sparse_image->m_image, &requirementCount, sparseRequirements.data());
+
+			auto& binds = opaqueBinds.emplace_back();
+			auto allocation = sparse_image->m_mip_tail_allocations.begin();
+			for (const auto& requirement : sparseRequirements) // In the order of the allocations
+			{
+				bool isMetadata = requirement.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT;
+				if (!isMetadata && requirement.imageMipTailFirstLod >= sparse_image->m_image->MipLevels()) continue;
+				bool isSingle = requirement.formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT;
+				uint32_t tailCount = isSingle ? 1 : sparse_image->m_image->ArrayLayers();
+				for (uint32_t tail = 0; tail < tailCount; ++tail, ++allocation)
+				{
+					auto allocationInfo = get_allocation_info(vma->m_allocator, *allocation);
+					binds.emplace_back(VkSparseMemoryBind
+						{
+							.resourceOffset = requirement.imageMipTailOffset + tail * requirement.imageMipTailStride,
+							.size = requirement.imageMipTailSize,
+							.memory = allocationInfo.deviceMemory,
+							.memoryOffset = allocationInfo.offset,
+							.flags = isMetadata ? VkSparseMemoryBindFlags(VK_SPARSE_MEMORY_BIND_METADATA_BIT) : VkSparseMemoryBindFlags(0)
+						});
+				}
+			}
+		}
+
+		if (imageBinds.empty() && opaqueBinds.empty())
+		{
+			m_pending_mip_tails.clear();
+			++m_frame;
+			return update;
+		}
+
+		std::vector<VkSparseImageMemoryBindInfo> imageBindInfos;
+		imageBindInfos.reserve(imageBinds.size());
+		for (size_t index = 0; index < imageBinds.size(); ++index)
+		{
+			imageBindInfos.emplace_back(VkSparseImageMemoryBindInfo
+				{
+					.image = *boundImages[index]->m_image,
+					.bindCount = static_cast<uint32_t>(imageBinds[index].size()),
+					.pBinds = imageBinds[index].data()
+				});
+		}
+		std::vector<VkSparseImageOpaqueMemoryBindInfo> opaqueBindInfos;
+		opaqueBindInfos.reserve(opaqueBinds.size());
+		for (size_t index = 0; index < opaqueBinds.size(); ++index)
+		{
+			opaqueBindInfos.emplace_back(VkSparseImageOpaqueMemoryBindInfo
+				{
+					.image = *m_pending_mip_tails[index]->m_image,
+					.bindCount = static_cast<uint32_t>(opaqueBinds[index].size()),
+					.pBinds = opaqueBinds[index].data()
+				});
+		}
+
+		// After the graphics work submitted so far (Evicted pages may be sampled) and the previous binds (Ordered ticks)
+		auto graphicsTimeline = m_context->GetGlobalQueueTimeline(m_context->m_device_queue_family_graphics);
+		std::array<VkSemaphore, 2> waitSemaphores{ graphicsTimeline->GetSemaphore(), *m_semaphore };
+		std::array<uint64_t, 2> waitValues{ graphicsTimeline->GetSubmittedTick(), m_bind_tick };
+		VkSemaphore signalSemaphore = *m_semaphore;
+		uint64_t signalValue = m_bind_tick + 1;
+
+		VkTimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+			.pWaitSemaphoreValues = waitValues.data(),
+			.signalSemaphoreValueCount = 1,
+			.pSignalSemaphoreValues = &signalValue
+		};
+		VkBindSparseInfo bindSparseInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO,
+			.pNext = &timelineSemaphoreSubmitInfo,
+			.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+			.pWaitSemaphores = waitSemaphores.data(),
+			.imageOpaqueBindCount = static_cast<uint32_t>(opaqueBindInfos.size()),
+			.pImageOpaqueBinds = opaqueBindInfos.data(),
+			.imageBindCount = static_cast<uint32_t>(imageBindInfos.size()),
+			.pImageBinds = imageBindInfos.data(),
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores = &signalSemaphore
+		};
+		m_context->GetGlobalQueueTimeline(m_context->m_device_queue_family_sparsebinding)->BindSparse(bindSparseInfo);
+
+		m_bind_tick = signalValue;
+		for (auto sparse_image : boundImages) sparse_image->m_bind_tick = m_bind_tick;
+		for (auto sparse_image : m_pending_mip_tails) sparse_image->m_bind_tick = m_bind_tick;
+		m_pending_mip_tails.clear();
+		if (!evictedAllocations.empty()) m_released_pages.emplace_back(m_bind_tick, std::move(evictedAllocations));
+
+		update.bind_tick = m_bind_tick;
+		++m_frame;
+		return update;
+	}
+
+	VkSemaphore ResidencyManager::GetSemaphore()
+	{
+		return *m_semaphore;
+	}
+
+	uint32_t ResidencyManager::GetResidentPageCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return static_cast<uint32_t>(m_lru.size());
+	}
+
+	void ResidencyManager::release_image(SparseImage& sparse_image)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_semaphore->Wait(sparse_image.m_bind_tick); // The image must outlive its binds
+
+		std::erase_if(m_requests, [&sparse_image](const auto& request) { return request.first == &sparse_image; });
+		std::erase(m_pending_mip_tails, &sparse_image);
+		std::vector<VmaAllocation> allocations = std::move(sparse_image.m_mip_tail_allocations);
+		for (auto& page : sparse_image.m_page_table)
+		{
+			if (!page.allocation) continue;
+			allocations.emplace_back(page.allocation);
+			m_lru.erase(page.lru);
+		}
+
+		// The graphics queue may still sample the image
+		m_context->DeferDeletion([allocator = m_context->m_memory_allocator, allocations = std::move(allocations)]()
+			{
+				for (auto allocation : allocations) vmaFreeMemory(allocator->m_allocator, allocation);
+			});
+	}
+
+	void ResidencyManager::collect_released_pages()
+	{
+		uint64_t completedTick = m_semaphore->GetCounterValue();
+		auto& vma = m_context->m_memory_allocator;
+		std::erase_if(m_released_pages, [&](const auto& released_pages)
+			{
+				if (released_pages.first > completedTick) return false;
+				for (auto allocation : released_pages.second) vmaFreeMemory(vma->m_allocator, allocation);
+				return true;
+			});
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <list>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class Semaphore;
+	class ResidencyManager;
+
+	// Partially resident image: The levels above the mip tail are split into pages of the sparse block granularity (page table),
+	// and the ResidencyManager binds memory to the requested pages only. The mip tail is always resident.
+	// Non-resident pages read as zero only with residencyNonResidentStrict, sample them with sparseTextureARB-style residency codes.
+	class SparseImage
+	{
+		friend class ResidencyManager;
+	public:
+		struct Page
+		{
+			uint32_t mip_level = 0;
+			uint32_t array_layer = 0;
+			uint32_t x = 0, y = 0, z = 0; // In pages
+		};
+		// Page Table: Levels (above the mip tail) -> layers -> z -> y -> x (Feedback shaders write these indices)
+		uint32_t GetPageIndex(const Page& page) const;
+		Page GetPage(uint32_t page_index) const;
+		uint32_t GetPageCount() const { return static_cast<uint32_t>(m_page_table.size()); }
+		VkExtent3D GetPageCount(uint32_t mip_level) const; // Pages of one layer
+		VkExtent3D GetPageExtent() const { return m_page_extent; } // Texels (imageGranularity)
+		VkDeviceSize GetPageSize() const { return m_page_size; } // Bytes (Sparse block size)
+		uint32_t GetMipTailFirstLevel() const { return m_mip_tail_first_level; } // The levels from here on are always resident
+		bool IsResident(uint32_t page_index) const { return m_page_table[page_index].allocation != VK_NULL_HANDLE; } // Bound by a committed update
+		uint32_t GetResidentPageCount() const { return m_resident_page_count; }
+
+		// Write a page after its bind completed (ResidencyManager::ResidencyUpdate::bind_tick): Texels clipped to the extent of the level
+		VkBufferImageCopy GetPageCopyRegion(uint32_t page_index, VkDeviceSize buffer_offset = 0) const;
+		std::shared_ptr<VMA::Image> GetImage() { return m_image; }
+
+	public:
+		SparseImage() = delete;
+		SparseImage(std::shared_ptr<ResidencyManager> residency_manager, std::shared_ptr<VMA::Image> image);
+		~SparseImage(); // Its memory is released after the GPU has passed the submitted work
+		SparseImage(const SparseImage&) = delete;
+
+	private:
+		using LRUList = std::list<std::pair<SparseImage*, uint32_t>>; // Resident pages of the manager, most recently requested first
+		struct PageEntry
+		{
+			VmaAllocation allocation = VK_NULL_HANDLE;
+			uint64_t requested_frame = 0; // Last Request() (0: Never)
+			LRUList::iterator lru;
+		};
+		VkSparseImageMemoryBind make_bind(uint32_t page_index, VmaAllocation allocation) const; // VK_NULL_HANDLE unbinds
+
+	private:
+		std::shared_ptr<ResidencyManager> m_manager;
+		std::shared_ptr<VMA::Image> m_image;
+		VkImageAspectFlags m_aspect;
+		VkExtent3D m_page_extent;
+		VkDeviceSize m_page_size;
+		uint32_t m_memory_type_bits;
+		uint32_t m_mip_tail_first_level;
+		std::vector<uint32_t> m_level_first_pages; // Per level above the mip tail (+ the end)
+		std::vector<PageEntry> m_page_table;
+		uint32_t m_resident_page_count = 0;
+		std::vector<VmaAllocation> m_mip_tail_allocations; // Bound by the first update
+		uint64_t m_bind_tick = 0; // Last bind touching this image
+	};
+
+	// Feedback-driven residency of sparse images under a fixed page budget.
+	// Each frame: Request() the pages needed (e.g. page indices written by a feedback pass and read back via ReadbackEngine),
+	// then Update() binds the missing ones in one vkQueueBindSparse and evicts the least recently requested pages beyond the budget.
+	class ResidencyManager : public std::enable_shared_from_this<ResidencyManager>
+	{
+		friend class SparseImage;
+	public:
+		struct ResidencyUpdate
+		{
+			uint64_t bind_tick = 0; // Wait GetSemaphore() with this value before writing the bound pages (0: Nothing changed)
+			std::vector<std::pair<SparseImage*, uint32_t>> bound_pages; // Undefined contents, upload them (see SparseImage::GetPageCopyRegion())
+			std::vector<std::pair<SparseImage*, uint32_t>> evicted_pages;
+		};
+
+		std::shared_ptr<SparseImage> CreateSparseImage(VkImageAspectFlags aspect, VkImageUsageFlags usage,
+			uint32_t width, uint32_t height, uint32_t channel, VkFormat format,
+			uint32_t miplevel = 0, VMA::ImageType image_type = VMA::ImageType::IMAGE_2D, uint32_t depth_or_layers = 1);
+
+		void Request(SparseImage& sparse_image, uint32_t page_index); // Thread-safe
+		void Request(SparseImage& sparse_image, std::span<const uint32_t> page_indices); // Out of range indices are ignored
+		// Call once per frame. The binds wait for the graphics work submitted so far, so evicted pages are not sampled anymore.
+		// Pages requested within the last eviction_delay frames are never evicted, requests beyond the budget stay pending.
+		ResidencyUpdate Update();
+
+		VkSemaphore GetSemaphore(); // Timeline signaled by the binds
+		uint32_t GetPageBudget() const { return m_page_budget; }
+		uint32_t GetResidentPageCount();
+
+	public:
+		ResidencyManager() = delete; // Create it with std::make_shared (Sparse images keep it alive)
+		ResidencyManager(std::shared_ptr<VulkanContext> vulkan_context, uint32_t page_budget, uint32_t eviction_delay = 3);
+		~ResidencyManager();
+		ResidencyManager(const ResidencyManager&) = delete;
+
+	private:
+		void release_image(SparseImage& sparse_image); // Called by ~SparseImage()
+		void collect_released_pages(); // Synchronized by the caller
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		const uint32_t m_page_budget;
+		const uint32_t m_eviction_delay;
+		std::unique_ptr<Semaphore> m_semaphore; // Timeline
+		uint64_t m_bind_tick = 0;
+		uint64_t m_frame = 1;
+
+		std::mutex m_mutex;
+		std::vector<std::pair<SparseImage*, uint32_t>> m_requests; // Not resident, in request order
+		std::vector<SparseImage*> m_pending_mip_tails; // Created since the last update
+		SparseImage::LRUList m_lru;
+		std::vector<std::pair<uint64_t, std::vector<VmaAllocation>>> m_released_pages; // Unbound at the tick
+	};
+
+}} // namespace Albedo::RHI
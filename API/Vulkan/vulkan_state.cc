@@ -0,0 +1,335 @@
+#include "vulkan_state.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Albedo {
+namespace RHI
+{
+	ResourceAccess ResourceAccess::FromLayout(VkImageLayout layout)
+	{
+		constexpr VkPipelineStageFlags2 depthStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+		switch (layout)
+		{
+		case VK_IMAGE_LAYOUT_UNDEFINED:
+		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: // Presentation is synchronized by semaphores
+			return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, layout };
+		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+			return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, layout };
+		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+			return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, layout };
+		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+			return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, layout };
+		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+			return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, layout };
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+		case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+		case VK_IMAGE_LAYOUT_STENCIL_ATTACHMENT_OPTIMAL:
+		case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL:
+		case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_STENCIL_READ_ONLY_OPTIMAL:
+			return { depthStages,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, layout };
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL: // Depth testing and sampling
+		case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
+		case VK_IMAGE_LAYOUT_STENCIL_READ_ONLY_OPTIMAL:
+			return { depthStages | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, layout };
+		case VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL:
+			return { depthStages | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, layout };
+		case VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR:
+			return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR, VK_ACCESS_2_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR, layout };
+		case VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL:
+			return { depthStages | VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, layout };
+		default: // GENERAL and others (Conservative)
+			return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, layout };
+		}
+	}
+
+	VkPipelineStageFlags ResourceAccess::ToLegacyStages(VkPipelineStageFlags2 stages)
+	{
+		// The low 32 bits are shared with the legacy flags
+		VkPipelineStageFlags legacyStages = static_cast<VkPipelineStageFlags>(stages & 0xFFFFFFFFull);
+		if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT |
+			VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT))
+			legacyStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+		if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT))
+			legacyStages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+		if (stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT)
+			legacyStages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT |
+				VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT;
+		return legacyStages;
+	}
+
+	VkAccessFlags ResourceAccess::ToLegacyAccess(VkAccessFlags2 access)
+	{
+		VkAccessFlags legacyAccess = static_cast<VkAccessFlags>(access & 0xFFFFFFFFull);
+		if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT))
+			legacyAccess |= VK_ACCESS_SHADER_READ_BIT;
+		if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT)
+			legacyAccess |= VK_ACCESS_SHADER_WRITE_BIT;
+		return legacyAccess;
+	}
+
+	bool ResourceState::Transition(const ResourceAccess& access, bool is_image, Dependency& dependency)
+	{
+		VkImageLayout newLayout = (is_image && access.layout != VK_IMAGE_LAYOUT_UNDEFINED) ? access.layout : layout;
+		bool isLayoutChanged = newLayout != layout;
+		bool isOwnershipChanged = queue_family != VK_QUEUE_FAMILY_IGNORED &&
+			access.queue_family != VK_QUEUE_FAMILY_IGNORED && queue_family != access.queue_family;
+		bool isWrite = access.IsWrite();
+
+		dependency = Dependency
+		{
+			.src_stages = write_stages,
+			.src_access = write_access,
+			.old_layout = layout,
+			.new_layout = newLayout,
+			.src_family = isOwnershipChanged ? queue_family : VK_QUEUE_FAMILY_IGNORED,
+			.dst_family = isOwnershipChanged ? access.queue_family : VK_QUEUE_FAMILY_IGNORED
+		};
+		if (access.queue_family != VK_QUEUE_FAMILY_IGNORED) queue_family = access.queue_family;
+
+		if (isWrite || isLayoutChanged || isOwnershipChanged)
+		{
+			// Write-after-read and write-after-write also wait for the readers (Execution dependency only)
+			dependency.src_stages |= read_stages;
+			bool isNeeded = isLayoutChanged || isOwnershipChanged || dependency.src_stages != VK_PIPELINE_STAGE_2_NONE;
+
+			layout = newLayout;
+			write_stages = access.stages; // Layout transitions and ownership transfers count as writes
+			write_access = access.access & ResourceAccess::WRITE_ACCESS_MASK;
+			read_stages = isWrite ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+			visible_stages = isWrite ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+			visible_access = isWrite ? VK_ACCESS_2_NONE : access.access;
+			return isNeeded;
+		}
+
+		// Read-after-write (Skipped if the last write is already visible to these readers)
+		bool isNeeded = write_stages != VK_PIPELINE_STAGE_2_NONE &&
+			((access.stages & ~visible_stages) || (access.access & ~visible_access));
+		if (isNeeded)
+		{
+			visible_stages |= access.stages;
+			visible_access |= access.access;
+		}
+		read_stages |= access.stages;
+		return isNeeded;
+	}
+
+	void ResourceState::Assume(const ResourceAccess& access, bool is_image)
+	{
+		if (is_image && access.layout != VK_IMAGE_LAYOUT_UNDEFINED) layout = access.layout;
+		if (access.queue_family != VK_QUEUE_FAMILY_IGNORED) queue_family = access.queue_family;
+		bool isWrite = access.IsWrite();
+		write_stages = isWrite ? access.stages : VK_PIPELINE_STAGE_2_NONE; // Reads were already made visible
+		write_access = access.access & ResourceAccess::WRITE_ACCESS_MASK;
+		read_stages = isWrite ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+		visible_stages = VK_PIPELINE_STAGE_2_NONE;
+		visible_access = VK_ACCESS_2_NONE;
+	}
+
+	void ImageStateTracker::Reset(uint32_t mip_levels, uint32_t array_layers, VkImageAspectFlags aspect, VkImageLayout layout/* = VK_IMAGE_LAYOUT_UNDEFINED*/)
+	{
+		assert(mip_levels > 0 && array_layers > 0 && "An image has at least one subresource!");
+		m_mip_levels = mip_levels;
+		m_array_layers = array_layers;
+		m_aspect = aspect;
+		m_states.assign(static_cast<size_t>(mip_levels) * array_layers, ResourceState{ .layout = layout });
+	}
+
+	VkImageSubresourceRange ImageStateTracker::GetWholeRange() const
+	{
+		return VkImageSubresourceRange
+		{
+			.aspectMask = m_aspect,
+			.baseMipLevel = 0,
+			.levelCount = m_mip_levels,
+			.baseArrayLayer = 0,
+			.layerCount = m_array_layers
+		};
+	}
+
+	void ImageStateTracker::resolve(const VkImageSubresourceRange& range, uint32_t& mip_end, uint32_t& layer_end) const
+	{
+		mip_end = range.levelCount == VK_REMAINING_MIP_LEVELS ? m_mip_levels : range.baseMipLevel + range.levelCount;
+		layer_end = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? m_array_layers : range.baseArrayLayer + range.layerCount;
+		assert(range.baseMipLevel < mip_end && mip_end <= m_mip_levels && "Invalid mip level range!");
+		assert(range.baseArrayLayer < layer_end && layer_end <= m_array_layers && "Invalid array layer range!");
+	}
+
+	void ImageStateTracker::Transition(VkImage image, const VkImageSubresourceRange& range, const ResourceAccess& access,
+		std::vector<VkImageMemoryBarrier2>& barriers)
+	{
+		uint32_t mipEnd, layerEnd;
+		resolve(range, mipEnd, layerEnd);
+
+		const size_t firstBarrier = barriers.size();
+		auto push_run = [&](const ResourceState::Dependency& dependency, uint32_t mip_level, uint32_t base_layer, uint32_t layer_count)
+		{
+			// Extend a barrier of the previous mip level covering the same layers
+			for (size_t index = firstBarrier; index < barriers.size(); ++index)
+			{
+				auto& barrier = barriers[index];
+				auto& subresource = barrier.subresourceRange;
+				if (subresource.baseMipLevel + subresource.levelCount == mip_level &&
+					subresource.baseArrayLayer == base_layer && subresource.layerCount == layer_count &&
+					barrier.srcStageMask == dependency.src_stages && barrier.srcAccessMask == dependency.src_access &&
+					barrier.oldLayout == dependency.old_layout && barrier.newLayout == dependency.new_layout &&
+					barrier.srcQueueFamilyIndex == dependency.src_family && barrier.dstQueueFamilyIndex == dependency.dst_family)
+				{
+					++subresource.levelCount;
+					return;
+				}
+			}
+			barriers.emplace_back(VkImageMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = dependency.src_stages,
+					.srcAccessMask = dependency.src_access,
+					.dstStageMask = access.stages,
+					.dstAccessMask = access.access,
+					.oldLayout = dependency.old_layout,
+					.newLayout = dependency.new_layout,
+					.srcQueueFamilyIndex = dependency.src_family,
+					.dstQueueFamilyIndex = dependency.dst_family,
+					.image = image,
+					.subresourceRange
+					{
+						.aspectMask = m_aspect,
+						.baseMipLevel = mip_level,
+						.levelCount = 1,
+						.baseArrayLayer = base_layer,
+						.layerCount = layer_count
+					}
+				});
+		};
+
+		for (uint32_t mip_level = range.baseMipLevel; mip_level < mipEnd; ++mip_level)
+		{
+			// Consecutive layers with the same dependency form one barrier
+			bool hasRun = false;
+			ResourceState::Dependency runDependency{};
+			uint32_t runBegin = 0;
+			for (uint32_t array_layer = range.baseArrayLayer; array_layer < layerEnd; ++array_layer)
+			{
+				ResourceState::Dependency dependency;
+				bool isNeeded = at(mip_level, array_layer).Transition(access, true, dependency);
+				if (hasRun && (!isNeeded || dependency != runDependency))
+				{
+					push_run(runDependency, mip_level, runBegin, array_layer - runBegin);
+					hasRun = false;
+				}
+				if (isNeeded && !hasRun)
+				{
+					hasRun = true;
+					runDependency = dependency;
+					runBegin = array_layer;
+				}
+			}
+			if (hasRun) push_run(runDependency, mip_level, runBegin, layerEnd - runBegin);
+		}
+	}
+
+	void ImageStateTracker::Assume(const VkImageSubresourceRange& range, const ResourceAccess& access)
+	{
+		uint32_t mipEnd, layerEnd;
+		resolve(range, mipEnd, layerEnd);
+		for (uint32_t mip_level = range.baseMipLevel; mip_level < mipEnd; ++mip_level)
+			for (uint32_t array_layer = range.baseArrayLayer; array_layer < layerEnd; ++array_layer)
+				at(mip_level, array_layer).Assume(access, true);
+	}
+
+	void BufferStateTracker::Reset(VkDeviceSize size)
+	{
+		m_size = size;
+		m_ranges.assign(1, Range{ .offset = 0, .size = size });
+	}
+
+	std::pair<size_t, size_t> BufferStateTracker::split(VkDeviceSize offset, VkDeviceSize size)
+	{
+		assert(!m_ranges.empty() && "You must Reset() the buffer state tracker first!");
+		VkDeviceSize end = (size == VK_WHOLE_SIZE) ? m_size : offset + size;
+		assert(offset < end && end <= m_size && "Invalid buffer range!");
+
+		auto split_at = [this](VkDeviceSize position) -> size_t
+		{
+			if (position == m_size) return m_ranges.size();
+			auto target = std::upper_bound(m_ranges.begin(), m_ranges.end(), position,
+				[](VkDeviceSize value, const Range& range) { return value < range.offset; }) - 1;
+			size_t index = static_cast<size_t>(target - m_ranges.begin());
+			if (target->offset == position) return index;
+
+			Range tail{ .offset = position, .size = target->offset + target->size - position, .state = target->state };
+			target->size = position - target->offset;
+			m_ranges.insert(m_ranges.begin() + index + 1, tail);
+			return index + 1;
+		};
+		size_t first = split_at(offset);
+		size_t last = split_at(end);
+		return { first, last };
+	}
+
+	void BufferStateTracker::merge()
+	{
+		size_t current = 0;
+		for (size_t index = 1; index < m_ranges.size(); ++index)
+		{
+			if (m_ranges[index].state == m_ranges[current].state)
+				m_ranges[current].size += m_ranges[index].size;
+			else m_ranges[++current] = m_ranges[index];
+		}
+		m_ranges.resize(current + 1);
+	}
+
+	void BufferStateTracker::Transition(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const ResourceAccess& access,
+		std::vector<VkBufferMemoryBarrier2>& barriers)
+	{
+		auto [first, last] = split(offset, size);
+		bool hasLastBarrier = false;
+		ResourceState::Dependency lastDependency{};
+		for (size_t index = first; index < last; ++index)
+		{
+			auto& range = m_ranges[index];
+			ResourceState::Dependency dependency;
+			if (!range.state.Transition(access, false, dependency))
+			{
+				hasLastBarrier = false;
+				continue;
+			}
+			if (hasLastBarrier && dependency == lastDependency)
+			{
+				barriers.back().size += range.size; // Contiguous ranges with the same dependency
+				continue;
+			}
+			barriers.emplace_back(VkBufferMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					.srcStageMask = dependency.src_stages,
+					.srcAccessMask = dependency.src_access,
+					.dstStageMask = access.stages,
+					.dstAccessMask = access.access,
+					.srcQueueFamilyIndex = dependency.src_family,
+					.dstQueueFamilyIndex = dependency.dst_family,
+					.buffer = buffer,
+					.offset = range.offset,
+					.size = range.size
+				});
+			hasLastBarrier = true;
+			lastDependency = dependency;
+		}
+		merge();
+	}
+
+	void BufferStateTracker::Assume(VkDeviceSize offset, VkDeviceSize size, const ResourceAccess& access)
+	{
+		auto [first, last] = split(offset, size);
+		for (size_t index = first; index < last; ++index)
+			m_ranges[index].state.Assume(access, false);
+		merge();
+	}
+
+}} // namespace Albedo::RHI
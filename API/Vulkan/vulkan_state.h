@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <utility>
+#include <vector>
+
+namespace Albedo {
+namespace RHI
+{
+	// An access of a resource (Synchronization2 masks, converted to legacy masks when needed)
+	struct ResourceAccess
+	{
+		VkPipelineStageFlags2	stages			= VK_PIPELINE_STAGE_2_NONE;
+		VkAccessFlags2			access			= VK_ACCESS_2_NONE;
+		VkImageLayout				layout			= VK_IMAGE_LAYOUT_UNDEFINED; // Images only (UNDEFINED: Keep the current layout)
+		uint32_t							queue_family	= VK_QUEUE_FAMILY_IGNORED; // Set it on both queues to transfer the ownership
+
+		static constexpr VkAccessFlags2 WRITE_ACCESS_MASK =
+			VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+			VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT |
+			VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		bool IsWrite() const { return access & WRITE_ACCESS_MASK; }
+
+		// The typical access of an image in this layout (e.g. SHADER_READ_ONLY_OPTIMAL -> Fragment Shader sampling)
+		static ResourceAccess FromLayout(VkImageLayout layout);
+		// Shader storage (UAV) accesses: Transitioning to them between dispatches records the read-after-write & write-after-write
+		// barriers, and none between reads (e.g. image->TransitionCommand(command_buffer, ResourceAccess::StorageImage()))
+		static constexpr ResourceAccess StorageBuffer(bool is_write = true, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
+		{
+			return { stages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | (is_write ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_NONE) };
+		}
+		static constexpr ResourceAccess StorageImage(bool is_write = true, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
+		{
+			return { stages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | (is_write ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_NONE), VK_IMAGE_LAYOUT_GENERAL };
+		}
+
+		// Legacy barriers (Without synchronization2)
+		static VkPipelineStageFlags ToLegacyStages(VkPipelineStageFlags2 stages);
+		static VkAccessFlags ToLegacyAccess(VkAccessFlags2 access);
+	};
+
+	// Last accesses of one image subresource or buffer range
+	struct ResourceState
+	{
+		VkImageLayout					layout					= VK_IMAGE_LAYOUT_UNDEFINED;
+		uint32_t							queue_family		= VK_QUEUE_FAMILY_IGNORED;
+		VkPipelineStageFlags2		write_stages		= VK_PIPELINE_STAGE_2_NONE; // Last write (or layout transition)
+		VkAccessFlags2				write_access		= VK_ACCESS_2_NONE;
+		VkPipelineStageFlags2		read_stages		= VK_PIPELINE_STAGE_2_NONE; // Readers since the last write
+		VkPipelineStageFlags2		visible_stages	= VK_PIPELINE_STAGE_2_NONE; // Readers the last write is visible to
+		VkAccessFlags2				visible_access	= VK_ACCESS_2_NONE;
+		bool operator==(const ResourceState&) const = default;
+
+		struct Dependency
+		{
+			VkPipelineStageFlags2	src_stages;
+			VkAccessFlags2			src_access;
+			VkImageLayout				old_layout;
+			VkImageLayout				new_layout;
+			uint32_t							src_family;
+			uint32_t							dst_family;
+			bool operator==(const Dependency&) const = default;
+		};
+		// Advance to the access and return whether a barrier is needed (Read-after-read in the same layout is free)
+		bool Transition(const ResourceAccess& access, bool is_image, Dependency& dependency);
+		void Assume(const ResourceAccess& access, bool is_image);
+	};
+
+	// Last accesses per image subresource (Mip Level x Array Layer, depth and stencil aspects are tracked together)
+	// Not thread-safe, record transitions of one image from one thread at a time.
+	class ImageStateTracker
+	{
+	public:
+		void Reset(uint32_t mip_levels, uint32_t array_layers, VkImageAspectFlags aspect, VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+		// Append the minimal barriers for the range (Subresources with the same dependency are merged into one barrier)
+		void Transition(VkImage image, const VkImageSubresourceRange& range, const ResourceAccess& access,
+			std::vector<VkImageMemoryBarrier2>& barriers);
+		// Record an access that was synchronized elsewhere (e.g. Queue Ownership Transfers, Render Pass final layouts)
+		void Assume(const VkImageSubresourceRange& range, const ResourceAccess& access);
+
+		VkImageLayout GetLayout(uint32_t mip_level = 0, uint32_t array_layer = 0) const { return at(mip_level, array_layer).layout; }
+		VkImageAspectFlags GetAspect() const { return m_aspect; }
+		VkImageSubresourceRange GetWholeRange() const;
+
+	private:
+		ResourceState& at(uint32_t mip_level, uint32_t array_layer) { return m_states[mip_level * m_array_layers + array_layer]; }
+		const ResourceState& at(uint32_t mip_level, uint32_t array_layer) const { return m_states[mip_level * m_array_layers + array_layer]; }
+		void resolve(const VkImageSubresourceRange& range, uint32_t& mip_end, uint32_t& layer_end) const;
+
+	private:
+		uint32_t m_mip_levels = 1;
+		uint32_t m_array_layers = 1;
+		VkImageAspectFlags m_aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		std::vector<ResourceState> m_states = std::vector<ResourceState>(1); // [Mip Level][Array Layer]
+	};
+
+	// Last accesses per buffer range
+	// Not thread-safe, record transitions of one buffer from one thread at a time.
+	class BufferStateTracker
+	{
+	public:
+		void Reset(VkDeviceSize size);
+		// Append the minimal barriers for the range [offset, offset + size), size can be VK_WHOLE_SIZE
+		void Transition(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const ResourceAccess& access,
+			std::vector<VkBufferMemoryBarrier2>& barriers);
+		void Assume(VkDeviceSize offset, VkDeviceSize size, const ResourceAccess& access);
+
+	private:
+		struct Range
+		{
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			ResourceState state;
+		};
+		// Split the ranges at both ends and return [first, last) inside [offset, offset + size)
+		std::pair<size_t, size_t> split(VkDeviceSize offset, VkDeviceSize size);
+		void merge(); // Coalesce neighbours in the same state
+
+	private:
+		VkDeviceSize m_size = 0;
+		std::vector<Range> m_ranges; // Sorted and contiguous
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,85 @@
+#include "vulkan_stats.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	void RHIStatistics::AddRecording(const RecordingStatistics& statistics)
+	{
+		if (statistics.draws) Add(DRAWS, statistics.draws);
+		if (statistics.dispatches) Add(DISPATCHES, statistics.dispatches);
+		if (statistics.barriers) Add(BARRIERS, statistics.barriers);
+		if (statistics.pipeline_binds) Add(PIPELINE_BINDS, statistics.pipeline_binds);
+	}
+
+	void RHIStatistics::EndFrame()
+	{
+		Values values;
+		for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+			values[counter] = m_counters[counter].value.exchange(0, std::memory_order_relaxed);
+		++m_frame_number;
+
+		uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+		m_sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_last_frame[0].store(m_frame_number, std::memory_order_relaxed);
+		for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+			m_last_frame[counter + 1].store(values[counter], std::memory_order_relaxed);
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	FrameStatistics RHIStatistics::GetLastFrame() const
+	{
+		uint64_t frameNumber;
+		Values values;
+		while (true)
+		{
+			uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+			if (sequence & 1) continue; // Being written
+			frameNumber = m_last_frame[0].load(std::memory_order_relaxed);
+			for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+				values[counter] = m_last_frame[counter + 1].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (m_sequence.load(std::memory_order_relaxed) == sequence) break;
+		}
+		return make_snapshot(frameNumber, values);
+	}
+
+	FrameStatistics RHIStatistics::GetCurrentFrame() const
+	{
+		Values values;
+		for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+			values[counter] = m_counters[counter].value.load(std::memory_order_relaxed);
+		return make_snapshot(m_frame_number + 1, values);
+	}
+
+	FrameStatistics RHIStatistics::make_snapshot(uint64_t frame_number, const Values& values)
+	{
+		return FrameStatistics
+		{
+			.frame_number						= frame_number,
+			.submits								= values[SUBMITS],
+			.command_buffers				= values[COMMAND_BUFFERS],
+			.draws									= values[DRAWS],
+			.dispatches							= values[DISPATCHES],
+			.barriers								= values[BARRIERS],
+			.pipeline_binds					= values[PIPELINE_BINDS],
+			.descriptor_writes				= values[DESCRIPTOR_WRITES],
+			.descriptor_allocations	= values[DESCRIPTOR_ALLOCATIONS],
+			.buffer_allocations			= values[BUFFER_ALLOCATIONS],
+			.buffer_bytes						= values[BUFFER_BYTES],
+			.image_allocations				= values[IMAGE_ALLOCATIONS],
+			.image_bytes						= values[IMAGE_BYTES],
+			.staging_bytes					= values[STAGING_BYTES],
+			.submit_cpu_ns					= values[SUBMIT_CPU_NS],
+			.present_cpu_ns					= values[PRESENT_CPU_NS],
+			.pipelines_created				= values[PIPELINES_CREATED],
+			.pipeline_cache_hits			= values[PIPELINE_CACHE_HITS],
+			.pipeline_creation_ns			= values[PIPELINE_CREATION_NS],
+			.thread_slot_lookups			= values[THREAD_SLOT_LOOKUPS],
+			.thread_slot_contentions	= values[THREAD_SLOT_CONTENTIONS],
+			.command_pool_contentions	= values[COMMAND_POOL_CONTENTIONS]
+		};
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Albedo {
+namespace RHI
+{
+	struct RecordingStatistics;
+
+	// RHI counters of one frame (Snapshot of RHIStatistics)
+	struct FrameStatistics
+	{
+		uint64_t frame_number = 0;
+		uint64_t submits = 0;									// vkQueueSubmit(2) calls
+		uint64_t command_buffers = 0;					// Submitted
+		uint64_t draws = 0;										// Of the command buffers ended this frame (Recorder counters)
+		uint64_t dispatches = 0;
+		uint64_t barriers = 0;									// Barrier structs recorded
+		uint64_t pipeline_binds = 0;
+		uint64_t descriptor_writes = 0;				// VkWriteDescriptorSet structs
+		uint64_t descriptor_allocations = 0;		// Descriptor sets allocated from pools
+		uint64_t buffer_allocations = 0;
+		uint64_t buffer_bytes = 0;
+		uint64_t image_allocations = 0;
+		uint64_t image_bytes = 0;
+		uint64_t staging_bytes = 0;						// Allocated from staging rings
+		uint64_t submit_cpu_ns = 0;						// Spent in submission calls
+		uint64_t present_cpu_ns = 0;					// Spent in vkQueuePresentKHR
+		uint64_t pipelines_created = 0;				// With creation feedback (PipelineCreationFeedback)
+		uint64_t pipeline_cache_hits = 0;			// Of the created pipelines
+		uint64_t pipeline_creation_ns = 0;			// Reported by the driver
+		uint64_t thread_slot_lookups = 0;			// Global thread slot lookups that missed the thread-local cache
+		uint64_t thread_slot_contentions = 0;	// Of the lookups, waited for the slot registry lock
+		uint64_t command_pool_contentions = 0;	// Command buffer acquires & recycles that waited for another thread
+	};
+
+	// Per-frame RHI Counters (VulkanContext::GetStatistics())
+	// Relaxed atomic counters on the hot paths, the recorder counters are added once per ended command buffer.
+	// EndFrame() publishes them as the last frame through a sequence lock, so GetLastFrame() never blocks.
+	class RHIStatistics
+	{
+	public:
+		enum Counter
+		{
+			SUBMITS,
+			COMMAND_BUFFERS,
+			DRAWS,
+			DISPATCHES,
+			BARRIERS,
+			PIPELINE_BINDS,
+			DESCRIPTOR_WRITES,
+			DESCRIPTOR_ALLOCATIONS,
+			BUFFER_ALLOCATIONS,
+			BUFFER_BYTES,
+			IMAGE_ALLOCATIONS,
+			IMAGE_BYTES,
+			STAGING_BYTES,
+			SUBMIT_CPU_NS,
+			PRESENT_CPU_NS,
+			PIPELINES_CREATED,
+			PIPELINE_CACHE_HITS,
+			PIPELINE_CREATION_NS,
+			THREAD_SLOT_LOOKUPS,
+			THREAD_SLOT_CONTENTIONS,
+			COMMAND_POOL_CONTENTIONS,
+			COUNTER_COUNT
+		};
+
+		void Add(Counter counter, uint64_t value = 1) { m_counters[counter].value.fetch_add(value, std::memory_order_relaxed); }
+		void AddRecording(const RecordingStatistics& statistics); // Thread-safe
+		void EndFrame(); // Called by FrameContext::EndFrame() (One publishing thread)
+
+		FrameStatistics GetLastFrame() const; // Lock-free, consistent across counters
+		FrameStatistics GetCurrentFrame() const; // Running counters (Individually consistent only)
+
+		class CPUTimer // Adds the elapsed nanoseconds to a counter
+		{
+		public:
+			CPUTimer(RHIStatistics& statistics, Counter counter) :
+				m_statistics{ statistics }, m_counter{ counter }, m_begin{ std::chrono::steady_clock::now() } {}
+			~CPUTimer() { m_statistics.Add(m_counter, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_begin).count()); }
+			CPUTimer(const CPUTimer&) = delete;
+		private:
+			RHIStatistics& m_statistics;
+			Counter m_counter;
+			std::chrono::steady_clock::time_point m_begin;
+		};
+
+	private:
+		using Values = std::array<uint64_t, COUNTER_COUNT>;
+		static FrameStatistics make_snapshot(uint64_t frame_number, const Values& values);
+
+	private:
+		struct alignas(64) PaddedCounter { std::atomic<uint64_t> value{ 0 }; }; // No false sharing between hot counters
+		std::array<PaddedCounter, COUNTER_COUNT> m_counters;
+
+		std::atomic<uint64_t> m_sequence{ 0 }; // Odd while EndFrame() writes the last frame
+		uint64_t m_frame_number = 0;
+		std::array<std::atomic<uint64_t>, COUNTER_COUNT + 1> m_last_frame{}; // Frame number + counters
+	};
+
+}} // namespace Albedo::RHI
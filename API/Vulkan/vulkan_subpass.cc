@@ -0,0 +1,228 @@
+#include "vulkan_subpass.h"
+#include "vulkan_format.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		bool Contains(const std::vector<uint32_t>& attachments, uint32_t attachment)
+		{
+			return std::ranges::find(attachments, attachment) != attachments.end();
+		}
+	}
+
+	uint32_t SubpassBuilder::AddAttachment(const VkAttachmentDescription& description)
+	{
+		m_attachments.emplace_back(description);
+		m_transient_attachments.emplace_back(false);
+		return static_cast<uint32_t>(m_attachments.size() - 1);
+	}
+
+	uint32_t SubpassBuilder::AddAttachment(VkFormat format, VkImageLayout final_layout, VkAttachmentLoadOp load_op/* = VK_ATTACHMENT_LOAD_OP_CLEAR*/)
+	{
+		const bool hasStencil = GetFormatAspect(format) & VK_IMAGE_ASPECT_STENCIL_BIT;
+		return AddAttachment(VkAttachmentDescription
+			{
+				.format = format,
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.loadOp = load_op,
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.stencilLoadOp = hasStencil ? load_op : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+				.stencilStoreOp = hasStencil ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				.initialLayout = load_op == VK_ATTACHMENT_LOAD_OP_LOAD ? final_layout : VK_IMAGE_LAYOUT_UNDEFINED, // Loaded: Left by the last frame
+				.finalLayout = final_layout
+			});
+	}
+
+	uint32_t SubpassBuilder::AddTransientAttachment(VkFormat format, VkSampleCountFlagBits samples/* = VK_SAMPLE_COUNT_1_BIT*/)
+	{
+		uint32_t attachment = AddAttachment(VkAttachmentDescription
+			{
+				.format = format,
+				.samples = samples,
+				.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE, // Never leaves the tile memory
+				.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.finalLayout = VK_IMAGE_LAYOUT_GENERAL // Replaced by the layout of its last use in Build()
+			});
+		m_transient_attachments[attachment] = true;
+		return attachment;
+	}
+
+	uint32_t SubpassBuilder::AddSubpass(Subpass subpass)
+	{
+		assert((subpass.resolves.empty() || subpass.resolves.size() == subpass.colors.size()) && "You have to resolve none or every color attachment!");
+		m_subpasses.emplace_back(std::move(subpass));
+		return static_cast<uint32_t>(m_subpasses.size() - 1);
+	}
+
+	void SubpassBuilder::Build(std::vector<VkAttachmentDescription>& attachment_descriptions, std::vector<VkSubpassDescription>& subpass_descriptions)
+	{
+		const size_t attachmentCount = m_attachments.size();
+		m_references.assign(m_subpasses.size(), References{});
+		m_dependencies.clear();
+
+		auto is_depth = [this](uint32_t attachment) { return !(GetFormatAspect(m_attachments[attachment].format) & VK_IMAGE_ASPECT_COLOR_BIT); };
+		auto write_stages = [&](uint32_t attachment) -> VkPipelineStageFlags
+		{
+			return is_depth(attachment) ? VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		};
+		auto write_access = [&](uint32_t attachment) -> VkAccessFlags
+		{
+			return is_depth(attachment) ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		};
+
+		std::vector<uint32_t> lastWriters(attachmentCount, VK_SUBPASS_EXTERNAL);
+		std::vector<std::vector<uint32_t>> readers(attachmentCount); // Since the last write
+		std::vector<uint32_t> firstUses(attachmentCount, VK_SUBPASS_EXTERNAL);
+		std::vector<uint32_t> lastUses(attachmentCount, VK_SUBPASS_EXTERNAL);
+		std::vector<VkImageLayout> lastLayouts(attachmentCount, VK_IMAGE_LAYOUT_UNDEFINED);
+
+		for (uint32_t subpassIndex = 0; subpassIndex < m_subpasses.size(); ++subpassIndex)
+		{
+			const auto& subpass = m_subpasses[subpassIndex];
+			auto& references = m_references[subpassIndex];
+
+			auto reference = [&](uint32_t attachment, VkImageLayout layout)
+			{
+				if (attachment == VK_ATTACHMENT_UNUSED) return VkAttachmentReference{ .attachment = attachment, .layout = VK_IMAGE_LAYOUT_UNDEFINED };
+				assert(attachment < attachmentCount && "You have to add the attachment before the subpasses using it!");
+				if (firstUses[attachment] == VK_SUBPASS_EXTERNAL) firstUses[attachment] = subpassIndex;
+				lastUses[attachment] = subpassIndex;
+				lastLayouts[attachment] = layout;
+				return VkAttachmentReference{ .attachment = attachment, .layout = layout };
+			};
+			auto read = [&](uint32_t attachment, VkPipelineStageFlags stages, VkAccessFlags access)
+			{
+				if (lastWriters[attachment] != VK_SUBPASS_EXTERNAL) // RAW
+					add_dependency(lastWriters[attachment], subpassIndex, write_stages(attachment), write_access(attachment), stages, access);
+				readers[attachment].emplace_back(subpassIndex);
+			};
+			auto write = [&](uint32_t attachment)
+			{
+				if (attachment == VK_ATTACHMENT_UNUSED) return;
+				const VkPipelineStageFlags stages = write_stages(attachment);
+				const VkAccessFlags access = write_access(attachment);
+				if (lastWriters[attachment] != VK_SUBPASS_EXTERNAL && lastWriters[attachment] != subpassIndex) // WAW
+					add_dependency(lastWriters[attachment], subpassIndex, stages, access, stages, access);
+				for (uint32_t reader : readers[attachment]) // WAR (Execution dependency only)
+					if (reader != subpassIndex) add_dependency(reader, subpassIndex, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | stages, 0, stages, access);
+				readers[attachment].clear();
+				lastWriters[attachment] = subpassIndex;
+			};
+
+			// A depth attachment also read as input is read-only in this subpass, a color one is a feedback loop
+			const bool isDepthReadOnly = subpass.depth_stencil && Contains(subpass.inputs, *subpass.depth_stencil);
+			for (uint32_t attachment : subpass.inputs)
+			{
+				VkImageLayout layout = is_depth(attachment) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				if (Contains(subpass.colors, attachment)) layout = VK_IMAGE_LAYOUT_GENERAL;
+				references.inputs.emplace_back(reference(attachment, layout));
+				read(attachment, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT);
+			}
+			for (uint32_t attachment : subpass.colors)
+			{
+				references.colors.emplace_back(reference(attachment,
+					Contains(subpass.inputs, attachment) ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+				write(attachment);
+				if (Contains(subpass.inputs, attachment)) // Pixel-local feedback (Reads the writes of earlier draws)
+					add_dependency(subpassIndex, subpassIndex, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+						VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT);
+			}
+			for (uint32_t attachment : subpass.resolves)
+			{
+				references.resolves.emplace_back(reference(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+				write(attachment);
+			}
+			if (subpass.depth_stencil)
+			{
+				const uint32_t attachment = *subpass.depth_stencil;
+				if (isDepthReadOnly)
+				{
+					references.depth_stencil = reference(attachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+					read(attachment, write_stages(attachment), VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT);
+				}
+				else
+				{
+					references.depth_stencil = reference(attachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+					write(attachment);
+				}
+			}
+		}
+
+		for (uint32_t attachment = 0; attachment < attachmentCount; ++attachment)
+		{
+			if (firstUses[attachment] == VK_SUBPASS_EXTERNAL) continue; // Unused
+			auto& description = m_attachments[attachment];
+			if (m_transient_attachments[attachment]) description.finalLayout = lastLayouts[attachment]; // No transition at the end
+
+			// Previous frame or the swap chain acquisition (Waited at the color output stage) -> First use
+			add_dependency(VK_SUBPASS_EXTERNAL, firstUses[attachment], write_stages(attachment), write_access(attachment),
+				write_stages(attachment) | (is_depth(attachment) ? 0 : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT), write_access(attachment));
+			// Last write -> Sampled after the render pass (Other consumers synchronize the final layout themselves)
+			if (description.storeOp == VK_ATTACHMENT_STORE_OP_STORE && description.finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
+				lastWriters[attachment] != VK_SUBPASS_EXTERNAL)
+				add_dependency(lastWriters[attachment], VK_SUBPASS_EXTERNAL, write_stages(attachment), write_access(attachment),
+					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+			// Keep the contents across the subpasses between its uses
+			for (uint32_t subpassIndex = firstUses[attachment] + 1; subpassIndex < lastUses[attachment]; ++subpassIndex)
+			{
+				const auto& subpass = m_subpasses[subpassIndex];
+				if (!Contains(subpass.colors, attachment) && !Contains(subpass.inputs, attachment) &&
+					!Contains(subpass.resolves, attachment) && subpass.depth_stencil != attachment)
+					m_references[subpassIndex].preserves.emplace_back(attachment);
+			}
+		}
+
+		attachment_descriptions = m_attachments;
+		subpass_descriptions.clear();
+		subpass_descriptions.reserve(m_subpasses.size());
+		for (uint32_t subpassIndex = 0; subpassIndex < m_subpasses.size(); ++subpassIndex)
+		{
+			const auto& references = m_references[subpassIndex];
+			subpass_descriptions.emplace_back(VkSubpassDescription
+				{
+					.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+					.inputAttachmentCount = static_cast<uint32_t>(references.inputs.size()),
+					.pInputAttachments = references.inputs.data(),
+					.colorAttachmentCount = static_cast<uint32_t>(references.colors.size()),
+					.pColorAttachments = references.colors.data(),
+					.pResolveAttachments = references.resolves.empty() ? nullptr : references.resolves.data(),
+					.pDepthStencilAttachment = m_subpasses[subpassIndex].depth_stencil ? &references.depth_stencil : nullptr,
+					.preserveAttachmentCount = static_cast<uint32_t>(references.preserves.size()),
+					.pPreserveAttachments = references.preserves.data()
+				});
+		}
+	}
+
+	void SubpassBuilder::add_dependency(uint32_t src_subpass, uint32_t dst_subpass,
+		VkPipelineStageFlags src_stages, VkAccessFlags src_access,
+		VkPipelineStageFlags dst_stages, VkAccessFlags dst_access)
+	{
+		auto target = std::ranges::find_if(m_dependencies, [src_subpass, dst_subpass](const VkSubpassDependency& dependency)
+			{ return dependency.srcSubpass == src_subpass && dependency.dstSubpass == dst_subpass; });
+		if (target == m_dependencies.end())
+		{
+			m_dependencies.emplace_back(VkSubpassDependency
+				{
+					.srcSubpass = src_subpass,
+					.dstSubpass = dst_subpass,
+					// Inside the render pass every access is framebuffer-local, so tiles never wait for the whole previous subpass
+					.dependencyFlags = (src_subpass == VK_SUBPASS_EXTERNAL || dst_subpass == VK_SUBPASS_EXTERNAL) ? 0u : VkDependencyFlags{ VK_DEPENDENCY_BY_REGION_BIT }
+				});
+			target = std::prev(m_dependencies.end());
+		}
+		target->srcStageMask |= src_stages;
+		target->srcAccessMask |= src_access;
+		target->dstStageMask |= dst_stages;
+		target->dstAccessMask |= dst_access;
+	}
+
+}} // namespace Albedo::RHI
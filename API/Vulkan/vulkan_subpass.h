@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <vector>
+
+namespace Albedo {
+namespace RHI
+{
+	// Subpass Builder: Attachments, subpasses and dependencies of a multi-subpass RenderPass (e.g. G-buffer -> Lighting)
+	// Attachments written by a subpass and read as input attachments (subpassLoad()) by a later one get BY_REGION dependencies,
+	// so tile-based GPUs merge the subpasses and keep the attachments on chip. Transient attachments are cleared and never stored,
+	// back them with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT (VMA::AllocateMultisampledAttachment() adds it to attachment-only usages).
+	// Usage: Add the attachments in create_attachments(), the subpasses and Build() in create_subpasses(),
+	// and return GetSubpassDependencies() in set_subpass_dependencies(). Keep the builder alive with the render pass
+	// (m_subpass_descriptions point into it). Record the subpasses in AddSubpass() order with RenderPass::NextSubpass().
+	class SubpassBuilder
+	{
+	public:
+		uint32_t AddAttachment(const VkAttachmentDescription& description); // e.g. RenderPass::make_resolve_attachment()
+		uint32_t AddAttachment(VkFormat format, VkImageLayout final_layout, VkAttachmentLoadOp load_op = VK_ATTACHMENT_LOAD_OP_CLEAR); // Stored
+		uint32_t AddTransientAttachment(VkFormat format, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT); // Final layout: Its last use
+
+		struct Subpass
+		{
+			std::vector<uint32_t> colors;
+			std::optional<uint32_t> depth_stencil;
+			std::vector<uint32_t> inputs;		// Written by earlier subpasses (Also a color or depth of this subpass: Feedback loop)
+			std::vector<uint32_t> resolves;	// Empty, or one per color (VK_ATTACHMENT_UNUSED to skip)
+		};
+		uint32_t AddSubpass(Subpass subpass); // In execution order
+
+		// Overwrites the descriptions of the render pass (Reference layouts, preserved attachments and dependencies are derived here)
+		void Build(std::vector<VkAttachmentDescription>& attachment_descriptions, std::vector<VkSubpassDescription>& subpass_descriptions);
+		const std::vector<VkSubpassDependency>& GetSubpassDependencies() const { return m_dependencies; }
+
+	public:
+		SubpassBuilder() = default;
+		SubpassBuilder(const SubpassBuilder&) = delete; // The descriptions hold pointers to the references
+
+	private:
+		struct References
+		{
+			std::vector<VkAttachmentReference> colors;
+			std::vector<VkAttachmentReference> resolves;
+			std::vector<VkAttachmentReference> inputs;
+			VkAttachmentReference depth_stencil;
+			std::vector<uint32_t> preserves;
+		};
+		void add_dependency(uint32_t src_subpass, uint32_t dst_subpass,
+			VkPipelineStageFlags src_stages, VkAccessFlags src_access,
+			VkPipelineStageFlags dst_stages, VkAccessFlags dst_access); // Merged with the dependency of the same subpass pair
+
+	private:
+		std::vector<VkAttachmentDescription> m_attachments;
+		std::vector<bool> m_transient_attachments;
+		std::vector<Subpass> m_subpasses;
+		std::vector<References> m_references; // One per subpass
+		std::vector<VkSubpassDependency> m_dependencies;
+	};
+
+}} // namespace Albedo::RHI
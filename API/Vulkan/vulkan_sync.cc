@@ -0,0 +1,125 @@
+#include "vulkan_sync.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	SyncPool::SyncPool(VulkanContext* vulkan_context) :
+		m_context{ vulkan_context }
+	{
+
+	}
+
+	SyncPool::~SyncPool()
+	{
+		for (auto semaphore : m_free_semaphores)
+			vkDestroySemaphore(m_context->m_device, semaphore, m_context->m_memory_allocation_callback);
+		for (auto fence : m_free_fences)
+			vkDestroyFence(m_context->m_device, fence, m_context->m_memory_allocation_callback);
+		for (auto fence : m_signaled_fences)
+			vkDestroyFence(m_context->m_device, fence, m_context->m_memory_allocation_callback);
+	}
+
+	VkSemaphore SyncPool::AcquireSemaphore()
+	{
+		{
+			std::scoped_lock guard{ m_mutex };
+			if (!m_free_semaphores.empty())
+			{
+				auto semaphore = m_free_semaphores.back();
+				m_free_semaphores.pop_back();
+				++m_statistics.recycled_semaphores;
+				return semaphore;
+			}
+			++m_statistics.created_semaphores;
+		}
+		return create_semaphore();
+	}
+
+	void SyncPool::ReleaseSemaphore(VkSemaphore semaphore)
+	{
+		if (semaphore == VK_NULL_HANDLE) return;
+		std::scoped_lock guard{ m_mutex };
+		m_free_semaphores.emplace_back(semaphore);
+	}
+
+	VkFence SyncPool::AcquireFence(bool signaled/* = false*/)
+	{
+		VkFence fence = VK_NULL_HANDLE;
+		{
+			std::scoped_lock guard{ m_mutex };
+			auto& preferred = signaled ? m_signaled_fences : m_free_fences;
+			if (!preferred.empty())
+			{
+				fence = preferred.back();
+				preferred.pop_back();
+				++m_statistics.recycled_fences;
+				return fence;
+			}
+			if (!signaled && !m_signaled_fences.empty()) // Reset a signaled one (Signaling from the host is not possible)
+			{
+				fence = m_signaled_fences.back();
+				m_signaled_fences.pop_back();
+				++m_statistics.recycled_fences;
+			}
+			else ++m_statistics.created_fences;
+		}
+		if (fence == VK_NULL_HANDLE) return create_fence(signaled ? VK_FENCE_CREATE_SIGNALED_BIT : 0);
+		vkResetFences(m_context->m_device, 1, &fence);
+		return fence;
+	}
+
+	void SyncPool::ReleaseFence(VkFence fence)
+	{
+		if (fence == VK_NULL_HANDLE) return;
+		const bool isSignaled = vkGetFenceStatus(m_context->m_device, fence) == VK_SUCCESS;
+		std::scoped_lock guard{ m_mutex };
+		(isSignaled ? m_signaled_fences : m_free_fences).emplace_back(fence);
+	}
+
+	SyncPool::Statistics SyncPool::GetStatistics()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_statistics;
+	}
+
+	size_t SyncPool::GetPooledCount()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return m_free_semaphores.size() + m_free_fences.size() + m_signaled_fences.size();
+	}
+
+	VkSemaphore SyncPool::create_semaphore()
+	{
+		VkSemaphoreCreateInfo semaphoreCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+		};
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		if (vkCreateSemaphore(
+			m_context->m_device,
+			&semaphoreCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&semaphore) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Semaphore!");
+		return semaphore;
+	}
+
+	VkFence SyncPool::create_fence(VkFenceCreateFlags flags)
+	{
+		VkFenceCreateInfo fenceCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			.flags = flags
+		};
+		VkFence fence = VK_NULL_HANDLE;
+		if (vkCreateFence(
+			m_context->m_device,
+			&fenceCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&fence) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Fence!");
+		return fence;
+	}
+
+}} // namespace Albedo::RHI
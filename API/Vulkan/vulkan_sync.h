@@ -0,0 +1,54 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <mutex>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Recycles binary semaphores and fences (VulkanContext::GetSyncPool())
+	// Semaphore & Fence objects draw their handles from here and hand them back when destroyed, so the sync objects
+	// cycling every frame stop reaching vkCreateXXX/vkDestroyXXX. The destruction rules still apply to a release:
+	// no pending queue operation may use the handle, and a binary semaphore must have been waited (Unsignaled).
+	class SyncPool
+	{
+	public:
+		// Thread-safe
+		VkSemaphore AcquireSemaphore(); // Unsignaled binary semaphore
+		void ReleaseSemaphore(VkSemaphore semaphore);
+		VkFence AcquireFence(bool signaled = false);
+		void ReleaseFence(VkFence fence); // Kept signaled until an unsignaled fence is needed
+
+		struct Statistics
+		{
+			uint32_t created_semaphores = 0;
+			uint32_t recycled_semaphores = 0;
+			uint32_t created_fences = 0;
+			uint32_t recycled_fences = 0;
+		};
+		Statistics GetStatistics();
+		size_t GetPooledCount(); // Semaphores + fences waiting for reuse
+
+	public:
+		SyncPool() = delete;
+		SyncPool(VulkanContext* vulkan_context);
+		~SyncPool(); // Destroy the pooled handles
+		SyncPool(const SyncPool&) = delete;
+
+	private:
+		VkSemaphore create_semaphore();
+		VkFence create_fence(VkFenceCreateFlags flags);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		std::mutex m_mutex;
+		std::vector<VkSemaphore> m_free_semaphores;
+		std::vector<VkFence> m_free_fences; // Unsignaled
+		std::vector<VkFence> m_signaled_fences;
+		Statistics m_statistics;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,163 @@
+#include "vulkan_texture.h"
+#include "vulkan_context.h"
+
+#include <cstring>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+		constexpr size_t KTX2_HEADER_SIZE = 80;		// Identifier, header and index
+		constexpr size_t KTX2_LEVEL_INDEX_SIZE = 24;	// byteOffset, byteLength, uncompressedByteLength
+		constexpr uint8_t KHR_DF_TRANSFER_SRGB = 2;
+
+		template<typename T>
+		T read(std::span<const char> data, size_t offset)
+		{
+			T value;
+			memcpy(&value, data.data() + offset, sizeof(T)); // Unaligned
+			return value;
+		}
+	} // namespace
+
+	KTX2Texture::KTX2Texture(std::shared_ptr<VulkanContext> vulkan_context, std::string_view path) :
+		m_context{ std::move(vulkan_context) },
+		m_path{ path },
+		m_file{ std::make_unique<MappedFile>(path) }
+	{
+		auto data = m_file->GetData();
+		if (data.size() < KTX2_HEADER_SIZE || memcmp(data.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)))
+			throw std::runtime_error(std::format("Failed to load the KTX2 texture {} - Not a KTX2 file!", path));
+
+		m_format = static_cast<VkFormat>(read<uint32_t>(data, 12));
+		m_width = read<uint32_t>(data, 20);
+		m_height = std::max(read<uint32_t>(data, 24), 1u);		// 0: 1D
+		m_depth = std::max(read<uint32_t>(data, 28), 1u);		// 0: Not 3D
+		m_layer_count = std::max(read<uint32_t>(data, 32), 1u);	// 0: Not an array
+		m_is_array = read<uint32_t>(data, 32) != 0;
+		m_face_count = read<uint32_t>(data, 36);
+		const uint32_t levelCount = std::max(read<uint32_t>(data, 40), 1u); // 0: Generate the other levels (GenerateMipsCommand())
+		m_supercompression = static_cast<Supercompression>(read<uint32_t>(data, 44));
+		if (!m_width || (m_face_count != 1 && m_face_count != 6))
+			throw std::runtime_error(std::format("Failed to load the KTX2 texture {} - Invalid dimensions!", path));
+
+		// Data Format Descriptor: Total size, then the basic block (vendorId & type, version & size, colorModel, primaries, transfer, flags)
+		const uint32_t dfdOffset = read<uint32_t>(data, 48), dfdLength = read<uint32_t>(data, 52);
+		if (dfdLength >= 16 && dfdOffset + dfdLength <= data.size())
+		{
+			m_color_model = read<uint8_t>(data, dfdOffset + 12);
+			m_is_srgb = read<uint8_t>(data, dfdOffset + 14) == KHR_DF_TRANSFER_SRGB;
+		}
+
+		const uint64_t sgdOffset = read<uint64_t>(data, 64), sgdLength = read<uint64_t>(data, 72);
+		if (sgdOffset + sgdLength > data.size())
+			throw std::runtime_error(std::format("Failed to load the KTX2 texture {} - Truncated global data!", path));
+		m_global_data = std::as_bytes(data.subspan(static_cast<size_t>(sgdOffset), static_cast<size_t>(sgdLength)));
+
+		if (KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_INDEX_SIZE > data.size())
+			throw std::runtime_error(std::format("Failed to load the KTX2 texture {} - Truncated level index!", path));
+		m_levels.reserve(levelCount);
+		for (uint32_t mip_level = 0; mip_level < levelCount; ++mip_level)
+		{
+			const size_t entry = KTX2_HEADER_SIZE + mip_level * KTX2_LEVEL_INDEX_SIZE;
+			const uint64_t byteOffset = read<uint64_t>(data, entry), byteLength = read<uint64_t>(data, entry + 8);
+			if (byteOffset + byteLength > data.size())
+				throw std::runtime_error(std::format("Failed to load the KTX2 texture {} - Truncated level {}!", path, mip_level));
+			m_levels.emplace_back(std::as_bytes(data.subspan(static_cast<size_t>(byteOffset), static_cast<size_t>(byteLength))));
+		}
+	}
+
+	KTX2Texture::~KTX2Texture()
+	{
+
+	}
+
+	std::shared_ptr<VMA::Image> KTX2Texture::Upload(VkImageUsageFlags usage/* = VK_IMAGE_USAGE_SAMPLED_BIT*/, const Transcoder& transcoder/* = {}*/,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/, VMA::MemoryPool memory_pool/* = VMA::MemoryPool::STREAMING*/,
+		uint32_t first_mip_level/* = 0*/)
+	{
+		assert(first_mip_level < MipLevels() && "Mip level is out of range!");
+		if (IsTranscodingNeeded() && !transcoder)
+			throw std::runtime_error(std::format("Failed to upload the KTX2 texture {} - Its payload needs a transcoder!", m_path));
+		const VkFormat targetFormat = (m_format == VK_FORMAT_UNDEFINED)? SelectTranscodeTarget() : m_format;
+		if (!is_sampled_format_supported(targetFormat))
+			throw std::runtime_error(std::format("Failed to upload the KTX2 texture {} - Format {} is not supported by this device!",
+				m_path, static_cast<int>(targetFormat)));
+
+		const auto imageType = GetImageType();
+		const uint32_t levelCount = MipLevels() - first_mip_level;
+		auto image = m_context->m_memory_allocator->AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT, usage,
+			std::max(m_width >> first_mip_level, 1u), std::max(m_height >> first_mip_level, 1u), 4, targetFormat,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_TILING_OPTIMAL, levelCount, memory_pool,
+			imageType, (imageType == VMA::ImageType::IMAGE_3D)? std::max(m_depth >> first_mip_level, 1u) : ArrayLayers());
+		if constexpr (EnableDebugMarkers) image->SetDebugName(m_path.c_str());
+
+		std::vector<std::span<const std::byte>> levels{ m_levels.begin() + first_mip_level, m_levels.end() };
+		std::vector<std::vector<std::byte>> transcodedLevels;
+		if (IsTranscodingNeeded())
+		{
+			// One job per level (The waiting thread transcodes as well, also a worker thread)
+			auto& workerPool = m_context->GetWorkerPool();
+			std::vector<std::future<std::vector<std::byte>>> jobs;
+			for (uint32_t mip_level = first_mip_level; mip_level < MipLevels(); ++mip_level)
+				jobs.emplace_back(workerPool.Submit([this, &transcoder, mip_level, targetFormat]() { return transcoder(*this, mip_level, targetFormat); }));
+			std::exception_ptr failure;
+			for (auto& job : jobs) // Join all levels before rethrowing, they reference the transcoder
+			{
+				try { transcodedLevels.emplace_back(workerPool.Wait(job)); }
+				catch (...) { if (!failure) failure = std::current_exception(); }
+			}
+			if (failure) std::rethrow_exception(failure); // Transcoding errors
+			for (uint32_t mip_level = 0; mip_level < levelCount; ++mip_level) levels[mip_level] = transcodedLevels[mip_level];
+		}
+		if ((usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT) && m_context->IsHostImageCopySupported())
+		{
+			for (uint32_t mip_level = 0; mip_level < levelCount; ++mip_level) // No queue involved (Callable from worker threads)
+			{
+				if (levels[mip_level].size() != image->GetDataSize(mip_level, 1))
+					throw std::runtime_error(std::format("Failed to upload the KTX2 texture {} - Level {} has an unexpected size!", m_path, first_mip_level + mip_level));
+				image->WriteFromHost(levels[mip_level], final_layout, mip_level, 1);
+			}
+		}
+		else m_context->GetUploadEngine().UploadImageLevels(image, levels, final_layout); // Validates the level sizes
+		return image;
+	}
+
+	VkFormat KTX2Texture::SelectTranscodeTarget() const
+	{
+		constexpr std::array<std::pair<VkFormat, VkFormat>, 4> candidates // UNORM, SRGB
+		{ {
+			{ VK_FORMAT_BC7_UNORM_BLOCK,						VK_FORMAT_BC7_SRGB_BLOCK },
+			{ VK_FORMAT_ASTC_4x4_UNORM_BLOCK,				VK_FORMAT_ASTC_4x4_SRGB_BLOCK },
+			{ VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,	VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK },
+			{ VK_FORMAT_R8G8B8A8_UNORM,						VK_FORMAT_R8G8B8A8_SRGB }
+		} };
+		for (const auto& [unorm_format, srgb_format] : candidates)
+		{
+			VkFormat format = m_is_srgb? srgb_format : unorm_format;
+			if (is_sampled_format_supported(format)) return format;
+		}
+		return m_is_srgb? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM; // Mandatory formats
+	}
+
+	VMA::ImageType KTX2Texture::GetImageType() const
+	{
+		if (m_depth > 1) return VMA::ImageType::IMAGE_3D;
+		if (m_face_count == 6) return m_is_array? VMA::ImageType::IMAGE_CUBE_ARRAY : VMA::ImageType::IMAGE_CUBE;
+		return m_is_array? VMA::ImageType::IMAGE_2D_ARRAY : VMA::ImageType::IMAGE_2D;
+	}
+
+	std::span<const std::byte> KTX2Texture::GetLevelData(uint32_t mip_level) const
+	{
+		assert(mip_level < m_levels.size() && "Mip level is out of range!");
+		return m_levels[mip_level];
+	}
+
+	bool KTX2Texture::is_sampled_format_supported(VkFormat format) const
+	{
+		return m_context->GetFormatTable().IsSupported(format, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+	}
+
+}} // namespace Albedo::RHI
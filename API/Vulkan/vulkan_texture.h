@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class MappedFile;
+
+	// KTX2 Container (Khronos Texture 2.0) of a memory-mapped file, its levels are gathered into the staging ring straight from the mapped pages.
+	// Basis Universal (BasisLZ / UASTC) and Zstandard payloads are decoded by a Transcoder on the worker pool (The RHI does not ship one).
+	class KTX2Texture
+	{
+	public:
+		enum class Supercompression : uint32_t { NONE = 0, BASIS_LZ = 1, ZSTANDARD = 2, ZLIB = 3 };
+		// Decode one level into Image::GetDataSize(mip_level, 1) bytes of target_format (Called on worker threads)
+		using Transcoder = std::function<std::vector<std::byte>(const KTX2Texture& texture, uint32_t mip_level, VkFormat target_format)>;
+
+		// Allocate the image and queue its upload on the Upload Engine (Flush it and wait the token before sampling)
+		// With VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT (VulkanContext::IsHostImageCopySupported()), the levels are copied from the host before returning.
+		// The image starts at first_mip_level (Smaller levels only, e.g. The Streamer of a TextureResidencyManager).
+		std::shared_ptr<VMA::Image> Upload(VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT, const Transcoder& transcoder = {},
+			VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VMA::MemoryPool memory_pool = VMA::MemoryPool::STREAMING,
+			uint32_t first_mip_level = 0);
+		// Best sampled format of this device for Basis payloads: BC7 > ASTC 4x4 > ETC2 RGBA8 > RGBA8 (sRGB variants if IsSRGB())
+		VkFormat SelectTranscodeTarget() const;
+
+		VkFormat GetFormat() const { return m_format; } // VK_FORMAT_UNDEFINED for Basis payloads
+		uint32_t Width() const { return m_width; }
+		uint32_t Height() const { return m_height; }
+		uint32_t Depth() const { return m_depth; }
+		uint32_t ArrayLayers() const { return m_layer_count * m_face_count; } // Including cube faces
+		uint32_t MipLevels() const { return static_cast<uint32_t>(m_levels.size()); }
+		VMA::ImageType GetImageType() const;
+		Supercompression GetSupercompression() const { return m_supercompression; }
+		bool IsTranscodingNeeded() const { return m_format == VK_FORMAT_UNDEFINED || m_supercompression != Supercompression::NONE; }
+		bool IsSRGB() const { return m_is_srgb; } // Transfer function of the Data Format Descriptor
+		uint8_t GetColorModel() const { return m_color_model; } // KHR_DF_MODEL_* (ETC1S: 163, UASTC: 166)
+		std::span<const std::byte> GetLevelData(uint32_t mip_level) const; // As stored (Supercompressed unless NONE)
+		std::span<const std::byte> GetSupercompressionGlobalData() const { return m_global_data; } // e.g. BasisLZ codebooks
+
+	public:
+		KTX2Texture() = delete;
+		KTX2Texture(std::shared_ptr<VulkanContext> vulkan_context, std::string_view path);
+		~KTX2Texture();
+		KTX2Texture(const KTX2Texture&) = delete;
+
+	private:
+		bool is_sampled_format_supported(VkFormat format) const;
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::string m_path;
+		std::unique_ptr<MappedFile> m_file;
+
+		VkFormat m_format = VK_FORMAT_UNDEFINED;
+		uint32_t m_width = 0;
+		uint32_t m_height = 1;
+		uint32_t m_depth = 1;
+		uint32_t m_layer_count = 1;
+		uint32_t m_face_count = 1;
+		bool m_is_array = false;
+		Supercompression m_supercompression = Supercompression::NONE;
+		uint8_t m_color_model = 0;
+		bool m_is_srgb = false;
+		std::vector<std::span<const std::byte>> m_levels; // Level 0 is the largest
+		std::span<const std::byte> m_global_data;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,114 @@
+#include "vulkan_trace.h"
+
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef ALBEDO_RHI_TRACY
+#include <tracy/TracyC.h>
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	void Trace::SetSink(std::shared_ptr<TraceSink> sink)
+	{
+		static std::mutex mutex;
+		static std::vector<std::shared_ptr<TraceSink>> sinks; // Keep-alive
+		std::scoped_lock guard{ mutex };
+		s_sink.store(sink.get(), std::memory_order_release);
+		if (sink) sinks.emplace_back(std::move(sink));
+	}
+
+	int64_t Trace::Now()
+	{
+		return ToTraceTime(std::chrono::steady_clock::now());
+	}
+
+	int64_t Trace::ToTraceTime(std::chrono::steady_clock::time_point time)
+	{
+		static const auto origin = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::microseconds>(time - origin).count();
+	}
+
+	ChromeTraceSink::ChromeTraceSink(std::string_view trace_file) :
+		m_trace_file{ trace_file }
+	{
+
+	}
+
+	ChromeTraceSink::~ChromeTraceSink()
+	{
+		try { Flush(); }
+		catch (...) {} // Tracing must not take the application down
+	}
+
+	void ChromeTraceSink::EndZone(const char* name, int64_t begin_us, int64_t end_us)
+	{
+		uint32_t track = thread_track();
+		std::scoped_lock guard{ m_mutex };
+		m_events.emplace_back(Event{ .name = name, .track = track, .begin_us = begin_us, .duration_us = end_us - begin_us });
+	}
+
+	void ChromeTraceSink::GPUZone(std::string_view name, uint32_t depth, int64_t begin_us, int64_t end_us)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_events.emplace_back(Event{ .name = std::string(name), .track = GPU_TRACK, .begin_us = begin_us, .duration_us = end_us - begin_us });
+	}
+
+	void ChromeTraceSink::Flush()
+	{
+		std::scoped_lock guard{ m_mutex };
+		std::ofstream file(m_trace_file, std::ios::trunc);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the trace file {}!", m_trace_file));
+
+		file << "{\"traceEvents\":[\n";
+		file << R"({"name":"thread_name","ph":"M","pid":0,"tid":0,"args":{"name":"GPU"}})";
+		for (const auto& event : m_events)
+		{
+			std::string name;
+			name.reserve(event.name.size());
+			for (char c : event.name)
+			{
+				if (c == '"' || c == '\\') name += '\\';
+				if (static_cast<unsigned char>(c) >= 0x20) name += c;
+			}
+			file << std::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{},\"dur\":{}}}",
+				name, event.track, event.begin_us, event.duration_us);
+		}
+		file << "\n]}\n";
+	}
+
+	uint32_t ChromeTraceSink::thread_track()
+	{
+		static std::atomic<uint32_t> nextTrack{ GPU_TRACK + 1 };
+		thread_local uint32_t track = nextTrack.fetch_add(1, std::memory_order_relaxed);
+		return track;
+	}
+
+#ifdef ALBEDO_RHI_TRACY
+	// Open Tracy zones of this thread (Zones are strictly nested)
+	static thread_local std::vector<TracyCZoneCtx> TRACY_ZONE_STACK;
+
+	void TracySink::BeginZone(const char* name)
+	{
+		std::string_view zoneName{ name };
+		uint64_t sourceLocation = ___tracy_alloc_srcloc_name(0, "AlbedoRHI", 9, name, zoneName.size(), name, zoneName.size(), 0);
+		TRACY_ZONE_STACK.emplace_back(___tracy_emit_zone_begin_alloc(sourceLocation, 1));
+	}
+
+	void TracySink::EndZone(const char* name, int64_t begin_us, int64_t end_us)
+	{
+		if (TRACY_ZONE_STACK.empty()) return; // Sink was set inside the zone
+		___tracy_emit_zone_end(TRACY_ZONE_STACK.back());
+		TRACY_ZONE_STACK.pop_back();
+	}
+
+	void TracySink::GPUZone(std::string_view name, uint32_t depth, int64_t begin_us, int64_t end_us)
+	{
+		auto message = std::format("[GPU] {:>{}}{} {:.3f} ms", "", depth * 2, name, (end_us - begin_us) / 1000.0);
+		___tracy_emit_message(message.data(), message.size(), 0);
+	}
+#endif
+
+}} // namespace Albedo::RHI
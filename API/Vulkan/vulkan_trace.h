@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <string_view>
+
+// CPU Trace Zones (Scoped zones around the RHI hot paths, forwarded to a pluggable TraceSink)
+// Define ALBEDO_RHI_TRACING=1 (CMake: ALBEDO_RHI_TRACING) to compile them in, otherwise a zone is an empty statement.
+#ifndef ALBEDO_RHI_TRACING
+#define ALBEDO_RHI_TRACING 0
+#endif
+
+#define ALBEDO_RHI_TRACE_CONCAT_IMPL(a, b) a##b
+#define ALBEDO_RHI_TRACE_CONCAT(a, b) ALBEDO_RHI_TRACE_CONCAT_IMPL(a, b)
+#if ALBEDO_RHI_TRACING
+// The name must be a string literal (Sinks keep the pointer)
+#define ALBEDO_RHI_TRACE_ZONE(name) ::Albedo::RHI::Trace::Scope ALBEDO_RHI_TRACE_CONCAT(_albedo_trace_zone_, __LINE__){ name }
+#else
+#define ALBEDO_RHI_TRACE_ZONE(name) ((void)0)
+#endif
+
+namespace Albedo {
+namespace RHI
+{
+	constexpr const bool EnableTracing = ALBEDO_RHI_TRACING;
+
+	// Timestamps are microseconds of the steady clock since the first Trace::Now() call
+	class TraceSink
+	{
+	public:
+		virtual ~TraceSink() = default;
+		// Called on the zone's thread (Zones of one thread are strictly nested)
+		virtual void BeginZone(const char* name) {}
+		virtual void EndZone(const char* name, int64_t begin_us, int64_t end_us) = 0;
+		// Resolved GPU timestamp zones (GPUProfiler), already mapped onto the CPU timeline
+		virtual void GPUZone(std::string_view name, uint32_t depth, int64_t begin_us, int64_t end_us) {}
+	};
+
+	class Trace
+	{
+	public:
+		// Set once at startup (A replaced sink is kept alive until exit, zones in flight may still reference it)
+		static void SetSink(std::shared_ptr<TraceSink> sink);
+		static TraceSink* GetSink() { return s_sink.load(std::memory_order_acquire); }
+		static bool IsEnabled() { return EnableTracing && GetSink() != nullptr; }
+		static int64_t Now();
+		static int64_t ToTraceTime(std::chrono::steady_clock::time_point time); // Microseconds on the timeline of Now()
+
+		class Scope // RAII Zone (Use ALBEDO_RHI_TRACE_ZONE(name))
+		{
+		public:
+			explicit Scope(const char* name) : m_name{ name }, m_sink{ GetSink() }
+			{
+				if (!m_sink) return;
+				m_sink->BeginZone(m_name);
+				m_begin_us = Now();
+			}
+			~Scope() { if (m_sink) m_sink->EndZone(m_name, m_begin_us, Now()); }
+			Scope(const Scope&) = delete;
+		private:
+			const char* m_name;
+			TraceSink* m_sink;
+			int64_t m_begin_us = 0;
+		};
+
+	private:
+		static inline std::atomic<TraceSink*> s_sink{ nullptr };
+	};
+
+	// Chrome Trace Event JSON (Open in chrome://tracing or ui.perfetto.dev). CPU zones use one track per thread, GPU zones a "GPU" track.
+	class ChromeTraceSink : public TraceSink
+	{
+	public:
+		void EndZone(const char* name, int64_t begin_us, int64_t end_us) override;
+		void GPUZone(std::string_view name, uint32_t depth, int64_t begin_us, int64_t end_us) override;
+		void Flush(); // Rewrite the whole file (Also called by the destructor)
+
+	public:
+		ChromeTraceSink() = delete;
+		ChromeTraceSink(std::string_view trace_file);
+		~ChromeTraceSink() override;
+		ChromeTraceSink(const ChromeTraceSink&) = delete;
+
+	private:
+		struct Event
+		{
+			std::string name;
+			uint32_t track;
+			int64_t begin_us;
+			int64_t duration_us;
+		};
+		static uint32_t thread_track(); // Small per-thread index
+		static constexpr uint32_t GPU_TRACK = 0;
+
+	private:
+		const std::string m_trace_file;
+		std::mutex m_mutex;
+		std::vector<Event> m_events;
+	};
+
+#ifdef ALBEDO_RHI_TRACY
+	// Tracy (Link Tracy::TracyClient, CMake: ALBEDO_RHI_TRACY). GPU zones are sent as messages, use TracyVkZone for a real GPU timeline.
+	class TracySink : public TraceSink
+	{
+	public:
+		void BeginZone(const char* name) override;
+		void EndZone(const char* name, int64_t begin_us, int64_t end_us) override;
+		void GPUZone(std::string_view name, uint32_t depth, int64_t begin_us, int64_t end_us) override;
+	};
+#endif
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,702 @@
+#include "vulkan_upload.h"
+#include "vulkan_context.h"
+#include "vulkan_hash.h"
+
+#include <bit>
+#include <chrono>
+
+namespace Albedo {
+namespace RHI
+{
+	UploadEngine::UploadEngine(VulkanContext* vulkan_context, VkDeviceSize staging_capacity_per_batch/* = 32 * 1024 * 1024*/) :
+		m_context{ vulkan_context },
+		m_transfer_family{ (m_context->m_device_queue_family_transfer.has_value() ?
+			m_context->m_device_queue_family_transfer : m_context->m_device_queue_family_graphics).value() },
+		m_graphics_family{ m_context->m_device_queue_family_graphics.value() }
+	{
+		QueueFamilyIndex transferFamily{ m_transfer_family };
+		m_queue_timeline = m_context->GetGlobalQueueTimeline(transferFamily);
+
+		VkCommandPoolCreateInfo commandPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex = m_transfer_family
+		};
+		if (vkCreateCommandPool(
+			m_context->m_device,
+			&commandPoolCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_command_pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Upload Command Pool!");
+
+		std::array<VkCommandBuffer, MAX_BATCHES_IN_FLIGHT> commandBuffers;
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = m_command_pool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = MAX_BATCHES_IN_FLIGHT
+		};
+		if (vkAllocateCommandBuffers(m_context->m_device, &commandBufferAllocateInfo, commandBuffers.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Upload Command Buffers!");
+		for (uint32_t i = 0; i < MAX_BATCHES_IN_FLIGHT; ++i)
+			m_batches[i].command_buffer = commandBuffers[i];
+
+		m_staging_ring = m_context->m_memory_allocator->CreateStagingRing(staging_capacity_per_batch, MAX_BATCHES_IN_FLIGHT);
+		m_staging_capacity_per_batch = staging_capacity_per_batch;
+
+		// Timestamps of the transfer family (Transfer-only queues cannot record resets: Reset on the host instead)
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_context->m_physical_device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_context->m_physical_device, &queueFamilyCount, queueFamilies.data());
+		const uint32_t validBits = queueFamilies[m_transfer_family].timestampValidBits;
+		if (validBits && (!IsDedicatedTransferQueue() || m_context->m_physical_device_features12.hostQueryReset))
+		{
+			VkQueryPoolCreateInfo queryPoolCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType = VK_QUERY_TYPE_TIMESTAMP,
+				.queryCount = 2 * MAX_BATCHES_IN_FLIGHT
+			};
+			if (vkCreateQueryPool(m_context->m_device, &queryPoolCreateInfo, m_context->m_memory_allocation_callback, &m_timestamp_pool) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Upload Query Pool!");
+			m_timestamp_mask = validBits >= 64 ? std::numeric_limits<uint64_t>::max() : ((uint64_t(1) << validBits) - 1);
+			m_timestamp_period_ms = m_context->m_physical_device_properties.limits.timestampPeriod / 1e6;
+		}
+		else log::warn("Upload Engine throughput is not measured - The transfer queue does not support resettable timestamps!");
+		if (m_context->IsExternalMemoryHostSupported())
+			m_get_memory_host_pointer_properties = (PFN_vkGetMemoryHostPointerPropertiesEXT)vkGetDeviceProcAddr(m_context->m_device, "vkGetMemoryHostPointerPropertiesEXT");
+
+		log::info("Created the Upload Engine on queue family {} ({})", m_transfer_family,
+			IsDedicatedTransferQueue() ? "dedicated transfer queue" : "shared with graphics");
+	}
+
+	UploadEngine::~UploadEngine()
+	{
+		if (m_last_token) m_queue_timeline->Wait(m_last_token);
+		for (auto& batch : m_batches) release_imported_files(batch);
+		m_staging_ring.reset();
+		if (m_timestamp_pool) vkDestroyQueryPool(m_context->m_device, m_timestamp_pool, m_context->m_memory_allocation_callback);
+		vkDestroyCommandPool(m_context->m_device, m_command_pool, m_context->m_memory_allocation_callback);
+	}
+
+	void UploadEngine::UploadBuffer(std::shared_ptr<VMA::Buffer> destination, const void* data, VkDeviceSize size, VkDeviceSize offset_dst/* = 0*/)
+	{
+		assert(size + offset_dst <= destination->Size() && "You cannot upload data to a smaller buffer!");
+		std::scoped_lock guard{ m_mutex };
+		auto& batch = begin_batch();
+
+		auto staging = m_staging_ring->Allocate(size);
+		memcpy(staging.data, data, size);
+		m_staging_ring->Flush(staging);
+
+		VkBufferCopy bufferCopy
+		{
+			.srcOffset = staging.offset,
+			.dstOffset = offset_dst,
+			.size = size
+		};
+		m_context->m_dispatch.vkCmdCopyBuffer(batch.command_buffer, staging.buffer, *destination, 1, &bufferCopy);
+		batch.bytes += size;
+
+		VkBufferMemoryBarrier2 releaseBarrier
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+			.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.dstStageMask = IsDedicatedTransferQueue() ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.dstAccessMask = IsDedicatedTransferQueue() ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_READ_BIT,
+			.srcQueueFamilyIndex = IsDedicatedTransferQueue() ? m_transfer_family : VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = IsDedicatedTransferQueue() ? m_graphics_family : VK_QUEUE_FAMILY_IGNORED,
+			.buffer = *destination,
+			.offset = offset_dst,
+			.size = size
+		};
+		CommandBuffer::PipelineBarrier(batch.command_buffer, *m_context, {}, { releaseBarrier });
+
+		if (IsDedicatedTransferQueue())
+		{
+			auto& acquireBarrier = m_pending_buffer_acquisitions.emplace_back(releaseBarrier);
+			acquireBarrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+			acquireBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+			acquireBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquireBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+		}
+		batch.buffers.emplace_back(std::move(destination));
+	}
+
+	void UploadEngine::UploadImage(std::shared_ptr<VMA::Image> destination, const void* data, VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		// Same layout as VMA::Image::WriteCommand() - Texel blocks of every mip level and array layer, color aspect
+		const VkDeviceSize image_size = destination->GetDataSize();
+		if (image_size > get_band_size())
+		{
+			const auto copyBands = destination->make_copy_bands(get_band_size());
+			std::scoped_lock guard{ m_mutex };
+			for (size_t index = 0; index < copyBands.size(); ++index)
+				record_image_band(destination, static_cast<const std::byte*>(data), copyBands[index], index == 0, index + 1 == copyBands.size(), final_layout);
+			return;
+		}
+
+		std::scoped_lock guard{ m_mutex };
+		auto& batch = begin_batch();
+
+		auto staging = m_staging_ring->Allocate(image_size, destination->get_copy_alignment());
+		memcpy(staging.data, data, image_size);
+		m_staging_ring->Flush(staging);
+		record_image_upload(batch, std::move(destination), staging.buffer, staging.offset, final_layout);
+	}
+
+	void UploadEngine::StreamImage(std::shared_ptr<VMA::Image> destination, std::span<const std::byte> data,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/, uint32_t priority/* = 0*/, std::function<void(Token)> on_submitted/* = {}*/)
+	{
+		if (data.size() != destination->GetDataSize())
+			throw std::runtime_error(std::format("Failed to stream the image - {} bytes instead of {}!", data.size(), destination->GetDataSize()));
+
+		// Scheduled in order among equal priorities, so the first band is always recorded first
+		auto copyBands = std::make_shared<const std::vector<VMA::Image::CopyBand>>(destination->make_copy_bands(get_band_size()));
+		for (size_t index = 0; index < copyBands->size(); ++index)
+		{
+			const bool isLastBand = index + 1 == copyBands->size();
+			Schedule(ScheduledUpload
+				{
+					.size = (*copyBands)[index].size,
+					.record = [this, destination, data, copyBands, index, isLastBand, final_layout]()
+					{
+						std::scoped_lock guard{ m_mutex };
+						record_image_band(destination, data.data(), (*copyBands)[index], index == 0, isLastBand, final_layout);
+					},
+					.on_submitted = isLastBand ? std::move(on_submitted) : nullptr,
+					.priority = priority
+				});
+		}
+	}
+
+	void UploadEngine::UploadImageLevels(std::shared_ptr<VMA::Image> destination, const std::vector<std::span<const std::byte>>& levels,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		if (levels.size() != destination->MipLevels())
+			throw std::runtime_error("Failed to upload the image - Every mip level must be given!");
+		for (uint32_t mip_level = 0; mip_level < levels.size(); ++mip_level)
+		{
+			if (levels[mip_level].size() != destination->GetDataSize(mip_level, 1))
+				throw std::runtime_error(std::format("Failed to upload the image - Mip level {} has {} bytes instead of {}!",
+					mip_level, levels[mip_level].size(), destination->GetDataSize(mip_level, 1)));
+		}
+
+		std::scoped_lock guard{ m_mutex };
+		auto& batch = begin_batch();
+
+		auto staging = m_staging_ring->Allocate(destination->GetDataSize(), destination->get_copy_alignment());
+		auto levelData = static_cast<std::byte*>(staging.data);
+		for (const auto& level : levels) levelData = std::copy(level.begin(), level.end(), levelData);
+		m_staging_ring->Flush(staging);
+		record_image_upload(batch, std::move(destination), staging.buffer, staging.offset, final_layout);
+	}
+
+	void UploadEngine::UploadImageFile(std::shared_ptr<VMA::Image> destination, std::string_view path, size_t payload_offset/* = 0*/,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		const VkDeviceSize image_size = destination->GetDataSize();
+		auto file = std::make_shared<MappedFile>(path);
+		auto fileData = file->GetData();
+		if (payload_offset + image_size > fileData.size())
+			throw std::runtime_error(std::format("Failed to upload the image file {} - The payload is smaller than the image!", path));
+		const char* payload = fileData.data() + payload_offset;
+
+		std::scoped_lock guard{ m_mutex };
+		auto& batch = begin_batch();
+
+		ImportedFile importedFile;
+		VkDeviceSize sourceOffset = 0;
+		if (import_file(file, payload, image_size, destination->get_copy_alignment(), importedFile, sourceOffset))
+		{
+			record_image_upload(batch, std::move(destination), importedFile.buffer, sourceOffset, final_layout);
+			batch.imported_files.emplace_back(std::move(importedFile));
+			return;
+		}
+
+		// Fallback: One copy from the mapped pages (The file is unmapped when this function returns)
+		if (image_size > get_band_size())
+		{
+			const auto copyBands = destination->make_copy_bands(get_band_size());
+			for (size_t index = 0; index < copyBands.size(); ++index)
+				record_image_band(destination, reinterpret_cast<const std::byte*>(payload), copyBands[index], index == 0, index + 1 == copyBands.size(), final_layout);
+			return;
+		}
+		auto staging = m_staging_ring->Allocate(image_size, destination->get_copy_alignment());
+		memcpy(staging.data, payload, image_size);
+		m_staging_ring->Flush(staging);
+		record_image_upload(batch, std::move(destination), staging.buffer, staging.offset, final_layout);
+	}
+
+	// Seed of the digests verifying content cache hits (The keys hash the content with seed 0)
+	static constexpr uint64_t CONTENT_DIGEST_SEED = 0x5bd1e9955bd1e995ULL;
+
+	std::shared_ptr<VMA::Buffer> UploadEngine::UploadSharedBuffer(const VMA::BufferDesc& buffer_desc, std::span<const std::byte> data)
+	{
+		assert(data.size() <= buffer_desc.size && "You cannot upload data to a smaller buffer!");
+		const uint64_t key = HashCombine(HashContent(data.data(), data.size()), HashWords(data.size(), buffer_desc.size, buffer_desc.usage,
+			buffer_desc.is_exclusive, buffer_desc.is_writable, buffer_desc.is_readable, buffer_desc.is_persistent));
+		const uint64_t digest = HashContent(data.data(), data.size(), CONTENT_DIGEST_SEED);
+		if (auto buffer = find_shared(m_shared_buffers, key, digest, data.size())) return buffer;
+
+		auto buffer = m_context->m_memory_allocator->AllocateBuffer(buffer_desc.size, buffer_desc.usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			buffer_desc.is_exclusive, buffer_desc.is_writable, buffer_desc.is_readable, buffer_desc.is_persistent);
+		UploadBuffer(buffer, data.data(), data.size());
+		return publish_shared(m_shared_buffers, key, digest, std::move(buffer));
+	}
+
+	std::shared_ptr<VMA::Image> UploadEngine::UploadSharedImage(const VMA::ImageDesc& image_desc, std::span<const std::byte> data,
+		VkImageLayout final_layout/* = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
+	{
+		const uint64_t key = HashCombine(HashContent(data.data(), data.size()), HashWords(data.size(), image_desc.aspect, image_desc.usage,
+			image_desc.width, image_desc.height, image_desc.channel, image_desc.format, image_desc.tiling_mode, image_desc.miplevel,
+			image_desc.image_type, image_desc.depth_or_layers, final_layout));
+		const uint64_t digest = HashContent(data.data(), data.size(), CONTENT_DIGEST_SEED);
+		if (auto image = find_shared(m_shared_images, key, digest, data.size())) return image;
+
+		auto image = m_context->m_memory_allocator->AllocateImage(image_desc.aspect, image_desc.usage, image_desc.width, image_desc.height,
+			image_desc.channel, image_desc.format, VK_IMAGE_LAYOUT_UNDEFINED, image_desc.tiling_mode, image_desc.miplevel,
+			VMA::MemoryPool::GENERAL, image_desc.image_type, image_desc.depth_or_layers);
+		if (data.size() != image->GetDataSize())
+			throw std::runtime_error(std::format("Failed to upload the shared image - {} bytes instead of {}!", data.size(), image->GetDataSize()));
+		UploadImage(image, data.data(), final_layout);
+		return publish_shared(m_shared_images, key, digest, std::move(image));
+	}
+
+	UploadEngine::ContentCacheStatistics UploadEngine::GetContentCacheStatistics()
+	{
+		std::scoped_lock guard{ m_content_mutex };
+		auto is_expired = [](const auto& entry) { return entry.second.resource.expired(); };
+		std::erase_if(m_shared_buffers, is_expired);
+		std::erase_if(m_shared_images, is_expired);
+		auto statistics = m_content_statistics;
+		statistics.entries = m_shared_buffers.size() + m_shared_images.size();
+		return statistics;
+	}
+
+	template<typename Resource>
+	std::shared_ptr<Resource> UploadEngine::find_shared(SharedResources<Resource>& shared_resources, uint64_t key, uint64_t digest, VkDeviceSize size)
+	{
+		std::scoped_lock guard{ m_content_mutex };
+		auto iter = shared_resources.find(key);
+		if (iter == shared_resources.end()) return nullptr;
+		auto resource = iter->second.resource.lock();
+		if (!resource)
+		{
+			shared_resources.erase(iter); // Released by its last user
+			return nullptr;
+		}
+		if (iter->second.digest != digest) return nullptr; // Key collision with another content
+		++m_content_statistics.hits;
+		m_content_statistics.saved_bytes += size;
+		return resource;
+	}
+
+	template<typename Resource>
+	std::shared_ptr<Resource> UploadEngine::publish_shared(SharedResources<Resource>& shared_resources, uint64_t key, uint64_t digest,
+		std::shared_ptr<Resource> resource)
+	{
+		std::scoped_lock guard{ m_content_mutex };
+		++m_content_statistics.misses;
+		auto& entry = shared_resources[key];
+		if (auto published = entry.resource.lock())
+		{
+			if (entry.digest == digest) return published; // Ours is released once its upload completed
+			return resource; // Key collision: The resident content keeps the entry, ours is not shared
+		}
+		entry = { .resource = resource, .digest = digest };
+		// Sweep the expired entries whenever the map doubles (Amortized)
+		if (shared_resources.size() >= 64 && std::has_single_bit(shared_resources.size()))
+			std::erase_if(shared_resources, [](const auto& shared) { return shared.second.resource.expired(); });
+		return resource;
+	}
+
+	UploadEngine::Token UploadEngine::Flush()
+	{
+		std::scoped_lock guard{ m_mutex };
+		return submit_batch();
+	}
+
+	UploadEngine::Token UploadEngine::submit_batch()
+	{
+		auto& batch = m_batches[m_current_batch];
+		if (!batch.is_recording) return m_last_token;
+
+		if (batch.is_timed)
+			m_context->m_dispatch.vkCmdWriteTimestamp(batch.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestamp_pool, 2 * m_current_batch + 1);
+		if (m_context->m_dispatch.vkEndCommandBuffer(batch.command_buffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to end the Vulkan Upload Command Buffer!");
+		batch.is_recording = false;
+		batch.token = m_queue_timeline->Submit({ &batch.command_buffer, 1 });
+
+		m_last_token = batch.token;
+		m_current_batch = (m_current_batch + 1) % MAX_BATCHES_IN_FLIGHT;
+		return m_last_token;
+	}
+
+	bool UploadEngine::IsComplete(Token token)
+	{
+		return m_queue_timeline->IsComplete(token);
+	}
+
+	void UploadEngine::Wait(Token token, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
+	{
+		m_queue_timeline->Wait(token, timeout);
+	}
+
+	GPUAwaitable UploadEngine::Completion(Token token)
+	{
+		return m_context->GetCompletionPoller().Await(m_queue_timeline->GetSemaphore(), token);
+	}
+
+	VkSemaphore UploadEngine::GetTimelineSemaphore()
+	{
+		return m_queue_timeline->GetSemaphore();
+	}
+
+	void UploadEngine::Schedule(ScheduledUpload upload)
+	{
+		assert(upload.record && "Invalid scheduled upload!");
+		std::scoped_lock guard{ m_schedule_mutex };
+		const uint64_t sequence = ++m_schedule_sequence;
+		const uint64_t deadlineFrame = upload.deadline == NO_DEADLINE ? std::numeric_limits<uint64_t>::max() : m_frame + upload.deadline;
+		m_scheduled_by_priority.emplace(~upload.priority, sequence);
+		if (upload.deadline != NO_DEADLINE) m_scheduled_by_deadline.emplace(deadlineFrame, sequence);
+		m_scheduled_bytes += upload.size;
+		m_scheduled.emplace(sequence, Scheduled{ .upload = std::move(upload), .deadline_frame = deadlineFrame });
+	}
+
+	void UploadEngine::SetScheduleConfig(const ScheduleConfig& config)
+	{
+		assert(config.min_frame_bytes <= config.max_frame_bytes && config.frame_time_ms > 0.0 && "Invalid schedule config!");
+		std::scoped_lock guard{ m_schedule_mutex };
+		m_schedule_config = config;
+	}
+
+	UploadEngine::ScheduleStatistics UploadEngine::UpdateFrame()
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::UploadEngine::UpdateFrame");
+		const auto begin = std::chrono::steady_clock::now();
+		ScheduleStatistics statistics;
+		{
+			std::scoped_lock guard{ m_mutex };
+			for (uint32_t i = 0; i < MAX_BATCHES_IN_FLIGHT; ++i)
+			{
+				const auto& batch = m_batches[i];
+				if (!batch.is_recording && batch.token && m_queue_timeline->IsComplete(batch.token)) resolve_timestamps(i);
+			}
+			statistics.throughput = m_throughput;
+		}
+
+		std::unique_lock guard{ m_schedule_mutex };
+		const auto& config = m_schedule_config;
+		const auto maxFrameBytes = std::min(config.max_frame_bytes, m_staging_capacity_per_batch); // One batch per frame
+		statistics.frame_bytes = (config.auto_tune && statistics.throughput > 0.0) ?
+			std::clamp(static_cast<VkDeviceSize>(statistics.throughput * config.frame_time_ms), std::min(config.min_frame_bytes, maxFrameBytes), maxFrameBytes) :
+			maxFrameBytes;
+		const double frameTimeMs = config.frame_time_ms;
+		++m_frame;
+
+		// Due uploads first (Beyond the budget), then by priority until the byte or CPU time budget is spent
+		std::vector<std::function<void(Token)>> submittedCallbacks;
+		while (!m_scheduled.empty())
+		{
+			uint64_t sequence = 0;
+			if (!m_scheduled_by_deadline.empty() && m_scheduled_by_deadline.begin()->first <= m_frame)
+			{
+				sequence = m_scheduled_by_deadline.begin()->second;
+				++statistics.overdue_uploads;
+			}
+			else
+			{
+				sequence = m_scheduled_by_priority.begin()->second;
+				const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+				if (statistics.dispatched_uploads && (statistics.dispatched_bytes + m_scheduled.at(sequence).upload.size > statistics.frame_bytes ||
+					elapsed.count() > frameTimeMs)) break;
+			}
+
+			auto iter = m_scheduled.find(sequence);
+			auto upload = std::move(iter->second.upload);
+			m_scheduled_by_priority.erase({ ~upload.priority, sequence });
+			if (upload.deadline != NO_DEADLINE) m_scheduled_by_deadline.erase({ iter->second.deadline_frame, sequence });
+			m_scheduled.erase(iter);
+			m_scheduled_bytes -= upload.size;
+			statistics.dispatched_bytes += upload.size;
+			++statistics.dispatched_uploads;
+
+			guard.unlock(); // The recorder calls Upload*() and may schedule more uploads
+			upload.record();
+			if (upload.on_submitted) submittedCallbacks.emplace_back(std::move(upload.on_submitted));
+			guard.lock();
+		}
+		statistics.queued_uploads = m_scheduled.size();
+		statistics.queued_bytes = m_scheduled_bytes;
+		guard.unlock();
+
+		if (!statistics.dispatched_uploads) return statistics;
+		const Token token = Flush();
+		for (auto& on_submitted : submittedCallbacks) on_submitted(token);
+		return statistics;
+	}
+
+	void UploadEngine::AcquireCommand(CommandBuffer& graphics_command_buffer)
+	{
+		assert(graphics_command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		std::scoped_lock guard{ m_mutex };
+		if (m_pending_buffer_acquisitions.empty() && m_pending_image_acquisitions.empty()) return;
+
+		graphics_command_buffer.PipelineBarrier(m_pending_image_acquisitions, m_pending_buffer_acquisitions);
+		m_pending_buffer_acquisitions.clear();
+		m_pending_image_acquisitions.clear();
+	}
+
+	UploadEngine::Batch& UploadEngine::begin_batch()
+	{
+		auto& batch = m_batches[m_current_batch];
+		if (batch.is_recording) return batch;
+
+		// Reuse the batch slot (and its staging partition) after its last submission retired
+		if (batch.token) m_queue_timeline->Wait(batch.token);
+		resolve_timestamps(m_current_batch);
+		batch.buffers.clear();
+		batch.images.clear();
+		release_imported_files(batch);
+		m_staging_ring->BeginFrame(m_current_batch);
+
+		m_context->m_dispatch.vkResetCommandBuffer(batch.command_buffer, 0);
+		VkCommandBufferBeginInfo commandBufferBeginInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+		};
+		if (m_context->m_dispatch.vkBeginCommandBuffer(batch.command_buffer, &commandBufferBeginInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to begin the Vulkan Upload Command Buffer!");
+		batch.is_recording = true;
+		batch.bytes = 0;
+
+		batch.is_timed = m_timestamp_pool != VK_NULL_HANDLE;
+		if (batch.is_timed)
+		{
+			if (IsDedicatedTransferQueue()) vkResetQueryPool(m_context->m_device, m_timestamp_pool, 2 * m_current_batch, 2);
+			else m_context->m_dispatch.vkCmdResetQueryPool(batch.command_buffer, m_timestamp_pool, 2 * m_current_batch, 2);
+			m_context->m_dispatch.vkCmdWriteTimestamp(batch.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestamp_pool, 2 * m_current_batch);
+		}
+		return batch;
+	}
+
+	void UploadEngine::resolve_timestamps(uint32_t batch_index)
+	{
+		auto& batch = m_batches[batch_index];
+		if (!batch.is_timed) return;
+		batch.is_timed = false;
+		// Small batches are dominated by the submission latency
+		static constexpr VkDeviceSize MIN_MEASURED_BYTES = 1024 * 1024;
+		if (batch.bytes < MIN_MEASURED_BYTES) return;
+
+		std::array<uint64_t, 2> timestamps{};
+		if (vkGetQueryPoolResults(
+			m_context->m_device,
+			m_timestamp_pool,
+			2 * batch_index, 2,
+			sizeof(timestamps), timestamps.data(),
+			sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) return;
+		const double durationMs = ((timestamps[1] - timestamps[0]) & m_timestamp_mask) * m_timestamp_period_ms;
+		if (durationMs <= 0.0) return;
+
+		const double throughput = static_cast<double>(batch.bytes) / durationMs;
+		m_throughput = m_throughput > 0.0 ? 0.8 * m_throughput + 0.2 * throughput : throughput;
+	}
+
+	void UploadEngine::record_image_upload(Batch& batch, std::shared_ptr<VMA::Image> destination, VkBuffer source, VkDeviceSize source_offset, VkImageLayout final_layout)
+	{
+		record_image_copy_barrier(batch, *destination);
+		auto copyRegions = destination->make_copy_regions(source_offset, 0, destination->MipLevels());
+		m_context->m_dispatch.vkCmdCopyBufferToImage(batch.command_buffer, source, *destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+		batch.bytes += destination->GetDataSize();
+		record_image_release(batch, *destination, final_layout);
+		batch.images.emplace_back(std::move(destination));
+	}
+
+	void UploadEngine::record_image_band(std::shared_ptr<VMA::Image> destination, const std::byte* data, const VMA::Image::CopyBand& band,
+		bool is_first_band, bool is_last_band, VkImageLayout final_layout)
+	{
+		// The staging partition of this batch is full: Submit it and continue in the next one (Waits only if all batches are in flight)
+		auto* batch = &begin_batch();
+		const VkDeviceSize alignment = destination->get_copy_alignment();
+		if (batch->bytes && m_staging_ring->GetFrameAvailable() < band.size + alignment)
+		{
+			submit_batch();
+			batch = &begin_batch();
+		}
+
+		auto staging = m_staging_ring->Allocate(band.size, alignment);
+		memcpy(staging.data, data + band.data_offset, band.size);
+		m_staging_ring->Flush(staging);
+
+		// Bands submitted in earlier batches were copied before (Same queue, in submission order)
+		if (is_first_band) record_image_copy_barrier(*batch, *destination);
+		auto copyRegions = band.regions;
+		for (auto& copyRegion : copyRegions) copyRegion.bufferOffset += staging.offset;
+		m_context->m_dispatch.vkCmdCopyBufferToImage(batch->command_buffer, staging.buffer, *destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+		batch->bytes += band.size;
+		if (is_last_band) record_image_release(*batch, *destination, final_layout);
+		batch->images.emplace_back(std::move(destination));
+	}
+
+	void UploadEngine::record_image_copy_barrier(Batch& batch, VMA::Image& destination)
+	{
+		const VkImageSubresourceRange subresourceRange
+		{
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = destination.MipLevels(),
+			.baseArrayLayer = 0,
+			.layerCount = destination.ArrayLayers()
+		};
+
+		// Full overwrite - previous contents are discarded, so no ownership is needed before the copy
+		VkImageMemoryBarrier2 copyBarrier
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+			.srcAccessMask = VK_ACCESS_2_NONE,
+			.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+			.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = destination,
+			.subresourceRange = subresourceRange
+		};
+		CommandBuffer::PipelineBarrier(batch.command_buffer, *m_context, { copyBarrier });
+	}
+
+	void UploadEngine::record_image_release(Batch& batch, VMA::Image& destination, VkImageLayout final_layout)
+	{
+		const VkImageSubresourceRange subresourceRange
+		{
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = destination.MipLevels(),
+			.baseArrayLayer = 0,
+			.layerCount = destination.ArrayLayers()
+		};
+		VkImageMemoryBarrier2 releaseBarrier
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+			.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.dstStageMask = IsDedicatedTransferQueue() ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.dstAccessMask = IsDedicatedTransferQueue() ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_READ_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.newLayout = final_layout,
+			.srcQueueFamilyIndex = IsDedicatedTransferQueue() ? m_transfer_family : VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = IsDedicatedTransferQueue() ? m_graphics_family : VK_QUEUE_FAMILY_IGNORED,
+			.image = destination,
+			.subresourceRange = subresourceRange
+		};
+		CommandBuffer::PipelineBarrier(batch.command_buffer, *m_context, { releaseBarrier });
+
+		if (IsDedicatedTransferQueue())
+		{
+			auto& acquireBarrier = m_pending_image_acquisitions.emplace_back(releaseBarrier);
+			acquireBarrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+			acquireBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+			acquireBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquireBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+		}
+		destination.assume_access(ResourceAccess // Layout once the upload has completed (Released / acquired above)
+			{
+				.stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.access = VK_ACCESS_2_MEMORY_READ_BIT,
+				.layout = final_layout
+			});
+	}
+
+	bool UploadEngine::import_file(std::shared_ptr<MappedFile> file, const char* data, VkDeviceSize size, VkDeviceSize copy_alignment,
+		ImportedFile& imported_file, VkDeviceSize& source_offset)
+	{
+		if (!m_get_memory_host_pointer_properties) return false;
+
+		// The imported range must start and end on minImportedHostPointerAlignment inside the mapped pages
+		const VkDeviceSize alignment = m_context->m_physical_device_external_memory_host_properties.minImportedHostPointerAlignment;
+		const auto fileBegin = reinterpret_cast<uintptr_t>(file->GetData().data());
+		const auto fileEnd = (fileBegin + file->GetData().size() + alignment - 1) & ~(alignment - 1);
+		const auto importBegin = reinterpret_cast<uintptr_t>(data) & ~(alignment - 1);
+		const auto importSize = (reinterpret_cast<uintptr_t>(data) + size - importBegin + alignment - 1) & ~(alignment - 1);
+		source_offset = reinterpret_cast<uintptr_t>(data) - importBegin;
+		if (importBegin < fileBegin || importBegin + importSize > fileEnd || source_offset % copy_alignment) return false; // bufferOffset: Texel block size
+
+		void* hostPointer = reinterpret_cast<void*>(importBegin);
+		VkMemoryHostPointerPropertiesEXT hostPointerProperties{ .sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT };
+		if (m_get_memory_host_pointer_properties(m_context->m_device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+			hostPointer, &hostPointerProperties) != VK_SUCCESS) return false;
+
+		VkExternalMemoryBufferCreateInfo externalMemoryBufferCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+			.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT
+		};
+		VkBufferCreateInfo bufferCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = &externalMemoryBufferCreateInfo,
+			.size = importSize,
+			.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE
+		};
+		if (vkCreateBuffer(m_context->m_device, &bufferCreateInfo, m_context->m_memory_allocation_callback, &imported_file.buffer) != VK_SUCCESS)
+			return false;
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(m_context->m_device, imported_file.buffer, &memoryRequirements);
+		const uint32_t memoryTypeBits = hostPointerProperties.memoryTypeBits & memoryRequirements.memoryTypeBits;
+		if (memoryTypeBits)
+		{
+			VkImportMemoryHostPointerInfoEXT importMemoryHostPointerInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT,
+				.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+				.pHostPointer = hostPointer
+			};
+			VkMemoryAllocateInfo memoryAllocateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+				.pNext = &importMemoryHostPointerInfo,
+				.allocationSize = importSize,
+				.memoryTypeIndex = static_cast<uint32_t>(std::countr_zero(memoryTypeBits))
+			};
+			if (vkAllocateMemory(m_context->m_device, &memoryAllocateInfo, m_context->m_memory_allocation_callback, &imported_file.memory) == VK_SUCCESS &&
+				vkBindBufferMemory(m_context->m_device, imported_file.buffer, imported_file.memory, 0) == VK_SUCCESS)
+			{
+				imported_file.file = std::move(file);
+				return true;
+			}
+		}
+
+		// e.g. Read-only pages cannot be pinned by this driver
+		vkDestroyBuffer(m_context->m_device, imported_file.buffer, m_context->m_memory_allocation_callback);
+		if (imported_file.memory) vkFreeMemory(m_context->m_device, imported_file.memory, m_context->m_memory_allocation_callback);
+		imported_file = {};
+		return false;
+	}
+
+	void UploadEngine::release_imported_files(Batch& batch)
+	{
+		for (auto& imported_file : batch.imported_files)
+		{
+			vkDestroyBuffer(m_context->m_device, imported_file.buffer, m_context->m_memory_allocation_callback);
+			vkFreeMemory(m_context->m_device, imported_file.memory, m_context->m_memory_allocation_callback);
+		}
+		batch.imported_files.clear(); // Unmap after the memory objects were freed
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <mutex>
+#include <map>
+#include <set>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class QueueTimeline;
+	class MappedFile;
+	class GPUAwaitable;
+
+	// Batches uploads onto the transfer queue family (Completion is tracked by the queue timeline)
+	class UploadEngine
+	{
+	public:
+		using Token = uint64_t; // Tick of the transfer QueueTimeline signaled when its batch has completed
+		static constexpr uint32_t NO_DEADLINE = ~0u;
+		// Scheduled Upload: Dispatched by UpdateFrame() in priority order under the per-frame budget (e.g. Level streaming)
+		struct ScheduledUpload
+		{
+			VkDeviceSize size = 0;						// Bytes charged to the frame budget (e.g. Image::GetDataSize())
+			std::function<void()> record;				// Issues the Upload*() calls once dispatched (Its data must stay valid until then)
+			std::function<void(Token)> on_submitted;	// Optional, called with the token of the batch it was flushed with
+			uint32_t priority = 0;						// Higher first, in scheduling order among equals
+			uint32_t deadline = NO_DEADLINE;			// Frames from now, dispatched regardless of the budget once due
+		};
+		struct ScheduleConfig
+		{
+			VkDeviceSize max_frame_bytes = 8 * 1024 * 1024;	// Byte budget per frame (Initial budget until the throughput is measured)
+			VkDeviceSize min_frame_bytes = 256 * 1024;		// Lower bound of the auto-tuned budget
+			double frame_time_ms = 1.0;						// Transfer time per frame (Auto-tunes the byte budget) and CPU recording time
+			bool auto_tune = true;							// Byte budget = measured throughput * frame_time_ms (Transfer queue timestamps)
+		};
+		struct ScheduleStatistics
+		{
+			size_t queued_uploads = 0;
+			VkDeviceSize queued_bytes = 0;
+			VkDeviceSize frame_bytes = 0;			// Byte budget of the last UpdateFrame()
+			VkDeviceSize dispatched_bytes = 0;		// By the last UpdateFrame()
+			uint32_t dispatched_uploads = 0;		// Ditto
+			uint32_t overdue_uploads = 0;			// Ditto (Dispatched beyond the budget by their deadline)
+			double throughput = 0.0;				// Measured bytes per millisecond (0: Not measured yet)
+		};
+		struct ContentCacheStatistics
+		{
+			size_t entries = 0;						// Resident shared resources
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			VkDeviceSize saved_bytes = 0;			// Uploads (And their allocations) skipped by hits
+		};
+
+		// Data is copied into the staging ring immediately, destinations are kept alive until completion (Thread-safe)
+		void UploadBuffer(std::shared_ptr<VMA::Buffer> destination, const void* data, VkDeviceSize size, VkDeviceSize offset_dst = 0);
+		// Image::GetDataSize() bytes (Every mip level and layer). Images larger than a band (A quarter of the staging capacity per batch)
+		// are copied in bands of block rows, submitting the batch whenever its staging partition is full: The staging footprint stays
+		// within the ring, and the copies of a band overlap with the memcpy of the next ones in the other batches.
+		void UploadImage(std::shared_ptr<VMA::Image> destination, const void* data, VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// Scheduled UploadImage() in bands (Same priority, the last one calls on_submitted): Large images stream over several frames
+		// under the UpdateFrame() budget. The data must stay valid until the last band was dispatched, and the image must not be used
+		// before the token given to on_submitted (It stays in TRANSFER_DST_OPTIMAL between the bands).
+		void StreamImage(std::shared_ptr<VMA::Image> destination, std::span<const std::byte> data,
+			VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, uint32_t priority = 0, std::function<void(Token)> on_submitted = {});
+		// One span per mip level (Image::GetDataSize(level, 1) bytes each, e.g. views of a KTX2 file), gathered into the staging ring in one pass
+		void UploadImageLevels(std::shared_ptr<VMA::Image> destination, const std::vector<std::span<const std::byte>>& levels,
+			VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// Payload (Same layout as UploadImage()) at payload_offset of a memory-mapped file: The mapped pages are imported as
+		// the copy source with VK_EXT_external_memory_host (No CPU copy), otherwise copied into the staging ring in one pass.
+		void UploadImageFile(std::shared_ptr<VMA::Image> destination, std::string_view path, size_t payload_offset = 0, VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// Content-addressed uploads (e.g. Placeholder textures, default normal maps and duplicated atlases): Data identical to a resident
+		// shared resource with the same descriptor (And final layout) returns that resource instead of a new allocation and upload.
+		// Entries are keyed by 64-bit hashes of the content and the descriptor (Hits are verified by a second, independent content hash),
+		// and hold weak references: The resource is reference-counted
+		// by its users and released with the last one (TextureResidencyManager charges a shared image once and never evicts it while shared).
+		// TRANSFER_DST is added to the usage, shared resources must not be written after their upload (Thread-safe).
+		std::shared_ptr<VMA::Buffer> UploadSharedBuffer(const VMA::BufferDesc& buffer_desc, std::span<const std::byte> data);
+		std::shared_ptr<VMA::Image> UploadSharedImage(const VMA::ImageDesc& image_desc, std::span<const std::byte> data, // Image::GetDataSize() bytes
+			VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		ContentCacheStatistics GetContentCacheStatistics();
+		Token Flush(); // Submit the pending uploads without waiting (Return the last token if nothing is pending)
+
+		void Schedule(ScheduledUpload upload); // Thread-safe
+		void SetScheduleConfig(const ScheduleConfig& config);
+		// Call once per frame: Dispatch the due uploads, then the others by priority within the byte and time budget, and flush them
+		// (At least one upload per frame, so uploads larger than the budget still progress)
+		ScheduleStatistics UpdateFrame();
+
+		bool IsComplete(Token token);
+		void Wait(Token token, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+		GPUAwaitable Completion(Token token); // co_await upload_engine.Completion(upload_engine.Flush())
+
+		// Graphics submissions wait on this semaphore with the token as the wait value
+		VkSemaphore GetTimelineSemaphore();
+		// Record the queue family ownership acquisition of all flushed uploads (No-op if transfer and graphics share a family)
+		void AcquireCommand(CommandBuffer& graphics_command_buffer);
+		bool IsDedicatedTransferQueue() const { return m_transfer_family != m_graphics_family; }
+
+	public:
+		UploadEngine() = delete;
+		UploadEngine(VulkanContext* vulkan_context, VkDeviceSize staging_capacity_per_batch = 32 * 1024 * 1024);
+		~UploadEngine(); // Wait all submitted uploads
+		UploadEngine(const UploadEngine&) = delete;
+
+	private:
+		static constexpr uint32_t MAX_BATCHES_IN_FLIGHT = 3;
+		static constexpr VkDeviceSize BANDS_PER_BATCH = 4; // Band size of large image uploads: Staging capacity per batch / BANDS_PER_BATCH
+		struct ImportedFile // Alive until the batch has completed
+		{
+			std::shared_ptr<MappedFile> file;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+		};
+		struct Batch
+		{
+			VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+			Token token = 0;
+			bool is_recording = false;
+			bool is_timed = false; // Timestamps written, resolved once after completion
+			VkDeviceSize bytes = 0;
+			std::vector<std::shared_ptr<VMA::Buffer>> buffers;
+			std::vector<std::shared_ptr<VMA::Image>> images;
+			std::vector<ImportedFile> imported_files;
+		};
+		struct Scheduled
+		{
+			ScheduledUpload upload;
+			uint64_t deadline_frame = 0;
+		};
+		Batch& begin_batch();
+		Token submit_batch(); // Synchronized by the caller
+		void resolve_timestamps(uint32_t batch_index); // Update the throughput from a completed batch (Synchronized by the caller)
+		void record_image_upload(Batch& batch, std::shared_ptr<VMA::Image> destination, VkBuffer source, VkDeviceSize source_offset, VkImageLayout final_layout);
+		void record_image_copy_barrier(Batch& batch, VMA::Image& destination); // UNDEFINED -> TRANSFER_DST of every subresource
+		void record_image_release(Batch& batch, VMA::Image& destination, VkImageLayout final_layout); // Ownership transfer & final layout
+		// One band of a large image upload (The first one transitions the image, the last one releases it), may submit the current batch
+		void record_image_band(std::shared_ptr<VMA::Image> destination, const std::byte* data, const VMA::Image::CopyBand& band,
+			bool is_first_band, bool is_last_band, VkImageLayout final_layout);
+		VkDeviceSize get_band_size() const { return std::max<VkDeviceSize>(m_staging_capacity_per_batch / BANDS_PER_BATCH, 1); }
+		// Import the pages of [data, data + size) as a transfer source (False if the driver or the alignment does not allow it)
+		bool import_file(std::shared_ptr<MappedFile> file, const char* data, VkDeviceSize size, VkDeviceSize copy_alignment,
+			ImportedFile& imported_file, VkDeviceSize& source_offset);
+		void release_imported_files(Batch& batch);
+		// Content cache: Hits save the size, publishing returns a live resource published meanwhile by another thread
+		template<typename Resource>
+		struct SharedEntry
+		{
+			std::weak_ptr<Resource> resource;
+			uint64_t digest; // Independent hash of the content (A key collision must not hand out another content)
+		};
+		template<typename Resource>
+		using SharedResources = std::unordered_map<uint64_t, SharedEntry<Resource>>;
+		template<typename Resource>
+		std::shared_ptr<Resource> find_shared(SharedResources<Resource>& shared_resources, uint64_t key, uint64_t digest, VkDeviceSize size);
+		template<typename Resource>
+		std::shared_ptr<Resource> publish_shared(SharedResources<Resource>& shared_resources, uint64_t key, uint64_t digest,
+			std::shared_ptr<Resource> resource);
+
+	private:
+		VulkanContext* const m_context; // Owner
+		uint32_t m_transfer_family;
+		uint32_t m_graphics_family;
+		std::shared_ptr<QueueTimeline> m_queue_timeline;
+		VkCommandPool m_command_pool = VK_NULL_HANDLE;
+		std::shared_ptr<VMA::StagingRing> m_staging_ring; // One partition per batch
+		VkDeviceSize m_staging_capacity_per_batch;
+		PFN_vkGetMemoryHostPointerPropertiesEXT m_get_memory_host_pointer_properties = nullptr; // VK_EXT_external_memory_host
+
+		std::mutex m_mutex;
+		std::array<Batch, MAX_BATCHES_IN_FLIGHT> m_batches;
+		uint32_t m_current_batch = 0;
+		Token m_last_token = 0;
+
+		// Ownership transfer (Released on the transfer queue, acquired on the graphics queue)
+		std::vector<VkBufferMemoryBarrier2> m_pending_buffer_acquisitions;
+		std::vector<VkImageMemoryBarrier2> m_pending_image_acquisitions;
+
+		// Throughput (Two timestamps per batch, none if the transfer family has no valid bits)
+		VkQueryPool m_timestamp_pool = VK_NULL_HANDLE;
+		uint64_t m_timestamp_mask = 0;
+		double m_timestamp_period_ms = 0.0;
+		double m_throughput = 0.0; // Bytes per millisecond (Moving average)
+
+		// Scheduled uploads
+		std::mutex m_schedule_mutex;
+		ScheduleConfig m_schedule_config;
+		uint64_t m_frame = 0;
+		uint64_t m_schedule_sequence = 0;
+		VkDeviceSize m_scheduled_bytes = 0;
+		std::map<uint64_t, Scheduled> m_scheduled; // By sequence
+		std::set<std::pair<uint32_t, uint64_t>> m_scheduled_by_priority; // (~priority, sequence)
+		std::set<std::pair<uint64_t, uint64_t>> m_scheduled_by_deadline; // (Deadline frame, sequence), only with deadlines
+
+		// Content cache (Hash of the content & descriptor -> Shared resource)
+		std::mutex m_content_mutex;
+		SharedResources<VMA::Buffer> m_shared_buffers;
+		SharedResources<VMA::Image> m_shared_images;
+		ContentCacheStatistics m_content_statistics;
+	};
+
+}} // namespace Albedo::RHI
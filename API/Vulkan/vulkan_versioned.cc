@@ -0,0 +1,44 @@
+#include "vulkan_versioned.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	FrameVersionedBuffer::FrameVersionedBuffer(std::shared_ptr<VulkanContext> vulkan_context, VkBufferUsageFlags usage, VkDeviceSize size,
+		uint32_t frames_in_flight) :
+		m_context{ std::move(vulkan_context) },
+		m_size{ size },
+		m_version_count{ frames_in_flight }
+	{
+		assert(size > 0 && frames_in_flight > 0 && "Invalid Frame-Versioned Buffer!");
+		assert((usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) && "Frame-Versioned Buffers serve uniform or storage buffers!");
+		const auto& limits = m_context->m_physical_device_properties.limits;
+		// Both limits are powers of two
+		VkDeviceSize alignment = 4;
+		if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
+		if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+		m_stride = (size + alignment - 1) & ~(alignment - 1);
+
+		m_buffer = m_context->m_memory_allocator->AllocateBuffer(m_stride * frames_in_flight, usage, true, true /*Writable*/, false, true);
+		if constexpr (EnableDebugMarkers)
+			m_buffer->SetDebugName(std::format("Frame-Versioned Buffer ({} bytes x {})", size, frames_in_flight).c_str());
+	}
+
+	void FrameVersionedBuffer::Write(uint32_t frame_index, const void* data, VkDeviceSize size/* = 0*/, VkDeviceSize offset/* = 0*/)
+	{
+		if (!size) size = m_size - offset;
+		assert(offset + size <= m_size && "Writing out of the version!");
+		m_buffer->Write({ static_cast<const std::byte*>(data), static_cast<size_t>(size) }, get_offset(frame_index) + offset);
+	}
+
+	void* FrameVersionedBuffer::Access(uint32_t frame_index)
+	{
+		return static_cast<std::byte*>(m_buffer->Access()) + get_offset(frame_index);
+	}
+
+	void FrameVersionedBuffer::Flush(uint32_t frame_index)
+	{
+		m_buffer->Flush(get_offset(frame_index), m_size);
+	}
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Frame-Versioned Buffer (Uniform & storage blocks rewritten every frame, e.g. camera and light constants): One persistently mapped
+	// allocation holding a version per frame in flight, each aligned to min(Uniform|Storage)BufferOffsetAlignment. The version of a frame
+	// slot is no longer read once its fence signaled (FrameContext::BeginFrame()), so writes never race the GPU and never wait.
+	// Bind the buffer once as a *_DYNAMIC descriptor (Offset 0, range GetSize()) and select the version by GetDynamicOffset().
+	class FrameVersionedBuffer
+	{
+	public:
+		// frame_index: FrameContext::GetFrameIndex() of the frame recording the commands that read it
+		void Write(uint32_t frame_index, const void* data, VkDeviceSize size = 0/*ALL*/, VkDeviceSize offset = 0); // Flushed for non-coherent memory
+		void* Access(uint32_t frame_index); // Call Flush() after writing non-coherent memory
+		void Flush(uint32_t frame_index);
+
+		std::shared_ptr<VMA::Buffer> GetBuffer() { return m_buffer; }
+		VkDeviceSize GetSize() const { return m_size; } // Range of the descriptor
+		VkDeviceSize GetStride() const { return m_stride; } // Between the versions
+		uint32_t GetDynamicOffset(uint32_t frame_index) const { return static_cast<uint32_t>(get_offset(frame_index)); }
+		VkDeviceAddress GetDeviceAddress(uint32_t frame_index) { return m_buffer->DeviceAddress() + get_offset(frame_index); } // Usage with SHADER_DEVICE_ADDRESS_BIT
+		uint32_t GetVersionCount() const { return m_version_count; }
+
+	public:
+		FrameVersionedBuffer() = delete;
+		// Usage: VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT and/or VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, one version per frame in flight
+		FrameVersionedBuffer(std::shared_ptr<VulkanContext> vulkan_context, VkBufferUsageFlags usage, VkDeviceSize size, uint32_t frames_in_flight);
+		FrameVersionedBuffer(const FrameVersionedBuffer&) = delete;
+
+	private:
+		VkDeviceSize get_offset(uint32_t frame_index) const
+		{
+			assert(frame_index < m_version_count && "Frame index is out of the frames in flight!");
+			return m_stride * frame_index;
+		}
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		std::shared_ptr<VMA::Buffer> m_buffer;
+		const VkDeviceSize m_size;
+		VkDeviceSize m_stride = 0;
+		const uint32_t m_version_count;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,899 @@
+#include "vulkan_video.h"
+#include "vulkan_context.h"
+
+#include <vk_mem_alloc.h>
+
+#include <algorithm>
+
+namespace Albedo {
+namespace RHI
+{
+	namespace
+	{
+		constexpr uint32_t LOG2_MAX_FRAME_NUM = 16; // frame_num wraps at 65536 (POC type 2 counts the wraps)
+		constexpr VkFormat PICTURE_FORMAT = VK_FORMAT_G8_B8R8_2PLANE_420_UNORM; // NV12
+		constexpr uint32_t CONVERT_GROUP_SIZE = 8;
+
+		uint32_t align_up(uint32_t value, uint32_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+		std::vector<VkVideoFormatPropertiesKHR> query_video_formats(VulkanContext& context,
+			const VkVideoProfileListInfoKHR& profile_list, VkImageUsageFlags usage)
+		{
+			VkPhysicalDeviceVideoFormatInfoKHR formatInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VIDEO_FORMAT_INFO_KHR,
+				.pNext = &profile_list,
+				.imageUsage = usage
+			};
+			uint32_t formatCount = 0;
+			context.m_get_physical_device_video_format_properties(context.m_physical_device, &formatInfo, &formatCount, nullptr);
+			std::vector<VkVideoFormatPropertiesKHR> formats(formatCount, { .sType = VK_STRUCTURE_TYPE_VIDEO_FORMAT_PROPERTIES_KHR });
+			context.m_get_physical_device_video_format_properties(context.m_physical_device, &formatInfo, &formatCount, formats.data());
+			formats.resize(formatCount);
+			return formats;
+		}
+	} // namespace
+
+	VideoEncoder::VideoEncoder(std::shared_ptr<VulkanContext> vulkan_context, const Config& config) :
+		m_context{ std::move(vulkan_context) },
+		m_config{ config }
+	{
+		if (!m_context->IsVideoEncodeSupported())
+			throw std::runtime_error("Failed to create the Video Encoder - H.264 encoding is not supported by the device!");
+		assert(m_config.extent.width && m_config.extent.height && !(m_config.extent.width % 2) && !(m_config.extent.height % 2) &&
+			"NV12 pictures need even extents!");
+		assert(m_config.frame_rate && m_config.gop_length && m_config.ring_size && "Invalid config of the Video Encoder!");
+		if (!m_config.bitstream_capacity) m_config.bitstream_capacity = VkDeviceSize{ m_config.extent.width } * m_config.extent.height;
+
+		m_usage_info.videoUsageHints = VK_VIDEO_ENCODE_USAGE_STREAMING_BIT_KHR;
+		m_usage_info.videoContentHints = VK_VIDEO_ENCODE_CONTENT_RENDERED_BIT_KHR;
+		m_usage_info.tuningMode = VK_VIDEO_ENCODE_TUNING_MODE_LOW_LATENCY_KHR;
+		m_h264_profile.pNext = &m_usage_info;
+		m_h264_profile.stdProfileIdc = STD_VIDEO_H264_PROFILE_IDC_MAIN;
+		m_profile.pNext = &m_h264_profile;
+		m_profile.videoCodecOperation = VK_VIDEO_CODEC_OPERATION_ENCODE_H264_BIT_KHR;
+		m_profile.chromaSubsampling = VK_VIDEO_CHROMA_SUBSAMPLING_420_BIT_KHR;
+		m_profile.lumaBitDepth = VK_VIDEO_COMPONENT_BIT_DEPTH_8_BIT_KHR;
+		m_profile.chromaBitDepth = VK_VIDEO_COMPONENT_BIT_DEPTH_8_BIT_KHR;
+		m_profile_list.profileCount = 1;
+		m_profile_list.pProfiles = &m_profile;
+
+		try
+		{
+			create_session();
+			create_slots();
+		}
+		catch (...)
+		{
+			release();
+			throw;
+		}
+		log::info("Created the Video Encoder ({}x{} coded as {}x{}, {} conversion)", m_config.extent.width, m_config.extent.height,
+			m_coded_extent.width, m_coded_extent.height, m_is_direct_conversion ? "direct" : "copied");
+	}
+
+	VideoEncoder::~VideoEncoder()
+	{
+		for (auto slotIndex : m_encoding_slots)
+		{
+			const auto& slot = m_slots[slotIndex];
+			slot.encode_timeline->Wait(slot.encode_tick);
+		}
+		release();
+	}
+
+	void VideoEncoder::release()
+	{
+		// Before the slots and the DPB release their images
+		m_context->DeferDeletion([context = m_context.get(), allocator = m_context->m_memory_allocator,
+			session = m_session, parameters = m_session_parameters, queryPool = m_feedback_query_pool,
+			memory = std::move(m_session_memory), views = std::move(m_owned_views)]()
+			{
+				for (auto view : views) vkDestroyImageView(context->m_device, view, context->m_memory_allocation_callback);
+				if (queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(context->m_device, queryPool, context->m_memory_allocation_callback);
+				if (parameters != VK_NULL_HANDLE) context->m_destroy_video_session_parameters(context->m_device, parameters, context->m_memory_allocation_callback);
+				if (session != VK_NULL_HANDLE) context->m_destroy_video_session(context->m_device, session, context->m_memory_allocation_callback);
+				for (auto allocation : memory) vmaFreeMemory(allocator->m_allocator, allocation);
+			});
+		m_session = VK_NULL_HANDLE;
+		m_session_parameters = VK_NULL_HANDLE;
+		m_feedback_query_pool = VK_NULL_HANDLE;
+	}
+
+	std::optional<VideoEncoder::Future> VideoEncoder::EncodeCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VMA::Image& source)
+	{
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(source.Width() >= m_config.extent.width && source.Height() >= m_config.extent.height && "The source is smaller than the stream!");
+
+		auto slotIndex = acquire_slot();
+		if (!slotIndex.has_value()) return std::nullopt;
+
+		source.TransitionCommand(command_buffer, ResourceAccess
+			{
+				.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+				.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			}, 0, 1);
+		return convert_command(command_buffer, convert_pipeline, source.GetSampledImageView(), *slotIndex);
+	}
+
+	std::optional<VideoEncoder::Future> VideoEncoder::EncodeCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline)
+	{
+		if (m_context->IsHeadless())
+			return EncodeCommand(command_buffer, convert_pipeline, *m_context->GetOffscreenImage(m_context->m_swapchain_current_image_index));
+
+		assert(command_buffer.IsRecording() &&
+			"You have to ensure that the command buffer is recording while using XXXCommand funcitons!");
+		assert(m_context->m_swapchain_current_extent.width >= m_config.extent.width &&
+			m_context->m_swapchain_current_extent.height >= m_config.extent.height && "The swap chain is smaller than the stream!");
+		if (!(m_context->m_swapchain_image_usage & VK_IMAGE_USAGE_SAMPLED_BIT))
+			throw std::runtime_error("Failed to encode the swap chain image - The surface does not support sampled swap chain images!");
+
+		auto slotIndex = acquire_slot();
+		if (!slotIndex.has_value()) return std::nullopt;
+
+		const uint32_t imageIndex = m_context->m_swapchain_current_image_index;
+		const VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = m_context->m_swapchain_images[imageIndex],
+				.subresourceRange = subresourceRange
+			});
+		auto future = convert_command(command_buffer, convert_pipeline, m_context->m_swapchain_imageviews[imageIndex], *slotIndex);
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.srcAccessMask = VK_ACCESS_2_NONE,
+				.dstStageMask = VK_PIPELINE_STAGE_2_NONE,
+				.dstAccessMask = VK_ACCESS_2_NONE,
+				.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = m_context->m_swapchain_images[imageIndex],
+				.subresourceRange = subresourceRange
+			});
+		command_buffer.FlushBarriers();
+		return future;
+	}
+
+	void VideoEncoder::Submit(QueueTimeline& converted_queue_timeline, uint64_t converted_tick)
+	{
+		if (m_converted_slots.empty()) return;
+		ALBEDO_RHI_TRACE_ZONE("RHI::VideoEncoder::Submit");
+
+		const uint32_t encodeQueueFamily = m_context->m_device_queue_family_video_encode.value();
+		auto commandBuffer = m_context->CreateOneTimeCommandBuffer(m_context->m_device_queue_family_video_encode);
+		commandBuffer->Begin();
+		{
+			// Acquire the pictures released by convert_command()
+			for (auto slotIndex : m_converted_slots)
+			{
+				const auto& slot = m_slots[slotIndex];
+				if (slot.converted_queue_family == encodeQueueFamily) continue;
+				commandBuffer->QueueBarrier(VkImageMemoryBarrier2
+					{
+						.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+						.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+						.srcAccessMask = VK_ACCESS_2_NONE,
+						.dstStageMask = VK_PIPELINE_STAGE_2_VIDEO_ENCODE_BIT_KHR,
+						.dstAccessMask = VK_ACCESS_2_VIDEO_ENCODE_READ_BIT_KHR,
+						.oldLayout = m_is_direct_conversion ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						.newLayout = VK_IMAGE_LAYOUT_VIDEO_ENCODE_SRC_KHR,
+						.srcQueueFamilyIndex = slot.converted_queue_family,
+						.dstQueueFamilyIndex = encodeQueueFamily,
+						.image = *slot.picture,
+						.subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+					});
+			}
+			if (!m_is_session_reset)
+			{
+				commandBuffer->QueueBarrier(VkImageMemoryBarrier2
+					{
+						.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+						.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+						.srcAccessMask = VK_ACCESS_2_NONE,
+						.dstStageMask = VK_PIPELINE_STAGE_2_VIDEO_ENCODE_BIT_KHR,
+						.dstAccessMask = VK_ACCESS_2_VIDEO_ENCODE_READ_BIT_KHR | VK_ACCESS_2_VIDEO_ENCODE_WRITE_BIT_KHR,
+						.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+						.newLayout = VK_IMAGE_LAYOUT_VIDEO_ENCODE_DPB_KHR,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.image = *m_dpb,
+						.subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 2 }
+					});
+			}
+			commandBuffer->FlushBarriers();
+
+			for (auto slotIndex : m_converted_slots) encode_command(*commandBuffer, m_slots[slotIndex], slotIndex);
+		}
+		commandBuffer->End();
+
+		const SemaphoreWaitInfo convertedWait
+		{
+			.semaphore = converted_queue_timeline.GetSemaphore(),
+			.stages = VK_PIPELINE_STAGE_2_VIDEO_ENCODE_BIT_KHR,
+			.value = converted_tick
+		};
+		const uint64_t encodeTick = commandBuffer->SubmitTick({ &convertedWait, 1 });
+		for (auto slotIndex : m_converted_slots)
+		{
+			auto& slot = m_slots[slotIndex];
+			slot.state = SlotState::ENCODING;
+			slot.encode_timeline = &commandBuffer->GetSubmittedQueueTimeline();
+			slot.encode_tick = encodeTick;
+			m_encoding_slots.push_back(slotIndex);
+		}
+		m_converted_slots.clear();
+	}
+
+	uint32_t VideoEncoder::Poll()
+	{
+		uint32_t resolvedCount = 0;
+		while (!m_encoding_slots.empty())
+		{
+			const uint32_t slotIndex = m_encoding_slots.front();
+			auto& slot = m_slots[slotIndex];
+			if (!slot.encode_timeline->IsComplete(slot.encode_tick)) break; // Completed in submission order
+			m_encoding_slots.pop_front();
+			slot.state = SlotState::FREE;
+
+			struct
+			{
+				uint32_t offset;
+				uint32_t bytes_written;
+				int32_t status; // VkQueryResultStatusKHR
+			} feedback{};
+			VkResult result = vkGetQueryPoolResults(m_context->m_device, m_feedback_query_pool, slotIndex, 1,
+				sizeof(feedback), &feedback, sizeof(feedback), VK_QUERY_RESULT_WITH_STATUS_BIT_KHR);
+			if (result != VK_SUCCESS || feedback.status != VK_QUERY_RESULT_STATUS_COMPLETE_KHR)
+			{
+				// e.g. The bitstream capacity was exceeded, restart the stream from an IDR picture
+				m_force_key_frame = true;
+				slot.promise.set_exception(std::make_exception_ptr(std::runtime_error(
+					std::format("Failed to encode the frame {} (VkResult {}, status {})!", slot.frame_index, static_cast<int>(result), feedback.status))));
+				continue;
+			}
+
+			slot.bitstream->Invalidate(feedback.offset, feedback.bytes_written);
+			Chunk chunk;
+			chunk.m_buffer = slot.bitstream;
+			chunk.m_data = static_cast<const std::byte*>(slot.bitstream->Access()) + feedback.offset;
+			chunk.m_size = feedback.bytes_written;
+			chunk.m_frame_index = slot.frame_index;
+			chunk.m_is_key_frame = slot.is_key_frame;
+			slot.promise.set_value(std::move(chunk));
+			++resolvedCount;
+		}
+		return resolvedCount;
+	}
+
+	void VideoEncoder::create_session()
+	{
+		auto device = m_context->m_device;
+		auto allocationCallback = m_context->m_memory_allocation_callback;
+
+		VkVideoEncodeH264CapabilitiesKHR h264Capabilities{ .sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_CAPABILITIES_KHR };
+		VkVideoEncodeCapabilitiesKHR encodeCapabilities{ .sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_CAPABILITIES_KHR, .pNext = &h264Capabilities };
+		VkVideoCapabilitiesKHR capabilities{ .sType = VK_STRUCTURE_TYPE_VIDEO_CAPABILITIES_KHR, .pNext = &encodeCapabilities };
+		if (m_context->m_get_physical_device_video_capabilities(m_context->m_physical_device, &m_profile, &capabilities) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Video Encoder - The H.264 Main profile is not supported!");
+		if (capabilities.maxDpbSlots < 2 || capabilities.maxActiveReferencePictures < 1 || h264Capabilities.maxPPictureL0ReferenceCount < 1)
+			throw std::runtime_error("Failed to create the Video Encoder - P-frames are not supported!");
+		constexpr VkVideoEncodeFeedbackFlagsKHR feedbackFlags =
+			VK_VIDEO_ENCODE_FEEDBACK_BITSTREAM_BUFFER_OFFSET_BIT_KHR | VK_VIDEO_ENCODE_FEEDBACK_BITSTREAM_BYTES_WRITTEN_BIT_KHR;
+		if ((encodeCapabilities.supportedEncodeFeedbackFlags & feedbackFlags) != feedbackFlags)
+			throw std::runtime_error("Failed to create the Video Encoder - The encode feedback is not supported!");
+
+		// Whole macroblocks of the access granularity, the padding is cropped by the SPS
+		m_coded_extent =
+		{
+			align_up(align_up(std::max(m_config.extent.width, capabilities.minCodedExtent.width), 16), capabilities.pictureAccessGranularity.width),
+			align_up(align_up(std::max(m_config.extent.height, capabilities.minCodedExtent.height), 16), capabilities.pictureAccessGranularity.height)
+		};
+		if (m_coded_extent.width > capabilities.maxCodedExtent.width || m_coded_extent.height > capabilities.maxCodedExtent.height)
+			throw std::runtime_error(std::format("Failed to create the Video Encoder - {}x{} exceeds the max coded extent {}x{}!",
+				m_coded_extent.width, m_coded_extent.height, capabilities.maxCodedExtent.width, capabilities.maxCodedExtent.height));
+		m_bitstream_alignment = std::max(capabilities.minBitstreamBufferSizeAlignment, capabilities.minBitstreamBufferOffsetAlignment);
+
+		if (encodeCapabilities.rateControlModes & VK_VIDEO_ENCODE_RATE_CONTROL_MODE_CBR_BIT_KHR)
+			m_rate_control_mode = VK_VIDEO_ENCODE_RATE_CONTROL_MODE_CBR_BIT_KHR;
+		else if (encodeCapabilities.rateControlModes & VK_VIDEO_ENCODE_RATE_CONTROL_MODE_VBR_BIT_KHR)
+			m_rate_control_mode = VK_VIDEO_ENCODE_RATE_CONTROL_MODE_VBR_BIT_KHR;
+		else log::warn("The video encoder has no CBR or VBR rate control, the bitrate is up to the implementation");
+		if (encodeCapabilities.maxBitrate) m_config.bitrate = static_cast<uint32_t>(std::min<uint64_t>(m_config.bitrate, encodeCapabilities.maxBitrate));
+
+		// Picture: Converted in place through storage views of its planes, or copied from separate luma & chroma images
+		auto pictureFormats = query_video_formats(*m_context, m_profile_list, VK_IMAGE_USAGE_VIDEO_ENCODE_SRC_BIT_KHR);
+		auto pictureFormat = std::find_if(pictureFormats.begin(), pictureFormats.end(),
+			[](const VkVideoFormatPropertiesKHR& properties) { return properties.format == PICTURE_FORMAT; });
+		if (pictureFormat == pictureFormats.end())
+			throw std::runtime_error("Failed to create the Video Encoder - NV12 pictures are not supported!");
+		constexpr VkImageCreateFlags planeViewFlags = VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+		m_is_direct_conversion = (pictureFormat->imageUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) &&
+			(pictureFormat->imageCreateFlags & planeViewFlags) == planeViewFlags;
+		if (!m_is_direct_conversion && !(pictureFormat->imageUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+			throw std::runtime_error("Failed to create the Video Encoder - NV12 pictures can neither be stored nor copied to!");
+		const auto& formatTable = m_context->GetFormatTable();
+		const auto storageFeatures = FormatTable::GetRequiredFeatures(VK_IMAGE_USAGE_STORAGE_BIT);
+		if (!formatTable.IsSupported(VK_FORMAT_R8_UNORM, VK_IMAGE_TILING_OPTIMAL, storageFeatures) ||
+			!formatTable.IsSupported(VK_FORMAT_R8G8_UNORM, VK_IMAGE_TILING_OPTIMAL, storageFeatures))
+			throw std::runtime_error("Failed to create the Video Encoder - R8 & R8G8 storage images are not supported!");
+
+		auto dpbFormats = query_video_formats(*m_context, m_profile_list, VK_IMAGE_USAGE_VIDEO_ENCODE_DPB_BIT_KHR);
+		if (dpbFormats.empty()) throw std::runtime_error("Failed to create the Video Encoder - No DPB format is supported!");
+		auto dpbFormat = std::find_if(dpbFormats.begin(), dpbFormats.end(),
+			[](const VkVideoFormatPropertiesKHR& properties) { return properties.format == PICTURE_FORMAT; });
+		const VkFormat referenceFormat = (dpbFormat != dpbFormats.end()) ? dpbFormat->format : dpbFormats.front().format;
+
+		// Session
+		VkVideoSessionCreateInfoKHR sessionCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_SESSION_CREATE_INFO_KHR,
+			.queueFamilyIndex = m_context->m_device_queue_family_video_encode.value(),
+			.pVideoProfile = &m_profile,
+			.pictureFormat = PICTURE_FORMAT,
+			.maxCodedExtent = m_coded_extent,
+			.referencePictureFormat = referenceFormat,
+			.maxDpbSlots = 2,
+			.maxActiveReferencePictures = 1,
+			.pStdHeaderVersion = &capabilities.stdHeaderVersion
+		};
+		if (m_context->m_create_video_session(device, &sessionCreateInfo, allocationCallback, &m_session) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Video Session!");
+
+		uint32_t requirementCount = 0;
+		m_context->m_get_video_session_memory_requirements(device, m_session, &requirementCount, nullptr);
+		std::vector<VkVideoSessionMemoryRequirementsKHR> requirements(requirementCount, { .sType = VK_STRUCTURE_TYPE_VIDEO_SESSION_MEMORY_REQUIREMENTS_KHR });
+		m_context->m_get_video_session_memory_requirements(device, m_session, &requirementCount, requirements.data());
+		std::vector<VkBindVideoSessionMemoryInfoKHR> memoryBinds;
+		memoryBinds.reserve(requirementCount);
+		const VmaAllocationCreateInfo allocationCreateInfo{ .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+		for (uint32_t i = 0; i < requirementCount; ++i)
+		{
+			VmaAllocation allocation = VK_NULL_HANDLE;
+			VmaAllocationInfo allocationInfo{};
+			if (vmaAllocateMemory(m_context->m_memory_allocator->m_allocator, &requirements[i].memoryRequirements,
+				&allocationCreateInfo, &allocation, &allocationInfo) != VK_SUCCESS)
+				throw std::runtime_error("Failed to allocate the memory of the Vulkan Video Session!");
+			m_session_memory.emplace_back(allocation);
+			memoryBinds.emplace_back(VkBindVideoSessionMemoryInfoKHR
+				{
+					.sType = VK_STRUCTURE_TYPE_BIND_VIDEO_SESSION_MEMORY_INFO_KHR,
+					.memoryBindIndex = requirements[i].memoryBindIndex,
+					.memory = allocationInfo.deviceMemory,
+					.memoryOffset = allocationInfo.offset,
+					.memorySize = requirements[i].memoryRequirements.size
+				});
+		}
+		if (m_context->m_bind_video_session_memory(device, m_session, requirementCount, memoryBinds.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to bind the memory of the Vulkan Video Session!");
+
+		// Parameters: 4:2:0 Main profile, one reference frame, POC type 2 (Output order is decoding order)
+		StdVideoH264SequenceParameterSet sps
+		{
+			.flags
+			{
+				.direct_8x8_inference_flag = 1,
+				.frame_mbs_only_flag = 1,
+				.frame_cropping_flag = (m_coded_extent.width != m_config.extent.width || m_coded_extent.height != m_config.extent.height),
+			},
+			.profile_idc = STD_VIDEO_H264_PROFILE_IDC_MAIN,
+			.level_idc = std::min(h264Capabilities.maxLevelIdc, STD_VIDEO_H264_LEVEL_IDC_5_1),
+			.chroma_format_idc = STD_VIDEO_H264_CHROMA_FORMAT_IDC_420,
+			.seq_parameter_set_id = 0,
+			.bit_depth_luma_minus8 = 0,
+			.bit_depth_chroma_minus8 = 0,
+			.log2_max_frame_num_minus4 = LOG2_MAX_FRAME_NUM - 4,
+			.pic_order_cnt_type = STD_VIDEO_H264_POC_TYPE_2,
+			.max_num_ref_frames = 1,
+			.pic_width_in_mbs_minus1 = m_coded_extent.width / 16 - 1,
+			.pic_height_in_map_units_minus1 = m_coded_extent.height / 16 - 1,
+			.frame_crop_right_offset = (m_coded_extent.width - m_config.extent.width) / 2, // In 2x2 chroma units
+			.frame_crop_bottom_offset = (m_coded_extent.height - m_config.extent.height) / 2
+		};
+		StdVideoH264PictureParameterSet pps
+		{
+			.flags
+			{
+				.entropy_coding_mode_flag = (h264Capabilities.stdSyntaxFlags & VK_VIDEO_ENCODE_H264_STD_ENTROPY_CODING_MODE_FLAG_SET_BIT_KHR) ? 1u : 0u, // CABAC
+			},
+			.seq_parameter_set_id = 0,
+			.pic_parameter_set_id = 0,
+			.weighted_bipred_idc = STD_VIDEO_H264_WEIGHTED_BIPRED_IDC_DEFAULT
+		};
+		VkVideoEncodeH264SessionParametersAddInfoKHR h264AddInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_SESSION_PARAMETERS_ADD_INFO_KHR,
+			.stdSPSCount = 1,
+			.pStdSPSs = &sps,
+			.stdPPSCount = 1,
+			.pStdPPSs = &pps
+		};
+		VkVideoEncodeH264SessionParametersCreateInfoKHR h264ParametersCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_SESSION_PARAMETERS_CREATE_INFO_KHR,
+			.maxStdSPSCount = 1,
+			.maxStdPPSCount = 1,
+			.pParametersAddInfo = &h264AddInfo
+		};
+		VkVideoSessionParametersCreateInfoKHR parametersCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_SESSION_PARAMETERS_CREATE_INFO_KHR,
+			.pNext = &h264ParametersCreateInfo,
+			.videoSession = m_session
+		};
+		if (m_context->m_create_video_session_parameters(device, &parametersCreateInfo, allocationCallback, &m_session_parameters) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Video Session Parameters!");
+
+		// SPS & PPS as the implementation encodes them (It may override some fields)
+		VkVideoEncodeH264SessionParametersGetInfoKHR h264GetInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_SESSION_PARAMETERS_GET_INFO_KHR,
+			.writeStdSPS = VK_TRUE,
+			.writeStdPPS = VK_TRUE
+		};
+		VkVideoEncodeSessionParametersGetInfoKHR getInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_SESSION_PARAMETERS_GET_INFO_KHR,
+			.pNext = &h264GetInfo,
+			.videoSessionParameters = m_session_parameters
+		};
+		size_t parameterSetsSize = 0;
+		m_context->m_get_encoded_video_session_parameters(device, &getInfo, nullptr, &parameterSetsSize, nullptr);
+		m_parameter_sets.resize(parameterSetsSize);
+		if (m_context->m_get_encoded_video_session_parameters(device, &getInfo, nullptr, &parameterSetsSize, m_parameter_sets.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to get the encoded H.264 parameter sets!");
+		m_parameter_sets.resize(parameterSetsSize);
+
+		// Encode feedback
+		VkQueryPoolVideoEncodeFeedbackCreateInfoKHR feedbackCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_VIDEO_ENCODE_FEEDBACK_CREATE_INFO_KHR,
+			.pNext = &m_profile,
+			.encodeFeedbackFlags = feedbackFlags
+		};
+		VkQueryPoolCreateInfo queryPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.pNext = &feedbackCreateInfo,
+			.queryType = VK_QUERY_TYPE_VIDEO_ENCODE_FEEDBACK_KHR,
+			.queryCount = m_config.ring_size
+		};
+		if (vkCreateQueryPool(device, &queryPoolCreateInfo, allocationCallback, &m_feedback_query_pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Video encode feedback query pool!");
+
+		// DPB: Two layers, the reconstructed picture of each frame is the reference of the next one
+		m_dpb = m_context->m_memory_allocator->AllocateVideoImage(VK_IMAGE_USAGE_VIDEO_ENCODE_DPB_BIT_KHR,
+			m_coded_extent.width, m_coded_extent.height, referenceFormat, m_profile_list, 0, 2);
+		for (uint32_t layer = 0; layer < m_dpb_views.size(); ++layer)
+			m_dpb_views[layer] = create_view(*m_dpb, referenceFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_VIDEO_ENCODE_DPB_BIT_KHR, layer);
+		if constexpr (EnableDebugMarkers) m_dpb->SetDebugName("VideoEncoder::DPB");
+	}
+
+	void VideoEncoder::create_slots()
+	{
+		auto& allocator = *m_context->m_memory_allocator;
+		const VkDeviceSize bitstreamCapacity = (m_config.bitstream_capacity + m_bitstream_alignment - 1) / m_bitstream_alignment * m_bitstream_alignment;
+		const VkImageUsageFlags pictureUsage = VK_IMAGE_USAGE_VIDEO_ENCODE_SRC_BIT_KHR |
+			(m_is_direct_conversion ? VK_IMAGE_USAGE_STORAGE_BIT : VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+		const VkImageCreateFlags pictureFlags = m_is_direct_conversion ? (VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT) : 0;
+
+		m_slots.resize(m_config.ring_size);
+		for (auto& slot : m_slots)
+		{
+			slot.picture = allocator.AllocateVideoImage(pictureUsage, m_coded_extent.width, m_coded_extent.height, PICTURE_FORMAT, m_profile_list, pictureFlags);
+			slot.picture_view = create_view(*slot.picture, PICTURE_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_VIDEO_ENCODE_SRC_BIT_KHR);
+			if (m_is_direct_conversion)
+			{
+				slot.luma_view = create_view(*slot.picture, VK_FORMAT_R8_UNORM, VK_IMAGE_ASPECT_PLANE_0_BIT, VK_IMAGE_USAGE_STORAGE_BIT);
+				slot.chroma_view = create_view(*slot.picture, VK_FORMAT_R8G8_UNORM, VK_IMAGE_ASPECT_PLANE_1_BIT, VK_IMAGE_USAGE_STORAGE_BIT);
+			}
+			else
+			{
+				constexpr VkImageUsageFlags planeUsage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+				slot.luma = allocator.AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT, planeUsage,
+					m_coded_extent.width, m_coded_extent.height, 1, VK_FORMAT_R8_UNORM);
+				slot.chroma = allocator.AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT, planeUsage,
+					m_coded_extent.width / 2, m_coded_extent.height / 2, 2, VK_FORMAT_R8G8_UNORM);
+				slot.luma_view = slot.luma->GetImageView();
+				slot.chroma_view = slot.chroma->GetImageView();
+			}
+			slot.bitstream = allocator.AllocateVideoBuffer(bitstreamCapacity, VK_BUFFER_USAGE_VIDEO_ENCODE_DST_BIT_KHR, m_profile_list, true);
+			if constexpr (EnableDebugMarkers)
+			{
+				slot.picture->SetDebugName("VideoEncoder::Picture");
+				slot.bitstream->SetDebugName("VideoEncoder::Bitstream");
+			}
+		}
+	}
+
+	VkImageView VideoEncoder::create_view(VkImage image, VkFormat format, VkImageAspectFlags aspect, VkImageUsageFlags usage, uint32_t array_layer/* = 0*/)
+	{
+		// Restricted to the usage of the view (Video and storage usages are not supported by every plane format)
+		VkImageViewUsageCreateInfo usageCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO,
+			.usage = usage
+		};
+		VkImageViewCreateInfo imageViewCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext = &usageCreateInfo,
+			.image = image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = format,
+			.subresourceRange{ aspect, 0, 1, array_layer, 1 }
+		};
+		VkImageView imageView = VK_NULL_HANDLE;
+		if (vkCreateImageView(m_context->m_device, &imageViewCreateInfo, m_context->m_memory_allocation_callback, &imageView) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Image View of the Video Encoder!");
+		m_owned_views.emplace_back(imageView);
+		return imageView;
+	}
+
+	std::optional<uint32_t> VideoEncoder::acquire_slot()
+	{
+		auto isFree = [this]() { return m_slots[m_next_slot].state == SlotState::FREE && m_slots[m_next_slot].bitstream.use_count() == 1; };
+		if (!isFree())
+		{
+			Poll();
+			if (!isFree())
+			{
+				++m_dropped_frame_count;
+				return std::nullopt;
+			}
+		}
+		const uint32_t slotIndex = m_next_slot;
+		m_next_slot = (m_next_slot + 1) % m_config.ring_size;
+		return slotIndex;
+	}
+
+	VideoEncoder::Future VideoEncoder::convert_command(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VkImageView source_view, uint32_t slot_index)
+	{
+		auto& slot = m_slots[slot_index];
+		const VkImageSubresourceRange pictureRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+		// The previous contents were consumed by a completed encode, so no ownership transfer back is needed
+		if (m_is_direct_conversion)
+		{
+			command_buffer.QueueBarrier(VkImageMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+					.srcAccessMask = VK_ACCESS_2_NONE,
+					.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+					.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+					.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+					.newLayout = VK_IMAGE_LAYOUT_GENERAL,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = *slot.picture,
+					.subresourceRange = pictureRange
+				});
+		}
+		else
+		{
+			const ResourceAccess storageWrite
+			{
+				.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.access = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+				.layout = VK_IMAGE_LAYOUT_GENERAL
+			};
+			slot.luma->TransitionCommand(command_buffer, storageWrite);
+			slot.chroma->TransitionCommand(command_buffer, storageWrite);
+		}
+
+		convert_pipeline.Bind(command_buffer);
+		auto descriptorSet = m_context->CreateDescriptorSet(convert_pipeline.GetSharedDescriptorSetLayout(0)); // Freed through the deletion queue
+		DescriptorWriteBatch{ m_context, 3 }
+			.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0, source_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+			.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, slot.luma_view, VK_IMAGE_LAYOUT_GENERAL)
+			.WriteImage(*descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2, slot.chroma_view, VK_IMAGE_LAYOUT_GENERAL)
+			.Flush();
+
+		const ConvertPushConstants pushConstants{ .extent = m_config.extent, .coded_extent = m_coded_extent };
+		command_buffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, convert_pipeline.GetPipelineLayout(), 0, { *descriptorSet });
+		command_buffer.PushConstants(convert_pipeline.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ConvertPushConstants), &pushConstants);
+		convert_pipeline.Dispatch(command_buffer,
+			(m_coded_extent.width / 2 + CONVERT_GROUP_SIZE - 1) / CONVERT_GROUP_SIZE,
+			(m_coded_extent.height / 2 + CONVERT_GROUP_SIZE - 1) / CONVERT_GROUP_SIZE);
+
+		if (!m_is_direct_conversion)
+		{
+			const ResourceAccess copySource
+			{
+				.stages = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.access = VK_ACCESS_2_TRANSFER_READ_BIT,
+				.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			};
+			slot.luma->TransitionCommand(command_buffer, copySource);
+			slot.chroma->TransitionCommand(command_buffer, copySource);
+			command_buffer.QueueBarrier(VkImageMemoryBarrier2
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+					.srcAccessMask = VK_ACCESS_2_NONE,
+					.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+					.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+					.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = *slot.picture,
+					.subresourceRange = pictureRange
+				});
+			command_buffer.FlushBarriers();
+
+			const std::array<std::pair<VMA::Image*, VkImageAspectFlagBits>, 2> planes
+			{ {
+				{ slot.luma.get(), VK_IMAGE_ASPECT_PLANE_0_BIT },
+				{ slot.chroma.get(), VK_IMAGE_ASPECT_PLANE_1_BIT }
+			} };
+			for (const auto& [plane, aspect] : planes)
+			{
+				VkImageCopy region
+				{
+					.srcSubresource{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+					.dstSubresource{ static_cast<VkImageAspectFlags>(aspect), 0, 0, 1 },
+					.extent{ plane->Width(), plane->Height(), 1 }
+				};
+				command_buffer.GetDispatch().vkCmdCopyImage(command_buffer, *plane, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					*slot.picture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+			}
+		}
+
+		// Release the picture to the encode queue (Acquired by Submit())
+		const uint32_t convertQueueFamily = command_buffer.GetQueueFamilyIndex();
+		const uint32_t encodeQueueFamily = m_context->m_device_queue_family_video_encode.value();
+		const bool isTransferred = convertQueueFamily != encodeQueueFamily;
+		command_buffer.QueueBarrier(VkImageMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = m_is_direct_conversion ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_2_COPY_BIT,
+				.srcAccessMask = m_is_direct_conversion ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_NONE, // Waited by the encode submission
+				.dstAccessMask = VK_ACCESS_2_NONE,
+				.oldLayout = m_is_direct_conversion ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.newLayout = VK_IMAGE_LAYOUT_VIDEO_ENCODE_SRC_KHR,
+				.srcQueueFamilyIndex = isTransferred ? convertQueueFamily : VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = isTransferred ? encodeQueueFamily : VK_QUEUE_FAMILY_IGNORED,
+				.image = *slot.picture,
+				.subresourceRange = pictureRange
+			});
+		command_buffer.FlushBarriers();
+
+		slot.state = SlotState::CONVERTED;
+		slot.frame_index = m_frame_count++;
+		slot.converted_queue_family = convertQueueFamily;
+		slot.promise = {};
+		m_converted_slots.push_back(slot_index);
+		return slot.promise.get_future();
+	}
+
+	void VideoEncoder::encode_command(CommandBuffer& command_buffer, Slot& slot, uint32_t slot_index)
+	{
+		const bool isIdr = !m_reference.has_value() || m_force_key_frame || m_frame_num >= m_config.gop_length;
+		if (isIdr)
+		{
+			m_frame_num = 0;
+			++m_idr_count;
+		}
+		m_force_key_frame = false;
+		const uint32_t frameNum = m_frame_num % (1u << LOG2_MAX_FRAME_NUM);
+		const int32_t picOrderCnt = static_cast<int32_t>(2 * m_frame_num); // POC type 2: Every picture is a reference
+		const uint32_t setupDpbSlot = m_reference.has_value() ? 1 - m_reference->dpb_slot : 0;
+		const StdVideoH264PictureType pictureType = isIdr ? STD_VIDEO_H264_PICTURE_TYPE_IDR : STD_VIDEO_H264_PICTURE_TYPE_P;
+
+		// Reconstructed pictures of the previous encodes are read as references
+		command_buffer.QueueBarrier(VkMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_VIDEO_ENCODE_BIT_KHR,
+				.srcAccessMask = VK_ACCESS_2_VIDEO_ENCODE_WRITE_BIT_KHR,
+				.dstStageMask = VK_PIPELINE_STAGE_2_VIDEO_ENCODE_BIT_KHR,
+				.dstAccessMask = VK_ACCESS_2_VIDEO_ENCODE_READ_BIT_KHR | VK_ACCESS_2_VIDEO_ENCODE_WRITE_BIT_KHR
+			});
+		command_buffer.FlushBarriers();
+		command_buffer.GetDispatch().vkCmdResetQueryPool(command_buffer, m_feedback_query_pool, slot_index, 1);
+
+		// Reference slots: The setup picture (Activated by this encode) and the reference of a P-frame
+		StdVideoEncodeH264ReferenceInfo setupReferenceInfo
+		{
+			.primary_pic_type = pictureType,
+			.FrameNum = frameNum,
+			.PicOrderCnt = picOrderCnt
+		};
+		VkVideoEncodeH264DpbSlotInfoKHR setupDpbSlotInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_DPB_SLOT_INFO_KHR,
+			.pStdReferenceInfo = &setupReferenceInfo
+		};
+		VkVideoPictureResourceInfoKHR setupPicture
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_PICTURE_RESOURCE_INFO_KHR,
+			.codedExtent = m_coded_extent,
+			.imageViewBinding = m_dpb_views[setupDpbSlot]
+		};
+		VkVideoReferenceSlotInfoKHR setupSlot
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_REFERENCE_SLOT_INFO_KHR,
+			.pNext = &setupDpbSlotInfo,
+			.slotIndex = static_cast<int32_t>(setupDpbSlot),
+			.pPictureResource = &setupPicture
+		};
+		StdVideoEncodeH264ReferenceInfo referenceInfo{};
+		VkVideoEncodeH264DpbSlotInfoKHR referenceDpbSlotInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_DPB_SLOT_INFO_KHR,
+			.pStdReferenceInfo = &referenceInfo
+		};
+		VkVideoPictureResourceInfoKHR referencePicture
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_PICTURE_RESOURCE_INFO_KHR,
+			.codedExtent = m_coded_extent
+		};
+		VkVideoReferenceSlotInfoKHR referenceSlot
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_REFERENCE_SLOT_INFO_KHR,
+			.pNext = &referenceDpbSlotInfo,
+			.slotIndex = -1,
+			.pPictureResource = &referencePicture
+		};
+		if (!isIdr)
+		{
+			referenceInfo.primary_pic_type = m_reference->is_idr ? STD_VIDEO_H264_PICTURE_TYPE_IDR : STD_VIDEO_H264_PICTURE_TYPE_P;
+			referenceInfo.FrameNum = m_reference->frame_num;
+			referenceInfo.PicOrderCnt = m_reference->pic_order_cnt;
+			referencePicture.imageViewBinding = m_dpb_views[m_reference->dpb_slot];
+			referenceSlot.slotIndex = static_cast<int32_t>(m_reference->dpb_slot);
+		}
+
+		// Rate control: Set by the reset of the session, later scopes begin with the same state
+		VkVideoEncodeRateControlLayerInfoKHR rateControlLayer
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_RATE_CONTROL_LAYER_INFO_KHR,
+			.averageBitrate = m_config.bitrate,
+			.maxBitrate = (m_rate_control_mode == VK_VIDEO_ENCODE_RATE_CONTROL_MODE_VBR_BIT_KHR) ? 2ull * m_config.bitrate : m_config.bitrate,
+			.frameRateNumerator = m_config.frame_rate,
+			.frameRateDenominator = 1
+		};
+		VkVideoEncodeH264RateControlInfoKHR h264RateControl
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_RATE_CONTROL_INFO_KHR,
+			.flags = VK_VIDEO_ENCODE_H264_RATE_CONTROL_REFERENCE_PATTERN_FLAT_BIT_KHR,
+			.gopFrameCount = m_config.gop_length,
+			.idrPeriod = m_config.gop_length,
+			.consecutiveBFrameCount = 0,
+			.temporalLayerCount = 1
+		};
+		const bool hasRateControlLayer = m_rate_control_mode != VK_VIDEO_ENCODE_RATE_CONTROL_MODE_DEFAULT_KHR;
+		VkVideoEncodeRateControlInfoKHR rateControl
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_RATE_CONTROL_INFO_KHR,
+			.pNext = &h264RateControl,
+			.rateControlMode = m_rate_control_mode,
+			.layerCount = hasRateControlLayer ? 1u : 0u,
+			.pLayers = hasRateControlLayer ? &rateControlLayer : nullptr,
+			.virtualBufferSizeInMs = hasRateControlLayer ? 1000u : 0u,
+			.initialVirtualBufferSizeInMs = hasRateControlLayer ? 500u : 0u
+		};
+
+		// Bound: The setup picture without a slot (slotIndex -1) and the active reference
+		std::array<VkVideoReferenceSlotInfoKHR, 2> boundSlots{ setupSlot, referenceSlot };
+		boundSlots[0].pNext = boundSlots[1].pNext = nullptr;
+		boundSlots[0].slotIndex = -1;
+		VkVideoBeginCodingInfoKHR beginCodingInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_BEGIN_CODING_INFO_KHR,
+			.pNext = m_is_session_reset ? &rateControl : nullptr,
+			.videoSession = m_session,
+			.videoSessionParameters = m_session_parameters,
+			.referenceSlotCount = isIdr ? 1u : 2u,
+			.pReferenceSlots = boundSlots.data()
+		};
+		m_context->m_cmd_begin_video_coding(command_buffer, &beginCodingInfo);
+		if (!m_is_session_reset)
+		{
+			VkVideoCodingControlInfoKHR controlInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_VIDEO_CODING_CONTROL_INFO_KHR,
+				.pNext = &rateControl,
+				.flags = VK_VIDEO_CODING_CONTROL_RESET_BIT_KHR | VK_VIDEO_CODING_CONTROL_ENCODE_RATE_CONTROL_BIT_KHR
+			};
+			m_context->m_cmd_control_video_coding(command_buffer, &controlInfo);
+			m_is_session_reset = true;
+		}
+
+		// One slice per picture, P-frames predict from the last reconstructed picture only
+		StdVideoEncodeH264SliceHeader sliceHeader
+		{
+			.slice_type = isIdr ? STD_VIDEO_H264_SLICE_TYPE_I : STD_VIDEO_H264_SLICE_TYPE_P,
+			.cabac_init_idc = STD_VIDEO_H264_CABAC_INIT_IDC_0
+		};
+		VkVideoEncodeH264NaluSliceInfoKHR naluSlice
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_NALU_SLICE_INFO_KHR,
+			.pStdSliceHeader = &sliceHeader
+		};
+		StdVideoEncodeH264ReferenceListsInfo referenceLists{};
+		std::fill(std::begin(referenceLists.RefPicList0), std::end(referenceLists.RefPicList0), STD_VIDEO_H264_NO_REFERENCE_PICTURE);
+		std::fill(std::begin(referenceLists.RefPicList1), std::end(referenceLists.RefPicList1), STD_VIDEO_H264_NO_REFERENCE_PICTURE);
+		if (!isIdr) referenceLists.RefPicList0[0] = static_cast<uint8_t>(m_reference->dpb_slot);
+		StdVideoEncodeH264PictureInfo pictureInfo
+		{
+			.flags
+			{
+				.IdrPicFlag = isIdr ? 1u : 0u,
+				.is_reference = 1
+			},
+			.seq_parameter_set_id = 0,
+			.pic_parameter_set_id = 0,
+			.idr_pic_id = static_cast<uint16_t>(m_idr_count), // Differs between consecutive IDR pictures
+			.primary_pic_type = pictureType,
+			.frame_num = frameNum,
+			.PicOrderCnt = picOrderCnt,
+			.pRefLists = &referenceLists
+		};
+		VkVideoEncodeH264PictureInfoKHR h264PictureInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_PICTURE_INFO_KHR,
+			.naluSliceEntryCount = 1,
+			.pNaluSliceEntries = &naluSlice,
+			.pStdPictureInfo = &pictureInfo
+		};
+		VkVideoEncodeInfoKHR encodeInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_INFO_KHR,
+			.pNext = &h264PictureInfo,
+			.dstBuffer = *slot.bitstream,
+			.dstBufferOffset = 0,
+			.dstBufferRange = slot.bitstream->Size(),
+			.srcPictureResource
+			{
+				.sType = VK_STRUCTURE_TYPE_VIDEO_PICTURE_RESOURCE_INFO_KHR,
+				.codedExtent = m_coded_extent,
+				.imageViewBinding = slot.picture_view
+			},
+			.pSetupReferenceSlot = &setupSlot,
+			.referenceSlotCount = isIdr ? 0u : 1u,
+			.pReferenceSlots = isIdr ? nullptr : &referenceSlot
+		};
+		command_buffer.GetDispatch().vkCmdBeginQuery(command_buffer, m_feedback_query_pool, slot_index, 0);
+		m_context->m_cmd_encode_video(command_buffer, &encodeInfo);
+		command_buffer.GetDispatch().vkCmdEndQuery(command_buffer, m_feedback_query_pool, slot_index);
+
+		VkVideoEndCodingInfoKHR endCodingInfo{ .sType = VK_STRUCTURE_TYPE_VIDEO_END_CODING_INFO_KHR };
+		m_context->m_cmd_end_video_coding(command_buffer, &endCodingInfo);
+
+		command_buffer.QueueBarrier(VkBufferMemoryBarrier2
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_VIDEO_ENCODE_BIT_KHR,
+				.srcAccessMask = VK_ACCESS_2_VIDEO_ENCODE_WRITE_BIT_KHR,
+				.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+				.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = *slot.bitstream,
+				.offset = 0,
+				.size = VK_WHOLE_SIZE
+			});
+
+		slot.is_key_frame = isIdr;
+		m_reference = Reference{ .dpb_slot = setupDpbSlot, .frame_num = frameNum, .pic_order_cnt = picOrderCnt, .is_idr = isIdr };
+		++m_frame_num;
+	}
+
+}} // namespace Albedo::RHI
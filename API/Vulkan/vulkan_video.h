@@ -0,0 +1,154 @@
+#pragma once
+
+#include "vulkan_memory.h"
+
+#include <deque>
+#include <future>
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+	class ComputePipeline;
+
+	// Video Encoder (VulkanContext::IsVideoEncodeSupported()): Streams rendered frames as an H.264 elementary stream without CPU pixel copies.
+	// EncodeCommand() converts the source (e.g. the offscreen or swap chain image) into an NV12 picture by a compute shader in the recording
+	// command buffer, Submit() encodes the converted pictures on the video encode queue once that command buffer was submitted, and the
+	// bitstream of each frame lands in a ring of host-cached buffers. Chunks are resolved by Poll() like ReadbackEngine results.
+	// Low-latency IPPP stream: One reference picture, an IDR picture every gop_length frames (Or RequestKeyFrame()), no B-frames.
+	// Not thread-safe: Record, submit and poll it from one thread (Chunks can be released anywhere).
+	class VideoEncoder
+	{
+	public:
+		struct Config
+		{
+			VkExtent2D extent;								// Even width & height (Padded to whole macroblocks and cropped by the SPS)
+			uint32_t frame_rate = 60;
+			uint32_t bitrate = 8'000'000;					// Bits per second (CBR if supported, otherwise VBR)
+			uint32_t gop_length = 60;						// Frames per IDR period
+			uint32_t ring_size = 4;							// Frames in flight between EncodeCommand() and the release of their chunks
+			VkDeviceSize bitstream_capacity = 0;	// Per frame (0: width * height bytes)
+		};
+
+		// Encoded frame in mapped bitstream memory (The ring slot is reused once every copy of the chunk is released)
+		class Chunk
+		{
+			friend class VideoEncoder;
+		public:
+			std::span<const std::byte> GetData() const { return { m_data, static_cast<size_t>(m_size) }; } // NAL units (Annex B)
+			uint64_t GetFrameIndex() const { return m_frame_index; }
+			bool IsKeyFrame() const { return m_is_key_frame; } // IDR (Send GetParameterSets() before it)
+
+		private:
+			std::shared_ptr<VMA::Buffer> m_buffer;
+			const std::byte* m_data = nullptr;
+			VkDeviceSize m_size = 0;
+			uint64_t m_frame_index = 0;
+			bool m_is_key_frame = false;
+		};
+		using Future = std::future<Chunk>;
+
+		// Set 0 of the convert pipeline: binding 0 - source (Sampled image read by texelFetch, sRGB formats read linear values),
+		// binding 1 - luma plane (Storage image, r8), binding 2 - chroma plane (Storage image, rg8 at half resolution, Cb in r),
+		// push constant: ConvertPushConstants. Invocation (x, y) converts the 2x2 block at (2x, 2y) with the BT.709 limited range matrix
+		// and reads the source clamped to extent, dispatched with 8x8x1 work groups over half the coded extent.
+		struct ConvertPushConstants
+		{
+			VkExtent2D extent;			// Of the source region (Config::extent)
+			VkExtent2D coded_extent;	// Of the luma plane
+		};
+		// Returns no future if the frame is dropped because every ring slot is in flight or held (Backpressure, the stream stays valid).
+		// The source is left as a compute shader read.
+		std::optional<Future> EncodeCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VMA::Image& source);
+		// Current swap chain image in PRESENT_SRC_KHR (Needs SAMPLED in m_swapchain_image_usage), record it after the last pass
+		std::optional<Future> EncodeCommand(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline);
+		// Encode the pictures converted so far, after their command buffer was submitted (Waits its queue timeline tick on the GPU),
+		// e.g. Submit(frame.command_buffer->GetSubmittedQueueTimeline(), frame.submitted_tick) after FrameContext::EndFrame()
+		void Submit(QueueTimeline& converted_queue_timeline, uint64_t converted_tick);
+		// Resolve the chunks of completed encodes (e.g. once per frame on the streaming thread), returns the number of resolved chunks
+		uint32_t Poll();
+		void RequestKeyFrame() { m_force_key_frame = true; } // e.g. A client joined or lost packets
+
+		std::span<const std::byte> GetParameterSets() const { return m_parameter_sets; } // SPS & PPS NAL units (Annex B)
+		VkExtent2D GetCodedExtent() const { return m_coded_extent; }
+		uint64_t GetEncodedFrameCount() const { return m_frame_count; }
+		uint64_t GetDroppedFrameCount() const { return m_dropped_frame_count; }
+
+	public:
+		VideoEncoder() = delete;
+		VideoEncoder(std::shared_ptr<VulkanContext> vulkan_context, const Config& config); // Throws if the device cannot encode it
+		~VideoEncoder(); // Wait the encodes in flight (Unresolved chunks are broken, std::future_error)
+		VideoEncoder(const VideoEncoder&) = delete;
+
+	private:
+		enum class SlotState { FREE, CONVERTED, ENCODING };
+		struct Slot
+		{
+			SlotState state = SlotState::FREE;
+			std::shared_ptr<VMA::Image> picture;				// NV12 input of the encoder
+			std::shared_ptr<VMA::Image> luma, chroma;		// Conversion targets copied into the picture (No storage views of the picture)
+			VkImageView picture_view = VK_NULL_HANDLE;	// VIDEO_ENCODE_SRC
+			VkImageView luma_view = VK_NULL_HANDLE;		// STORAGE
+			VkImageView chroma_view = VK_NULL_HANDLE;
+			std::shared_ptr<VMA::Buffer> bitstream;		// Free if only the slot holds it
+			std::promise<Chunk> promise;
+			uint64_t frame_index = 0;
+			bool is_key_frame = false;
+			QueueTimeline* encode_timeline = nullptr;
+			uint64_t encode_tick = 0;
+			uint32_t converted_queue_family = 0;
+		};
+		// Reconstructed picture of the last frame (The only reference of a P-frame)
+		struct Reference
+		{
+			uint32_t dpb_slot = 0;
+			uint32_t frame_num = 0;
+			int32_t pic_order_cnt = 0;
+			bool is_idr = false;
+		};
+
+		void create_session();
+		void create_slots();
+		void release(); // Also on a failed construction
+		VkImageView create_view(VkImage image, VkFormat format, VkImageAspectFlags aspect, VkImageUsageFlags usage, uint32_t array_layer = 0);
+		std::optional<uint32_t> acquire_slot(); // std::nullopt: Drop the frame
+		Future convert_command(CommandBuffer& command_buffer, ComputePipeline& convert_pipeline, VkImageView source_view, uint32_t slot_index);
+		void encode_command(CommandBuffer& command_buffer, Slot& slot, uint32_t slot_index);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		Config m_config;
+		VkExtent2D m_coded_extent{};
+		bool m_is_direct_conversion = false; // Storage views of the picture planes (Otherwise converted into luma & chroma and copied)
+
+		// Profile (Referenced by every video resource)
+		VkVideoEncodeUsageInfoKHR m_usage_info{ .sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_USAGE_INFO_KHR };
+		VkVideoEncodeH264ProfileInfoKHR m_h264_profile{ .sType = VK_STRUCTURE_TYPE_VIDEO_ENCODE_H264_PROFILE_INFO_KHR };
+		VkVideoProfileInfoKHR m_profile{ .sType = VK_STRUCTURE_TYPE_VIDEO_PROFILE_INFO_KHR };
+		VkVideoProfileListInfoKHR m_profile_list{ .sType = VK_STRUCTURE_TYPE_VIDEO_PROFILE_LIST_INFO_KHR };
+		VkVideoEncodeRateControlModeFlagBitsKHR m_rate_control_mode = VK_VIDEO_ENCODE_RATE_CONTROL_MODE_DEFAULT_KHR;
+		VkDeviceSize m_bitstream_alignment = 1;
+
+		VkVideoSessionKHR m_session = VK_NULL_HANDLE;
+		VkVideoSessionParametersKHR m_session_parameters = VK_NULL_HANDLE;
+		std::vector<VmaAllocation> m_session_memory;
+		std::vector<std::byte> m_parameter_sets;
+		std::shared_ptr<VMA::Image> m_dpb;								// Two layers, reconstructed pictures alternate between them
+		std::array<VkImageView, 2> m_dpb_views{};
+		VkQueryPool m_feedback_query_pool = VK_NULL_HANDLE;	// One encode feedback query per slot
+		std::vector<VkImageView> m_owned_views;					// Plane & DPB layer views (create_view())
+		bool m_is_session_reset = false;
+
+		std::vector<Slot> m_slots;
+		std::deque<uint32_t> m_converted_slots;	// In conversion order
+		std::deque<uint32_t> m_encoding_slots;		// In submission order
+		uint32_t m_next_slot = 0;
+		std::optional<Reference> m_reference;
+		uint64_t m_frame_count = 0;
+		uint64_t m_dropped_frame_count = 0;
+		uint32_t m_idr_count = 0;
+		uint32_t m_frame_num = 0; // Since the last IDR picture
+		bool m_force_key_frame = false;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,184 @@
+#include "vulkan_window.h"
+#include "vulkan_context.h"
+
+namespace Albedo {
+namespace RHI
+{
+	WindowSwapChain::WindowSwapChain(std::shared_ptr<VulkanContext> vulkan_context, GLFWwindow* window) :
+		m_context{ std::move(vulkan_context) },
+		m_window{ window }
+	{
+		assert(m_window != nullptr && "Invalid window!");
+		if (glfwCreateWindowSurface(
+			m_context->m_instance,
+			m_window,
+			m_context->m_memory_allocation_callback,
+			&m_surface) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Window Surface!");
+
+		// Presented by the present queue of the context (One vkQueuePresentKHR for every window)
+		VkBool32 presentSupport = VK_FALSE;
+		vkGetPhysicalDeviceSurfaceSupportKHR(m_context->m_physical_device, m_context->m_device_queue_family_present.value(), m_surface, &presentSupport);
+		try
+		{
+			if (!presentSupport) throw std::runtime_error("Failed to create the Window Swap Chain - The present queue cannot present to the window!");
+			Recreate();
+		}
+		catch (...)
+		{
+			vkDestroySurfaceKHR(m_context->m_instance, m_surface, m_context->m_memory_allocation_callback);
+			throw;
+		}
+	}
+
+	WindowSwapChain::~WindowSwapChain()
+	{
+		retire();
+		// After the swap chain (Deleters run in order)
+		m_context->DeferDeletion([context = m_context.get(), surface = m_surface]()
+			{ vkDestroySurfaceKHR(context->m_instance, surface, context->m_memory_allocation_callback); });
+	}
+
+	void WindowSwapChain::Recreate()
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::WindowSwapChain::Recreate");
+		const auto& physicalDevice = m_context->m_physical_device;
+		m_is_acquired = false;
+		m_is_out_of_date = true; // Until a swap chain of the current extent exists
+
+		// The image format of the main swap chain (Its pipelines render into every window)
+		uint32_t formatCount = 0;
+		vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, nullptr);
+		std::vector<VkSurfaceFormatKHR> surfaceFormats(formatCount);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, surfaceFormats.data());
+		if (std::none_of(surfaceFormats.begin(), surfaceFormats.end(), [this](const VkSurfaceFormatKHR& surface_format)
+			{ return surface_format.format == m_context->m_swapchain_image_format && surface_format.colorSpace == m_context->m_swapchain_color_space; }))
+			throw std::runtime_error("Failed to create the Window Swap Chain - Image format is not supported!");
+		m_format = m_context->m_swapchain_image_format;
+
+		uint32_t presentModeCount = 0;
+		vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_surface, &presentModeCount, nullptr);
+		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_surface, &presentModeCount, presentModes.data());
+		m_present_mode = VK_PRESENT_MODE_FIFO_KHR; // Always supported
+		for (auto present_mode : m_context->m_swapchain_config.present_modes) // The first supported mode in the fallback chain
+		{
+			if (std::find(presentModes.begin(), presentModes.end(), present_mode) == presentModes.end()) continue;
+			m_present_mode = present_mode;
+			break;
+		}
+
+		VkSurfaceCapabilitiesKHR surfaceCapabilities{};
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, m_surface, &surfaceCapabilities);
+		VkExtent2D extent = surfaceCapabilities.currentExtent;
+		if (extent.width == std::numeric_limits<uint32_t>::max()) // Decided by the window manager
+		{
+			int width, height;
+			glfwGetFramebufferSize(m_window, &width, &height);
+			extent = VkExtent2D
+			{
+				.width = std::clamp(static_cast<uint32_t>(std::max(width, 0)), surfaceCapabilities.minImageExtent.width, surfaceCapabilities.maxImageExtent.width),
+				.height = std::clamp(static_cast<uint32_t>(std::max(height, 0)), surfaceCapabilities.minImageExtent.height, surfaceCapabilities.maxImageExtent.height)
+			};
+		}
+		// Minimized: Skipped by the acquisitions until it has an area again (The other windows keep presenting, unlike glfwWaitEvents())
+		if (extent.width == 0 || extent.height == 0) return;
+
+		uint32_t imageCount = surfaceCapabilities.minImageCount + m_context->m_swapchain_config.extra_image_count;
+		if (surfaceCapabilities.maxImageCount != 0) // 0 means no limits
+			imageCount = std::clamp(imageCount, surfaceCapabilities.minImageCount, surfaceCapabilities.maxImageCount);
+		VkSwapchainCreateInfoKHR swapChainCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+			.surface = m_surface,
+			.minImageCount = imageCount,
+			.imageFormat = m_format,
+			.imageColorSpace = m_context->m_swapchain_color_space,
+			.imageExtent = extent,
+			.imageArrayLayers = 1,
+			.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, // e.g. Blits of a shared scene
+			.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE, // Ditto (See VulkanContext::create_swap_chain())
+			.preTransform = surfaceCapabilities.currentTransform,
+			.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+			.presentMode = m_present_mode,
+			.clipped = VK_TRUE,
+			.oldSwapchain = m_swapchain
+		};
+		// Presented with the present mode of each swap chain once the main one switches modes per present (Maintenance1)
+		const VkSwapchainPresentModesCreateInfoEXT presentModesCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODES_CREATE_INFO_EXT,
+			.presentModeCount = 1,
+			.pPresentModes = &m_present_mode
+		};
+		if (m_context->IsSwapchainMaintenance1Supported()) swapChainCreateInfo.pNext = &presentModesCreateInfo;
+		VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+		if (vkCreateSwapchainKHR(m_context->m_device, &swapChainCreateInfo, m_context->m_memory_allocation_callback, &swapchain) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Window Swap Chain!");
+		retire(); // Images of the old swap chain may still be used by frames in flight
+		m_swapchain = swapchain;
+		m_extent = extent;
+		++m_generation;
+
+		vkGetSwapchainImagesKHR(m_context->m_device, m_swapchain, &imageCount, nullptr);
+		m_images.resize(imageCount);
+		vkGetSwapchainImagesKHR(m_context->m_device, m_swapchain, &imageCount, m_images.data());
+		for (auto image : m_images)
+		{
+			VkImageViewCreateInfo imageViewCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image = image,
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,
+				.format = m_format,
+				.subresourceRange{.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+													.baseMipLevel = 0,
+													.levelCount = 1,
+													.baseArrayLayer = 0,
+													.layerCount = 1}
+			};
+			VkImageView imageView = VK_NULL_HANDLE;
+			if (vkCreateImageView(m_context->m_device, &imageViewCreateInfo, m_context->m_memory_allocation_callback, &imageView) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the image views of the Vulkan Window Swap Chain!");
+			m_imageviews.emplace_back(imageView);
+		}
+
+		if (m_context->m_device_queue_family_graphics != m_context->m_device_queue_family_present)
+			m_present_ownership_transfer = m_context->create_present_ownership_transfer(m_images);
+		m_is_out_of_date = false;
+	}
+
+	void WindowSwapChain::retire()
+	{
+		if (m_swapchain == VK_NULL_HANDLE) return;
+		std::optional<PresentOwnershipTransfer> transfer;
+		std::swap(transfer, m_present_ownership_transfer); // Its command buffers may be pending in frames in flight
+		m_context->DeferDeletion([context = m_context.get(), swapchain = m_swapchain, imageviews = std::move(m_imageviews),
+			transfer = std::move(transfer)]()
+			{
+				for (auto imageview : imageviews)
+					vkDestroyImageView(context->m_device, imageview, context->m_memory_allocation_callback);
+				vkDestroySwapchainKHR(context->m_device, swapchain, context->m_memory_allocation_callback);
+				if (transfer) context->destroy_present_ownership_transfer(*transfer);
+			});
+		m_swapchain = VK_NULL_HANDLE;
+		m_imageviews.clear();
+		m_images.clear();
+	}
+
+	bool WindowSwapChain::acquire(VkSemaphore semaphore, uint64_t timeout)
+	{
+		m_is_acquired = false;
+		if (m_is_out_of_date) return false; // Still minimized
+		auto result = m_context->m_dispatch.vkAcquireNextImageKHR(m_context->m_device, m_swapchain, timeout, semaphore, VK_NULL_HANDLE, &m_image_index);
+		switch (result)
+		{
+		case VK_SUBOPTIMAL_KHR: m_is_out_of_date = true; [[fallthrough]]; // Acquired (The semaphore is signaled), recreated after its present
+		case VK_SUCCESS: m_is_acquired = true; return true;
+		case VK_ERROR_OUT_OF_DATE_KHR: m_is_out_of_date = true; return false;
+		case VK_TIMEOUT: case VK_NOT_READY: return false; // Skip this window for a frame
+		default: throw std::runtime_error("Failed to retrive the next image of the Vulkan Window Swap Chain!");
+		}
+	}
+
+}} // namespace Albedo::RHI
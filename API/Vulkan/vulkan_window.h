@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vulkan_wrapper.h"
+
+struct GLFWwindow;
+
+namespace Albedo {
+namespace RHI
+{
+	class VulkanContext;
+
+	// Queue family ownership transfer of exclusive swap chain images (Distinct graphics & present families, recreated with the swap chain)
+	struct PresentOwnershipTransfer
+	{
+		VkCommandPool release_command_pool = VK_NULL_HANDLE; // Graphics family
+		VkCommandPool acquire_command_pool = VK_NULL_HANDLE; // Present family
+		std::vector<VkCommandBuffer> release_commands; // Pre-recorded, one per swap chain image
+		std::vector<VkCommandBuffer> acquire_commands;
+		std::vector<VkSemaphore> released_semaphores;
+		std::vector<VkSemaphore> acquired_semaphores; // Waited by the present
+	};
+
+	// Window Swap Chain: An additional window of a windowed context (e.g. one per monitor of a control room), with its own surface and
+	// swap chain in the image format and SwapchainConfig of the context (No depth image, pipelines of the main swap chain render into it).
+	// Acquire the windows with VulkanContext::AcquireSwapChains() and present them with VulkanContext::PresentSwapChains(), which presents
+	// every acquired window and the main swap chain in one vkQueuePresentKHR.
+	// Not thread-safe: Acquire, present and destroy it on the presenting thread.
+	class WindowSwapChain
+	{
+		friend class VulkanContext;
+	public:
+		bool IsAcquired() const { return m_is_acquired; } // Render into it only if acquired (Out-of-date windows skip the frame)
+		VkImage GetImage() const { assert(m_is_acquired); return m_images[m_image_index]; }
+		VkImageView GetImageView() const { assert(m_is_acquired); return m_imageviews[m_image_index]; }
+		uint32_t GetImageIndex() const { return m_image_index; }
+		uint32_t GetImageCount() const { return static_cast<uint32_t>(m_images.size()); }
+		VkExtent2D GetExtent() const { return m_extent; }
+		VkFormat GetFormat() const { return m_format; }
+		uint64_t GetGeneration() const { return m_generation; } // Increased by every (re)creation
+		GLFWwindow* GetWindow() const { return m_window; }
+		void Recreate(); // Also done by the next acquisition once out of date
+
+	public:
+		WindowSwapChain() = delete;
+		WindowSwapChain(std::shared_ptr<VulkanContext> vulkan_context, GLFWwindow* window); // Throws if the present queue cannot present to it
+		~WindowSwapChain();
+		WindowSwapChain(const WindowSwapChain&) = delete;
+
+	private:
+		void retire(); // Deferred destruction of the current swap chain
+		// Next image (Worker thread of AcquireSwapChains()), returns false if out of date
+		bool acquire(VkSemaphore semaphore, uint64_t timeout);
+
+	private:
+		std::shared_ptr<VulkanContext> m_context;
+		GLFWwindow* const m_window;
+		VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+		VkSwapchainKHR m_swapchain = VK_NULL_HANDLE;
+		VkFormat m_format = VK_FORMAT_UNDEFINED;
+		VkPresentModeKHR m_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+		VkExtent2D m_extent{};
+		std::vector<VkImage> m_images;
+		std::vector<VkImageView> m_imageviews;
+		std::optional<PresentOwnershipTransfer> m_present_ownership_transfer; // Empty: Identical families
+		uint32_t m_image_index = 0;
+		uint64_t m_generation = 0;
+		bool m_is_acquired = false;
+		bool m_is_out_of_date = false;
+	};
+
+}} // namespace Albedo::RHI
@@ -0,0 +1,92 @@
+#include "vulkan_worker.h"
+
+#include <algorithm>
+
+namespace Albedo {
+namespace RHI
+{
+	WorkerPool::WorkerPool(size_t worker_count)
+	{
+		worker_count = std::max<size_t>(1, worker_count);
+		m_deques.reserve(worker_count);
+		for (size_t i = 0; i < worker_count; ++i) m_deques.emplace_back(std::make_unique<JobDeque>());
+		m_workers.reserve(worker_count);
+		for (size_t i = 0; i < worker_count; ++i)
+			m_workers.emplace_back(&WorkerPool::work, this, i);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::scoped_lock guard{ m_sleep_mutex };
+			m_stop = true;
+		}
+		m_condition.notify_all();
+		for (auto& worker : m_workers) worker.join();
+	}
+
+	std::vector<std::thread::id> WorkerPool::GetWorkerThreadIDs() const
+	{
+		std::vector<std::thread::id> threadIDs;
+		threadIDs.reserve(m_workers.size());
+		for (const auto& worker : m_workers) threadIDs.emplace_back(worker.get_id());
+		return threadIDs;
+	}
+
+	void WorkerPool::enqueue(Job job)
+	{
+		size_t target = IsWorkerThread()? s_worker_index : m_next_deque.fetch_add(1, std::memory_order_relaxed) % m_deques.size();
+		{
+			auto& deque = *m_deques[target];
+			std::scoped_lock guard{ deque.mutex };
+			deque.jobs.emplace_back(std::move(job));
+		}
+		m_queued_jobs.fetch_add(1, std::memory_order_release);
+		{
+			std::scoped_lock guard{ m_sleep_mutex }; // Workers check m_queued_jobs under this lock (No lost wake-up)
+		}
+		m_condition.notify_one();
+	}
+
+	bool WorkerPool::run_one()
+	{
+		if (m_queued_jobs.load(std::memory_order_acquire) == 0) return false;
+
+		Job job;
+		const size_t home = IsWorkerThread()? s_worker_index : 0;
+		for (size_t offset = 0; offset < m_deques.size() && !job; ++offset)
+		{
+			auto& deque = *m_deques[(home + offset) % m_deques.size()];
+			std::scoped_lock guard{ deque.mutex };
+			if (deque.jobs.empty()) continue;
+			if (offset == 0 && IsWorkerThread()) // Own jobs: Newest first (Still in cache)
+			{
+				job = std::move(deque.jobs.back());
+				deque.jobs.pop_back();
+			}
+			else // Steal: Oldest first (Usually the largest remaining work)
+			{
+				job = std::move(deque.jobs.front());
+				deque.jobs.pop_front();
+			}
+		}
+		if (!job) return false;
+		m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+		job(); // Exceptions are captured by the packaged task
+		return true;
+	}
+
+	void WorkerPool::work(size_t worker_index)
+	{
+		s_current_pool = this;
+		s_worker_index = worker_index;
+		while (true)
+		{
+			if (run_one()) continue;
+			std::unique_lock lock{ m_sleep_mutex };
+			m_condition.wait(lock, [this]() { return m_stop || m_queued_jobs.load(std::memory_order_acquire) > 0; });
+			if (m_stop && m_queued_jobs.load(std::memory_order_acquire) == 0) return;
+		}
+	}
+
+}} // namespace Albedo::RHI
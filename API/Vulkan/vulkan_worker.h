@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Albedo {
+namespace RHI
+{
+	// Worker Pool (Fixed worker threads shared by the RHI parallel services)
+	// Work-stealing: every worker owns a deque. Jobs submitted by a worker go to its own deque and are run newest first,
+	// jobs submitted by other threads are spread across the deques, and idle workers steal the oldest jobs of the others.
+	// Workers are pre-registered by VulkanContext (Global command pools and descriptor allocators exist before their first job).
+	class WorkerPool
+	{
+	public:
+		template<typename Task>
+		auto Submit(Task&& task) -> std::future<std::invoke_result_t<Task>>
+		{
+			using Result = std::invoke_result_t<Task>;
+			auto job = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+			auto future = job->get_future();
+			enqueue([job]() { (*job)(); });
+			return future;
+		}
+
+		// Runs queued jobs until the future is ready (Jobs may wait for the jobs they submitted without deadlocking the pool)
+		template<typename Result>
+		Result Wait(std::future<Result>& future)
+		{
+			while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				if (!run_one()) std::this_thread::yield();
+			return future.get();
+		}
+
+		size_t GetWorkerCount() const { return m_workers.size(); }
+		bool IsWorkerThread() const { return s_current_pool == this; }
+		std::vector<std::thread::id> GetWorkerThreadIDs() const;
+
+	public:
+		WorkerPool() = delete;
+		WorkerPool(size_t worker_count);
+		~WorkerPool();
+		WorkerPool(const WorkerPool&) = delete;
+
+	private:
+		using Job = std::function<void()>;
+		void enqueue(Job job);
+		bool run_one(); // Own deque first (Newest), then steals (Oldest)
+		void work(size_t worker_index);
+
+	private:
+		struct alignas(64) JobDeque
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+		std::vector<std::unique_ptr<JobDeque>> m_deques; // One per worker
+		std::vector<std::thread> m_workers;
+		std::atomic<size_t> m_next_deque{ 0 }; // Spreads external submissions
+		std::atomic<size_t> m_queued_jobs{ 0 };
+
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_condition;
+		bool m_stop = false;
+
+		static inline thread_local WorkerPool* s_current_pool = nullptr;
+		static inline thread_local size_t s_worker_index = 0;
+	};
+
+}} // namespace Albedo::RHI
@@ -1,13 +1,391 @@
 #include "vulkan_context.h"
 #include "vulkan_wrapper.h"
 
-#include <fstream>
+#include <bit>
 
-#include <spirv_reflect.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <vulkan/vulkan_win32.h>
+#endif
 
 namespace Albedo {
 namespace RHI
 {
+	namespace
+	{
+		// Split [0, draw_count) into ranges recorded by the worker pool into secondary command buffers (Shared by both render pass paths)
+		void record_parallel(VulkanContext& vulkan_context, std::shared_ptr<CommandBuffer> primary_command_buffer,
+			VkCommandBufferInheritanceInfo inheritanceInfo,
+			uint32_t draw_count, const RenderPass::RecordFunction& record, uint32_t range_count)
+		{
+			auto& workerPool = vulkan_context.GetWorkerPool();
+			if (range_count == 0) range_count = static_cast<uint32_t>(workerPool.GetWorkerCount());
+			range_count = std::clamp(range_count, 1u, draw_count);
+
+			auto record_range = [&vulkan_context, &inheritanceInfo, &record](uint32_t first, uint32_t count)
+			{
+				// Secondaries come from the per-thread global pool of the recording thread
+				auto secondaryCommandBuffer = vulkan_context.CreateOneTimeCommandBuffer(vulkan_context.m_device_queue_family_graphics, false);
+				secondaryCommandBuffer->Begin(&inheritanceInfo);
+				record(secondaryCommandBuffer, first, count);
+				secondaryCommandBuffer->End();
+				return secondaryCommandBuffer;
+			};
+
+			std::vector<std::future<std::shared_ptr<CommandBuffer>>> futures;
+			futures.reserve(range_count);
+			for (uint32_t range = 0; range < range_count; ++range)
+			{
+				uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * range / range_count);
+				uint32_t count = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * (range + 1) / range_count) - first;
+				futures.emplace_back(workerPool.Submit([&record_range, first, count]() { return record_range(first, count); }));
+			}
+
+			std::vector<std::shared_ptr<CommandBuffer>> secondaryCommandBuffers;
+			secondaryCommandBuffers.reserve(range_count);
+			std::exception_ptr failure;
+			for (auto& future : futures) // Join all ranges before rethrowing, they reference this frame
+			{
+				try { secondaryCommandBuffers.emplace_back(workerPool.Wait(future)); } // Helps recording (Also from worker threads)
+				catch (...) { if (!failure) failure = std::current_exception(); }
+			}
+			if (failure) std::rethrow_exception(failure);
+
+			primary_command_buffer->ExecuteCommands(secondaryCommandBuffers);
+		}
+
+		// Storage images are written in GENERAL without a sampler, samplers only go with the sampler types (Unless immutable)
+		VkDescriptorImageInfo get_descriptor_image_info(VMA::Image& image, VkDescriptorType image_type, bool is_immutable_sampler)
+		{
+			if (image_type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+				return { .sampler = VK_NULL_HANDLE, .imageView = image.GetImageView(), .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+			const bool hasSampler = !is_immutable_sampler &&
+				(image_type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || image_type == VK_DESCRIPTOR_TYPE_SAMPLER);
+			return
+			{
+				.sampler = hasSampler ? image.GetImageSampler() : VK_NULL_HANDLE, // Asserts a bound sampler
+				.imageView = image.GetSampledImageView(),
+				.imageLayout = image.GetImageLayout()
+			};
+		}
+
+		// Size and component size of the vertex formats (0: Not a vertex format)
+		std::pair<uint32_t, uint32_t> get_vertex_format_size(VkFormat format)
+		{
+			switch (format)
+			{
+			case VK_FORMAT_R8_UNORM: case VK_FORMAT_R8_SNORM: case VK_FORMAT_R8_UINT: case VK_FORMAT_R8_SINT:
+				return { 1, 1 };
+			case VK_FORMAT_R8G8_UNORM: case VK_FORMAT_R8G8_SNORM: case VK_FORMAT_R8G8_UINT: case VK_FORMAT_R8G8_SINT:
+				return { 2, 1 };
+			case VK_FORMAT_R8G8B8_UNORM: case VK_FORMAT_R8G8B8_SNORM: case VK_FORMAT_R8G8B8_UINT: case VK_FORMAT_R8G8B8_SINT:
+				return { 3, 1 };
+			case VK_FORMAT_R8G8B8A8_UNORM: case VK_FORMAT_R8G8B8A8_SNORM: case VK_FORMAT_R8G8B8A8_UINT: case VK_FORMAT_R8G8B8A8_SINT:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+				return { 4, 1 };
+			case VK_FORMAT_A2B10G10R10_UNORM_PACK32: case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+			case VK_FORMAT_A2B10G10R10_UINT_PACK32: case VK_FORMAT_A2B10G10R10_SINT_PACK32:
+				return { 4, 4 };
+			case VK_FORMAT_R16_UNORM: case VK_FORMAT_R16_SNORM: case VK_FORMAT_R16_UINT: case VK_FORMAT_R16_SINT: case VK_FORMAT_R16_SFLOAT:
+				return { 2, 2 };
+			case VK_FORMAT_R16G16_UNORM: case VK_FORMAT_R16G16_SNORM: case VK_FORMAT_R16G16_UINT: case VK_FORMAT_R16G16_SINT: case VK_FORMAT_R16G16_SFLOAT:
+				return { 4, 2 };
+			case VK_FORMAT_R16G16B16_UNORM: case VK_FORMAT_R16G16B16_SNORM: case VK_FORMAT_R16G16B16_UINT: case VK_FORMAT_R16G16B16_SINT: case VK_FORMAT_R16G16B16_SFLOAT:
+				return { 6, 2 };
+			case VK_FORMAT_R16G16B16A16_UNORM: case VK_FORMAT_R16G16B16A16_SNORM: case VK_FORMAT_R16G16B16A16_UINT: case VK_FORMAT_R16G16B16A16_SINT: case VK_FORMAT_R16G16B16A16_SFLOAT:
+				return { 8, 2 };
+			case VK_FORMAT_R32_UINT: case VK_FORMAT_R32_SINT: case VK_FORMAT_R32_SFLOAT:
+				return { 4, 4 };
+			case VK_FORMAT_R32G32_UINT: case VK_FORMAT_R32G32_SINT: case VK_FORMAT_R32G32_SFLOAT:
+				return { 8, 4 };
+			case VK_FORMAT_R32G32B32_UINT: case VK_FORMAT_R32G32B32_SINT: case VK_FORMAT_R32G32B32_SFLOAT:
+				return { 12, 4 };
+			case VK_FORMAT_R32G32B32A32_UINT: case VK_FORMAT_R32G32B32A32_SINT: case VK_FORMAT_R32G32B32A32_SFLOAT:
+				return { 16, 4 };
+			default: return { 0, 0 }; // 64-bit inputs take two locations, declare them in prepare_vertex_input_state()
+			}
+		}
+
+		// Pack the reflected inputs in location order (Vertices are fetched in one stream)
+		void deduce_vertex_input_layout(VulkanContext& vulkan_context, const ShaderReflection& vertex_reflection,
+			const std::unordered_map<uint32_t, VkFormat>& format_overrides, VertexInputLayout& vertex_input_layout)
+		{
+			vertex_input_layout = {};
+			for (const auto& vertex_input : vertex_reflection.vertex_inputs)
+			{
+				auto format = vertex_input.format;
+				if (auto override_format = format_overrides.find(vertex_input.location); override_format != format_overrides.end())
+				{
+					if (!vulkan_context.GetFormatTable().IsBufferSupported(override_format->second, VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT))
+						throw std::runtime_error(std::format("Failed to override the vertex input (location {}) - the format is not a vertex buffer format!", vertex_input.location));
+					format = override_format->second;
+				}
+
+				auto [size, componentSize] = get_vertex_format_size(format);
+				if (size == 0) throw std::runtime_error(std::format("Failed to reflect the vertex input (location {}) - Unsupported format!", vertex_input.location));
+				uint32_t offset = (vertex_input_layout.stride + componentSize - 1) / componentSize * componentSize;
+				vertex_input_layout.attributes.emplace_back(VkVertexInputAttributeDescription
+					{
+						.location = vertex_input.location,
+						.binding = 0,
+						.format = format,
+						.offset = offset
+					});
+				vertex_input_layout.stride = offset + size;
+			}
+			vertex_input_layout.stride = (vertex_input_layout.stride + 3) / 4 * 4;
+		}
+
+		// Layouts are only deduced for the null outputs of prepare_xxx() (Shared by graphics and compute pipelines)
+		void deduce_pipeline_states_from_shaders(VulkanContext& vulkan_context,
+			const std::vector<std::shared_ptr<const ShaderReflection>>& shader_reflections,
+			std::vector<VkDescriptorSetLayout>* descriptor_set_layouts,
+			std::vector<VkPushConstantRange>* push_constants,
+			std::vector<std::shared_ptr<DescriptorSetLayout>>& shared_descriptor_set_layouts,
+			const std::vector<ImmutableSamplerBinding>& immutable_samplers,
+			std::optional<uint32_t> push_descriptor_set,
+			bool descriptor_buffers)
+		{
+			// Reflection records are cached by the shader cache (no SPIR-V reflection on warm starts)
+			ScratchScope scratch;
+			std::pmr::vector<DescriptorBinding> descriptor_set_layout_bindings{ scratch.Resource() };
+			for (const auto& reflection : shader_reflections)
+			{
+				if (descriptor_set_layouts)
+				{
+					for (const auto& binding : reflection->descriptor_bindings)
+					{
+						descriptor_set_layout_bindings.emplace_back(DescriptorBinding
+							{
+								.set = binding.set,
+								.binding = binding.binding,
+								.type = binding.type,
+								.count = binding.count,
+								.stages = static_cast<VkShaderStageFlags>(reflection->stage)
+							});
+					}
+				} // End deduce Descriptor Sets
+
+				if (push_constants)
+				{
+					push_constants->insert(push_constants->end(),
+						reflection->push_constants.begin(), reflection->push_constants.end());
+				} // End deduce Push Constants
+			}
+			// One range of all stages, so the whole block is pushed by one call (See CommandBuffer::Push())
+			if (push_constants && push_constants->size() > 1)
+			{
+				VkPushConstantRange merged{ .offset = std::numeric_limits<uint32_t>::max() };
+				uint32_t end = 0;
+				for (const auto& range : *push_constants)
+				{
+					merged.stageFlags |= range.stageFlags;
+					merged.offset = std::min(merged.offset, range.offset);
+					end = std::max(end, range.offset + range.size);
+				}
+				merged.size = end - merged.offset;
+				*push_constants = { merged };
+			}
+
+			// Final. Create Resource
+			if (descriptor_set_layouts && !descriptor_set_layout_bindings.empty())
+			{
+				if (descriptor_set_layout_bindings.size() > 1)
+					std::sort(descriptor_set_layout_bindings.begin(), descriptor_set_layout_bindings.end(),
+						[](const DescriptorBinding& prev, const DescriptorBinding& next)->bool
+						{
+							if (next.set != prev.set) return next.set < prev.set; // Descending Set Index
+							else return next.binding < prev.binding; // Descending Binding Index
+						});
+
+				size_t max_set = descriptor_set_layout_bindings.front().set + 1;
+				descriptor_set_layouts->resize(max_set);
+				std::vector<std::vector<VkDescriptorSetLayoutBinding>> descriptorSets(max_set);
+
+				for (auto& currentBinding : descriptor_set_layout_bindings)
+				{
+					auto& currentSet = descriptorSets[currentBinding.set];
+					if (currentSet.empty())
+					{
+						currentSet.reserve(currentBinding.binding + 1); // DESC Sorted
+						currentSet.emplace_back(currentBinding);
+					}
+					else
+					{
+						auto& previousBinding = currentSet.back();
+						if (currentBinding.binding == previousBinding.binding)
+						{
+							previousBinding.stageFlags |= currentBinding.stages; // Same binding but different stages.
+						}
+						else currentSet.emplace_back(currentBinding); // Differernt bindings
+					}
+				}
+				// Bake Immutable Samplers (Copied by the layouts)
+				std::vector<std::vector<VkSampler>> immutableSamplers;
+				std::vector<std::vector<std::shared_ptr<Sampler>>> immutableSamplerOwners(max_set);
+				immutableSamplers.reserve(immutable_samplers.size());
+				for (const auto& immutable_sampler : immutable_samplers)
+				{
+					auto& targetSet = descriptorSets[std::min<size_t>(immutable_sampler.set, max_set - 1)];
+					auto targetBinding = std::find_if(targetSet.begin(), targetSet.end(),
+						[&](const VkDescriptorSetLayoutBinding& binding) { return binding.binding == immutable_sampler.binding; });
+					if (immutable_sampler.set >= max_set || targetBinding == targetSet.end())
+						throw std::runtime_error(std::format("Failed to bake the immutable sampler {} - (set {}, binding {}) is not used by the shaders!",
+							immutable_sampler.sampler, immutable_sampler.set, immutable_sampler.binding));
+					if (targetBinding->descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER &&
+						targetBinding->descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+						throw std::runtime_error(std::format("Failed to bake the immutable sampler {} - (set {}, binding {}) is not a sampler!",
+							immutable_sampler.sampler, immutable_sampler.set, immutable_sampler.binding));
+					auto& sampler = immutableSamplerOwners[immutable_sampler.set].emplace_back(vulkan_context.GetImmutableSampler(immutable_sampler.sampler));
+					auto& samplers = immutableSamplers.emplace_back(targetBinding->descriptorCount, *sampler);
+					targetBinding->pImmutableSamplers = samplers.data();
+				}
+				// Validate the Push Descriptor Set (Only one per pipeline layout)
+				if (push_descriptor_set.has_value())
+				{
+					const uint32_t pushSet = push_descriptor_set.value();
+					if (!vulkan_context.IsPushDescriptorSupported())
+						throw std::runtime_error(std::format("Failed to create the push descriptor set {} - VK_KHR_push_descriptor is not supported by this device!", pushSet));
+					if (pushSet >= max_set || descriptorSets[pushSet].empty())
+						throw std::runtime_error(std::format("Failed to create the push descriptor set {} - the set is not used by the shaders!", pushSet));
+					uint32_t pushDescriptorCount = 0;
+					for (const auto& binding : descriptorSets[pushSet])
+					{
+						if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+							binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+							throw std::runtime_error(std::format("Failed to create the push descriptor set {} - binding {} is a dynamic buffer!", pushSet, binding.binding));
+						pushDescriptorCount += binding.descriptorCount;
+					}
+					if (pushDescriptorCount > vulkan_context.m_physical_device_push_descriptor_properties.maxPushDescriptors)
+						throw std::runtime_error(std::format("Failed to create the push descriptor set {} - {} descriptors exceed maxPushDescriptors ({})!",
+							pushSet, pushDescriptorCount, vulkan_context.m_physical_device_push_descriptor_properties.maxPushDescriptors));
+					if (descriptor_buffers && !vulkan_context.m_physical_device_descriptor_buffer_features.descriptorBufferPushDescriptors)
+						throw std::runtime_error(std::format("Failed to create the push descriptor set {} - descriptor buffers cannot push descriptors on this device!", pushSet));
+				}
+				// Validate the Descriptor Buffer Sets (Dynamic offsets do not exist, bind another set offset instead)
+				for (size_t current_set = 0; descriptor_buffers && current_set < max_set; ++current_set)
+				{
+					for (const auto& binding : descriptorSets[current_set])
+					{
+						if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+							binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+							throw std::runtime_error(std::format("Failed to create the descriptor buffer set {} - binding {} is a dynamic buffer!", current_set, binding.binding));
+					}
+				}
+				// Create (or reuse) Descriptor Set Layouts
+				shared_descriptor_set_layouts.resize(max_set);
+				for (size_t current_set = 0; current_set < max_set; ++current_set)
+				{
+					VkDescriptorSetLayoutCreateFlags layoutFlags = descriptor_buffers ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0;
+					if (push_descriptor_set == current_set) layoutFlags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+					shared_descriptor_set_layouts[current_set] = vulkan_context.CreateDescripotrSetLayout(std::move(descriptorSets[current_set]),
+						std::move(immutableSamplerOwners[current_set]),
+						layoutFlags);
+					(*descriptor_set_layouts)[current_set] = *shared_descriptor_set_layouts[current_set];
+				}
+			} // End create Descriptor Set Layouts
+		
+			if (push_constants && !push_constants->empty())
+			{
+				if (push_constants->size() > 1)
+					std::sort(push_constants->begin(), push_constants->end(),
+						[](const VkPushConstantRange& next, const VkPushConstantRange& prev)->bool
+						{
+							if (next.offset == prev.offset) return next.size < prev.size; // Descending Range Size
+							else return next.offset < prev.offset; // Descending Range Offset
+						});
+
+				std::vector<VkPushConstantRange> pushConstants{ push_constants->front() };
+				for (size_t i = 1; i < push_constants->size(); ++i)
+				{
+					auto& prevPushConstant = (*push_constants)[i - 1];
+					auto& curPushConstant = (*push_constants)[i];
+					if (curPushConstant.offset == prevPushConstant.offset &&
+						curPushConstant.size == prevPushConstant.size)
+					{
+						prevPushConstant.stageFlags |= curPushConstant.stageFlags; // Same PushConstant but different stages.
+					}
+					else pushConstants.emplace_back(curPushConstant); // Differernt PushConstants
+				}
+				push_constants->swap(pushConstants);
+			} // End arrange Descriptor Set Layouts
+
+		}
+
+		// Chained into a pipeline create info (Core since Vulkan 1.3, skipped by older devices), reported once the pipeline is created
+		class CreationFeedbackChain
+		{
+		public:
+			CreationFeedbackChain(const VulkanContext& vulkan_context, uint32_t stage_count, const void* next) :
+				m_stages(stage_count),
+				m_create_info
+				{
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+					.pNext = next,
+					.pPipelineCreationFeedback = &m_pipeline,
+					.pipelineStageCreationFeedbackCount = stage_count,
+					.pPipelineStageCreationFeedbacks = stage_count? m_stages.data() : nullptr
+				},
+				m_supported{ vulkan_context.m_physical_device_properties.apiVersion >= VK_API_VERSION_1_3 } {}
+			CreationFeedbackChain(const CreationFeedbackChain&) = delete;
+
+			const void* Chain() const { return m_supported? &m_create_info : m_create_info.pNext; }
+
+			// stages: Of the create info (Same count)
+			PipelineCreationFeedback Report(VulkanContext& vulkan_context, const VkPipelineShaderStageCreateInfo* stages, const char* name) const
+			{
+				PipelineCreationFeedback feedback{ .valid = m_supported && (m_pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) };
+				if (!feedback.valid) return feedback;
+				feedback.duration_ns = m_pipeline.duration;
+				feedback.cache_hit = m_pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT;
+
+				std::string stageDurations;
+				feedback.stages.reserve(m_stages.size());
+				for (size_t index = 0; index < m_stages.size(); ++index)
+				{
+					const auto& stage = m_stages[index];
+					auto& stageFeedback = feedback.stages.emplace_back(PipelineCreationFeedback::Stage{ .stage = stages[index].stage });
+					stageFeedback.valid = stage.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT;
+					if (!stageFeedback.valid) continue;
+					stageFeedback.duration_ns = stage.duration;
+					stageFeedback.cache_hit = stage.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT;
+					stageDurations += std::format(", stage {:#x} {:.2f} ms", static_cast<uint32_t>(stageFeedback.stage), stage.duration * 1e-6);
+				}
+
+				auto& statistics = vulkan_context.GetStatistics();
+				statistics.Add(RHIStatistics::PIPELINES_CREATED);
+				statistics.Add(RHIStatistics::PIPELINE_CREATION_NS, feedback.duration_ns);
+				if (feedback.cache_hit)
+				{
+					statistics.Add(RHIStatistics::PIPELINE_CACHE_HITS);
+					log::debug("{} hit the pipeline cache ({:.2f} ms)", name, feedback.duration_ns * 1e-6);
+				}
+				else log::info("{} missed the pipeline cache ({:.2f} ms{})", name, feedback.duration_ns * 1e-6, stageDurations);
+				return feedback;
+			}
+
+		private:
+			VkPipelineCreationFeedback m_pipeline{};
+			std::vector<VkPipelineCreationFeedback> m_stages;
+			VkPipelineCreationFeedbackCreateInfo m_create_info;
+			bool m_supported;
+		};
+
+		// Counts the waits for another thread (e.g. a worker acquiring while the main thread recycles its command buffers)
+		std::unique_lock<std::mutex> lock_counting_contention(std::mutex& mutex, RHIStatistics& statistics)
+		{
+			std::unique_lock guard{ mutex, std::try_to_lock };
+			if (!guard.owns_lock())
+			{
+				statistics.Add(RHIStatistics::COMMAND_POOL_CONTENTIONS);
+				guard.lock();
+			}
+			return guard;
+		}
+	} // namespace
+
 	RenderPass::RenderPass(std::shared_ptr<RHI::VulkanContext> vulkan_context):
 		m_context{ std::move(vulkan_context) }
 	{
@@ -52,931 +430,4076 @@ namespace RHI
 			&m_render_pass) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create the Vulkan Render Pass!");
 
-		create_framebuffers();
+		m_imageless_attachments = set_imageless_attachments();
+		if (!m_imageless_attachments.empty())
+		{
+			if (!m_context->IsImagelessFramebufferSupported())
+				throw std::runtime_error("Failed to initialize the Render Pass - Imageless framebuffers are not supported by this device!");
+			create_imageless_framebuffer();
+		}
+		else create_framebuffers();
+		m_swapchain_generation = m_context->m_swapchain_generation;
+		prepare_begin_infos();
 		create_pipelines();
 	}
 
-	void RenderPass::Begin(std::shared_ptr<CommandBuffer> command_buffer)
+	void RenderPass::RecreateFramebuffers()
 	{
-		assert(command_buffer->IsRecording() && "You must Begin() the command buffer before Begin() the render pass!");
+		m_context->DeferDeletion([context = m_context.get(), framebuffers = std::move(m_framebuffers)]() // Owned by the context
+			{
+				for (auto& frame_buffer : framebuffers)
+					vkDestroyFramebuffer(context->m_device, frame_buffer, context->m_memory_allocation_callback);
+			});
+		m_framebuffers.clear();
+		if (!m_imageless_attachments.empty()) create_imageless_framebuffer();
+		else create_framebuffers();
+		m_swapchain_generation = m_context->m_swapchain_generation;
+		prepare_begin_infos(); // New framebuffers and render area
+	}
+
+	void RenderPass::create_imageless_framebuffer()
+	{
+		const VkRect2D renderArea = set_render_area();
+		m_imageless_extent =
+		{
+			.width = renderArea.offset.x + renderArea.extent.width,
+			.height = renderArea.offset.y + renderArea.extent.height
+		};
 
-		static auto clear_color = set_attachment_clear_colors();
-		auto& current_framebuffer = m_framebuffers[m_context->m_swapchain_current_image_index];
-		VkRenderPassBeginInfo renderPassBeginInfo
+		std::vector<VkFramebufferAttachmentImageInfo> attachmentImageInfos;
+		attachmentImageInfos.reserve(m_imageless_attachments.size());
+		for (const auto& attachment : m_imageless_attachments)
+		{
+			attachmentImageInfos.emplace_back(VkFramebufferAttachmentImageInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENT_IMAGE_INFO,
+				.flags = attachment.flags,
+				.usage = attachment.usage,
+				.width = m_imageless_extent.width,
+				.height = m_imageless_extent.height,
+				.layerCount = attachment.layer_count,
+				.viewFormatCount = 1,
+				.pViewFormats = &attachment.format
+			});
+		}
+		VkFramebufferAttachmentsCreateInfo attachmentsCreateInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENTS_CREATE_INFO,
+			.attachmentImageInfoCount = static_cast<uint32_t>(attachmentImageInfos.size()),
+			.pAttachmentImageInfos = attachmentImageInfos.data()
+		};
+		VkFramebufferCreateInfo framebufferCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			.pNext = &attachmentsCreateInfo,
+			.flags = VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT,
 			.renderPass = m_render_pass,
-			.framebuffer = current_framebuffer,
-			.renderArea = set_render_area(),
-			.clearValueCount = static_cast<uint32_t>(clear_color.size()),
-			.pClearValues = clear_color.data()
+			.attachmentCount = static_cast<uint32_t>(attachmentImageInfos.size()),
+			.pAttachments = nullptr,
+			.width = m_imageless_extent.width,
+			.height = m_imageless_extent.height,
+			.layers = 1
 		};
-		VkSubpassContents contents = command_buffer->GetLevel() == VK_COMMAND_BUFFER_LEVEL_PRIMARY? 
-																 VK_SUBPASS_CONTENTS_INLINE : VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS;
-		vkCmdBeginRenderPass(*command_buffer, &renderPassBeginInfo, contents);
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		if (vkCreateFramebuffer(m_context->m_device, &framebufferCreateInfo, m_context->m_memory_allocation_callback, &framebuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the imageless Vulkan Framebuffer!");
+		m_framebuffers.emplace_back(framebuffer);
 	}
 
-	void RenderPass::End(std::shared_ptr<CommandBuffer> command_buffer)
+	void RenderPass::prepare_begin_infos()
 	{
-		assert(command_buffer->IsRecording() && "You must Begin() the command buffer before End() the render pass!");
+		m_clear_values = set_attachment_clear_colors(); // Owned by this instance
+		const VkRect2D renderArea = set_render_area();
+		m_begin_infos.clear();
+		m_begin_infos.reserve(m_framebuffers.size());
+		for (auto framebuffer : m_framebuffers)
+		{
+			m_begin_infos.emplace_back(VkRenderPassBeginInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+				.renderPass = m_render_pass,
+				.framebuffer = framebuffer,
+				.renderArea = renderArea,
+				.clearValueCount = static_cast<uint32_t>(m_clear_values.size()),
+				.pClearValues = m_clear_values.data()
+			});
+		}
+	}
+
+	void RenderPass::Begin(std::shared_ptr<CommandBuffer> command_buffer, bool secondary_contents/* = false*/)
+	{
+		assert(command_buffer->IsRecording() && "You must Begin() the command buffer before Begin() the render pass!");
+		command_buffer->FlushBarriers(); // Barriers are not allowed inside the render pass
+		m_subpass_contents = secondary_contents || command_buffer->GetLevel() != VK_COMMAND_BUFFER_LEVEL_PRIMARY?
+			VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+		m_current_subpass = 0;
+		if (!m_imageless_attachments.empty())
+		{
+			if (m_swapchain_generation != m_context->m_swapchain_generation)
+			{
+				const VkRect2D renderArea = set_render_area();
+				if (renderArea.offset.x + renderArea.extent.width != m_imageless_extent.width ||
+					renderArea.offset.y + renderArea.extent.height != m_imageless_extent.height) RecreateFramebuffers();
+				else m_swapchain_generation = m_context->m_swapchain_generation; // Same extent, the views are passed below
+			}
+
+			auto views = set_attachment_views(m_context->m_swapchain_current_image_index);
+			assert(views.size() == m_imageless_attachments.size() && "One view per imageless attachment is required!");
+			VkRenderPassAttachmentBeginInfo attachmentBeginInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO,
+				.attachmentCount = static_cast<uint32_t>(views.size()),
+				.pAttachments = views.data()
+			};
+			VkRenderPassBeginInfo renderPassBeginInfo = m_begin_infos.front();
+			renderPassBeginInfo.pNext = &attachmentBeginInfo;
+			command_buffer->GetDispatch().vkCmdBeginRenderPass(*command_buffer, &renderPassBeginInfo, m_subpass_contents);
+			return;
+		}
 
-		vkCmdEndRenderPass(*command_buffer);
+		if (m_swapchain_generation != m_context->m_swapchain_generation) RecreateFramebuffers();
+		assert(m_context->m_swapchain_current_image_index < m_begin_infos.size() && "One framebuffer per swap chain image is required!");
+		command_buffer->GetDispatch().vkCmdBeginRenderPass(*command_buffer, &m_begin_infos[m_context->m_swapchain_current_image_index], m_subpass_contents);
 	}
 
-	VkRect2D RenderPass::set_render_area()
-	{ 
-		return { { 0,0 }, m_context->m_swapchain_current_extent };
+	void RenderPass::NextSubpass(CommandBuffer& command_buffer, VkSubpassContents contents/* = VK_SUBPASS_CONTENTS_INLINE*/)
+	{
+		assert(command_buffer.IsRecording() && "You must Begin() the render pass before NextSubpass()!");
+		assert(m_current_subpass + 1 < m_subpass_descriptions.size() && "NextSubpass() is out of the subpasses of the render pass!");
+
+		++m_current_subpass;
+		m_subpass_contents = contents;
+		command_buffer.GetDispatch().vkCmdNextSubpass(command_buffer, contents);
 	}
 
-	GraphicsPipeline::GraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
-		VkRenderPass owner, uint32_t subpass_bind_point,
-		VkPipeline base_pipeline/* = VK_NULL_HANDLE*/, int32_t base_pipeline_index/* = -1*/):
-		m_context{std::move(vulkan_context)},
-		m_owner{owner}, 
-		m_subpass_bind_point { subpass_bind_point },
-		m_base_pipeline { base_pipeline },
-		m_base_pipeline_index { base_pipeline_index }
+	void RenderPass::End(std::shared_ptr<CommandBuffer> command_buffer)
 	{
-		
+		assert(command_buffer->IsRecording() && "You must Begin() the command buffer before End() the render pass!");
+
+		command_buffer->GetDispatch().vkCmdEndRenderPass(*command_buffer);
 	}
 
-	GraphicsPipeline::~GraphicsPipeline()
+	void RenderPass::DrawIndirect(std::shared_ptr<CommandBuffer> command_buffer, IndirectDrawBuffer& indirect_draws)
 	{
-		for (auto& descriptor_set_layout : m_descriptor_set_layouts)
-			vkDestroyDescriptorSetLayout(m_context->m_device, descriptor_set_layout, m_context->m_memory_allocation_callback);
-		vkDestroyPipelineLayout(m_context->m_device, m_pipeline_layout, m_context->m_memory_allocation_callback);
-		vkDestroyPipeline(m_context->m_device, m_pipeline, m_context->m_memory_allocation_callback);
+		assert(command_buffer->IsRecording() && "You must Begin() the render pass before DrawIndirect()!");
+		indirect_draws.DrawCommand(*command_buffer);
 	}
 
-	void GraphicsPipeline::Initialize()
+	void RenderPass::RecordParallel(std::shared_ptr<CommandBuffer> primary_command_buffer, uint32_t subpass,
+		uint32_t draw_count, const RecordFunction& record, uint32_t range_count/* = 0*/)
 	{
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// 1. Create Shader Stages
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// Shaders
-		std::vector<VkPipelineShaderStageCreateInfo> shaderInfos(MAX_SHADER_COUNT);
-		auto shaders = prepare_shader_files();
-		// Vertex Shader
-		std::vector<char> vertex_shader_buffer;
-		shaderInfos[vertex_shader].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shaderInfos[vertex_shader].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		shaderInfos[vertex_shader].module = create_shader_module(shaders[vertex_shader], vertex_shader_buffer);
-		shaderInfos[vertex_shader].pName = "main";
-		// Fragment Shader
-		std::vector<char> fragment_shader_buffer;
-		shaderInfos[fragment_shader].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shaderInfos[fragment_shader].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		shaderInfos[fragment_shader].module = create_shader_module(shaders[fragment_shader], fragment_shader_buffer);
-		shaderInfos[fragment_shader].pName = "main";
-		// --------------------------------------------------------------------------------------------------------------------------------//
+		assert(primary_command_buffer->GetLevel() == VK_COMMAND_BUFFER_LEVEL_PRIMARY && "You must RecordParallel() into a primary command buffer!");
+		assert(primary_command_buffer->IsRecording() && "You must Begin() the render pass before RecordParallel()!");
+		assert(m_subpass_contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS && "You must Begin() the render pass with secondary_contents!");
+		if (draw_count == 0) return;
 
+		VkCommandBufferInheritanceInfo inheritanceInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.renderPass = m_render_pass,
+			.subpass = subpass,
+			.framebuffer = m_imageless_attachments.empty()? m_framebuffers[m_context->m_swapchain_current_image_index] : m_framebuffers.front()
+		};
+		record_parallel(*m_context, std::move(primary_command_buffer), inheritanceInfo, draw_count, record, range_count);
+	}
 
+	VkRect2D RenderPass::set_render_area()
+	{ 
+		return { { 0,0 }, m_context->m_swapchain_current_extent };
+	}
 
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// 2. Create Pipeline Layout
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// Descriptor Set Layouts & Push Constants
-		m_descriptor_set_layouts = prepare_descriptor_layouts();
-		auto push_constant_state = prepare_push_constant_state();
-		deduce_pipeline_states_from_shaders(vertex_shader_buffer, fragment_shader_buffer,
-			(m_descriptor_set_layouts.empty() ? &m_descriptor_set_layouts : nullptr),
-			(push_constant_state.empty() ? &push_constant_state : nullptr));
+	void RenderPass::initialize_graphics_pipelines()
+	{
+		auto futures = m_context->InitializeGraphicsPipelines(m_graphics_pipelines);
+		for (auto& future : futures) future.get(); // Rethrow the first failure
+	}
 
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo
+	VkAttachmentDescription RenderPass::make_multisampled_attachment(VkFormat format, VkSampleCountFlagBits samples, VkImageLayout layout)
+	{
+		return VkAttachmentDescription
 		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-			.setLayoutCount = static_cast<uint32_t>(m_descriptor_set_layouts.size()),
-			.pSetLayouts = m_descriptor_set_layouts.data(),
-			.pushConstantRangeCount = static_cast<uint32_t>(push_constant_state.size()),
-			.pPushConstantRanges = push_constant_state.data()
+			.format = format,
+			.samples = samples,
+			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE, // Resolved before leaving the tile memory
+			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.finalLayout = layout
 		};
+	}
 
-		if (vkCreatePipelineLayout(
-			m_context->m_device,
-			&pipelineLayoutCreateInfo,
-			m_context->m_memory_allocation_callback,
-			&m_pipeline_layout) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Pipeline Layout!");
-		// --------------------------------------------------------------------------------------------------------------------------------//
-
+	VkAttachmentDescription RenderPass::make_resolve_attachment(VkFormat format, VkImageLayout final_layout)
+	{
+		return VkAttachmentDescription
+		{
+			.format = format,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE, // Fully overwritten by the resolve
+			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.finalLayout = final_layout
+		};
+	}
 
+	DynamicRenderPass::DynamicRenderPass(std::shared_ptr<RHI::VulkanContext> vulkan_context):
+		m_context{ std::move(vulkan_context) }
+	{
 
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// 3. Create Graphics Pipeline
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		auto vertex_inpute_state			= prepare_vertex_input_state();
-		auto input_assembly_state		= prepare_input_assembly_state();
-		auto tessellation_state			= prepare_tessellation_state();
-		auto viewport_state					= prepare_viewport_state();
-		auto rasterization_state			= prepare_rasterization_state();
-		auto multisampling_state		= prepare_multisampling_state();
-		auto depth_stencil_state			= prepare_depth_stencil_state();
-		auto color_blend_state			= prepare_color_blend_state();
-		auto dynamic_state					= prepare_dynamic_state();
+	}
 
-		VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo
+	DynamicRenderPass::~DynamicRenderPass()
+	{
+		for (auto& graphics_pipeline : m_graphics_pipelines)
 		{
-			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-			.pNext = nullptr,
-			.flags = 0x0,
+			delete graphics_pipeline;
+		}
+	}
 
-			.stageCount = static_cast<uint32_t>(shaderInfos.size()),
-			.pStages = shaderInfos.data(),
+	void DynamicRenderPass::Initialize()
+	{
+		if (!m_context->m_physical_device_features13.dynamicRendering)
+			throw std::runtime_error("Failed to create the Dynamic Render Pass (dynamicRendering is not supported)!");
+
+		m_rendering_formats = set_rendering_formats();
+		if (m_rendering_formats.shading_rate_attachment && !m_context->IsShadingRateAttachmentSupported())
+			throw std::runtime_error("Failed to create the Dynamic Render Pass (Shading rate attachments are not supported)!");
+		VkImageAspectFlags aspects = m_rendering_formats.color_formats.empty()? 0 : VK_IMAGE_ASPECT_COLOR_BIT;
+		if (m_rendering_formats.depth_format != VK_FORMAT_UNDEFINED) aspects |= VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (m_rendering_formats.stencil_format != VK_FORMAT_UNDEFINED) aspects |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		m_rendering_formats.samples = m_context->ClampSampleCount(m_rendering_formats.samples, aspects); // Same as the MSAA images
+		create_pipelines();
+	}
 
-			.pVertexInputState = &vertex_inpute_state,
-			.pInputAssemblyState = &input_assembly_state,
-			.pTessellationState = &tessellation_state,
-			.pViewportState = &viewport_state,
-			.pRasterizationState = &rasterization_state,
-			.pMultisampleState = &multisampling_state,
-			.pDepthStencilState = &depth_stencil_state,
-			.pColorBlendState = &color_blend_state,
-			.pDynamicState = &dynamic_state,
+	void DynamicRenderPass::Begin(std::shared_ptr<CommandBuffer> command_buffer, bool secondary_contents/* = false*/)
+	{
+		assert(command_buffer->IsRecording() && "You must Begin() the command buffer before Begin() the render pass!");
+		command_buffer->FlushBarriers(); // Barriers are not allowed inside the render pass
 
-			.layout = m_pipeline_layout,
-			.renderPass = m_owner,
-			.subpass = m_subpass_bind_point,
-			.basePipelineHandle = m_base_pipeline,
-			.basePipelineIndex = m_base_pipeline_index
+		auto attachments = set_attachments();
+		assert(attachments.colors.size() == m_rendering_formats.color_formats.size() && "Attachments must match the rendering formats!");
+		VkRenderingInfo renderingInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+			.flags = static_cast<VkRenderingFlags>(secondary_contents? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0),
+			.renderArea = set_render_area(),
+			.layerCount = 1,
+			.viewMask = 0,
+			.colorAttachmentCount = static_cast<uint32_t>(attachments.colors.size()),
+			.pColorAttachments = attachments.colors.data(),
+			.pDepthAttachment = attachments.depth.has_value()? &attachments.depth.value() : nullptr,
+			.pStencilAttachment = attachments.stencil.has_value()? &attachments.stencil.value() : nullptr
 		};
+		assert(attachments.shading_rate.has_value() == m_rendering_formats.shading_rate_attachment && "Attachments must match the rendering formats!");
+		if (attachments.shading_rate.has_value()) renderingInfo.pNext = &attachments.shading_rate.value();
 
-		if (vkCreateGraphicsPipelines(
-			m_context->m_device,
-			m_pipeline_cache,
-			1,
-			&graphicsPipelineCreateInfo,
-			m_context->m_memory_allocation_callback,
-			&m_pipeline) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline!");
-		// --------------------------------------------------------------------------------------------------------------------------------//
-
-
-
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// 4. Free Resource
-		// --------------------------------------------------------------------------------------------------------------------------------//
-		// Shader Modules
-		for (auto& shaderInfo : shaderInfos)
+		// Split-frame rendering: Horizontal bands of the render area for the devices of the mask in order
+		InlineVector<VkRect2D, 4> deviceRenderAreas;
+		VkDeviceGroupRenderPassBeginInfo deviceGroupBeginInfo{ .sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_RENDER_PASS_BEGIN_INFO };
+		if (command_buffer->IsSplitRendering() && m_context->GetDeviceCount() > 1)
 		{
-			vkDestroyShaderModule(m_context->m_device, shaderInfo.module,
-														 m_context->m_memory_allocation_callback);
+			const auto& area = renderingInfo.renderArea;
+			const uint32_t deviceMask = command_buffer->GetDeviceMask() ? command_buffer->GetDeviceMask() : m_context->GetAllDevicesMask();
+			const uint32_t bandCount = static_cast<uint32_t>(std::popcount(deviceMask));
+			uint32_t band = 0;
+			for (uint32_t device = 0; device < m_context->GetDeviceCount(); ++device)
+			{
+				if (!(deviceMask & (1U << device))) { deviceRenderAreas.emplace_back(VkRect2D{ .offset = area.offset }); continue; }
+				const uint32_t top = area.extent.height * band / bandCount, bottom = area.extent.height * ++band / bandCount;
+				deviceRenderAreas.emplace_back(VkRect2D
+					{
+						.offset = { area.offset.x, area.offset.y + static_cast<int32_t>(top) },
+						.extent = { area.extent.width, bottom - top }
+					});
+			}
+			deviceGroupBeginInfo.pNext = renderingInfo.pNext;
+			deviceGroupBeginInfo.deviceMask = deviceMask;
+			deviceGroupBeginInfo.deviceRenderAreaCount = static_cast<uint32_t>(deviceRenderAreas.size());
+			deviceGroupBeginInfo.pDeviceRenderAreas = deviceRenderAreas.data();
+			renderingInfo.pNext = &deviceGroupBeginInfo;
 		}
-		// --------------------------------------------------------------------------------------------------------------------------------//
+		command_buffer->capture(CaptureOpcode::BEGIN_RENDERING, renderingInfo.renderArea, m_rendering_formats.samples,
+			m_rendering_formats.color_formats, m_rendering_formats.depth_format, m_rendering_formats.stencil_format);
+		command_buffer->GetDispatch().vkCmdBeginRendering(*command_buffer, &renderingInfo);
 	}
 
-	std::vector<VkDescriptorSetLayout> GraphicsPipeline::
-		prepare_descriptor_layouts()
+	void DynamicRenderPass::End(std::shared_ptr<CommandBuffer> command_buffer)
 	{
-		return {};
+		assert(command_buffer->IsRecording() && "You must Begin() the command buffer before End() the render pass!");
+
+		command_buffer->capture(CaptureOpcode::END_RENDERING);
+		command_buffer->GetDispatch().vkCmdEndRendering(*command_buffer);
 	}
 
-	std::vector<VkPushConstantRange> GraphicsPipeline::
-		prepare_push_constant_state()
+	void DynamicRenderPass::DrawIndirect(std::shared_ptr<CommandBuffer> command_buffer, IndirectDrawBuffer& indirect_draws)
 	{
-		return {};
+		assert(command_buffer->IsRecording() && "You must Begin() the render pass before DrawIndirect()!");
+		indirect_draws.DrawCommand(*command_buffer);
 	}
 
-	VkPipelineVertexInputStateCreateInfo GraphicsPipeline::
-		prepare_vertex_input_state()
+	void DynamicRenderPass::RecordParallel(std::shared_ptr<CommandBuffer> primary_command_buffer,
+		uint32_t draw_count, const RenderPass::RecordFunction& record, uint32_t range_count/* = 0*/)
 	{
-		return {};
-	}
+		assert(primary_command_buffer->GetLevel() == VK_COMMAND_BUFFER_LEVEL_PRIMARY && "You must RecordParallel() into a primary command buffer!");
+		assert(primary_command_buffer->IsRecording() && "You must Begin() the render pass before RecordParallel()!");
+		if (draw_count == 0) return;
 
-	VkPipelineTessellationStateCreateInfo GraphicsPipeline::
-		prepare_tessellation_state()
-	{
-		
-
-		return VkPipelineTessellationStateCreateInfo
+		VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
-			.patchControlPoints = 0 // Disable
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+			.viewMask = 0,
+			.colorAttachmentCount = static_cast<uint32_t>(m_rendering_formats.color_formats.size()),
+			.pColorAttachmentFormats = m_rendering_formats.color_formats.data(),
+			.depthAttachmentFormat = m_rendering_formats.depth_format,
+			.stencilAttachmentFormat = m_rendering_formats.stencil_format,
+			.rasterizationSamples = m_rendering_formats.samples
 		};
-	}
-
-	VkPipelineMultisampleStateCreateInfo GraphicsPipeline::
-		prepare_multisampling_state()
-	{
-		return VkPipelineMultisampleStateCreateInfo
+		VkCommandBufferInheritanceInfo inheritanceInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-			.sampleShadingEnable = VK_FALSE,
-			.minSampleShading = 1.0f,
-			.pSampleMask = nullptr,
-			.alphaToCoverageEnable = VK_FALSE,
-			.alphaToOneEnable = VK_FALSE
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.pNext = &inheritanceRenderingInfo,
+			.renderPass = VK_NULL_HANDLE
 		};
+		record_parallel(*m_context, std::move(primary_command_buffer), inheritanceInfo, draw_count, record, range_count);
 	}
 
-	VkPipelineDepthStencilStateCreateInfo GraphicsPipeline::
-		prepare_depth_stencil_state()
+	VkRenderingAttachmentInfo DynamicRenderPass::make_resolved_attachment(VkImageView multisampled_view, VkImageView resolve_view, VkImageLayout layout,
+		VkClearValue clear_value, VkResolveModeFlagBits resolve_mode/* = VK_RESOLVE_MODE_AVERAGE_BIT*/)
 	{
-		return VkPipelineDepthStencilStateCreateInfo
+		return VkRenderingAttachmentInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-			.depthTestEnable = VK_FALSE,
-			.depthWriteEnable = VK_FALSE,
-			.depthCompareOp = VK_COMPARE_OP_LESS, // Keep fragments, which has lower depth
-			.depthBoundsTestEnable = VK_FALSE,  // Only keep fragments that fall within the specified depth range.
-			.stencilTestEnable = VK_FALSE,
-			.front = {},
-			.back = {},
-			.minDepthBounds = 0.0,
-			.maxDepthBounds = 1.0
+			.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+			.imageView = multisampled_view,
+			.imageLayout = layout,
+			.resolveMode = resolve_mode,
+			.resolveImageView = resolve_view,
+			.resolveImageLayout = layout,
+			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE, // Resolved before leaving the tile memory
+			.clearValue = clear_value
 		};
 	}
 
-	VkPipelineDynamicStateCreateInfo GraphicsPipeline::
-		prepare_dynamic_state()
-	{
-		return VkPipelineDynamicStateCreateInfo
-		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-			.dynamicStateCount = 0,
-			.pDynamicStates = nullptr
-		};
+	VkRect2D DynamicRenderPass::set_render_area()
+	{ 
+		return { { 0,0 }, m_context->m_swapchain_current_extent };
 	}
 
-	VkShaderModule GraphicsPipeline::create_shader_module(std::string_view shader_file, std::vector<char>& buffer)
+	void DynamicRenderPass::initialize_graphics_pipelines()
 	{
-		// Check Reload
-		VkShaderModule shader_module{};
-
-		// Read File
-		std::ifstream file(shader_file.data(), std::ios::ate | std::ios::binary);
-		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the shader file {}!", shader_file));
-
-		size_t file_size = static_cast<size_t>(file.tellg());
-		buffer.resize(file_size);
-
-		file.seekg(0);
-		file.read(buffer.data(), file_size);
-
-		file.close();
-
-		// Register Shader Module
-		VkShaderModuleCreateInfo shaderModuleCreateInfo
-		{
-			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-			.codeSize = buffer.size(),
-			.pCode = reinterpret_cast<const uint32_t*>(buffer.data())
-		};
-
-		if (vkCreateShaderModule(
-			m_context->m_device,
-			&shaderModuleCreateInfo,
-			m_context->m_memory_allocation_callback,
-			&shader_module) != VK_SUCCESS)
-			throw std::runtime_error(std::format("Failed to create shader module {}!", shader_file));
-
-		return shader_module;
+		auto futures = m_context->InitializeGraphicsPipelines(m_graphics_pipelines);
+		for (auto& future : futures) future.get(); // Rethrow the first failure
 	}
 
-	void GraphicsPipeline::deduce_pipeline_states_from_shaders(
-		std::vector<char>& vertex_shader,
-		std::vector<char>& fragment_shader,
-		std::vector<VkDescriptorSetLayout>* descriptor_set_layouts,
-		std::vector<VkPushConstantRange>* push_constants)
+	namespace
 	{
-		SpvReflectShaderModule spvContext;
-		std::vector<DescriptorBinding> descriptor_set_layout_bindings;
-		uint32_t count = 0;
-		// 1. Vertex Shader
+		// Field-wise serialization of create infos (Struct padding and pNext pointers are skipped)
+		class StateKeyWriter
 		{
-			if (spvReflectCreateShaderModule(vertex_shader.size(), vertex_shader.data(), &spvContext) != SPV_REFLECT_RESULT_SUCCESS)
-				throw std::runtime_error("Failed to reflect vertex shader!");
+		public:
+			template<typename... Ts>
+			StateKeyWriter& Write(const Ts&... values) { (append(values), ...); return *this; }
+			StateKeyWriter& WriteBytes(const void* data, size_t size)
+			{
+				Write(size);
+				auto bytes = static_cast<const uint8_t*>(data);
+				m_key.insert(m_key.end(), bytes, bytes + size);
+				return *this;
+			}
+			std::vector<uint8_t> Take() { return std::move(m_key); }
 
-			if (descriptor_set_layouts)
+		private:
+			template<typename T>
+			void append(const T& value)
 			{
-				if (spvReflectEnumerateDescriptorSets(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to reflect descriptor sets of vertex shader!");
+				static_assert(std::is_scalar_v<T>, "Serialize the fields of the struct instead!");
+				auto bytes = reinterpret_cast<const uint8_t*>(&value);
+				m_key.insert(m_key.end(), bytes, bytes + sizeof(T));
+			}
 
-				std::vector<SpvReflectDescriptorSet*> pDescriptorSets(count);
-				if (spvReflectEnumerateDescriptorSets(&spvContext, &count, pDescriptorSets.data()) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to enumerate descriptor sets of vertex shader!");
+		private:
+			std::vector<uint8_t> m_key;
+		};
 
-				for(const auto& descriptorSets : pDescriptorSets)
+		// Shader modules by their content hash, the layout by its state key, and the render pass by its handle (Compatibility is not introspectable)
+		std::vector<uint8_t> serialize_graphics_pipeline_state(const VkGraphicsPipelineCreateInfo& create_info, const PipelineLayout& pipeline_layout,
+			const std::vector<std::shared_ptr<ShaderModule>>& shader_modules, const VkPipelineRenderingCreateInfo* rendering_info,
+			const VkPipelineFragmentShadingRateStateCreateInfoKHR* shading_rate_state, uint64_t fixed_state_hash)
+		{
+			StateKeyWriter key;
+			key.Write(create_info.flags, create_info.stageCount);
+			for (uint32_t i = 0; i < create_info.stageCount; ++i)
+			{
+				const auto& stage = create_info.pStages[i];
+				auto shaderModule = std::find_if(shader_modules.begin(), shader_modules.end(),
+					[&stage](const auto& shader_module) { return static_cast<VkShaderModule>(*shader_module) == stage.module; });
+				assert(shaderModule != shader_modules.end() && "Shader stages must come from the shader cache!");
+				key.Write(stage.flags, stage.stage, (*shaderModule)->GetHash()).WriteBytes(stage.pName, strlen(stage.pName));
+				key.Write(stage.pSpecializationInfo != nullptr);
+				if (const auto* specialization = stage.pSpecializationInfo)
 				{
-					DescriptorBinding descriptorBinding{ .set = descriptorSets->set, .stages = VK_SHADER_STAGE_VERTEX_BIT };
-
-					log::debug("Set {} Bindings {}", descriptorSets->set, descriptorSets->binding_count);
-					auto& bindings = descriptorSets->bindings;
-					for (uint32_t i = 0; i < descriptorSets->binding_count; ++i)
+					key.Write(specialization->mapEntryCount);
+					for (uint32_t j = 0; j < specialization->mapEntryCount; ++j)
 					{
-						descriptorBinding.binding = bindings[i]->binding;
-						descriptorBinding.count = bindings[i]->count;
-						descriptorBinding.type = static_cast<VkDescriptorType>(bindings[i]->descriptor_type);
-						log::debug("binding {}, name {}, count {}", bindings[i]->binding, bindings[i]->name, bindings[i]->count);
-						descriptor_set_layout_bindings.emplace_back(descriptorBinding);
+						const auto& entry = specialization->pMapEntries[j];
+						key.Write(entry.constantID, entry.offset, entry.size);
 					}
+					key.WriteBytes(specialization->pData, specialization->dataSize);
 				}
-			} // End deduce Descriptor Sets
+			}
 
-			if (push_constants)
+			key.Write(create_info.pVertexInputState != nullptr);
+			if (const auto* state = create_info.pVertexInputState)
 			{
-				if (spvReflectEnumeratePushConstants(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to reflect push constants of vertex shader!");
-
-				std::vector<SpvReflectBlockVariable*> pPushConstants(count);
-				if (spvReflectEnumeratePushConstants(&spvContext, &count, pPushConstants.data()) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to reflect enumerate constants of vertex shader!");
-
-				for(const auto& pushConstant : pPushConstants)
+				key.Write(state->flags, state->vertexBindingDescriptionCount, state->vertexAttributeDescriptionCount);
+				for (uint32_t i = 0; i < state->vertexBindingDescriptionCount; ++i)
 				{
-					log::debug("Push Constant: offset {}, size {}", pushConstant->offset, pushConstant->size);
-					push_constants->emplace_back(
-						VkPushConstantRange
-						{
-							.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-							.offset = pushConstant->offset,
-							.size = pushConstant->size
-						});
+					const auto& binding = state->pVertexBindingDescriptions[i];
+					key.Write(binding.binding, binding.stride, binding.inputRate);
 				}
-			} // End deduce Push Constants
-
-			spvReflectDestroyShaderModule(&spvContext);
-		} // End parse Vertex Shader
-		
+				for (uint32_t i = 0; i < state->vertexAttributeDescriptionCount; ++i)
+				{
+					const auto& attribute = state->pVertexAttributeDescriptions[i];
+					key.Write(attribute.location, attribute.binding, attribute.format, attribute.offset);
+				}
+			}
 
+			// Compile-time states (PipelineDesc) stand for their input assembly, rasterization, depth stencil and blend blocks
+			key.Write(fixed_state_hash);
+			key.Write(create_info.pInputAssemblyState != nullptr);
+			if (const auto* state = create_info.pInputAssemblyState; state && !fixed_state_hash)
+				key.Write(state->flags, state->topology, state->primitiveRestartEnable);
 
-		// 2. Fragment Shader
-		{
-			if (spvReflectCreateShaderModule(fragment_shader.size(), fragment_shader.data(), &spvContext) != SPV_REFLECT_RESULT_SUCCESS)
-				throw std::runtime_error("Failed to reflect fragment shader!");
+			key.Write(create_info.pTessellationState != nullptr);
+			if (const auto* state = create_info.pTessellationState)
+				key.Write(state->flags, state->patchControlPoints);
 
-			if (descriptor_set_layouts)
+			key.Write(create_info.pViewportState != nullptr);
+			if (const auto* state = create_info.pViewportState)
 			{
-				if (spvReflectEnumerateDescriptorSets(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to reflect descriptor sets of fragment shader!");
-
-				std::vector<SpvReflectDescriptorSet*> pDescriptorSets(count);
-				if (spvReflectEnumerateDescriptorSets(&spvContext, &count, pDescriptorSets.data()) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to enumerate descriptor sets of fragment shader!");
-
-				for (const auto& descriptorSets : pDescriptorSets)
+				key.Write(state->flags, state->viewportCount, state->scissorCount);
+				for (uint32_t i = 0; state->pViewports && i < state->viewportCount; ++i)
 				{
-					DescriptorBinding descriptorBinding{ .set = descriptorSets->set, .stages = VK_SHADER_STAGE_FRAGMENT_BIT };
-
-					log::debug("Set {} Bindings {}", descriptorSets->set, descriptorSets->binding_count);
-					auto& bindings = descriptorSets->bindings;
-					for (uint32_t i = 0; i < descriptorSets->binding_count; ++i)
-					{
-						descriptorBinding.binding = bindings[i]->binding;
-						descriptorBinding.count = bindings[i]->count;
-						descriptorBinding.type = static_cast<VkDescriptorType>(bindings[i]->descriptor_type);
-						log::debug("binding {}, name {}, count {}", bindings[i]->binding, bindings[i]->name, bindings[i]->count);
-						descriptor_set_layout_bindings.emplace_back(descriptorBinding);
-					}
+					const auto& viewport = state->pViewports[i];
+					key.Write(viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth);
 				}
-			} // End deduce Descriptor Sets
-
-			if (push_constants)
-			{
-				if (spvReflectEnumeratePushConstants(&spvContext, &count, NULL) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to reflect push constants of vertex shader!");
-
-				std::vector<SpvReflectBlockVariable*> pPushConstants(count);
-				if (spvReflectEnumeratePushConstants(&spvContext, &count, pPushConstants.data()) != SPV_REFLECT_RESULT_SUCCESS)
-					throw std::runtime_error("Failed to reflect enumerate constants of vertex shader!");
-
-				for (const auto& pushConstant : pPushConstants)
+				for (uint32_t i = 0; state->pScissors && i < state->scissorCount; ++i)
 				{
-					log::debug("Push Constant: offset {}, size {}", pushConstant->offset, pushConstant->size);
-					push_constants->emplace_back(
-						VkPushConstantRange
-						{
-							.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-							.offset = pushConstant->offset,
-							.size = pushConstant->size
-						});
+					const auto& scissor = state->pScissors[i];
+					key.Write(scissor.offset.x, scissor.offset.y, scissor.extent.width, scissor.extent.height);
 				}
-			} // End deduce Push Constants
-
-			spvReflectDestroyShaderModule(&spvContext);
-		} // End parse Fragment Shader
-
+			}
 
+			key.Write(create_info.pRasterizationState != nullptr);
+			if (const auto* state = create_info.pRasterizationState; state && !fixed_state_hash)
+				key.Write(state->flags, state->depthClampEnable, state->rasterizerDiscardEnable, state->polygonMode, state->cullMode, state->frontFace,
+					state->depthBiasEnable, state->depthBiasConstantFactor, state->depthBiasClamp, state->depthBiasSlopeFactor, state->lineWidth);
 
-		// Final. Create Resource
-		if (descriptor_set_layouts && !descriptor_set_layout_bindings.empty())
-		{
-			if (descriptor_set_layout_bindings.size() > 1)
-				std::sort(descriptor_set_layout_bindings.begin(), descriptor_set_layout_bindings.end(),
-					[](const DescriptorBinding& prev, const DescriptorBinding& next)->bool
-					{
-						if (next.set != prev.set) return next.set < prev.set; // Descending Set Index
-						else return next.binding < prev.binding; // Descending Binding Index
-					});
+			key.Write(create_info.pMultisampleState != nullptr);
+			if (const auto* state = create_info.pMultisampleState)
+			{
+				key.Write(state->flags, state->rasterizationSamples, state->sampleShadingEnable, state->minSampleShading,
+					state->alphaToCoverageEnable, state->alphaToOneEnable);
+				if (state->pSampleMask) key.WriteBytes(state->pSampleMask, sizeof(VkSampleMask) * ((state->rasterizationSamples + 31) / 32));
+				}
 
-			size_t max_set = descriptor_set_layout_bindings.front().set + 1;
-			descriptor_set_layouts->resize(max_set);
-			std::vector<std::vector<VkDescriptorSetLayoutBinding>> descriptorSets(max_set);
+			key.Write(create_info.pDepthStencilState != nullptr);
+			if (const auto* state = create_info.pDepthStencilState; state && !fixed_state_hash)
+			{
+				key.Write(state->flags, state->depthTestEnable, state->depthWriteEnable, state->depthCompareOp, state->depthBoundsTestEnable,
+					state->stencilTestEnable, state->minDepthBounds, state->maxDepthBounds);
+				for (const auto& stencil : { state->front, state->back })
+					key.Write(stencil.failOp, stencil.passOp, stencil.depthFailOp, stencil.compareOp, stencil.compareMask, stencil.writeMask, stencil.reference);
+			}
 
-			for (auto& currentBinding : descriptor_set_layout_bindings)
+			key.Write(create_info.pColorBlendState != nullptr);
+			if (create_info.pColorBlendState && fixed_state_hash) key.Write(create_info.pColorBlendState->attachmentCount);
+			else if (const auto* state = create_info.pColorBlendState)
 			{
-				auto& currentSet = descriptorSets[currentBinding.set];
-				if (currentSet.empty())
-				{
-					currentSet.reserve(currentBinding.binding + 1); // DESC Sorted
-					currentSet.emplace_back(currentBinding);
-				}
-				else
+				key.Write(state->flags, state->logicOpEnable, state->logicOp, state->attachmentCount);
+				for (uint32_t i = 0; i < state->attachmentCount; ++i)
 				{
-					auto& previousBinding = currentSet.back();
-					if (currentBinding.binding == previousBinding.binding)
-					{
-						previousBinding.stageFlags |= currentBinding.stages; // Same binding but different stages.
-					}
-					else currentSet.emplace_back(currentBinding); // Differernt bindings
+					const auto& attachment = state->pAttachments[i];
+					key.Write(attachment.blendEnable, attachment.srcColorBlendFactor, attachment.dstColorBlendFactor, attachment.colorBlendOp,
+						attachment.srcAlphaBlendFactor, attachment.dstAlphaBlendFactor, attachment.alphaBlendOp, attachment.colorWriteMask);
 				}
+				key.Write(state->blendConstants[0], state->blendConstants[1], state->blendConstants[2], state->blendConstants[3]);
+			}
+
+			key.Write(create_info.pDynamicState != nullptr);
+			if (const auto* state = create_info.pDynamicState)
+			{
+				key.Write(state->flags, state->dynamicStateCount);
+				for (uint32_t i = 0; i < state->dynamicStateCount; ++i) key.Write(state->pDynamicStates[i]);
 			}
-			// Create Descriptor Set Layouts
-			for (size_t current_set = 0; current_set < max_set; ++current_set)
+
+			const auto& layoutKey = pipeline_layout.GetStateKey();
+			key.WriteBytes(layoutKey.data(), layoutKey.size());
+			key.Write(create_info.renderPass, create_info.subpass, create_info.basePipelineHandle, create_info.basePipelineIndex);
+			key.Write(rendering_info != nullptr);
+			if (rendering_info) // Dynamic Rendering
 			{
-				auto& descriptor_set_layout = m_descriptor_set_layouts[current_set];
-				VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo
-				{
-					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-					.bindingCount = static_cast<uint32_t>(descriptorSets[current_set].size()),
-					.pBindings = descriptorSets[current_set].data()
-				};
-				if (vkCreateDescriptorSetLayout(
-					m_context->m_device,
-					&descriptorSetLayoutCreateInfo,
-					m_context->m_memory_allocation_callback,
-					&descriptor_set_layout) != VK_SUCCESS)
-					throw std::runtime_error("Failed to create the Vulkan Desceriptor Set Layout automatically!");
-			}
-		} // End create Descriptor Set Layouts
-		
-		if (push_constants && !push_constants->empty())
+				key.Write(rendering_info->viewMask, rendering_info->colorAttachmentCount, rendering_info->depthAttachmentFormat, rendering_info->stencilAttachmentFormat);
+				for (uint32_t i = 0; i < rendering_info->colorAttachmentCount; ++i) key.Write(rendering_info->pColorAttachmentFormats[i]);
+			}
+			key.Write(shading_rate_state != nullptr);
+			if (shading_rate_state)
+				key.Write(shading_rate_state->fragmentSize.width, shading_rate_state->fragmentSize.height,
+					shading_rate_state->combinerOps[0], shading_rate_state->combinerOps[1]);
+			return key.Take();
+		}
+	} // namespace
+
+	PipelineLayout::PipelineLayout(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges) :
+		m_context{ std::move(vulkan_context) },
+		m_state_key{ Serialize(descriptor_set_layouts, push_constant_ranges) },
+		m_push_constant_ranges{ push_constant_ranges },
+		m_hash{ HashBytes(m_state_key.data(), m_state_key.size()) }
+	{
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo
 		{
-			if (push_constants->size() > 1)
-				std::sort(push_constants->begin(), push_constants->end(),
-					[](const VkPushConstantRange& next, const VkPushConstantRange& prev)->bool
-					{
-						if (next.offset == prev.offset) return next.size < prev.size; // Descending Range Size
-						else return next.offset < prev.offset; // Descending Range Offset
-					});
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = static_cast<uint32_t>(descriptor_set_layouts.size()),
+			.pSetLayouts = descriptor_set_layouts.data(),
+			.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size()),
+			.pPushConstantRanges = push_constant_ranges.data()
+		};
 
-			std::vector<VkPushConstantRange> pushConstants{ push_constants->front() };
-			for (size_t i = 1; i < push_constants->size(); ++i)
+		if (vkCreatePipelineLayout(
+			m_context->m_device,
+			&pipelineLayoutCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_pipeline_layout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Pipeline Layout!");
+
+		// Pushable in one call if every range covers the same bytes (Always true for the reflected layouts)
+		m_push_constant_block.layout = m_pipeline_layout;
+		if (!push_constant_ranges.empty())
+		{
+			const auto& first = push_constant_ranges.front();
+			if (std::all_of(push_constant_ranges.begin(), push_constant_ranges.end(), [&first](const VkPushConstantRange& range)
+				{ return range.offset == first.offset && range.size == first.size; }))
 			{
-				auto& prevPushConstant = (*push_constants)[i - 1];
-				auto& curPushConstant = (*push_constants)[i];
-				if (curPushConstant.offset == prevPushConstant.offset &&
-					curPushConstant.size == prevPushConstant.size)
-				{
-					prevPushConstant.stageFlags |= curPushConstant.stageFlags; // Same PushConstant but different stages.
-				}
-				else pushConstants.emplace_back(curPushConstant); // Differernt PushConstants
+				for (const auto& range : push_constant_ranges) m_push_constant_block.stages |= range.stageFlags;
+				m_push_constant_block.offset = first.offset;
+				m_push_constant_block.size = first.size;
 			}
-			push_constants->swap(pushConstants);
-		} // End arrange Descriptor Set Layouts
+		}
+	}
 
+	PipelineLayout::~PipelineLayout()
+	{
+		vkDestroyPipelineLayout(m_context->m_device, m_pipeline_layout, m_context->m_memory_allocation_callback);
 	}
 
-	CommandBuffer::CommandBuffer(std::shared_ptr<CommandPool> parent, VkCommandBufferLevel level) :
-		m_parent{ std::move(parent) }, m_level{ level }
+	std::vector<uint8_t> PipelineLayout::Serialize(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges)
 	{
-		
+		// Reflected set layouts are deduplicated by content, so their handles identify them
+		StateKeyWriter key;
+		key.Write(descriptor_set_layouts.size());
+		for (auto descriptor_set_layout : descriptor_set_layouts) key.Write(descriptor_set_layout);
+		key.Write(push_constant_ranges.size());
+		for (const auto& push_constant_range : push_constant_ranges)
+			key.Write(push_constant_range.stageFlags, push_constant_range.offset, push_constant_range.size);
+		return key.Take();
 	}
 
-	void CommandBufferReset::Begin(VkCommandBufferInheritanceInfo* inheritanceInfo/* = nullptr*/)
+	PipelineStateObject::PipelineStateObject(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkPipeline pipeline, std::vector<uint8_t> state_key/* = {}*/) :
+		m_context{ std::move(vulkan_context) },
+		m_pipeline{ pipeline },
+		m_state_key{ std::move(state_key) },
+		m_hash{ HashBytes(m_state_key.data(), m_state_key.size()) }
 	{
-		assert(!IsRecording() && "You cannot Begin() a recording Vulkan Command Buffer!");
 
-		vkResetCommandBuffer(command_buffer, 0);
+	}
 
-		VkCommandBufferBeginInfo commandBufferBeginInfo
-		{
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-			.flags = 0,
-			.pInheritanceInfo = inheritanceInfo
-		};
-		if (vkBeginCommandBuffer(command_buffer, &commandBufferBeginInfo) != VK_SUCCESS)
-			throw std::runtime_error("Failed to begin the Vulkan Command Buffer!");
+	PipelineStateObject::~PipelineStateObject()
+	{
+		m_context->InvalidateBakedCommands(m_pipeline);
+		m_context->DeferDeletion([context = m_context.get(), pipeline = m_pipeline]()
+			{ vkDestroyPipeline(context->m_device, pipeline, context->m_memory_allocation_callback); });
+	}
 
-		m_is_recording = true;
+	GraphicsPipeline::GraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		VkRenderPass owner, uint32_t subpass_bind_point,
+		VkPipeline base_pipeline/* = VK_NULL_HANDLE*/, int32_t base_pipeline_index/* = -1*/):
+		m_context{std::move(vulkan_context)},
+		m_pipeline_cache{ m_context->m_pipeline_cache },
+		m_owner{owner}, 
+		m_subpass_bind_point { subpass_bind_point },
+		m_base_pipeline { base_pipeline },
+		m_base_pipeline_index { base_pipeline_index }
+	{
+		
 	}
 
-	void CommandBufferReset::End()
+	GraphicsPipeline::GraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		const RenderingFormats& rendering_formats,
+		VkPipeline base_pipeline/* = VK_NULL_HANDLE*/, int32_t base_pipeline_index/* = -1*/):
+		m_context{std::move(vulkan_context)},
+		m_pipeline_cache{ m_context->m_pipeline_cache },
+		m_base_pipeline { base_pipeline },
+		m_base_pipeline_index { base_pipeline_index },
+		m_rendering_formats { rendering_formats }
 	{
-		assert(IsRecording() && "You cannot End() an idle Vulkan Command Buffer!");
-		if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
-			throw std::runtime_error("Failed to end the Vulkan Command Buffer!");
-		m_is_recording = false;
+		
 	}
 
-	void CommandBufferReset::Submit(
-		bool wait_queue_idle/* = false*/,
-		VkFence fence/* = VK_NULL_HANDLE*/,
-		std::vector<VkSemaphore> wait_semaphores/* = {}*/,
-		std::vector<VkSemaphore> signal_semaphores/* = {}*/,
-		VkPipelineStageFlags which_pipeline_stages_to_wait/* = 0*/,
-		uint32_t target_queue_index/* = 0*/)
+	GraphicsPipeline::~GraphicsPipeline()
 	{
-		VkSubmitInfo submitInfo
+		if (m_hot_reload_enabled) m_context->WatchShaderFiles(this, false);
+		if (m_shared_descriptor_set_layouts.empty()) // Cached layouts will be destroyed by their last owner
 		{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size()),
-			.pWaitSemaphores = wait_semaphores.data(),
-			.pWaitDstStageMask = &which_pipeline_stages_to_wait,
-			.commandBufferCount = 1,
-			.pCommandBuffers = &command_buffer,
-			.signalSemaphoreCount = static_cast<uint32_t>(signal_semaphores.size()),
-			.pSignalSemaphores = signal_semaphores.data()
-		};
-		
-		auto& submit_queue = m_parent->m_submit_queue_family;
-		if (vkQueueSubmit(submit_queue, 1, &submitInfo, fence) != VK_SUCCESS)
-			throw std::runtime_error("Failed to submit the Vulkan Command Buffer!");
-		if (wait_queue_idle) vkQueueWaitIdle(submit_queue);
+			for (auto& descriptor_set_layout : m_descriptor_set_layouts)
+				vkDestroyDescriptorSetLayout(m_context->m_device, descriptor_set_layout, m_context->m_memory_allocation_callback);
+		}
+		for (auto& optimizing_job : m_optimizing_jobs) optimizing_job.wait();
+		// Shared pipelines and layouts will be destroyed by their last owner
 	}
 
-	void CommandBufferOneTime::Begin(VkCommandBufferInheritanceInfo* inheritanceInfo/* = nullptr*/)
+	void GraphicsPipeline::Initialize()
 	{
-		assert(!IsRecording() && "You cannot Begin() a recording Vulkan Command Buffer!");
+		ALBEDO_RHI_TRACE_ZONE("RHI::GraphicsPipeline::Initialize");
 
-		VkCommandBufferBeginInfo commandBufferBeginInfo
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		// 1. Create Shader Stages
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		// Shaders (Stages are reflected from the SPIR-V, e.g. Vertex -> Tessellation -> Geometry -> Fragment or Task -> Mesh -> Fragment)
+		m_shader_program = load_shader_program();
+		// --------------------------------------------------------------------------------------------------------------------------------//
+
+
+
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		// 2. Create Pipeline Layout
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		// Descriptor Set Layouts & Push Constants
+		m_descriptor_set_layouts = prepare_descriptor_layouts();
+		m_reflected_descriptor_layouts = m_descriptor_set_layouts.empty();
+		auto push_constant_state = prepare_push_constant_state();
+		deduce_pipeline_states_from_shaders(*m_context, m_shader_program.reflections, // Merged across all stages
+			(m_descriptor_set_layouts.empty() ? &m_descriptor_set_layouts : nullptr),
+			(push_constant_state.empty() ? &push_constant_state : nullptr),
+			m_shared_descriptor_set_layouts,
+			prepare_immutable_samplers(),
+			prepare_push_descriptor_set(),
+			m_use_descriptor_buffers);
+		m_vertex_input_layout = {};
+		for (const auto& reflection : m_shader_program.reflections)
 		{
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-			.pInheritanceInfo = inheritanceInfo
-		};
-		if (vkBeginCommandBuffer(command_buffer, &commandBufferBeginInfo) != VK_SUCCESS)
-			throw std::runtime_error("Failed to begin the Vulkan Command Buffer!");
+			if (reflection->stage == VK_SHADER_STAGE_VERTEX_BIT)
+				deduce_vertex_input_layout(*m_context, *reflection, prepare_vertex_attribute_formats(), m_vertex_input_layout);
+		}
 
-		m_is_recording = true;
+		m_shared_pipeline_layout = m_context->CreatePipelineLayout(m_descriptor_set_layouts, push_constant_state); // Identical layouts are shared
+		m_pipeline_layout = *m_shared_pipeline_layout;
+		m_push_constant_block = m_shared_pipeline_layout->GetPushConstantBlock();
+		// --------------------------------------------------------------------------------------------------------------------------------//
+
+
+
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		// 3. Create Graphics Pipeline
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		m_default_specialization = prepare_specialization();
+		m_creation_feedback = {};
+		m_shared_pipeline = create_pipeline(m_shader_program, m_default_specialization.GetInfo(), 0, &m_creation_feedback);
+		m_pipeline = *m_shared_pipeline;
+		if constexpr (EnableDebugMarkers)
+			DebugUtils::SetObjectName(m_context->m_device, VK_OBJECT_TYPE_PIPELINE_LAYOUT, m_pipeline_layout, typeid(*this).name());
+		// --------------------------------------------------------------------------------------------------------------------------------//
+		// Shader modules are kept in the shader cache and will be reused by other pipelines
 	}
 
-	void CommandBufferOneTime::End()
+	GraphicsPipeline::ShaderProgram GraphicsPipeline::load_shader_program()
 	{
-		assert(IsRecording() && "You cannot End() an idle Vulkan Command Buffer!");
-		if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
-			throw std::runtime_error("Failed to end the Vulkan Command Buffer!");
-		m_is_recording = false;
+		ShaderProgram shaderProgram{ .files = prepare_shader_files() };
+		auto& shader_cache = m_context->GetShaderCache();
+		shaderProgram.reflections.reserve(shaderProgram.files.size());
+		VkShaderStageFlags pipelineStages = 0;
+		for (const auto& shader : shaderProgram.files)
+		{
+			auto& shaderModule = shaderProgram.modules.emplace_back(create_shader_module(shader));
+			auto& reflection = shaderProgram.reflections.emplace_back(shader_cache.GetShaderReflection(*shaderModule));
+			if (pipelineStages & reflection->stage)
+				throw std::runtime_error(std::format("Failed to create the Vulkan Graphics Pipeline - Duplicate shader stage ({})!", shader));
+			pipelineStages |= reflection->stage;
+			shaderProgram.stage_infos.emplace_back(VkPipelineShaderStageCreateInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					.stage = reflection->stage,
+					.module = *shaderModule,
+					.pName = "main"
+				});
+		}
+		const bool isMeshPipeline = pipelineStages & VK_SHADER_STAGE_MESH_BIT_EXT;
+		if (isMeshPipeline == static_cast<bool>(pipelineStages & VK_SHADER_STAGE_VERTEX_BIT))
+			throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline - Either a vertex or a mesh shader is required!");
+		if (pipelineStages & VK_SHADER_STAGE_COMPUTE_BIT)
+			throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline - Compute shaders belong to ComputePipeline!");
+		if (isMeshPipeline && !m_context->IsMeshShaderSupported())
+			throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline - Mesh shaders are not supported by this device!");
+		if ((pipelineStages & VK_SHADER_STAGE_TASK_BIT_EXT) && !m_context->IsTaskShaderSupported())
+			throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline - Task shaders are not supported by this device!");
+		shaderProgram.stages = pipelineStages;
+		return shaderProgram;
 	}
 
-	void CommandBufferOneTime::Submit(
-		bool wait_queue_idle/* = false*/,
-		VkFence fence/* = VK_NULL_HANDLE*/,
-		std::vector<VkSemaphore> wait_semaphores/* = {}*/,
-		std::vector<VkSemaphore> signal_semaphores/* = {}*/,
-		VkPipelineStageFlags which_pipeline_stages_to_wait/* = 0*/,
-		uint32_t target_queue_index/* = 0*/)
+	void GraphicsPipeline::EnableHotReload()
 	{
-		VkSubmitInfo submitInfo
+		assert(m_pipeline != VK_NULL_HANDLE && "You must Initialize() the pipeline before EnableHotReload()!");
+		if (m_hot_reload_enabled) return;
+		m_context->WatchShaderFiles(this, true);
+		m_hot_reload_enabled = true;
+	}
+
+	void GraphicsPipeline::reload_shader_program()
+	{
+		// Same steps as Initialize(), but the layouts only have to match the current ones
+		auto shaderProgram = std::make_unique<ShaderProgram>(load_shader_program());
+		if (shaderProgram->stages != m_shader_program.stages)
+			throw std::runtime_error("The shader stages changed!");
+
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+		if (!m_reflected_descriptor_layouts) descriptorSetLayouts = m_descriptor_set_layouts; // Provided by prepare_descriptor_layouts()
+		std::vector<std::shared_ptr<DescriptorSetLayout>> sharedDescriptorSetLayouts;
+		auto pushConstantState = prepare_push_constant_state();
+		deduce_pipeline_states_from_shaders(*m_context, shaderProgram->reflections,
+			(m_reflected_descriptor_layouts ? &descriptorSetLayouts : nullptr),
+			(pushConstantState.empty() ? &pushConstantState : nullptr),
+			sharedDescriptorSetLayouts,
+			prepare_immutable_samplers(),
+			prepare_push_descriptor_set(),
+			m_use_descriptor_buffers);
+		if (m_context->CreatePipelineLayout(descriptorSetLayouts, pushConstantState) != m_shared_pipeline_layout) // Identical layouts are shared
+			throw std::runtime_error("The pipeline layout changed (Descriptor sets or push constants)!");
+
+		VertexInputLayout vertexInputLayout;
+		for (const auto& reflection : shaderProgram->reflections)
 		{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size()),
-			.pWaitSemaphores = wait_semaphores.data(),
-			.pWaitDstStageMask = &which_pipeline_stages_to_wait,
-			.commandBufferCount = 1,
-			.pCommandBuffers = &command_buffer,
-			.signalSemaphoreCount = static_cast<uint32_t>(signal_semaphores.size()),
-			.pSignalSemaphores = signal_semaphores.data()
+			if (reflection->stage == VK_SHADER_STAGE_VERTEX_BIT)
+				deduce_vertex_input_layout(*m_context, *reflection, prepare_vertex_attribute_formats(), vertexInputLayout);
+		}
+		auto isSameAttribute = [](const VkVertexInputAttributeDescription& lhs, const VkVertexInputAttributeDescription& rhs)
+			{ return lhs.location == rhs.location && lhs.binding == rhs.binding && lhs.format == rhs.format && lhs.offset == rhs.offset; };
+		if (vertexInputLayout.stride != m_vertex_input_layout.stride ||
+			!std::equal(vertexInputLayout.attributes.begin(), vertexInputLayout.attributes.end(),
+				m_vertex_input_layout.attributes.begin(), m_vertex_input_layout.attributes.end(), isSameAttribute))
+			throw std::runtime_error("The vertex input layout changed!");
+
+		// Compiled via the pipeline cache, the render thread keeps using the current pipeline meanwhile
+		m_reloaded_pipeline = create_pipeline(*shaderProgram, m_default_specialization.GetInfo());
+		m_reloaded_program = std::move(shaderProgram);
+	}
+
+	void GraphicsPipeline::apply_hot_reload()
+	{
+		if (m_reloaded_pipeline == nullptr) return;
+
+		std::scoped_lock guard{ m_variant_mutex };
+		++m_program_generation;
+		m_shader_program = std::move(*m_reloaded_program);
+		m_reloaded_program.reset();
+		m_shared_pipeline = std::move(m_reloaded_pipeline); // The retired pipeline is destroyed deferred
+		m_pipeline = *m_shared_pipeline;
+		// Variants and shader libraries will be compiled again on first use
+		m_variants.clear();
+		m_pre_rasterization_libraries.clear();
+		m_fragment_shader_libraries.clear();
+		log::info("Hot reloaded {}", typeid(*this).name());
+	}
+
+	const VkSpecializationInfo* SpecializationConstants::GetInfo() const
+	{
+		if (IsEmpty()) return nullptr;
+		m_info = VkSpecializationInfo
+		{
+			.mapEntryCount = static_cast<uint32_t>(m_entries.size()),
+			.pMapEntries = m_entries.data(),
+			.dataSize = m_data.size(),
+			.pData = m_data.data()
 		};
+		return &m_info;
+	}
 
-		auto& submit_queue = m_parent->m_submit_queue_family;
-		if (vkQueueSubmit(submit_queue, 1, &submitInfo, fence) != VK_SUCCESS)
-			throw std::runtime_error("Failed to submit the Vulkan Command Buffer!");
-		if (wait_queue_idle) vkQueueWaitIdle(submit_queue);
+	VkPipeline GraphicsPipeline::GetVariant(const SpecializationConstants& specialization)
+	{
+		assert(m_pipeline != VK_NULL_HANDLE && "You must Initialize() the pipeline before GetVariant()!");
+		uint64_t hash = specialization.GetHash();
+		if (hash == m_default_specialization.GetHash()) return m_pipeline;
 
-		vkFreeCommandBuffers(m_parent->m_context->m_device, *m_parent, 1, &command_buffer);
+		std::scoped_lock guard{ m_variant_mutex };
+		auto& variant = m_variants[hash];
+		if (variant == nullptr)
+		{
+			variant = m_context->IsGraphicsPipelineLibrarySupported()?
+				link_variant(hash, specialization) :
+				create_pipeline(m_shader_program, specialization.GetInfo()); // Compiled on first use via the pipeline cache
+		}
+		return *variant;
 	}
 
-	CommandPool::CommandPool(
-		std::shared_ptr<VulkanContext> vulkan_context,
-		QueueFamilyIndex& submit_queue_family_index,
-		VkCommandPoolCreateFlags command_pool_flags) :
-		m_context{ std::move(vulkan_context) },
-		m_submit_queue_family{ m_context->GetQueue(submit_queue_family_index) },
-		m_command_pool_flags{ command_pool_flags }
+	std::shared_ptr<PipelineStateObject> GraphicsPipeline::link_variant(uint64_t hash, const SpecializationConstants& specialization)
 	{
-		VkCommandPoolCreateInfo commandPoolCreateInfo
+		// 1. Libraries (Only the shader parts are specialized)
+		const bool isMeshPipeline = m_shader_program.stages & VK_SHADER_STAGE_MESH_BIT_EXT;
+		if (m_vertex_input_library == nullptr && !isMeshPipeline)
+			m_vertex_input_library = create_pipeline(m_shader_program, nullptr, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+		if (m_fragment_output_library == nullptr)
+			m_fragment_output_library = create_pipeline(m_shader_program, nullptr, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+		auto& preRasterizationLibrary = m_pre_rasterization_libraries[hash];
+		if (preRasterizationLibrary == nullptr)
+			preRasterizationLibrary = create_pipeline(m_shader_program, specialization.GetInfo(), VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+		auto& fragmentShaderLibrary = m_fragment_shader_libraries[hash];
+		if (fragmentShaderLibrary == nullptr)
+			fragmentShaderLibrary = create_pipeline(m_shader_program, specialization.GetInfo(), VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+
+		std::vector<VkPipeline> libraries{ *preRasterizationLibrary, *fragmentShaderLibrary, *m_fragment_output_library };
+		if (!isMeshPipeline) libraries.emplace_back(*m_vertex_input_library);
+
+		// 2. Fast Link (Usable now) & Optimize in the background
+		auto fastLinkedPipeline = link_pipeline(libraries, false);
+		m_optimizing_jobs.emplace_back(m_context->GetWorkerPool().Submit([this, hash, generation = m_program_generation, libraries = std::move(libraries)]()
 		{
-			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-			.flags = command_pool_flags,
-			.queueFamilyIndex = submit_queue_family_index.value()
+			std::shared_ptr<PipelineStateObject> optimizedPipeline;
+			try { optimizedPipeline = link_pipeline(libraries, true); }
+			catch (const std::exception& error)
+			{
+				log::warn("Keep the fast-linked pipeline variant {:#x}: {}", hash, error.what());
+				return;
+			}
+			std::scoped_lock guard{ m_variant_mutex };
+			if (generation != m_program_generation) return; // Replaced by a hot reload
+			m_variants[hash] = std::move(optimizedPipeline); // The fast-linked pipeline is destroyed deferred
+		}));
+		return fastLinkedPipeline;
+	}
+
+	std::shared_ptr<PipelineStateObject> GraphicsPipeline::link_pipeline(const std::vector<VkPipeline>& libraries, bool link_time_optimization)
+	{
+		VkPipelineLibraryCreateInfoKHR libraryCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+			.libraryCount = static_cast<uint32_t>(libraries.size()),
+			.pLibraries = libraries.data()
+		};
+		CreationFeedbackChain creationFeedback{ *m_context, 0, &libraryCreateInfo }; // Linking has no stages
+		VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = creationFeedback.Chain(),
+			.flags = (link_time_optimization? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : VkPipelineCreateFlags(0)) |
+				(m_use_descriptor_buffers? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : VkPipelineCreateFlags(0)) |
+				((m_owner == VK_NULL_HANDLE && m_rendering_formats.shading_rate_attachment)?
+					VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR : VkPipelineCreateFlags(0)),
+			.layout = m_pipeline_layout
 		};
 
-		if (vkCreateCommandPool(
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		if (vkCreateGraphicsPipelines(
 			m_context->m_device,
-			&commandPoolCreateInfo,
+			m_pipeline_cache,
+			1,
+			&graphicsPipelineCreateInfo,
 			m_context->m_memory_allocation_callback,
-			&m_command_pool) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Command Pool!");
+			&pipeline) != VK_SUCCESS)
+			throw std::runtime_error("Failed to link the Vulkan Graphics Pipeline Libraries!");
+		creationFeedback.Report(*m_context, nullptr, typeid(*this).name());
+		return std::make_shared<PipelineStateObject>(m_context, pipeline);
 	}
 
-	CommandPool::~CommandPool()
+	void GraphicsPipeline::BindVariant(std::shared_ptr<RHI::CommandBuffer> command_buffer, const SpecializationConstants& specialization)
 	{
-		vkDestroyCommandPool(m_context->m_device, m_command_pool, m_context->m_memory_allocation_callback);
+		command_buffer->BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, GetVariant(specialization));
 	}
 
-	std::shared_ptr<CommandBuffer> CommandPool::
-		AllocateCommandBuffer(VkCommandBufferLevel level)
+	std::shared_ptr<PipelineStateObject> GraphicsPipeline::create_pipeline(const ShaderProgram& shader_program, const VkSpecializationInfo* specialization_info,
+		VkGraphicsPipelineLibraryFlagsEXT library_parts/* = 0*/, PipelineCreationFeedback* creation_feedback/* = nullptr*/)
 	{
-		// Command buffers will be automatically freed when their command pool is destroyed
-		std::shared_ptr<CommandBuffer> commandbuffer;
-		if (m_command_pool_flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+		auto hasPart = [library_parts](VkGraphicsPipelineLibraryFlagsEXT part) { return library_parts == 0 || (library_parts & part); };
+		const bool hasVertexInput = hasPart(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+		const bool hasPreRasterization = hasPart(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+		const bool hasFragmentShader = hasPart(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+		const bool hasFragmentOutput = hasPart(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+
+		// Shader modules and reflections are shared by all variants
+		std::vector<VkPipelineShaderStageCreateInfo> shaderInfos;
+		for (auto shader_info : shader_program.stage_infos)
 		{
-			commandbuffer = std::make_shared<CommandBufferReset>(shared_from_this(), level);
+			bool isFragmentStage = shader_info.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+			if (isFragmentStage ? !hasFragmentShader : !hasPreRasterization) continue;
+			shader_info.pSpecializationInfo = specialization_info;
+			shaderInfos.emplace_back(shader_info);
 		}
+		const bool isMeshPipeline = shader_program.stages & VK_SHADER_STAGE_MESH_BIT_EXT;
+
+		auto vertex_inpute_state			= prepare_vertex_input_state();
+		auto input_assembly_state		= prepare_input_assembly_state();
+		auto tessellation_state			= prepare_tessellation_state();
+		auto viewport_state					= prepare_viewport_state();
+		auto rasterization_state			= prepare_rasterization_state();
+		auto multisampling_state		= prepare_multisampling_state();
+		auto depth_stencil_state			= prepare_depth_stencil_state();
+		auto color_blend_state			= prepare_color_blend_state();
+		auto dynamic_state					= prepare_dynamic_state();
+		auto shading_rate_state			= prepare_fragment_shading_rate_state();
+		if (shading_rate_state.has_value() && !m_context->IsFragmentShadingRateSupported())
+			throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline - Fragment shading rates are not supported by this device!");
+		const bool hasShadingRateState = shading_rate_state.has_value() && (hasPreRasterization || hasFragmentShader);
+		const void* shadingRateNext = hasShadingRateState? &shading_rate_state.value() : nullptr;
+
+		// Dynamic counts leave the baked viewports and scissors out (Resizing rebuilds nothing)
+		std::vector<VkDynamicState> dynamicStates(dynamic_state.pDynamicStates, dynamic_state.pDynamicStates + dynamic_state.dynamicStateCount);
+		auto isDynamic = [&dynamicStates](VkDynamicState state) { return std::find(dynamicStates.begin(), dynamicStates.end(), state) != dynamicStates.end(); };
+		if (isDynamic(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT)) { viewport_state.viewportCount = 0; viewport_state.pViewports = nullptr; }
+		if (isDynamic(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT)) { viewport_state.scissorCount = 0; viewport_state.pScissors = nullptr; }
+		if (isMeshPipeline)
+		{
+			std::erase(dynamicStates, VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY); // No input assembly
+			dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+			dynamic_state.pDynamicStates = dynamicStates.data();
+		}
+
+		VkPipelineRenderingCreateInfo renderingCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.pNext = shadingRateNext,
+			.viewMask = 0,
+			.colorAttachmentCount = static_cast<uint32_t>(m_rendering_formats.color_formats.size()),
+			.pColorAttachmentFormats = m_rendering_formats.color_formats.data(),
+			.depthAttachmentFormat = m_rendering_formats.depth_format,
+			.stencilAttachmentFormat = m_rendering_formats.stencil_format
+		};
+
+		VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+			.pNext = (m_owner == VK_NULL_HANDLE)? &renderingCreateInfo : shadingRateNext,
+			.flags = library_parts
+		};
+
+		CreationFeedbackChain creationFeedback{ *m_context, static_cast<uint32_t>(shaderInfos.size()),
+			library_parts? static_cast<const void*>(&libraryCreateInfo) : (m_owner == VK_NULL_HANDLE)? &renderingCreateInfo : shadingRateNext }; // Dynamic Rendering
+		VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = creationFeedback.Chain(),
+			.flags = (library_parts? VkPipelineCreateFlags(VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT) : VkPipelineCreateFlags(0)) |
+				(m_use_descriptor_buffers? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : VkPipelineCreateFlags(0)) |
+				((m_owner == VK_NULL_HANDLE && m_rendering_formats.shading_rate_attachment)?
+					VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR : VkPipelineCreateFlags(0)),
+
+			.stageCount = static_cast<uint32_t>(shaderInfos.size()),
+			.pStages = shaderInfos.data(),
+
+			.pVertexInputState = (isMeshPipeline || !hasVertexInput)? nullptr : &vertex_inpute_state, // Ignored by mesh pipelines
+			.pInputAssemblyState = (isMeshPipeline || !hasVertexInput)? nullptr : &input_assembly_state,
+			.pTessellationState = (hasPreRasterization && (shader_program.stages & VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT))? &tessellation_state : nullptr,
+			.pViewportState = hasPreRasterization? &viewport_state : nullptr,
+			.pRasterizationState = hasPreRasterization? &rasterization_state : nullptr,
+			.pMultisampleState = (hasFragmentShader || hasFragmentOutput)? &multisampling_state : nullptr,
+			.pDepthStencilState = hasFragmentShader? &depth_stencil_state : nullptr,
+			.pColorBlendState = hasFragmentOutput? &color_blend_state : nullptr,
+			.pDynamicState = &dynamic_state,
+
+			.layout = (hasPreRasterization || hasFragmentShader)? m_pipeline_layout : VK_NULL_HANDLE,
+			.renderPass = m_owner,
+			.subpass = m_subpass_bind_point,
+			.basePipelineHandle = library_parts? VK_NULL_HANDLE : m_base_pipeline,
+			.basePipelineIndex = library_parts? -1 : m_base_pipeline_index
+		};
+
+		auto createPipeline = [&]()
+		{
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			if (vkCreateGraphicsPipelines(
+				m_context->m_device,
+				m_pipeline_cache,
+				1,
+				&graphicsPipelineCreateInfo,
+				m_context->m_memory_allocation_callback,
+				&pipeline) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the Vulkan Graphics Pipeline!");
+			auto feedback = creationFeedback.Report(*m_context, shaderInfos.data(), typeid(*this).name());
+			if (creation_feedback) *creation_feedback = std::move(feedback);
+			if constexpr (EnableDebugMarkers)
+				DebugUtils::SetObjectName(m_context->m_device, VK_OBJECT_TYPE_PIPELINE, pipeline, typeid(*this).name()); // First derived pipeline class
+			auto* pipelineTrace = m_context->GetPipelineTrace();
+			auto* commandCapture = m_context->GetCommandCapture();
+			if ((pipelineTrace || commandCapture) && !library_parts && m_owner == VK_NULL_HANDLE && m_reflected_descriptor_layouts)
+			{
+				if (auto record = PipelineTrace::MakeGraphicsRecord(graphicsPipelineCreateInfo, renderingCreateInfo, hasShadingRateState? &shading_rate_state.value() : nullptr,
+					shader_program.files, shader_program.modules, m_shared_descriptor_set_layouts, m_shared_pipeline_layout->GetPushConstantRanges()))
+				{
+					if (commandCapture) commandCapture->AddPipeline(pipeline, graphicsPipelineCreateInfo.layout, PipelineTrace::Serialize(*record));
+					if (pipelineTrace) pipelineTrace->Add(std::move(*record));
+				}
+			}
+			return pipeline;
+		};
+		if (library_parts) return std::make_shared<PipelineStateObject>(m_context, createPipeline());
+
+		auto stateKey = serialize_graphics_pipeline_state(graphicsPipelineCreateInfo, *m_shared_pipeline_layout, shader_program.modules,
+			(m_owner == VK_NULL_HANDLE)? &renderingCreateInfo : nullptr, hasShadingRateState? &shading_rate_state.value() : nullptr, m_fixed_state_hash);
+		return m_context->AcquirePipeline(std::move(stateKey), createPipeline);
+	}
+
+	SpecializationConstants GraphicsPipeline::
+		prepare_specialization()
+	{
+		return {};
+	}
+
+	std::vector<VkDescriptorSetLayout> GraphicsPipeline::
+		prepare_descriptor_layouts()
+	{
+		return {};
+	}
+
+	std::vector<VkPushConstantRange> GraphicsPipeline::
+		prepare_push_constant_state()
+	{
+		return {};
+	}
+
+	std::vector<ImmutableSamplerBinding> GraphicsPipeline::
+		prepare_immutable_samplers()
+	{
+		return {};
+	}
+
+	std::optional<uint32_t> GraphicsPipeline::
+		prepare_push_descriptor_set()
+	{
+		return std::nullopt;
+	}
+
+	VkPipelineVertexInputStateCreateInfo GraphicsPipeline::
+		prepare_vertex_input_state()
+	{
+		// Reflected interleaved layout (Empty if the vertex shader has no inputs)
+		m_vertex_binding_description = VkVertexInputBindingDescription
+		{
+			.binding = 0,
+			.stride = m_vertex_input_layout.stride,
+			.inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+		};
+		const bool hasVertexInputs = !m_vertex_input_layout.attributes.empty();
+		return VkPipelineVertexInputStateCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.vertexBindingDescriptionCount = hasVertexInputs ? 1U : 0U,
+			.pVertexBindingDescriptions = &m_vertex_binding_description,
+			.vertexAttributeDescriptionCount = static_cast<uint32_t>(m_vertex_input_layout.attributes.size()),
+			.pVertexAttributeDescriptions = m_vertex_input_layout.attributes.data()
+		};
+	}
+
+	std::unordered_map<uint32_t, VkFormat> GraphicsPipeline::
+		prepare_vertex_attribute_formats()
+	{
+		return {};
+	}
+
+	VkPipelineTessellationStateCreateInfo GraphicsPipeline::
+		prepare_tessellation_state()
+	{
+		
+
+		return VkPipelineTessellationStateCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
+			.patchControlPoints = 3 // Triangle patches
+		};
+	}
+
+	VkPipelineMultisampleStateCreateInfo GraphicsPipeline::
+		prepare_multisampling_state()
+	{
+		return VkPipelineMultisampleStateCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples = m_rendering_formats.samples, // Override it for MSAA subpasses of a RenderPass
+			.sampleShadingEnable = VK_FALSE,
+			.minSampleShading = 1.0f,
+			.pSampleMask = nullptr,
+			.alphaToCoverageEnable = VK_FALSE,
+			.alphaToOneEnable = VK_FALSE
+		};
+	}
+
+	VkPipelineDepthStencilStateCreateInfo GraphicsPipeline::
+		prepare_depth_stencil_state()
+	{
+		return VkPipelineDepthStencilStateCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+			.depthTestEnable = VK_FALSE,
+			.depthWriteEnable = VK_FALSE,
+			.depthCompareOp = VK_COMPARE_OP_LESS, // Keep fragments, which has lower depth
+			.depthBoundsTestEnable = VK_FALSE,  // Only keep fragments that fall within the specified depth range.
+			.stencilTestEnable = VK_FALSE,
+			.front = {},
+			.back = {},
+			.minDepthBounds = 0.0,
+			.maxDepthBounds = 1.0
+		};
+	}
+
+	std::optional<VkPipelineFragmentShadingRateStateCreateInfoKHR> GraphicsPipeline::
+		prepare_fragment_shading_rate_state()
+	{
+		return std::nullopt; // Full rate (Chaining the state is invalid without the extension)
+	}
+
+	VkPipelineDynamicStateCreateInfo GraphicsPipeline::
+		prepare_dynamic_state()
+	{
+		return VkPipelineDynamicStateCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount = static_cast<uint32_t>(m_dynamic_states.size()),
+			.pDynamicStates = m_dynamic_states.data()
+		};
+	}
+
+	bool GraphicsPipeline::use_extended_dynamic_state()
+	{
+		if (m_context->m_physical_device_properties.apiVersion < VK_API_VERSION_1_3) return false; // Core (No feature bit)
+
+		m_dynamic_states =
+		{
+			VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT,
+			VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT,
+			VK_DYNAMIC_STATE_CULL_MODE,
+			VK_DYNAMIC_STATE_FRONT_FACE,
+			VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY, // Removed from mesh pipelines
+			VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,
+			VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE,
+			VK_DYNAMIC_STATE_STENCIL_OP
+		};
+		return true;
+	}
+
+	bool GraphicsPipeline::use_dynamic_viewports()
+	{
+		if (m_context->m_physical_device_properties.apiVersion < VK_API_VERSION_1_3) return false; // Core (No feature bit)
+		for (auto dynamicState : { VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT, VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT })
+		{
+			if (std::find(m_dynamic_states.begin(), m_dynamic_states.end(), dynamicState) == m_dynamic_states.end())
+				m_dynamic_states.emplace_back(dynamicState);
+		}
+		return true;
+	}
+
+	bool GraphicsPipeline::use_dynamic_fragment_shading_rate()
+	{
+		if (!m_context->IsFragmentShadingRateSupported()) return false;
+		if (std::find(m_dynamic_states.begin(), m_dynamic_states.end(), VK_DYNAMIC_STATE_FRAGMENT_SHADING_RATE_KHR) == m_dynamic_states.end())
+			m_dynamic_states.emplace_back(VK_DYNAMIC_STATE_FRAGMENT_SHADING_RATE_KHR);
+		return true;
+	}
+
+	bool GraphicsPipeline::use_descriptor_buffers()
+	{
+		assert(m_pipeline == VK_NULL_HANDLE && "Call use_descriptor_buffers() before Initialize()!");
+		m_use_descriptor_buffers = m_context->IsDescriptorBufferSupported();
+		return m_use_descriptor_buffers;
+	}
+
+	std::shared_ptr<ShaderModule> GraphicsPipeline::create_shader_module(std::string_view shader_file)
+	{
+		return m_context->GetShaderCache().GetShaderModule(shader_file);
+	}
+
+	ComputePipeline::ComputePipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		VkPipeline base_pipeline/* = VK_NULL_HANDLE*/, int32_t base_pipeline_index/* = -1*/):
+		m_context{std::move(vulkan_context)},
+		m_pipeline_cache{ m_context->m_pipeline_cache },
+		m_base_pipeline { base_pipeline },
+		m_base_pipeline_index { base_pipeline_index }
+	{
+		
+	}
+
+	ComputePipeline::~ComputePipeline()
+	{
+		if (m_shared_descriptor_set_layouts.empty()) // Cached layouts will be destroyed by their last owner
+		{
+			for (auto& descriptor_set_layout : m_descriptor_set_layouts)
+				vkDestroyDescriptorSetLayout(m_context->m_device, descriptor_set_layout, m_context->m_memory_allocation_callback);
+		}
+		m_context->InvalidateBakedCommands(m_pipeline);
+		vkDestroyPipeline(m_context->m_device, m_pipeline, m_context->m_memory_allocation_callback);
+	}
+
+	void ComputePipeline::Initialize()
+	{
+		// 1. Shader Stage
+		const auto shaderFile = prepare_shader_file();
+		m_shader_module = m_context->GetShaderCache().GetShaderModule(shaderFile);
+		auto& shader_cache = m_context->GetShaderCache();
+		auto shader_reflection = shader_cache.GetShaderReflection(*m_shader_module);
+		if (shader_reflection->stage != VK_SHADER_STAGE_COMPUTE_BIT)
+			throw std::runtime_error("Failed to create the Vulkan Compute Pipeline - The shader is not a compute shader!");
+
+		// 2. Pipeline Layout
+		m_descriptor_set_layouts = prepare_descriptor_layouts();
+		const bool isReflectedLayout = m_descriptor_set_layouts.empty();
+		auto push_constant_state = prepare_push_constant_state();
+		deduce_pipeline_states_from_shaders(*m_context, { shader_reflection },
+			(m_descriptor_set_layouts.empty() ? &m_descriptor_set_layouts : nullptr),
+			(push_constant_state.empty() ? &push_constant_state : nullptr),
+			m_shared_descriptor_set_layouts,
+			prepare_immutable_samplers(),
+			prepare_push_descriptor_set(),
+			m_use_descriptor_buffers);
+
+		m_shared_pipeline_layout = m_context->CreatePipelineLayout(m_descriptor_set_layouts, push_constant_state); // Identical layouts are shared
+		m_pipeline_layout = *m_shared_pipeline_layout;
+		m_push_constant_block = m_shared_pipeline_layout->GetPushConstantBlock();
+
+		// 3. Compute Pipeline
+		VkComputePipelineCreateInfo computePipelineCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.flags = m_use_descriptor_buffers? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : VkPipelineCreateFlags(0),
+			.stage = VkPipelineShaderStageCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+				.module = *m_shader_module,
+				.pName = "main",
+				.pSpecializationInfo = prepare_specialization_info()
+			},
+			.layout = m_pipeline_layout,
+			.basePipelineHandle = m_base_pipeline,
+			.basePipelineIndex = m_base_pipeline_index
+		};
+		CreationFeedbackChain creationFeedback{ *m_context, 1, nullptr };
+		computePipelineCreateInfo.pNext = creationFeedback.Chain();
+		if (vkCreateComputePipelines(
+			m_context->m_device,
+			m_pipeline_cache,
+			1,
+			&computePipelineCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_pipeline) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Compute Pipeline!");
+		m_creation_feedback = creationFeedback.Report(*m_context, &computePipelineCreateInfo.stage, typeid(*this).name());
+		auto* pipelineTrace = m_context->GetPipelineTrace();
+		auto* commandCapture = m_context->GetCommandCapture();
+		if ((pipelineTrace || commandCapture) && isReflectedLayout)
+		{
+			if (auto record = PipelineTrace::MakeComputeRecord(computePipelineCreateInfo, shaderFile, *m_shader_module,
+				m_shared_descriptor_set_layouts, push_constant_state))
+			{
+				if (commandCapture) commandCapture->AddPipeline(m_pipeline, m_pipeline_layout, PipelineTrace::Serialize(*record));
+				if (pipelineTrace) pipelineTrace->Add(std::move(*record));
+			}
+		}
+		if constexpr (EnableDebugMarkers)
+		{
+			const char* name = typeid(*this).name(); // Derived pipeline class
+			DebugUtils::SetObjectName(m_context->m_device, VK_OBJECT_TYPE_PIPELINE, m_pipeline, name);
+			DebugUtils::SetObjectName(m_context->m_device, VK_OBJECT_TYPE_PIPELINE_LAYOUT, m_pipeline_layout, name);
+		}
+	}
+
+	void ComputePipeline::Bind(RHI::CommandBuffer& command_buffer)
+	{
+		command_buffer.BindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+	}
+
+	void ComputePipeline::Dispatch(RHI::CommandBuffer& command_buffer, uint32_t group_count_x, uint32_t group_count_y/* = 1*/, uint32_t group_count_z/* = 1*/)
+	{
+		command_buffer.Dispatch(group_count_x, group_count_y, group_count_z);
+	}
+
+	std::vector<VkDescriptorSetLayout> ComputePipeline::
+		prepare_descriptor_layouts()
+	{
+		return {};
+	}
+
+	std::vector<VkPushConstantRange> ComputePipeline::
+		prepare_push_constant_state()
+	{
+		return {};
+	}
+
+	std::vector<ImmutableSamplerBinding> ComputePipeline::
+		prepare_immutable_samplers()
+	{
+		return {};
+	}
+
+	std::optional<uint32_t> ComputePipeline::
+		prepare_push_descriptor_set()
+	{
+		return std::nullopt;
+	}
+
+	bool ComputePipeline::use_descriptor_buffers()
+	{
+		assert(m_pipeline == VK_NULL_HANDLE && "Call use_descriptor_buffers() before Initialize()!");
+		m_use_descriptor_buffers = m_context->IsDescriptorBufferSupported();
+		return m_use_descriptor_buffers;
+	}
+
+	const VkSpecializationInfo* ComputePipeline::
+		prepare_specialization_info()
+	{
+		return nullptr;
+	}
+
+	ShaderObjectProgram::ShaderObjectProgram(std::shared_ptr<RHI::VulkanContext> vulkan_context, const std::vector<std::string>& shader_files,
+		const SpecializationConstants& specialization/* = {}*/, const std::unordered_map<uint32_t, VkFormat>& vertex_attribute_formats/* = {}*/) :
+		m_context{ std::move(vulkan_context) }
+	{
+		ALBEDO_RHI_TRACE_ZONE("RHI::ShaderObjectProgram::ShaderObjectProgram");
+		if (!m_context->IsShaderObjectSupported())
+			throw std::runtime_error("Failed to create the Shader Objects - VK_EXT_shader_object is not supported by this device!");
+
+		// 1. Shader Stages (Same checks as GraphicsPipeline::load_shader_program())
+		auto& shader_cache = m_context->GetShaderCache();
+		std::vector<std::shared_ptr<ShaderModule>> shaderModules;
+		std::vector<std::shared_ptr<const ShaderReflection>> shaderReflections;
+		for (const auto& shader : shader_files)
+		{
+			auto& shaderModule = shaderModules.emplace_back(shader_cache.GetShaderModule(shader));
+			auto& reflection = shaderReflections.emplace_back(shader_cache.GetShaderReflection(*shaderModule));
+			if (m_stages & reflection->stage)
+				throw std::runtime_error(std::format("Failed to create the Shader Objects - Duplicate shader stage ({})!", shader));
+			m_stages |= reflection->stage;
+		}
+		const bool isMeshProgram = m_stages & VK_SHADER_STAGE_MESH_BIT_EXT;
+		if (isMeshProgram == static_cast<bool>(m_stages & VK_SHADER_STAGE_VERTEX_BIT))
+			throw std::runtime_error("Failed to create the Shader Objects - Either a vertex or a mesh shader is required!");
+		if (m_stages & VK_SHADER_STAGE_COMPUTE_BIT)
+			throw std::runtime_error("Failed to create the Shader Objects - Compute shaders belong to ComputePipeline!");
+		if (isMeshProgram && !m_context->IsMeshShaderSupported())
+			throw std::runtime_error("Failed to create the Shader Objects - Mesh shaders are not supported by this device!");
+
+		// 2. Layouts (Reflected, shared with pipelines of the same layouts)
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		deduce_pipeline_states_from_shaders(*m_context, shaderReflections, &descriptorSetLayouts, &pushConstantRanges,
+			m_shared_descriptor_set_layouts, {}, std::nullopt, false);
+		m_shared_pipeline_layout = m_context->CreatePipelineLayout(descriptorSetLayouts, pushConstantRanges);
+		m_pipeline_layout = *m_shared_pipeline_layout;
+		m_push_constant_block = m_shared_pipeline_layout->GetPushConstantBlock();
+		for (const auto& reflection : shaderReflections)
+		{
+			if (reflection->stage != VK_SHADER_STAGE_VERTEX_BIT) continue;
+			deduce_vertex_input_layout(*m_context, *reflection, vertex_attribute_formats, m_vertex_input_layout);
+			if (!m_vertex_input_layout.attributes.empty())
+			{
+				m_vertex_binding = VkVertexInputBindingDescription2EXT
+				{
+					.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT,
+					.binding = 0,
+					.stride = m_vertex_input_layout.stride,
+					.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+					.divisor = 1
+				};
+			}
+			for (const auto& attribute : m_vertex_input_layout.attributes)
+			{
+				m_vertex_attributes.emplace_back(VkVertexInputAttributeDescription2EXT
+					{
+						.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT,
+						.location = attribute.location,
+						.binding = attribute.binding,
+						.format = attribute.format,
+						.offset = attribute.offset
+					});
+			}
+		}
+
+		// 3. Shader Objects (Linked like a pipeline, so the driver optimizes across the interfaces)
+		auto get_next_stages = [this](VkShaderStageFlagBits stage) -> VkShaderStageFlags
+		{
+			switch (stage)
+			{
+			case VK_SHADER_STAGE_VERTEX_BIT:										return m_stages & (VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT | VK_SHADER_STAGE_GEOMETRY_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+			case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:		return m_stages & VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+			case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:	return m_stages & (VK_SHADER_STAGE_GEOMETRY_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+			case VK_SHADER_STAGE_GEOMETRY_BIT:								return m_stages & VK_SHADER_STAGE_FRAGMENT_BIT;
+			case VK_SHADER_STAGE_TASK_BIT_EXT:									return m_stages & VK_SHADER_STAGE_MESH_BIT_EXT;
+			case VK_SHADER_STAGE_MESH_BIT_EXT:									return m_stages & VK_SHADER_STAGE_FRAGMENT_BIT;
+			default:																					return 0;
+			}
+		};
+		const auto& layoutPushConstants = m_shared_pipeline_layout->GetPushConstantRanges();
+		std::vector<VkShaderCreateInfoEXT> shaderCreateInfos;
+		for (size_t index = 0; index < shaderModules.size(); ++index)
+		{
+			const auto stage = shaderReflections[index]->stage;
+			const auto bytecode = shaderModules[index]->GetBytecode();
+			VkShaderCreateFlagsEXT flags = (shaderModules.size() > 1)? VK_SHADER_CREATE_LINK_STAGE_BIT_EXT : VkShaderCreateFlagsEXT(0);
+			if (stage == VK_SHADER_STAGE_MESH_BIT_EXT && !(m_stages & VK_SHADER_STAGE_TASK_BIT_EXT)) flags |= VK_SHADER_CREATE_NO_TASK_SHADER_BIT_EXT;
+			shaderCreateInfos.emplace_back(VkShaderCreateInfoEXT
+				{
+					.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+					.flags = flags,
+					.stage = stage,
+					.nextStage = get_next_stages(stage),
+					.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+					.codeSize = bytecode.size(),
+					.pCode = bytecode.data(),
+					.pName = "main",
+					.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
+					.pSetLayouts = descriptorSetLayouts.data(),
+					.pushConstantRangeCount = static_cast<uint32_t>(layoutPushConstants.size()),
+					.pPushConstantRanges = layoutPushConstants.data(),
+					.pSpecializationInfo = specialization.GetInfo()
+				});
+		}
+		m_shaders.resize(shaderCreateInfos.size(), VK_NULL_HANDLE);
+		if (m_context->m_create_shaders(m_context->m_device, static_cast<uint32_t>(shaderCreateInfos.size()), shaderCreateInfos.data(),
+			m_context->m_memory_allocation_callback, m_shaders.data()) != VK_SUCCESS)
+		{
+			for (auto shader : m_shaders)
+				if (shader != VK_NULL_HANDLE) m_context->m_destroy_shader(m_context->m_device, shader, m_context->m_memory_allocation_callback);
+			throw std::runtime_error("Failed to create the Shader Objects!");
+		}
+
+		// Every graphics stage of the device is bound, so the stages of the previous program are unbound
+		std::vector<VkShaderStageFlagBits> bindStages{ VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+		if (m_context->m_physical_device_features.tessellationShader)
+		{
+			bindStages.emplace_back(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+			bindStages.emplace_back(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
+		}
+		if (m_context->m_physical_device_features.geometryShader) bindStages.emplace_back(VK_SHADER_STAGE_GEOMETRY_BIT);
+		if (m_context->IsTaskShaderSupported()) bindStages.emplace_back(VK_SHADER_STAGE_TASK_BIT_EXT);
+		if (m_context->IsMeshShaderSupported()) bindStages.emplace_back(VK_SHADER_STAGE_MESH_BIT_EXT);
+		for (auto stage : bindStages)
+		{
+			auto shader = std::find_if(shaderCreateInfos.begin(), shaderCreateInfos.end(), [stage](const auto& info) { return info.stage == stage; });
+			m_bind_stages.emplace_back(stage);
+			m_bind_shaders.emplace_back(shader != shaderCreateInfos.end()? m_shaders[shader - shaderCreateInfos.begin()] : VK_NULL_HANDLE);
+		}
+		if constexpr (EnableDebugMarkers)
+		{
+			for (size_t index = 0; index < m_shaders.size(); ++index)
+				DebugUtils::SetObjectName(m_context->m_device, VK_OBJECT_TYPE_SHADER_EXT, m_shaders[index], shader_files[index].c_str());
+		}
+	}
+
+	ShaderObjectProgram::~ShaderObjectProgram()
+	{
+		m_context->DeferDeletion([context = m_context.get(), shaders = std::move(m_shaders)]()
+			{
+				for (auto shader : shaders)
+					context->m_destroy_shader(context->m_device, shader, context->m_memory_allocation_callback);
+			});
+	}
+
+	void ShaderObjectProgram::Bind(CommandBuffer& command_buffer, const State& state)
+	{
+		assert(command_buffer.IsRecording() && "You have to ensure that the command buffer is recording!");
+		assert(state.color_blend_attachments.size() <= MAX_COLOR_ATTACHMENTS && "Too many color attachments!");
+		command_buffer.BindShaders(m_bind_stages, m_bind_shaders);
+
+		const auto& context = *m_context;
+		const auto& dispatch = command_buffer.GetDispatch();
+		const auto& features = context.m_physical_device_features; // Enabled as supported
+		if (m_stages & VK_SHADER_STAGE_VERTEX_BIT)
+		{
+			context.m_cmd_set_vertex_input(command_buffer, m_vertex_binding.has_value()? 1 : 0, m_vertex_binding.has_value()? &m_vertex_binding.value() : nullptr,
+				static_cast<uint32_t>(m_vertex_attributes.size()), m_vertex_attributes.data());
+			command_buffer.SetPrimitiveTopology(state.topology);
+			dispatch.vkCmdSetPrimitiveRestartEnable(command_buffer, state.primitive_restart);
+		}
+		if (m_stages & VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT)
+			context.m_cmd_set_patch_control_points(command_buffer, state.patch_control_points);
+
+		// Rasterization
+		dispatch.vkCmdSetRasterizerDiscardEnable(command_buffer, state.rasterizer_discard);
+		context.m_cmd_set_polygon_mode(command_buffer, state.polygon_mode);
+		command_buffer.SetCullMode(state.cull_mode);
+		command_buffer.SetFrontFace(state.front_face);
+		dispatch.vkCmdSetLineWidth(command_buffer, state.line_width);
+		if (features.depthClamp) context.m_cmd_set_depth_clamp_enable(command_buffer, state.depth_clamp);
+		dispatch.vkCmdSetDepthBiasEnable(command_buffer, state.depth_bias);
+		if (state.depth_bias)
+			dispatch.vkCmdSetDepthBias(command_buffer, state.depth_bias_constant_factor, state.depth_bias_clamp, state.depth_bias_slope_factor);
+
+		// Depth & Stencil
+		command_buffer.SetDepthTestEnable(state.depth_test);
+		command_buffer.SetDepthWriteEnable(state.depth_write);
+		command_buffer.SetDepthCompareOp(state.depth_compare_op);
+		dispatch.vkCmdSetDepthBoundsTestEnable(command_buffer, VK_FALSE);
+		command_buffer.SetStencilTestEnable(state.stencil_test);
+
+		// Multisampling
+		constexpr VkSampleMask sampleMask[2]{ ~0u, ~0u }; // Up to 64 samples
+		context.m_cmd_set_rasterization_samples(command_buffer, state.samples);
+		context.m_cmd_set_sample_mask(command_buffer, state.samples, sampleMask);
+		context.m_cmd_set_alpha_to_coverage_enable(command_buffer, state.alpha_to_coverage);
+		if (features.alphaToOne) context.m_cmd_set_alpha_to_one_enable(command_buffer, VK_FALSE);
+
+		// Color Blending
+		if (features.logicOp) context.m_cmd_set_logic_op_enable(command_buffer, VK_FALSE);
+		const uint32_t attachmentCount = static_cast<uint32_t>(state.color_blend_attachments.size());
+		if (attachmentCount == 0) return;
+		std::array<VkBool32, MAX_COLOR_ATTACHMENTS> blendEnables;
+		std::array<VkColorBlendEquationEXT, MAX_COLOR_ATTACHMENTS> blendEquations;
+		std::array<VkColorComponentFlags, MAX_COLOR_ATTACHMENTS> writeMasks;
+		for (uint32_t index = 0; index < attachmentCount; ++index)
+		{
+			const auto& attachment = state.color_blend_attachments[index];
+			blendEnables[index] = attachment.blendEnable;
+			blendEquations[index] = VkColorBlendEquationEXT
+			{
+				.srcColorBlendFactor = attachment.srcColorBlendFactor,
+				.dstColorBlendFactor = attachment.dstColorBlendFactor,
+				.colorBlendOp = attachment.colorBlendOp,
+				.srcAlphaBlendFactor = attachment.srcAlphaBlendFactor,
+				.dstAlphaBlendFactor = attachment.dstAlphaBlendFactor,
+				.alphaBlendOp = attachment.alphaBlendOp
+			};
+			writeMasks[index] = attachment.colorWriteMask;
+		}
+		context.m_cmd_set_color_blend_enable(command_buffer, 0, attachmentCount, blendEnables.data());
+		context.m_cmd_set_color_blend_equation(command_buffer, 0, attachmentCount, blendEquations.data());
+		context.m_cmd_set_color_write_mask(command_buffer, 0, attachmentCount, writeMasks.data());
+	}
+
+	CommandBuffer::CommandBuffer(CommandPool& parent, VkCommandBufferLevel level, CommandBufferPolicy policy) :
+		m_parent{ &parent }, m_policy{ policy }, m_dispatch{ &m_parent->m_context->m_dispatch }, m_level{ level }, m_submitted_timeline{ &m_parent->GetQueueTimeline() }
+	{
+		
+	}
+
+	CommandBuffer::~CommandBuffer()
+	{
+		if (command_buffer != VK_NULL_HANDLE)
+			m_parent->recycle(command_buffer, m_level, m_submitted_timeline, m_submitted_tick);
+	}
+
+	void CommandBuffer::Begin(VkCommandBufferInheritanceInfo* inheritanceInfo/* = nullptr*/)
+	{
+		assert(!IsRecording() && "You cannot Begin() a recording Vulkan Command Buffer!");
+		assert(command_buffer != VK_NULL_HANDLE && "One-time Vulkan Command Buffers cannot be recorded again after Submit()!");
+		m_queued_barriers.clear();
+		m_split_barriers.clear();
+		InvalidateDynamicState();
+		InvalidateBindings();
+		m_statistics = {};
+		m_capture = (m_level == VK_COMMAND_BUFFER_LEVEL_PRIMARY && m_parent->m_context->GetCommandCapture()) ?
+			std::make_unique<CaptureStream>() : nullptr;
+
+		const VkDeviceGroupCommandBufferBeginInfo deviceGroupBeginInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_COMMAND_BUFFER_BEGIN_INFO,
+			.deviceMask = m_device_mask
+		};
+		m_current_device_mask = m_device_mask;
+
+		VkCommandBufferUsageFlags usage = (m_level == VK_COMMAND_BUFFER_LEVEL_SECONDARY && inheritanceInfo &&
+			(inheritanceInfo->renderPass != VK_NULL_HANDLE || inheritanceInfo->pNext /*Dynamic Rendering*/)) ?
+			VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0;
+		if (m_policy == CommandBufferPolicy::RESET)
+		{
+			m_dispatch->vkResetCommandBuffer(command_buffer, 0);
+			m_executed_command_buffers.clear();
+		}
+		else usage |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		VkCommandBufferBeginInfo commandBufferBeginInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = m_device_mask ? &deviceGroupBeginInfo : nullptr,
+			.flags = usage,
+			.pInheritanceInfo = inheritanceInfo
+		};
+		if (m_dispatch->vkBeginCommandBuffer(command_buffer, &commandBufferBeginInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to begin the Vulkan Command Buffer!");
+
+		m_is_recording = true;
+	}
+
+	void CommandBuffer::End()
+	{
+		assert(IsRecording() && "You cannot End() an idle Vulkan Command Buffer!");
+		assert(m_split_barriers.empty() && "You must WaitBarrierEvent() for every SetBarrierEvent() before End()!");
+		assert(!m_is_conditional && "You must EndConditional() before End()!");
+		FlushBarriers();
+		if (m_dispatch->vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to end the Vulkan Command Buffer!");
+		m_is_recording = false;
+		{
+			std::scoped_lock guard{ m_parent->m_recycle_mutex };
+			m_parent->m_recording_statistics += m_statistics;
+		}
+		m_parent->m_context->GetStatistics().AddRecording(m_statistics);
+	}
+
+	void CommandBuffer::Submit(
+		bool wait_queue_idle/* = false*/,
+		VkFence fence/* = VK_NULL_HANDLE*/,
+		std::span<const VkSemaphore> wait_semaphores/* = {}*/,
+		std::span<const VkSemaphore> signal_semaphores/* = {}*/,
+		VkPipelineStageFlags2 which_pipeline_stages_to_wait/* = 0*/,
+		uint32_t target_queue_index/* = PARENT_QUEUE*/)
+	{
+		InlineVector<SemaphoreWaitInfo, 8> waitInfos;
+		for (auto wait_semaphore : wait_semaphores)
+			waitInfos.emplace_back(SemaphoreWaitInfo{ .semaphore = wait_semaphore, .stages = which_pipeline_stages_to_wait });
+
+		auto tick = SubmitTick(waitInfos, signal_semaphores, fence, target_queue_index);
+		if (wait_queue_idle) m_submitted_timeline->Wait(tick); // Only this submission instead of vkQueueWaitIdle()
+		if (m_policy == CommandBufferPolicy::RESET) return;
+
+		// Recycled by the pool once its work is complete (Instead of vkFreeCommandBuffers())
+		m_parent->recycle(command_buffer, m_level, m_submitted_timeline, tick);
+		command_buffer = VK_NULL_HANDLE;
+	}
+
+	CommandBufferBaked::~CommandBufferBaked()
+	{
+		unregister();
+	}
+
+	bool CommandBufferBaked::Bake(const RecordFunction& record, VkCommandBufferInheritanceInfo* inheritanceInfo/* = nullptr*/)
+	{
+		if (IsValid()) return false;
+		unregister(); // Stale since the swap chain was recreated
+
+		auto& context = *m_parent->m_context;
+		if (m_submitted_tick && !m_submitted_timeline->IsComplete(m_submitted_tick))
+		{
+			// The last baking may still be executing: Retire its handle and record into another one
+			m_parent->recycle(command_buffer, m_level, m_submitted_timeline, m_submitted_tick);
+			command_buffer = m_parent->allocate(m_level);
+			m_submitted_timeline = &m_parent->GetQueueTimeline();
+		}
+		m_submitted_tick = 0;
+
+		std::vector<uint64_t> dependencies;
+		m_baked_dependencies = &dependencies;
+		Begin(inheritanceInfo);
+		record(*this);
+		End();
+		m_baked_dependencies = nullptr;
+		std::sort(dependencies.begin(), dependencies.end());
+		dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+		std::scoped_lock guard{ context.m_baked_command_buffers_mutex };
+		m_dependencies = std::move(dependencies);
+		m_swapchain_generation = context.m_swapchain_generation;
+		m_is_valid = true;
+		context.m_baked_command_buffers.emplace_back(this);
+		context.m_baked_command_buffer_count = context.m_baked_command_buffers.size();
+		return true;
+	}
+
+	void CommandBufferBaked::Replay(CommandBuffer& primary_command_buffer)
+	{
+		assert(IsValid() && "You have to Bake() the command buffer again before replaying it!");
+		primary_command_buffer.ExecuteCommands({ shared_from_this() });
+	}
+
+	void CommandBufferBaked::Invalidate()
+	{
+		unregister();
+	}
+
+	bool CommandBufferBaked::IsValid() const
+	{
+		return m_is_valid && m_swapchain_generation == m_parent->m_context->m_swapchain_generation;
+	}
+
+	void CommandBufferBaked::unregister()
+	{
+		auto& context = *m_parent->m_context;
+		std::scoped_lock guard{ context.m_baked_command_buffers_mutex };
+		m_is_valid = false;
+		std::erase(context.m_baked_command_buffers, this);
+		context.m_baked_command_buffer_count = context.m_baked_command_buffers.size();
+	}
+
+	uint64_t CommandBuffer::SubmitTick(
+		std::span<const SemaphoreWaitInfo> wait_semaphores/* = {}*/,
+		std::span<const VkSemaphore> signal_semaphores/* = {}*/,
+		VkFence fence/* = VK_NULL_HANDLE*/,
+		uint32_t target_queue_index/* = PARENT_QUEUE*/)
+	{
+		assert(!IsRecording() && "You cannot submit a recording Vulkan Command Buffer!");
+		assert(command_buffer != VK_NULL_HANDLE && "One-time Vulkan Command Buffers cannot be submitted twice!");
+		m_submitted_timeline = (target_queue_index == PARENT_QUEUE || target_queue_index == m_parent->GetQueueIndex()) ?
+			&m_parent->GetQueueTimeline() : &m_parent->GetQueueTimeline(target_queue_index);
+		if (!m_device_mask) m_submitted_tick = m_submitted_timeline->Submit({ &command_buffer, 1 }, wait_semaphores, signal_semaphores, fence);
+		else
+		{
+			// Only the devices of the mask run it
+			const VkCommandBufferSubmitInfo commandBufferInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+				.commandBuffer = command_buffer,
+				.deviceMask = m_device_mask
+			};
+			InlineVector<VkSemaphoreSubmitInfo, 8> waitInfos;
+			for (const auto& wait_semaphore : wait_semaphores)
+				waitInfos.emplace_back(VkSemaphoreSubmitInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .semaphore = wait_semaphore.semaphore,
+					.value = wait_semaphore.value, .stageMask = wait_semaphore.stages ? wait_semaphore.stages : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT });
+			InlineVector<VkSemaphoreSubmitInfo, 8> signalInfos;
+			for (auto signal_semaphore : signal_semaphores)
+				signalInfos.emplace_back(VkSemaphoreSubmitInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .semaphore = signal_semaphore,
+					.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT });
+			assert(m_parent->m_context->m_physical_device_features13.synchronization2 && "Device masks of submissions need synchronization2!");
+			m_submitted_tick = m_submitted_timeline->Submit2({ &commandBufferInfo, 1 }, waitInfos, signalInfos, fence);
+		}
+		if (m_capture) m_parent->m_context->GetCommandCapture()->Submit(*m_capture);
+		for (auto& executed_command_buffer : m_executed_command_buffers)
+		{
+			// Recycled after this submission
+			executed_command_buffer->m_submitted_timeline = m_submitted_timeline;
+			executed_command_buffer->m_submitted_tick = m_submitted_tick;
+		}
+		m_executed_command_buffers.clear();
+		return m_submitted_tick;
+	}
+
+	void CommandBuffer::SetDeviceMask(uint32_t device_mask, bool split_render_areas/* = false*/)
+	{
+		const uint32_t allDevices = m_parent->m_context->GetAllDevicesMask();
+		assert(!(device_mask & ~allDevices) && "The device mask has devices beyond the group!");
+		m_split_render_areas = split_render_areas;
+		if (IsRecording())
+		{
+			assert(!(device_mask & ~(m_device_mask ? m_device_mask : allDevices)) && "The device mask must be a subset of the one at Begin()!");
+			if (allDevices != 1) m_dispatch->vkCmdSetDeviceMask(command_buffer, device_mask ? device_mask : allDevices);
+		}
+		else m_device_mask = device_mask;
+		m_current_device_mask = device_mask;
+	}
+
+	void CommandBuffer::DrawMeshTasks(uint32_t group_count_x, uint32_t group_count_y/* = 1*/, uint32_t group_count_z/* = 1*/)
+	{
+		assert(IsRecording() && m_parent->m_context->m_cmd_draw_mesh_tasks && "Mesh shaders are not supported by this device!");
+		FlushBarriers();
+		++m_statistics.draws;
+		m_parent->m_context->m_cmd_draw_mesh_tasks(command_buffer, group_count_x, group_count_y, group_count_z);
+	}
+
+	void CommandBuffer::DrawMeshTasksIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride/* = sizeof(VkDrawMeshTasksIndirectCommandEXT)*/)
+	{
+		assert(IsRecording() && m_parent->m_context->m_cmd_draw_mesh_tasks_indirect && "Mesh shaders are not supported by this device!");
+		FlushBarriers();
+		track_dependency(buffer);
+		++m_statistics.draws;
+		m_parent->m_context->m_cmd_draw_mesh_tasks_indirect(command_buffer, buffer, offset, draw_count, stride);
+	}
+
+	void CommandBuffer::DrawMeshTasksIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer count_buffer, VkDeviceSize count_offset,
+		uint32_t max_draw_count, uint32_t stride/* = sizeof(VkDrawMeshTasksIndirectCommandEXT)*/)
+	{
+		assert(IsRecording() && m_parent->m_context->m_cmd_draw_mesh_tasks_indirect_count && "Mesh shaders are not supported by this device!");
+		assert(m_parent->m_context->m_physical_device_features12.drawIndirectCount && "drawIndirectCount is not supported by this device!");
+		FlushBarriers();
+		track_dependency(buffer);
+		track_dependency(count_buffer);
+		++m_statistics.draws;
+		m_parent->m_context->m_cmd_draw_mesh_tasks_indirect_count(command_buffer, buffer, offset, count_buffer, count_offset, max_draw_count, stride);
+	}
+
+	void CommandBuffer::BeginConditional(VkBuffer predicate_buffer, VkDeviceSize offset/* = 0*/, bool inverted/* = false*/)
+	{
+		assert(IsRecording() && m_parent->m_context->m_cmd_begin_conditional_rendering && "Conditional rendering is not supported by this device!");
+		assert(!m_is_conditional && "You cannot nest BeginConditional()!");
+		assert(offset % 4 == 0 && "The predicate offset must be a multiple of 4!");
+		FlushBarriers(); // The barrier of the predicate may still be queued
+		track_dependency(predicate_buffer);
+		VkConditionalRenderingBeginInfoEXT conditionalRenderingBeginInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT,
+			.buffer = predicate_buffer,
+			.offset = offset,
+			.flags = inverted ? VK_CONDITIONAL_RENDERING_INVERTED_BIT_EXT : VkConditionalRenderingFlagsEXT(0)
+		};
+		m_parent->m_context->m_cmd_begin_conditional_rendering(command_buffer, &conditionalRenderingBeginInfo);
+		m_is_conditional = true;
+	}
+
+	void CommandBuffer::EndConditional()
+	{
+		assert(IsRecording() && m_is_conditional && "You must BeginConditional() before EndConditional()!");
+		m_parent->m_context->m_cmd_end_conditional_rendering(command_buffer);
+		m_is_conditional = false;
+	}
+
+	void CommandBuffer::SetFragmentShadingRate(VkExtent2D fragment_size,
+		VkFragmentShadingRateCombinerOpKHR primitive_combiner/* = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR*/,
+		VkFragmentShadingRateCombinerOpKHR attachment_combiner/* = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR*/)
+	{
+		assert(IsRecording() && m_parent->m_context->m_cmd_set_fragment_shading_rate && "Fragment shading rates are not supported by this device!");
+		assert(std::has_single_bit(fragment_size.width) && fragment_size.width <= 4 &&
+			std::has_single_bit(fragment_size.height) && fragment_size.height <= 4 && "Fragment sizes are 1, 2 or 4 texels!");
+		const VkFragmentShadingRateCombinerOpKHR combinerOps[2]{ primitive_combiner, attachment_combiner };
+		m_parent->m_context->m_cmd_set_fragment_shading_rate(command_buffer, &fragment_size, combinerOps);
+	}
+
+	namespace
+	{
+		size_t get_bind_point_slot(VkPipelineBindPoint bind_point)
+		{
+			assert((bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS || bind_point == VK_PIPELINE_BIND_POINT_COMPUTE) && "Unsupported bind point!");
+			return bind_point == VK_PIPELINE_BIND_POINT_COMPUTE ? 1 : 0;
+		}
+
+		// Captured barriers: One global barrier covering the stages and accesses of a batch
+		VkMemoryBarrier2 union_barriers(const std::vector<VkImageMemoryBarrier2>& image_barriers,
+			const std::vector<VkBufferMemoryBarrier2>& buffer_barriers,
+			const std::vector<VkMemoryBarrier2>& memory_barriers)
+		{
+			VkMemoryBarrier2 memoryBarrier{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+			auto merge = [&memoryBarrier](const auto& barrier)
+			{
+				memoryBarrier.srcStageMask |= barrier.srcStageMask;
+				memoryBarrier.srcAccessMask |= barrier.srcAccessMask;
+				memoryBarrier.dstStageMask |= barrier.dstStageMask;
+				memoryBarrier.dstAccessMask |= barrier.dstAccessMask;
+			};
+			for (const auto& image_barrier : image_barriers) merge(image_barrier);
+			for (const auto& buffer_barrier : buffer_barriers) merge(buffer_barrier);
+			for (const auto& memory_barrier : memory_barriers) merge(memory_barrier);
+			return memoryBarrier;
+		}
+	} // namespace
+
+	void CommandBuffer::BindPipeline(VkPipelineBindPoint bind_point, VkPipeline pipeline)
+	{
+		auto& boundPipeline = m_bindings.pipelines[get_bind_point_slot(bind_point)];
+		if (boundPipeline == pipeline) { ++m_statistics.redundant_binds; return; }
+		boundPipeline = pipeline;
+		if (bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS) m_bindings.shaders.clear();
+		track_dependency(pipeline);
+		++m_statistics.pipeline_binds;
+		capture(CaptureOpcode::BIND_PIPELINE, bind_point, pipeline);
+		m_dispatch->vkCmdBindPipeline(command_buffer, bind_point, pipeline);
+	}
+
+	void CommandBuffer::BindShaders(std::span<const VkShaderStageFlagBits> stages, std::span<const VkShaderEXT> shaders)
+	{
+		assert(IsRecording() && m_parent->m_context->m_cmd_bind_shaders && "Shader objects are not supported by this device!");
+		assert(stages.size() == shaders.size() && "Every stage needs a shader (or VK_NULL_HANDLE)!");
+		auto& boundShaders = m_bindings.shaders;
+		bool isBound = m_bindings.pipelines[0] == VK_NULL_HANDLE && boundShaders.size() == stages.size();
+		for (size_t index = 0; isBound && index < stages.size(); ++index)
+			isBound = boundShaders[index].first == stages[index] && boundShaders[index].second == shaders[index];
+		if (isBound) { ++m_statistics.redundant_binds; return; }
+		boundShaders.clear();
+		for (size_t index = 0; index < stages.size(); ++index) boundShaders.emplace_back(stages[index], shaders[index]);
+		m_bindings.pipelines[0] = VK_NULL_HANDLE; // The next graphics BindPipeline() is recorded again
+		++m_statistics.pipeline_binds;
+		m_parent->m_context->m_cmd_bind_shaders(command_buffer, static_cast<uint32_t>(stages.size()), stages.data(), shaders.data());
+	}
+
+	void CommandBuffer::BindDescriptorSets(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t first_set,
+		const std::vector<VkDescriptorSet>& descriptor_sets, const std::vector<uint32_t>& dynamic_offsets/* = {}*/)
+	{
+		if (descriptor_sets.empty()) return;
+		auto& boundSets = m_bindings.descriptor_sets[get_bind_point_slot(bind_point)];
+		if (dynamic_offsets.empty() && first_set + descriptor_sets.size() <= boundSets.size() &&
+			std::equal(descriptor_sets.begin(), descriptor_sets.end(), boundSets.begin() + first_set,
+				[layout](VkDescriptorSet descriptor_set, const auto& bound) { return bound.layout == layout && bound.descriptor_set == descriptor_set; }))
+		{
+			++m_statistics.redundant_binds;
+			return;
+		}
+
+		// Sets bound with another layout may have been disturbed (Compatibility is not tracked)
+		for (auto& bound_set : boundSets) if (bound_set.layout != layout) bound_set = {};
+		if (boundSets.size() < first_set + descriptor_sets.size()) boundSets.resize(first_set + descriptor_sets.size());
+		for (size_t i = 0; i < descriptor_sets.size(); ++i)
+		{
+			boundSets[first_set + i] = { .layout = layout, .descriptor_set = dynamic_offsets.empty() ? descriptor_sets[i] : VK_NULL_HANDLE };
+			track_dependency(descriptor_sets[i]);
+		}
+		++m_statistics.descriptor_set_binds;
+		capture(CaptureOpcode::BIND_DESCRIPTOR_SETS, bind_point, layout, first_set, descriptor_sets, dynamic_offsets);
+		m_dispatch->vkCmdBindDescriptorSets(command_buffer, bind_point, layout, first_set,
+			static_cast<uint32_t>(descriptor_sets.size()), descriptor_sets.data(),
+			static_cast<uint32_t>(dynamic_offsets.size()), dynamic_offsets.data());
+	}
+
+	void CommandBuffer::PushDescriptors(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set, const std::vector<VkWriteDescriptorSet>& writes)
+	{
+		assert(m_parent->m_context->IsPushDescriptorSupported() && "Push descriptors are not supported by this device!");
+		if (writes.empty()) return;
+		// The pushed set replaces the bound one (Sets bound with another layout may have been disturbed)
+		auto& boundSets = m_bindings.descriptor_sets[get_bind_point_slot(bind_point)];
+		for (auto& bound_set : boundSets) if (bound_set.layout != layout) bound_set = {};
+		if (set < boundSets.size()) boundSets[set] = {};
+		++m_statistics.descriptor_pushes;
+		m_parent->m_context->m_cmd_push_descriptor_set(command_buffer, bind_point, layout, set,
+			static_cast<uint32_t>(writes.size()), writes.data());
+	}
+
+	void CommandBuffer::PushDescriptors(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set, DescriptorWriteBatch& writes)
+	{
+		if (writes.m_writes.empty()) return;
+		writes.patch_writes();
+		PushDescriptors(bind_point, layout, set, writes.m_writes);
+		writes.clear();
+	}
+
+	void CommandBuffer::BindDescriptorBuffer(VkDeviceAddress address, VkBufferUsageFlags usage)
+	{
+		assert(m_parent->m_context->IsDescriptorBufferSupported() && "Descriptor buffers are not supported by this device!");
+		if (m_bindings.descriptor_buffer == address) { ++m_statistics.redundant_binds; return; }
+		m_bindings.descriptor_buffer = address;
+		m_bindings.descriptor_sets = {}; // Disturbed
+		VkDescriptorBufferBindingInfoEXT descriptorBufferBindingInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+			.address = address,
+			.usage = usage
+		};
+		m_parent->m_context->m_cmd_bind_descriptor_buffers(command_buffer, 1, &descriptorBufferBindingInfo);
+	}
+
+	void CommandBuffer::SetDescriptorBufferOffsets(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t first_set, const std::vector<VkDeviceSize>& offsets)
+	{
+		assert(m_bindings.descriptor_buffer != 0 && "Bind the descriptor buffer first!");
+		if (offsets.empty()) return;
+		// Offsets are not tracked (Sets bound with another layout may have been disturbed)
+		auto& boundSets = m_bindings.descriptor_sets[get_bind_point_slot(bind_point)];
+		for (auto& bound_set : boundSets) if (bound_set.layout != layout) bound_set = {};
+		for (size_t i = first_set; i < std::min(boundSets.size(), first_set + offsets.size()); ++i) boundSets[i] = {};
+		const std::vector<uint32_t> bufferIndices(offsets.size(), 0); // One bound descriptor buffer
+		++m_statistics.descriptor_set_binds;
+		m_parent->m_context->m_cmd_set_descriptor_buffer_offsets(command_buffer, bind_point, layout, first_set,
+			static_cast<uint32_t>(offsets.size()), bufferIndices.data(), offsets.data());
+	}
+
+	void CommandBuffer::BindVertexBuffers(uint32_t first_binding, const std::vector<VkBuffer>& buffers, const std::vector<VkDeviceSize>& offsets)
+	{
+		assert(buffers.size() == offsets.size() && "Every vertex buffer needs an offset!");
+		if (buffers.empty()) return;
+		auto& boundBuffers = m_bindings.vertex_buffers;
+		bool isRedundant = first_binding + buffers.size() <= boundBuffers.size();
+		for (size_t i = 0; isRedundant && i < buffers.size(); ++i)
+			isRedundant = boundBuffers[first_binding + i] == std::pair{ buffers[i], offsets[i] };
+		if (isRedundant) { ++m_statistics.redundant_binds; return; }
+
+		if (boundBuffers.size() < first_binding + buffers.size()) boundBuffers.resize(first_binding + buffers.size());
+		for (size_t i = 0; i < buffers.size(); ++i)
+		{
+			boundBuffers[first_binding + i] = { buffers[i], offsets[i] };
+			track_dependency(buffers[i]);
+		}
+		++m_statistics.vertex_buffer_binds;
+		capture(CaptureOpcode::BIND_VERTEX_BUFFERS, first_binding, buffers, offsets);
+		m_dispatch->vkCmdBindVertexBuffers(command_buffer, first_binding, static_cast<uint32_t>(buffers.size()), buffers.data(), offsets.data());
+	}
+
+	void CommandBuffer::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type)
+	{
+		if (m_bindings.index_buffer == buffer && m_bindings.index_offset == offset && m_bindings.index_type == index_type)
+		{
+			++m_statistics.redundant_binds;
+			return;
+		}
+		m_bindings.index_buffer = buffer;
+		m_bindings.index_offset = offset;
+		m_bindings.index_type = index_type;
+		track_dependency(buffer);
+		++m_statistics.index_buffer_binds;
+		capture(CaptureOpcode::BIND_INDEX_BUFFER, buffer, offset, index_type);
+		m_dispatch->vkCmdBindIndexBuffer(command_buffer, buffer, offset, index_type);
+	}
+
+	void CommandBuffer::PushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data)
+	{
+		auto& pushConstants = m_bindings.push_constants;
+		if (m_bindings.push_constant_layout != layout)
+		{
+			m_bindings.push_constant_layout = layout;
+			pushConstants.clear();
+		}
+		auto bytes = static_cast<const uint8_t*>(data);
+		for (const auto& push_constant : pushConstants)
+		{
+			if (push_constant.stages == stages && push_constant.offset == offset && push_constant.data.size() == size &&
+				!memcmp(push_constant.data.data(), bytes, size)) { ++m_statistics.redundant_binds; return; }
+		}
+
+		// Forget the overlapped ranges
+		std::erase_if(pushConstants, [offset, size](const auto& push_constant)
+			{ return push_constant.offset < offset + size && offset < push_constant.offset + push_constant.data.size(); });
+		pushConstants.emplace_back(BindingFilter::PushConstantRange{ .stages = stages, .offset = offset, .data = { bytes, bytes + size } });
+		++m_statistics.push_constants;
+		capture(CaptureOpcode::PUSH_CONSTANTS, layout, stages, offset, std::span<const uint8_t>{ bytes, size });
+		m_dispatch->vkCmdPushConstants(command_buffer, layout, stages, offset, size, data);
+	}
+
+	void CommandBuffer::Draw(uint32_t vertex_count, uint32_t instance_count/* = 1*/, uint32_t first_vertex/* = 0*/, uint32_t first_instance/* = 0*/)
+	{
+		FlushBarriers();
+		++m_statistics.draws;
+		capture(CaptureOpcode::DRAW, vertex_count, instance_count, first_vertex, first_instance);
+		m_dispatch->vkCmdDraw(command_buffer, vertex_count, instance_count, first_vertex, first_instance);
+	}
+
+	void CommandBuffer::DrawIndexed(uint32_t index_count, uint32_t instance_count/* = 1*/, uint32_t first_index/* = 0*/, int32_t vertex_offset/* = 0*/, uint32_t first_instance/* = 0*/)
+	{
+		FlushBarriers();
+		++m_statistics.draws;
+		capture(CaptureOpcode::DRAW_INDEXED, index_count, instance_count, first_index, vertex_offset, first_instance);
+		m_dispatch->vkCmdDrawIndexed(command_buffer, index_count, instance_count, first_index, vertex_offset, first_instance);
+	}
+
+	void CommandBuffer::DrawIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride, bool indexed/* = false*/)
+	{
+		FlushBarriers();
+		track_dependency(buffer);
+		++m_statistics.draws;
+		capture(CaptureOpcode::DRAW_INDIRECT, buffer, offset, draw_count, stride, indexed);
+		if (indexed) m_dispatch->vkCmdDrawIndexedIndirect(command_buffer, buffer, offset, draw_count, stride);
+		else m_dispatch->vkCmdDrawIndirect(command_buffer, buffer, offset, draw_count, stride);
+	}
+
+	void CommandBuffer::DrawIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer count_buffer, VkDeviceSize count_offset,
+		uint32_t max_draw_count, uint32_t stride, bool indexed/* = false*/)
+	{
+		FlushBarriers();
+		track_dependency(buffer);
+		track_dependency(count_buffer);
+		++m_statistics.draws;
+		capture(CaptureOpcode::DRAW_INDIRECT_COUNT, buffer, offset, count_buffer, count_offset, max_draw_count, stride, indexed);
+		if (indexed) m_dispatch->vkCmdDrawIndexedIndirectCount(command_buffer, buffer, offset, count_buffer, count_offset, max_draw_count, stride);
+		else m_dispatch->vkCmdDrawIndirectCount(command_buffer, buffer, offset, count_buffer, count_offset, max_draw_count, stride);
+	}
+
+	void CommandBuffer::DrawMulti(std::span<const VkMultiDrawInfoEXT> draws, uint32_t instance_count/* = 1*/, uint32_t first_instance/* = 0*/)
+	{
+		if (draws.empty()) return;
+		FlushBarriers();
+		capture(CaptureOpcode::DRAW_MULTI, instance_count, first_instance, draws);
+		auto& context = *m_parent->m_context;
+		if (!context.m_cmd_draw_multi)
+		{
+			for (const auto& draw : draws) m_dispatch->vkCmdDraw(command_buffer, draw.vertexCount, instance_count, draw.firstVertex, first_instance);
+			m_statistics.draws += draws.size();
+			return;
+		}
+		const size_t maxDrawCount = context.m_physical_device_multi_draw_properties.maxMultiDrawCount;
+		for (size_t first = 0; first < draws.size(); first += maxDrawCount)
+		{
+			const auto drawCount = static_cast<uint32_t>(std::min(draws.size() - first, maxDrawCount));
+			++m_statistics.draws;
+			context.m_cmd_draw_multi(command_buffer, drawCount, draws.data() + first, instance_count, first_instance, sizeof(VkMultiDrawInfoEXT));
+		}
+	}
+
+	void CommandBuffer::DrawMultiIndexed(std::span<const VkMultiDrawIndexedInfoEXT> draws, uint32_t instance_count/* = 1*/, uint32_t first_instance/* = 0*/)
+	{
+		if (draws.empty()) return;
+		FlushBarriers();
+		capture(CaptureOpcode::DRAW_MULTI_INDEXED, instance_count, first_instance, draws);
+		auto& context = *m_parent->m_context;
+		if (!context.m_cmd_draw_multi_indexed)
+		{
+			for (const auto& draw : draws)
+				m_dispatch->vkCmdDrawIndexed(command_buffer, draw.indexCount, instance_count, draw.firstIndex, draw.vertexOffset, first_instance);
+			m_statistics.draws += draws.size();
+			return;
+		}
+		const size_t maxDrawCount = context.m_physical_device_multi_draw_properties.maxMultiDrawCount;
+		for (size_t first = 0; first < draws.size(); first += maxDrawCount)
+		{
+			const auto drawCount = static_cast<uint32_t>(std::min(draws.size() - first, maxDrawCount));
+			++m_statistics.draws;
+			context.m_cmd_draw_multi_indexed(command_buffer, drawCount, draws.data() + first, instance_count, first_instance,
+				sizeof(VkMultiDrawIndexedInfoEXT), nullptr /*Per-draw vertex offsets*/);
+		}
+	}
+
+	void CommandBuffer::Dispatch(uint32_t group_count_x, uint32_t group_count_y/* = 1*/, uint32_t group_count_z/* = 1*/)
+	{
+		FlushBarriers();
+		++m_statistics.dispatches;
+		capture(CaptureOpcode::DISPATCH, group_count_x, group_count_y, group_count_z);
+		m_dispatch->vkCmdDispatch(command_buffer, group_count_x, group_count_y, group_count_z);
+	}
+
+	void CommandBuffer::SetViewports(const std::vector<VkViewport>& viewports)
+	{
+		if (viewports.size() == m_dynamic_state.viewports.size() &&
+			(viewports.empty() || !memcmp(viewports.data(), m_dynamic_state.viewports.data(), viewports.size() * sizeof(VkViewport)))) return;
+		m_dynamic_state.viewports = viewports;
+		capture(CaptureOpcode::SET_VIEWPORTS, viewports);
+		m_dispatch->vkCmdSetViewportWithCount(command_buffer, static_cast<uint32_t>(viewports.size()), viewports.data());
+	}
+
+	void CommandBuffer::SetScissors(const std::vector<VkRect2D>& scissors)
+	{
+		if (scissors.size() == m_dynamic_state.scissors.size() &&
+			(scissors.empty() || !memcmp(scissors.data(), m_dynamic_state.scissors.data(), scissors.size() * sizeof(VkRect2D)))) return;
+		m_dynamic_state.scissors = scissors;
+		capture(CaptureOpcode::SET_SCISSORS, scissors);
+		m_dispatch->vkCmdSetScissorWithCount(command_buffer, static_cast<uint32_t>(scissors.size()), scissors.data());
+	}
+
+	void CommandBuffer::SetCullMode(VkCullModeFlags cull_mode)
+	{
+		if (m_dynamic_state.cull_mode == cull_mode) return;
+		m_dynamic_state.cull_mode = cull_mode;
+		capture(CaptureOpcode::SET_STATE, CaptureState::CULL_MODE, std::array<uint32_t, 5>{ static_cast<uint32_t>(cull_mode) });
+		m_dispatch->vkCmdSetCullMode(command_buffer, cull_mode);
+	}
+
+	void CommandBuffer::SetFrontFace(VkFrontFace front_face)
+	{
+		if (m_dynamic_state.front_face == front_face) return;
+		m_dynamic_state.front_face = front_face;
+		capture(CaptureOpcode::SET_STATE, CaptureState::FRONT_FACE, std::array<uint32_t, 5>{ static_cast<uint32_t>(front_face) });
+		m_dispatch->vkCmdSetFrontFace(command_buffer, front_face);
+	}
+
+	void CommandBuffer::SetPrimitiveTopology(VkPrimitiveTopology primitive_topology)
+	{
+		if (m_dynamic_state.primitive_topology == primitive_topology) return;
+		m_dynamic_state.primitive_topology = primitive_topology;
+		capture(CaptureOpcode::SET_STATE, CaptureState::PRIMITIVE_TOPOLOGY, std::array<uint32_t, 5>{ static_cast<uint32_t>(primitive_topology) });
+		m_dispatch->vkCmdSetPrimitiveTopology(command_buffer, primitive_topology);
+	}
+
+	void CommandBuffer::SetDepthTestEnable(bool enable)
+	{
+		if (m_dynamic_state.depth_test_enable == enable) return;
+		m_dynamic_state.depth_test_enable = enable;
+		capture(CaptureOpcode::SET_STATE, CaptureState::DEPTH_TEST_ENABLE, std::array<uint32_t, 5>{ static_cast<uint32_t>(enable) });
+		m_dispatch->vkCmdSetDepthTestEnable(command_buffer, enable ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetDepthWriteEnable(bool enable)
+	{
+		if (m_dynamic_state.depth_write_enable == enable) return;
+		m_dynamic_state.depth_write_enable = enable;
+		capture(CaptureOpcode::SET_STATE, CaptureState::DEPTH_WRITE_ENABLE, std::array<uint32_t, 5>{ static_cast<uint32_t>(enable) });
+		m_dispatch->vkCmdSetDepthWriteEnable(command_buffer, enable ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetDepthCompareOp(VkCompareOp compare_op)
+	{
+		if (m_dynamic_state.depth_compare_op == compare_op) return;
+		m_dynamic_state.depth_compare_op = compare_op;
+		capture(CaptureOpcode::SET_STATE, CaptureState::DEPTH_COMPARE_OP, std::array<uint32_t, 5>{ static_cast<uint32_t>(compare_op) });
+		m_dispatch->vkCmdSetDepthCompareOp(command_buffer, compare_op);
+	}
+
+	void CommandBuffer::SetStencilTestEnable(bool enable)
+	{
+		if (m_dynamic_state.stencil_test_enable == enable) return;
+		m_dynamic_state.stencil_test_enable = enable;
+		capture(CaptureOpcode::SET_STATE, CaptureState::STENCIL_TEST_ENABLE, std::array<uint32_t, 5>{ static_cast<uint32_t>(enable) });
+		m_dispatch->vkCmdSetStencilTestEnable(command_buffer, enable ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetStencilOp(VkStencilFaceFlags faces, VkStencilOp fail_op, VkStencilOp pass_op, VkStencilOp depth_fail_op, VkCompareOp compare_op)
+	{
+		const std::array<uint32_t, 4> stencilOp{ static_cast<uint32_t>(fail_op), static_cast<uint32_t>(pass_op), static_cast<uint32_t>(depth_fail_op), static_cast<uint32_t>(compare_op) };
+		// Only the faces whose state changes are set
+		VkStencilFaceFlags changedFaces = 0;
+		if ((faces & VK_STENCIL_FACE_FRONT_BIT) && m_dynamic_state.stencil_ops[0] != stencilOp) changedFaces |= VK_STENCIL_FACE_FRONT_BIT;
+		if ((faces & VK_STENCIL_FACE_BACK_BIT) && m_dynamic_state.stencil_ops[1] != stencilOp) changedFaces |= VK_STENCIL_FACE_BACK_BIT;
+		if (!changedFaces) return;
+		if (changedFaces & VK_STENCIL_FACE_FRONT_BIT) m_dynamic_state.stencil_ops[0] = stencilOp;
+		if (changedFaces & VK_STENCIL_FACE_BACK_BIT) m_dynamic_state.stencil_ops[1] = stencilOp;
+		capture(CaptureOpcode::SET_STATE, CaptureState::STENCIL_OP, std::array<uint32_t, 5>{ changedFaces, stencilOp[0], stencilOp[1], stencilOp[2], stencilOp[3] });
+		m_dispatch->vkCmdSetStencilOp(command_buffer, changedFaces, fail_op, pass_op, depth_fail_op, compare_op);
+	}
+
+	void CommandBuffer::ExecuteCommands(const std::vector<std::shared_ptr<CommandBuffer>>& secondary_command_buffers)
+	{
+		assert(IsRecording() && "You must Begin() the command buffer before ExecuteCommands()!");
+		if (secondary_command_buffers.empty()) return;
+		FlushBarriers();
+
+		ScratchScope scratch;
+		std::pmr::vector<VkCommandBuffer> commandBuffers{ scratch.Resource() };
+		commandBuffers.reserve(secondary_command_buffers.size());
+		for (const auto& secondary_command_buffer : secondary_command_buffers)
+		{
+			assert(secondary_command_buffer->GetLevel() == VK_COMMAND_BUFFER_LEVEL_SECONDARY && "Only secondary command buffers can be executed!");
+			commandBuffers.emplace_back(*secondary_command_buffer);
+			m_executed_command_buffers.emplace_back(secondary_command_buffer);
+		}
+		m_dispatch->vkCmdExecuteCommands(command_buffer, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+	}
+
+	void CommandBuffer::PipelineBarrier(const std::vector<VkImageMemoryBarrier2>& image_barriers,
+		const std::vector<VkBufferMemoryBarrier2>& buffer_barriers/* = {}*/,
+		const std::vector<VkMemoryBarrier2>& memory_barriers/* = {}*/)
+	{
+		assert(IsRecording() && "You must Begin() the command buffer before PipelineBarrier()!");
+		for (const auto& image_barrier : image_barriers) QueueBarrier(image_barrier);
+		for (const auto& buffer_barrier : buffer_barriers) QueueBarrier(buffer_barrier);
+		for (const auto& memory_barrier : memory_barriers) QueueBarrier(memory_barrier);
+		FlushBarriers();
+	}
+
+	void CommandBuffer::FlushBarriers()
+	{
+		if (m_queued_barriers.empty()) return;
+		assert(IsRecording() && "You must Begin() the command buffer before FlushBarriers()!");
+		m_statistics.barriers += m_queued_barriers.image_barriers.size() + m_queued_barriers.buffer_barriers.size() + m_queued_barriers.memory_barriers.size();
+		if (m_capture) capture(CaptureOpcode::BARRIER,
+			union_barriers(m_queued_barriers.image_barriers, m_queued_barriers.buffer_barriers, m_queued_barriers.memory_barriers),
+			static_cast<uint32_t>(m_queued_barriers.image_barriers.size() + m_queued_barriers.buffer_barriers.size() + m_queued_barriers.memory_barriers.size()));
+		record_barriers(command_buffer, *m_parent->m_context,
+			BarrierCommand::PIPELINE_BARRIER, VK_NULL_HANDLE,
+			m_queued_barriers.image_barriers, m_queued_barriers.buffer_barriers, m_queued_barriers.memory_barriers);
+		m_queued_barriers.clear();
+	}
+
+	void CommandBuffer::SetBarrierEvent(VkEvent event)
+	{
+		assert(IsRecording() && "You must Begin() the command buffer before SetBarrierEvent()!");
+		assert(std::none_of(m_split_barriers.begin(), m_split_barriers.end(), [event](const auto& split_barrier) { return split_barrier.first == event; }) &&
+			"This event is still waiting for its split barriers!");
+		record_barriers(command_buffer, *m_parent->m_context,
+			BarrierCommand::SET_EVENT, event,
+			m_queued_barriers.image_barriers, m_queued_barriers.buffer_barriers, m_queued_barriers.memory_barriers);
+		m_split_barriers.emplace_back(event, std::move(m_queued_barriers));
+		m_queued_barriers = {};
+	}
+
+	void CommandBuffer::WaitBarrierEvent(VkEvent event)
+	{
+		assert(IsRecording() && "You must Begin() the command buffer before WaitBarrierEvent()!");
+		auto target = std::find_if(m_split_barriers.begin(), m_split_barriers.end(), [event](const auto& split_barrier) { return split_barrier.first == event; });
+		if (target == m_split_barriers.end()) throw std::runtime_error("Failed to wait the Vulkan Event - It was not set by SetBarrierEvent()!");
+
+		FlushBarriers(); // Keep the recording order
+		const auto& batch = target->second;
+		m_statistics.barriers += batch.image_barriers.size() + batch.buffer_barriers.size() + batch.memory_barriers.size();
+		if (m_capture) capture(CaptureOpcode::BARRIER, union_barriers(batch.image_barriers, batch.buffer_barriers, batch.memory_barriers),
+			static_cast<uint32_t>(batch.image_barriers.size() + batch.buffer_barriers.size() + batch.memory_barriers.size()));
+		record_barriers(command_buffer, *m_parent->m_context,
+			BarrierCommand::WAIT_EVENT, event,
+			batch.image_barriers, batch.buffer_barriers, batch.memory_barriers);
+		m_split_barriers.erase(target);
+	}
+
+	void CommandBuffer::PipelineBarrier(VkCommandBuffer command_buffer, const VulkanContext& vulkan_context,
+		const std::vector<VkImageMemoryBarrier2>& image_barriers,
+		const std::vector<VkBufferMemoryBarrier2>& buffer_barriers/* = {}*/,
+		const std::vector<VkMemoryBarrier2>& memory_barriers/* = {}*/)
+	{
+		if (image_barriers.empty() && buffer_barriers.empty() && memory_barriers.empty()) return;
+		record_barriers(command_buffer, vulkan_context,
+			BarrierCommand::PIPELINE_BARRIER, VK_NULL_HANDLE, image_barriers, buffer_barriers, memory_barriers);
+	}
+
+	void CommandBuffer::record_barriers(VkCommandBuffer command_buffer, const VulkanContext& vulkan_context, BarrierCommand command, VkEvent event,
+		const std::vector<VkImageMemoryBarrier2>& image_barriers,
+		const std::vector<VkBufferMemoryBarrier2>& buffer_barriers,
+		const std::vector<VkMemoryBarrier2>& memory_barriers)
+	{
+		const auto& dispatch = vulkan_context.m_dispatch;
+		if (vulkan_context.m_physical_device_features13.synchronization2)
+		{
+			VkDependencyInfo dependencyInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.memoryBarrierCount = static_cast<uint32_t>(memory_barriers.size()),
+				.pMemoryBarriers = memory_barriers.data(),
+				.bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size()),
+				.pBufferMemoryBarriers = buffer_barriers.data(),
+				.imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+				.pImageMemoryBarriers = image_barriers.data()
+			};
+			switch (command)
+			{
+			case BarrierCommand::PIPELINE_BARRIER:	dispatch.vkCmdPipelineBarrier2(command_buffer, &dependencyInfo); break;
+			case BarrierCommand::SET_EVENT:				dispatch.vkCmdSetEvent2(command_buffer, event, &dependencyInfo); break;
+			case BarrierCommand::WAIT_EVENT:			dispatch.vkCmdWaitEvents2(command_buffer, 1, &event, &dependencyInfo); break;
+			}
+			return;
+		}
+
+		// Legacy barriers share one stage mask pair
+		VkPipelineStageFlags srcStages = 0, dstStages = 0;
+		ScratchScope scratch;
+		std::pmr::vector<VkMemoryBarrier> memoryBarriers{ scratch.Resource() };
+		std::pmr::vector<VkBufferMemoryBarrier> bufferBarriers{ scratch.Resource() };
+		std::pmr::vector<VkImageMemoryBarrier> imageBarriers{ scratch.Resource() };
+		memoryBarriers.reserve(memory_barriers.size());
+		bufferBarriers.reserve(buffer_barriers.size());
+		imageBarriers.reserve(image_barriers.size());
+		for (const auto& barrier : memory_barriers)
+		{
+			srcStages |= ResourceAccess::ToLegacyStages(barrier.srcStageMask);
+			dstStages |= ResourceAccess::ToLegacyStages(barrier.dstStageMask);
+			memoryBarriers.emplace_back(VkMemoryBarrier
+				{
+					.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+					.srcAccessMask = ResourceAccess::ToLegacyAccess(barrier.srcAccessMask),
+					.dstAccessMask = ResourceAccess::ToLegacyAccess(barrier.dstAccessMask)
+				});
+		}
+		for (const auto& barrier : buffer_barriers)
+		{
+			srcStages |= ResourceAccess::ToLegacyStages(barrier.srcStageMask);
+			dstStages |= ResourceAccess::ToLegacyStages(barrier.dstStageMask);
+			bufferBarriers.emplace_back(VkBufferMemoryBarrier
+				{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+					.srcAccessMask = ResourceAccess::ToLegacyAccess(barrier.srcAccessMask),
+					.dstAccessMask = ResourceAccess::ToLegacyAccess(barrier.dstAccessMask),
+					.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+					.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+					.buffer = barrier.buffer,
+					.offset = barrier.offset,
+					.size = barrier.size
+				});
+		}
+		for (const auto& barrier : image_barriers)
+		{
+			srcStages |= ResourceAccess::ToLegacyStages(barrier.srcStageMask);
+			dstStages |= ResourceAccess::ToLegacyStages(barrier.dstStageMask);
+			imageBarriers.emplace_back(VkImageMemoryBarrier
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+					.srcAccessMask = ResourceAccess::ToLegacyAccess(barrier.srcAccessMask),
+					.dstAccessMask = ResourceAccess::ToLegacyAccess(barrier.dstAccessMask),
+					.oldLayout = barrier.oldLayout,
+					.newLayout = barrier.newLayout,
+					.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+					.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+					.image = barrier.image,
+					.subresourceRange = barrier.subresourceRange
+				});
+		}
+		if (!srcStages) srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		if (!dstStages) dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+		switch (command)
+		{
+		case BarrierCommand::PIPELINE_BARRIER:
+			dispatch.vkCmdPipelineBarrier(command_buffer, srcStages, dstStages, 0x0,
+				static_cast<uint32_t>(memoryBarriers.size()), memoryBarriers.data(),
+				static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+				static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+			break;
+		case BarrierCommand::SET_EVENT: // Legacy events only carry the source stages
+			dispatch.vkCmdSetEvent(command_buffer, event, srcStages);
+			break;
+		case BarrierCommand::WAIT_EVENT:
+			dispatch.vkCmdWaitEvents(command_buffer, 1, &event, srcStages, dstStages,
+				static_cast<uint32_t>(memoryBarriers.size()), memoryBarriers.data(),
+				static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+				static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+			break;
+		}
+	}
+
+	CommandPool::CommandPool(
+		std::shared_ptr<VulkanContext> vulkan_context,
+		QueueFamilyIndex& submit_queue_family_index,
+		VkCommandPoolCreateFlags command_pool_flags,
+		uint32_t submit_queue_index/* = 0*/) :
+		m_context{ std::move(vulkan_context) },
+		m_queue_family_index{ submit_queue_family_index },
+		m_queue_index{ submit_queue_index },
+		m_submit_queue_family{ m_context->GetQueue(submit_queue_family_index, submit_queue_index) },
+		m_queue_timeline{ m_context->GetGlobalQueueTimeline(submit_queue_family_index, submit_queue_index) },
+		m_command_pool_flags{ command_pool_flags }
+	{
+		VkCommandPoolCreateInfo commandPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags = command_pool_flags,
+			.queueFamilyIndex = submit_queue_family_index.value()
+		};
+
+		if (vkCreateCommandPool(
+			m_context->m_device,
+			&commandPoolCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_command_pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Command Pool!");
+	}
+
+	CommandPool::~CommandPool()
+	{
+		assert(m_outstanding_command_buffers == 0 && "Destroy every Vulkan Command Buffer before its Command Pool!");
+		vkDestroyCommandPool(m_context->m_device, m_command_pool, m_context->m_memory_allocation_callback);
+	}
+
+	std::shared_ptr<CommandBuffer> CommandPool::
+		AllocateCommandBuffer(VkCommandBufferLevel level)
+	{
+		// Command buffers will be automatically freed when their command pool is destroyed
+		CommandBufferPolicy policy;
+		if (m_command_pool_flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+			policy = CommandBufferPolicy::RESET;
 		else if (m_command_pool_flags & VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)
+			policy = CommandBufferPolicy::ONE_TIME;
+		else throw std::runtime_error("Failed to allocate a proper Vulkan Command Buffer!");
+
+		auto commandbuffer = std::make_shared<CommandBuffer>(*this, level, policy);
+
+		commandbuffer->command_buffer = allocate(level);
+		return commandbuffer;
+	}
+
+	std::shared_ptr<CommandBufferBaked> CommandPool::
+		AllocateBakedCommandBuffer()
+	{
+		if (!(m_command_pool_flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT))
+			throw std::runtime_error("Baked Vulkan Command Buffers have to be allocated from a resettable command pool!");
+		auto commandbuffer = std::make_shared<CommandBufferBaked>(*this);
+		commandbuffer->command_buffer = allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+		return commandbuffer;
+	}
+
+	VkCommandBuffer CommandPool::allocate(VkCommandBufferLevel level)
+	{
+		VkCommandBuffer commandBuffer = acquire(level);
+		if (commandBuffer != VK_NULL_HANDLE) return commandBuffer;
+
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = m_command_pool,
+			.level = level,
+			.commandBufferCount = 1
+		};
+
+		if (vkAllocateCommandBuffers(
+			m_context->m_device, 
+			&commandBufferAllocateInfo, 
+			&commandBuffer) != VK_SUCCESS)
+		{
+			std::scoped_lock guard{ m_recycle_mutex };
+			--m_outstanding_command_buffers;
+			throw std::runtime_error("Failed to create the Vulkan Command Buffer!");
+		}
+
+		return commandBuffer;
+	}
+
+	void CommandPool::Reset()
+	{
+		std::scoped_lock guard{ m_recycle_mutex };
+		if (vkResetCommandPool(m_context->m_device, m_command_pool, 0) != VK_SUCCESS)
+			throw std::runtime_error("Failed to reset the Vulkan Command Pool!");
+
+		for (const auto& retired : m_retired_command_buffers)
+			m_free_command_buffers[retired.level].emplace_back(retired.command_buffer);
+		m_retired_command_buffers.clear();
+	}
+
+	VkCommandBuffer CommandPool::acquire(VkCommandBufferLevel level)
+	{
+		auto guard = lock_counting_contention(m_recycle_mutex, m_context->GetStatistics());
+		++m_outstanding_command_buffers;
+
+		auto& freeCommandBuffers = m_free_command_buffers[level];
+		if (freeCommandBuffers.empty()) reclaim();
+		if (freeCommandBuffers.empty()) return VK_NULL_HANDLE; // Allocate a new one
+
+		VkCommandBuffer commandBuffer = freeCommandBuffers.back();
+		freeCommandBuffers.pop_back();
+		return commandBuffer;
+	}
+
+	void CommandPool::recycle(VkCommandBuffer command_buffer, VkCommandBufferLevel level, QueueTimeline* timeline, uint64_t tick)
+	{
+		auto guard = lock_counting_contention(m_recycle_mutex, m_context->GetStatistics());
+		--m_outstanding_command_buffers;
+		m_retired_command_buffers.emplace_back(RetiredCommandBuffer{ command_buffer, level, timeline, tick });
+	}
+
+	RecordingStatistics CommandPool::TakeRecordingStatistics()
+	{
+		std::scoped_lock guard{ m_recycle_mutex };
+		return std::exchange(m_recording_statistics, {});
+	}
+
+	QueueTimeline& CommandPool::GetQueueTimeline(uint32_t queue_index)
+	{
+		if (queue_index == m_queue_index) return *m_queue_timeline;
+		return *m_context->GetGlobalQueueTimeline(m_queue_family_index, queue_index); // Cached by the context
+	}
+
+	void CommandPool::reclaim()
+	{
+		if (m_retired_command_buffers.empty()) return;
+
+		if (m_command_pool_flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+		{
+			// Reset individually in CommandBuffer::Begin()
+			std::erase_if(m_retired_command_buffers, [this](const RetiredCommandBuffer& retired)
+				{
+					if (!retired.timeline->IsComplete(retired.tick)) return false;
+					m_free_command_buffers[retired.level].emplace_back(retired.command_buffer);
+					return true;
+				});
+			return;
+		}
+
+		// Transient command buffers can only be reset with the whole pool
+		if (m_outstanding_command_buffers > 1) return; // Except the acquiring one
+		if (!std::all_of(m_retired_command_buffers.begin(), m_retired_command_buffers.end(),
+			[](const RetiredCommandBuffer& retired) { return retired.timeline->IsComplete(retired.tick); })) return;
+
+		if (vkResetCommandPool(m_context->m_device, m_command_pool, 0) != VK_SUCCESS)
+			throw std::runtime_error("Failed to reset the Vulkan Command Pool!");
+		for (const auto& retired : m_retired_command_buffers)
+			m_free_command_buffers[retired.level].emplace_back(retired.command_buffer);
+		m_retired_command_buffers.clear();
+	}
+
+	DescriptorSetLayout::DescriptorSetLayout(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		const std::vector<VkDescriptorSetLayoutBinding>& descriptor_bindings,
+		std::vector<std::shared_ptr<Sampler>> immutable_samplers/* = {}*/,
+		VkDescriptorSetLayoutCreateFlags flags/* = 0*/) :
+		m_context{ std::move(vulkan_context) },
+		m_flags{ flags },
+		m_bindings{ Normalize(descriptor_bindings) },
+		m_hash{ Hash(m_bindings, m_flags) },
+		m_immutable_sampler_owners{ std::move(immutable_samplers) }
+	{
+		// Own the immutable samplers (The caller's arrays are temporary)
+		m_immutable_samplers.resize(m_bindings.size());
+		for (size_t index = 0; index < m_bindings.size(); ++index)
+		{
+			auto& binding = m_bindings[index];
+			if (binding.pImmutableSamplers == nullptr) continue;
+			m_immutable_samplers[index].assign(binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+			binding.pImmutableSamplers = m_immutable_samplers[index].data();
+		}
+
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.flags = m_flags,
+			.bindingCount = static_cast<uint32_t>(m_bindings.size()),
+			.pBindings = m_bindings.data()
+		};
+
+		if (vkCreateDescriptorSetLayout(
+			m_context->m_device,
+			&descriptorSetLayoutCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_descriptor_set_layout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Descriptor Set Layout!");
+
+		if (IsDescriptorBuffer())
+		{
+			m_context->m_get_descriptor_set_layout_size(m_context->m_device, m_descriptor_set_layout, &m_descriptor_buffer_size);
+			m_descriptor_buffer_offsets.resize(m_bindings.size());
+			for (size_t index = 0; index < m_bindings.size(); ++index)
+				m_context->m_get_descriptor_set_layout_binding_offset(m_context->m_device, m_descriptor_set_layout, m_bindings[index].binding, &m_descriptor_buffer_offsets[index]);
+		}
+		create_update_template();
+	}
+
+	DescriptorSetLayout::~DescriptorSetLayout()
+	{
+		if (m_update_template != VK_NULL_HANDLE)
+			vkDestroyDescriptorUpdateTemplate(m_context->m_device, m_update_template, m_context->m_memory_allocation_callback);
+		vkDestroyDescriptorSetLayout(m_context->m_device, m_descriptor_set_layout, m_context->m_memory_allocation_callback);
+	}
+
+	void DescriptorSetLayout::create_update_template()
+	{
+		std::vector<VkDescriptorUpdateTemplateEntry> templateEntries;
+		templateEntries.reserve(m_bindings.size());
+		m_packed_indices.reserve(m_bindings.size());
+
+		for (const auto& binding : m_bindings)
+		{
+			m_packed_indices.emplace_back(m_packed_count);
+			if (binding.descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+				continue; // Bytes instead of descriptors (Not packed)
+
+			templateEntries.emplace_back(VkDescriptorUpdateTemplateEntry
+				{
+					.dstBinding = binding.binding,
+					.dstArrayElement = 0,
+					.descriptorCount = binding.descriptorCount,
+					.descriptorType = binding.descriptorType,
+					.offset = m_packed_count * sizeof(DescriptorInfo),
+					.stride = sizeof(DescriptorInfo)
+				});
+			m_packed_count += binding.descriptorCount;
+		}
+		// Push descriptor templates are bound to a pipeline layout (Push the writes instead), descriptor buffers are written by DescriptorBufferSet
+		if (templateEntries.empty() || IsPushDescriptor() || IsDescriptorBuffer()) return;
+
+		VkDescriptorUpdateTemplateCreateInfo descriptorUpdateTemplateCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+			.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size()),
+			.pDescriptorUpdateEntries = templateEntries.data(),
+			.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+			.descriptorSetLayout = m_descriptor_set_layout
+		};
+
+		if (vkCreateDescriptorUpdateTemplate(
+			m_context->m_device,
+			&descriptorUpdateTemplateCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_update_template) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Descriptor Update Template!");
+	}
+
+	void DescriptorSetLayout::
+		UpdateDescriptorSet(VkDescriptorSet descriptor_set, const void* packed_data) const
+	{
+		assert(m_update_template != VK_NULL_HANDLE && "This Descriptor Set Layout has nothing to update!");
+		vkUpdateDescriptorSetWithTemplate(m_context->m_device, descriptor_set, m_update_template, packed_data);
+	}
+
+	uint32_t DescriptorSetLayout::
+		GetPackedIndex(uint32_t binding) const
+	{
+		auto target = std::lower_bound(m_bindings.begin(), m_bindings.end(), binding,
+			[](const VkDescriptorSetLayoutBinding& layout_binding, uint32_t binding) { return layout_binding.binding < binding; });
+		assert(target != m_bindings.end() && target->binding == binding && "Binding is not in this Descriptor Set Layout!");
+		return m_packed_indices[std::distance(m_bindings.begin(), target)];
+	}
+
+	VkDeviceSize DescriptorSetLayout::
+		GetDescriptorBufferOffset(uint32_t binding) const
+	{
+		assert(IsDescriptorBuffer() && "Not a descriptor buffer layout!");
+		auto target = std::lower_bound(m_bindings.begin(), m_bindings.end(), binding,
+			[](const VkDescriptorSetLayoutBinding& layout_binding, uint32_t binding) { return layout_binding.binding < binding; });
+		assert(target != m_bindings.end() && target->binding == binding && "Binding is not in this Descriptor Set Layout!");
+		return m_descriptor_buffer_offsets[std::distance(m_bindings.begin(), target)];
+	}
+
+	std::vector<VkDescriptorSetLayoutBinding> DescriptorSetLayout::
+		Normalize(std::vector<VkDescriptorSetLayoutBinding> descriptor_bindings)
+	{
+		std::sort(descriptor_bindings.begin(), descriptor_bindings.end(),
+			[](const VkDescriptorSetLayoutBinding& prev, const VkDescriptorSetLayoutBinding& next)
+			{ return prev.binding < next.binding; });
+		return descriptor_bindings;
+	}
+
+	uint64_t DescriptorSetLayout::
+		Hash(const std::vector<VkDescriptorSetLayoutBinding>& normalized_bindings, VkDescriptorSetLayoutCreateFlags flags)
+	{
+		uint64_t hash = HashValue(flags);
+		for (const auto& binding : normalized_bindings)
+		{
+			hash = HashCombine(hash, DescriptorBinding::Hash{}(DescriptorBinding{ .set = 0, .binding = binding.binding }));
+			hash = HashCombine(hash, binding.descriptorType);
+			hash = HashCombine(hash, binding.descriptorCount);
+			hash = HashCombine(hash, binding.stageFlags);
+			if (binding.pImmutableSamplers) // Handles instead of the temporary array
+				hash = HashCombine(hash, HashBytes(binding.pImmutableSamplers, binding.descriptorCount * sizeof(VkSampler)));
+		}
+		return hash;
+	}
+
+	bool DescriptorSetLayout::
+		IsIdentical(const std::vector<VkDescriptorSetLayoutBinding>& normalized_bindings, VkDescriptorSetLayoutCreateFlags flags) const
+	{
+		return m_flags == flags && std::equal(m_bindings.begin(), m_bindings.end(), normalized_bindings.begin(), normalized_bindings.end(),
+			[](const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs)
+			{
+				return lhs.binding == rhs.binding &&
+					lhs.descriptorType == rhs.descriptorType &&
+					lhs.descriptorCount == rhs.descriptorCount &&
+					lhs.stageFlags == rhs.stageFlags &&
+					(lhs.pImmutableSamplers == nullptr) == (rhs.pImmutableSamplers == nullptr) &&
+					(lhs.pImmutableSamplers == nullptr || std::equal(lhs.pImmutableSamplers, lhs.pImmutableSamplers + lhs.descriptorCount, rhs.pImmutableSamplers));
+			});
+	}
+
+	bool DescriptorSetLayout::
+		HasImmutableSamplers(uint32_t binding) const
+	{
+		auto target = std::lower_bound(m_bindings.begin(), m_bindings.end(), binding,
+			[](const VkDescriptorSetLayoutBinding& layout_binding, uint32_t binding) { return layout_binding.binding < binding; });
+		return target != m_bindings.end() && target->binding == binding && target->pImmutableSamplers != nullptr;
+	}
+
+	std::shared_ptr<Sampler> DescriptorSetLayout::
+		GetImmutableSampler(uint32_t binding) const
+	{
+		auto target = std::lower_bound(m_bindings.begin(), m_bindings.end(), binding,
+			[](const VkDescriptorSetLayoutBinding& layout_binding, uint32_t binding) { return layout_binding.binding < binding; });
+		if (target == m_bindings.end() || target->binding != binding || target->pImmutableSamplers == nullptr) return nullptr;
+		auto owner = std::find_if(m_immutable_sampler_owners.begin(), m_immutable_sampler_owners.end(),
+			[handle = target->pImmutableSamplers[0]](const auto& sampler) { return static_cast<VkSampler>(*sampler) == handle; });
+		return owner != m_immutable_sampler_owners.end() ? *owner : nullptr;
+	}
+
+	DescriptorPool::DescriptorPool(std::shared_ptr<RHI::VulkanContext> vulkan_context, 
+		const std::vector<VkDescriptorPoolSize>& pool_size, uint32_t limit_max_sets,
+		VkDescriptorPoolCreateFlags flags/* = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT*/) :
+		m_context{ std::move(vulkan_context) },
+		m_flags{ flags }
+	{
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.flags = m_flags,
+			.maxSets = limit_max_sets,
+			.poolSizeCount = static_cast<uint32_t>(pool_size.size()),
+			.pPoolSizes = pool_size.data()
+		};
+		if (vkCreateDescriptorPool(
+			m_context->m_device,
+			&descriptorPoolCreateInfo,
+			m_context->m_memory_allocation_callback,
+			&m_descriptor_pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Descriptor Pool!");
+	}
+
+	DescriptorPool::~DescriptorPool()
+	{
+		vkDestroyDescriptorPool(m_context->m_device, m_descriptor_pool, m_context->m_memory_allocation_callback);
+	}
+
+	std::shared_ptr<DescriptorSet> DescriptorPool::
+		AllocateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout)
+	{
+		assert(!descriptor_set_layout->IsPushDescriptor() && "Push descriptor layouts are never allocated (use CommandBuffer::PushDescriptors())!");
+		return std::make_shared<DescriptorSet>(shared_from_this(), descriptor_set_layout);
+	}
+
+	void DescriptorPool::Reset()
+	{
+		assert((!CanFreeDescriptorSets() || m_allocated_sets == 0) && "Cannot reset a pool whose descriptor sets are still owned!");
+		vkResetDescriptorPool(m_context->m_device, m_descriptor_pool, 0);
+		m_allocated_sets = 0;
+	}
+
+	VkResult DescriptorPool::
+		allocate(VkDescriptorSetLayout descriptor_set_layout, VkDescriptorSet* descriptor_set)
+	{
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = m_descriptor_pool,
+			.descriptorSetCount = 1,
+			.pSetLayouts = &descriptor_set_layout
+		};
+
+		VkResult result = vkAllocateDescriptorSets(m_context->m_device, &descriptorSetAllocateInfo, descriptor_set);
+		if (result == VK_SUCCESS)
+		{
+			++m_allocated_sets;
+			m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_ALLOCATIONS);
+		}
+		return result;
+	}
+
+	void DescriptorPool::free(VkDescriptorSet descriptor_set)
+	{
+		if (CanFreeDescriptorSets())
+		{
+			vkFreeDescriptorSets(m_context->m_device, m_descriptor_pool, 1, &descriptor_set);
+			--m_allocated_sets;
+		}
+	}
+
+	DescriptorAllocator::DescriptorAllocator(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		bool free_descriptor_sets/* = true*/, uint32_t initial_sets_per_pool/* = 128*/) :
+		m_context{ std::move(vulkan_context) },
+		m_pool_flags{ free_descriptor_sets ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : VkDescriptorPoolCreateFlags(0) },
+		m_sets_per_pool{ initial_sets_per_pool }
+	{
+
+	}
+
+	std::shared_ptr<DescriptorSet> DescriptorAllocator::
+		AllocateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout)
+	{
+		std::shared_ptr<DescriptorPool> allocatedPool;
+		VkDescriptorSet descriptorSet = allocate(*descriptor_set_layout, &allocatedPool);
+		return std::make_shared<DescriptorSet>(std::move(allocatedPool), std::move(descriptor_set_layout), descriptorSet);
+	}
+
+	VkDescriptorSet DescriptorAllocator::
+		AllocateDescriptorSetHandle(DescriptorSetLayout& descriptor_set_layout)
+	{
+		assert(!CanFreeDescriptorSets() && "Descriptor Set handles are only allocated from no-free allocators (use AllocateDescriptorSet())!");
+		return allocate(descriptor_set_layout, nullptr);
+	}
+
+	void DescriptorAllocator::Reset()
+	{
+		for (auto& pool : m_pools) pool->Reset();
+		m_current_pool = 0;
+	}
+
+	std::shared_ptr<DescriptorPool> DescriptorAllocator::
+		GetCurrentPool()
+	{
+		if (m_pools.empty()) m_pools.emplace_back(create_pool());
+		return m_pools[m_current_pool];
+	}
+
+	VkDescriptorSet DescriptorAllocator::
+		allocate(DescriptorSetLayout& descriptor_set_layout, std::shared_ptr<DescriptorPool>* allocated_pool)
+	{
+		assert(!descriptor_set_layout.IsPushDescriptor() && "Push descriptor layouts are never allocated (use CommandBuffer::PushDescriptors())!");
+		record_usage(descriptor_set_layout);
+
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		auto pool = GetCurrentPool();
+		bool is_new_pool = false;
+		while (true)
+		{
+			VkResult result = pool->allocate(descriptor_set_layout, &descriptorSet);
+			if (result == VK_SUCCESS) break;
+			if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+				throw std::runtime_error("Failed to allocate the Vulkan Descriptor Set!");
+			if (is_new_pool)
+				throw std::runtime_error("Failed to allocate the Vulkan Descriptor Set from a new Descriptor Pool!");
+
+			// An empty pool that cannot hold the layout was sized from older statistics - chain a new one
+			auto recycled_pool = pool->GetAllocatedSetCount() ? acquire_pool() : nullptr;
+			if (recycled_pool) { pool = std::move(recycled_pool); continue; }
+
+			m_pools.emplace_back(create_pool());
+			m_current_pool = m_pools.size() - 1;
+			pool = m_pools.back();
+			is_new_pool = true;
+		}
+
+		if (allocated_pool) *allocated_pool = pool;
+		return descriptorSet;
+	}
+
+	std::shared_ptr<DescriptorPool> DescriptorAllocator::
+		acquire_pool()
+	{
+		// Recycle a fully free pool before chaining a new one
+		for (size_t i = 0; i < m_pools.size(); ++i)
+		{
+			if (i == m_current_pool) continue;
+			if (m_pools[i]->GetAllocatedSetCount() == 0)
+			{
+				m_pools[i]->Reset();
+				m_current_pool = i;
+				return m_pools[i];
+			}
+		}
+		return nullptr;
+	}
+
+	std::shared_ptr<DescriptorPool> DescriptorAllocator::
+		create_pool()
+	{
+		static constexpr VkDescriptorType CORE_DESCRIPTOR_TYPES[]
+		{
+			VK_DESCRIPTOR_TYPE_SAMPLER,
+			VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+			VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
+			VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
+			VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+			VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT
+		};
+		constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+		// Size from observed usage ratios (Unseen types keep a small reserve)
+		const uint32_t MAX_ALLOCATABLE_SETS = m_sets_per_pool;
+		const uint32_t MIN_DESCRIPTORS = std::max(MAX_ALLOCATABLE_SETS / 16, 1u);
+		std::vector<VkDescriptorPoolSize> descriptorPoolSize;
+		auto add_pool_size = [&](VkDescriptorType type)
+		{
+			uint32_t count = MAX_ALLOCATABLE_SETS;
+			if (m_observed_sets)
+			{
+				auto observed = m_observed_descriptors.find(type);
+				uint64_t expected = observed == m_observed_descriptors.end() ? 0 :
+					(observed->second * MAX_ALLOCATABLE_SETS + m_observed_sets - 1) / m_observed_sets; // Round up
+				count = std::max(static_cast<uint32_t>(expected), MIN_DESCRIPTORS);
+			}
+			descriptorPoolSize.emplace_back(VkDescriptorPoolSize{ .type = type, .descriptorCount = count });
+		};
+		for (auto type : CORE_DESCRIPTOR_TYPES) add_pool_size(type);
+		for (const auto& [type, count] : m_observed_descriptors) // Extension types
 		{
-			commandbuffer = std::make_shared<CommandBufferOneTime>(shared_from_this(), level);
+			if (std::find(std::begin(CORE_DESCRIPTOR_TYPES), std::end(CORE_DESCRIPTOR_TYPES), type) == std::end(CORE_DESCRIPTOR_TYPES))
+				add_pool_size(type);
 		}
-		else throw std::runtime_error("Failed to allocate a proper Vulkan Command Buffer!");
 
-		VkCommandBufferAllocateInfo commandBufferAllocateInfo
+		log::info("Descriptor Allocator created a new Descriptor Pool (No.{}) and you can allocate descriptor set {} times",
+			m_pools.size(), MAX_ALLOCATABLE_SETS);
+		m_sets_per_pool = std::min(m_sets_per_pool * 2, MAX_SETS_PER_POOL);
+
+		return std::make_shared<DescriptorPool>(m_context, descriptorPoolSize, MAX_ALLOCATABLE_SETS, m_pool_flags);
+	}
+
+	void DescriptorAllocator::
+		record_usage(const DescriptorSetLayout& descriptor_set_layout)
+	{
+		++m_observed_sets;
+		for (const auto& binding : descriptor_set_layout.GetBindings())
+			m_observed_descriptors[binding.descriptorType] += binding.descriptorCount;
+	}
+
+	DescriptorArena::DescriptorArena(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		uint32_t frames_in_flight, uint32_t initial_sets_per_pool/* = 256*/)
+	{
+		assert(frames_in_flight > 0 && "Descriptor Arena needs at least one frame!");
+		m_frame_allocators.reserve(frames_in_flight);
+		for (uint32_t i = 0; i < frames_in_flight; ++i)
+			m_frame_allocators.emplace_back(std::make_shared<DescriptorAllocator>(vulkan_context, false, initial_sets_per_pool));
+	}
+
+	void DescriptorArena::BeginFrame(uint32_t frame_index)
+	{
+		assert(frame_index < m_frame_allocators.size() && "Frame index is out of range!");
+		m_frame_index = frame_index;
+		m_frame_allocators[m_frame_index]->Reset(); // One vkResetDescriptorPool per pool
+	}
+
+	void DescriptorArena::BeginFrame(uint32_t frame_index, Fence& frame_fence)
+	{
+		frame_fence.Wait();
+		BeginFrame(frame_index);
+	}
+
+	VkDescriptorSet DescriptorArena::
+		Allocate(DescriptorSetLayout& descriptor_set_layout)
+	{
+		return m_frame_allocators[m_frame_index]->AllocateDescriptorSetHandle(descriptor_set_layout);
+	}
+
+	DescriptorSet::DescriptorSet(std::shared_ptr<DescriptorPool> parent, std::shared_ptr<DescriptorSetLayout> descriptor_set_layout)
+		:m_parent{ std::move(parent) }, m_descriptor_set_layout{ std::move(descriptor_set_layout) }
+	{
+		if (m_parent->allocate(*m_descriptor_set_layout, &m_descriptor_set) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Descriptor Sets!");
+	}
+
+	DescriptorSet::DescriptorSet(std::shared_ptr<DescriptorPool> parent, std::shared_ptr<DescriptorSetLayout> descriptor_set_layout, VkDescriptorSet allocated_descriptor_set)
+		:m_parent{ std::move(parent) }, m_descriptor_set{ allocated_descriptor_set }, m_descriptor_set_layout{ std::move(descriptor_set_layout) }
+	{
+
+	}
+
+	DescriptorSet::~DescriptorSet()
+	{
+		m_parent->m_context->InvalidateBakedCommands(m_descriptor_set);
+		if (!m_parent->CanFreeDescriptorSets()) return;
+		m_parent->m_context->DeferDeletion([pool = m_parent, descriptor_set = m_descriptor_set]() { pool->free(descriptor_set); });
+	}
+
+	namespace
+	{
+		bool is_dynamic_buffer(VkDescriptorType buffer_type)
 		{
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-			.commandPool = m_command_pool,
-			.level = level,
-			.commandBufferCount = 1
+			return buffer_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || buffer_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		}
+	} // namespace
+
+	void DescriptorSet::WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data,
+		VkDeviceSize offset/* = 0*/, VkDeviceSize range/* = VK_WHOLE_SIZE*/)
+	{
+		VkDescriptorBufferInfo descriptorBufferInfo
+		{
+			.buffer = *data,
+			.offset = offset,
+			.range = range // data->Size()
 		};
 
-		if (vkAllocateCommandBuffers(
-			m_context->m_device, 
-			&commandBufferAllocateInfo, 
-			&commandbuffer->command_buffer) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Command Buffer!");
+		VkWriteDescriptorSet writeDescriptorSet
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = m_descriptor_set,
+			.dstBinding = buffer_binding,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = buffer_type,
+			.pImageInfo = nullptr,
+			.pBufferInfo = &descriptorBufferInfo,
+			.pTexelBufferView = nullptr
+		};
 
-		return commandbuffer;
+		vkUpdateDescriptorSets(m_parent->m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
+		m_parent->m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES);
+	}
+
+	void DescriptorSet::WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice)
+	{
+		VkDescriptorBufferInfo descriptorBufferInfo
+		{
+			.buffer = slice.GetBuffer(),
+			.offset = is_dynamic_buffer(buffer_type)? 0 : slice.GetOffset(),
+			.range = slice.GetSize()
+		};
+
+		VkWriteDescriptorSet writeDescriptorSet
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = m_descriptor_set,
+			.dstBinding = buffer_binding,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = buffer_type,
+			.pImageInfo = nullptr,
+			.pBufferInfo = &descriptorBufferInfo,
+			.pTexelBufferView = nullptr
+		};
+
+		vkUpdateDescriptorSets(m_parent->m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
+		m_parent->m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES);
+	}
+
+	void DescriptorSet::WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data)
+	{
+		const VkDescriptorImageInfo descriptorImageInfo =
+			get_descriptor_image_info(*data, image_type, m_descriptor_set_layout->HasImmutableSamplers(image_binding));
+
+		VkWriteDescriptorSet writeDescriptorSet
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = m_descriptor_set,
+			.dstBinding = image_binding,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = image_type,
+			.pImageInfo = &descriptorImageInfo,
+			.pBufferInfo = nullptr,
+			.pTexelBufferView = nullptr
+		};
+
+		vkUpdateDescriptorSets(m_parent->m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
+		m_parent->m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES);
+	}
+
+	void DescriptorSet::WriteTexelBuffer(VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding, VkBufferView buffer_view,
+		uint32_t array_element/* = 0*/)
+	{
+		assert((texel_buffer_type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || texel_buffer_type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER) &&
+			"Invalid texel buffer descriptor type!");
+		VkWriteDescriptorSet writeDescriptorSet
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = m_descriptor_set,
+			.dstBinding = texel_buffer_binding,
+			.dstArrayElement = array_element,
+			.descriptorCount = 1,
+			.descriptorType = texel_buffer_type,
+			.pImageInfo = nullptr,
+			.pBufferInfo = nullptr,
+			.pTexelBufferView = &buffer_view
+		};
+
+		vkUpdateDescriptorSets(m_parent->m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
+		m_parent->m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES);
+	}
+
+	void DescriptorSet::Update(const void* packed_struct)
+	{
+		m_descriptor_set_layout->UpdateDescriptorSet(m_descriptor_set, packed_struct);
+	}
+
+	void DescriptorSet::WriteImages(VkDescriptorType image_type, std::vector<std::shared_ptr<VMA::Image>> data, uint32_t offset/* = 0*/)
+	{
+		ScratchScope scratch;
+		std::pmr::vector<VkDescriptorImageInfo> descriptorImageInfos(data.size(), scratch.Resource());
+		std::pmr::vector<VkWriteDescriptorSet> writeDescriptorSets(data.size(), scratch.Resource());
+
+		for (uint32_t i = 0; i < data.size(); ++i)
+		{
+			descriptorImageInfos[i] = get_descriptor_image_info(*data[i], image_type, m_descriptor_set_layout->HasImmutableSamplers(i + offset));
+
+			writeDescriptorSets[i] = VkWriteDescriptorSet
+			{
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = m_descriptor_set,
+				.dstBinding = i + offset,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = image_type,
+				.pImageInfo = &descriptorImageInfos[i],
+				.pBufferInfo = nullptr,
+				.pTexelBufferView = nullptr
+			};
+		}
+		vkUpdateDescriptorSets(m_parent->m_context->m_device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+		m_parent->m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES, writeDescriptorSets.size());
+	}
+
+	DescriptorWriteBatch::DescriptorWriteBatch(std::shared_ptr<RHI::VulkanContext> vulkan_context, size_t reserved_writes/* = 64*/) :
+		m_context{ std::move(vulkan_context) }
+	{
+		m_writes.reserve(reserved_writes);
+		m_info_indices.reserve(reserved_writes);
+		m_buffer_infos.reserve(reserved_writes);
+		m_image_infos.reserve(reserved_writes);
+	}
+
+	DescriptorWriteBatch::~DescriptorWriteBatch()
+	{
+		Flush();
+	}
+
+	VkWriteDescriptorSet& DescriptorWriteBatch::
+		push_write(VkDescriptorSet descriptor_set, VkDescriptorType type, uint32_t binding, uint32_t array_element)
+	{
+		return m_writes.emplace_back(VkWriteDescriptorSet
+			{
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = descriptor_set,
+				.dstBinding = binding,
+				.dstArrayElement = array_element,
+				.descriptorCount = 1,
+				.descriptorType = type,
+				.pImageInfo = nullptr,
+				.pBufferInfo = nullptr,
+				.pTexelBufferView = nullptr
+			});
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, VkBuffer buffer,
+		VkDeviceSize offset/* = 0*/, VkDeviceSize range/* = VK_WHOLE_SIZE*/, uint32_t array_element/* = 0*/)
+	{
+		push_write(descriptor_set, buffer_type, buffer_binding, array_element);
+		m_info_indices.emplace_back(static_cast<uint32_t>(m_buffer_infos.size()));
+		m_buffer_infos.emplace_back(VkDescriptorBufferInfo
+			{
+				.buffer = buffer,
+				.offset = offset,
+				.range = range
+			});
+		return *this;
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data)
+	{
+		return WriteBuffer(descriptor_set, buffer_type, buffer_binding, *data);
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice)
+	{
+		return WriteBuffer(descriptor_set, buffer_type, buffer_binding, slice.GetBuffer(),
+			is_dynamic_buffer(buffer_type)? 0 : slice.GetOffset(), slice.GetSize());
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, BufferHandle buffer)
+	{
+		const auto& registry = m_context->GetResourceRegistry();
+		return WriteBuffer(descriptor_set, buffer_type, buffer_binding, registry.GetBuffer(buffer), 0, registry.GetSize(buffer));
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteImage(VkDescriptorSet descriptor_set, VkDescriptorType image_type, uint32_t image_binding,
+		VkImageView image_view, VkImageLayout image_layout, VkSampler sampler/* = VK_NULL_HANDLE*/, uint32_t array_element/* = 0*/)
+	{
+		push_write(descriptor_set, image_type, image_binding, array_element);
+		m_info_indices.emplace_back(static_cast<uint32_t>(m_image_infos.size()));
+		m_image_infos.emplace_back(VkDescriptorImageInfo
+			{
+				.sampler = sampler,
+				.imageView = image_view,
+				.imageLayout = image_layout
+			});
+		return *this;
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteImage(VkDescriptorSet descriptor_set, VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data)
+	{
+		const auto imageInfo = get_descriptor_image_info(*data, image_type, false);
+		return WriteImage(descriptor_set, image_type, image_binding, imageInfo.imageView, imageInfo.imageLayout, imageInfo.sampler);
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteImage(VkDescriptorSet descriptor_set, VkDescriptorType image_type, uint32_t image_binding, ImageHandle image)
+	{
+		auto& data = m_context->GetResourceRegistry().Resolve(image); // The layout is tracked by the image
+		const auto imageInfo = get_descriptor_image_info(data, image_type, false);
+		return WriteImage(descriptor_set, image_type, image_binding, imageInfo.imageView, imageInfo.imageLayout, imageInfo.sampler);
+	}
+
+	DescriptorWriteBatch& DescriptorWriteBatch::
+		WriteTexelBuffer(VkDescriptorSet descriptor_set, VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding,
+		VkBufferView buffer_view, uint32_t array_element/* = 0*/)
+	{
+		push_write(descriptor_set, texel_buffer_type, texel_buffer_binding, array_element);
+		m_info_indices.emplace_back(static_cast<uint32_t>(m_texel_buffer_views.size()));
+		m_texel_buffer_views.emplace_back(buffer_view);
+		return *this;
+	}
+
+	void DescriptorWriteBatch::Flush()
+	{
+		if (m_writes.empty()) return;
+
+		patch_writes();
+		vkUpdateDescriptorSets(m_context->m_device, static_cast<uint32_t>(m_writes.size()), m_writes.data(), 0, nullptr);
+		m_context->GetStatistics().Add(RHIStatistics::DESCRIPTOR_WRITES, m_writes.size());
+		clear();
+	}
+
+	void DescriptorWriteBatch::patch_writes()
+	{
+		for (size_t i = 0; i < m_writes.size(); ++i)
+		{
+			auto& write = m_writes[i];
+			switch (write.descriptorType)
+			{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				write.pBufferInfo = &m_buffer_infos[m_info_indices[i]]; break;
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+				write.pTexelBufferView = &m_texel_buffer_views[m_info_indices[i]]; break;
+			default:
+				write.pImageInfo = &m_image_infos[m_info_indices[i]];
+			}
+		}
+	}
+
+	void DescriptorWriteBatch::clear()
+	{
+		m_writes.clear();
+		m_info_indices.clear();
+		m_buffer_infos.clear();
+		m_image_infos.clear();
+		m_texel_buffer_views.clear();
+	}
+
+	DescriptorSetCache::Contents& DescriptorSetCache::Contents::
+		WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data,
+		VkDeviceSize offset/* = 0*/, VkDeviceSize range/* = VK_WHOLE_SIZE*/, uint32_t array_element/* = 0*/)
+	{
+		const VkBuffer buffer = *data;
+		m_writes.emplace_back(Write
+			{
+				.type = buffer_type,
+				.binding = buffer_binding,
+				.array_element = array_element,
+				.resource = (uint64_t)buffer,
+				.buffer_info{ .buffer = buffer, .offset = offset, .range = range }
+			});
+		return *this;
+	}
+
+	DescriptorSetCache::Contents& DescriptorSetCache::Contents::
+		WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice)
+	{
+		m_writes.emplace_back(Write
+			{
+				.type = buffer_type,
+				.binding = buffer_binding,
+				.array_element = 0,
+				.resource = (uint64_t)slice.GetBuffer(),
+				.buffer_info{ .buffer = slice.GetBuffer(), .offset = is_dynamic_buffer(buffer_type)? 0 : slice.GetOffset(), .range = slice.GetSize() }
+			});
+		return *this;
+	}
+
+	DescriptorSetCache::Contents& DescriptorSetCache::Contents::
+		WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data, uint32_t array_element/* = 0*/)
+	{
+		m_writes.emplace_back(Write
+			{
+				.type = image_type,
+				.binding = image_binding,
+				.array_element = array_element,
+				.resource = (uint64_t)static_cast<VkImage>(*data),
+				.image_info = get_descriptor_image_info(*data, image_type, m_descriptor_set_layout->HasImmutableSamplers(image_binding))
+			});
+		return *this;
+	}
+
+	DescriptorSetCache::Contents& DescriptorSetCache::Contents::
+		WriteTexelBuffer(VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding, std::shared_ptr<VMA::Buffer> data,
+		VkFormat format, VkDeviceSize offset/* = 0*/, VkDeviceSize range/* = VK_WHOLE_SIZE*/, uint32_t array_element/* = 0*/)
+	{
+		m_writes.emplace_back(Write
+			{
+				.type = texel_buffer_type,
+				.binding = texel_buffer_binding,
+				.array_element = array_element,
+				.resource = (uint64_t)static_cast<VkBuffer>(*data),
+				.texel_buffer_view = data->GetTexelView(format, offset, range)
+			});
+		return *this;
+	}
+
+	bool DescriptorSetCache::Contents::Write::operator==(const Write& other) const
+	{
+		return type == other.type && binding == other.binding && array_element == other.array_element && resource == other.resource &&
+			buffer_info.buffer == other.buffer_info.buffer && buffer_info.offset == other.buffer_info.offset && buffer_info.range == other.buffer_info.range &&
+			image_info.sampler == other.image_info.sampler && image_info.imageView == other.image_info.imageView &&
+			image_info.imageLayout == other.image_info.imageLayout && texel_buffer_view == other.texel_buffer_view;
+	}
+
+	DescriptorSetCache::DescriptorSetCache(std::shared_ptr<RHI::VulkanContext> vulkan_context, uint32_t initial_sets_per_pool/* = 128*/) :
+		m_context{ std::move(vulkan_context) },
+		m_allocator{ std::make_shared<DescriptorAllocator>(m_context, true, initial_sets_per_pool) }
+	{
+		std::scoped_lock guard{ m_context->m_descriptor_set_caches_mutex };
+		m_context->m_descriptor_set_caches.emplace_back(this);
+		m_context->m_descriptor_set_cache_count = m_context->m_descriptor_set_caches.size();
+	}
+
+	DescriptorSetCache::~DescriptorSetCache()
+	{
+		{
+			std::scoped_lock guard{ m_context->m_descriptor_set_caches_mutex };
+			std::erase(m_context->m_descriptor_set_caches, this);
+			m_context->m_descriptor_set_cache_count = m_context->m_descriptor_set_caches.size();
+		}
+		m_entries.clear(); // Before the allocator (Unregistered, so their destructors do not come back here)
+	}
+
+	std::shared_ptr<DescriptorSet> DescriptorSetCache::GetDescriptorSet(Contents contents)
+	{
+		auto& writes = contents.m_writes;
+		std::sort(writes.begin(), writes.end(), [](const Contents::Write& lhs, const Contents::Write& rhs)
+			{ return std::tie(lhs.binding, lhs.array_element) < std::tie(rhs.binding, rhs.array_element); });
+		// Field by field (No padding bytes)
+		uint64_t key = HashValue(static_cast<VkDescriptorSetLayout>(*contents.m_descriptor_set_layout));
+		for (const auto& write : writes)
+		{
+			key = HashCombine(key, HashWords(write.type, write.binding, write.array_element, write.resource,
+				write.buffer_info.offset, write.buffer_info.range, (uint64_t)write.image_info.sampler, (uint64_t)write.image_info.imageView,
+				write.image_info.imageLayout, (uint64_t)write.texel_buffer_view));
+		}
+
+		std::shared_ptr<DescriptorSet> collidedSet; // Released after unlocking (Its destructor invalidates its handle)
+		std::scoped_lock guard{ m_mutex };
+		if (auto iter = m_entries.find(key); iter != m_entries.end())
+		{
+			if (iter->second.writes == writes)
+			{
+				++m_statistics.hits;
+				return iter->second.descriptor_set;
+			}
+			collidedSet = std::move(iter->second.descriptor_set); // Replaced below, its dependents are skipped by evict()
+		}
+		++m_statistics.misses;
+
+		auto descriptorSet = m_allocator->AllocateDescriptorSet(contents.m_descriptor_set_layout);
+		DescriptorWriteBatch writeBatch{ m_context, writes.size() };
+		for (const auto& write : writes)
+		{
+			switch (write.type)
+			{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				writeBatch.WriteBuffer(*descriptorSet, write.type, write.binding, write.buffer_info.buffer, write.buffer_info.offset,
+					write.buffer_info.range, write.array_element); break;
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+				writeBatch.WriteTexelBuffer(*descriptorSet, write.type, write.binding, write.texel_buffer_view, write.array_element); break;
+			default:
+				writeBatch.WriteImage(*descriptorSet, write.type, write.binding, write.image_info.imageView, write.image_info.imageLayout,
+					write.image_info.sampler, write.array_element);
+			}
+		}
+		writeBatch.Flush();
+
+		for (const auto& write : writes) m_dependents.emplace(write.resource, key);
+		m_entries[key] = Entry{ .descriptor_set = descriptorSet, .writes = std::move(writes) };
+		return descriptorSet;
+	}
+
+	void DescriptorSetCache::Clear()
+	{
+		std::unordered_map<uint64_t, Entry> entries; // Released after unlocking
+		std::scoped_lock guard{ m_mutex };
+		entries.swap(m_entries);
+		m_dependents.clear();
+	}
+
+	DescriptorSetCache::Statistics DescriptorSetCache::GetStatistics()
+	{
+		std::scoped_lock guard{ m_mutex };
+		auto statistics = m_statistics;
+		statistics.entries = m_entries.size();
+		return statistics;
+	}
+
+	void DescriptorSetCache::evict(uint64_t resource, std::vector<std::shared_ptr<DescriptorSet>>& evicted_sets)
+	{
+		std::scoped_lock guard{ m_mutex };
+		auto [first, last] = m_dependents.equal_range(resource);
+		for (auto iter = first; iter != last; ++iter)
+		{
+			auto entry = m_entries.find(iter->second);
+			if (entry == m_entries.end()) continue; // Evicted by another of its resources (Its other dependents are stale)
+			evicted_sets.emplace_back(std::move(entry->second.descriptor_set));
+			m_entries.erase(entry);
+			++m_statistics.evictions;
+		}
+		m_dependents.erase(first, last);
+	}
+
+	uint64_t Sampler::Desc::Hash() const
+	{
+		// Field by field (No padding bytes)
+		uint64_t hash = HashValue(mag_filter);
+		hash = HashCombine(hash, HashValue(min_filter));
+		hash = HashCombine(hash, HashValue(mipmap_mode));
+		hash = HashCombine(hash, HashValue(address_mode_u));
+		hash = HashCombine(hash, HashValue(address_mode_v));
+		hash = HashCombine(hash, HashValue(address_mode_w));
+		hash = HashCombine(hash, HashValue(border_color));
+		hash = HashCombine(hash, HashValue(compare_op));
+		hash = HashCombine(hash, HashValue(anisotropy_enable));
+		hash = HashCombine(hash, HashValue(mip_lod_bias));
+		hash = HashCombine(hash, HashValue(min_lod));
+		hash = HashCombine(hash, HashValue(max_lod));
+		return hash;
 	}
 
-	DescriptorSetLayout::DescriptorSetLayout(std::shared_ptr<RHI::VulkanContext> vulkan_context,
-		const std::vector<VkDescriptorSetLayoutBinding>& descriptor_bindings) :
-		m_context{ std::move(vulkan_context) }
+	Sampler::Sampler(std::shared_ptr<RHI::VulkanContext> vulkan_context, const Desc& desc):
+		m_context {std::move(vulkan_context)},
+		m_desc{ desc }
 	{
-		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo
+		assert(desc.min_lod <= desc.max_lod && "Invalid LOD range of the sampler!");
+		VkSamplerCreateInfo samplerCreateInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-			.bindingCount = static_cast<uint32_t>(descriptor_bindings.size()),
-			.pBindings = descriptor_bindings.data()
+			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+
+			.magFilter = desc.mag_filter,
+			.minFilter = desc.min_filter,
+
+			.mipmapMode = desc.mipmap_mode,
+
+			.addressModeU = desc.address_mode_u,
+			.addressModeV = desc.address_mode_v,
+			.addressModeW = desc.address_mode_w,
+
+			.mipLodBias = desc.mip_lod_bias,
+
+			.anisotropyEnable = desc.anisotropy_enable ? VK_TRUE : VK_FALSE,
+			.maxAnisotropy = m_context->m_physical_device_properties.limits.maxSamplerAnisotropy,
+
+			.compareEnable = desc.compare_op ? VK_TRUE : VK_FALSE,
+			.compareOp = desc.compare_op,
+			
+			.minLod = desc.min_lod,
+			.maxLod = desc.max_lod,
+
+			.borderColor = desc.border_color,
+
+			.unnormalizedCoordinates = VK_FALSE
 		};
 
-		if (vkCreateDescriptorSetLayout(
+		if (vkCreateSampler(
 			m_context->m_device,
-			&descriptorSetLayoutCreateInfo,
+			&samplerCreateInfo,
 			m_context->m_memory_allocation_callback,
-			&m_descriptor_set_layout) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Descriptor Set Layout!");
+			&m_sampler) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Sampler!");
 	}
 
-	DescriptorSetLayout::~DescriptorSetLayout()
+	Sampler::~Sampler()
 	{
-		vkDestroyDescriptorSetLayout(m_context->m_device, m_descriptor_set_layout, m_context->m_memory_allocation_callback);
+		m_context->DeferDeletion([context = m_context, sampler = m_sampler]()
+			{ vkDestroySampler(context->m_device, sampler, context->m_memory_allocation_callback); });
 	}
 
-	DescriptorPool::DescriptorPool(std::shared_ptr<RHI::VulkanContext> vulkan_context, 
-		const std::vector<VkDescriptorPoolSize>& pool_size, uint32_t limit_max_sets) :
+	Semaphore::Semaphore(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkSemaphoreCreateFlags flags) :
 		m_context{ std::move(vulkan_context) }
 	{
-		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo
+		assert(flags == 0 && "Binary semaphores have no creation flags!");
+		m_semaphore = m_context->GetSyncPool().AcquireSemaphore();
+	}
+
+	Semaphore::Semaphore(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkSemaphoreCreateFlags flags, uint64_t timeline_initial_value,
+		bool is_exportable/* = false*/) :
+		m_context{ std::move(vulkan_context) },
+		m_is_timeline{ true },
+		m_is_exportable{ is_exportable }
+	{
+		assert((!is_exportable || m_context->IsExternalMemorySupported()) && "External semaphores are not supported by this device!");
+		VkExportSemaphoreCreateInfo exportSemaphoreCreateInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-			.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-			.maxSets = limit_max_sets,
-			.poolSizeCount = static_cast<uint32_t>(pool_size.size()),
-			.pPoolSizes = pool_size.data()
+			.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO,
+			.handleTypes = static_cast<VkExternalSemaphoreHandleTypeFlags>(ExternalSemaphoreHandleType)
 		};
-		if (vkCreateDescriptorPool(
+		VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.pNext = is_exportable? &exportSemaphoreCreateInfo : nullptr,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = timeline_initial_value
+		};
+		VkSemaphoreCreateInfo semaphoreCreateInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &semaphoreTypeCreateInfo,
+			.flags = flags
+		};
+		if (vkCreateSemaphore(
 			m_context->m_device,
-			&descriptorPoolCreateInfo,
+			&semaphoreCreateInfo,
 			m_context->m_memory_allocation_callback,
-			&m_descriptor_pool) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Descriptor Pool!");
+			&m_semaphore) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Timeline Semaphore!");
 	}
 
-	DescriptorPool::~DescriptorPool()
+	Semaphore::Semaphore(Semaphore&& rvalue) noexcept :
+		m_context{ rvalue.m_context },
+		m_semaphore{ rvalue.m_semaphore },
+		m_is_timeline{ rvalue.m_is_timeline },
+		m_is_exportable{ rvalue.m_is_exportable }
 	{
-		vkDestroyDescriptorPool(m_context->m_device, m_descriptor_pool, m_context->m_memory_allocation_callback);
+		rvalue.m_semaphore = VK_NULL_HANDLE;
 	}
 
-	std::shared_ptr<DescriptorSet> DescriptorPool::
-		AllocateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout)
+	Semaphore::~Semaphore()
 	{
-		return std::make_shared<DescriptorSet>(shared_from_this(), descriptor_set_layout);
+		if (m_semaphore == VK_NULL_HANDLE) return; // Moved
+		if (!m_is_timeline) m_context->GetSyncPool().ReleaseSemaphore(m_semaphore);
+		else vkDestroySemaphore(m_context->m_device, m_semaphore, m_context->m_memory_allocation_callback);
 	}
 
-	DescriptorSet::DescriptorSet(std::shared_ptr<DescriptorPool> parent, std::shared_ptr<DescriptorSetLayout> descriptor_set_layout)
-		:m_parent{ std::move(parent) }, m_descriptor_set_layout{ std::move(descriptor_set_layout) }
+	uint64_t Semaphore::GetCounterValue()
 	{
-		VkDescriptorSetLayout layout = *m_descriptor_set_layout;
-		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo
+		assert(IsTimeline() && "Only timeline semaphores have a counter!");
+		uint64_t value = 0;
+		m_context->m_dispatch.vkGetSemaphoreCounterValue(m_context->m_device, m_semaphore, &value);
+		return value;
+	}
+
+	void Semaphore::Wait(uint64_t value, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
+	{
+		assert(IsTimeline() && "Only timeline semaphores can be waited on the host!");
+		VkSemaphoreWaitInfo semaphoreWaitInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-			.descriptorPool = *m_parent,
-			.descriptorSetCount = 1,
-			.pSetLayouts = &layout
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &m_semaphore,
+			.pValues = &value
 		};
-
-		if (vkAllocateDescriptorSets(
-			m_parent->m_context->m_device,
-			&descriptorSetAllocateInfo,
-			&m_descriptor_set) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Descriptor Sets!");
+		m_context->m_dispatch.vkWaitSemaphores(m_context->m_device, &semaphoreWaitInfo, timeout);
 	}
 
-	DescriptorSet::~DescriptorSet()
+	void Semaphore::Signal(uint64_t value)
 	{
-		vkFreeDescriptorSets(m_parent->m_context->m_device, *m_parent, 1, &m_descriptor_set);
+		assert(IsTimeline() && "Only timeline semaphores can be signaled on the host!");
+		VkSemaphoreSignalInfo semaphoreSignalInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+			.semaphore = m_semaphore,
+			.value = value
+		};
+		m_context->m_dispatch.vkSignalSemaphore(m_context->m_device, &semaphoreSignalInfo);
 	}
 
-	void DescriptorSet::WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data)
+	ExternalHandle Semaphore::Export()
 	{
-		VkDescriptorBufferInfo descriptorBufferInfo
+		if (!m_is_exportable) throw std::runtime_error("Failed to export the Vulkan Semaphore - It was not created as exportable!");
+#ifdef _WIN32
+		const VkSemaphoreGetWin32HandleInfoKHR getInfo
 		{
-			.buffer = *data,
-			.offset = 0,
-			.range = VK_WHOLE_SIZE // data->Size()
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_WIN32_HANDLE_INFO_KHR,
+			.semaphore = m_semaphore,
+			.handleType = ExternalSemaphoreHandleType
 		};
-
-		VkWriteDescriptorSet writeDescriptorSet
+		HANDLE handle = nullptr;
+		VkResult result = reinterpret_cast<PFN_vkGetSemaphoreWin32HandleKHR>(m_context->m_get_semaphore_win32_handle)(m_context->m_device, &getInfo, &handle);
+#else
+		const VkSemaphoreGetFdInfoKHR getInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			.dstSet = m_descriptor_set,
-			.dstBinding = buffer_binding,
-			.dstArrayElement = 0,
-			.descriptorCount = 1,
-			.descriptorType = buffer_type,
-			.pImageInfo = nullptr,
-			.pBufferInfo = &descriptorBufferInfo,
-			.pTexelBufferView = nullptr
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR,
+			.semaphore = m_semaphore,
+			.handleType = ExternalSemaphoreHandleType
 		};
-
-		vkUpdateDescriptorSets(m_parent->m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
+		int handle = -1;
+		VkResult result = m_context->m_get_semaphore_fd(m_context->m_device, &getInfo, &handle);
+#endif
+		if (result != VK_SUCCESS) throw std::runtime_error("Failed to export the Vulkan Semaphore!");
+		return handle;
 	}
 
-	void DescriptorSet::WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data)
+	void Semaphore::Import(ExternalHandle handle)
 	{
-		assert(data->GetImageSampler() != VK_NULL_HANDLE && "Cannot write the image without a sampler!");
-		VkDescriptorImageInfo descriptorImageInfo
+		assert(IsTimeline() && m_context->IsExternalMemorySupported() && "Only timeline semaphores are shared!");
+#ifdef _WIN32
+		const VkImportSemaphoreWin32HandleInfoKHR importInfo
 		{
-			.sampler = data->GetImageSampler(),
-			.imageView = data->GetImageView(),
-			.imageLayout = data->GetImageLayout()
+			.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_WIN32_HANDLE_INFO_KHR,
+			.semaphore = m_semaphore,
+			.handleType = ExternalSemaphoreHandleType,
+			.handle = handle
 		};
-
-		VkWriteDescriptorSet writeDescriptorSet
+		VkResult result = reinterpret_cast<PFN_vkImportSemaphoreWin32HandleKHR>(m_context->m_import_semaphore_win32_handle)(m_context->m_device, &importInfo);
+#else
+		const VkImportSemaphoreFdInfoKHR importInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			.dstSet = m_descriptor_set,
-			.dstBinding = image_binding,
-			.dstArrayElement = 0,
-			.descriptorCount = 1,
-			.descriptorType = image_type,
-			.pImageInfo = &descriptorImageInfo,
-			.pBufferInfo = nullptr,
-			.pTexelBufferView = nullptr
+			.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+			.semaphore = m_semaphore,
+			.handleType = ExternalSemaphoreHandleType,
+			.fd = handle
 		};
+		VkResult result = m_context->m_import_semaphore_fd(m_context->m_device, &importInfo);
+#endif
+		if (result != VK_SUCCESS) throw std::runtime_error("Failed to import the Vulkan Semaphore!");
+	}
+
+	QueueTimeline::QueueTimeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+		QueueFamilyIndex& queue_family_index, uint32_t queue_index/* = 0*/) :
+		m_context{ vulkan_context.get() },
+		m_queue{ vulkan_context->GetQueue(queue_family_index, queue_index) },
+		m_semaphore{ std::move(vulkan_context), 0x0, 0 }
+	{
 
-		vkUpdateDescriptorSets(m_parent->m_context->m_device, 1, &writeDescriptorSet, 0, nullptr);
 	}
 
-	void DescriptorSet::WriteImages(VkDescriptorType image_type, std::vector<std::shared_ptr<VMA::Image>> data, uint32_t offset/* = 0*/)
+	QueueTimeline::~QueueTimeline()
 	{
-		std::vector<VkDescriptorImageInfo> descriptorImageInfos(data.size());
-		std::vector<VkWriteDescriptorSet> writeDescriptorSets(data.size());
+		if (!m_submission_thread.joinable()) return;
+		m_stop_submission_thread = true;
+		++m_doorbell;
+		m_doorbell.notify_one();
+		m_submission_thread.join(); // Drains the ring first
+	}
 
-		for (uint32_t i = 0; i < data.size(); ++i)
+	void QueueTimeline::EnableSubmissionThread(uint32_t ring_capacity/* = 256*/)
+	{
+		if (IsSubmissionThreadEnabled()) return;
+		if (!m_context->m_physical_device_features13.synchronization2)
 		{
-			assert(data[i]->GetImageSampler() != VK_NULL_HANDLE && "Cannot write the image without a sampler!");
+			log::warn("The submission thread is disabled - the GPU does not support synchronization2");
+			return;
+		}
+		assert(ring_capacity > 0 && "Invalid ring capacity!");
+
+		std::scoped_lock guard{ m_mutex };
+		m_submit_ring_capacity = ring_capacity;
+		m_submit_ring = std::make_unique<SubmitPacket[]>(ring_capacity);
+		for (uint32_t position = 0; position < ring_capacity; ++position)
+			m_submit_ring[position].sequence.store(position, std::memory_order_relaxed);
+		m_submit_ring_tick_base = m_submitted_tick;
+		m_submission_thread = std::thread(&QueueTimeline::submission_loop, this);
+	}
 
-			descriptorImageInfos[i] = VkDescriptorImageInfo
+	uint64_t QueueTimeline::enqueue(std::span<const VkCommandBufferSubmitInfo> command_buffers,
+		std::span<const VkSemaphoreSubmitInfo> wait_semaphores,
+		std::span<const VkSemaphoreSubmitInfo> signal_semaphores,
+		VkFence fence)
+	{
+		uint64_t position = m_enqueue_position.fetch_add(1, std::memory_order_acq_rel);
+		auto& packet = m_submit_ring[position % m_submit_ring_capacity];
+		// Full ring: Wait for the submission thread to free this slot
+		for (uint64_t sequence = packet.sequence.load(std::memory_order_acquire); sequence != position;
+			sequence = packet.sequence.load(std::memory_order_acquire))
+			packet.sequence.wait(sequence, std::memory_order_acquire);
+
+		uint64_t tick = m_submit_ring_tick_base + position + 1;
+		// The packets keep their capacity, so the ring stops allocating after warm-up
+		packet.command_buffers.assign(command_buffers.begin(), command_buffers.end());
+		packet.wait_semaphores.assign(wait_semaphores.begin(), wait_semaphores.end());
+		packet.signal_semaphores.assign(signal_semaphores.begin(), signal_semaphores.end());
+		packet.signal_semaphores.emplace_back(VkSemaphoreSubmitInfo
 			{
-				.sampler = data[i]->GetImageSampler(),
-				.imageView = data[i]->GetImageView(),
-				.imageLayout = data[i]->GetImageLayout()
-			};
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = m_semaphore,
+				.value = tick,
+				.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+			});
+		packet.fence = fence;
+
+		// Producers may publish out of order, the submitted tick only grows
+		for (uint64_t submittedTick = m_submitted_tick; submittedTick < tick &&
+			!m_submitted_tick.compare_exchange_weak(submittedTick, tick, std::memory_order_acq_rel); ) {}
+		packet.sequence.store(position + 1, std::memory_order_release);
+		++m_doorbell;
+		m_doorbell.notify_one();
+		return tick;
+	}
 
-			writeDescriptorSets[i] = VkWriteDescriptorSet
+	void QueueTimeline::submission_loop()
+	{
+		constexpr uint32_t MAX_COALESCED_PACKETS = 64;
+		std::vector<VkSubmitInfo2> submitInfos;
+		submitInfos.reserve(MAX_COALESCED_PACKETS);
+		uint64_t position = 0;
+		while (true)
+		{
+			uint64_t doorbell = m_doorbell.load(std::memory_order_acquire);
+
+			// Coalesce the consecutive ready packets (A fence ends the batch, it covers the whole call)
+			VkFence fence = VK_NULL_HANDLE;
+			submitInfos.clear();
+			while (submitInfos.size() < MAX_COALESCED_PACKETS && submitInfos.size() < m_submit_ring_capacity)
 			{
-				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-				.dstSet = m_descriptor_set,
-				.dstBinding = i + offset,
-				.dstArrayElement = 0,
-				.descriptorCount = 1,
-				.descriptorType = image_type,
-				.pImageInfo = &descriptorImageInfos[i],
-				.pBufferInfo = nullptr,
-				.pTexelBufferView = nullptr
-			};
+				uint64_t current = position + submitInfos.size();
+				auto& packet = m_submit_ring[current % m_submit_ring_capacity];
+				if (packet.sequence.load(std::memory_order_acquire) != current + 1) break;
+				submitInfos.emplace_back(VkSubmitInfo2
+					{
+						.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+						.waitSemaphoreInfoCount = static_cast<uint32_t>(packet.wait_semaphores.size()),
+						.pWaitSemaphoreInfos = packet.wait_semaphores.data(),
+						.commandBufferInfoCount = static_cast<uint32_t>(packet.command_buffers.size()),
+						.pCommandBufferInfos = packet.command_buffers.data(),
+						.signalSemaphoreInfoCount = static_cast<uint32_t>(packet.signal_semaphores.size()),
+						.pSignalSemaphoreInfos = packet.signal_semaphores.data()
+					});
+				if (packet.fence != VK_NULL_HANDLE) { fence = packet.fence; break; }
+			}
+
+			if (submitInfos.empty())
+			{
+				if (m_stop_submission_thread && position == m_enqueue_position.load(std::memory_order_acquire)) return;
+				m_doorbell.wait(doorbell, std::memory_order_acquire);
+				continue;
+			}
+
+			VkResult result;
+			{
+				std::scoped_lock guard{ m_mutex };
+				result = m_context->m_dispatch.vkQueueSubmit2(m_queue, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), fence);
+			}
+			if (result != VK_SUCCESS)
+			{
+				log::error("Failed to submit {} coalesced Vulkan submissions!", submitInfos.size()); // Device lost (Cannot throw here)
+				if (result == VK_ERROR_DEVICE_LOST) m_context->OnDeviceLost();
+			}
+
+			// Free the slots for the producers
+			for (uint64_t current = position; current < position + submitInfos.size(); ++current)
+			{
+				auto& packet = m_submit_ring[current % m_submit_ring_capacity];
+				packet.sequence.store(current + m_submit_ring_capacity, std::memory_order_release);
+				packet.sequence.notify_all();
+			}
+			position += submitInfos.size();
+			m_retired_position.store(position, std::memory_order_release);
+			m_retired_position.notify_all();
 		}
-		vkUpdateDescriptorSets(m_parent->m_context->m_device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
 	}
 
-	Sampler::Sampler(std::shared_ptr<RHI::VulkanContext> vulkan_context,
-		VkSamplerAddressMode address_mode,
-		VkBorderColor border_color/* = VK_BORDER_COLOR_INT_OPAQUE_BLACK*/,
-		VkCompareOp compare_mode/* = VK_COMPARE_OP_NEVER*/,
-		bool anisotropy_enable/* = true*/):
-		m_context {std::move(vulkan_context)}
+	void QueueTimeline::Flush()
 	{
-		VkSamplerCreateInfo samplerCreateInfo
+		if (!IsSubmissionThreadEnabled()) return;
+		uint64_t target = m_enqueue_position.load(std::memory_order_acquire);
+		for (uint64_t retired = m_retired_position.load(std::memory_order_acquire); retired < target;
+			retired = m_retired_position.load(std::memory_order_acquire))
+			m_retired_position.wait(retired, std::memory_order_acquire);
+	}
+
+	VkResult QueueTimeline::Present(const VkPresentInfoKHR& present_info)
+	{
+		Flush(); // The wait semaphores must have been signaled by submitted work
+		VkResult result;
 		{
-			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+			std::scoped_lock guard{ m_mutex };
+			result = m_context->m_dispatch.vkQueuePresentKHR(m_queue, &present_info);
+		}
+		if (result == VK_ERROR_DEVICE_LOST) m_context->OnDeviceLost();
+		return result;
+	}
+
+	void QueueTimeline::BindSparse(const VkBindSparseInfo& bind_info, VkFence fence/* = VK_NULL_HANDLE*/)
+	{
+		Flush(); // In submission order
+		std::scoped_lock guard{ m_mutex };
+		if (m_context->m_dispatch.vkQueueBindSparse(m_queue, 1, &bind_info, fence) != VK_SUCCESS)
+			throw std::runtime_error("Failed to bind the sparse Vulkan memory!");
+	}
 
-			.magFilter = VK_FILTER_LINEAR,
-			.minFilter = VK_FILTER_LINEAR,
+	// Per-submission lists longer than this spill to the heap
+	static constexpr size_t INLINE_SUBMIT_COUNT = 8;
+
+	uint64_t QueueTimeline::Submit(std::span<const VkCommandBuffer> command_buffers,
+		std::span<const WaitInfo> wait_semaphores/* = {}*/,
+		std::span<const VkSemaphore> signal_semaphores/* = {}*/,
+		VkFence fence/* = VK_NULL_HANDLE*/)
+	{
+		if (m_context->m_physical_device_features13.synchronization2)
+		{
+			InlineVector<VkCommandBufferSubmitInfo, INLINE_SUBMIT_COUNT> commandBuffers;
+			for (auto command_buffer : command_buffers)
+				commandBuffers.emplace_back(VkCommandBufferSubmitInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .commandBuffer = command_buffer });
+			InlineVector<VkSemaphoreSubmitInfo, INLINE_SUBMIT_COUNT> waitSemaphores;
+			for (const auto& wait_semaphore : wait_semaphores)
+			{
+				waitSemaphores.emplace_back(VkSemaphoreSubmitInfo
+					{
+						.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+						.semaphore = wait_semaphore.semaphore,
+						.value = wait_semaphore.value,
+						.stageMask = wait_semaphore.stages ? wait_semaphore.stages : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT // Per semaphore
+					});
+			}
+			InlineVector<VkSemaphoreSubmitInfo, INLINE_SUBMIT_COUNT> signalSemaphores;
+			for (auto signal_semaphore : signal_semaphores)
+			{
+				signalSemaphores.emplace_back(VkSemaphoreSubmitInfo
+					{
+						.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+						.semaphore = signal_semaphore,
+						.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+					});
+			}
+			return Submit2(commandBuffers, waitSemaphores, signalSemaphores, fence);
+		}
 
-			.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+		// Legacy vkQueueSubmit
+		ALBEDO_RHI_TRACE_ZONE("RHI::Submit"); // After the forwarding to Submit2(), so a submission is one zone
+		auto& statistics = m_context->GetStatistics();
+		RHIStatistics::CPUTimer submitTimer{ statistics, RHIStatistics::SUBMIT_CPU_NS };
+		statistics.Add(RHIStatistics::SUBMITS);
+		statistics.Add(RHIStatistics::COMMAND_BUFFERS, command_buffers.size());
+		InlineVector<VkSemaphore, INLINE_SUBMIT_COUNT> waitSemaphores;
+		InlineVector<uint64_t, INLINE_SUBMIT_COUNT> waitValues;
+		InlineVector<VkPipelineStageFlags, INLINE_SUBMIT_COUNT> waitStages;
+		for (const auto& wait_semaphore : wait_semaphores)
+		{
+			waitSemaphores.emplace_back(wait_semaphore.semaphore);
+			waitValues.emplace_back(wait_semaphore.value);
+			waitStages.emplace_back(wait_semaphore.stages ? ResourceAccess::ToLegacyStages(wait_semaphore.stages) : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		}
 
-			.addressModeU = address_mode,
-			.addressModeV = address_mode,
-			.addressModeW = address_mode,
+		InlineVector<VkSemaphore, INLINE_SUBMIT_COUNT + 1> signalSemaphores;
+		InlineVector<uint64_t, INLINE_SUBMIT_COUNT + 1> signalValues;
+		for (auto signal_semaphore : signal_semaphores)
+		{
+			signalSemaphores.emplace_back(signal_semaphore);
+			signalValues.emplace_back(uint64_t{ 0 }); // Binary
+		}
+		signalSemaphores.emplace_back(m_semaphore);
 
-			.mipLodBias = 0.0,
+		std::scoped_lock guard{ m_mutex };
+		uint64_t tick = m_submitted_tick + 1;
+		signalValues.emplace_back(tick);
 
-			.anisotropyEnable = anisotropy_enable ? VK_TRUE : VK_FALSE,
-			.maxAnisotropy = m_context->m_physical_device_properties.limits.maxSamplerAnisotropy,
+		VkTimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+			.pWaitSemaphoreValues = waitValues.data(),
+			.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+			.pSignalSemaphoreValues = signalValues.data()
+		};
+		VkSubmitInfo submitInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = &timelineSemaphoreSubmitInfo,
+			.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+			.pWaitSemaphores = waitSemaphores.data(),
+			.pWaitDstStageMask = waitStages.data(),
+			.commandBufferCount = static_cast<uint32_t>(command_buffers.size()),
+			.pCommandBuffers = command_buffers.data(),
+			.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
+			.pSignalSemaphores = signalSemaphores.data()
+		};
+		if (auto result = m_context->m_dispatch.vkQueueSubmit(m_queue, 1, &submitInfo, fence); result != VK_SUCCESS)
+		{
+			if (result == VK_ERROR_DEVICE_LOST) m_context->OnDeviceLost();
+			throw std::runtime_error("Failed to submit the Vulkan Command Buffer!");
+		}
 
-			.compareEnable = compare_mode ? VK_TRUE : VK_FALSE,
-			.compareOp = compare_mode,
-			
-			.minLod = 0.0,
-			.maxLod = 0.0,
+		m_submitted_tick = tick;
+		return tick;
+	}
 
-			.borderColor = border_color,
+	uint64_t QueueTimeline::Submit2(std::span<const VkCommandBufferSubmitInfo> command_buffers,
+		std::span<const VkSemaphoreSubmitInfo> wait_semaphores,
+		std::span<const VkSemaphoreSubmitInfo> signal_semaphores,
+		VkFence fence/* = VK_NULL_HANDLE*/)
+	{
+		if (!m_context->m_physical_device_features13.synchronization2)
+		{
+			InlineVector<VkCommandBuffer, INLINE_SUBMIT_COUNT> commandBuffers;
+			for (const auto& command_buffer : command_buffers) commandBuffers.emplace_back(command_buffer.commandBuffer);
+			InlineVector<WaitInfo, INLINE_SUBMIT_COUNT> waitSemaphores;
+			for (const auto& wait_semaphore : wait_semaphores)
+				waitSemaphores.emplace_back(WaitInfo{ wait_semaphore.semaphore, wait_semaphore.stageMask, wait_semaphore.value });
+			InlineVector<VkSemaphore, INLINE_SUBMIT_COUNT> signalSemaphores; // Binary only
+			for (const auto& signal_semaphore : signal_semaphores)
+			{
+				assert(signal_semaphore.value == 0 && "Timeline signals need synchronization2 in SubmitBatch!");
+				signalSemaphores.emplace_back(signal_semaphore.semaphore);
+			}
+			return Submit(commandBuffers, waitSemaphores, signalSemaphores, fence);
+		}
+		ALBEDO_RHI_TRACE_ZONE("RHI::Submit");
+		auto& statistics = m_context->GetStatistics();
+		RHIStatistics::CPUTimer submitTimer{ statistics, RHIStatistics::SUBMIT_CPU_NS }; // Enqueueing only with a submission thread
+		statistics.Add(RHIStatistics::SUBMITS);
+		statistics.Add(RHIStatistics::COMMAND_BUFFERS, command_buffers.size());
+		if (IsSubmissionThreadEnabled()) return enqueue(command_buffers, wait_semaphores, signal_semaphores, fence);
+
+		InlineVector<VkSemaphoreSubmitInfo, INLINE_SUBMIT_COUNT + 1> signalSemaphores;
+		for (const auto& signal_semaphore : signal_semaphores) signalSemaphores.emplace_back(signal_semaphore);
+
+		std::scoped_lock guard{ m_mutex };
+		uint64_t tick = m_submitted_tick + 1;
+		signalSemaphores.emplace_back(VkSemaphoreSubmitInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = m_semaphore,
+				.value = tick,
+				.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+			});
 
-			.unnormalizedCoordinates = VK_FALSE
+		VkSubmitInfo2 submitInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.waitSemaphoreInfoCount = static_cast<uint32_t>(wait_semaphores.size()),
+			.pWaitSemaphoreInfos = wait_semaphores.data(),
+			.commandBufferInfoCount = static_cast<uint32_t>(command_buffers.size()),
+			.pCommandBufferInfos = command_buffers.data(),
+			.signalSemaphoreInfoCount = static_cast<uint32_t>(signalSemaphores.size()),
+			.pSignalSemaphoreInfos = signalSemaphores.data()
 		};
+		if (auto result = m_context->m_dispatch.vkQueueSubmit2(m_queue, 1, &submitInfo, fence); result != VK_SUCCESS)
+		{
+			if (result == VK_ERROR_DEVICE_LOST) m_context->OnDeviceLost();
+			throw std::runtime_error("Failed to submit the Vulkan Command Buffers!");
+		}
 
-		if (vkCreateSampler(
-			m_context->m_device,
-			&samplerCreateInfo,
-			m_context->m_memory_allocation_callback,
-			&m_sampler) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Sampler!");
+		m_submitted_tick = tick;
+		return tick;
 	}
 
-	Sampler::~Sampler()
+	SubmitBatch::SubmitBatch(std::shared_ptr<QueueTimeline> queue_timeline, size_t reserved_command_buffers/* = 16*/) :
+		m_queue_timeline{ std::move(queue_timeline) }
 	{
-		vkDestroySampler(m_context->m_device, m_sampler, m_context->m_memory_allocation_callback);
+		m_command_buffers.reserve(reserved_command_buffers);
 	}
 
-	Semaphore::Semaphore(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkSemaphoreCreateFlags flags) :
+	SubmitBatch& SubmitBatch::Add(VkCommandBuffer command_buffer)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_command_buffers.emplace_back(VkCommandBufferSubmitInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+				.commandBuffer = command_buffer
+			});
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Wait(VkSemaphore semaphore, VkPipelineStageFlags2 stages, uint64_t value/* = 0*/)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_wait_semaphores.emplace_back(VkSemaphoreSubmitInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = semaphore,
+				.value = value,
+				.stageMask = stages
+			});
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Signal(VkSemaphore semaphore, VkPipelineStageFlags2 stages/* = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT*/, uint64_t value/* = 0*/)
+	{
+		std::scoped_lock guard{ m_mutex };
+		m_signal_semaphores.emplace_back(VkSemaphoreSubmitInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = semaphore,
+				.value = value,
+				.stageMask = stages
+			});
+		return *this;
+	}
+
+	uint64_t SubmitBatch::Flush(VkFence fence/* = VK_NULL_HANDLE*/)
+	{
+		std::scoped_lock guard{ m_mutex };
+		if (IsEmpty() && fence == VK_NULL_HANDLE) return m_queue_timeline->GetSubmittedTick();
+
+		auto tick = m_queue_timeline->Submit2(m_command_buffers, m_wait_semaphores, m_signal_semaphores, fence);
+		m_command_buffers.clear();
+		m_wait_semaphores.clear();
+		m_signal_semaphores.clear();
+		return tick;
+	}
+
+	void QueueTimeline::Wait(uint64_t tick, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
+	{
+		assert(tick <= m_submitted_tick && "You cannot wait for a tick which has not been submitted!");
+		if (IsComplete(tick)) return;
+		m_semaphore.Wait(tick, timeout);
+	}
+
+	GPUAwaitable QueueTimeline::Completion(uint64_t tick)
+	{
+		assert(tick <= m_submitted_tick && "You cannot wait for a tick which has not been submitted!");
+		return m_context->GetCompletionPoller().Await(m_semaphore, tick);
+	}
+
+	Event::Event(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkEventCreateFlags flags) :
 		m_context{ std::move(vulkan_context) }
 	{
-		VkSemaphoreCreateInfo semaphoreCreateInfo
+		VkEventCreateInfo eventCreateInfo
 		{
-			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
 			.flags = flags
 		};
-		if (vkCreateSemaphore(
+		if (vkCreateEvent(
 			m_context->m_device,
-			&semaphoreCreateInfo,
+			&eventCreateInfo,
 			m_context->m_memory_allocation_callback,
-			&m_semaphore) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Semaphore!");
+			&m_event) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the Vulkan Event!");
 	}
 
-	Semaphore::Semaphore(Semaphore&& rvalue) noexcept :
-		m_context{ rvalue.m_context },
-		m_semaphore{ rvalue.m_semaphore }
+	Event::~Event()
 	{
-
+		vkDestroyEvent(m_context->m_device, m_event, m_context->m_memory_allocation_callback);
 	}
 
-	Semaphore::~Semaphore()
+	void Event::Reset()
 	{
-		vkDestroySemaphore(m_context->m_device, m_semaphore, m_context->m_memory_allocation_callback);
+		vkResetEvent(m_context->m_device, m_event);
 	}
 
 	Fence::Fence(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkFenceCreateFlags flags) :
 		m_context{ std::move(vulkan_context) }
 	{
-		VkFenceCreateInfo fenceCreateInfo
-		{
-			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-			.flags = flags
-		};
-		if (vkCreateFence(
-			m_context->m_device,
-			&fenceCreateInfo,
-			m_context->m_memory_allocation_callback,
-			&m_fence) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create the Vulkan Fence!");
+		m_fence = m_context->GetSyncPool().AcquireFence(flags & VK_FENCE_CREATE_SIGNALED_BIT);
 	}
 
 	Fence::Fence(Fence&& rvalue) noexcept :
 		m_context{ rvalue.m_context },
 		m_fence{ rvalue.m_fence }
 	{
-
+		rvalue.m_fence = VK_NULL_HANDLE;
 	}
 
 	Fence::~Fence()
 	{ 
-		vkDestroyFence(m_context->m_device, m_fence, m_context->m_memory_allocation_callback); 
+		if (m_fence != VK_NULL_HANDLE) m_context->GetSyncPool().ReleaseFence(m_fence); // Not moved
 	}
 
 	void Fence::Wait(bool reset/* = false*/, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
 	{
-		vkWaitForFences(m_context->m_device, 1, &m_fence, VK_TRUE, timeout);
+		if (vkWaitForFences(m_context->m_device, 1, &m_fence, VK_TRUE, timeout) == VK_ERROR_DEVICE_LOST)
+			m_context->OnDeviceLost();
 		if (reset) Reset();
 	}
 
@@ -985,4 +4508,48 @@ namespace RHI
 		vkResetFences(m_context->m_device, 1, &m_fence);
 	}
 
+	bool Fence::IsSignaled()
+	{
+		return vkGetFenceStatus(m_context->m_device, m_fence) == VK_SUCCESS;
+	}
+
+	GPUAwaitable Fence::operator co_await()
+	{
+		return m_context->GetCompletionPoller().Await(m_fence);
+	}
+
+	bool Fence::WaitAll(std::span<Fence* const> fences, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
+	{
+		return wait(fences, VK_TRUE, timeout);
+	}
+
+	bool Fence::WaitAny(std::span<Fence* const> fences, uint64_t timeout/* = std::numeric_limits<uint64_t>::max()*/)
+	{
+		return wait(fences, VK_FALSE, timeout);
+	}
+
+	void Fence::ResetAll(std::span<Fence* const> fences)
+	{
+		if (fences.empty()) return;
+		InlineVector<VkFence, 8> handles;
+		for (auto* fence : fences) handles.emplace_back(fence->m_fence);
+		vkResetFences(fences.front()->m_context->m_device, static_cast<uint32_t>(handles.size()), handles.data());
+	}
+
+	bool Fence::wait(std::span<Fence* const> fences, VkBool32 wait_all, uint64_t timeout)
+	{
+		if (fences.empty()) return true;
+		InlineVector<VkFence, 8> handles;
+		for (auto* fence : fences)
+		{
+			assert(fence->m_context == fences.front()->m_context && "Batched fences must come from the same context!");
+			handles.emplace_back(fence->m_fence);
+		}
+		auto result = vkWaitForFences(fences.front()->m_context->m_device, static_cast<uint32_t>(handles.size()), handles.data(), wait_all, timeout);
+		if (result == VK_TIMEOUT) return false;
+		if (result == VK_ERROR_DEVICE_LOST) fences.front()->m_context->OnDeviceLost();
+		if (result != VK_SUCCESS) throw std::runtime_error(std::format("Failed to wait the Vulkan Fences ({})!", static_cast<int>(result)));
+		return true;
+	}
+
 }} // namespace Albedo::RHI
\ No newline at end of file
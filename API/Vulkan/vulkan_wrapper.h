@@ -1,6 +1,13 @@
 #pragma once
 
 #include "vulkan_memory.h"
+#include "vulkan_shader.h"
+#include "vulkan_registry.h"
+#include "vulkan_inline.h"
+#include "vulkan_arena.h"
+#include "vulkan_capture.h"
+
+#include <future>
 
 namespace Albedo {
 namespace RHI
@@ -9,117 +16,463 @@ namespace RHI
 
 	// Wrapper List
 	class RenderPass;			// Abstract Class
+	class DynamicRenderPass;	// Abstract Class (Dynamic Rendering without VkRenderPass & VkFramebuffer)
 	class GraphicsPipeline;	// Abstract Class
+	class ComputePipeline;	// Abstract Class
+	class PipelineLayout;		// Shared by identical pipeline layouts
+	class PipelineStateObject; // Shared by identical graphics pipelines
+	class IndirectDrawBuffer; // vulkan_indirect.h
+	class DescriptorBuffer; // vulkan_descriptor_buffer.h
 
 	class CommandPool;		// Factory
 	class CommandBuffer;
-	class CommandBufferReset;
-	class CommandBufferOneTime;
+	class CommandBufferBaked;
 
 	class DescriptorPool;		// Factory
+	class DescriptorAllocator; // Growable chain of Descriptor Pools
+	class DescriptorArena;		// Per-frame transient Descriptor Sets
+	class DescriptorSetCache; // Sets shared by identical contents
+	class DescriptorWriteBatch; // Batched vkUpdateDescriptorSets
 	class DescriptorSetLayout;
 	class DescriptorSet;
 	class DescriptorBinding;
 
-	class Sampler;
+	class Sampler;			// Shared by identical descriptions (Immutable)
 
 	class Semaphore;	// Add order between queue operations (same queue or different queues) on the GPU
 	class Fence;				// order the execution on the CPU
+	class Event;				// Split barriers inside a queue
+	class QueueTimeline; // Monotonic GPU ticks per queue (Timeline Semaphore)
+	class SubmitBatch;		// Accumulates submissions for one vkQueueSubmit2
+	class GPUAwaitable;	// co_await GPU completion (vulkan_async.h)
 
 	using QueueFamilyIndex = std::optional<uint32_t>;
 
+	struct SemaphoreWaitInfo
+	{
+		VkSemaphore semaphore;
+		VkPipelineStageFlags2 stages; // 0: ALL_COMMANDS
+		uint64_t value = 0; // Ignored by binary semaphores
+	};
+
+	// Attachment formats the pipelines of a Dynamic Render Pass are compiled against
+	struct RenderingFormats
+	{
+		std::vector<VkFormat> color_formats;
+		VkFormat depth_format = VK_FORMAT_UNDEFINED;
+		VkFormat stencil_format = VK_FORMAT_UNDEFINED;
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT; // Clamped by DynamicRenderPass::Initialize(), the default multisampling state
+		bool shading_rate_attachment = false; // Rendered with a ShadingRateImage (Attachments::shading_rate)
+	};
+
+	// Binding of a reflected layout baked with a named immutable sampler (VulkanContext::RegisterImmutableSampler())
+	struct ImmutableSamplerBinding
+	{
+		uint32_t set;
+		uint32_t binding; // SAMPLER or COMBINED_IMAGE_SAMPLER (All array elements)
+		std::string sampler;
+	};
+
+	// Interleaved vertex buffer (binding 0) reflected from the vertex shader inputs
+	struct VertexInputLayout
+	{
+		std::vector<VkVertexInputAttributeDescription> attributes; // Ascending locations, offsets aligned to the component size
+		uint32_t stride = 0; // Tightly packed (4-byte aligned)
+	};
+
+	// Push constant block of a pipeline layout, resolved once at pipeline creation (See CommandBuffer::Push())
+	struct PushConstantBlock
+	{
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkShaderStageFlags stages = 0; // 0: No single range covers every stage (Use CommandBuffer::PushConstants())
+		uint32_t offset = 0;
+		uint32_t size = 0;
+	};
+
+	// Compile-time check of a block struct against build-time reflection (Laid out from offset 0 like the generated structs)
+	constexpr bool MatchesPushConstants(const ShaderReflectionTable& reflection, size_t size)
+	{
+		uint32_t end = 0;
+		for (const auto& range : reflection.push_constants) end = std::max(end, range.offset + range.size);
+		return end != 0 && size == end;
+	}
+
+	// Commands recorded through the CommandBuffer recorder (Redundant binds are dropped and counted)
+	struct RecordingStatistics
+	{
+		uint64_t pipeline_binds = 0;
+		uint64_t descriptor_set_binds = 0; // vkCmdBindDescriptorSets calls
+		uint64_t descriptor_pushes = 0; // vkCmdPushDescriptorSetKHR calls
+		uint64_t vertex_buffer_binds = 0;
+		uint64_t index_buffer_binds = 0;
+		uint64_t push_constants = 0;
+		uint64_t draws = 0; // Draw calls (An indirect call counts once)
+		uint64_t dispatches = 0;
+		uint64_t redundant_binds = 0; // Dropped before reaching the driver
+		uint64_t barriers = 0; // Barrier structs recorded (Queued, split and direct)
+
+		RecordingStatistics& operator+=(const RecordingStatistics& other)
+		{
+			pipeline_binds += other.pipeline_binds;
+			descriptor_set_binds += other.descriptor_set_binds;
+			descriptor_pushes += other.descriptor_pushes;
+			vertex_buffer_binds += other.vertex_buffer_binds;
+			index_buffer_binds += other.index_buffer_binds;
+			push_constants += other.push_constants;
+			draws += other.draws;
+			dispatches += other.dispatches;
+			redundant_binds += other.redundant_binds;
+			barriers += other.barriers;
+			return *this;
+		}
+	};
+
+	// Behaviour of the command buffers of a pool, fixed at allocation by the pool flags
+	enum class CommandBufferPolicy
+	{
+		RESET,		// VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT: Reset by Begin(), submitted any number of times
+		ONE_TIME	// VK_COMMAND_POOL_CREATE_TRANSIENT_BIT: ONE_TIME_SUBMIT, recycled by Submit()
+	};
+
 	// Implementation
-	class CommandPool : public std::enable_shared_from_this<CommandPool>
+	class CommandPool
 	{
-		friend class CommandBufferReset;
-		friend class CommandBufferOneTime;
+		friend class CommandBuffer;
+		friend class CommandBufferBaked;
 	public:
+		// Recycled command buffers first (They must not outlive the pool, which they do not own)
 		std::shared_ptr<CommandBuffer> AllocateCommandBuffer(VkCommandBufferLevel level);
+		std::shared_ptr<CommandBufferBaked> AllocateBakedCommandBuffer(); // Secondary, requires VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+		// Recycle every command buffer at once via vkResetCommandPool (e.g. once the frame fence signaled)
+		// Transient pools also do it implicitly when no command buffer is outstanding and its GPU work is complete
+		void Reset();
+		QueueTimeline& GetQueueTimeline() { return *m_queue_timeline; } // Of the submit queue
+		QueueTimeline& GetQueueTimeline(uint32_t queue_index); // Any queue of the family
+		uint32_t GetQueueIndex() const { return m_queue_index; }
+		uint32_t GetQueueFamilyIndex() const { return m_queue_family_index.value(); }
+		RecordingStatistics TakeRecordingStatistics(); // Of the command buffers ended since the last call
 		operator VkCommandPool() { return m_command_pool; }
 
 	public:
 		CommandPool() = delete;
 		CommandPool(std::shared_ptr<VulkanContext> vulkan_context,
 									QueueFamilyIndex& submit_queue_family_index,
-									VkCommandPoolCreateFlags command_pool_flags);
-		~CommandPool();
+									VkCommandPoolCreateFlags command_pool_flags,
+									uint32_t submit_queue_index = 0);
+		~CommandPool(); // Every allocated command buffer has to be destroyed before
 
 	private:
 		std::shared_ptr<VulkanContext> m_context;
+		QueueFamilyIndex m_queue_family_index;
+		uint32_t m_queue_index;
 		VkQueue m_submit_queue_family;
+		std::shared_ptr<QueueTimeline> m_queue_timeline;
 
 		VkCommandPool m_command_pool = VK_NULL_HANDLE;
 		VkCommandPoolCreateFlags m_command_pool_flags;
+
+		struct RetiredCommandBuffer
+		{
+			VkCommandBuffer command_buffer;
+			VkCommandBufferLevel level;
+			QueueTimeline* timeline; // Submitted to (Global timelines live as long as the context)
+			uint64_t tick; // Reusable once the queue timeline passed it
+		};
+		std::mutex m_recycle_mutex;
+		std::vector<RetiredCommandBuffer> m_retired_command_buffers;
+		std::array<std::vector<VkCommandBuffer>, 2> m_free_command_buffers; // [Primary, Secondary]
+		uint32_t m_outstanding_command_buffers = 0;
+		RecordingStatistics m_recording_statistics; // Guarded by m_recycle_mutex
+
+	private:
+		VkCommandBuffer acquire(VkCommandBufferLevel level);
+		VkCommandBuffer allocate(VkCommandBufferLevel level); // acquire() or vkAllocateCommandBuffers
+		void recycle(VkCommandBuffer command_buffer, VkCommandBufferLevel level, QueueTimeline* timeline, uint64_t tick);
+		void reclaim();
 	};
 
 	class CommandBuffer
 	{
 		friend class CommandPool;
+		friend class VMA::Buffer; // Captured copies
+		friend class DynamicRenderPass; // Captured rendering scopes
 	public:
-		virtual void Begin(VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr) = 0;
-		virtual void End() = 0;
-		virtual void Submit(bool wait_queue_idle = false,
+		// Not virtual: The policy of the parent pool is a predictable branch instead of a vtable dispatch per call
+		void Begin(VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr);
+		void End();
+		static constexpr uint32_t PARENT_QUEUE = std::numeric_limits<uint32_t>::max(); // Submit queue of the parent pool
+		void Submit(bool wait_queue_idle = false,
 			VkFence fence = VK_NULL_HANDLE,
-			std::vector<VkSemaphore> wait_semaphores = {},
-			std::vector<VkSemaphore> signal_semaphores = {},
-			VkPipelineStageFlags which_pipeline_stages_to_wait = 0,
-			uint32_t target_queue_index = 0) = 0;
+			std::span<const VkSemaphore> wait_semaphores = {},
+			std::span<const VkSemaphore> signal_semaphores = {},
+			VkPipelineStageFlags2 which_pipeline_stages_to_wait = 0,
+			uint32_t target_queue_index = PARENT_QUEUE); // wait_queue_idle only waits for this submission
+		// Return the GPU tick of this submission (See QueueTimeline), One-time command buffers are not freed here
+		// The tick belongs to GetSubmittedQueueTimeline() (Another queue of the pool family can be targeted, e.g. VulkanContext::GetQueueIndex())
+		uint64_t SubmitTick(std::span<const SemaphoreWaitInfo> wait_semaphores = {},
+			std::span<const VkSemaphore> signal_semaphores = {},
+			VkFence fence = VK_NULL_HANDLE,
+			uint32_t target_queue_index = PARENT_QUEUE);
+		QueueTimeline& GetSubmittedQueueTimeline() { return *m_submitted_timeline; }
+		// Device Groups (VulkanContext::GetDeviceCount() > 1): Devices running the commands, 0: Every device of the group.
+		// Outside recording: The mask of the next Begin() and submissions, while recording: vkCmdSetDeviceMask (A subset of it).
+		// With split_render_areas, dynamic render passes give each device of the mask a band of the render area (Split-frame rendering).
+		void SetDeviceMask(uint32_t device_mask, bool split_render_areas = false);
+		uint32_t GetDeviceMask() const { return m_current_device_mask; }
+		bool IsSplitRendering() const { return m_split_render_areas; }
+
+		// Debug Labels (Compiled out without debug markers)
+		void PushLabel(const char* name, const DebugUtils::Color& color = { 0.0f, 0.0f, 0.0f, 0.0f }) { DebugUtils::BeginLabel(command_buffer, name, color); }
+		void PopLabel() { DebugUtils::EndLabel(command_buffer); }
+		void InsertLabel(const char* name, const DebugUtils::Color& color = { 0.0f, 0.0f, 0.0f, 0.0f }) { DebugUtils::InsertLabel(command_buffer, name, color); }
+
+		// vkCmdPipelineBarrier2 (Converted to one legacy vkCmdPipelineBarrier without synchronization2), queued barriers go first
+		void PipelineBarrier(const std::vector<VkImageMemoryBarrier2>& image_barriers,
+			const std::vector<VkBufferMemoryBarrier2>& buffer_barriers = {},
+			const std::vector<VkMemoryBarrier2>& memory_barriers = {});
+
+		// Barrier Batching: queued barriers are recorded as one barrier command by FlushBarriers().
+		// End(), ExecuteCommands(), RenderPass::Begin() and the XXXCommand functions of the RHI flush implicitly,
+		// but you must FlushBarriers() yourself before recording draws, dispatches or copies on the raw handle.
+		void QueueBarrier(const VkImageMemoryBarrier2& image_barrier) { m_queued_barriers.image_barriers.emplace_back(image_barrier); }
+		void QueueBarrier(const VkBufferMemoryBarrier2& buffer_barrier) { m_queued_barriers.buffer_barriers.emplace_back(buffer_barrier); }
+		void QueueBarrier(const VkMemoryBarrier2& memory_barrier) { m_queued_barriers.memory_barriers.emplace_back(memory_barrier); }
+		void FlushBarriers();
+		bool HasQueuedBarriers() const { return !m_queued_barriers.empty(); }
+		// Record immediately into a raw command buffer (e.g. command buffers owned by the Upload Engine)
+		static void PipelineBarrier(VkCommandBuffer command_buffer, const VulkanContext& vulkan_context,
+			const std::vector<VkImageMemoryBarrier2>& image_barriers,
+			const std::vector<VkBufferMemoryBarrier2>& buffer_barriers = {},
+			const std::vector<VkMemoryBarrier2>& memory_barriers = {});
+
+		// Split Barriers: SetBarrierEvent() signals the queued barriers after the producer work (vkCmdSetEvent2),
+		// WaitBarrierEvent() waits for them before the consumer work (vkCmdWaitEvents2), independent work in between overlaps.
+		// Both must be recorded in this command buffer, and the event must be reset before it is set again.
+		void SetBarrierEvent(VkEvent event);
+		void WaitBarrierEvent(VkEvent event);
+
+		// Mesh Shaders (VulkanContext::IsMeshShaderSupported(), queued barriers are flushed first)
+		void DrawMeshTasks(uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1);
+		void DrawMeshTasksIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride = sizeof(VkDrawMeshTasksIndirectCommandEXT));
+		void DrawMeshTasksIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer count_buffer, VkDeviceSize count_offset,
+			uint32_t max_draw_count, uint32_t stride = sizeof(VkDrawMeshTasksIndirectCommandEXT)); // Requires drawIndirectCount
+
+		// Conditional Rendering (VulkanContext::IsConditionalRenderingSupported()): Draws, dispatches and clears until EndConditional()
+		// are discarded on the GPU if the 32-bit predicate at offset is zero (non-zero if inverted). The predicate buffer needs
+		// VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT and a barrier to VK_ACCESS_2_CONDITIONAL_RENDERING_READ_BIT_EXT after it is written
+		// (See QueryPool::CopyPredicates(), or write it from a compute culling pass). Must not nest, and a block begun inside a render pass ends in it.
+		void BeginConditional(VkBuffer predicate_buffer, VkDeviceSize offset = 0, bool inverted = false);
+		void EndConditional();
+
+		// Variable Rate Shading (VulkanContext::IsFragmentShadingRateSupported()): Rate of the next draws, the pipelines need
+		// VK_DYNAMIC_STATE_FRAGMENT_SHADING_RATE_KHR. The combiners merge it with the primitive rate and then with the ShadingRateImage.
+		void SetFragmentShadingRate(VkExtent2D fragment_size,
+			VkFragmentShadingRateCombinerOpKHR primitive_combiner = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR,
+			VkFragmentShadingRateCombinerOpKHR attachment_combiner = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR);
+
+		// Recorder: Tracks the bound pipelines, descriptor sets, vertex & index buffers and push constants of this command buffer,
+		// and drops redundant binds. Raw vkCmdBindXXX calls on the handle bypass the tracking, call InvalidateBindings() after them.
+		void BindPipeline(VkPipelineBindPoint bind_point, VkPipeline pipeline);
+		// Shader Objects (VulkanContext::IsShaderObjectSupported(), see ShaderObjectProgram::Bind()): VK_NULL_HANDLE unbinds a stage.
+		// Binding a graphics pipeline replaces them, and binding them replaces the graphics pipeline.
+		void BindShaders(std::span<const VkShaderStageFlagBits> stages, std::span<const VkShaderEXT> shaders);
+		void BindDescriptorSets(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t first_set,
+			const std::vector<VkDescriptorSet>& descriptor_sets, const std::vector<uint32_t>& dynamic_offsets = {}); // Dynamic offsets are never filtered
+		void BindVertexBuffers(uint32_t first_binding, const std::vector<VkBuffer>& buffers, const std::vector<VkDeviceSize>& offsets);
+		void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type);
+		void PushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data);
+		// Typed push constants (Pipeline: GraphicsPipeline, ComputePipeline or PipelineLayout): One PushConstants() with the block
+		// resolved at pipeline creation. T is laid out from offset 0 like the generated structs, only its bytes of the block are pushed.
+		template<typename Pipeline, typename T>
+		void Push(const Pipeline& pipeline, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % 4 == 0, "Push constants are trivially copyable 4-byte words!");
+			const PushConstantBlock& block = pipeline.GetPushConstantBlock();
+			assert(block.stages && block.offset < sizeof(T) && sizeof(T) <= block.offset + block.size && "The value does not match the push constant block!");
+			PushConstants(block.layout, block.stages, block.offset, static_cast<uint32_t>(sizeof(T)) - block.offset,
+				reinterpret_cast<const std::byte*>(&value) + block.offset);
+		}
+		// Ditto, sizeof(T) is checked against the build-time reflection (e.g. Push<Shaders::mesh_vert::REFLECTION>(pipeline, constants))
+		template<const ShaderReflectionTable& REFLECTION, typename Pipeline, typename T>
+		void Push(const Pipeline& pipeline, const T& value)
+		{
+			static_assert(MatchesPushConstants(REFLECTION, sizeof(T)), "The struct does not match the reflected push constant block!");
+			Push(pipeline, value);
+		}
+		// Push Descriptors (VulkanContext::IsPushDescriptorSupported()): Written into the command buffer instead of an allocated set,
+		// the set of the layout must be a push descriptor layout (See prepare_push_descriptor_set(), dstSet is ignored). Never filtered.
+		void PushDescriptors(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set, const std::vector<VkWriteDescriptorSet>& writes);
+		void PushDescriptors(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set, DescriptorWriteBatch& writes); // Consumes the pending writes
+		// Descriptor Buffers (VulkanContext::IsDescriptorBufferSupported(), see DescriptorBuffer::Bind()): Sets are offsets into the bound buffer.
+		// Binding another descriptor buffer disturbs all bound descriptor sets, offsets are never filtered.
+		void BindDescriptorBuffer(VkDeviceAddress address, VkBufferUsageFlags usage);
+		void SetDescriptorBufferOffsets(VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t first_set, const std::vector<VkDeviceSize>& offsets);
+		void InvalidateBindings() { m_bindings = {}; }
+		// Queued barriers are flushed first
+		void Draw(uint32_t vertex_count, uint32_t instance_count = 1, uint32_t first_vertex = 0, uint32_t first_instance = 0);
+		void DrawIndexed(uint32_t index_count, uint32_t instance_count = 1, uint32_t first_index = 0, int32_t vertex_offset = 0, uint32_t first_instance = 0);
+		void DrawIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride, bool indexed = false);
+		void DrawIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer count_buffer, VkDeviceSize count_offset,
+			uint32_t max_draw_count, uint32_t stride, bool indexed = false); // Requires drawIndirectCount
+		// Multi Draw (VulkanContext::IsMultiDrawSupported()): Direct draws sharing the bound state and instances in one command
+		// (Split by maxMultiDrawCount, gl_DrawID is the index in the batch). Recorded one by one without the extension.
+		void DrawMulti(std::span<const VkMultiDrawInfoEXT> draws, uint32_t instance_count = 1, uint32_t first_instance = 0);
+		void DrawMultiIndexed(std::span<const VkMultiDrawIndexedInfoEXT> draws, uint32_t instance_count = 1, uint32_t first_instance = 0);
+		void Dispatch(uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1);
+		const RecordingStatistics& GetRecordingStatistics() const { return m_statistics; } // Since Begin()
+
+		// Extended Dynamic State (Vulkan 1.3, see GraphicsPipeline::use_extended_dynamic_state())
+		// Identical consecutive sets are skipped. Binding a pipeline that bakes one of these states invalidates it,
+		// call InvalidateDynamicState() after such a bind (Begin() resets the filter).
+		void SetViewports(const std::vector<VkViewport>& viewports);
+		void SetScissors(const std::vector<VkRect2D>& scissors);
+		void SetCullMode(VkCullModeFlags cull_mode);
+		void SetFrontFace(VkFrontFace front_face);
+		void SetPrimitiveTopology(VkPrimitiveTopology primitive_topology); // Same topology class as the pipeline
+		void SetDepthTestEnable(bool enable);
+		void SetDepthWriteEnable(bool enable);
+		void SetDepthCompareOp(VkCompareOp compare_op);
+		void SetStencilTestEnable(bool enable);
+		void SetStencilOp(VkStencilFaceFlags faces, VkStencilOp fail_op, VkStencilOp pass_op, VkStencilOp depth_fail_op, VkCompareOp compare_op);
+		void InvalidateDynamicState() { m_dynamic_state = {}; }
+
+		// vkCmdExecuteCommands (Secondaries are kept alive until this command buffer was submitted)
+		void ExecuteCommands(const std::vector<std::shared_ptr<CommandBuffer>>& secondary_command_buffers);
 
 		VkCommandBufferLevel GetLevel() const { return m_level; }
+		CommandBufferPolicy GetPolicy() const { return m_policy; }
+		uint32_t GetQueueFamilyIndex() const { return m_parent->GetQueueFamilyIndex(); } // Of the parent pool
 		bool IsRecording() const { return m_is_recording; }
 		operator VkCommandBuffer() { return command_buffer; }
+		// Raw commands without a wrapper (Not captured or tracked), e.g. command_buffer.GetDispatch().vkCmdFillBuffer(command_buffer, ...)
+		const DeviceDispatchTable& GetDispatch() const { return *m_dispatch; }
 
 	public:
 		CommandBuffer() = delete;
-		CommandBuffer(std::shared_ptr<CommandPool> parent, VkCommandBufferLevel level);
-		virtual ~CommandBuffer() {};
+		CommandBuffer(CommandPool& parent, VkCommandBufferLevel level, CommandBufferPolicy policy);
+		~CommandBuffer(); // Return to the parent pool
 
 	protected:
-		std::shared_ptr<CommandPool> m_parent;
+		CommandPool* m_parent; // Not owned (Outlives its command buffers)
+		const CommandBufferPolicy m_policy;
+		const DeviceDispatchTable* m_dispatch; // Of the parent pool's context
 		VkCommandBuffer command_buffer = VK_NULL_HANDLE;
 		VkCommandBufferLevel m_level;
 		bool m_is_recording = false;
+		bool m_is_conditional = false; // Between BeginConditional() and EndConditional()
+		QueueTimeline* m_submitted_timeline; // Parent queue until submitted
+		uint64_t m_submitted_tick = 0;
+		std::vector<std::shared_ptr<CommandBuffer>> m_executed_command_buffers;
+		uint32_t m_device_mask = 0; // Of Begin() and submissions (See SetDeviceMask())
+		uint32_t m_current_device_mask = 0;
+		bool m_split_render_areas = false;
+
+		struct BarrierBatch
+		{
+			std::vector<VkImageMemoryBarrier2> image_barriers;
+			std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+			std::vector<VkMemoryBarrier2> memory_barriers;
+			bool empty() const { return image_barriers.empty() && buffer_barriers.empty() && memory_barriers.empty(); }
+			void clear() { image_barriers.clear(); buffer_barriers.clear(); memory_barriers.clear(); }
+		};
+		BarrierBatch m_queued_barriers; // Keep the capacity across flushes
+		std::vector<std::pair<VkEvent, BarrierBatch>> m_split_barriers; // Set but not waited yet
+
+		struct DynamicStateFilter // Last values set in this command buffer
+		{
+			std::vector<VkViewport> viewports;
+			std::vector<VkRect2D> scissors;
+			std::optional<VkCullModeFlags> cull_mode;
+			std::optional<VkFrontFace> front_face;
+			std::optional<VkPrimitiveTopology> primitive_topology;
+			std::optional<bool> depth_test_enable;
+			std::optional<bool> depth_write_enable;
+			std::optional<VkCompareOp> depth_compare_op;
+			std::optional<bool> stencil_test_enable;
+			std::array<std::optional<std::array<uint32_t, 4>>, 2> stencil_ops; // [Front, Back] {fail, pass, depth fail, compare}
+		};
+		DynamicStateFilter m_dynamic_state;
+
+		struct BindingFilter // Currently bound in this command buffer
+		{
+			struct BoundDescriptorSet
+			{
+				VkPipelineLayout layout = VK_NULL_HANDLE;
+				VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+			};
+			struct PushConstantRange
+			{
+				VkShaderStageFlags stages;
+				uint32_t offset;
+				std::vector<uint8_t> data;
+			};
+			std::array<VkPipeline, 2> pipelines{}; // [Graphics, Compute]
+			std::vector<std::pair<VkShaderStageFlagBits, VkShaderEXT>> shaders; // Of the last BindShaders() (Cleared by graphics pipelines)
+			std::array<std::vector<BoundDescriptorSet>, 2> descriptor_sets; // Per set index
+			VkDeviceAddress descriptor_buffer = 0;
+			std::vector<std::pair<VkBuffer, VkDeviceSize>> vertex_buffers; // Per binding
+			VkBuffer index_buffer = VK_NULL_HANDLE;
+			VkDeviceSize index_offset = 0;
+			VkIndexType index_type = VK_INDEX_TYPE_UINT16;
+			VkPipelineLayout push_constant_layout = VK_NULL_HANDLE;
+			std::vector<PushConstantRange> push_constants;
+		};
+		BindingFilter m_bindings;
+		RecordingStatistics m_statistics;
+
+		std::vector<uint64_t>* m_baked_dependencies = nullptr; // Collected while baking (See CommandBufferBaked)
+		template<typename VulkanHandle>
+		void track_dependency(VulkanHandle handle) { if (m_baked_dependencies) m_baked_dependencies->emplace_back((uint64_t)handle); }
+
+		std::unique_ptr<CaptureStream> m_capture; // Primaries while a CommandCapture is attached (See VulkanContext::SetCommandCapture())
+		template<typename... Values>
+		void capture(CaptureOpcode opcode, const Values&... values) { if (m_capture) m_capture->Write(opcode, values...); }
+
+	private:
+		enum class BarrierCommand { PIPELINE_BARRIER, SET_EVENT, WAIT_EVENT };
+		static void record_barriers(VkCommandBuffer command_buffer, const VulkanContext& vulkan_context, BarrierCommand command, VkEvent event,
+			const std::vector<VkImageMemoryBarrier2>& image_barriers,
+			const std::vector<VkBufferMemoryBarrier2>& buffer_barriers,
+			const std::vector<VkMemoryBarrier2>& memory_barriers);
 
 	}; // class CommandBuffer
 
-	class CommandBufferReset :
-		public CommandBuffer
+	// Baked Command Buffer: A secondary recorded once and replayed by vkCmdExecuteCommands every frame (Static geometry, UI layers ...)
+	// instead of recording the same commands again. The pipelines, descriptor sets, vertex, index, indirect and predicate buffers bound
+	// while baking are tracked: Destroying one of them (Including hot reloads and defragmentation moves) or recreating the swap chain
+	// invalidates it, and the next Bake() records it again. Descriptor sets of pools that are reset wholesale are not tracked, and
+	// rewriting a baked set needs update-after-bind bindings (Or Invalidate() it).
+	class CommandBufferBaked final :
+		public CommandBuffer,
+		public std::enable_shared_from_this<CommandBufferBaked>
 	{
+		friend class VulkanContext; // Invalidation
 	public:
-		virtual void Begin(VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr) override;
-		virtual void End() override;
-		virtual void Submit(bool wait_queue_idle = false,
-			VkFence fence = VK_NULL_HANDLE,
-			std::vector<VkSemaphore> wait_semaphores = {},
-			std::vector<VkSemaphore> signal_semaphores = {},
-			VkPipelineStageFlags which_pipeline_stages_to_wait = 0,
-			uint32_t target_queue_index = 0) override;
+		using RecordFunction = std::function<void(CommandBuffer& command_buffer)>;
+		// Records only if it is invalid and returns true then, call it before recording the primaries of the frame.
+		// The inheritance info must be compatible with every render pass it is replayed in.
+		bool Bake(const RecordFunction& record, VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr);
+		// vkCmdExecuteCommands (Kept alive until the primary was submitted), a render pass must be begun with secondary_contents
+		void Replay(CommandBuffer& primary_command_buffer);
+		// Inside the record function: Resources used behind the tracked binds, e.g. images of a bindless heap (VkBuffer or VkImage)
+		template<typename VulkanHandle>
+		void DependOn(VulkanHandle handle) { assert(m_baked_dependencies && "Call DependOn() while baking!"); track_dependency(handle); }
+		void Invalidate();
+		bool IsValid() const;
 
 	public:
-		CommandBufferReset() = delete;
-		CommandBufferReset(std::shared_ptr<CommandPool> parent, VkCommandBufferLevel level) :
-			CommandBuffer{ parent, level } {}
-		virtual ~CommandBufferReset() override {};
-	};
+		CommandBufferBaked() = delete;
+		CommandBufferBaked(CommandPool& parent) :
+			CommandBuffer{ parent, VK_COMMAND_BUFFER_LEVEL_SECONDARY, CommandBufferPolicy::RESET } {}
+		~CommandBufferBaked();
 
-	class CommandBufferOneTime :
-		public CommandBuffer
-	{
-	public:
-		virtual void Begin(VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr) override;
-		virtual void End() override;
-		virtual void Submit(bool wait_queue_idle = false,
-			VkFence fence = VK_NULL_HANDLE,
-			std::vector<VkSemaphore> wait_semaphores = {},
-			std::vector<VkSemaphore> signal_semaphores = {},
-			VkPipelineStageFlags which_pipeline_stages_to_wait = 0,
-			uint32_t target_queue_index = 0) override;
+	private:
+		void unregister(); // From the invalidation list of the context
 
-	public:
-		CommandBufferOneTime() = delete;
-		CommandBufferOneTime(std::shared_ptr<CommandPool> parent, VkCommandBufferLevel level) :
-			CommandBuffer{ parent, level } {}
-		virtual ~CommandBufferOneTime() override {};
+	private:
+		std::atomic<bool> m_is_valid = false;
+		uint64_t m_swapchain_generation = 0; // Baked with
+		std::vector<uint64_t> m_dependencies; // Sorted, guarded by the context while registered
 	};
 
 	class RenderPass
@@ -128,11 +481,27 @@ namespace RHI
 		// All derived classes have to call initialize() before beginning the render pass.
 		virtual void Initialize();
 
-		virtual void Begin(std::shared_ptr<CommandBuffer> command_buffer);
+		// The subpass is recorded by secondary command buffers only with secondary_contents (RecordParallel(), CommandBufferBaked::Replay())
+		virtual void Begin(std::shared_ptr<CommandBuffer> command_buffer, bool secondary_contents = false);
 		const std::vector<GraphicsPipeline*>& GetGraphicsPipelines() {return m_graphics_pipelines; } // Call pipeline.Bind() first, and then callvkCmdDraw
+		// Multiple subpasses (See SubpassBuilder): Advance to the next one in order and track it in GetCurrentSubpass()
+		// (Recording vkCmdNextSubpass directly stays valid, but is not tracked)
+		void NextSubpass(CommandBuffer& command_buffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+		uint32_t GetCurrentSubpass() const { return m_current_subpass; }
 		virtual void End(std::shared_ptr<CommandBuffer> command_buffer);
 
+		// Split [0, draw_count) into ranges recorded by the worker pool into secondary command buffers,
+		// and then execute them in order. The primary must Begin() this render pass (Or NextSubpass() to it) with secondary contents first.
+		using RecordFunction = std::function<void(std::shared_ptr<CommandBuffer> secondary_command_buffer, uint32_t first, uint32_t count)>;
+		void RecordParallel(std::shared_ptr<CommandBuffer> primary_command_buffer, uint32_t subpass,
+			uint32_t draw_count, const RecordFunction& record, uint32_t range_count = 0 /*Worker Count*/);
+		// GPU-driven draws of the bound pipeline (Run IndirectDrawBuffer::CullCommand() before Begin())
+		void DrawIndirect(std::shared_ptr<CommandBuffer> command_buffer, IndirectDrawBuffer& indirect_draws);
+
 		void SetCurrentFrameBufferIndex(size_t index) { m_current_frame_buffer_index = index; }
+		// Retire m_framebuffers and call create_framebuffers() again (Begin() does it after the swap chain was recreated)
+		// The begin infos are prepared again, so clear values and render area changes are also applied here.
+		virtual void RecreateFramebuffers();
 		operator VkRenderPass() { return m_render_pass; }
 
 	protected:
@@ -143,13 +512,37 @@ namespace RHI
 		virtual void create_framebuffers() = 0;
 		virtual void create_pipelines() = 0;
 
+		// Queried by Initialize() and RecreateFramebuffers() only (Baked into the begin infos of this instance)
 		virtual std::vector<VkClearValue>	set_attachment_clear_colors() = 0;	// Note that the order of clearValues should be identical to the order of your attachments.
 		virtual VkRect2D								set_render_area()									/*[Optional]*/;
 
+		// [Optional]: Imageless framebuffer (VulkanContext::IsImagelessFramebufferSupported()). Non-empty attachments create one framebuffer
+		// of the render area instead of create_framebuffers(), and set_attachment_views() passes the views in every Begin().
+		// Swap chain recreations keep it, only a new render area extent recreates it.
+		struct ImagelessAttachment
+		{
+			VkImageUsageFlags usage; // Of the images the views will be created from
+			VkFormat format;
+			VkImageCreateFlags flags = 0;
+			uint32_t layer_count = 1;
+		};
+		using AttachmentViews = InlineVector<VkImageView, 8>;
+		virtual std::vector<ImagelessAttachment>	set_imageless_attachments() { return {}; } // Identical order to your attachments
+		virtual AttachmentViews							set_attachment_views(uint32_t swapchain_image_index) { return {}; } // Ditto
+
+		void initialize_graphics_pipelines(); // [Optional]: Call it in create_pipelines() to initialize m_graphics_pipelines in parallel
+
+		// [Optional]: MSAA attachments resolved at the end of the subpass (pResolveAttachments), the samples are cleared and never stored,
+		// so tile-based GPUs resolve on tile and only write the resolved attachment (Back them with VMA::AllocateMultisampledAttachment())
+		static VkAttachmentDescription make_multisampled_attachment(VkFormat format, VkSampleCountFlagBits samples, VkImageLayout layout);
+		static VkAttachmentDescription make_resolve_attachment(VkFormat format, VkImageLayout final_layout);
+		// [Optional]: Multiple subpasses with input attachments (e.g. G-buffer -> Lighting on tile) are derived by SubpassBuilder (vulkan_subpass.h)
+
 	protected:
 		std::shared_ptr<RHI::VulkanContext> m_context;
 		VkRenderPass m_render_pass = VK_NULL_HANDLE;
 		size_t m_current_frame_buffer_index = 0;
+		uint64_t m_swapchain_generation = 0; // Swap chain the framebuffers were created for
 
 		// You may use some enum classes to manage the following descriptiions
 		std::vector<VkFramebuffer> m_framebuffers;
@@ -159,12 +552,72 @@ namespace RHI
 		std::vector<VkSubpassDescription> m_subpass_descriptions;
 		std::vector<GraphicsPipeline*> m_graphics_pipelines;
 
+	private:
+		void prepare_begin_infos();
+		void create_imageless_framebuffer();
+		std::vector<VkClearValue> m_clear_values;
+		std::vector<VkRenderPassBeginInfo> m_begin_infos; // One per framebuffer (Begin() is a single vkCmdBeginRenderPass)
+		VkSubpassContents m_subpass_contents = VK_SUBPASS_CONTENTS_INLINE; // Of the current subpass
+		uint32_t m_current_subpass = 0; // Reset by Begin(), advanced by NextSubpass()
+		std::vector<ImagelessAttachment> m_imageless_attachments; // Empty: One framebuffer per swap chain image
+		VkExtent2D m_imageless_extent{}; // Of the imageless framebuffer
+
 	public:
 		RenderPass() = delete;
 		RenderPass(std::shared_ptr<RHI::VulkanContext> vulkan_context);
 		virtual ~RenderPass() noexcept;
 	};
 
+	class DynamicRenderPass
+	{
+	public:
+		// All derived classes have to call initialize() before beginning the render pass.
+		virtual void Initialize(); // Requires dynamicRendering (Vulkan 1.3)
+
+		// Attachments are queried via set_attachments() in every Begin(), so resizing the swapchain recreates nothing here.
+		// Transition the attachment layouts before Begin() (e.g. Image::TransitionCommand()), barriers are flushed here.
+		virtual void Begin(std::shared_ptr<CommandBuffer> command_buffer, bool secondary_contents = false /*RecordParallel()*/);
+		const std::vector<GraphicsPipeline*>& GetGraphicsPipelines() {return m_graphics_pipelines; }
+		virtual void End(std::shared_ptr<CommandBuffer> command_buffer);
+
+		// Same as RenderPass::RecordParallel(), the primary must Begin() this render pass with secondary_contents.
+		void RecordParallel(std::shared_ptr<CommandBuffer> primary_command_buffer,
+			uint32_t draw_count, const RenderPass::RecordFunction& record, uint32_t range_count = 0 /*Worker Count*/);
+		void DrawIndirect(std::shared_ptr<CommandBuffer> command_buffer, IndirectDrawBuffer& indirect_draws); // Same as RenderPass::DrawIndirect()
+
+		const RenderingFormats& GetRenderingFormats() const { return m_rendering_formats; } // Pass it to GraphicsPipeline
+
+	protected:
+		struct Attachments
+		{
+			std::vector<VkRenderingAttachmentInfo> colors; // Identical order to RenderingFormats::color_formats
+			std::optional<VkRenderingAttachmentInfo> depth;
+			std::optional<VkRenderingAttachmentInfo> stencil;
+			std::optional<VkRenderingFragmentShadingRateAttachmentInfoKHR> shading_rate; // ShadingRateImage::GetAttachmentInfo()
+		};
+		virtual RenderingFormats	set_rendering_formats()	= 0;
+		virtual Attachments			set_attachments()			= 0; // Per frame (e.g. the view of the current swapchain image)
+		virtual void						create_pipelines()			= 0;
+		virtual VkRect2D				set_render_area()			/*[Optional]*/;
+
+		void initialize_graphics_pipelines(); // [Optional]: Call it in create_pipelines() to initialize m_graphics_pipelines in parallel
+
+		// [Optional]: MSAA attachment of set_attachments() resolved into resolve_view by vkCmdEndRendering (Cleared, never stored,
+		// so tile-based GPUs resolve on tile). Depth and integer formats need SAMPLE_ZERO or another supported resolve mode.
+		static VkRenderingAttachmentInfo make_resolved_attachment(VkImageView multisampled_view, VkImageView resolve_view, VkImageLayout layout,
+			VkClearValue clear_value, VkResolveModeFlagBits resolve_mode = VK_RESOLVE_MODE_AVERAGE_BIT);
+
+	protected:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		RenderingFormats m_rendering_formats;
+		std::vector<GraphicsPipeline*> m_graphics_pipelines;
+
+	public:
+		DynamicRenderPass() = delete;
+		DynamicRenderPass(std::shared_ptr<RHI::VulkanContext> vulkan_context);
+		virtual ~DynamicRenderPass() noexcept;
+	};
+
 	class DescriptorBinding
 	{
 	public:
@@ -201,8 +654,103 @@ namespace RHI
 		};
 	};
 
+	// Specialization Constants of one pipeline variant (Shared by all stages, unused ids are ignored by the stages)
+	class SpecializationConstants
+	{
+	public:
+		template<typename T>
+		SpecializationConstants& Set(uint32_t constant_id, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= 8, "Specialization constants are scalars!");
+			if constexpr (std::is_same_v<T, bool>) return Set<VkBool32>(constant_id, value ? VK_TRUE : VK_FALSE);
+			else
+			{
+				assert(std::none_of(m_entries.begin(), m_entries.end(), [constant_id](const auto& entry) { return entry.constantID == constant_id; }) && "Duplicate constant id!");
+				m_entries.emplace_back(VkSpecializationMapEntry{ .constantID = constant_id, .offset = static_cast<uint32_t>(m_data.size()), .size = sizeof(T) });
+				auto bytes = reinterpret_cast<const uint8_t*>(&value);
+				m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+				m_hash = HashCombine(HashValue(constant_id, m_hash), HashBytes(bytes, sizeof(T)));
+				return *this;
+			}
+		}
+		uint64_t GetHash() const { return m_hash; } // Depends on the order of Set()
+		const VkSpecializationInfo* GetInfo() const; // Null if empty (Valid until the next Set())
+		bool IsEmpty() const { return m_entries.empty(); }
+
+	private:
+		std::vector<VkSpecializationMapEntry> m_entries;
+		std::vector<uint8_t> m_data;
+		uint64_t m_hash = HASH_SEED;
+		mutable VkSpecializationInfo m_info{};
+	};
+
+	class PipelineLayout // Hashed & Cached by VulkanContext::CreatePipelineLayout()
+	{
+	public:
+		const std::vector<uint8_t>& GetStateKey() const { return m_state_key; } // Serialized set layouts & push constant ranges
+		const std::vector<VkPushConstantRange>& GetPushConstantRanges() const { return m_push_constant_ranges; }
+		const PushConstantBlock& GetPushConstantBlock() const { return m_push_constant_block; }
+		uint64_t GetHash() const { return m_hash; }
+		operator VkPipelineLayout() const { return m_pipeline_layout; }
+
+		static std::vector<uint8_t> Serialize(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges);
+
+	public:
+		PipelineLayout() = delete;
+		PipelineLayout(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+			const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges);
+		~PipelineLayout();
+		PipelineLayout(const PipelineLayout&) = delete;
+
+	private:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+		std::vector<uint8_t> m_state_key;
+		std::vector<VkPushConstantRange> m_push_constant_ranges;
+		PushConstantBlock m_push_constant_block;
+		uint64_t m_hash;
+	};
+
+	// Pipeline Creation Feedback (Vulkan 1.3): Compile times and hits of the application pipeline cache, counted by RHIStatistics
+	// (PIPELINES_CREATED, PIPELINE_CACHE_HITS, PIPELINE_CREATION_NS). A driver update invalidates the cache and shows up as misses.
+	struct PipelineCreationFeedback
+	{
+		struct Stage
+		{
+			VkShaderStageFlagBits stage;
+			uint64_t duration_ns = 0;
+			bool cache_hit = false;
+			bool valid = false;	// Drivers may leave stages out
+		};
+		uint64_t duration_ns = 0;
+		bool cache_hit = false;
+		bool valid = false;		// False: Not supported by the device
+		std::vector<Stage> stages; // In the order of the create info
+	};
+
+	class PipelineStateObject // Deduplicated by VulkanContext::AcquirePipeline()
+	{
+	public:
+		const std::vector<uint8_t>& GetStateKey() const { return m_state_key; } // Serialized create info (Empty: Not shared, e.g. pipeline libraries)
+		uint64_t GetHash() const { return m_hash; }
+		operator VkPipeline() const { return m_pipeline; }
+
+	public:
+		PipelineStateObject() = delete;
+		PipelineStateObject(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkPipeline pipeline, std::vector<uint8_t> state_key = {}); // Takes the ownership
+		~PipelineStateObject(); // Deferred (Recorded command buffers may still use it)
+		PipelineStateObject(const PipelineStateObject&) = delete;
+
+	private:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		VkPipeline m_pipeline;
+		std::vector<uint8_t> m_state_key;
+		uint64_t m_hash;
+	};
+
 	class GraphicsPipeline
 	{
+		friend class VulkanContext; // Shader Hot Reload
 	public:
 		// All derived classes have to call initialize() before beginning the render pass.
 		virtual void Initialize();
@@ -212,16 +760,34 @@ namespace RHI
 		VkPipelineLayout& GetPipelineLayout() { return m_pipeline_layout; }
 		VkPipelineBindPoint GetPipelineBindPoint() const { return VK_PIPELINE_BIND_POINT_GRAPHICS; }
 		VkDescriptorSetLayout& GetDescriptorSetLayout(size_t index) { assert(index < m_descriptor_set_layouts.size()); return m_descriptor_set_layouts[index]; }
-		operator VkPipeline() { return m_pipeline; }
+		std::shared_ptr<DescriptorSetLayout> GetSharedDescriptorSetLayout(size_t index) { assert(index < m_shared_descriptor_set_layouts.size() && "Only reflected layouts are shared!"); return m_shared_descriptor_set_layouts[index]; }
+		const VertexInputLayout& GetVertexInputLayout() const { return m_vertex_input_layout; } // Pack your vertices with it
+		const PushConstantBlock& GetPushConstantBlock() const { return m_push_constant_block; } // CommandBuffer::Push()
+		operator VkPipeline() { return m_pipeline; } // Variant of prepare_specialization()
+		// Of m_pipeline compiled by Initialize() (Invalid if it was shared from the context registry)
+		const PipelineCreationFeedback& GetCreationFeedback() const { return m_creation_feedback; }
+
+		// Shader permutations of the same modules and layout (Compiled on first use, thread-safe)
+		// With graphics pipeline libraries, the variant is fast-linked from cached libraries and replaced by a link-time
+		// optimized pipeline compiled by the worker pool, so query it again at every frame instead of keeping the handle.
+		VkPipeline GetVariant(const SpecializationConstants& specialization);
+		void BindVariant(std::shared_ptr<RHI::CommandBuffer> command_buffer, const SpecializationConstants& specialization);
+
+		// Shader Hot Reload: Rebuilt on the worker pool when a file of prepare_shader_files() changes, and swapped in by the next
+		// FrameContext::BeginFrame() (Read m_pipeline or GetVariant() at every frame). Reloads that change the pipeline layout or
+		// the vertex input layout are rejected, since descriptor sets and vertex buffers depend on them.
+		void EnableHotReload();
 
 	protected:
 		virtual std::vector<VkDescriptorSetLayout>  						prepare_descriptor_layouts()			/* [Optional]: Layout will be reflected automatically*/;
 		virtual std::vector<VkPushConstantRange>						prepare_push_constant_state()		/* [Optional]: Layout will be reflected automatically*/;
 
-		enum ShaderTypes{vertex_shader, fragment_shader, MAX_SHADER_COUNT};
-		virtual std::array<std::string, MAX_SHADER_COUNT>		prepare_shader_files()						= 0; // Use ShaderTypes enum
+		virtual std::vector<std::string>										prepare_shader_files()						= 0; // Any order (Stages are reflected), task/mesh instead of vertex
 		virtual VkPipelineVertexInputStateCreateInfo						prepare_vertex_input_state()			/* [Optional]: Layout will be reflected automatically*/;
-		virtual VkPipelineTessellationStateCreateInfo					prepare_tessellation_state()			/* [Optional]*/;
+		virtual std::unordered_map<uint32_t, VkFormat>				prepare_vertex_attribute_formats()	/* [Optional]: Location -> Format overrides of the reflected layout (e.g. R16G16B16A16_SFLOAT, A2B10G10R10_SNORM_PACK32)*/;
+		virtual std::vector<ImmutableSamplerBinding>					prepare_immutable_samplers()		/* [Optional]: Baked into the reflected layouts (Writes skip their samplers)*/;
+		virtual std::optional<uint32_t>										prepare_push_descriptor_set()		/* [Optional]: Reflected set created as a push descriptor layout (CommandBuffer::PushDescriptors())*/;
+		virtual VkPipelineTessellationStateCreateInfo					prepare_tessellation_state()			/* [Optional]: Only used with tessellation shaders*/;
 		virtual VkPipelineInputAssemblyStateCreateInfo				prepare_input_assembly_state()	= 0;
 		virtual VkPipelineViewportStateCreateInfo							prepare_viewport_state()				= 0; // m_viewports & m_scissors
 		virtual VkPipelineRasterizationStateCreateInfo					prepare_rasterization_state()			= 0;
@@ -229,67 +795,298 @@ namespace RHI
 		virtual VkPipelineDepthStencilStateCreateInfo					prepare_depth_stencil_state()		/* [Optional]*/;
 		virtual VkPipelineColorBlendStateCreateInfo						prepare_color_blend_state()			= 0;
 		virtual VkPipelineDynamicStateCreateInfo							prepare_dynamic_state()				/* [Optional]*/;
+		virtual std::optional<VkPipelineFragmentShadingRateStateCreateInfoKHR> prepare_fragment_shading_rate_state() /* [Optional]: Needs VulkanContext::IsFragmentShadingRateSupported()*/;
+		virtual SpecializationConstants										prepare_specialization()				/* [Optional]: Default variant*/;
+
+		// [Optional]: Call it in the derived constructor, prepare_dynamic_state() then returns m_dynamic_states
+		// (Viewports, scissors, cull mode, front face, topology, depth & stencil tests). Set them on the command buffer before drawing.
+		// Return false and keep the static states if the device does not support Vulkan 1.3 extended dynamic state.
+		bool use_extended_dynamic_state();
+		// [Optional]: Call it in the derived constructor (after use_extended_dynamic_state()), the rate is then set per draw by
+		// CommandBuffer::SetFragmentShadingRate(). Return false if the device does not support VK_KHR_fragment_shading_rate.
+		bool use_dynamic_fragment_shading_rate();
+		// [Optional]: Call it in the derived constructor, only viewports and scissors are then set by CommandBuffer::SetViewports()
+		// and SetScissors() (Subset of use_extended_dynamic_state()). Return false without Vulkan 1.3 (Fill m_viewports & m_scissors).
+		bool use_dynamic_viewports();
+		// [Optional]: Call it in the derived constructor, the reflected layouts are then created for DescriptorBuffer sets instead of
+		// allocated descriptor sets (Also the pipelines). Return false if the device does not support VK_EXT_descriptor_buffer.
+		bool use_descriptor_buffers();
 
 	public:
 		GraphicsPipeline() = delete;
 		GraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context, 
 										VkRenderPass owner, uint32_t subpass_bind_point, 
 										VkPipeline base_pipeline = VK_NULL_HANDLE, int32_t base_pipeline_index = -1);
+		GraphicsPipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context, 
+										const RenderingFormats& rendering_formats, // Dynamic Rendering
+										VkPipeline base_pipeline = VK_NULL_HANDLE, int32_t base_pipeline_index = -1);
 		virtual ~GraphicsPipeline() noexcept;
 
 	protected:
-		VkShaderModule	create_shader_module(std::string_view shader_file, std::vector<char>& buffer);
+		struct ShaderProgram // Shaders of prepare_shader_files() (Replaced by hot reloads)
+		{
+			std::vector<std::string> files;
+			std::vector<std::shared_ptr<ShaderModule>> modules; // Shared with other pipelines
+			std::vector<std::shared_ptr<const ShaderReflection>> reflections;
+			std::vector<VkPipelineShaderStageCreateInfo> stage_infos;
+			VkShaderStageFlags stages = 0;
+		};
+		ShaderProgram load_shader_program(); // Validates the stages
+
+		std::shared_ptr<ShaderModule> create_shader_module(std::string_view shader_file); // From the context shader cache
+		// Calls prepare_xxx_state() again, library_parts != 0 creates a pipeline library with the states of these parts only
+		// Complete pipelines are looked up in the context registry first (Identical create infos of any pipeline class share one object)
+		std::shared_ptr<PipelineStateObject> create_pipeline(const ShaderProgram& shader_program, const VkSpecializationInfo* specialization_info,
+			VkGraphicsPipelineLibraryFlagsEXT library_parts = 0, PipelineCreationFeedback* creation_feedback = nullptr);
+		std::shared_ptr<PipelineStateObject> link_pipeline(const std::vector<VkPipeline>& libraries, bool link_time_optimization);
+		std::shared_ptr<PipelineStateObject> link_variant(uint64_t hash, const SpecializationConstants& specialization); // Locked by m_variant_mutex
 
 	protected:
 		std::shared_ptr<RHI::VulkanContext> m_context;
 		VkPipeline								m_pipeline								= VK_NULL_HANDLE;
 		VkPipelineLayout					m_pipeline_layout				= VK_NULL_HANDLE;
-		VkPipelineCache					m_pipeline_cache					= VK_NULL_HANDLE;
+		std::shared_ptr<PipelineStateObject> m_shared_pipeline;	// Owns m_pipeline
+		PipelineCreationFeedback		m_creation_feedback;				// Of m_shared_pipeline
+		std::shared_ptr<PipelineLayout> m_shared_pipeline_layout;	// Owns m_pipeline_layout
+		PushConstantBlock				m_push_constant_block;			// Of m_shared_pipeline_layout
+		VkPipelineCache					m_pipeline_cache					= VK_NULL_HANDLE; // Context Pipeline Cache
 		VkPipeline								m_base_pipeline					= VK_NULL_HANDLE;
 		int32_t									m_base_pipeline_index;
 
-		VkRenderPass						m_owner;
-		uint32_t									m_subpass_bind_point;
+		VkRenderPass						m_owner								= VK_NULL_HANDLE; // VK_NULL_HANDLE: Dynamic Rendering
+		uint32_t									m_subpass_bind_point			= 0;
+		RenderingFormats					m_rendering_formats;
 		std::vector<VkViewport>		m_viewports;
 		std::vector<VkRect2D>		m_scissors;
 		std::vector<VkDescriptorSetLayout> m_descriptor_set_layouts;
+		std::vector<std::shared_ptr<DescriptorSetLayout>> m_shared_descriptor_set_layouts; // Reflected layouts from the context cache
+		ShaderProgram						m_shader_program;
+		bool										m_reflected_descriptor_layouts	= false;
+		VertexInputLayout				m_vertex_input_layout;
+		VkVertexInputBindingDescription m_vertex_binding_description{};
+
+		std::vector<VkDynamicState>	m_dynamic_states; // Returned by the default prepare_dynamic_state()
+		bool										m_use_descriptor_buffers		= false;
+		uint64_t									m_fixed_state_hash				= 0; // PipelineDesc::HASH of DescribedGraphicsPipeline (0: Serialized)
+
+		SpecializationConstants		m_default_specialization;
+		std::mutex								m_variant_mutex;
+		std::unordered_map<uint64_t, std::shared_ptr<PipelineStateObject>> m_variants; // Specialization Hash -> Pipeline
+
+		// Graphics Pipeline Libraries (Cached independently, the interfaces do not depend on the specialization)
+		std::shared_ptr<PipelineStateObject> m_vertex_input_library;
+		std::shared_ptr<PipelineStateObject> m_fragment_output_library;
+		std::unordered_map<uint64_t, std::shared_ptr<PipelineStateObject>> m_pre_rasterization_libraries; // Specialization Hash -> Library
+		std::unordered_map<uint64_t, std::shared_ptr<PipelineStateObject>> m_fragment_shader_libraries;
+		std::vector<std::future<void>>	m_optimizing_jobs; // Waited by the destructor
+		uint64_t									m_program_generation			= 0; // Outdated optimizing jobs are dropped
+
+		// Shader Hot Reload (Guarded by the context hot reload lock)
+		bool										m_hot_reload_enabled			= false;
+		std::unique_ptr<ShaderProgram> m_reloaded_program;
+		std::shared_ptr<PipelineStateObject> m_reloaded_pipeline;
+
+	private:
+		void reload_shader_program(); // Worker thread (Throws if rejected)
+		void apply_hot_reload(); // Frame boundary
+	};
+
+	class ComputePipeline
+	{
+	public:
+		// Layouts are reflected like GraphicsPipeline, submit to m_device_queue_family_compute for async compute
+		virtual void Initialize();
+
+		void Bind(RHI::CommandBuffer& command_buffer);
+		void Dispatch(RHI::CommandBuffer& command_buffer, uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1); // Flushes queued barriers
+
+		VkPipelineLayout& GetPipelineLayout() { return m_pipeline_layout; }
+		VkPipelineBindPoint GetPipelineBindPoint() const { return VK_PIPELINE_BIND_POINT_COMPUTE; }
+		VkDescriptorSetLayout& GetDescriptorSetLayout(size_t index) { assert(index < m_descriptor_set_layouts.size()); return m_descriptor_set_layouts[index]; }
+		std::shared_ptr<DescriptorSetLayout> GetSharedDescriptorSetLayout(size_t index) { assert(index < m_shared_descriptor_set_layouts.size() && "Only reflected layouts are shared!"); return m_shared_descriptor_set_layouts[index]; }
+		const PushConstantBlock& GetPushConstantBlock() const { return m_push_constant_block; } // CommandBuffer::Push()
+		const PipelineCreationFeedback& GetCreationFeedback() const { return m_creation_feedback; }
+		operator VkPipeline() { return m_pipeline; }
+
+	protected:
+		virtual std::vector<VkDescriptorSetLayout>	prepare_descriptor_layouts()		/* [Optional]: Layout will be reflected automatically*/;
+		virtual std::vector<VkPushConstantRange>	prepare_push_constant_state()	/* [Optional]: Layout will be reflected automatically*/;
+		virtual std::string										prepare_shader_file()					= 0;
+		virtual std::vector<ImmutableSamplerBinding>	prepare_immutable_samplers()	/* [Optional]: Baked into the reflected layouts (Writes skip their samplers)*/;
+		virtual std::optional<uint32_t>						prepare_push_descriptor_set()	/* [Optional]: Reflected set created as a push descriptor layout (CommandBuffer::PushDescriptors())*/;
+		virtual const VkSpecializationInfo*				prepare_specialization_info()		/* [Optional]: e.g. Local size constants*/;
+
+		bool use_descriptor_buffers(); // [Optional]: See GraphicsPipeline::use_descriptor_buffers()
+
+	public:
+		ComputePipeline() = delete;
+		ComputePipeline(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+										VkPipeline base_pipeline = VK_NULL_HANDLE, int32_t base_pipeline_index = -1);
+		virtual ~ComputePipeline() noexcept;
+
+	protected:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		VkPipeline								m_pipeline								= VK_NULL_HANDLE;
+		VkPipelineLayout					m_pipeline_layout				= VK_NULL_HANDLE;
+		std::shared_ptr<PipelineLayout> m_shared_pipeline_layout;	// Owns m_pipeline_layout
+		PushConstantBlock				m_push_constant_block;			// Of m_shared_pipeline_layout
+		VkPipelineCache					m_pipeline_cache					= VK_NULL_HANDLE; // Context Pipeline Cache
+		VkPipeline								m_base_pipeline					= VK_NULL_HANDLE;
+		int32_t									m_base_pipeline_index;
+
+		std::vector<VkDescriptorSetLayout> m_descriptor_set_layouts;
+		std::vector<std::shared_ptr<DescriptorSetLayout>> m_shared_descriptor_set_layouts; // Reflected layouts from the context cache
+		std::shared_ptr<ShaderModule> m_shader_module; // Shared with other pipelines
+		bool m_use_descriptor_buffers = false;
+		PipelineCreationFeedback m_creation_feedback;
+	};
+
+	// Shader Objects (VulkanContext::IsShaderObjectSupported()): The graphics stages of shader_files compiled as linked VkShaderEXT
+	// objects from the shader cache, bound per draw without any VkPipeline. Layouts are reflected and shared like GraphicsPipeline,
+	// and every state is dynamic (Bind() sets them all), so material permutations cost no pipeline compilation (Tools, highly dynamic
+	// materials). Dynamic Rendering only, viewports & scissors are set by CommandBuffer::SetViewports() & SetScissors().
+	// The shaders are neither tracked by baked command buffers nor recorded by command captures.
+	class ShaderObjectProgram
+	{
+	public:
+		static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8;
+		struct State // See MakeShaderObjectState() of vulkan_pipeline_desc.h
+		{
+			VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			bool primitive_restart = false;
+			uint32_t patch_control_points = 3; // Tessellation programs
+			bool rasterizer_discard = false;
+			VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
+			VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
+			VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+			float line_width = 1.0f;
+			bool depth_clamp = false; // Requires depthClamp
+			bool depth_bias = false;
+			float depth_bias_constant_factor = 0.0f;
+			float depth_bias_clamp = 0.0f;
+			float depth_bias_slope_factor = 0.0f;
+			bool depth_test = true;
+			bool depth_write = true;
+			VkCompareOp depth_compare_op = VK_COMPARE_OP_LESS;
+			bool stencil_test = false; // Ops are set by CommandBuffer::SetStencilOp()
+			VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+			bool alpha_to_coverage = false;
+			std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments; // One per color attachment of the rendering
+		};
+		// Binds the shaders (Unbinding the other graphics stages) and the reflected vertex input, and sets every state of the draw.
+		// Devices with pipelineFragmentShadingRate also need one CommandBuffer::SetFragmentShadingRate() per command buffer.
+		void Bind(CommandBuffer& command_buffer, const State& state);
+
+		VkPipelineLayout& GetPipelineLayout() { return m_pipeline_layout; }
+		VkPipelineBindPoint GetPipelineBindPoint() const { return VK_PIPELINE_BIND_POINT_GRAPHICS; }
+		std::shared_ptr<DescriptorSetLayout> GetSharedDescriptorSetLayout(size_t index) { assert(index < m_shared_descriptor_set_layouts.size()); return m_shared_descriptor_set_layouts[index]; }
+		const VertexInputLayout& GetVertexInputLayout() const { return m_vertex_input_layout; } // Pack your vertices with it
+		const PushConstantBlock& GetPushConstantBlock() const { return m_push_constant_block; } // CommandBuffer::Push()
+		VkShaderStageFlags GetStages() const { return m_stages; }
+
+	public:
+		ShaderObjectProgram() = delete;
+		// shader_files: Any order (Stages are reflected), task/mesh instead of vertex. vertex_attribute_formats: See GraphicsPipeline.
+		ShaderObjectProgram(std::shared_ptr<RHI::VulkanContext> vulkan_context, const std::vector<std::string>& shader_files,
+			const SpecializationConstants& specialization = {}, const std::unordered_map<uint32_t, VkFormat>& vertex_attribute_formats = {});
+		~ShaderObjectProgram(); // Deferred (Recorded command buffers may still use them)
+		ShaderObjectProgram(const ShaderObjectProgram&) = delete;
 
 	private:
-		void deduce_pipeline_states_from_shaders(
-			std::vector<char>& vertex_shader, 
-			std::vector<char>& fragment_shader,
-			std::vector<VkDescriptorSetLayout>* descriptor_set_layouts, 
-			std::vector<VkPushConstantRange>* push_constants);
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		VkShaderStageFlags m_stages = 0;
+		std::vector<VkShaderStageFlagBits> m_bind_stages; // Every graphics stage of the device
+		std::vector<VkShaderEXT> m_bind_shaders; // VK_NULL_HANDLE: Unbound
+		std::vector<VkShaderEXT> m_shaders; // Owned
+
+		VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+		std::shared_ptr<PipelineLayout> m_shared_pipeline_layout; // Owns m_pipeline_layout
+		std::vector<std::shared_ptr<DescriptorSetLayout>> m_shared_descriptor_set_layouts; // Reflected layouts from the context cache
+		PushConstantBlock m_push_constant_block;
+		VertexInputLayout m_vertex_input_layout;
+		std::optional<VkVertexInputBindingDescription2EXT> m_vertex_binding; // None without vertex attributes
+		std::vector<VkVertexInputAttributeDescription2EXT> m_vertex_attributes;
 	};
 
-	class DescriptorSetLayout // Future: Hash & Cache
+	// Element of the packed data consumed by descriptor update templates
+	union DescriptorInfo
+	{
+		VkDescriptorBufferInfo	buffer;
+		VkDescriptorImageInfo		image;
+		VkBufferView						texel_buffer;
+	};
+
+	class DescriptorSetLayout // Hashed & Cached by VulkanContext::CreateDescripotrSetLayout()
 	{
 	public:
+		// Packed data is a DescriptorInfo array: each binding (ascending) takes descriptorCount elements
+		void UpdateDescriptorSet(VkDescriptorSet descriptor_set, const void* packed_data) const; // Not for push descriptor & descriptor buffer layouts
+		uint32_t GetPackedIndex(uint32_t binding) const; // First DescriptorInfo element of the binding
+		uint32_t GetPackedCount() const { return m_packed_count; }
+		VkDescriptorUpdateTemplate GetUpdateTemplate() const { return m_update_template; } // VK_NULL_HANDLE for push descriptor & descriptor buffer layouts
+
+		const std::vector<VkDescriptorSetLayoutBinding>& GetBindings() const { return m_bindings; } // Ascending binding index
+		bool HasImmutableSamplers(uint32_t binding) const; // Written without samplers
+		std::shared_ptr<Sampler> GetImmutableSampler(uint32_t binding) const; // Of the first array element (nullptr: None)
+		bool IsPushDescriptor() const { return m_flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR; } // Never allocated
+		bool IsDescriptorBuffer() const { return m_flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT; } // Sets are DescriptorBuffer ranges
+		VkDeviceSize GetDescriptorBufferSize() const { return m_descriptor_buffer_size; } // Bytes of one set
+		VkDeviceSize GetDescriptorBufferOffset(uint32_t binding) const; // Of the first array element
+		VkDescriptorSetLayoutCreateFlags GetFlags() const { return m_flags; }
+		uint64_t GetHash() const { return m_hash; }
+		bool IsIdentical(const std::vector<VkDescriptorSetLayoutBinding>& normalized_bindings, VkDescriptorSetLayoutCreateFlags flags) const;
 		operator VkDescriptorSetLayout() { return m_descriptor_set_layout; }
 
+		static std::vector<VkDescriptorSetLayoutBinding> Normalize(std::vector<VkDescriptorSetLayoutBinding> descriptor_bindings);
+		static uint64_t Hash(const std::vector<VkDescriptorSetLayoutBinding>& normalized_bindings, VkDescriptorSetLayoutCreateFlags flags);
+
 	public:
 		DescriptorSetLayout() = delete;
-		DescriptorSetLayout(std::shared_ptr<RHI::VulkanContext> vulkan_context, const std::vector<VkDescriptorSetLayoutBinding>& descriptor_bindings);
+		DescriptorSetLayout(std::shared_ptr<RHI::VulkanContext> vulkan_context, const std::vector<VkDescriptorSetLayoutBinding>& descriptor_bindings,
+			std::vector<std::shared_ptr<Sampler>> immutable_samplers = {}, VkDescriptorSetLayoutCreateFlags flags = 0);
 		~DescriptorSetLayout();
 
+	private:
+		void create_update_template();
+
 	private:
 		std::shared_ptr<RHI::VulkanContext> m_context;
 		VkDescriptorSetLayout m_descriptor_set_layout;
+		VkDescriptorSetLayoutCreateFlags m_flags;
+		std::vector<VkDescriptorSetLayoutBinding> m_bindings;
+		std::vector<std::vector<VkSampler>> m_immutable_samplers; // Parallel to m_bindings (pImmutableSamplers points here)
+		uint64_t m_hash;
+		std::vector<std::shared_ptr<Sampler>> m_immutable_sampler_owners; // Keep the handles of m_immutable_samplers valid
+
+		VkDescriptorUpdateTemplate m_update_template = VK_NULL_HANDLE;
+		std::vector<uint32_t> m_packed_indices; // Parallel to m_bindings
+		uint32_t m_packed_count = 0;
+
+		VkDeviceSize m_descriptor_buffer_size = 0; // Descriptor buffer layouts only
+		std::vector<VkDeviceSize> m_descriptor_buffer_offsets; // Parallel to m_bindings
 	};
 
 	class DescriptorSet
 	{
 	public:
-		void WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data);
+		void WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data,
+			VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		// *_DYNAMIC types bind the page at offset 0, pass GetDynamicOffset() when binding the set
+		void WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice);
+		// STORAGE_IMAGE descriptors need no sampler and are written in GENERAL (TransitionCommand() the image to ResourceAccess::StorageImage())
 		void WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data);
 		void WriteImages(VkDescriptorType image_type, std::vector<std::shared_ptr<VMA::Image>> data, uint32_t offset = 0);
+		// UNIFORM_TEXEL_BUFFER or STORAGE_TEXEL_BUFFER (e.g. VMA::Buffer::GetTexelView())
+		void WriteTexelBuffer(VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding, VkBufferView buffer_view, uint32_t array_element = 0);
+		void Update(const void* packed_struct); // Write all bindings at once (See DescriptorSetLayout::UpdateDescriptorSet())
 
 		std::shared_ptr<DescriptorSetLayout> GetDescriptorSetLayout() { return m_descriptor_set_layout; }
 
 	public:
 		DescriptorSet() = delete;
 		DescriptorSet(std::shared_ptr<DescriptorPool> parent, std::shared_ptr<DescriptorSetLayout> descriptor_set_layout);
-		~DescriptorSet();
+		DescriptorSet(std::shared_ptr<DescriptorPool> parent, std::shared_ptr<DescriptorSetLayout> descriptor_set_layout, VkDescriptorSet allocated_descriptor_set);
+		~DescriptorSet(); // Only freed individually if the parent pool allows it
 		operator VkDescriptorSet() { return m_descriptor_set; }
 
 	private:
@@ -298,45 +1095,260 @@ namespace RHI
 		std::shared_ptr<DescriptorSetLayout> m_descriptor_set_layout;
 	};
 
+	class DescriptorWriteBatch
+	{
+		friend class CommandBuffer; // Push Descriptors
+	public:
+		DescriptorWriteBatch& WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, VkBuffer buffer,
+			VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE, uint32_t array_element = 0);
+		DescriptorWriteBatch& WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data);
+		DescriptorWriteBatch& WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice);
+		DescriptorWriteBatch& WriteBuffer(VkDescriptorSet descriptor_set, VkDescriptorType buffer_type, uint32_t buffer_binding, BufferHandle buffer); // Whole buffer
+		DescriptorWriteBatch& WriteImage(VkDescriptorSet descriptor_set, VkDescriptorType image_type, uint32_t image_binding,
+			VkImageView image_view, VkImageLayout image_layout, VkSampler sampler = VK_NULL_HANDLE, uint32_t array_element = 0);
+		DescriptorWriteBatch& WriteImage(VkDescriptorSet descriptor_set, VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data);
+		DescriptorWriteBatch& WriteImage(VkDescriptorSet descriptor_set, VkDescriptorType image_type, uint32_t image_binding, ImageHandle image);
+		DescriptorWriteBatch& WriteTexelBuffer(VkDescriptorSet descriptor_set, VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding,
+			VkBufferView buffer_view, uint32_t array_element = 0);
+
+		void Flush(); // One vkUpdateDescriptorSets() for all pending writes (Or CommandBuffer::PushDescriptors() with VK_NULL_HANDLE sets)
+		size_t GetPendingWriteCount() const { return m_writes.size(); }
+
+	public:
+		DescriptorWriteBatch() = delete;
+		DescriptorWriteBatch(std::shared_ptr<RHI::VulkanContext> vulkan_context, size_t reserved_writes = 64);
+		~DescriptorWriteBatch(); // Flush pending writes
+		DescriptorWriteBatch(const DescriptorWriteBatch&) = delete;
+
+	private:
+		VkWriteDescriptorSet& push_write(VkDescriptorSet descriptor_set, VkDescriptorType type, uint32_t binding, uint32_t array_element);
+		void patch_writes(); // Point the writes to the infos
+		void clear();
+
+	private:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		// Storage keeps its capacity across flushes, so a long-lived batch stops allocating after warm-up
+		std::vector<VkWriteDescriptorSet>		m_writes;
+		std::vector<uint32_t>								m_info_indices; // Pointers are patched at Flush()
+		std::vector<VkDescriptorBufferInfo>	m_buffer_infos;
+		std::vector<VkDescriptorImageInfo>	m_image_infos;
+		std::vector<VkBufferView>						m_texel_buffer_views;
+	};
+
 	class DescriptorPool : public std::enable_shared_from_this<DescriptorPool>
 	{
 		friend class DescriptorSet;
+		friend class DescriptorAllocator;
 	public:
 		std::shared_ptr<DescriptorSet> AllocateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout);
+		void Reset(); // All sets allocated from this pool become invalid
+
+		bool CanFreeDescriptorSets() const { return m_flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; }
+		uint32_t GetAllocatedSetCount() const { return m_allocated_sets; }
 
 	public:
 		DescriptorPool() = delete;
-		DescriptorPool(std::shared_ptr<RHI::VulkanContext> vulkan_context, const std::vector<VkDescriptorPoolSize>& pool_size, uint32_t limit_max_sets);
+		DescriptorPool(std::shared_ptr<RHI::VulkanContext> vulkan_context, const std::vector<VkDescriptorPoolSize>& pool_size, uint32_t limit_max_sets,
+			VkDescriptorPoolCreateFlags flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 		~DescriptorPool();
 		operator VkDescriptorPool() { return m_descriptor_pool; }
 
+	private:
+		VkResult allocate(VkDescriptorSetLayout descriptor_set_layout, VkDescriptorSet* descriptor_set);
+		void free(VkDescriptorSet descriptor_set);
+
 	private:
 		std::shared_ptr<RHI::VulkanContext> m_context;
 		VkDescriptorPool	 m_descriptor_pool = VK_NULL_HANDLE;
+		VkDescriptorPoolCreateFlags m_flags;
+		std::atomic<uint32_t> m_allocated_sets{ 0 };
+	};
+
+	class DescriptorAllocator : public std::enable_shared_from_this<DescriptorAllocator>
+	{
+	public:
+		// Chains a new pool on VK_ERROR_OUT_OF_POOL_MEMORY / VK_ERROR_FRAGMENTED_POOL (Not thread-safe)
+		std::shared_ptr<DescriptorSet> AllocateDescriptorSet(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout);
+		VkDescriptorSet AllocateDescriptorSetHandle(DescriptorSetLayout& descriptor_set_layout); // No-free allocators only (Valid until Reset())
+		void Reset(); // Reset all pools at once (e.g. per-frame sets without individual frees)
+
+		std::shared_ptr<DescriptorPool> GetCurrentPool();
+		size_t GetPoolCount() const { return m_pools.size(); }
+		bool CanFreeDescriptorSets() const { return m_pool_flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; }
+
+	public:
+		DescriptorAllocator() = delete;
+		DescriptorAllocator(std::shared_ptr<RHI::VulkanContext> vulkan_context,
+			bool free_descriptor_sets = true, uint32_t initial_sets_per_pool = 128);
+
+	private:
+		VkDescriptorSet allocate(DescriptorSetLayout& descriptor_set_layout, std::shared_ptr<DescriptorPool>* allocated_pool);
+		std::shared_ptr<DescriptorPool> acquire_pool();
+		std::shared_ptr<DescriptorPool> create_pool();
+		void record_usage(const DescriptorSetLayout& descriptor_set_layout);
+
+	private:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		VkDescriptorPoolCreateFlags m_pool_flags;
+		uint32_t m_sets_per_pool;
+
+		std::vector<std::shared_ptr<DescriptorPool>> m_pools; // Chained pools
+		size_t m_current_pool = 0;
+
+		// Observed usage for sizing new pools
+		uint64_t m_observed_sets = 0;
+		std::unordered_map<VkDescriptorType, uint64_t> m_observed_descriptors;
+	};
+
+	class DescriptorArena
+	{
+	public:
+		// Call after the fence of this frame signaled, all handles of the last use of this frame become invalid
+		void BeginFrame(uint32_t frame_index);
+		void BeginFrame(uint32_t frame_index, Fence& frame_fence); // Wait the fence then reset
+		VkDescriptorSet Allocate(DescriptorSetLayout& descriptor_set_layout); // Plain handle without ownership (Not thread-safe)
+
+		uint32_t GetFrameIndex() const { return m_frame_index; }
+		uint32_t GetFrameCount() const { return static_cast<uint32_t>(m_frame_allocators.size()); }
+
+	public:
+		DescriptorArena() = delete;
+		DescriptorArena(std::shared_ptr<RHI::VulkanContext> vulkan_context, uint32_t frames_in_flight, uint32_t initial_sets_per_pool = 256);
+
+	private:
+		std::vector<std::shared_ptr<DescriptorAllocator>> m_frame_allocators;
+		uint32_t m_frame_index = 0;
+	};
+
+	// Content-addressed Descriptor Sets (e.g. Static materials): Sets are keyed by their layout and their writes, so a request identical
+	// to a cached set returns it instead of allocating and writing a new one. Entries referencing a buffer or image are evicted when it is
+	// destroyed or moved (VulkanContext::InvalidateBakedCommands()), holders of an evicted set keep it alive. Thread-safe.
+	class DescriptorSetCache
+	{
+		friend class RHI::VulkanContext;
+	public:
+		// Writes of one set (Same rules as DescriptorSet, only issued on a miss), in any order
+		class Contents
+		{
+			friend class DescriptorSetCache;
+		public:
+			Contents& WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, std::shared_ptr<VMA::Buffer> data,
+				VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE, uint32_t array_element = 0);
+			Contents& WriteBuffer(VkDescriptorType buffer_type, uint32_t buffer_binding, const VMA::BufferSuballocator::Slice& slice);
+			Contents& WriteImage(VkDescriptorType image_type, uint32_t image_binding, std::shared_ptr<VMA::Image> data, uint32_t array_element = 0);
+			Contents& WriteTexelBuffer(VkDescriptorType texel_buffer_type, uint32_t texel_buffer_binding, std::shared_ptr<VMA::Buffer> data,
+				VkFormat format, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE, uint32_t array_element = 0);
+
+		public:
+			Contents() = delete;
+			Contents(std::shared_ptr<DescriptorSetLayout> descriptor_set_layout) : m_descriptor_set_layout{ std::move(descriptor_set_layout) } {}
+
+		private:
+			struct Write
+			{
+				VkDescriptorType type;
+				uint32_t binding;
+				uint32_t array_element;
+				uint64_t resource; // VkBuffer or VkImage (Evicts the entry)
+				VkDescriptorBufferInfo buffer_info{};
+				VkDescriptorImageInfo image_info{};
+				VkBufferView texel_buffer_view = VK_NULL_HANDLE;
+
+				bool operator==(const Write& other) const;
+			};
+			std::shared_ptr<DescriptorSetLayout> m_descriptor_set_layout;
+			std::vector<Write> m_writes;
+		};
+		struct Statistics
+		{
+			size_t entries = 0;
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0; // By destroyed or moved resources
+		};
+
+		std::shared_ptr<DescriptorSet> GetDescriptorSet(Contents contents);
+		void Clear(); // e.g. After unloading a level (Holders keep their sets)
+		Statistics GetStatistics();
+
+	public:
+		DescriptorSetCache() = delete;
+		DescriptorSetCache(std::shared_ptr<RHI::VulkanContext> vulkan_context, uint32_t initial_sets_per_pool = 128);
+		~DescriptorSetCache();
+		DescriptorSetCache(const DescriptorSetCache&) = delete;
+
+	private:
+		// Called by VulkanContext::InvalidateBakedCommands(), the evicted sets are released by the caller (Outside of the locks)
+		void evict(uint64_t resource, std::vector<std::shared_ptr<DescriptorSet>>& evicted_sets);
+
+	private:
+		struct Entry
+		{
+			std::shared_ptr<DescriptorSet> descriptor_set;
+			std::vector<Contents::Write> writes; // Sorted by binding & array element
+		};
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		std::mutex m_mutex;
+		std::shared_ptr<DescriptorAllocator> m_allocator; // Frees individual sets
+		std::unordered_map<uint64_t, Entry> m_entries; // Hash of the layout & writes
+		std::unordered_multimap<uint64_t, uint64_t> m_dependents; // Resource -> Entry keys
+		Statistics m_statistics;
 	};
 
 	class Sampler
 	{
+	public:
+		struct Desc
+		{
+			VkFilter mag_filter = VK_FILTER_LINEAR;
+			VkFilter min_filter = VK_FILTER_LINEAR;
+			VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			VkSamplerAddressMode address_mode_u = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			VkSamplerAddressMode address_mode_v = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			VkSamplerAddressMode address_mode_w = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			VkBorderColor border_color = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+			VkCompareOp compare_op = VK_COMPARE_OP_NEVER; // NEVER: Compare disabled
+			bool anisotropy_enable = true; // maxSamplerAnisotropy
+			float mip_lod_bias = 0.0f;
+			float min_lod = 0.0f;
+			float max_lod = VK_LOD_CLAMP_NONE; // All levels of the image view
+
+			uint64_t Hash() const;
+			bool operator==(const Desc&) const = default;
+		};
+		const Desc& GetDesc() const { return m_desc; }
+
 	public:
 		Sampler() = delete;
-		Sampler(std::shared_ptr<RHI::VulkanContext> vulkan_context,
-						VkSamplerAddressMode address_mode,
-						VkBorderColor border_color = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-						VkCompareOp compare_mode = VK_COMPARE_OP_NEVER,
-						bool anisotropy_enable = true);
+		Sampler(std::shared_ptr<RHI::VulkanContext> vulkan_context, const Desc& desc); // VulkanContext::CreateSampler() (Cached)
 		~Sampler();
-		operator VkSampler() { return m_sampler; }
+		Sampler(const Sampler&) = delete;
+		operator VkSampler() const { return m_sampler; }
 
 	private:
 		std::shared_ptr<RHI::VulkanContext> m_context;
+		const Desc m_desc;
 		VkSampler m_sampler;
 	};
 
 	class Semaphore
 	{
+	public:
+		// Timeline Semaphore Only
+		bool IsTimeline() const { return m_is_timeline; }
+		uint64_t GetCounterValue();
+		bool IsComplete(uint64_t value) { return GetCounterValue() >= value; }
+		void Wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+		void Signal(uint64_t value); // Signal on the host
+		// External Timeline Semaphore (VulkanContext::IsExternalMemorySupported()): Orders the frames shared with another process
+		ExternalHandle Export(); // Exportable only, the caller owns the handle (CloseExternalHandle())
+		void Import(ExternalHandle handle); // Replaces the payload permanently (Consumes a file descriptor, not a Win32 handle)
+
 	public:
 		Semaphore() = delete;
-		Semaphore(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkSemaphoreCreateFlags flags);
+		Semaphore(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkSemaphoreCreateFlags flags); // Binary (Recycled by the SyncPool)
+		Semaphore(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkSemaphoreCreateFlags flags, uint64_t timeline_initial_value,
+			bool is_exportable = false); // Timeline
 		~Semaphore();
 		Semaphore(const Semaphore&) = delete;
 		Semaphore(Semaphore&& rvalue) noexcept;
@@ -345,6 +1357,123 @@ namespace RHI
 	private:
 		std::shared_ptr<RHI::VulkanContext> m_context;
 		VkSemaphore m_semaphore = VK_NULL_HANDLE;
+		bool m_is_timeline = false;
+		bool m_is_exportable = false;
+	};
+
+	class QueueTimeline // Global Object (VulkanContext::GetGlobalQueueTimeline())
+	{
+	public:
+		using WaitInfo = SemaphoreWaitInfo;
+		// Every submission signals the next tick (Thread-safe, the queue is externally synchronized here)
+		// Short lists are converted on the stack, so submitting does not allocate (See InlineVector)
+		uint64_t Submit(std::span<const VkCommandBuffer> command_buffers,
+			std::span<const WaitInfo> wait_semaphores = {},
+			std::span<const VkSemaphore> signal_semaphores = {},
+			VkFence fence = VK_NULL_HANDLE);
+		// Synchronization2 version (Falls back to vkQueueSubmit on devices without synchronization2)
+		uint64_t Submit2(std::span<const VkCommandBufferSubmitInfo> command_buffers,
+			std::span<const VkSemaphoreSubmitInfo> wait_semaphores,
+			std::span<const VkSemaphoreSubmitInfo> signal_semaphores, // The tick signal is appended to a copy on the stack
+			VkFence fence = VK_NULL_HANDLE);
+
+		bool IsComplete(uint64_t tick) { return tick <= m_completed_tick || tick <= (m_completed_tick = m_semaphore.GetCounterValue()); }
+		void Wait(uint64_t tick, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+		uint64_t GetSubmittedTick() const { return m_submitted_tick; }
+		uint64_t GetCompletedTick() { return m_completed_tick = m_semaphore.GetCounterValue(); }
+		GPUAwaitable Completion(uint64_t tick); // co_await queue_timeline.Completion(tick) (See CompletionPoller)
+
+		VkSemaphore GetSemaphore() { return m_semaphore; } // Wait it on other queues with a tick value
+		VkQueue GetQueue() const { return m_queue; }
+
+		// Submission Thread (Optional, needs synchronization2): Submit() only copies a packet into a lock-free ring,
+		// the thread coalesces ready packets into one vkQueueSubmit2. Enable it before the queue is shared by other threads.
+		// Binary semaphores signaled here reach the driver later, call Flush() before waiting them outside of this queue.
+		void EnableSubmissionThread(uint32_t ring_capacity = 256);
+		bool IsSubmissionThreadEnabled() const { return m_submission_thread.joinable(); }
+		void Flush(); // Wait until every enqueued packet was passed to the driver
+		VkResult Present(const VkPresentInfoKHR& present_info); // vkQueuePresentKHR (Externally synchronized with the submissions)
+		// vkQueueBindSparse (Ditto, sparse binding families only). No tick is signaled, chain the signals into bind_info.
+		void BindSparse(const VkBindSparseInfo& bind_info, VkFence fence = VK_NULL_HANDLE);
+
+	public:
+		QueueTimeline() = delete;
+		QueueTimeline(std::shared_ptr<RHI::VulkanContext> vulkan_context, QueueFamilyIndex& queue_family_index, uint32_t queue_index = 0);
+		~QueueTimeline();
+
+	private:
+		VulkanContext* const m_context; // Semaphore keeps the context alive
+		VkQueue m_queue;
+		Semaphore m_semaphore;
+		std::mutex m_mutex; // Held around the driver calls
+		std::atomic<uint64_t> m_submitted_tick{ 0 };
+		std::atomic<uint64_t> m_completed_tick{ 0 }; // Cached
+
+	private:
+		// Bounded MPSC ring (Producers claim the positions in tick order)
+		struct SubmitPacket
+		{
+			std::atomic<uint64_t> sequence{ 0 }; // == position: Free, == position + 1: Ready
+			std::vector<VkCommandBufferSubmitInfo> command_buffers;
+			std::vector<VkSemaphoreSubmitInfo> wait_semaphores;
+			std::vector<VkSemaphoreSubmitInfo> signal_semaphores; // The tick signal is the last one
+			VkFence fence = VK_NULL_HANDLE;
+		};
+		std::unique_ptr<SubmitPacket[]> m_submit_ring;
+		uint32_t m_submit_ring_capacity = 0;
+		uint64_t m_submit_ring_tick_base = 0; // Submitted tick when the thread was enabled
+		std::atomic<uint64_t> m_enqueue_position{ 0 };
+		std::atomic<uint64_t> m_retired_position{ 0 }; // Passed to the driver
+		std::atomic<uint64_t> m_doorbell{ 0 }; // Wakes the submission thread
+		std::atomic<bool> m_stop_submission_thread{ false };
+		std::thread m_submission_thread;
+
+		uint64_t enqueue(std::span<const VkCommandBufferSubmitInfo> command_buffers,
+			std::span<const VkSemaphoreSubmitInfo> wait_semaphores,
+			std::span<const VkSemaphoreSubmitInfo> signal_semaphores,
+			VkFence fence);
+		void submission_loop();
+	};
+
+	class SubmitBatch
+	{
+	public:
+		// Accumulate across many recorders (Thread-safe)
+		SubmitBatch& Add(VkCommandBuffer command_buffer);
+		SubmitBatch& Add(CommandBuffer& command_buffer) { return Add(static_cast<VkCommandBuffer>(command_buffer)); }
+		SubmitBatch& Wait(VkSemaphore semaphore, VkPipelineStageFlags2 stages, uint64_t value = 0 /*Binary*/);
+		SubmitBatch& Signal(VkSemaphore semaphore, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, uint64_t value = 0 /*Binary*/);
+
+		uint64_t Flush(VkFence fence = VK_NULL_HANDLE); // One vkQueueSubmit2, return the tick of the queue timeline
+		bool IsEmpty() const { return m_command_buffers.empty() && m_wait_semaphores.empty() && m_signal_semaphores.empty(); }
+
+	public:
+		SubmitBatch() = delete;
+		SubmitBatch(std::shared_ptr<QueueTimeline> queue_timeline, size_t reserved_command_buffers = 16);
+
+	private:
+		std::shared_ptr<QueueTimeline> m_queue_timeline;
+		std::mutex m_mutex;
+		// Storage keeps its capacity across flushes
+		std::vector<VkCommandBufferSubmitInfo> m_command_buffers;
+		std::vector<VkSemaphoreSubmitInfo> m_wait_semaphores;
+		std::vector<VkSemaphoreSubmitInfo> m_signal_semaphores;
+	};
+
+	class Event
+	{
+	public:
+		void Reset(); // On the host (Device-only events must be reset by vkCmdResetEvent2)
+
+		Event() = delete;
+		Event(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkEventCreateFlags flags);
+		~Event();
+		Event(const Event&) = delete;
+		operator VkEvent() { return m_event; }
+
+	private:
+		std::shared_ptr<RHI::VulkanContext> m_context;
+		VkEvent m_event = VK_NULL_HANDLE;
 	};
 
 	class Fence
@@ -352,14 +1481,25 @@ namespace RHI
 	public:
 		void Wait(bool reset = false, uint64_t timeout = std::numeric_limits<uint64_t>::max());
 		void Reset();
+		bool IsSignaled(); // Non-blocking poll
+		GPUAwaitable operator co_await(); // Do not reset the fence before the coroutine was resumed (See CompletionPoller)
+
+		// Batched (One vkWaitForFences / vkResetFences call, all fences must come from the same context)
+		// Return false on timeout. Poll IsSignaled() after WaitAny() to find the completed fences.
+		static bool WaitAll(std::span<Fence* const> fences, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+		static bool WaitAny(std::span<Fence* const> fences, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+		static void ResetAll(std::span<Fence* const> fences);
 
 		Fence() = delete;
-		Fence(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkFenceCreateFlags flags);
+		Fence(std::shared_ptr<RHI::VulkanContext> vulkan_context, VkFenceCreateFlags flags); // Recycled by the SyncPool
 		~Fence();
 		Fence(const Fence&) = delete;
 		Fence(Fence&& rvalue) noexcept;
 		operator VkFence() { return m_fence; }
 
+	private:
+		static bool wait(std::span<Fence* const> fences, VkBool32 wait_all, uint64_t timeout);
+
 	private:
 		std::shared_ptr<RHI::VulkanContext> m_context;
 		VkFence m_fence = VK_NULL_HANDLE;
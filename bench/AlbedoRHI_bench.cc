@@ -0,0 +1,296 @@
+// AlbedoRHI_bench: Headless microbenchmarks of the RHI hot paths
+// Usage: AlbedoRHI_bench [--output <file.json>] [--iterations <scale>] [--compute-shader <shader.spv>]
+// Results are written as one JSON document (stdout by default), compare them across versions to catch regressions.
+
+#include <AlbedoRHI.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+// Heap allocations of the measured loops (Every operator new of the process is counted)
+static std::atomic<uint64_t> HEAP_ALLOCATIONS{ 0 };
+
+void* operator new(std::size_t size)
+{
+	HEAP_ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size ? size : 1)) return memory;
+	throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+namespace
+{
+	using namespace Albedo::RHI;
+
+	struct Result
+	{
+		std::string name;
+		uint64_t iterations = 0;
+		double ns_per_op = 0.0;
+		double allocations_per_op = 0.0;	// Heap allocations
+		double bytes_per_second = 0.0;		// Throughput benchmarks only
+		std::string skipped;							// Reason, empty if measured
+	};
+
+	// Runs body(iteration) iterations times after a short warm-up, finish() is timed once after the loop (e.g. waiting the GPU)
+	template<typename Body, typename Finish>
+	Result Measure(std::string name, uint64_t iterations, uint64_t bytes_per_op, Body&& body, Finish&& finish)
+	{
+		for (uint64_t iteration = 0; iteration < std::max<uint64_t>(iterations / 10, 1); ++iteration) body(iteration);
+		finish();
+
+		uint64_t allocations = HEAP_ALLOCATIONS.load(std::memory_order_relaxed);
+		auto begin = std::chrono::steady_clock::now();
+		for (uint64_t iteration = 0; iteration < iterations; ++iteration) body(iteration);
+		finish();
+		auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+		allocations = HEAP_ALLOCATIONS.load(std::memory_order_relaxed) - allocations;
+
+		return Result
+		{
+			.name = std::move(name),
+			.iterations = iterations,
+			.ns_per_op = elapsed / iterations,
+			.allocations_per_op = static_cast<double>(allocations) / iterations,
+			.bytes_per_second = bytes_per_op ? bytes_per_op * iterations / (elapsed * 1e-9) : 0.0
+		};
+	}
+
+	template<typename Body>
+	Result Measure(std::string name, uint64_t iterations, Body&& body) { return Measure(std::move(name), iterations, 0, std::forward<Body>(body), [] {}); }
+
+	Result Skipped(std::string name, std::string reason) { return Result{ .name = std::move(name), .skipped = std::move(reason) }; }
+
+	class BenchComputePipeline : public ComputePipeline
+	{
+	public:
+		BenchComputePipeline(std::shared_ptr<VulkanContext> vulkan_context, std::string shader_file) :
+			ComputePipeline{ std::move(vulkan_context) }, m_shader_file{ std::move(shader_file) } {}
+	protected:
+		std::string prepare_shader_file() override { return m_shader_file; }
+	private:
+		std::string m_shader_file;
+	};
+
+	void WaitIdle(VulkanContext& context)
+	{
+		vkDeviceWaitIdle(context.m_device);
+		context.GetDeletionQueue().Collect();
+	}
+
+	std::vector<Result> RunBenchmarks(std::shared_ptr<VulkanContext> context, uint64_t scale, const std::string& compute_shader)
+	{
+		std::vector<Result> results;
+		auto& allocator = *context->m_memory_allocator;
+
+		// Descriptor Sets (Global allocator of this thread)
+		{
+			auto layout = context->CreateDescripotrSetLayout({ VkDescriptorSetLayoutBinding
+				{
+					.binding = 0,
+					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+					.descriptorCount = 1,
+					.stageFlags = VK_SHADER_STAGE_ALL
+				} });
+			auto uniformBuffer = allocator.AllocateBuffer(256, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+			results.emplace_back(Measure("descriptor_set_allocate_write_free", 10000 * scale, [&](uint64_t)
+				{
+					auto descriptorSet = context->CreateDescriptorSet(layout);
+					descriptorSet->WriteBuffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, uniformBuffer);
+				}));
+		}
+
+		// Command Buffers (Empty one-time command buffers, the GPU is drained once after the loop)
+		results.emplace_back(Measure("command_buffer_allocate_submit", 2000 * scale, 0, [&](uint64_t)
+			{
+				auto commandBuffer = context->CreateOneTimeCommandBuffer(context->m_device_queue_family_graphics);
+				commandBuffer->Begin();
+				commandBuffer->End();
+				commandBuffer->Submit();
+			},
+			[&] { WaitIdle(*context); }));
+
+		// Allocations (Released through the deletion queue)
+		results.emplace_back(Measure("allocate_buffer_64KiB", 2000 * scale, 0, [&](uint64_t iteration)
+			{
+				auto buffer = allocator.AllocateBuffer(64 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+				if (iteration % 256 == 0) context->GetDeletionQueue().Collect();
+			},
+			[&] { WaitIdle(*context); }));
+		results.emplace_back(Measure("allocate_image_256x256_rgba8", 1000 * scale, 0, [&](uint64_t iteration)
+			{
+				auto image = allocator.AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+					256, 256, 4, VK_FORMAT_R8G8B8A8_UNORM);
+				if (iteration % 256 == 0) context->GetDeletionQueue().Collect();
+			},
+			[&] { WaitIdle(*context); }));
+
+		// Staging Upload Bandwidth (Upload Engine, one batch per upload)
+		{
+			constexpr VkDeviceSize UPLOAD_SIZE = 4 * 1024 * 1024;
+			auto destination = allocator.AllocateBuffer(UPLOAD_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+			std::vector<std::byte> payload(UPLOAD_SIZE, std::byte{ 0x5A });
+			auto& uploadEngine = context->GetUploadEngine();
+			results.emplace_back(Measure("staging_upload_4MiB", 100 * scale, UPLOAD_SIZE, [&](uint64_t)
+				{
+					uploadEngine.UploadBuffer(destination, payload.data(), UPLOAD_SIZE);
+					uploadEngine.Wait(uploadEngine.Flush());
+				},
+				[] {}));
+			WaitIdle(*context);
+		}
+
+		// Pipeline Creation (Cold: fresh context without shader & pipeline caches, Warm: the same shader again)
+		if (compute_shader.empty())
+		{
+			results.emplace_back(Skipped("pipeline_create_cold", "No --compute-shader given"));
+			results.emplace_back(Skipped("pipeline_create_warm", "No --compute-shader given"));
+		}
+		else
+		{
+			uint64_t coldIterations = std::max<uint64_t>(5 * scale, 1);
+			double coldNanoseconds = 0.0;
+			for (uint64_t iteration = 0; iteration < coldIterations; ++iteration)
+			{
+				auto coldContext = VulkanContext::CreateHeadless({ 64, 64 }, 2);
+				auto begin = std::chrono::steady_clock::now();
+				BenchComputePipeline pipeline{ coldContext, compute_shader };
+				pipeline.Initialize();
+				coldNanoseconds += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+			}
+			results.emplace_back(Result{ .name = "pipeline_create_cold", .iterations = coldIterations, .ns_per_op = coldNanoseconds / coldIterations });
+
+			BenchComputePipeline(context, compute_shader).Initialize(); // Populate the caches
+			results.emplace_back(Measure("pipeline_create_warm", 50 * scale, [&](uint64_t)
+				{
+					BenchComputePipeline pipeline{ context, compute_shader };
+					pipeline.Initialize();
+				}));
+		}
+
+		// Acquire-Present Latency (Empty frames through the headless swap chain)
+		{
+			auto frameContext = context->CreateFrameContext(2);
+			results.emplace_back(Measure("frame_acquire_present", 500 * scale, 0, [&](uint64_t)
+				{
+					frameContext->BeginFrame();
+					frameContext->EndFrame();
+				},
+				[&] { WaitIdle(*context); }));
+			// Transient bookkeeping from the frame allocator (No heap allocations once its capacity was reached)
+			results.emplace_back(Measure("frame_allocator_transient_vectors", 500 * scale, 0, [&](uint64_t iteration)
+				{
+					frameContext->BeginFrame();
+					std::pmr::vector<VkWriteDescriptorSet> writes{ &frameContext->GetFrameAllocator() };
+					std::pmr::vector<VkDescriptorImageInfo> imageInfos{ &frameContext->GetFrameAllocator() };
+					writes.resize(64 + iteration % 64);
+					imageInfos.resize(writes.size());
+					frameContext->EndFrame();
+				},
+				[&] { WaitIdle(*context); }));
+		}
+
+		// CPU Instance Culling (100k instances of 64 meshes on a grid, about half of them in the frustum)
+		{
+			constexpr uint32_t INSTANCE_COUNT = 100000, MESH_COUNT = 64;
+			IndirectDrawBuffer draws{ context, IndirectDrawBuffer::CommandType::DRAW_INDEXED, MESH_COUNT, true };
+			for (auto transformFormat : { InstanceCuller::TransformFormat::FLOAT_3X4, InstanceCuller::TransformFormat::HALF_3X4 })
+			{
+				InstanceCuller culler{ transformFormat };
+				for (uint32_t mesh = 0; mesh < MESH_COUNT; ++mesh) culler.AddMesh({ .index_count = 36 });
+				for (uint32_t instance = 0; instance < INSTANCE_COUNT; ++instance)
+				{
+					const float x = static_cast<float>(instance % 316) - 158.0f, z = static_cast<float>(instance / 316) - 158.0f;
+					culler.Add(instance % MESH_COUNT, { 1, 0, 0, x, 0, 1, 0, 0, 0, 0, 1, z }, { 0, 0, 0, 0.87f });
+				}
+				auto instanceBuffer = allocator.AllocateBuffer(static_cast<size_t>(INSTANCE_COUNT) * culler.GetTransformStride(),
+					VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, true, false, true);
+				// Orthographic view of x in [-158, 158], z in [-158, 0] (Column-major, Vulkan depth)
+				const auto frustum = InstanceCuller::ExtractFrustum({ 1.0f / 158, 0, 0, 0, 0, 0, 1.0f / 316, 0, 0, 1.0f / 79, 0, 0, 0, 1, 0.5f, 1 });
+				const bool isHalf = transformFormat == InstanceCuller::TransformFormat::HALF_3X4;
+				results.emplace_back(Measure(isHalf ? "instance_cull_pack_100k_half" : "instance_cull_pack_100k_float", 100 * scale, [&](uint64_t)
+					{
+						culler.Cull(frustum, *instanceBuffer, draws);
+					}));
+			}
+		}
+		return results;
+	}
+
+	std::string Escape(std::string_view text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	void WriteJson(std::ostream& output, VulkanContext& context, const std::vector<Result>& results)
+	{
+		output << "{\n";
+		output << "  \"device\": \"" << Escape(context.m_physical_device_properties.deviceName) << "\",\n";
+		output << "  \"driver_version\": " << context.m_physical_device_properties.driverVersion << ",\n";
+		output << "  \"benchmarks\": [\n";
+		for (size_t index = 0; index < results.size(); ++index)
+		{
+			const auto& result = results[index];
+			output << "    { \"name\": \"" << result.name << "\"";
+			if (!result.skipped.empty()) output << ", \"skipped\": \"" << Escape(result.skipped) << "\"";
+			else
+			{
+				output << ", \"iterations\": " << result.iterations
+					<< ", \"ns_per_op\": " << result.ns_per_op
+					<< ", \"allocations_per_op\": " << result.allocations_per_op;
+				if (result.bytes_per_second > 0.0) output << ", \"bytes_per_second\": " << result.bytes_per_second;
+			}
+			output << " }" << (index + 1 < results.size() ? "," : "") << "\n";
+		}
+		output << "  ]\n}\n";
+	}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::string outputFile;
+	std::string computeShader;
+	uint64_t scale = 1;
+	for (int index = 1; index + 1 < argc; index += 2)
+	{
+		std::string_view option = argv[index];
+		if (option == "--output") outputFile = argv[index + 1];
+		else if (option == "--iterations") scale = std::max<uint64_t>(std::strtoull(argv[index + 1], nullptr, 10), 1);
+		else if (option == "--compute-shader") computeShader = argv[index + 1];
+		else
+		{
+			std::cerr << "Unknown option " << option << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	try
+	{
+		auto context = Albedo::RHI::VulkanContext::CreateHeadless({ 256, 256 }, 3);
+		auto results = RunBenchmarks(context, scale, computeShader);
+		if (outputFile.empty()) WriteJson(std::cout, *context, results);
+		else
+		{
+			std::ofstream file(outputFile, std::ios::trunc);
+			WriteJson(file, *context, results);
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << "AlbedoRHI_bench failed: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
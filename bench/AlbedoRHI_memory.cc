@@ -0,0 +1,293 @@
+// AlbedoRHI_memory: Headless memory footprint of the RHI objects, per resource type
+// Usage: AlbedoRHI_memory [--output <file.json>] [--count <objects per type>] [--compute-shader <shader.spv>]
+// Creates representative sets of each type and reports the live bytes per object: C++ heap (Wrappers, shared_ptr control blocks ...),
+// driver host memory (Tracking HostAllocator) and device memory (VMA statistics). Pin them across releases to catch regressions.
+
+#include <AlbedoRHI.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+// Live heap bytes of the process (Every operator new, the requested size is kept in front of the block)
+static std::atomic<int64_t> HEAP_BYTES{ 0 };
+static constexpr std::size_t HEAP_HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(std::size_t size)
+{
+	if (void* block = std::malloc(size + HEAP_HEADER_SIZE))
+	{
+		*static_cast<std::size_t*>(block) = size;
+		HEAP_BYTES.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+		return static_cast<std::byte*>(block) + HEAP_HEADER_SIZE;
+	}
+	throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept
+{
+	if (memory == nullptr) return;
+	void* block = static_cast<std::byte*>(memory) - HEAP_HEADER_SIZE;
+	HEAP_BYTES.fetch_sub(static_cast<int64_t>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+	std::free(block);
+}
+void operator delete(void* memory, std::size_t) noexcept { operator delete(memory); }
+
+namespace
+{
+	using namespace Albedo::RHI;
+
+	// Trivial compute shader (local size 1x1x1, no resources), used without --compute-shader
+	constexpr uint32_t EMPTY_COMPUTE_SHADER[] =
+	{
+		0x07230203, 0x00010000, 0, 5, 0,
+		0x00020011, 1,															// OpCapability Shader
+		0x0003000E, 0, 1,														// OpMemoryModel Logical GLSL450
+		0x0005000F, 5, 1, 0x6E69616D, 0,								// OpEntryPoint GLCompute %1 "main"
+		0x00060010, 1, 17, 1, 1, 1,										// OpExecutionMode %1 LocalSize 1 1 1
+		0x00020013, 2,															// %2 = OpTypeVoid
+		0x00030021, 3, 2,														// %3 = OpTypeFunction %2
+		0x00050036, 2, 1, 0, 3,												// %1 = OpFunction %2 None %3
+		0x000200F8, 4,															// OpLabel
+		0x000100FD,																// OpReturn
+		0x00010038																// OpFunctionEnd
+	};
+
+	struct Snapshot
+	{
+		int64_t heap_bytes = 0;
+		int64_t driver_host_bytes = 0;				// Live bytes of every allocation scope
+		int64_t driver_internal_bytes = 0;
+		int64_t device_block_bytes = 0;				// Allocated from Vulkan
+		int64_t device_allocation_bytes = 0;	// Used by resources
+		int64_t device_allocations = 0;
+
+		Snapshot operator-(const Snapshot& before) const
+		{
+			return Snapshot
+			{
+				.heap_bytes = heap_bytes - before.heap_bytes,
+				.driver_host_bytes = driver_host_bytes - before.driver_host_bytes,
+				.driver_internal_bytes = driver_internal_bytes - before.driver_internal_bytes,
+				.device_block_bytes = device_block_bytes - before.device_block_bytes,
+				.device_allocation_bytes = device_allocation_bytes - before.device_allocation_bytes,
+				.device_allocations = device_allocations - before.device_allocations
+			};
+		}
+	};
+
+	Snapshot TakeSnapshot(VulkanContext* context)
+	{
+		Snapshot snapshot{ .heap_bytes = HEAP_BYTES.load(std::memory_order_relaxed) };
+		auto hostStatistics = HostAllocator::GetStatistics(); // Before the VMA statistics, which allocate
+		for (const auto& scope : hostStatistics.scopes)
+		{
+			snapshot.driver_host_bytes += static_cast<int64_t>(scope.bytes);
+			snapshot.driver_internal_bytes += static_cast<int64_t>(scope.internal_bytes);
+		}
+		if (context != nullptr)
+		{
+			auto deviceStatistics = context->m_memory_allocator->GetStatistics().total;
+			snapshot.device_block_bytes = static_cast<int64_t>(deviceStatistics.block_bytes);
+			snapshot.device_allocation_bytes = static_cast<int64_t>(deviceStatistics.allocation_bytes);
+			snapshot.device_allocations = deviceStatistics.allocation_count;
+		}
+		return snapshot;
+	}
+
+	struct Result
+	{
+		std::string name;
+		uint64_t objects = 0;
+		Snapshot footprint; // Of all objects
+	};
+
+	class BenchComputePipeline : public ComputePipeline
+	{
+	public:
+		BenchComputePipeline(std::shared_ptr<VulkanContext> vulkan_context, std::string shader_file) :
+			ComputePipeline{ std::move(vulkan_context) }, m_shader_file{ std::move(shader_file) } {}
+	protected:
+		std::string prepare_shader_file() override { return m_shader_file; }
+	private:
+		std::string m_shader_file;
+	};
+
+	void WaitIdle(VulkanContext& context)
+	{
+		vkDeviceWaitIdle(context.m_device);
+		context.GetDeletionQueue().Collect();
+	}
+
+	// Keeps count objects of create(index) alive while measuring, then releases them (Through the deletion queue)
+	template<typename Create>
+	Result MeasureFootprint(std::shared_ptr<VulkanContext> context, std::string name, uint64_t count, Create&& create)
+	{
+		create(0); // Warm-up: Pools, caches and shared layouts are not counted per object
+		WaitIdle(*context);
+
+		std::vector<std::shared_ptr<void>> objects;
+		objects.reserve(count);
+		const auto before = TakeSnapshot(context.get());
+		for (uint64_t index = 0; index < count; ++index) objects.emplace_back(create(index));
+		const auto after = TakeSnapshot(context.get());
+		objects.clear();
+		WaitIdle(*context);
+		return Result{ .name = std::move(name), .objects = count, .footprint = after - before };
+	}
+
+	std::vector<Result> RunFootprints(std::shared_ptr<VulkanContext> context, uint64_t count, const std::string& compute_shader)
+	{
+		std::vector<Result> results;
+		auto& allocator = *context->m_memory_allocator;
+
+		// Buffers (The small one shows the wrapper overhead, the large one the allocation granularity)
+		results.emplace_back(MeasureFootprint(context, "buffer_256B_uniform", count, [&](uint64_t)
+			{
+				return allocator.AllocateBuffer(256, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+			}));
+		results.emplace_back(MeasureFootprint(context, "buffer_64KiB_storage", count, [&](uint64_t)
+			{
+				return allocator.AllocateBuffer(64 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+			}));
+
+		// Textures (With their sampled view)
+		results.emplace_back(MeasureFootprint(context, "texture_256x256_rgba8", count, [&](uint64_t)
+			{
+				auto image = allocator.AllocateImage(VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+					256, 256, 4, VK_FORMAT_R8G8B8A8_UNORM);
+				image->GetSampledImageView();
+				return image;
+			}));
+
+		// Descriptor Sets (Global allocator of this thread, one uniform buffer written)
+		{
+			auto layout = context->CreateDescripotrSetLayout({ VkDescriptorSetLayoutBinding
+				{
+					.binding = 0,
+					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+					.descriptorCount = 1,
+					.stageFlags = VK_SHADER_STAGE_ALL
+				} });
+			auto uniformBuffer = allocator.AllocateBuffer(256, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+			results.emplace_back(MeasureFootprint(context, "descriptor_set_uniform", count, [&](uint64_t)
+				{
+					auto descriptorSet = context->CreateDescriptorSet(layout);
+					descriptorSet->WriteBuffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, uniformBuffer);
+					return descriptorSet;
+				}));
+		}
+
+		// Compute Pipelines (Shader module & layout shared, one VkPipeline each)
+		results.emplace_back(MeasureFootprint(context, "compute_pipeline", std::max<uint64_t>(count / 16, 1), [&](uint64_t)
+			{
+				auto pipeline = std::make_shared<BenchComputePipeline>(context, compute_shader);
+				pipeline->Initialize();
+				return pipeline;
+			}));
+
+		// Command Buffers (Per-thread one-time pool, recorded empty)
+		results.emplace_back(MeasureFootprint(context, "command_buffer_primary", count, [&](uint64_t)
+			{
+				auto commandBuffer = context->CreateOneTimeCommandBuffer(context->m_device_queue_family_graphics);
+				commandBuffer->Begin();
+				commandBuffer->End();
+				return commandBuffer;
+			}));
+		return results;
+	}
+
+	std::string Escape(std::string_view text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	void WriteFootprint(std::ostream& output, const Snapshot& footprint, uint64_t objects)
+	{
+		auto per_object = [objects](int64_t value) { return static_cast<double>(value) / static_cast<double>(objects); };
+		output << "\"heap_bytes_per_object\": " << per_object(footprint.heap_bytes)
+			<< ", \"driver_host_bytes_per_object\": " << per_object(footprint.driver_host_bytes)
+			<< ", \"driver_internal_bytes_per_object\": " << per_object(footprint.driver_internal_bytes)
+			<< ", \"device_block_bytes_per_object\": " << per_object(footprint.device_block_bytes)
+			<< ", \"device_allocation_bytes_per_object\": " << per_object(footprint.device_allocation_bytes)
+			<< ", \"device_allocations_per_object\": " << per_object(footprint.device_allocations);
+	}
+
+	void WriteJson(std::ostream& output, VulkanContext& context, const Snapshot& context_footprint, const std::vector<Result>& results)
+	{
+		output << "{\n";
+		output << "  \"device\": \"" << Escape(context.m_physical_device_properties.deviceName) << "\",\n";
+		output << "  \"driver_version\": " << context.m_physical_device_properties.driverVersion << ",\n";
+		output << "  \"context\": { ";
+		WriteFootprint(output, context_footprint, 1);
+		output << " },\n";
+		output << "  \"resources\": [\n";
+		for (size_t index = 0; index < results.size(); ++index)
+		{
+			const auto& result = results[index];
+			output << "    { \"name\": \"" << result.name << "\", \"objects\": " << result.objects << ", ";
+			WriteFootprint(output, result.footprint, result.objects);
+			output << " }" << (index + 1 < results.size() ? "," : "") << "\n";
+		}
+		output << "  ]\n}\n";
+	}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::string outputFile;
+	std::string computeShader;
+	uint64_t count = 1000;
+	for (int index = 1; index + 1 < argc; index += 2)
+	{
+		std::string_view option = argv[index];
+		if (option == "--output") outputFile = argv[index + 1];
+		else if (option == "--count") count = std::max<uint64_t>(std::strtoull(argv[index + 1], nullptr, 10), 1);
+		else if (option == "--compute-shader") computeShader = argv[index + 1];
+		else
+		{
+			std::cerr << "Unknown option " << option << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	try
+	{
+		if (computeShader.empty())
+		{
+			auto path = std::filesystem::temp_directory_path() / "AlbedoRHI_memory_empty.comp.spv";
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(EMPTY_COMPUTE_SHADER), sizeof(EMPTY_COMPUTE_SHADER));
+			computeShader = path.string();
+		}
+
+		Albedo::RHI::HostAllocator::Enable(); // Before the context latches the callbacks
+		const auto beforeContext = TakeSnapshot(nullptr);
+		auto context = Albedo::RHI::VulkanContext::CreateHeadless({ 256, 256 }, 3);
+		const auto contextFootprint = TakeSnapshot(context.get()) - beforeContext;
+
+		auto results = RunFootprints(context, count, computeShader);
+		if (outputFile.empty()) WriteJson(std::cout, *context, contextFootprint, results);
+		else
+		{
+			std::ofstream file(outputFile, std::ios::trunc);
+			WriteJson(file, *context, contextFootprint, results);
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << "AlbedoRHI_memory failed: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,373 @@
+// AlbedoRHI_scaling: Headless scaling benchmark of multi-threaded recording and submission
+// Usage: AlbedoRHI_scaling [--output <file.json>] [--draws <M>] [--threads <N>] [--frames <F>] [--vertex-shader <shader.spv>]
+// Records M draws per frame on 1, 2, 4 ... N threads (Per-thread command pools), once into secondaries executed by one primary and
+// once into one primary per thread, both submitted through a SubmitBatch. Reports draws per second, the latency percentiles of
+// SubmitBatch::Flush() and the contention on the thread slot registry & the command pools (Compare them across versions).
+
+#include <AlbedoRHI.hpp>
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	using namespace Albedo::RHI;
+
+	constexpr VkExtent2D RENDER_AREA{ 256, 256 };
+	constexpr size_t FRAMES_IN_FLIGHT = 2;
+
+	// Empty vertex shader (No inputs, no outputs, nothing rasterized), used without --vertex-shader
+	constexpr uint32_t EMPTY_VERTEX_SHADER[] =
+	{
+		0x07230203, 0x00010000, 0, 5, 0,
+		0x00020011, 1,															// OpCapability Shader
+		0x0003000E, 0, 1,														// OpMemoryModel Logical GLSL450
+		0x0005000F, 0, 1, 0x6E69616D, 0,								// OpEntryPoint Vertex %1 "main"
+		0x00020013, 2,															// %2 = OpTypeVoid
+		0x00030021, 3, 2,														// %3 = OpTypeFunction %2
+		0x00050036, 2, 1, 0, 3,												// %1 = OpFunction %2 None %3
+		0x000200F8, 4,															// OpLabel
+		0x000100FD,																// OpReturn
+		0x00010038																// OpFunctionEnd
+	};
+
+	enum class Mode { SECONDARY, BATCHED_PRIMARIES };
+
+	struct Result
+	{
+		Mode mode;
+		uint32_t threads = 0;
+		uint64_t frames = 0;
+		double draws_per_second = 0.0;
+		double submit_p50_us = 0.0;		// SubmitBatch::Flush()
+		double submit_p90_us = 0.0;
+		double submit_p99_us = 0.0;
+		uint64_t thread_slot_lookups = 0;
+		uint64_t thread_slot_contentions = 0;
+		uint64_t command_pool_contentions = 0;
+	};
+
+	using BenchPipelineDesc = PipelineDesc<Blend::Opaque, Depth::Disabled, Cull::None>;
+
+	class BenchGraphicsPipeline : public DescribedGraphicsPipeline<BenchPipelineDesc>
+	{
+	public:
+		BenchGraphicsPipeline(std::shared_ptr<VulkanContext> vulkan_context, const RenderingFormats& rendering_formats, std::string shader_file) :
+			DescribedGraphicsPipeline{ std::move(vulkan_context), rendering_formats }, m_shader_file{ std::move(shader_file) } {}
+		void Bind(std::shared_ptr<CommandBuffer> command_buffer) override { command_buffer->BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, *this); }
+	protected:
+		std::vector<std::string> prepare_shader_files() override { return { m_shader_file }; }
+	private:
+		std::string m_shader_file;
+	};
+
+	// Attachment-less rendering: The draws write nothing, so frames in flight need no barriers between them
+	class BenchRenderPass : public DynamicRenderPass
+	{
+	public:
+		BenchRenderPass(std::shared_ptr<VulkanContext> vulkan_context, std::string shader_file) :
+			DynamicRenderPass{ std::move(vulkan_context) }, m_shader_file{ std::move(shader_file) } {}
+
+		BenchGraphicsPipeline& GetPipeline() { return *m_pipeline; }
+		VkCommandBufferInheritanceRenderingInfo GetInheritanceRenderingInfo() const
+		{
+			return VkCommandBufferInheritanceRenderingInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+				.viewMask = 0,
+				.colorAttachmentCount = 0,
+				.depthAttachmentFormat = VK_FORMAT_UNDEFINED,
+				.stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+				.rasterizationSamples = m_rendering_formats.samples
+			};
+		}
+
+	protected:
+		RenderingFormats set_rendering_formats() override { return {}; }
+		Attachments set_attachments() override { return {}; }
+		VkRect2D set_render_area() override { return { { 0, 0 }, RENDER_AREA }; }
+		void create_pipelines() override
+		{
+			m_pipeline = std::make_unique<BenchGraphicsPipeline>(m_context, m_rendering_formats, m_shader_file);
+			m_graphics_pipelines = { m_pipeline.get() };
+			initialize_graphics_pipelines();
+		}
+
+	private:
+		std::string m_shader_file;
+		std::unique_ptr<BenchGraphicsPipeline> m_pipeline;
+	};
+
+	// Draws of one range (Viewports & scissors are dynamic, every command buffer sets them)
+	void RecordDraws(BenchRenderPass& render_pass, std::shared_ptr<CommandBuffer> command_buffer, uint32_t count)
+	{
+		render_pass.GetPipeline().Bind(command_buffer);
+		command_buffer->SetViewports({ VkViewport{ 0.0f, 0.0f, static_cast<float>(RENDER_AREA.width), static_cast<float>(RENDER_AREA.height), 0.0f, 1.0f } });
+		command_buffer->SetScissors({ VkRect2D{ { 0, 0 }, RENDER_AREA } });
+		for (uint32_t draw = 0; draw < count; ++draw) command_buffer->Draw(3, 1, 0, draw);
+	}
+
+	// Workers started per run, so every run registers its threads in the slot registry again
+	class WorkerGroup
+	{
+	public:
+		using Task = std::function<void(uint32_t worker)>;
+
+		explicit WorkerGroup(uint32_t worker_count) :
+			m_start{ static_cast<std::ptrdiff_t>(worker_count) + 1 },
+			m_finish{ static_cast<std::ptrdiff_t>(worker_count) + 1 },
+			m_failures(worker_count)
+		{
+			for (uint32_t worker = 0; worker < worker_count; ++worker)
+				m_threads.emplace_back([this, worker]
+					{
+						for (;;)
+						{
+							m_start.arrive_and_wait();
+							if (m_stop) return;
+							try { m_task(worker); }
+							catch (...) { m_failures[worker] = std::current_exception(); }
+							m_finish.arrive_and_wait();
+						}
+					});
+		}
+		~WorkerGroup()
+		{
+			m_stop = true;
+			m_start.arrive_and_wait();
+		}
+		WorkerGroup(const WorkerGroup&) = delete;
+
+		void Run(Task task) // Blocks until every worker returned
+		{
+			m_task = std::move(task);
+			m_start.arrive_and_wait();
+			m_finish.arrive_and_wait();
+			for (auto& failure : m_failures)
+				if (failure) std::rethrow_exception(std::exchange(failure, nullptr));
+		}
+
+	private:
+		std::barrier<> m_start;
+		std::barrier<> m_finish;
+		Task m_task;
+		bool m_stop = false; // Published by m_start
+		std::vector<std::exception_ptr> m_failures;
+		std::vector<std::jthread> m_threads;
+	};
+
+	Result RunScaling(std::shared_ptr<VulkanContext> context, BenchRenderPass& render_pass, Mode mode, uint32_t thread_count, uint32_t draw_count, uint64_t frame_count)
+	{
+		auto& graphicsFamily = context->m_device_queue_family_graphics;
+		auto queueTimeline = context->GetGlobalQueueTimeline(graphicsFamily);
+		SubmitBatch submitBatch{ queueTimeline, thread_count };
+		WorkerGroup workers{ thread_count };
+
+		auto inheritanceRenderingInfo = render_pass.GetInheritanceRenderingInfo();
+		VkCommandBufferInheritanceInfo inheritanceInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.pNext = &inheritanceRenderingInfo,
+			.renderPass = VK_NULL_HANDLE
+		};
+
+		std::vector<std::shared_ptr<CommandBuffer>> recorded(thread_count);
+		auto record_frame = [&](uint32_t worker)
+		{
+			const uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * worker / thread_count);
+			const uint32_t count = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * (worker + 1) / thread_count) - first;
+			if (mode == Mode::SECONDARY)
+			{
+				auto secondaryCommandBuffer = context->CreateOneTimeCommandBuffer(graphicsFamily, false);
+				secondaryCommandBuffer->Begin(&inheritanceInfo);
+				RecordDraws(render_pass, secondaryCommandBuffer, count);
+				secondaryCommandBuffer->End();
+				recorded[worker] = std::move(secondaryCommandBuffer);
+			}
+			else
+			{
+				auto primaryCommandBuffer = context->CreateOneTimeCommandBuffer(graphicsFamily);
+				primaryCommandBuffer->Begin();
+				render_pass.Begin(primaryCommandBuffer);
+				RecordDraws(render_pass, primaryCommandBuffer, count);
+				render_pass.End(primaryCommandBuffer);
+				primaryCommandBuffer->End();
+				submitBatch.Add(*primaryCommandBuffer);
+				recorded[worker] = std::move(primaryCommandBuffer);
+			}
+		};
+
+		// The command buffers of a frame are released (Recycled into the pools of their recording threads) once its tick passed
+		struct FrameInFlight { uint64_t tick; std::vector<std::shared_ptr<CommandBuffer>> command_buffers; };
+		std::deque<FrameInFlight> framesInFlight;
+		std::vector<double> submitMicroseconds;
+		submitMicroseconds.reserve(frame_count);
+
+		auto run_frame = [&]()
+		{
+			if (framesInFlight.size() == FRAMES_IN_FLIGHT)
+			{
+				queueTimeline->Wait(framesInFlight.front().tick);
+				framesInFlight.pop_front();
+			}
+			workers.Run(record_frame);
+
+			FrameInFlight frame;
+			if (mode == Mode::SECONDARY)
+			{
+				auto primaryCommandBuffer = context->CreateOneTimeCommandBuffer(graphicsFamily);
+				primaryCommandBuffer->Begin();
+				render_pass.Begin(primaryCommandBuffer, true);
+				primaryCommandBuffer->ExecuteCommands(recorded); // Keeps the secondaries alive
+				render_pass.End(primaryCommandBuffer);
+				primaryCommandBuffer->End();
+				submitBatch.Add(*primaryCommandBuffer);
+				frame.command_buffers.emplace_back(std::move(primaryCommandBuffer));
+				for (auto& secondaryCommandBuffer : recorded) secondaryCommandBuffer.reset();
+			}
+			else frame.command_buffers = std::exchange(recorded, std::vector<std::shared_ptr<CommandBuffer>>(thread_count));
+
+			auto begin = std::chrono::steady_clock::now();
+			frame.tick = submitBatch.Flush();
+			submitMicroseconds.emplace_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+			framesInFlight.emplace_back(std::move(frame));
+		};
+
+		for (uint64_t frame = 0; frame < std::max<uint64_t>(frame_count / 10, 1); ++frame) run_frame(); // Warm-up (Pools & registry)
+		queueTimeline->Wait(queueTimeline->GetSubmittedTick());
+		framesInFlight.clear();
+		submitMicroseconds.clear();
+
+		const auto before = context->GetStatistics().GetCurrentFrame();
+		auto begin = std::chrono::steady_clock::now();
+		for (uint64_t frame = 0; frame < frame_count; ++frame) run_frame();
+		queueTimeline->Wait(queueTimeline->GetSubmittedTick());
+		framesInFlight.clear();
+		auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		const auto after = context->GetStatistics().GetCurrentFrame();
+
+		std::sort(submitMicroseconds.begin(), submitMicroseconds.end());
+		auto percentile = [&submitMicroseconds](double fraction)
+		{
+			return submitMicroseconds[std::min(static_cast<size_t>(fraction * submitMicroseconds.size()), submitMicroseconds.size() - 1)];
+		};
+		return Result
+		{
+			.mode = mode,
+			.threads = thread_count,
+			.frames = frame_count,
+			.draws_per_second = static_cast<double>(draw_count) * frame_count / elapsed,
+			.submit_p50_us = percentile(0.50),
+			.submit_p90_us = percentile(0.90),
+			.submit_p99_us = percentile(0.99),
+			.thread_slot_lookups = after.thread_slot_lookups - before.thread_slot_lookups,
+			.thread_slot_contentions = after.thread_slot_contentions - before.thread_slot_contentions,
+			.command_pool_contentions = after.command_pool_contentions - before.command_pool_contentions
+		};
+	}
+
+	std::string Escape(std::string_view text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	void WriteJson(std::ostream& output, VulkanContext& context, uint32_t draw_count, const std::vector<Result>& results)
+	{
+		output << "{\n";
+		output << "  \"device\": \"" << Escape(context.m_physical_device_properties.deviceName) << "\",\n";
+		output << "  \"driver_version\": " << context.m_physical_device_properties.driverVersion << ",\n";
+		output << "  \"draws_per_frame\": " << draw_count << ",\n";
+		output << "  \"runs\": [\n";
+		for (size_t index = 0; index < results.size(); ++index)
+		{
+			const auto& result = results[index];
+			output << "    { \"mode\": \"" << (result.mode == Mode::SECONDARY ? "secondary" : "batched_primaries") << "\""
+				<< ", \"threads\": " << result.threads
+				<< ", \"frames\": " << result.frames
+				<< ", \"draws_per_second\": " << result.draws_per_second
+				<< ", \"submit_p50_us\": " << result.submit_p50_us
+				<< ", \"submit_p90_us\": " << result.submit_p90_us
+				<< ", \"submit_p99_us\": " << result.submit_p99_us
+				<< ", \"thread_slot_lookups\": " << result.thread_slot_lookups
+				<< ", \"thread_slot_contentions\": " << result.thread_slot_contentions
+				<< ", \"command_pool_contentions\": " << result.command_pool_contentions
+				<< " }" << (index + 1 < results.size() ? "," : "") << "\n";
+		}
+		output << "  ]\n}\n";
+	}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::string outputFile;
+	std::string vertexShader;
+	uint32_t drawCount = 10000;
+	uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	uint64_t frameCount = 200;
+	for (int index = 1; index + 1 < argc; index += 2)
+	{
+		std::string_view option = argv[index];
+		if (option == "--output") outputFile = argv[index + 1];
+		else if (option == "--draws") drawCount = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[index + 1], nullptr, 10)), 1);
+		else if (option == "--threads") maxThreads = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[index + 1], nullptr, 10)), 1);
+		else if (option == "--frames") frameCount = std::max<uint64_t>(std::strtoull(argv[index + 1], nullptr, 10), 1);
+		else if (option == "--vertex-shader") vertexShader = argv[index + 1];
+		else
+		{
+			std::cerr << "Unknown option " << option << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	try
+	{
+		if (vertexShader.empty())
+		{
+			auto path = std::filesystem::temp_directory_path() / "AlbedoRHI_scaling_empty.vert.spv";
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(EMPTY_VERTEX_SHADER), sizeof(EMPTY_VERTEX_SHADER));
+			vertexShader = path.string();
+		}
+
+		auto context = Albedo::RHI::VulkanContext::CreateHeadless(RENDER_AREA, 3);
+		BenchRenderPass renderPass{ context, vertexShader };
+		renderPass.Initialize();
+
+		std::vector<Result> results;
+		for (auto mode : { Mode::SECONDARY, Mode::BATCHED_PRIMARIES })
+		{
+			for (uint32_t threads = 1; threads <= maxThreads; threads = (threads == maxThreads) ? threads + 1 : std::min(threads * 2, maxThreads))
+				results.emplace_back(RunScaling(context, renderPass, mode, std::min(threads, drawCount), drawCount, frameCount));
+		}
+		vkDeviceWaitIdle(context->m_device);
+		context->GetDeletionQueue().Collect();
+
+		if (outputFile.empty()) WriteJson(std::cout, *context, drawCount, results);
+		else
+		{
+			std::ofstream file(outputFile, std::ios::trunc);
+			WriteJson(file, *context, drawCount, results);
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << "AlbedoRHI_scaling failed: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
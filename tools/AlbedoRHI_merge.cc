@@ -0,0 +1,33 @@
+// AlbedoRHI_merge: Merge step of the shared pipeline cache (See VulkanContext::MergePipelineCaches())
+// Usage: AlbedoRHI_merge <pipeline cache file> <delta>...
+// Worker processes save their caches to deltas by VulkanContext::SetPipelineCacheDeltaFile(), this tool combines them into the shared
+// pipeline cache file. Run it on a node with the same GPU and driver as the workers (Deltas of other devices are skipped).
+
+#include <AlbedoRHI.hpp>
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: AlbedoRHI_merge <pipeline cache file> <delta>...\n";
+		return EXIT_FAILURE;
+	}
+	std::vector<std::string> deltaFiles(argv + 2, argv + argc);
+
+	try
+	{
+		auto context = Albedo::RHI::VulkanContext::CreateHeadless({ 64, 64 }, 1, argv[1]);
+		auto mergedDeltas = context->MergePipelineCaches(deltaFiles);
+		std::cout << "[AlbedoRHI_merge]: Merged " << mergedDeltas << " of " << deltaFiles.size() << " deltas into " << argv[1]
+			<< " (Generation " << context->GetPipelineCacheGeneration() << ")\n";
+		if (mergedDeltas != deltaFiles.size()) return EXIT_FAILURE; // Skipped deltas are kept by the caller
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << "[AlbedoRHI_merge]: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
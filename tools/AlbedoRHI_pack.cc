@@ -0,0 +1,32 @@
+// AlbedoRHI_pack: Build-time shader archive packing (See albedo_rhi_pack_shaders() in CMakeLists.txt)
+// Usage: AlbedoRHI_pack <output.archive> [--keep-debug-info] <shader.spv>...
+// Shaders are archived under the given paths (Relative to the working directory), so GetShaderModule() must use the same paths.
+// Load the archive with ShaderCache::LoadShaderArchive() (e.g. <pipeline cache file>.archive at context creation).
+
+#include <AlbedoRHI.hpp>
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> shaderFiles;
+	bool stripDebugInfo = true;
+	for (int i = 2; i < argc; ++i)
+	{
+		if (std::string_view{ argv[i] } == "--keep-debug-info") stripDebugInfo = false;
+		else shaderFiles.emplace_back(argv[i]);
+	}
+	if (argc < 2 || shaderFiles.empty())
+	{
+		std::cerr << "Usage: AlbedoRHI_pack <output.archive> [--keep-debug-info] <shader.spv>...\n";
+		return EXIT_FAILURE;
+	}
+
+	try { Albedo::RHI::ShaderCache::PackShaderArchive(argv[1], shaderFiles, stripDebugInfo); }
+	catch (const std::exception& error)
+	{
+		std::cerr << "[AlbedoRHI_pack]: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,315 @@
+// AlbedoRHI_reflect: Build-time SPIR-V reflection (See albedo_rhi_reflect_shaders() in CMakeLists.txt)
+// Usage: AlbedoRHI_reflect <shader.spv> <output.h> [--namespace <name>]
+// The header holds the constexpr binding tables of the shader (ShaderReflectionTable, registered by ShaderCache::RegisterShaderReflections())
+// and layout-exact C++ structs of its uniform, storage and push constant blocks (Explicit padding, offsets checked by static_asserts),
+// so a block is written by one memcpy and the SPIR-V is never reflected at runtime.
+
+#include "../API/Vulkan/vulkan_hash.h"
+
+#include <spirv_reflect.h>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using namespace Albedo::RHI;
+
+	constexpr uint32_t NO_SIZE = 0;
+
+	std::string sanitize(std::string_view name, std::string_view fallback)
+	{
+		static const std::set<std::string, std::less<>> KEYWORDS
+		{
+			"auto", "class", "default", "delete", "explicit", "friend", "goto", "namespace", "new", "operator",
+			"private", "protected", "public", "register", "template", "this", "throw", "typename", "union", "using", "virtual"
+		};
+
+		std::string identifier{ name.empty() ? fallback : name };
+		for (auto& character : identifier)
+			if (!std::isalnum(static_cast<unsigned char>(character)) && character != '_') character = '_';
+		if (identifier.empty() || std::isdigit(static_cast<unsigned char>(identifier.front()))) identifier.insert(0, "_");
+		if (KEYWORDS.contains(identifier)) identifier += '_';
+		return identifier;
+	}
+
+	std::string to_constant(std::string_view identifier) // camelCase -> CAMEL_CASE
+	{
+		std::string constant;
+		for (size_t i = 0; i < identifier.size(); ++i)
+		{
+			if (i && std::isupper(static_cast<unsigned char>(identifier[i])) && std::islower(static_cast<unsigned char>(identifier[i - 1])))
+				constant += '_';
+			constant += static_cast<char>(std::toupper(static_cast<unsigned char>(identifier[i])));
+		}
+		return constant;
+	}
+
+	const char* scalar_type(const SpvReflectTypeDescription& type, const SpvReflectNumericTraits& numeric)
+	{
+		const uint32_t width = numeric.scalar.width;
+		if (type.type_flags & SPV_REFLECT_TYPE_FLAG_FLOAT)
+		{
+			if (width == 64) return "double";
+			if (width == 32) return "float";
+			if (width == 16) return "uint16_t"; // IEEE half bits
+		}
+		else if (type.type_flags & SPV_REFLECT_TYPE_FLAG_INT)
+		{
+			const bool isSigned = numeric.scalar.signedness;
+			if (width == 64) return isSigned ? "int64_t" : "uint64_t";
+			if (width == 32) return isSigned ? "int32_t" : "uint32_t";
+			if (width == 16) return isSigned ? "int16_t" : "uint16_t";
+			if (width == 8) return isSigned ? "int8_t" : "uint8_t";
+		}
+		else if (type.type_flags & SPV_REFLECT_TYPE_FLAG_BOOL) return "uint32_t"; // Booleans are 32-bit in blocks
+		throw std::runtime_error(std::format("Unsupported scalar type (flags {:#x}, width {})!", type.type_flags, width));
+	}
+
+	class HeaderWriter
+	{
+	public:
+		std::string Generate(const std::vector<char>& bytecode, std::string_view shader_name, std::string_view namespace_name)
+		{
+			SpvReflectShaderModule spvContext;
+			if (spvReflectCreateShaderModule(bytecode.size(), bytecode.data(), &spvContext) != SPV_REFLECT_RESULT_SUCCESS)
+				throw std::runtime_error(std::format("Failed to reflect shader {}!", shader_name));
+
+			try { write_shader(spvContext, HashBytes(bytecode.data(), bytecode.size()), shader_name, namespace_name); }
+			catch (...) { spvReflectDestroyShaderModule(&spvContext); throw; }
+			spvReflectDestroyShaderModule(&spvContext);
+			return m_out.str();
+		}
+
+	private:
+		template<typename T>
+		std::vector<T*> enumerate(SpvReflectResult(*function)(const SpvReflectShaderModule*, uint32_t*, T**), const SpvReflectShaderModule& module)
+		{
+			uint32_t count = 0;
+			if (function(&module, &count, nullptr) != SPV_REFLECT_RESULT_SUCCESS) throw std::runtime_error("Failed to reflect shader!");
+			std::vector<T*> values(count);
+			if (function(&module, &count, values.data()) != SPV_REFLECT_RESULT_SUCCESS) throw std::runtime_error("Failed to enumerate shader!");
+			return values;
+		}
+
+		void write_shader(const SpvReflectShaderModule& module, uint64_t hash, std::string_view shader_name, std::string_view namespace_name)
+		{
+			m_out << "// Generated by AlbedoRHI_reflect from " << shader_name << " - do not edit\n"
+				<< "#pragma once\n\n#include <AlbedoRHI.hpp>\n\n#include <cstddef>\n\n"
+				<< "namespace Albedo {\nnamespace RHI {\nnamespace Shaders {\nnamespace " << namespace_name << "\n{\n";
+
+			// Same records as ShaderCache::reflect_shader() (Sets in order, vertex inputs by location)
+			std::vector<std::string> bindings, pushConstants, vertexInputs;
+			std::set<std::string> blockTypes; // Declared once per shader
+			for (const auto* descriptorSet : enumerate(spvReflectEnumerateDescriptorSets, module))
+			{
+				for (uint32_t i = 0; i < descriptorSet->binding_count; ++i)
+				{
+					const auto& binding = *descriptorSet->bindings[i];
+					bindings.emplace_back(std::format("{{ .set = {}, .binding = {}, .type = static_cast<VkDescriptorType>({}), .count = {} }}",
+						binding.set, binding.binding, static_cast<int>(binding.descriptor_type), binding.count));
+
+					const char* typeName = binding.type_description && binding.type_description->type_name ? binding.type_description->type_name : "";
+					const auto fallback = std::format("Set{}Binding{}", binding.set, binding.binding);
+					const auto constant = to_constant(sanitize(binding.name ? binding.name : "", sanitize(typeName, fallback)));
+					m_out << "\tinline constexpr uint32_t " << constant << "_SET = " << binding.set << ";\n"
+						<< "\tinline constexpr uint32_t " << constant << "_BINDING = " << binding.binding << ";\n";
+
+					if (binding.descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER &&
+						binding.descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER) continue;
+					const auto structName = sanitize(typeName, fallback);
+					if (!blockTypes.insert(structName).second) continue;
+					m_out << "\n";
+					write_struct(m_out, binding.block, structName, std::max(binding.block.size, binding.block.padded_size), "\t");
+					m_out << "\n";
+				}
+			}
+
+			for (const auto* pushConstant : enumerate(spvReflectEnumeratePushConstantBlocks, module))
+			{
+				pushConstants.emplace_back(std::format("{{ .stageFlags = {:#x}, .offset = {}, .size = {} }}",
+					static_cast<uint32_t>(module.shader_stage), pushConstant->offset, pushConstant->size));
+
+				const char* typeName = pushConstant->type_description && pushConstant->type_description->type_name ? pushConstant->type_description->type_name : "";
+				const auto structName = sanitize(typeName, "PushConstants");
+				if (!blockTypes.insert(structName).second) continue;
+				m_out << "\n\t// Push constant range [" << pushConstant->offset << ", " << pushConstant->offset + pushConstant->size
+					<< ") - the struct starts at offset 0, push it with CommandBuffer::Push<REFLECTION>()\n";
+				write_struct(m_out, *pushConstant, structName, NO_SIZE, "\t");
+				m_out << "\n";
+			}
+
+			if (module.shader_stage == SPV_REFLECT_SHADER_STAGE_VERTEX_BIT)
+			{
+				auto inputVariables = enumerate(spvReflectEnumerateInputVariables, module);
+				std::erase_if(inputVariables, [](const auto* input) { return input->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN; });
+				std::sort(inputVariables.begin(), inputVariables.end(), [](const auto* prev, const auto* next) { return prev->location < next->location; });
+				for (const auto* input : inputVariables)
+					vertexInputs.emplace_back(std::format("{{ .location = {}, .format = static_cast<VkFormat>({}) }}", input->location, static_cast<int>(input->format)));
+			}
+
+			auto write_table = [this](std::string_view type, std::string_view name, const std::vector<std::string>& values)
+			{
+				m_out << "\tinline constexpr std::array<" << type << ", " << values.size() << "> " << name << "\n\t{";
+				for (const auto& value : values) m_out << "\n\t\t" << type << value << ",";
+				m_out << (values.empty() ? "" : "\n\t") << "};\n";
+			};
+			m_out << "\n\tinline constexpr uint64_t HASH = " << std::format("{:#018x}", hash) << "ULL;\n"
+				<< "\tinline constexpr VkShaderStageFlagBits STAGE = static_cast<VkShaderStageFlagBits>(" << std::format("{:#x}", static_cast<uint32_t>(module.shader_stage)) << ");\n";
+			write_table("ShaderReflection::Binding", "DESCRIPTOR_BINDINGS", bindings);
+			write_table("VkPushConstantRange", "PUSH_CONSTANTS", pushConstants);
+			write_table("ShaderReflection::VertexInput", "VERTEX_INPUTS", vertexInputs);
+			m_out << "\tinline constexpr ShaderReflectionTable REFLECTION\n\t{\n"
+				<< "\t\t.hash = HASH,\n\t\t.stage = STAGE,\n\t\t.descriptor_bindings = DESCRIPTOR_BINDINGS,\n"
+				<< "\t\t.push_constants = PUSH_CONSTANTS,\n\t\t.vertex_inputs = VERTEX_INPUTS\n\t};\n\n"
+				<< "}}}} // namespace Albedo::RHI::Shaders::" << namespace_name << "\n";
+		}
+
+		// Members are placed at their SPIR-V offsets by explicit padding (Offsets of std140 / std430 are multiples of the C++ alignments)
+		void write_struct(std::ostream& out, const SpvReflectBlockVariable& block, const std::string& name, uint32_t size, const std::string& indent)
+		{
+			std::ostringstream body, checks;
+			std::set<std::string> nestedTypes;
+			uint32_t offset = 0, paddings = 0;
+			auto pad_to = [&](uint32_t target)
+			{
+				if (target < offset) throw std::runtime_error(std::format("Overlapping members in block {}!", name));
+				if (target > offset) body << indent << "\tstd::byte _padding" << paddings++ << "[" << target - offset << "];\n";
+				offset = target;
+			};
+
+			std::vector<const SpvReflectBlockVariable*> members;
+			for (uint32_t i = 0; i < block.member_count; ++i) members.emplace_back(&block.members[i]);
+			std::stable_sort(members.begin(), members.end(), [](const auto* prev, const auto* next) { return prev->offset < next->offset; });
+
+			for (size_t i = 0; i < members.size(); ++i)
+			{
+				const auto& member = *members[i];
+				const auto memberName = sanitize(member.name ? member.name : "", std::format("member{}", i));
+				const auto& type = *member.type_description;
+
+				// Arrays of arrays are flattened (The reflected stride is the one of the innermost elements)
+				uint32_t elementCount = 1, elementStride = 0;
+				bool isRuntimeArray = false;
+				if (type.type_flags & SPV_REFLECT_TYPE_FLAG_ARRAY)
+				{
+					const auto& array = type.traits.array; // Member traits miss runtime arrays
+					for (uint32_t dim = 0; dim < array.dims_count; ++dim)
+					{
+						if (array.dims[dim] == 0xFFFFFFFF)
+							throw std::runtime_error(std::format("Array {} of block {} is sized by a specialization constant!", memberName, name));
+						if (array.dims[dim] == 0) isRuntimeArray = true;
+						else elementCount *= array.dims[dim];
+					}
+					elementStride = array.stride;
+				}
+
+				auto [elementType, elementSize] = element_type(member, memberName, elementStride, body, nestedTypes, indent + "\t");
+				if (elementStride > elementSize) elementType = std::format("StridedElement<{}, {}>", elementType, elementStride);
+				else if (elementStride && elementStride < elementSize)
+					throw std::runtime_error(std::format("Array {} of block {} has a stride below its element size!", memberName, name));
+				if (elementStride) elementSize = elementStride;
+
+				pad_to(member.offset);
+				if (isRuntimeArray)
+				{
+					if (i + 1 != members.size()) throw std::runtime_error(std::format("Runtime array {} is not the last member of block {}!", memberName, name));
+					body << indent << "\t// Runtime array " << memberName << ": Elements follow at RUNTIME_ARRAY_OFFSET every RUNTIME_ARRAY_STRIDE bytes\n"
+						<< indent << "\tusing RuntimeArrayElement = " << elementType << ";\n"
+						<< indent << "\tstatic constexpr uint32_t RUNTIME_ARRAY_OFFSET = " << member.offset << ";\n"
+						<< indent << "\tstatic constexpr uint32_t RUNTIME_ARRAY_STRIDE = " << elementSize << ";\n";
+					break;
+				}
+
+				if (type.type_flags & SPV_REFLECT_TYPE_FLAG_ARRAY)
+					body << indent << "\tstd::array<" << elementType << ", " << elementCount << "> " << memberName << ";\n";
+				else body << indent << "\t" << elementType << " " << memberName << ";\n";
+				checks << indent << "static_assert(offsetof(" << name << ", " << memberName << ") == " << member.offset << ");\n";
+				offset += elementSize * elementCount;
+			}
+			if (size != NO_SIZE) pad_to(std::max(size, offset));
+
+			out << indent << "struct " << name << "\n" << indent << "{\n" << body.str() << indent << "};\n"
+				<< checks.str();
+			if (offset) out << indent << "static_assert(sizeof(" << name << ") == " << offset << ");\n"; // Not if only a runtime array (Empty)
+		}
+
+		// C++ type of one element of the member (Nested structs are declared into the body first) and its size in bytes
+		std::pair<std::string, uint32_t> element_type(const SpvReflectBlockVariable& member, const std::string& member_name, uint32_t element_stride,
+			std::ostringstream& body, std::set<std::string>& nested_types, const std::string& indent)
+		{
+			const auto& type = *member.type_description;
+			const auto& numeric = member.numeric;
+
+			if (type.type_flags & SPV_REFLECT_TYPE_FLAG_STRUCT)
+			{
+				const auto structName = sanitize(type.type_name ? type.type_name : "", member_name + "_t");
+				const uint32_t structSize = element_stride ? element_stride : member.size;
+				if (nested_types.insert(structName).second) write_struct(body, member, structName, structSize, indent);
+				return { structName, structSize };
+			}
+
+			const std::string scalar = scalar_type(type, numeric);
+			const uint32_t scalarSize = numeric.scalar.width / 8;
+			if (type.type_flags & SPV_REFLECT_TYPE_FLAG_MATRIX)
+			{
+				const bool isRowMajor = member.decoration_flags & SPV_REFLECT_DECORATION_ROW_MAJOR;
+				const uint32_t vectors = isRowMajor ? numeric.matrix.row_count : numeric.matrix.column_count; // Columns or rows (Padded to the stride)
+				return { std::format("std::array<std::array<{}, {}>, {}>", scalar, numeric.matrix.stride / scalarSize, vectors), vectors * numeric.matrix.stride };
+			}
+			if (type.type_flags & SPV_REFLECT_TYPE_FLAG_VECTOR)
+				return { std::format("std::array<{}, {}>", scalar, numeric.vector.component_count), numeric.vector.component_count * scalarSize };
+			return { scalar, scalarSize };
+		}
+
+	private:
+		std::ostringstream m_out;
+	};
+
+	std::vector<char> read_file(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) throw std::runtime_error(std::format("Failed to open the shader file {}!", path));
+		std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(buffer.data(), buffer.size());
+		return buffer;
+	}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3 && !(argc == 5 && std::string_view{ argv[3] } == "--namespace"))
+	{
+		std::cerr << "Usage: AlbedoRHI_reflect <shader.spv> <output.h> [--namespace <name>]\n";
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		const std::string shaderFile = argv[1];
+		auto fileName = shaderFile.substr(shaderFile.find_last_of("/\\") + 1);
+		if (fileName.ends_with(".spv")) fileName.resize(fileName.size() - 4); // mesh.vert.spv -> mesh_vert
+		const auto namespaceName = argc == 5 ? std::string{ argv[4] } : sanitize(fileName, "shader");
+
+		auto header = HeaderWriter{}.Generate(read_file(shaderFile), fileName, namespaceName);
+
+		std::ofstream output(argv[2], std::ios::trunc);
+		if (!output.is_open()) throw std::runtime_error(std::format("Failed to open the output file {}!", argv[2]));
+		output << header;
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << "[AlbedoRHI_reflect]: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
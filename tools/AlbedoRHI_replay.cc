@@ -0,0 +1,44 @@
+// AlbedoRHI_replay: Performance regression harness of captured workloads (See CommandCapture and CommandReplay)
+// Usage: AlbedoRHI_replay <capture file> [iterations = 10]
+// Replays every frame of the capture headless and prints the frame times, run it with the build and shaders that captured it.
+// Compare the median across commits on the same machine, proxies keep the timings comparable but not equal to the application.
+
+#include <AlbedoRHI.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "Usage: AlbedoRHI_replay <capture file> [iterations = 10]\n";
+		return EXIT_FAILURE;
+	}
+	const uint32_t iterations = (argc == 3) ? static_cast<uint32_t>(std::max(1, std::atoi(argv[2]))) : 10;
+
+	try
+	{
+		auto context = Albedo::RHI::VulkanContext::CreateHeadless({ 64, 64 }, 1);
+		Albedo::RHI::CommandReplay replay{ context, argv[1] };
+		if (replay.GetFrameCount() == 0) throw std::runtime_error("The capture has no frames!");
+		replay.Run(); // Warm-up (Pipelines, residency and clocks)
+		auto frameTimes = replay.Run(iterations);
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		const auto& statistics = replay.GetStatistics();
+		std::cout << "[AlbedoRHI_replay]: " << argv[1] << " - " << replay.GetFrameCount() << " frames x " << iterations << " iterations ("
+			<< statistics.commands << " commands, skipped " << statistics.skipped_commands << " commands and " << statistics.skipped_pipelines << " pipelines)\n"
+			<< "  Frame time (ms): min " << frameTimes.front()
+			<< ", avg " << std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / frameTimes.size()
+			<< ", median " << frameTimes[frameTimes.size() / 2]
+			<< ", max " << frameTimes.back() << "\n";
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << "[AlbedoRHI_replay]: " << error.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}